@@ -119,6 +119,9 @@ struct obd_dev_s *obd_init(char *devfile, int baudate, int mode)
     }
 
   dev->can_mode = mode;
+#ifdef CONFIG_LIBOBD2_POLL
+  dev->poll     = NULL;
+#endif
 
   printf("OBD-II device initialized!\n");
 
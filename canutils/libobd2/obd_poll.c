@@ -0,0 +1,987 @@
+/****************************************************************************
+ * canutils/libobd2/obd_poll.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/ioctl.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <nuttx/can/can.h>
+
+#include "canutils/obd.h"
+#include "canutils/obd_pid.h"
+#include "canutils/obd_frame.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define OBD_POLL_CLOCK   CLOCK_MONOTONIC
+#else
+#  define OBD_POLL_CLOCK   CLOCK_REALTIME
+#endif
+
+/* Number of CAN messages taken from the driver with each read() */
+
+#define OBD_POLL_RXBATCH   4
+
+/* Times are kept in msec and compared modulo 2^32 */
+
+#define OBD_POLL_DUE(t, now) ((int32_t)((now) - (t)) >= 0)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One polled PID */
+
+struct obd_pollpid_s
+{
+  uint8_t  opmode;                   /* Mode of the request                 */
+  uint8_t  pid;                      /* PID of the request                  */
+  bool     inflight;                 /* A request is waiting for a response */
+  bool     answered;                 /* A once only request was answered    */
+  uint32_t period;                   /* msec between requests, 0 = once     */
+  uint32_t due;                      /* Time of the next request            */
+  uint32_t sent;                     /* Time the request in flight was sent */
+};
+
+/* Reassembly of a multi-frame response from one ECU */
+
+#ifdef CONFIG_LIBOBD2_MULTIFRAME
+struct obd_isotp_s
+{
+  uint32_t canid;                    /* ID of the responding ECU, 0 = free  */
+  uint32_t updated;                  /* Time the last frame was received    */
+  uint16_t len;                      /* Total length from the first frame   */
+  uint16_t got;                      /* Bytes received so far               */
+  uint8_t  seq;                      /* Next consecutive frame number       */
+  uint8_t  buf[CONFIG_LIBOBD2_POLL_MAXLEN];
+};
+#endif
+
+struct obd_poll_s
+{
+  obd_pollcb_t callback;             /* Called with each response           */
+  FAR void *arg;                     /* Argument for the callback           */
+  uint8_t npids;                     /* Number of entries in pids[]         */
+  uint8_t ninflight;                 /* Requests waiting for a response     */
+  uint8_t next;                      /* Round-robin start for sending       */
+  struct obd_pollpid_s pids[CONFIG_LIBOBD2_POLL_MAXPIDS];
+#ifdef CONFIG_LIBOBD2_MULTIFRAME
+  struct obd_isotp_s isotp[CONFIG_LIBOBD2_POLL_MAXECUS];
+#endif
+  struct obd_pollstats_s stats;
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: obd_poll_time
+ *
+ * Description:
+ *   Return the current time in msec.
+ *
+ ****************************************************************************/
+
+static uint32_t obd_poll_time(void)
+{
+  struct timespec ts;
+
+  clock_gettime(OBD_POLL_CLOCK, &ts);
+  return (uint32_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/****************************************************************************
+ * Name: obd_poll_find
+ *
+ * Description:
+ *   Return the entry for a polled PID or NULL.
+ *
+ ****************************************************************************/
+
+static FAR struct obd_pollpid_s *obd_poll_find(FAR struct obd_poll_s *poll,
+                                               uint8_t opmode, uint8_t pid)
+{
+  int i;
+
+  for (i = 0; i < poll->npids; i++)
+    {
+      if (poll->pids[i].opmode == opmode && poll->pids[i].pid == pid)
+        {
+          return &poll->pids[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: obd_poll_delete
+ *
+ * Description:
+ *   Remove an entry from the table.  The last entry takes its place.
+ *
+ ****************************************************************************/
+
+static void obd_poll_delete(FAR struct obd_poll_s *poll,
+                            FAR struct obd_pollpid_s *entry)
+{
+  if (entry->inflight)
+    {
+      poll->ninflight--;
+    }
+
+  poll->npids--;
+  *entry = poll->pids[poll->npids];
+
+  if (poll->next >= poll->npids)
+    {
+      poll->next = 0;
+    }
+}
+
+/****************************************************************************
+ * Name: obd_poll_deliver
+ *
+ * Description:
+ *   Pass a complete response payload (response mode, PID, data) to the
+ *   callback if it answers a polled PID.
+ *
+ ****************************************************************************/
+
+static void obd_poll_deliver(FAR struct obd_dev_s *dev, uint8_t ecu,
+                             FAR const uint8_t *data, size_t len,
+                             uint32_t now)
+{
+  FAR struct obd_poll_s *poll = dev->poll;
+  FAR struct obd_pollpid_s *entry;
+  uint8_t opmode;
+  uint8_t pid;
+  size_t ncopy;
+  uint32_t rtt;
+
+  if (len < 2 || data[0] < OBD_RESP_BASE)
+    {
+      return;
+    }
+
+  opmode = data[0] - OBD_RESP_BASE;
+  pid    = data[1];
+
+  /* Responses from further ECUs to a request that has already been
+   * answered are delivered as well, as long as the PID is still polled.
+   */
+
+  entry = obd_poll_find(poll, opmode, pid);
+  if (entry == NULL)
+    {
+      return;
+    }
+
+  if (entry->inflight)
+    {
+      rtt = now - entry->sent;
+      if (rtt > poll->stats.maxrtt)
+        {
+          poll->stats.maxrtt = rtt;
+        }
+
+      /* A PID that is only requested once stays in the table until the
+       * timeout so that the answers of further ECUs are still delivered.
+       */
+
+      entry->inflight = false;
+      entry->answered = entry->period == 0;
+      poll->ninflight--;
+    }
+
+  /* Leave the response where obd_decode_pid() expects it */
+
+  ncopy = len;
+  if (ncopy > sizeof(dev->data) - 1)
+    {
+      ncopy = sizeof(dev->data) - 1;
+    }
+
+  dev->data[0] = len < 8 ? OBD_SINGLE_FRAME | OBD_SF_DATA_LEN(len) :
+                 OBD_FIRST_FRAME | ((len >> 8) & 0x0f);
+  memcpy(&dev->data[1], data, ncopy);
+
+  poll->stats.responses++;
+  poll->callback(dev, poll->arg, ecu, opmode, pid, data, len);
+}
+
+/****************************************************************************
+ * Name: obd_poll_ecu
+ *
+ * Description:
+ *   Return the number of the ECU that sent a message, or OBD_POLL_NOECU if
+ *   it is not an OBD response.
+ *
+ ****************************************************************************/
+
+static uint8_t obd_poll_ecu(FAR struct obd_dev_s *dev,
+                            FAR const struct can_msg_s *msg)
+{
+#ifdef CONFIG_CAN_EXTID
+  if (dev->can_mode == CAN_EXT)
+    {
+      if (msg->cm_hdr.ch_extid &&
+          (msg->cm_hdr.ch_id & OBD_PID_EXT_RESPONSE_MASK) ==
+          OBD_PID_EXT_RESPONSE_BASE)
+        {
+          return msg->cm_hdr.ch_id & 0xff;
+        }
+
+      return OBD_POLL_NOECU;
+    }
+
+  if (msg->cm_hdr.ch_extid)
+    {
+      return OBD_POLL_NOECU;
+    }
+#endif
+
+  if (msg->cm_hdr.ch_id >= OBD_PID_STD_RESPONSE_FIRST &&
+      msg->cm_hdr.ch_id <= OBD_PID_STD_RESPONSE_LAST)
+    {
+      return msg->cm_hdr.ch_id - OBD_PID_STD_RESPONSE_FIRST;
+    }
+
+  return OBD_POLL_NOECU;
+}
+
+#ifdef CONFIG_LIBOBD2_MULTIFRAME
+/****************************************************************************
+ * Name: obd_poll_flowcontrol
+ *
+ * Description:
+ *   Tell an ECU that has sent a first frame to send all of the consecutive
+ *   frames without delay.
+ *
+ ****************************************************************************/
+
+static int obd_poll_flowcontrol(FAR struct obd_dev_s *dev, uint8_t ecu)
+{
+  int msgsize;
+  int nbytes;
+
+#ifdef CONFIG_CAN_EXTID
+  if (dev->can_mode == CAN_EXT)
+    {
+      dev->can_txmsg.cm_hdr.ch_id    = OBD_PID_EXT_ECU_REQUEST |
+                                       ((uint32_t)ecu << 8);
+      dev->can_txmsg.cm_hdr.ch_extid = true;
+    }
+  else
+    {
+      dev->can_txmsg.cm_hdr.ch_id    = OBD_PID_STD_ECU_REQUEST + ecu;
+      dev->can_txmsg.cm_hdr.ch_extid = false;
+    }
+#else
+  dev->can_txmsg.cm_hdr.ch_id     = OBD_PID_STD_ECU_REQUEST + ecu;
+#endif
+
+  dev->can_txmsg.cm_hdr.ch_rtr    = false;
+  dev->can_txmsg.cm_hdr.ch_dlc    = 8;
+  dev->can_txmsg.cm_hdr.ch_unused = 0;
+
+  /* Continue to send, no block size limit, no separation time */
+
+  memset(dev->can_txmsg.cm_data, 0, 8);
+  dev->can_txmsg.cm_data[0] = OBD_FLWCTRL_FRAME;
+
+  msgsize = CAN_MSGLEN(8);
+  nbytes  = write(dev->can_fd, &dev->can_txmsg, msgsize);
+  if (nbytes != msgsize)
+    {
+      return -EAGAIN;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: obd_poll_isotp
+ *
+ * Description:
+ *   Return the reassembly state for a response ID.  If "alloc" is true and
+ *   there is none, a free one is taken, or the one that has waited longest
+ *   for a frame.
+ *
+ ****************************************************************************/
+
+static FAR struct obd_isotp_s *obd_poll_isotp(FAR struct obd_poll_s *poll,
+                                              uint32_t canid, bool alloc)
+{
+  FAR struct obd_isotp_s *oldest = NULL;
+  FAR struct obd_isotp_s *isotp;
+  int i;
+
+  for (i = 0; i < CONFIG_LIBOBD2_POLL_MAXECUS; i++)
+    {
+      isotp = &poll->isotp[i];
+      if (isotp->canid == canid)
+        {
+          return isotp;
+        }
+
+      if (oldest == NULL ||
+          (oldest->canid != 0 &&
+           (isotp->canid == 0 ||
+            (int32_t)(isotp->updated - oldest->updated) < 0)))
+        {
+          oldest = isotp;
+        }
+    }
+
+  if (!alloc)
+    {
+      return NULL;
+    }
+
+  if (oldest->canid != 0)
+    {
+      poll->stats.errors++;
+    }
+
+  oldest->canid = canid;
+  return oldest;
+}
+
+/****************************************************************************
+ * Name: obd_poll_multiframe
+ *
+ * Description:
+ *   Handle a first or consecutive frame of a multi-frame response.
+ *
+ ****************************************************************************/
+
+static void obd_poll_multiframe(FAR struct obd_dev_s *dev, uint8_t ecu,
+                                FAR const struct can_msg_s *msg,
+                                uint32_t now)
+{
+  FAR struct obd_poll_s *poll = dev->poll;
+  FAR const uint8_t *data = msg->cm_data;
+  FAR struct obd_pollpid_s *entry;
+  FAR struct obd_isotp_s *isotp;
+  uint16_t len;
+  int ncopy;
+
+  if (OBD_FRAME_TYPE(data[0]) == OBD_FIRST_FRAME)
+    {
+      if (msg->cm_hdr.ch_dlc < 8)
+        {
+          return;
+        }
+
+      len = OBD_FF_DATA_LEN_D0(data[0]) | OBD_FF_DATA_LEN_D1(data[1]);
+      if (len < 8 || data[2] < OBD_RESP_BASE)
+        {
+          return;
+        }
+
+      /* Only reassemble responses to polled PIDs.  Restart the timeout of
+       * the request; the first frame shows that it is being answered.
+       */
+
+      entry = obd_poll_find(poll, data[2] - OBD_RESP_BASE, data[3]);
+      if (entry == NULL)
+        {
+          return;
+        }
+
+      if (entry->inflight)
+        {
+          entry->sent = now;
+        }
+
+      if (len > CONFIG_LIBOBD2_POLL_MAXLEN)
+        {
+          poll->stats.errors++;
+          return;
+        }
+
+      isotp = obd_poll_isotp(poll, msg->cm_hdr.ch_id, true);
+      isotp->updated = now;
+      isotp->len     = len;
+      isotp->got     = 6;
+      isotp->seq     = 1;
+      memcpy(isotp->buf, &data[2], 6);
+
+      if (obd_poll_flowcontrol(dev, ecu) < 0)
+        {
+          poll->stats.errors++;
+          isotp->canid = 0;
+        }
+    }
+  else
+    {
+      isotp = obd_poll_isotp(poll, msg->cm_hdr.ch_id, false);
+      if (isotp == NULL)
+        {
+          return;
+        }
+
+      if (OBD_CF_SEQ_NUM(data[0]) != isotp->seq)
+        {
+          poll->stats.errors++;
+          isotp->canid = 0;
+          return;
+        }
+
+      ncopy = isotp->len - isotp->got;
+      if (ncopy > msg->cm_hdr.ch_dlc - 1)
+        {
+          ncopy = msg->cm_hdr.ch_dlc - 1;
+        }
+
+      if (ncopy > 0)
+        {
+          memcpy(&isotp->buf[isotp->got], &data[1], ncopy);
+          isotp->got += ncopy;
+        }
+
+      isotp->seq     = (isotp->seq + 1) & 0x0f;
+      isotp->updated = now;
+
+      if (isotp->got >= isotp->len)
+        {
+          isotp->canid = 0;
+          obd_poll_deliver(dev, ecu, isotp->buf, isotp->len, now);
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: obd_poll_message
+ *
+ * Description:
+ *   Handle one received CAN message.
+ *
+ ****************************************************************************/
+
+static void obd_poll_message(FAR struct obd_dev_s *dev,
+                             FAR const struct can_msg_s *msg, uint32_t now)
+{
+  uint8_t ecu;
+  int len;
+
+  if (msg->cm_hdr.ch_rtr || msg->cm_hdr.ch_dlc < 1)
+    {
+      return;
+    }
+
+  ecu = obd_poll_ecu(dev, msg);
+  if (ecu == OBD_POLL_NOECU)
+    {
+      return;
+    }
+
+  switch (OBD_FRAME_TYPE(msg->cm_data[0]))
+    {
+      case OBD_SINGLE_FRAME:
+        len = OBD_SF_DATA_LEN(msg->cm_data[0]);
+        if (len > 0 && len < msg->cm_hdr.ch_dlc)
+          {
+            obd_poll_deliver(dev, ecu, &msg->cm_data[1], len, now);
+          }
+        break;
+
+#ifdef CONFIG_LIBOBD2_MULTIFRAME
+      case OBD_FIRST_FRAME:
+      case OBD_CONSEC_FRAME:
+        obd_poll_multiframe(dev, ecu, msg, now);
+        break;
+#endif
+
+      default:
+        break;
+    }
+}
+
+/****************************************************************************
+ * Name: obd_poll_receive
+ *
+ * Description:
+ *   Take the waiting messages from the CAN driver and handle them.
+ *
+ ****************************************************************************/
+
+static int obd_poll_receive(FAR struct obd_dev_s *dev, uint32_t now)
+{
+  struct can_msg_s rxbuf[OBD_POLL_RXBATCH];
+  FAR const uint8_t *ptr;
+  ssize_t nbytes;
+  size_t msglen;
+
+  nbytes = read(dev->can_fd, rxbuf, sizeof(rxbuf));
+  if (nbytes < 0)
+    {
+      return errno == EINTR || errno == EAGAIN ? OK : -errno;
+    }
+
+  /* The driver packs the messages, each only as long as its data */
+
+  ptr = (FAR const uint8_t *)rxbuf;
+  while (nbytes >= CAN_MSGLEN(0))
+    {
+      memcpy(&dev->can_rxmsg, ptr, CAN_MSGLEN(0));
+      msglen = CAN_MSGLEN(dev->can_rxmsg.cm_hdr.ch_dlc);
+      if (msglen > (size_t)nbytes)
+        {
+          break;
+        }
+
+      memcpy(&dev->can_rxmsg, ptr, msglen);
+      obd_poll_message(dev, &dev->can_rxmsg, now);
+
+      ptr    += msglen;
+      nbytes -= msglen;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: obd_poll_expire
+ *
+ * Description:
+ *   Report requests that have not been answered in time, retire answered
+ *   once only requests and abandon multi-frame responses that have stalled.
+ *
+ ****************************************************************************/
+
+static void obd_poll_expire(FAR struct obd_dev_s *dev, uint32_t now)
+{
+  FAR struct obd_poll_s *poll = dev->poll;
+  FAR struct obd_pollpid_s *entry;
+  uint8_t opmode;
+  uint8_t pid;
+  bool timedout;
+  int i;
+
+  for (i = 0; i < poll->npids; )
+    {
+      entry = &poll->pids[i];
+      if ((!entry->inflight && !entry->answered) ||
+          !OBD_POLL_DUE(entry->sent + CONFIG_LIBOBD2_POLL_TIMEOUT, now))
+        {
+          i++;
+          continue;
+        }
+
+      opmode   = entry->opmode;
+      pid      = entry->pid;
+      timedout = entry->inflight;
+
+      if (timedout)
+        {
+          entry->inflight = false;
+          poll->ninflight--;
+          poll->stats.timeouts++;
+        }
+
+      /* Once only requests are dropped; the last entry moves into this
+       * place, so look at the same index again.
+       */
+
+      if (entry->period == 0)
+        {
+          obd_poll_delete(poll, entry);
+        }
+      else
+        {
+          i++;
+        }
+
+      if (timedout)
+        {
+          poll->callback(dev, poll->arg, OBD_POLL_NOECU, opmode, pid,
+                         NULL, 0);
+        }
+    }
+
+#ifdef CONFIG_LIBOBD2_MULTIFRAME
+  for (i = 0; i < CONFIG_LIBOBD2_POLL_MAXECUS; i++)
+    {
+      if (poll->isotp[i].canid != 0 &&
+          OBD_POLL_DUE(poll->isotp[i].updated + CONFIG_LIBOBD2_POLL_TIMEOUT,
+                       now))
+        {
+          poll->stats.errors++;
+          poll->isotp[i].canid = 0;
+        }
+    }
+#endif
+}
+
+/****************************************************************************
+ * Name: obd_poll_send
+ *
+ * Description:
+ *   Send the requests that are due while there is room in flight.  The
+ *   table is scanned round-robin so that fast PIDs cannot starve the rest.
+ *
+ ****************************************************************************/
+
+static void obd_poll_send(FAR struct obd_dev_s *dev, uint32_t now)
+{
+  FAR struct obd_poll_s *poll = dev->poll;
+  FAR struct obd_pollpid_s *entry;
+  int index;
+  int n;
+
+  index = poll->next;
+  for (n = 0;
+       n < poll->npids && poll->ninflight < CONFIG_LIBOBD2_POLL_INFLIGHT;
+       n++)
+    {
+      entry = &poll->pids[index];
+      if (++index >= poll->npids)
+        {
+          index = 0;
+        }
+
+      if (entry->inflight || entry->answered ||
+          !OBD_POLL_DUE(entry->due, now))
+        {
+          continue;
+        }
+
+      if (obd_send_request(dev, entry->opmode, entry->pid) < 0)
+        {
+          /* Try again after a timeout rather than spin on a failing
+           * device.
+           */
+
+          poll->stats.errors++;
+          entry->due = now + CONFIG_LIBOBD2_POLL_TIMEOUT;
+          continue;
+        }
+
+      entry->inflight = true;
+      entry->sent     = now;
+      entry->due      = now + entry->period;
+      poll->ninflight++;
+      poll->stats.requests++;
+      poll->next      = index;
+    }
+}
+
+/****************************************************************************
+ * Name: obd_poll_wait
+ *
+ * Description:
+ *   Return the number of msec until the engine next has something to do,
+ *   limited to "limit".
+ *
+ ****************************************************************************/
+
+static int obd_poll_wait(FAR struct obd_poll_s *poll, uint32_t now,
+                         uint32_t limit)
+{
+  FAR struct obd_pollpid_s *entry;
+  uint32_t event;
+  uint32_t wait = limit;
+  int i;
+
+  for (i = 0; i < poll->npids; i++)
+    {
+      entry = &poll->pids[i];
+      if (entry->inflight || entry->answered)
+        {
+          event = entry->sent + CONFIG_LIBOBD2_POLL_TIMEOUT;
+        }
+      else if (poll->ninflight < CONFIG_LIBOBD2_POLL_INFLIGHT)
+        {
+          event = entry->due;
+        }
+      else
+        {
+          continue;
+        }
+
+      if (OBD_POLL_DUE(event, now))
+        {
+          return 0;
+        }
+
+      if (event - now < wait)
+        {
+          wait = event - now;
+        }
+    }
+
+#ifdef CONFIG_LIBOBD2_MULTIFRAME
+  for (i = 0; i < CONFIG_LIBOBD2_POLL_MAXECUS; i++)
+    {
+      if (poll->isotp[i].canid != 0)
+        {
+          event = poll->isotp[i].updated + CONFIG_LIBOBD2_POLL_TIMEOUT;
+          if (OBD_POLL_DUE(event, now))
+            {
+              return 0;
+            }
+
+          if (event - now < wait)
+            {
+              wait = event - now;
+            }
+        }
+    }
+#endif
+
+  return (int)wait;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: obd_poll_init
+ *
+ * Description:
+ *   Prepare the device for polling.
+ *
+ ****************************************************************************/
+
+int obd_poll_init(FAR struct obd_dev_s *dev, obd_pollcb_t callback,
+                  FAR void *arg)
+{
+  FAR struct obd_poll_s *poll;
+
+  if (callback == NULL)
+    {
+      return -EINVAL;
+    }
+
+  poll = (FAR struct obd_poll_s *)malloc(sizeof(struct obd_poll_s));
+  if (poll == NULL)
+    {
+      printf("ERROR: Failed to alloc memory for obd_poll!\n");
+      return -ENOMEM;
+    }
+
+  memset(poll, 0, sizeof(struct obd_poll_s));
+  poll->callback = callback;
+  poll->arg      = arg;
+
+  free(dev->poll);
+  dev->poll = poll;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: obd_poll_uninit
+ *
+ * Description:
+ *   Release the polling engine.
+ *
+ ****************************************************************************/
+
+void obd_poll_uninit(FAR struct obd_dev_s *dev)
+{
+  free(dev->poll);
+  dev->poll = NULL;
+}
+
+/****************************************************************************
+ * Name: obd_poll_add
+ *
+ * Description:
+ *   Poll a PID every "period" milliseconds, or only once if period is zero.
+ *
+ ****************************************************************************/
+
+int obd_poll_add(FAR struct obd_dev_s *dev, uint8_t opmode, uint8_t pid,
+                 unsigned int period)
+{
+  FAR struct obd_poll_s *poll = dev->poll;
+  FAR struct obd_pollpid_s *entry;
+
+  if (poll == NULL)
+    {
+      return -EINVAL;
+    }
+
+  entry = obd_poll_find(poll, opmode, pid);
+  if (entry == NULL)
+    {
+      if (poll->npids >= CONFIG_LIBOBD2_POLL_MAXPIDS)
+        {
+          return -ENOSPC;
+        }
+
+      entry = &poll->pids[poll->npids++];
+      entry->opmode   = opmode;
+      entry->pid      = pid;
+      entry->inflight = false;
+    }
+
+  entry->answered = false;
+  entry->period   = period;
+  entry->due      = obd_poll_time();
+  return OK;
+}
+
+/****************************************************************************
+ * Name: obd_poll_remove
+ *
+ * Description:
+ *   Stop polling a PID.
+ *
+ ****************************************************************************/
+
+int obd_poll_remove(FAR struct obd_dev_s *dev, uint8_t opmode, uint8_t pid)
+{
+  FAR struct obd_poll_s *poll = dev->poll;
+  FAR struct obd_pollpid_s *entry;
+
+  if (poll == NULL)
+    {
+      return -EINVAL;
+    }
+
+  entry = obd_poll_find(poll, opmode, pid);
+  if (entry == NULL)
+    {
+      return -ENOENT;
+    }
+
+  obd_poll_delete(poll, entry);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: obd_poll_run
+ *
+ * Description:
+ *   Run the polling engine for "msec" milliseconds.
+ *
+ ****************************************************************************/
+
+int obd_poll_run(FAR struct obd_dev_s *dev, unsigned int msec)
+{
+  struct pollfd pfd;
+  uint32_t start;
+  uint32_t now;
+  uint32_t elapsed;
+  int ret;
+
+  if (dev->poll == NULL)
+    {
+      return -EINVAL;
+    }
+
+  start = obd_poll_time();
+  for (; ; )
+    {
+      now = obd_poll_time();
+      obd_poll_expire(dev, now);
+      obd_poll_send(dev, now);
+
+      elapsed = now - start;
+      if (elapsed >= msec)
+        {
+          return OK;
+        }
+
+      /* Sleep until a response arrives or something else falls due */
+
+      pfd.fd      = dev->can_fd;
+      pfd.events  = POLLIN;
+      pfd.revents = 0;
+
+      ret = poll(&pfd, 1, obd_poll_wait(dev->poll, now, msec - elapsed));
+      if (ret < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          return -errno;
+        }
+
+      if (ret > 0 && (pfd.revents & POLLIN) != 0)
+        {
+          ret = obd_poll_receive(dev, obd_poll_time());
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: obd_poll_getstats
+ *
+ * Description:
+ *   Return the polling engine statistics.
+ *
+ ****************************************************************************/
+
+void obd_poll_getstats(FAR struct obd_dev_s *dev,
+                       FAR struct obd_pollstats_s *stats)
+{
+  if (dev->poll != NULL)
+    {
+      *stats = dev->poll->stats;
+    }
+  else
+    {
+      memset(stats, 0, sizeof(struct obd_pollstats_s));
+    }
+}
@@ -95,14 +95,14 @@ int obd_send_request(FAR struct obd_dev_s *dev, uint8_t opmode, uint8_t pid)
 
   if (extended)
     {
-      dev->can_txmsg.cm_hdr.ch_id     = OBD_PID_STD_REQUEST; /* MSG ID for PID Request */
-    }
-  else
-    {
 #ifdef CONFIG_CAN_EXTID
       dev->can_txmsg.cm_hdr.ch_id     = OBD_PID_EXT_REQUEST; /* MSG ID for PID Request */
 #endif
     }
+  else
+    {
+      dev->can_txmsg.cm_hdr.ch_id     = OBD_PID_STD_REQUEST; /* MSG ID for PID Request */
+    }
 
   dev->can_txmsg.cm_hdr.ch_rtr    = false;               /* Not a Remote Frame     */
   dev->can_txmsg.cm_hdr.ch_dlc    = msgdlc;              /* Data length is 8 bytes */
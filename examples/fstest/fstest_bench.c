@@ -0,0 +1,987 @@
+/****************************************************************************
+ * examples/fstest/fstest_bench.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+#include "testing/bench.h"
+
+#include "fstest.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_EXAMPLES_FSTEST_BENCH_MAXQD
+#  define CONFIG_EXAMPLES_FSTEST_BENCH_MAXQD 8
+#endif
+
+#ifndef CONFIG_EXAMPLES_FSTEST_BENCH_STACKSIZE
+#  define CONFIG_EXAMPLES_FSTEST_BENCH_STACKSIZE 2048
+#endif
+
+#define BENCH_DIRSIZE    (sizeof(CONFIG_EXAMPLES_FSTEST_MOUNTPT) + 32)
+#define BENCH_PATHSIZE   (BENCH_DIRSIZE + 24)
+#define BENCH_NSCANS     16
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bench_config_s
+{
+  FAR const char *label;        /* Free text label for the results */
+  size_t bs;                    /* Bytes per read or write */
+  off_t filesize;               /* Size of each sequential/random file */
+  uint32_t nops;                /* Random and fsync operations per worker */
+  uint32_t nfiles;              /* Files per worker for create/delete */
+  int qd;                       /* Queue depth: concurrent workers */
+  char dir[BENCH_DIRSIZE];      /* Directory holding the benchmark files */
+};
+
+struct bench_worker_s
+{
+  pthread_t thread;
+  FAR const struct bench_config_s *cfg;
+  FAR const struct bench_test_s *test;
+  FAR uint8_t *buffer;          /* bs byte I/O buffer */
+  uint32_t seed;                /* Private random number state */
+  int id;                       /* Worker number */
+  int result;                   /* OK or negated errno of first failure */
+  uint64_t nbytes;              /* Bytes transferred */
+  struct bench_hist_s hist;
+};
+
+struct bench_test_s
+{
+  FAR const char *name;
+  CODE int (*prepare)(FAR struct bench_worker_s *worker);
+  CODE int (*run)(FAR struct bench_worker_s *worker);
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int bench_prepfile(FAR struct bench_worker_s *worker);
+static int bench_prepfiles(FAR struct bench_worker_s *worker);
+static int bench_seqwrite(FAR struct bench_worker_s *worker);
+static int bench_seqread(FAR struct bench_worker_s *worker);
+static int bench_randwrite(FAR struct bench_worker_s *worker);
+static int bench_randread(FAR struct bench_worker_s *worker);
+static int bench_fsync(FAR struct bench_worker_s *worker);
+static int bench_create(FAR struct bench_worker_s *worker);
+static int bench_scan(FAR struct bench_worker_s *worker);
+static int bench_delete(FAR struct bench_worker_s *worker);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The tests, in the order in which they run.  Each test leaves behind what
+ * the next needs; prepare() creates it (untimed) if an earlier test was
+ * not selected.
+ */
+
+static const struct bench_test_s g_tests[] =
+{
+  { "seqwr",  NULL,            bench_seqwrite  },
+  { "seqrd",  bench_prepfile,  bench_seqread   },
+  { "rndwr",  bench_prepfile,  bench_randwrite },
+  { "rndrd",  bench_prepfile,  bench_randread  },
+  { "fsync",  NULL,            bench_fsync     },
+  { "create", NULL,            bench_create    },
+  { "scan",   bench_prepfiles, bench_scan      },
+  { "delete", bench_prepfiles, bench_delete    }
+};
+
+#define BENCH_NTESTS (sizeof(g_tests) / sizeof(struct bench_test_s))
+
+/* Merged histogram of all workers, kept off the stack */
+
+static struct bench_hist_s g_hist;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: bench_random
+ *
+ * Description:
+ *   xorshift32; rand() is not safe to share between the workers.
+ *
+ ****************************************************************************/
+
+static uint32_t bench_random(FAR struct bench_worker_s *worker)
+{
+  uint32_t x = worker->seed;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+
+  worker->seed = x;
+  return x;
+}
+
+/****************************************************************************
+ * Name: bench_path
+ *
+ * Description:
+ *   Name a benchmark file: <dir>/<prefix><worker>_<index>
+ *
+ ****************************************************************************/
+
+static void bench_path(FAR struct bench_worker_s *worker,
+                       FAR const char *prefix, uint32_t index,
+                       FAR char *path)
+{
+  snprintf(path, BENCH_PATHSIZE, "%s/%s%d_%lu", worker->cfg->dir, prefix,
+           worker->id, (unsigned long)index);
+}
+
+/****************************************************************************
+ * Name: bench_writeall and bench_readall
+ *
+ * Description:
+ *   Transfer exactly nbytes, retrying partial transfers.  Returns nbytes,
+ *   0 at end of file (read only), or a negated errno value.
+ *
+ ****************************************************************************/
+
+static ssize_t bench_writeall(int fd, FAR const uint8_t *buffer,
+                              size_t nbytes)
+{
+  ssize_t nwritten;
+  size_t ndone;
+
+  for (ndone = 0; ndone < nbytes; ndone += nwritten)
+    {
+      nwritten = write(fd, &buffer[ndone], nbytes - ndone);
+      if (nwritten < 0)
+        {
+          if (errno == EINTR)
+            {
+              nwritten = 0;
+              continue;
+            }
+
+          return -errno;
+        }
+    }
+
+  return nbytes;
+}
+
+static ssize_t bench_readall(int fd, FAR uint8_t *buffer, size_t nbytes)
+{
+  ssize_t nread;
+  size_t ndone;
+
+  for (ndone = 0; ndone < nbytes; ndone += nread)
+    {
+      nread = read(fd, &buffer[ndone], nbytes - ndone);
+      if (nread < 0)
+        {
+          if (errno == EINTR)
+            {
+              nread = 0;
+              continue;
+            }
+
+          return -errno;
+        }
+      else if (nread == 0)
+        {
+          break;
+        }
+    }
+
+  return ndone;
+}
+
+/****************************************************************************
+ * Name: bench_open
+ ****************************************************************************/
+
+static int bench_open(FAR struct bench_worker_s *worker,
+                      FAR const char *prefix, int oflags)
+{
+  char path[BENCH_PATHSIZE];
+  int fd;
+
+  bench_path(worker, prefix, 0, path);
+
+  fd = open(path, oflags, 0666);
+  if (fd < 0)
+    {
+      return -errno;
+    }
+
+  return fd;
+}
+
+/****************************************************************************
+ * Name: bench_seqwrite
+ *
+ * Description:
+ *   Write the worker's data file from start to end, bs bytes at a time.
+ *   This is also the prepare step of the read and random tests.
+ *
+ ****************************************************************************/
+
+static int bench_seqwrite(FAR struct bench_worker_s *worker)
+{
+  FAR const struct bench_config_s *cfg = worker->cfg;
+  uint64_t start;
+  ssize_t ret;
+  off_t offset;
+  int fd;
+
+  fd = bench_open(worker, "data", O_WRONLY | O_CREAT | O_TRUNC);
+  if (fd < 0)
+    {
+      return fd;
+    }
+
+  for (offset = 0; offset < cfg->filesize; offset += cfg->bs)
+    {
+      start = bench_usec();
+      ret   = bench_writeall(fd, worker->buffer, cfg->bs);
+      if (ret < 0)
+        {
+          close(fd);
+          return ret;
+        }
+
+      bench_hist_record(&worker->hist, start);
+      worker->nbytes += cfg->bs;
+    }
+
+  close(fd);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bench_prepfile
+ *
+ * Description:
+ *   Make sure that the worker's data file exists at full size.  Any
+ *   writes done here are not counted.
+ *
+ ****************************************************************************/
+
+static int bench_prepfile(FAR struct bench_worker_s *worker)
+{
+  char path[BENCH_PATHSIZE];
+  struct stat buf;
+
+  bench_path(worker, "data", 0, path);
+  if (stat(path, &buf) == 0 && buf.st_size >= worker->cfg->filesize)
+    {
+      return OK;
+    }
+
+  return bench_seqwrite(worker);
+}
+
+/****************************************************************************
+ * Name: bench_seqread
+ ****************************************************************************/
+
+static int bench_seqread(FAR struct bench_worker_s *worker)
+{
+  FAR const struct bench_config_s *cfg = worker->cfg;
+  uint64_t start;
+  ssize_t ret;
+  off_t offset;
+  int fd;
+
+  fd = bench_open(worker, "data", O_RDONLY);
+  if (fd < 0)
+    {
+      return fd;
+    }
+
+  for (offset = 0; offset < cfg->filesize; offset += cfg->bs)
+    {
+      start = bench_usec();
+      ret   = bench_readall(fd, worker->buffer, cfg->bs);
+      if (ret <= 0)
+        {
+          close(fd);
+          return ret < 0 ? ret : -ENODATA;
+        }
+
+      bench_hist_record(&worker->hist, start);
+      worker->nbytes += ret;
+    }
+
+  close(fd);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bench_randio
+ *
+ * Description:
+ *   nops reads or writes of bs bytes at random, bs aligned offsets within
+ *   the worker's data file.  The seek is part of the operation.
+ *
+ ****************************************************************************/
+
+static int bench_randio(FAR struct bench_worker_s *worker, bool write)
+{
+  FAR const struct bench_config_s *cfg = worker->cfg;
+  uint32_t nslots = cfg->filesize / cfg->bs;
+  uint64_t start;
+  uint32_t op;
+  ssize_t ret = OK;
+  off_t offset;
+  int fd;
+
+  fd = bench_open(worker, "data", write ? O_WRONLY : O_RDONLY);
+  if (fd < 0)
+    {
+      return fd;
+    }
+
+  for (op = 0; op < cfg->nops; op++)
+    {
+      offset = (off_t)(bench_random(worker) % nslots) * cfg->bs;
+      start  = bench_usec();
+
+      if (lseek(fd, offset, SEEK_SET) < 0)
+        {
+          ret = -errno;
+          break;
+        }
+
+      if (write)
+        {
+          ret = bench_writeall(fd, worker->buffer, cfg->bs);
+        }
+      else
+        {
+          ret = bench_readall(fd, worker->buffer, cfg->bs);
+          if (ret == 0)
+            {
+              ret = -ENODATA;
+            }
+        }
+
+      if (ret < 0)
+        {
+          break;
+        }
+
+      bench_hist_record(&worker->hist, start);
+      worker->nbytes += ret;
+      ret = OK;
+    }
+
+  close(fd);
+  return ret;
+}
+
+static int bench_randwrite(FAR struct bench_worker_s *worker)
+{
+  return bench_randio(worker, true);
+}
+
+static int bench_randread(FAR struct bench_worker_s *worker)
+{
+  return bench_randio(worker, false);
+}
+
+/****************************************************************************
+ * Name: bench_fsync
+ *
+ * Description:
+ *   nops appends of bs bytes, each followed by fsync(), as a log or a
+ *   database journal would do.
+ *
+ ****************************************************************************/
+
+static int bench_fsync(FAR struct bench_worker_s *worker)
+{
+  FAR const struct bench_config_s *cfg = worker->cfg;
+  uint64_t start;
+  uint32_t op;
+  ssize_t ret = OK;
+  int fd;
+
+  fd = bench_open(worker, "sync", O_WRONLY | O_CREAT | O_TRUNC);
+  if (fd < 0)
+    {
+      return fd;
+    }
+
+  for (op = 0; op < cfg->nops; op++)
+    {
+      start = bench_usec();
+
+      ret = bench_writeall(fd, worker->buffer, cfg->bs);
+      if (ret < 0)
+        {
+          break;
+        }
+
+      if (fsync(fd) < 0)
+        {
+          ret = -errno;
+          break;
+        }
+
+      bench_hist_record(&worker->hist, start);
+      worker->nbytes += cfg->bs;
+      ret = OK;
+    }
+
+  close(fd);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: bench_create
+ *
+ * Description:
+ *   Create nfiles empty files.  Each operation is an open() with O_CREAT
+ *   and the close().
+ *
+ ****************************************************************************/
+
+static int bench_create(FAR struct bench_worker_s *worker)
+{
+  char path[BENCH_PATHSIZE];
+  uint64_t start;
+  uint32_t index;
+  int fd;
+
+  for (index = 0; index < worker->cfg->nfiles; index++)
+    {
+      bench_path(worker, "f", index, path);
+
+      start = bench_usec();
+      fd    = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (fd < 0)
+        {
+          return -errno;
+        }
+
+      close(fd);
+      bench_hist_record(&worker->hist, start);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bench_prepfiles
+ *
+ * Description:
+ *   Make sure that the files of the create test exist.
+ *
+ ****************************************************************************/
+
+static int bench_prepfiles(FAR struct bench_worker_s *worker)
+{
+  char path[BENCH_PATHSIZE];
+  struct stat buf;
+
+  bench_path(worker, "f", worker->cfg->nfiles - 1, path);
+  if (stat(path, &buf) == 0)
+    {
+      return OK;
+    }
+
+  return bench_create(worker);
+}
+
+/****************************************************************************
+ * Name: bench_scan
+ *
+ * Description:
+ *   List the benchmark directory BENCH_NSCANS times.  Each operation is a
+ *   complete opendir()/readdir()/closedir() pass.
+ *
+ ****************************************************************************/
+
+static int bench_scan(FAR struct bench_worker_s *worker)
+{
+  FAR struct dirent *entry;
+  FAR DIR *dirp;
+  uint64_t start;
+  int scan;
+
+  for (scan = 0; scan < BENCH_NSCANS; scan++)
+    {
+      start = bench_usec();
+
+      dirp = opendir(worker->cfg->dir);
+      if (dirp == NULL)
+        {
+          return -errno;
+        }
+
+      do
+        {
+          entry = readdir(dirp);
+        }
+      while (entry != NULL);
+
+      closedir(dirp);
+      bench_hist_record(&worker->hist, start);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bench_delete
+ *
+ * Description:
+ *   Remove the files made by the create test, one unlink() per operation.
+ *
+ ****************************************************************************/
+
+static int bench_delete(FAR struct bench_worker_s *worker)
+{
+  char path[BENCH_PATHSIZE];
+  uint64_t start;
+  uint32_t index;
+
+  for (index = 0; index < worker->cfg->nfiles; index++)
+    {
+      bench_path(worker, "f", index, path);
+
+      start = bench_usec();
+      if (unlink(path) < 0)
+        {
+          return -errno;
+        }
+
+      bench_hist_record(&worker->hist, start);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bench_thread
+ ****************************************************************************/
+
+static FAR void *bench_thread(FAR void *arg)
+{
+  FAR struct bench_worker_s *worker = (FAR struct bench_worker_s *)arg;
+
+  worker->result = worker->test->run(worker);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: bench_runtest
+ *
+ * Description:
+ *   Run one test with cfg->qd concurrent workers and print its result
+ *   line.
+ *
+ ****************************************************************************/
+
+static int bench_runtest(FAR const struct bench_config_s *cfg,
+                         FAR const struct bench_test_s *test,
+                         FAR struct bench_worker_s *workers)
+{
+  bool started[CONFIG_EXAMPLES_FSTEST_BENCH_MAXQD];
+  FAR struct bench_hist_s *hist = &g_hist;
+  pthread_attr_t attr;
+  uint64_t nbytes;
+  uint64_t start;
+  uint64_t usec;
+  int result = OK;
+  int ret;
+  int i;
+
+  /* Prepare and reset each worker */
+
+  for (i = 0; i < cfg->qd; i++)
+    {
+      workers[i].test = test;
+      workers[i].seed = 0x93846 + i;
+      workers[i].result = OK;
+
+      if (test->prepare != NULL)
+        {
+          ret = test->prepare(&workers[i]);
+          if (ret < 0)
+            {
+              fprintf(stderr, "ERROR: %s prepare failed: %d\n",
+                      test->name, ret);
+              return ret;
+            }
+        }
+
+      memset(&workers[i].hist, 0, sizeof(struct bench_hist_s));
+      workers[i].nbytes = 0;
+    }
+
+  /* Queue depth one runs in-line; otherwise one thread per request kept
+   * in flight.
+   */
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, CONFIG_EXAMPLES_FSTEST_BENCH_STACKSIZE);
+
+  start = bench_usec();
+
+  if (cfg->qd == 1)
+    {
+      bench_thread(&workers[0]);
+    }
+  else
+    {
+      for (i = 0; i < cfg->qd; i++)
+        {
+          ret = pthread_create(&workers[i].thread, &attr, bench_thread,
+                               &workers[i]);
+          started[i] = (ret == 0);
+          if (ret != 0)
+            {
+              workers[i].result = -ret;
+            }
+        }
+
+      for (i = 0; i < cfg->qd; i++)
+        {
+          if (started[i])
+            {
+              pthread_join(workers[i].thread, NULL);
+            }
+        }
+    }
+
+  usec = bench_usec() - start;
+  pthread_attr_destroy(&attr);
+
+  /* Merge the workers' results */
+
+  memset(hist, 0, sizeof(struct bench_hist_s));
+  nbytes = 0;
+
+  for (i = 0; i < cfg->qd; i++)
+    {
+      bench_hist_merge(hist, &workers[i].hist);
+      nbytes += workers[i].nbytes;
+
+      if (workers[i].result < 0 && result == OK)
+        {
+          result = workers[i].result;
+        }
+    }
+
+  if (usec == 0)
+    {
+      usec = 1;
+    }
+
+  printf("%s,%s,%lu,%d,%lu,%d,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+         cfg->label, test->name, (unsigned long)cfg->bs, cfg->qd,
+         (unsigned long)hist->nops, result,
+         (unsigned long)nbytes, (unsigned long)usec,
+         (unsigned long)(nbytes * 1000000 / 1024 / usec),
+         (unsigned long)((uint64_t)hist->nops * 1000000 / usec),
+         (unsigned long)bench_hist_percentile(hist, 500),
+         (unsigned long)bench_hist_percentile(hist, 900),
+         (unsigned long)bench_hist_percentile(hist, 990),
+         (unsigned long)bench_hist_percentile(hist, 999),
+         (unsigned long)hist->max);
+  fflush(stdout);
+
+  if (result < 0)
+    {
+      fprintf(stderr, "ERROR: %s failed: %d\n", test->name, result);
+    }
+
+  return result;
+}
+
+/****************************************************************************
+ * Name: bench_cleanup
+ *
+ * Description:
+ *   Remove everything that the benchmark created.
+ *
+ ****************************************************************************/
+
+static void bench_cleanup(FAR const struct bench_config_s *cfg,
+                          FAR struct bench_worker_s *workers)
+{
+  char path[BENCH_PATHSIZE];
+  uint32_t index;
+  int i;
+
+  for (i = 0; i < cfg->qd; i++)
+    {
+      bench_path(&workers[i], "data", 0, path);
+      (void)unlink(path);
+      bench_path(&workers[i], "sync", 0, path);
+      (void)unlink(path);
+
+      for (index = 0; index < cfg->nfiles; index++)
+        {
+          bench_path(&workers[i], "f", index, path);
+          (void)unlink(path);
+        }
+    }
+
+  (void)rmdir(cfg->dir);
+}
+
+/****************************************************************************
+ * Name: bench_showusage
+ ****************************************************************************/
+
+static void bench_showusage(void)
+{
+  unsigned int i;
+
+  fprintf(stderr, "USAGE: fstest -b [-t <test>[,<test>...]] [-s <bs>] "
+          "[-S <filesize>] [-q <qd>]\n"
+          "                 [-n <ops>] [-N <files>] [-l <label>] "
+          "[-d <dir>]\n");
+  fprintf(stderr, "  -t  Tests to run (default: all):");
+  for (i = 0; i < BENCH_NTESTS; i++)
+    {
+      fprintf(stderr, " %s", g_tests[i].name);
+    }
+
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  -s  Bytes per read/write (default: 512)\n");
+  fprintf(stderr, "  -S  Data file size per worker (default: 65536)\n");
+  fprintf(stderr, "  -q  Queue depth, concurrent workers (default: 1, "
+          "max: %d)\n", CONFIG_EXAMPLES_FSTEST_BENCH_MAXQD);
+  fprintf(stderr, "  -n  Random and fsync operations per worker "
+          "(default: 256)\n");
+  fprintf(stderr, "  -N  Files per worker for create/scan/delete "
+          "(default: 64)\n");
+  fprintf(stderr, "  -l  Label for the result lines (default: fs)\n");
+  fprintf(stderr, "  -d  Directory to use (default: %s/bench)\n",
+          CONFIG_EXAMPLES_FSTEST_MOUNTPT);
+}
+
+/****************************************************************************
+ * Name: bench_selected
+ ****************************************************************************/
+
+static bool bench_selected(FAR const char *list, FAR const char *name)
+{
+  size_t len = strlen(name);
+  FAR const char *ptr;
+
+  if (list == NULL)
+    {
+      return true;
+    }
+
+  for (ptr = list; (ptr = strstr(ptr, name)) != NULL; ptr += len)
+    {
+      if ((ptr == list || ptr[-1] == ',') &&
+          (ptr[len] == '\0' || ptr[len] == ','))
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fstest_benchmark
+ *
+ * Description:
+ *   Run the benchmark mode, "fstest -b [options]".  One CSV line is
+ *   printed per test after a header line naming the columns.  Throughput
+ *   is in KiB/s and the latency percentiles in microseconds; result is
+ *   zero or the negated errno of the first failure.
+ *
+ ****************************************************************************/
+
+int fstest_benchmark(int argc, FAR char *argv[])
+{
+  FAR struct bench_worker_s *workers;
+  struct bench_config_s cfg;
+  FAR const char *tests = NULL;
+  unsigned int i;
+  int option;
+  int ret = OK;
+
+  memset(&cfg, 0, sizeof(struct bench_config_s));
+  cfg.label    = "fs";
+  cfg.bs       = 512;
+  cfg.filesize = 65536;
+  cfg.nops     = 256;
+  cfg.nfiles   = 64;
+  cfg.qd       = 1;
+  snprintf(cfg.dir, sizeof(cfg.dir), "%s/bench",
+           CONFIG_EXAMPLES_FSTEST_MOUNTPT);
+
+  while ((option = getopt(argc, argv, "t:s:S:q:n:N:l:d:")) != ERROR)
+    {
+      switch (option)
+        {
+          case 't':
+            tests = optarg;
+            break;
+
+          case 's':
+            cfg.bs = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'S':
+            cfg.filesize = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'q':
+            cfg.qd = atoi(optarg);
+            break;
+
+          case 'n':
+            cfg.nops = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'N':
+            cfg.nfiles = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'l':
+            cfg.label = optarg;
+            break;
+
+          case 'd':
+            snprintf(cfg.dir, sizeof(cfg.dir), "%s", optarg);
+            break;
+
+          default:
+            bench_showusage();
+            return EXIT_FAILURE;
+        }
+    }
+
+  if (optind != argc || cfg.bs == 0 || cfg.filesize < (off_t)cfg.bs ||
+      cfg.nfiles == 0 || cfg.qd < 1 ||
+      cfg.qd > CONFIG_EXAMPLES_FSTEST_BENCH_MAXQD)
+    {
+      bench_showusage();
+      return EXIT_FAILURE;
+    }
+
+  if (mkdir(cfg.dir, 0777) < 0 && errno != EEXIST)
+    {
+      fprintf(stderr, "ERROR: Failed to create %s: %d\n", cfg.dir, errno);
+      return EXIT_FAILURE;
+    }
+
+  workers = (FAR struct bench_worker_s *)
+    calloc(cfg.qd, sizeof(struct bench_worker_s));
+  if (workers == NULL)
+    {
+      fprintf(stderr, "ERROR: Failed to allocate workers\n");
+      return EXIT_FAILURE;
+    }
+
+  for (i = 0; i < (unsigned int)cfg.qd; i++)
+    {
+      workers[i].cfg    = &cfg;
+      workers[i].id     = i;
+      workers[i].buffer = (FAR uint8_t *)malloc(cfg.bs);
+      if (workers[i].buffer == NULL)
+        {
+          fprintf(stderr, "ERROR: Failed to allocate I/O buffers\n");
+          ret = -ENOMEM;
+          goto errout;
+        }
+
+      memset(workers[i].buffer, 0x5a + i, cfg.bs);
+    }
+
+  printf("label,test,bs,qd,ops,result,bytes,usec,kibps,iops,"
+         "p50,p90,p99,p999,max\n");
+
+  for (i = 0; i < BENCH_NTESTS; i++)
+    {
+      if (bench_selected(tests, g_tests[i].name))
+        {
+          ret = bench_runtest(&cfg, &g_tests[i], workers);
+          if (ret < 0)
+            {
+              break;
+            }
+        }
+    }
+
+errout:
+  bench_cleanup(&cfg, workers);
+
+  for (i = 0; i < (unsigned int)cfg.qd; i++)
+    {
+      free(workers[i].buffer);
+    }
+
+  free(workers);
+  return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -54,6 +54,8 @@
 #include <crc32.h>
 #include <debug.h>
 
+#include "fstest.h"
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -961,6 +963,15 @@ int fstest_main(int argc, char *argv[])
   unsigned int i;
   int ret;
 
+#ifdef CONFIG_EXAMPLES_FSTEST_BENCHMARK
+  /* "fstest -b ..." runs the benchmark instead of the stress test */
+
+  if (argc > 1 && strcmp(argv[1], "-b") == 0)
+    {
+      return fstest_benchmark(argc - 1, &argv[1]);
+    }
+#endif
+
   /* Seed the random number generated */
 
   srand(0x93846);
@@ -43,6 +43,7 @@
 #include <nuttx/config.h>
 #include <nuttx/compiler.h>
 
+#include <stdint.h>
 #include <stdio.h>
 #include <debug.h>
 
@@ -97,6 +98,10 @@
 #  endif
 #endif
 
+/* The path at which the mock device is registered */
+
+#define FT80X_MOCK_DEVPATH "/dev/ft80xmock"
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -172,6 +177,13 @@ int ft80x_coproc_screensaver(int fd, FAR struct ft80x_dlbuffer_s *buffer);
 #endif
 int ft80x_coproc_logo(int fd, FAR struct ft80x_dlbuffer_s *buffer);
 
+#ifdef CONFIG_EXAMPLES_FT80X_MOCK
+/* Mock device for the benchmark */
+
+int ft80x_mock_register(FAR const char *devpath);
+uint64_t ft80x_mock_usec(void);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -48,8 +48,23 @@
 #include <nuttx/lcd/ft80x.h>
 
 #include "graphics/ft80x.h"
+#include "testing/bench.h"
 #include "ft80x.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The mock device reports the time that the real device would have taken */
+
+#ifdef CONFIG_EXAMPLES_FT80X_MOCK
+#  define FT80X_DEVPATH     FT80X_MOCK_DEVPATH
+#  define ft80x_bench_usec  ft80x_mock_usec
+#else
+#  define FT80X_DEVPATH     CONFIG_EXAMPLES_FT80X_DEVPATH
+#  define ft80x_bench_usec  bench_usec
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -156,6 +171,28 @@ static const struct ft80x_exampleinfo_s g_coproc[] =
 
 #define NCOPROC (sizeof(g_coproc) / sizeof(struct ft80x_exampleinfo_s))
 
+#ifdef CONFIG_EXAMPLES_FT80X_BENCHMARK
+/* Co-processor examples that render a single frame without delays.  These
+ * are used to measure the frame rate.
+ */
+
+static const struct ft80x_exampleinfo_s g_benchmarks[] =
+{
+  { "Button",         ft80x_coproc_button },
+  { "Clock",          ft80x_coproc_clock },
+  { "Gauge",          ft80x_coproc_gauge },
+  { "Keys",           ft80x_coproc_keys },
+  { "Progress Bar",   ft80x_coproc_progressbar },
+  { "Scroll Bar",     ft80x_coproc_scrollbar },
+  { "Slider",         ft80x_coproc_slider },
+  { "Dial",           ft80x_coproc_dial },
+  { "Toggle",         ft80x_coproc_toggle },
+  { "Number",         ft80x_coproc_number }
+};
+
+#define NBENCHMARKS (sizeof(g_benchmarks) / sizeof(struct ft80x_exampleinfo_s))
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -280,6 +317,61 @@ static int ft80x_example(int fd, FAR struct ft80x_dlbuffer_s *buffer,
   return OK;
 }
 
+#ifdef CONFIG_EXAMPLES_FT80X_BENCHMARK
+/****************************************************************************
+ * Name: ft80x_benchmark
+ *
+ * Description:
+ *   Render one example CONFIG_EXAMPLES_FT80X_BENCHMARK_FRAMES times and
+ *   report the frame rate.  The time includes waiting for the co-processor
+ *   to execute the last frame.
+ *
+ ****************************************************************************/
+
+static int ft80x_benchmark(int fd, FAR struct ft80x_dlbuffer_s *buffer,
+                           FAR const struct ft80x_exampleinfo_s *example)
+{
+  unsigned long elapsed;
+  uint64_t start;
+  int ret;
+  int i;
+
+  start = ft80x_bench_usec();
+
+  for (i = 0; i < CONFIG_EXAMPLES_FT80X_BENCHMARK_FRAMES; i++)
+    {
+      ret = example->func(fd, buffer);
+      if (ret < 0)
+        {
+          ft80x_err("ERROR: \"%s\" example failed: %d\n",
+                    example->name, ret);
+          return ret;
+        }
+    }
+
+  /* Wait for the co-processor to finish the last frame */
+
+  ret = ft80x_dl_flush(fd, buffer, true);
+  if (ret < 0)
+    {
+      ft80x_err("ERROR: ft80x_dl_flush failed: %d\n", ret);
+      return ret;
+    }
+
+  elapsed = (unsigned long)((ft80x_bench_usec() - start) / 1000);
+  if (elapsed == 0)
+    {
+      elapsed = 1;
+    }
+
+  printf("%-14s %4d frames %6lu msec %6lu.%lu FPS\n",
+         example->name, CONFIG_EXAMPLES_FT80X_BENCHMARK_FRAMES, elapsed,
+         (CONFIG_EXAMPLES_FT80X_BENCHMARK_FRAMES * 1000UL) / elapsed,
+         ((CONFIG_EXAMPLES_FT80X_BENCHMARK_FRAMES * 10000UL) / elapsed) % 10);
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -298,14 +390,24 @@ int ft80x_main(int argc, char *argv[])
   int fd;
   int i;
 
+#ifdef CONFIG_EXAMPLES_FT80X_MOCK
+  /* Register the mock device.  It is left registered for the next run. */
+
+  fd = ft80x_mock_register(FT80X_DEVPATH);
+  if (fd < 0 && fd != -EEXIST)
+    {
+      ft80x_err("ERROR: Failed to register %s: %d\n", FT80X_DEVPATH, fd);
+      return EXIT_FAILURE;
+    }
+#endif
+
   /* Open the configured FT80x device */
 
-  fd = open(CONFIG_EXAMPLES_FT80X_DEVPATH, O_WRONLY);
+  fd = open(FT80X_DEVPATH, O_WRONLY);
   if (fd < 0)
     {
       int errcode = errno;
-      ft80x_err("ERROR: Failed to open %s: %d\n",
-                CONFIG_EXAMPLES_FT80X_DEVPATH, errcode);
+      ft80x_err("ERROR: Failed to open %s: %d\n", FT80X_DEVPATH, errcode);
       UNUSED(errcode);
       return EXIT_FAILURE;
     }
@@ -313,7 +415,7 @@ int ft80x_main(int argc, char *argv[])
   /* Allocate the display list buffer structure */
 
   buffer = (FAR struct ft80x_dlbuffer_s *)
-    malloc(sizeof(struct ft80x_dlbuffer_s));
+    zalloc(sizeof(struct ft80x_dlbuffer_s));
 
   if (buffer == NULL)
     {
@@ -322,6 +424,20 @@ int ft80x_main(int argc, char *argv[])
       return EXIT_FAILURE;
     }
 
+#ifdef CONFIG_EXAMPLES_FT80X_BENCHMARK
+  /* Measure the frame rate of the static co-processor examples */
+
+  (void)ft80x_backlight_set(fd, 100);
+
+  for (i = 0; i < NBENCHMARKS; i++)
+    {
+      (void)ft80x_benchmark(fd, buffer, &g_benchmarks[i]);
+    }
+
+  (void)ft80x_backlight_set(fd, 0);
+#endif
+
+#ifndef CONFIG_EXAMPLES_FT80X_MOCK
 #ifdef CONFIG_EXAMPLES_FT80X_PRIMITIVES
   /* Perform tests on a few of the FT80x primitive functions */
 
@@ -341,6 +457,7 @@ int ft80x_main(int argc, char *argv[])
     {
       (void)ft80x_example(fd, buffer, &g_coproc[i]);
     }
+#endif /* CONFIG_EXAMPLES_FT80X_MOCK */
 
   free(buffer);
   close(fd);
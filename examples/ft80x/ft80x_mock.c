@@ -0,0 +1,435 @@
+/****************************************************************************
+ * examples/ft80x/ft80x_mock.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <signal.h>
+#include <errno.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/lcd/ft80x.h>
+
+#include "graphics/ft80x.h"
+#include "ft80x.h"
+
+#ifdef CONFIG_EXAMPLES_FT80X_MOCK
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MOCK_CMDFIFO_MASK  (FT80X_CMDFIFO_SIZE - 1)
+
+/* The number of other registers remembered */
+
+#define MOCK_NREGS         16
+
+/* Each SPI access sends a 3 byte address; reads add a dummy byte */
+
+#define MOCK_WRADDR_BYTES  3
+#define MOCK_RDADDR_BYTES  4
+
+/* Time (nsec) for the co-processor to execute 'n' bytes of commands */
+
+#define MOCK_CMD_NSEC(n) \
+  ((uint64_t)(n) * 1000000 / CONFIG_EXAMPLES_FT80X_MOCK_CMDRATE)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct ft80x_mockreg_s
+{
+  uint32_t addr;
+  uint32_t value;
+};
+
+struct ft80x_mock_s
+{
+  uint64_t nsec;                /* Modelled time */
+  uint64_t synctime;            /* Time at which cmdread was last valid */
+  uint16_t cmdread;             /* REG_CMD_READ */
+  uint16_t cmdwrite;            /* REG_CMD_WRITE */
+  uint8_t nregs;                /* Number of entries in regs[] */
+  struct ft80x_mockreg_s regs[MOCK_NREGS];
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static ssize_t ft80x_mock_write(FAR struct file *filep,
+                                FAR const char *buffer, size_t buflen);
+static int ft80x_mock_ioctl(FAR struct file *filep, int cmd,
+                            unsigned long arg);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct file_operations g_ft80x_mock_fops =
+{
+  0,                 /* open */
+  0,                 /* close */
+  0,                 /* read */
+  ft80x_mock_write,  /* write */
+  0,                 /* seek */
+  ft80x_mock_ioctl   /* ioctl */
+#ifndef CONFIG_DISABLE_POLL
+  , 0                /* poll */
+#endif
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+  , 0                /* unlink */
+#endif
+};
+
+static struct ft80x_mock_s g_ft80x_mock;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ft80x_mock_spi
+ *
+ * Description:
+ *   Account for one SPI access of 'nbytes' bytes, including the address.
+ *
+ ****************************************************************************/
+
+static void ft80x_mock_spi(size_t nbytes)
+{
+  g_ft80x_mock.nsec += CONFIG_EXAMPLES_FT80X_MOCK_XFERNSEC +
+                       (uint64_t)nbytes * 8 * 1000000 /
+                       CONFIG_EXAMPLES_FT80X_MOCK_SPIFREQ;
+}
+
+/****************************************************************************
+ * Name: ft80x_mock_coproc
+ *
+ * Description:
+ *   Advance REG_CMD_READ to the current time.  The co-processor executes
+ *   whole command words at CONFIG_EXAMPLES_FT80X_MOCK_CMDRATE bytes per
+ *   millisecond and is idle while the FIFO is empty.
+ *
+ ****************************************************************************/
+
+static void ft80x_mock_coproc(void)
+{
+  FAR struct ft80x_mock_s *priv = &g_ft80x_mock;
+  uint64_t consumed;
+  uint16_t pending;
+
+  pending  = (priv->cmdwrite - priv->cmdread) & MOCK_CMDFIFO_MASK;
+  consumed = (priv->nsec - priv->synctime) *
+             CONFIG_EXAMPLES_FT80X_MOCK_CMDRATE / 1000000;
+  consumed &= ~(uint64_t)3;
+
+  if (consumed >= pending)
+    {
+      priv->cmdread  = priv->cmdwrite;
+      priv->synctime = priv->nsec;
+    }
+  else
+    {
+      priv->cmdread   = (priv->cmdread + consumed) & MOCK_CMDFIFO_MASK;
+      priv->synctime += MOCK_CMD_NSEC(consumed);
+    }
+}
+
+/****************************************************************************
+ * Name: ft80x_mock_getreg
+ ****************************************************************************/
+
+static uint32_t ft80x_mock_getreg(uint32_t addr)
+{
+  FAR struct ft80x_mock_s *priv = &g_ft80x_mock;
+  int i;
+
+  if (addr == FT80X_REG_CMD_READ)
+    {
+      ft80x_mock_coproc();
+      return priv->cmdread;
+    }
+  else if (addr == FT80X_REG_CMD_WRITE)
+    {
+      return priv->cmdwrite;
+    }
+
+  for (i = 0; i < priv->nregs; i++)
+    {
+      if (priv->regs[i].addr == addr)
+        {
+          return priv->regs[i].value;
+        }
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: ft80x_mock_putreg
+ ****************************************************************************/
+
+static void ft80x_mock_putreg(uint32_t addr, uint32_t value)
+{
+  FAR struct ft80x_mock_s *priv = &g_ft80x_mock;
+  int i;
+
+  if (addr == FT80X_REG_CMD_WRITE)
+    {
+      /* The co-processor starts on the new commands now */
+
+      ft80x_mock_coproc();
+      priv->cmdwrite = value & MOCK_CMDFIFO_MASK;
+      return;
+    }
+
+  for (i = 0; i < priv->nregs; i++)
+    {
+      if (priv->regs[i].addr == addr)
+        {
+          priv->regs[i].value = value;
+          return;
+        }
+    }
+
+  if (priv->nregs < MOCK_NREGS)
+    {
+      priv->regs[priv->nregs].addr  = addr;
+      priv->regs[priv->nregs].value = value;
+      priv->nregs++;
+    }
+}
+
+/****************************************************************************
+ * Name: ft80x_mock_write
+ *
+ * Description:
+ *   Write to RAM DL.  The data is discarded.
+ *
+ ****************************************************************************/
+
+static ssize_t ft80x_mock_write(FAR struct file *filep,
+                                FAR const char *buffer, size_t buflen)
+{
+  ft80x_mock_spi(MOCK_WRADDR_BYTES + buflen);
+  filep->f_pos += buflen;
+  return buflen;
+}
+
+/****************************************************************************
+ * Name: ft80x_mock_ioctl
+ ****************************************************************************/
+
+static int ft80x_mock_ioctl(FAR struct file *filep, int cmd,
+                            unsigned long arg)
+{
+  FAR struct ft80x_mock_s *priv = &g_ft80x_mock;
+  int i;
+
+  switch (cmd)
+    {
+      case FT80X_IOC_GETREG8:
+      case FT80X_IOC_GETREG16:
+      case FT80X_IOC_GETREG32:
+        {
+          FAR struct ft80x_register_s *reg =
+            (FAR struct ft80x_register_s *)((uintptr_t)arg);
+
+          if (cmd == FT80X_IOC_GETREG8)
+            {
+              ft80x_mock_spi(MOCK_RDADDR_BYTES + 1);
+              reg->value.u8 = (uint8_t)ft80x_mock_getreg(reg->addr);
+            }
+          else if (cmd == FT80X_IOC_GETREG16)
+            {
+              ft80x_mock_spi(MOCK_RDADDR_BYTES + 2);
+              reg->value.u16 = (uint16_t)ft80x_mock_getreg(reg->addr);
+            }
+          else
+            {
+              ft80x_mock_spi(MOCK_RDADDR_BYTES + 4);
+              reg->value.u32 = ft80x_mock_getreg(reg->addr);
+            }
+        }
+        break;
+
+      case FT80X_IOC_GETREGS:
+        {
+          FAR struct ft80x_registers_s *regs =
+            (FAR struct ft80x_registers_s *)((uintptr_t)arg);
+
+          ft80x_mock_spi(MOCK_RDADDR_BYTES + 4 * regs->nregs);
+          for (i = 0; i < regs->nregs; i++)
+            {
+              regs->value[i] = ft80x_mock_getreg(regs->addr + 4 * i);
+            }
+        }
+        break;
+
+      case FT80X_IOC_PUTREG8:
+      case FT80X_IOC_PUTREG16:
+      case FT80X_IOC_PUTREG32:
+        {
+          FAR struct ft80x_register_s *reg =
+            (FAR struct ft80x_register_s *)((uintptr_t)arg);
+
+          if (cmd == FT80X_IOC_PUTREG8)
+            {
+              ft80x_mock_spi(MOCK_WRADDR_BYTES + 1);
+              ft80x_mock_putreg(reg->addr, reg->value.u8);
+            }
+          else if (cmd == FT80X_IOC_PUTREG16)
+            {
+              ft80x_mock_spi(MOCK_WRADDR_BYTES + 2);
+              ft80x_mock_putreg(reg->addr, reg->value.u16);
+            }
+          else
+            {
+              ft80x_mock_spi(MOCK_WRADDR_BYTES + 4);
+              ft80x_mock_putreg(reg->addr, reg->value.u32);
+            }
+        }
+        break;
+
+      case FT80X_IOC_PUTREGS:
+        {
+          FAR struct ft80x_registers_s *regs =
+            (FAR struct ft80x_registers_s *)((uintptr_t)arg);
+
+          ft80x_mock_spi(MOCK_WRADDR_BYTES + 4 * regs->nregs);
+          for (i = 0; i < regs->nregs; i++)
+            {
+              ft80x_mock_putreg(regs->addr + 4 * i, regs->value[i]);
+            }
+        }
+        break;
+
+      case FT80X_IOC_PUTRAMG:
+      case FT80X_IOC_PUTRAMCMD:
+        {
+          FAR struct ft80x_relmem_s *mem =
+            (FAR struct ft80x_relmem_s *)((uintptr_t)arg);
+
+          /* Only the transfer time matters:  The co-processor rate does
+           * not depend on the commands.
+           */
+
+          ft80x_mock_spi(MOCK_WRADDR_BYTES + mem->nbytes);
+        }
+        break;
+
+      case FT80X_IOC_EVENTNOTIFY:
+        {
+          FAR struct ft80x_notify_s *notify =
+            (FAR struct ft80x_notify_s *)((uintptr_t)arg);
+
+          /* The caller waits for the CMD FIFO to become empty.  Let the
+           * time pass and send the signal at once:  It pends until the
+           * caller waits for it.
+           */
+
+          if (notify->event == FT80X_NOTIFY_CMDEMPTY && notify->enable)
+            {
+              ft80x_mock_coproc();
+              priv->nsec += MOCK_CMD_NSEC((priv->cmdwrite - priv->cmdread) &
+                                          MOCK_CMDFIFO_MASK);
+              ft80x_mock_coproc();
+
+              (void)kill(notify->pid, notify->signo);
+            }
+        }
+        break;
+
+      case FT80X_IOC_FADE:
+      case FT80X_IOC_AUDIO:
+        break;
+
+      default:
+        return -ENOTTY;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ft80x_mock_register
+ *
+ * Description:
+ *   Register the mock FT80x device at 'devpath'.  The mock accepts the
+ *   ioctl commands and RAM DL writes used by the FT80x library and only
+ *   accounts for the time that the real device would take:  The SPI
+ *   transfer time and the co-processor execution time.  The data is
+ *   discarded.
+ *
+ * Input Parameters:
+ *   devpath - The path of the mock device
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int ft80x_mock_register(FAR const char *devpath)
+{
+  return register_driver(devpath, &g_ft80x_mock_fops, 0222, NULL);
+}
+
+/****************************************************************************
+ * Name: ft80x_mock_usec
+ *
+ * Description:
+ *   Return the modelled time in microseconds.
+ *
+ ****************************************************************************/
+
+uint64_t ft80x_mock_usec(void)
+{
+  return g_ft80x_mock.nsec / 1000;
+}
+
+#endif /* CONFIG_EXAMPLES_FT80X_MOCK */
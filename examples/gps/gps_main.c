@@ -1,5 +1,5 @@
 /****************************************************************************
- * examples/hello/gps_main.c
+ * examples/gps/gps_main.c
  *
  *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
  *   Author: Alan Carvalho de Assis <acassis@gmail.com>
@@ -40,118 +40,361 @@
 #include <nuttx/config.h>
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <fcntl.h>
-#include <wchar.h>
-#include <syslog.h>
+#include <time.h>
+#include <errno.h>
 
 #include "gpsutils/minmea.h"
+#include "testing/bench.h"
 
 /****************************************************************************
- * Public Functions
+ * Pre-processor Definitions
  ****************************************************************************/
 
+#ifndef CONFIG_EXAMPLES_GPS_DEVPATH
+#  define CONFIG_EXAMPLES_GPS_DEVPATH "/dev/ttyS1"
+#endif
+
+/* Receive chunk size.  This is also the chunk size used to feed the
+ * streaming parser in the benchmark, to resemble UART reads.
+ */
+
+#define GPS_CHUNKSIZE 64
+
 /****************************************************************************
- * gps_main
+ * Private Data
  ****************************************************************************/
 
-#ifdef BUILD_MODULE
-int main(int argc, FAR char *argv[])
-#else
-int gps_main(int argc, char *argv[])
-#endif
+/* The parser holds all of its state, so it need not live on the stack */
+
+static struct minmea_stream_s g_stream;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: gps_sentence
+ *
+ * Description:
+ *   Streaming parser callback: show position and fix information.
+ *
+ ****************************************************************************/
+
+static void gps_sentence(FAR void *arg, enum minmea_sentence_id id,
+                         FAR const union minmea_sentence_u *frame,
+                         FAR const char *sentence)
 {
-  int fd;
-  int cnt;
-  char ch;
-  char line[MINMEA_MAX_LENGTH];
+  struct minmea_sentence_rmc rmc;
 
-  /* Open the GPS serial port */
+  switch (id)
+    {
+      case MINMEA_SENTENCE_RMC:
+        rmc = frame->rmc;
 
-  fd = open("/dev/ttyS1", O_RDONLY);
-  if (fd < 0)
+        printf("Fixed-point Latitude...........: %d\n",
+               minmea_rescale(&rmc.latitude, 1000));
+        printf("Fixed-point Longitude..........: %d\n",
+               minmea_rescale(&rmc.longitude, 1000));
+        printf("Fixed-point Speed..............: %d\n",
+               minmea_rescale(&rmc.speed, 1000));
+        printf("Floating point degree latitude.: %2.6f\n",
+               minmea_tocoord(&rmc.latitude));
+        printf("Floating point degree longitute: %2.6f\n",
+               minmea_tocoord(&rmc.longitude));
+        printf("Floating point speed...........: %2.6f\n",
+               minmea_tofloat(&rmc.speed));
+        break;
+
+      case MINMEA_SENTENCE_GGA:
+        printf("Fix quality....................: %d\n",
+               frame->gga.fix_quality);
+        printf("Altitude.......................: %d\n",
+               frame->gga.altitude.value);
+        printf("Tracked satellites.............: %d\n",
+               frame->gga.satellites_tracked);
+        break;
+
+      case MINMEA_INVALID:
+        printf("%s is not parsed\n", sentence);
+        break;
+
+      default:
+        break;
+    }
+}
+
+#ifdef CONFIG_EXAMPLES_GPS_BENCHMARK
+/****************************************************************************
+ * Name: gps_report
+ ****************************************************************************/
+
+static void gps_report(FAR const char *name, unsigned long nsentences,
+                       unsigned long usec)
+{
+  if (usec == 0)
     {
-      printf("Unable to open file /dev/ttyS1\n");
+      usec = 1;
     }
 
-  /* Run forever */
+  printf("%-10s %8lu sentences %8lu us %10llu sentences/s\n",
+         name, nsentences, usec,
+         (unsigned long long)nsentences * 1000000 / usec);
+}
 
-  for (; ; )
+/****************************************************************************
+ * Name: gps_bench_line
+ *
+ * Description:
+ *   Parse the log the way the line based API is used: split it into lines,
+ *   check and identify each line, then parse it.
+ *
+ ****************************************************************************/
+
+static unsigned long gps_bench_line(FAR const char *log, size_t len)
+{
+  FAR const char *end = log + len;
+  FAR const char *eol;
+  char line[MINMEA_MAX_LENGTH + 4];
+  union minmea_sentence_u frame;
+  unsigned long nsentences = 0;
+  size_t linelen;
+  bool ok;
+
+  for (; log < end; log = eol + 1)
     {
-      /* Read until we complete a line */
+      eol = memchr(log, '\n', end - log);
+      if (eol == NULL)
+        {
+          eol = end;
+        }
 
-      cnt = 0;
-      do
+      linelen = eol - log;
+      if (linelen >= sizeof(line))
         {
-          read(fd, &ch, 1);
-          if (ch != '\r' && ch != '\n')
-            {
-              line[cnt++] = ch;
-            }
+          continue;
         }
-      while (ch != '\r' && ch != '\n');
 
-      line[cnt] = '\0';
+      memcpy(line, log, linelen);
+      line[linelen] = '\0';
+      if (linelen > 0 && line[linelen - 1] == '\r')
+        {
+          line[linelen - 1] = '\0';
+        }
 
       switch (minmea_sentence_id(line, false))
         {
           case MINMEA_SENTENCE_RMC:
-            {
-              struct minmea_sentence_rmc frame;
-
-              if (minmea_parse_rmc(&frame, line))
-                {
-                  printf("Fixed-point Latitude...........: %d\n",
-                         minmea_rescale(&frame.latitude, 1000));
-                  printf("Fixed-point Longitude..........: %d\n",
-                         minmea_rescale(&frame.longitude, 1000));
-                  printf("Fixed-point Speed..............: %d\n",
-                         minmea_rescale(&frame.speed, 1000));
-                  printf("Floating point degree latitude.: %2.6f\n",
-                         minmea_tocoord(&frame.latitude));
-                  printf("Floating point degree longitute: %2.6f\n",
-                         minmea_tocoord(&frame.longitude));
-                  printf("Floating point speed...........: %2.6f\n",
-                         minmea_tocoord(&frame.speed));
-                }
-              else
-                {
-                    printf("$xxRMC sentence is not parsed\n");
-                }
-            }
+            ok = minmea_parse_rmc(&frame.rmc, line);
             break;
 
           case MINMEA_SENTENCE_GGA:
-            {
-              struct minmea_sentence_gga frame;
-
-              if (minmea_parse_gga(&frame, line))
-                {
-                  printf("Fix quality....................: %d\n",
-                         frame.fix_quality);
-                  printf("Altitude.......................: %d\n",
-                         frame.altitude.value);
-                  printf("Tracked satellites.............: %d\n",
-                         frame.satellites_tracked);
-                }
-              else
-                {
-                  printf("$xxGGA sentence is not parsed\n");
-                }
-            }
+            ok = minmea_parse_gga(&frame.gga, line);
             break;
 
-          case MINMEA_INVALID:
-          case MINMEA_UNKNOWN:
           case MINMEA_SENTENCE_GSA:
+            ok = minmea_parse_gsa(&frame.gsa, line);
+            break;
+
           case MINMEA_SENTENCE_GLL:
+            ok = minmea_parse_gll(&frame.gll, line);
+            break;
+
           case MINMEA_SENTENCE_GST:
+            ok = minmea_parse_gst(&frame.gst, line);
+            break;
+
           case MINMEA_SENTENCE_GSV:
-            {
-            }
+            ok = minmea_parse_gsv(&frame.gsv, line);
             break;
+
+          default:
+            ok = false;
+            break;
+        }
+
+      if (ok)
+        {
+          nsentences++;
         }
     }
 
-  return 0;
+  return nsentences;
 }
 
+/****************************************************************************
+ * Name: gps_bench_stream
+ *
+ * Description:
+ *   Feed the log to the streaming parser in receive sized chunks.
+ *
+ ****************************************************************************/
+
+static unsigned long gps_bench_stream(FAR const char *log, size_t len)
+{
+  size_t nbytes;
+
+  minmea_stream_init(&g_stream, false, NULL, NULL);
+
+  while (len > 0)
+    {
+      nbytes = len < GPS_CHUNKSIZE ? len : GPS_CHUNKSIZE;
+      minmea_stream_feed(&g_stream, log, nbytes);
+      log += nbytes;
+      len -= nbytes;
+    }
+
+  return g_stream.stats.sentences;
+}
+
+/****************************************************************************
+ * Name: gps_benchmark
+ *
+ * Description:
+ *   Measure the sentences per second of both parsers on a recorded NMEA
+ *   log.
+ *
+ ****************************************************************************/
+
+static int gps_benchmark(FAR const char *path, int npasses)
+{
+  uint64_t start;
+  unsigned long nline = 0;
+  unsigned long nstream = 0;
+  unsigned long usec;
+  FAR char *log;
+  off_t size;
+  ssize_t nread;
+  size_t len;
+  int fd;
+  int i;
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0)
+    {
+      fprintf(stderr, "ERROR: Unable to open %s: %d\n", path, errno);
+      return EXIT_FAILURE;
+    }
+
+  size = lseek(fd, 0, SEEK_END);
+  if (size <= 0 || lseek(fd, 0, SEEK_SET) < 0)
+    {
+      fprintf(stderr, "ERROR: %s is empty\n", path);
+      close(fd);
+      return EXIT_FAILURE;
+    }
+
+  log = malloc(size);
+  if (log == NULL)
+    {
+      fprintf(stderr, "ERROR: Failed to allocate %ld bytes\n", (long)size);
+      close(fd);
+      return EXIT_FAILURE;
+    }
+
+  for (len = 0; len < size; len += nread)
+    {
+      nread = read(fd, log + len, size - len);
+      if (nread <= 0)
+        {
+          break;
+        }
+    }
+
+  close(fd);
+
+  printf("%s: %lu bytes, %d passes\n", path, (unsigned long)len, npasses);
+
+  start = bench_usec();
+  for (i = 0; i < npasses; i++)
+    {
+      nline += gps_bench_line(log, len);
+    }
+
+  usec = (unsigned long)(bench_usec() - start);
+  gps_report("line", nline, usec);
+
+  start = bench_usec();
+  for (i = 0; i < npasses; i++)
+    {
+      nstream += gps_bench_stream(log, len);
+    }
+
+  usec = (unsigned long)(bench_usec() - start);
+  gps_report("stream", nstream, usec);
+
+  printf("stream: %lu unknown, %lu bad checksum, %lu bad frame, "
+         "%lu bad field (last pass)\n",
+         (unsigned long)g_stream.stats.unknown,
+         (unsigned long)g_stream.stats.badchecksum,
+         (unsigned long)g_stream.stats.badframe,
+         (unsigned long)g_stream.stats.badfield);
+
+  free(log);
+  return EXIT_SUCCESS;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * gps_main
+ ****************************************************************************/
+
+#ifdef BUILD_MODULE
+int main(int argc, FAR char *argv[])
+#else
+int gps_main(int argc, char *argv[])
+#endif
+{
+  char buffer[GPS_CHUNKSIZE];
+  ssize_t nread;
+  int fd;
+
+#ifdef CONFIG_EXAMPLES_GPS_BENCHMARK
+  /* gps -b <nmealog> [<passes>] */
+
+  if (argc > 2 && strcmp(argv[1], "-b") == 0)
+    {
+      return gps_benchmark(argv[2], argc > 3 ? atoi(argv[3]) : 10);
+    }
+#endif
+
+  /* Open the GPS serial port */
+
+  fd = open(CONFIG_EXAMPLES_GPS_DEVPATH, O_RDONLY);
+  if (fd < 0)
+    {
+      printf("Unable to open file %s\n", CONFIG_EXAMPLES_GPS_DEVPATH);
+      return EXIT_FAILURE;
+    }
+
+  minmea_stream_init(&g_stream, false, gps_sentence, NULL);
+
+  /* Run forever, passing whatever the receiver sends to the parser */
+
+  for (; ; )
+    {
+      nread = read(fd, buffer, sizeof(buffer));
+      if (nread < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          printf("Read failed: %d\n", errno);
+          break;
+        }
+
+      minmea_stream_feed(&g_stream, buffer, nread);
+    }
+
+  close(fd);
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,322 @@
+/****************************************************************************
+ * examples/mkfatfs_bench/mkfatfs_bench_main.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/ioctl.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+
+#include <nuttx/fs/loop.h>
+
+#include "fsutils/mkfatfs.h"
+#include "testing/bench.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_MKFATFS_BENCH_LOOPDEV
+#  define CONFIG_EXAMPLES_MKFATFS_BENCH_LOOPDEV "/dev/loop7"
+#endif
+
+#define BENCH_SECTORSIZE 512
+#define BENCH_FILLSIZE   4096
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bench_progress_s
+{
+  unsigned long nwrites;        /* Number of writes reported */
+  unsigned int  percent;        /* Last percentage shown */
+  bool          verbose;        /* Show progress */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: bench_progress
+ *
+ * Description:
+ *   mkfatfs progress callback: count writes and show every 10%.
+ *
+ ****************************************************************************/
+
+static void bench_progress(FAR void *arg, uint32_t nwritten, uint32_t ntotal)
+{
+  FAR struct bench_progress_s *progress = (FAR struct bench_progress_s *)arg;
+  unsigned int percent;
+
+  progress->nwrites++;
+
+  if (progress->verbose && ntotal > 0)
+    {
+      percent = (unsigned int)((uint64_t)nwritten * 100 / ntotal);
+      if (percent >= progress->percent + 10 || nwritten == ntotal)
+        {
+          printf("  %3u%% (%lu/%lu sectors)\n", percent,
+                 (unsigned long)nwritten, (unsigned long)ntotal);
+          progress->percent = percent;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: bench_mkimage
+ *
+ * Description:
+ *   Create the backing file, size bytes long.
+ *
+ ****************************************************************************/
+
+static int bench_mkimage(FAR const char *path, off_t size)
+{
+  FAR uint8_t *buffer;
+  ssize_t nwritten;
+  off_t remaining;
+  int errcode;
+  int fd;
+
+  fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0)
+    {
+      errcode = errno;
+      fprintf(stderr, "ERROR: Failed to create %s: %d\n", path, errcode);
+      return -errcode;
+    }
+
+  /* Not every file system supports ftruncate().  Fill with zeros if it
+   * fails.
+   */
+
+  if (ftruncate(fd, size) < 0)
+    {
+      buffer = (FAR uint8_t *)zalloc(BENCH_FILLSIZE);
+      if (buffer == NULL)
+        {
+          close(fd);
+          return -ENOMEM;
+        }
+
+      for (remaining = size; remaining > 0; remaining -= nwritten)
+        {
+          nwritten = write(fd, buffer, remaining < BENCH_FILLSIZE ?
+                           remaining : BENCH_FILLSIZE);
+          if (nwritten < 0)
+            {
+              errcode = errno;
+              fprintf(stderr, "ERROR: Failed to fill %s: %d\n",
+                      path, errcode);
+              free(buffer);
+              close(fd);
+              return -errcode;
+            }
+        }
+
+      free(buffer);
+    }
+
+  close(fd);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bench_loop
+ *
+ * Description:
+ *   Set up (filename != NULL) or tear down the loop device.
+ *
+ ****************************************************************************/
+
+static int bench_loop(FAR const char *filename)
+{
+  struct losetup_s setup;
+  int errcode;
+  int ret;
+  int fd;
+
+  fd = open("/dev/loop", O_RDONLY);
+  if (fd < 0)
+    {
+      errcode = errno;
+      fprintf(stderr, "ERROR: Failed to open /dev/loop: %d\n", errcode);
+      return -errcode;
+    }
+
+  if (filename != NULL)
+    {
+      setup.devname  = CONFIG_EXAMPLES_MKFATFS_BENCH_LOOPDEV;
+      setup.filename = filename;
+      setup.sectsize = BENCH_SECTORSIZE;
+      setup.offset   = 0;
+      setup.readonly = false;
+
+      ret = ioctl(fd, LOOPIOC_SETUP, (unsigned long)((uintptr_t)&setup));
+    }
+  else
+    {
+      ret = ioctl(fd, LOOPIOC_TEARDOWN,
+                  (unsigned long)((uintptr_t)
+                                  CONFIG_EXAMPLES_MKFATFS_BENCH_LOOPDEV));
+    }
+
+  if (ret < 0)
+    {
+      ret = -errno;
+      fprintf(stderr, "ERROR: Loop device ioctl failed: %d\n", ret);
+    }
+
+  close(fd);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: bench_showusage
+ ****************************************************************************/
+
+static void bench_showusage(FAR const char *progname)
+{
+  fprintf(stderr, "USAGE: %s [-F 12|16|32] [-s <MiB>] [-p] <file>\n",
+          progname);
+  fprintf(stderr, "  -F  FAT type (default: automatic)\n");
+  fprintf(stderr, "  -s  Image size in MiB (default: 64)\n");
+  fprintf(stderr, "  -p  Show progress\n");
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * mkfatfs_bench_main
+ ****************************************************************************/
+
+#ifdef BUILD_MODULE
+int main(int argc, FAR char *argv[])
+#else
+int mkfatfs_bench_main(int argc, char *argv[])
+#endif
+{
+  struct fat_format_s fmt = FAT_FORMAT_INITIALIZER;
+  struct bench_progress_s progress;
+  uint64_t start;
+  FAR const char *filename;
+  unsigned long msec;
+  unsigned long size = 64;
+  int option;
+  int ret;
+
+  memset(&progress, 0, sizeof(struct bench_progress_s));
+
+  while ((option = getopt(argc, argv, "F:s:p")) != ERROR)
+    {
+      switch (option)
+        {
+          case 'F':
+            fmt.ff_fattype = atoi(optarg);
+            break;
+
+          case 's':
+            size = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'p':
+            progress.verbose = true;
+            break;
+
+          default:
+            bench_showusage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+  if (optind != argc - 1 || size == 0)
+    {
+      bench_showusage(argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  filename = argv[optind];
+
+  ret = bench_mkimage(filename, (off_t)size << 20);
+  if (ret < 0)
+    {
+      return EXIT_FAILURE;
+    }
+
+  ret = bench_loop(filename);
+  if (ret < 0)
+    {
+      return EXIT_FAILURE;
+    }
+
+  fmt.ff_progress = bench_progress;
+  fmt.ff_progarg  = &progress;
+
+  printf("Formatting %s (%s, %lu MiB)\n",
+         CONFIG_EXAMPLES_MKFATFS_BENCH_LOOPDEV, filename, size);
+
+  start = bench_usec();
+  ret   = mkfatfs(CONFIG_EXAMPLES_MKFATFS_BENCH_LOOPDEV, &fmt);
+  msec  = (unsigned long)((bench_usec() - start) / 1000);
+
+  if (ret < 0)
+    {
+      fprintf(stderr, "ERROR: mkfatfs failed: %d\n", errno);
+    }
+  else
+    {
+      printf("FAT%d: %lu writes, %lu ms\n",
+             fmt.ff_fattype, progress.nwrites, msec);
+    }
+
+  (void)bench_loop(NULL);
+  return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,167 @@
+/****************************************************************************
+ * examples/mm_bench/mm_bench.h
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_EXAMPLES_MM_BENCH_MM_BENCH_H
+#define __APPS_EXAMPLES_MM_BENCH_MM_BENCH_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "testing/bench.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_EXAMPLES_MM_BENCH_MAXTHREADS
+#  define CONFIG_EXAMPLES_MM_BENCH_MAXTHREADS 8
+#endif
+
+#ifndef CONFIG_EXAMPLES_MM_BENCH_THREAD_STACKSIZE
+#  define CONFIG_EXAMPLES_MM_BENCH_THREAD_STACKSIZE 2048
+#endif
+
+#ifndef CONFIG_EXAMPLES_MM_BENCH_TRACE_NRECORDS
+#  define CONFIG_EXAMPLES_MM_BENCH_TRACE_NRECORDS 512
+#endif
+
+#ifndef CONFIG_EXAMPLES_MM_BENCH_TRACE_PRIORITY
+#  define CONFIG_EXAMPLES_MM_BENCH_TRACE_PRIORITY 200
+#endif
+
+#ifndef CONFIG_EXAMPLES_MM_BENCH_TRACE_STACKSIZE
+#  define CONFIG_EXAMPLES_MM_BENCH_TRACE_STACKSIZE 2048
+#endif
+
+/* Trace records.  A trace is a text file with one operation per line:
+ *
+ *   m <addr> <size>          malloc()
+ *   z <addr> <size>          zalloc() or calloc()
+ *   a <addr> <align> <size>  memalign()
+ *   r <old> <new> <size>     realloc(); <old> may be 0
+ *   f <addr>                 free()
+ *
+ * Addresses are in hexadecimal and only serve to pair up the operations.
+ */
+
+#define MM_TRACE_MALLOC   'm'
+#define MM_TRACE_ZALLOC   'z'
+#define MM_TRACE_MEMALIGN 'a'
+#define MM_TRACE_REALLOC  'r'
+#define MM_TRACE_FREE     'f'
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Latency and heap statistics shared by the synthetic and the replay
+ * workloads.
+ */
+
+struct mm_bench_stats_s
+{
+  uint32_t nallocs;             /* Allocations (incl. realloc) */
+  uint32_t nfrees;              /* Frees */
+  uint32_t nfailed;             /* Allocations that returned NULL */
+  uint32_t maxalloc;            /* Worst allocation latency (usec) */
+  uint32_t maxfree;             /* Worst free latency (usec) */
+  uint64_t allocusec;           /* Total allocation latency (usec) */
+  uint64_t freeusec;            /* Total free latency (usec) */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_bench_sample
+ *
+ * Description:
+ *   Print one line of the heap usage and fragmentation time series and
+ *   update the peak heap usage.  'live' is the number of bytes that the
+ *   benchmark itself has allocated at this time.
+ *
+ ****************************************************************************/
+
+void mm_bench_sample(uint64_t start, size_t live);
+
+/****************************************************************************
+ * Name: mm_bench_report
+ *
+ * Description:
+ *   Print the summary of a run.
+ *
+ ****************************************************************************/
+
+void mm_bench_report(FAR const struct mm_bench_stats_s *stats,
+                     uint64_t usec, size_t peaklive);
+
+/****************************************************************************
+ * Name: mm_bench_replay
+ *
+ * Description:
+ *   Load the trace at 'path' and replay it, sampling the heap every
+ *   'interval' operations.
+ *
+ ****************************************************************************/
+
+int mm_bench_replay(FAR const char *path, uint32_t interval);
+
+/****************************************************************************
+ * Name: mm_trace_start and mm_trace_stop
+ *
+ * Description:
+ *   Start recording every heap operation to the trace file at 'path', or
+ *   stop recording.  The program must be linked with
+ *   -Wl,--wrap=malloc,--wrap=free,--wrap=realloc,--wrap=zalloc,
+ *   --wrap=calloc,--wrap=memalign for anything to be recorded.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_EXAMPLES_MM_BENCH_TRACE
+int mm_trace_start(FAR const char *path);
+int mm_trace_stop(void);
+#endif
+
+#endif /* __APPS_EXAMPLES_MM_BENCH_MM_BENCH_H */
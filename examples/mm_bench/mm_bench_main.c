@@ -0,0 +1,710 @@
+/****************************************************************************
+ * examples/mm_bench/mm_bench_main.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+#include "mm_bench.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+enum mm_bench_dist_e
+{
+  MM_DIST_UNIFORM = 0,          /* Uniform between min and max */
+  MM_DIST_LOG,                  /* Log-uniform: as many small as large */
+  MM_DIST_FIXED                 /* Always min */
+};
+
+struct mm_bench_config_s
+{
+  enum mm_bench_dist_e dist;    /* Size distribution */
+  size_t minsize;               /* Smallest allocation */
+  size_t maxsize;               /* Largest allocation */
+  uint32_t nops;                /* Operations per thread */
+  uint32_t nlive;               /* Live allocation slots per thread */
+  uint32_t pinned;              /* Percent of allocations kept to the end */
+  uint32_t interval;            /* Operations between heap samples */
+  int nthreads;                 /* Number of contending threads */
+};
+
+struct mm_bench_worker_s
+{
+  pthread_t thread;
+  FAR const struct mm_bench_config_s *cfg;
+  FAR void **slots;             /* Live allocations */
+  FAR size_t *sizes;            /* Size of each live allocation */
+  FAR void **pins;              /* Allocations kept until the end */
+  uint32_t npins;               /* Number of entries in pins[] */
+  uint32_t seed;                /* Private random number state */
+  int id;                       /* Thread number */
+  volatile size_t live;         /* Bytes currently allocated */
+  struct mm_bench_stats_s stats;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static FAR struct mm_bench_worker_s *g_workers;
+static uint64_t g_start;
+static size_t g_peakused;
+static size_t g_peaklive;
+static uint32_t g_nsamples;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_bench_random
+ *
+ * Description:
+ *   xorshift32; rand() is not safe to share between the threads.
+ *
+ ****************************************************************************/
+
+static uint32_t mm_bench_random(FAR struct mm_bench_worker_s *worker)
+{
+  uint32_t x = worker->seed;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+
+  worker->seed = x;
+  return x;
+}
+
+/****************************************************************************
+ * Name: mm_bench_size
+ *
+ * Description:
+ *   Draw an allocation size from the configured distribution.
+ *
+ ****************************************************************************/
+
+static size_t mm_bench_size(FAR struct mm_bench_worker_s *worker)
+{
+  FAR const struct mm_bench_config_s *cfg = worker->cfg;
+  size_t range = cfg->maxsize - cfg->minsize + 1;
+  size_t lo;
+  size_t hi;
+  int minbit;
+  int maxbit;
+  int bit;
+
+  switch (cfg->dist)
+    {
+      case MM_DIST_UNIFORM:
+        return cfg->minsize + mm_bench_random(worker) % range;
+
+      case MM_DIST_LOG:
+
+        /* Pick a power of two uniformly, then a size within it */
+
+        for (minbit = 0; (cfg->minsize >> (minbit + 1)) != 0; minbit++);
+        for (maxbit = 0; (cfg->maxsize >> (maxbit + 1)) != 0; maxbit++);
+
+        bit = minbit + mm_bench_random(worker) % (maxbit - minbit + 1);
+        lo  = (size_t)1 << bit;
+        hi  = (lo << 1) - 1;
+
+        if (lo < cfg->minsize)
+          {
+            lo = cfg->minsize;
+          }
+
+        if (hi > cfg->maxsize)
+          {
+            hi = cfg->maxsize;
+          }
+
+        return lo + mm_bench_random(worker) % (hi - lo + 1);
+
+      case MM_DIST_FIXED:
+      default:
+        return cfg->minsize;
+    }
+}
+
+/****************************************************************************
+ * Name: mm_bench_alloc and mm_bench_free
+ *
+ * Description:
+ *   Timed malloc() and free().  The first byte of each cache line of an
+ *   allocation is touched, as a real user of the memory would.
+ *
+ ****************************************************************************/
+
+static FAR void *mm_bench_alloc(FAR struct mm_bench_worker_s *worker,
+                                size_t size)
+{
+  FAR uint8_t *mem;
+  uint64_t start;
+  uint32_t usec;
+  size_t i;
+
+  start = bench_usec();
+  mem   = (FAR uint8_t *)malloc(size);
+  usec  = (uint32_t)(bench_usec() - start);
+
+  worker->stats.nallocs++;
+  worker->stats.allocusec += usec;
+  if (usec > worker->stats.maxalloc)
+    {
+      worker->stats.maxalloc = usec;
+    }
+
+  if (mem == NULL)
+    {
+      worker->stats.nfailed++;
+      return NULL;
+    }
+
+  for (i = 0; i < size; i += 32)
+    {
+      mem[i] = (uint8_t)i;
+    }
+
+  worker->live += size;
+  return mem;
+}
+
+static void mm_bench_free(FAR struct mm_bench_worker_s *worker,
+                          FAR void *mem, size_t size)
+{
+  uint64_t start;
+  uint32_t usec;
+
+  start = bench_usec();
+  free(mem);
+  usec  = (uint32_t)(bench_usec() - start);
+
+  worker->stats.nfrees++;
+  worker->stats.freeusec += usec;
+  if (usec > worker->stats.maxfree)
+    {
+      worker->stats.maxfree = usec;
+    }
+
+  worker->live -= size;
+}
+
+/****************************************************************************
+ * Name: mm_bench_totallive
+ ****************************************************************************/
+
+static size_t mm_bench_totallive(FAR const struct mm_bench_config_s *cfg)
+{
+  size_t live = 0;
+  int i;
+
+  for (i = 0; i < cfg->nthreads; i++)
+    {
+      live += g_workers[i].live;
+    }
+
+  return live;
+}
+
+/****************************************************************************
+ * Name: mm_bench_thread
+ *
+ * Description:
+ *   The synthetic workload:  each operation picks one of the thread's live
+ *   slots at random and frees it if it is in use or fills it if not.  The
+ *   number of slots sets how long allocations live.  A percentage of the
+ *   allocations are pinned until the end of the run instead, which is what
+ *   fragments a heap over time.  Thread 0 also samples the heap.
+ *
+ ****************************************************************************/
+
+static FAR void *mm_bench_thread(FAR void *arg)
+{
+  FAR struct mm_bench_worker_s *worker = (FAR struct mm_bench_worker_s *)arg;
+  FAR const struct mm_bench_config_s *cfg = worker->cfg;
+  FAR void *mem;
+  uint32_t slot;
+  uint32_t op;
+  size_t size;
+
+  for (op = 0; op < cfg->nops; op++)
+    {
+      slot = mm_bench_random(worker) % cfg->nlive;
+
+      if (worker->slots[slot] != NULL)
+        {
+          mm_bench_free(worker, worker->slots[slot], worker->sizes[slot]);
+          worker->slots[slot] = NULL;
+        }
+      else
+        {
+          size = mm_bench_size(worker);
+          mem  = mm_bench_alloc(worker, size);
+
+          if (mem != NULL)
+            {
+              if (worker->npins < cfg->nlive &&
+                  mm_bench_random(worker) % 100 < cfg->pinned)
+                {
+                  worker->pins[worker->npins++] = mem;
+                }
+              else
+                {
+                  worker->slots[slot] = mem;
+                  worker->sizes[slot] = size;
+                }
+            }
+        }
+
+      if (worker->id == 0 && cfg->interval > 0 &&
+          (op + 1) % cfg->interval == 0)
+        {
+          mm_bench_sample(g_start, mm_bench_totallive(cfg));
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: mm_bench_synthetic
+ ****************************************************************************/
+
+static int mm_bench_synthetic(FAR const struct mm_bench_config_s *cfg)
+{
+  FAR struct mm_bench_worker_s *worker;
+  struct mm_bench_stats_s stats;
+  pthread_attr_t attr;
+  uint64_t usec;
+  uint32_t slot;
+  int ret = OK;
+  int i;
+
+  g_workers = (FAR struct mm_bench_worker_s *)
+    calloc(cfg->nthreads, sizeof(struct mm_bench_worker_s));
+  if (g_workers == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  for (i = 0; i < cfg->nthreads; i++)
+    {
+      worker        = &g_workers[i];
+      worker->cfg   = cfg;
+      worker->id    = i;
+      worker->seed  = 0x93846 + i;
+      worker->slots = (FAR void **)calloc(cfg->nlive, sizeof(FAR void *));
+      worker->sizes = (FAR size_t *)calloc(cfg->nlive, sizeof(size_t));
+      worker->pins  = (FAR void **)calloc(cfg->nlive, sizeof(FAR void *));
+
+      if (worker->slots == NULL || worker->sizes == NULL ||
+          worker->pins == NULL)
+        {
+          ret = -ENOMEM;
+          goto errout;
+        }
+    }
+
+  printf("sample,msec,used,free,largest,frag,live\n");
+  mm_bench_sample(g_start = bench_usec(), 0);
+
+  if (cfg->nthreads == 1)
+    {
+      mm_bench_thread(&g_workers[0]);
+    }
+  else
+    {
+      pthread_attr_init(&attr);
+      pthread_attr_setstacksize(&attr,
+                                CONFIG_EXAMPLES_MM_BENCH_THREAD_STACKSIZE);
+
+      for (i = 0; i < cfg->nthreads; i++)
+        {
+          ret = pthread_create(&g_workers[i].thread, &attr, mm_bench_thread,
+                               &g_workers[i]);
+          if (ret != 0)
+            {
+              fprintf(stderr, "ERROR: pthread_create failed: %d\n", ret);
+              ret = -ret;
+              break;
+            }
+        }
+
+      while (--i >= 0)
+        {
+          pthread_join(g_workers[i].thread, NULL);
+        }
+
+      pthread_attr_destroy(&attr);
+    }
+
+  usec = bench_usec() - g_start;
+  mm_bench_sample(g_start, mm_bench_totallive(cfg));
+
+  /* Merge the statistics of all threads */
+
+  memset(&stats, 0, sizeof(struct mm_bench_stats_s));
+  for (i = 0; i < cfg->nthreads; i++)
+    {
+      worker = &g_workers[i];
+
+      stats.nallocs   += worker->stats.nallocs;
+      stats.nfrees    += worker->stats.nfrees;
+      stats.nfailed   += worker->stats.nfailed;
+      stats.allocusec += worker->stats.allocusec;
+      stats.freeusec  += worker->stats.freeusec;
+
+      if (worker->stats.maxalloc > stats.maxalloc)
+        {
+          stats.maxalloc = worker->stats.maxalloc;
+        }
+
+      if (worker->stats.maxfree > stats.maxfree)
+        {
+          stats.maxfree = worker->stats.maxfree;
+        }
+    }
+
+  mm_bench_report(&stats, usec, g_peaklive);
+
+errout:
+  for (i = 0; i < cfg->nthreads; i++)
+    {
+      worker = &g_workers[i];
+
+      if (worker->slots != NULL && worker->sizes != NULL)
+        {
+          for (slot = 0; slot < cfg->nlive; slot++)
+            {
+              free(worker->slots[slot]);
+            }
+        }
+
+      if (worker->pins != NULL)
+        {
+          for (slot = 0; slot < worker->npins; slot++)
+            {
+              free(worker->pins[slot]);
+            }
+        }
+
+      free(worker->slots);
+      free(worker->sizes);
+      free(worker->pins);
+    }
+
+  free(g_workers);
+  g_workers = NULL;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mm_bench_showusage
+ ****************************************************************************/
+
+static void mm_bench_showusage(FAR const char *progname)
+{
+  fprintf(stderr, "USAGE: %s [-t <threads>] [-n <ops>] "
+          "[-d uniform|log|fixed] [-z <min>] [-Z <max>]\n"
+          "          [-l <live>] [-p <pinned%%>] [-i <interval>]\n",
+          progname);
+  fprintf(stderr, "       %s -P <trace> [-i <interval>]\n", progname);
+#ifdef CONFIG_EXAMPLES_MM_BENCH_TRACE
+  fprintf(stderr, "       %s -r <trace> | -R\n", progname);
+#endif
+  fprintf(stderr, "  -t  Contending threads (default: 1, max: %d)\n",
+          CONFIG_EXAMPLES_MM_BENCH_MAXTHREADS);
+  fprintf(stderr, "  -n  Operations per thread (default: 10000)\n");
+  fprintf(stderr, "  -d  Size distribution (default: log)\n");
+  fprintf(stderr, "  -z  Smallest allocation (default: 8)\n");
+  fprintf(stderr, "  -Z  Largest allocation (default: 1024)\n");
+  fprintf(stderr, "  -l  Live allocations per thread (default: 64)\n");
+  fprintf(stderr, "  -p  Percent of allocations never freed during the "
+          "run (default: 0)\n");
+  fprintf(stderr, "  -i  Operations between heap samples (default: "
+          "1000, 0: none)\n");
+  fprintf(stderr, "  -P  Replay a recorded trace\n");
+#ifdef CONFIG_EXAMPLES_MM_BENCH_TRACE
+  fprintf(stderr, "  -r  Start recording all heap operations to a trace\n");
+  fprintf(stderr, "  -R  Stop recording\n");
+#endif
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_bench_sample
+ *
+ * Description:
+ *   Print one line of the heap usage and fragmentation time series and
+ *   update the peaks.  Fragmentation is the part of the free heap that is
+ *   not in the largest free chunk, in percent.
+ *
+ ****************************************************************************/
+
+void mm_bench_sample(uint64_t start, size_t live)
+{
+  struct mallinfo info;
+  unsigned long frag;
+
+#ifdef CONFIG_CAN_PASS_STRUCTS
+  info = mallinfo();
+#else
+  (void)mallinfo(&info);
+#endif
+
+  frag = 0;
+  if (info.fordblks > 0)
+    {
+      frag = 100 - (unsigned long)((uint64_t)info.mxordblk * 100 /
+                                   info.fordblks);
+    }
+
+  if ((size_t)info.uordblks > g_peakused)
+    {
+      g_peakused = info.uordblks;
+    }
+
+  if (live > g_peaklive)
+    {
+      g_peaklive = live;
+    }
+
+  printf("%lu,%lu,%lu,%lu,%lu,%lu,%lu\n", (unsigned long)g_nsamples++,
+         (unsigned long)((bench_usec() - start) / 1000),
+         (unsigned long)info.uordblks, (unsigned long)info.fordblks,
+         (unsigned long)info.mxordblk, frag, (unsigned long)live);
+}
+
+/****************************************************************************
+ * Name: mm_bench_report
+ ****************************************************************************/
+
+void mm_bench_report(FAR const struct mm_bench_stats_s *stats,
+                     uint64_t usec, size_t peaklive)
+{
+  uint32_t nops = stats->nallocs + stats->nfrees;
+
+  if (usec == 0)
+    {
+      usec = 1;
+    }
+
+  printf("\n%lu allocs, %lu frees, %lu failed in %lu ms\n",
+         (unsigned long)stats->nallocs, (unsigned long)stats->nfrees,
+         (unsigned long)stats->nfailed, (unsigned long)(usec / 1000));
+  printf("  Operations/s:  %lu (%lu allocs/s)\n",
+         (unsigned long)((uint64_t)nops * 1000000 / usec),
+         (unsigned long)((uint64_t)stats->nallocs * 1000000 / usec));
+  printf("  Alloc latency: avg %lu usec, worst %lu usec\n",
+         stats->nallocs > 0 ?
+         (unsigned long)(stats->allocusec / stats->nallocs) : 0,
+         (unsigned long)stats->maxalloc);
+  printf("  Free latency:  avg %lu usec, worst %lu usec\n",
+         stats->nfrees > 0 ?
+         (unsigned long)(stats->freeusec / stats->nfrees) : 0,
+         (unsigned long)stats->maxfree);
+  printf("  Peak heap in use: %lu bytes (%lu requested)\n",
+         (unsigned long)g_peakused, (unsigned long)peaklive);
+}
+
+/****************************************************************************
+ * mm_bench_main
+ ****************************************************************************/
+
+#ifdef BUILD_MODULE
+int main(int argc, FAR char *argv[])
+#else
+int mm_bench_main(int argc, char *argv[])
+#endif
+{
+  struct mm_bench_config_s cfg;
+  FAR const char *replay = NULL;
+  int option;
+  int ret;
+
+  memset(&cfg, 0, sizeof(struct mm_bench_config_s));
+  cfg.dist     = MM_DIST_LOG;
+  cfg.minsize  = 8;
+  cfg.maxsize  = 1024;
+  cfg.nops     = 10000;
+  cfg.nlive    = 64;
+  cfg.interval = 1000;
+  cfg.nthreads = 1;
+
+  g_peakused = 0;
+  g_peaklive = 0;
+  g_nsamples = 0;
+
+  while ((option = getopt(argc, argv, "t:n:d:z:Z:l:p:i:P:r:R")) != ERROR)
+    {
+      switch (option)
+        {
+          case 't':
+            cfg.nthreads = atoi(optarg);
+            break;
+
+          case 'n':
+            cfg.nops = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'd':
+            if (strcmp(optarg, "uniform") == 0)
+              {
+                cfg.dist = MM_DIST_UNIFORM;
+              }
+            else if (strcmp(optarg, "log") == 0)
+              {
+                cfg.dist = MM_DIST_LOG;
+              }
+            else if (strcmp(optarg, "fixed") == 0)
+              {
+                cfg.dist = MM_DIST_FIXED;
+              }
+            else
+              {
+                mm_bench_showusage(argv[0]);
+                return EXIT_FAILURE;
+              }
+            break;
+
+          case 'z':
+            cfg.minsize = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'Z':
+            cfg.maxsize = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'l':
+            cfg.nlive = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'p':
+            cfg.pinned = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'i':
+            cfg.interval = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'P':
+            replay = optarg;
+            break;
+
+#ifdef CONFIG_EXAMPLES_MM_BENCH_TRACE
+          case 'r':
+            ret = mm_trace_start(optarg);
+            if (ret < 0)
+              {
+                fprintf(stderr, "ERROR: Failed to start recording: %d\n",
+                        ret);
+                return EXIT_FAILURE;
+              }
+
+            printf("Recording heap operations to %s\n", optarg);
+            return EXIT_SUCCESS;
+
+          case 'R':
+            ret = mm_trace_stop();
+            if (ret < 0)
+              {
+                fprintf(stderr, "ERROR: Not recording\n");
+                return EXIT_FAILURE;
+              }
+
+            return EXIT_SUCCESS;
+#endif
+
+          default:
+            mm_bench_showusage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+  if (optind != argc)
+    {
+      mm_bench_showusage(argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  if (replay != NULL)
+    {
+      ret = mm_bench_replay(replay, cfg.interval);
+    }
+  else
+    {
+      if (cfg.nthreads < 1 ||
+          cfg.nthreads > CONFIG_EXAMPLES_MM_BENCH_MAXTHREADS ||
+          cfg.minsize == 0 || cfg.maxsize < cfg.minsize ||
+          cfg.nlive == 0 || cfg.pinned > 100)
+        {
+          mm_bench_showusage(argv[0]);
+          return EXIT_FAILURE;
+        }
+
+      ret = mm_bench_synthetic(&cfg);
+    }
+
+  if (ret < 0)
+    {
+      fprintf(stderr, "ERROR: Benchmark failed: %d\n", ret);
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
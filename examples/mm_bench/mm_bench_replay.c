@@ -0,0 +1,508 @@
+/****************************************************************************
+ * examples/mm_bench/mm_bench_replay.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "mm_bench.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define REPLAY_LINESIZE  64
+#define REPLAY_NOSLOT    UINT32_MAX
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One operation of the trace.  The recorded addresses are replaced by slot
+ * numbers when the trace is loaded:  each allocation gets a new slot and
+ * the free or realloc that ends it refers back to that slot.
+ */
+
+struct replay_op_s
+{
+  uint8_t  type;                /* MM_TRACE_* */
+  uint32_t slot;                /* Slot allocated or freed */
+  uint32_t oldslot;             /* realloc(): slot reallocated */
+  size_t   size;                /* Allocation size */
+  size_t   align;               /* memalign() alignment */
+};
+
+/* Maps a recorded address to the slot of the allocation that is live at
+ * that address.  Chained by slot number.
+ */
+
+struct replay_map_s
+{
+  FAR uint32_t *buckets;        /* First slot of each hash chain */
+  FAR uint32_t *next;           /* Next slot in the chain, by slot */
+  FAR uintptr_t *addr;          /* Recorded address, by slot */
+  uint32_t nbuckets;            /* Power of two */
+};
+
+struct replay_s
+{
+  FAR struct replay_op_s *ops;  /* The trace */
+  uint32_t nops;                /* Number of operations in ops[] */
+  uint32_t nslots;              /* Number of allocations in the trace */
+  uint32_t nskipped;            /* Frees of unknown addresses, bad lines */
+  struct replay_map_s map;
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: replay_hash
+ ****************************************************************************/
+
+static uint32_t replay_hash(FAR struct replay_map_s *map, uintptr_t addr)
+{
+  /* Heap addresses are aligned, so drop the low bits */
+
+  return (uint32_t)((addr >> 3) * 2654435761u) & (map->nbuckets - 1);
+}
+
+/****************************************************************************
+ * Name: replay_insert
+ *
+ * Description:
+ *   Start a new allocation at 'addr' and return its slot.
+ *
+ ****************************************************************************/
+
+static uint32_t replay_insert(FAR struct replay_s *replay, uintptr_t addr)
+{
+  FAR struct replay_map_s *map = &replay->map;
+  uint32_t hash = replay_hash(map, addr);
+  uint32_t slot = replay->nslots++;
+
+  map->addr[slot]     = addr;
+  map->next[slot]     = map->buckets[hash];
+  map->buckets[hash]  = slot;
+  return slot;
+}
+
+/****************************************************************************
+ * Name: replay_remove
+ *
+ * Description:
+ *   End the allocation at 'addr' and return its slot, or REPLAY_NOSLOT if
+ *   there is none (it was made before recording started).
+ *
+ ****************************************************************************/
+
+static uint32_t replay_remove(FAR struct replay_s *replay, uintptr_t addr)
+{
+  FAR struct replay_map_s *map = &replay->map;
+  FAR uint32_t *prev;
+  uint32_t slot;
+
+  prev = &map->buckets[replay_hash(map, addr)];
+  for (slot = *prev; slot != REPLAY_NOSLOT; slot = *prev)
+    {
+      if (map->addr[slot] == addr)
+        {
+          *prev = map->next[slot];
+          return slot;
+        }
+
+      prev = &map->next[slot];
+    }
+
+  return REPLAY_NOSLOT;
+}
+
+/****************************************************************************
+ * Name: replay_parse
+ *
+ * Description:
+ *   Convert one trace line to an operation.  Returns false if the line does
+ *   not add an operation to the replay.
+ *
+ ****************************************************************************/
+
+static bool replay_parse(FAR struct replay_s *replay, FAR const char *line,
+                         FAR struct replay_op_s *op)
+{
+  unsigned long addr;
+  unsigned long newaddr;
+  unsigned long arg;
+  unsigned long size;
+  char type = line[0];
+
+  memset(op, 0, sizeof(struct replay_op_s));
+
+  switch (type)
+    {
+      case MM_TRACE_MALLOC:
+      case MM_TRACE_ZALLOC:
+        if (sscanf(&line[1], "%lx %lu", &addr, &size) != 2 || addr == 0)
+          {
+            break;
+          }
+
+        op->type = type;
+        op->size = size;
+        op->slot = replay_insert(replay, addr);
+        return true;
+
+      case MM_TRACE_MEMALIGN:
+        if (sscanf(&line[1], "%lx %lu %lu", &addr, &arg, &size) != 3 ||
+            addr == 0)
+          {
+            break;
+          }
+
+        op->type  = type;
+        op->align = arg;
+        op->size  = size;
+        op->slot  = replay_insert(replay, addr);
+        return true;
+
+      case MM_TRACE_REALLOC:
+        if (sscanf(&line[1], "%lx %lx %lu", &addr, &newaddr, &size) != 3)
+          {
+            break;
+          }
+
+        if (newaddr == 0)
+          {
+            /* A failed realloc() leaves the old allocation alone; a
+             * realloc() to zero bytes frees it.
+             */
+
+            if (size != 0 || addr == 0)
+              {
+                break;
+              }
+
+            op->type = MM_TRACE_FREE;
+            op->slot = replay_remove(replay, addr);
+            if (op->slot == REPLAY_NOSLOT)
+              {
+                break;
+              }
+
+            return true;
+          }
+
+        op->oldslot = addr != 0 ? replay_remove(replay, addr) :
+                                  REPLAY_NOSLOT;
+
+        /* A realloc() of an unknown allocation is replayed as malloc() */
+
+        op->type = op->oldslot == REPLAY_NOSLOT ? MM_TRACE_MALLOC :
+                                                  MM_TRACE_REALLOC;
+        op->size = size;
+        op->slot = replay_insert(replay, newaddr);
+        return true;
+
+      case MM_TRACE_FREE:
+        if (sscanf(&line[1], "%lx", &addr) != 1 || addr == 0)
+          {
+            break;
+          }
+
+        op->type = type;
+        op->slot = replay_remove(replay, addr);
+        if (op->slot == REPLAY_NOSLOT)
+          {
+            break;
+          }
+
+        return true;
+
+      case '\0':
+      case '\n':
+      case '#':
+        return false;
+
+      default:
+        break;
+    }
+
+  replay->nskipped++;
+  return false;
+}
+
+/****************************************************************************
+ * Name: replay_load
+ *
+ * Description:
+ *   Read the trace into memory, so that file I/O is not part of the timed
+ *   replay.  The file is read twice:  once to size the tables and once to
+ *   fill them.
+ *
+ ****************************************************************************/
+
+static int replay_load(FAR struct replay_s *replay, FAR const char *path)
+{
+  FAR struct replay_map_s *map = &replay->map;
+  char line[REPLAY_LINESIZE];
+  FAR FILE *stream;
+  uint32_t nlines;
+  uint32_t i;
+  int errcode;
+
+  stream = fopen(path, "r");
+  if (stream == NULL)
+    {
+      errcode = errno;
+      fprintf(stderr, "ERROR: Failed to open %s: %d\n", path, errcode);
+      return -errcode;
+    }
+
+  for (nlines = 0; fgets(line, sizeof(line), stream) != NULL; nlines++);
+
+  if (nlines == 0)
+    {
+      fprintf(stderr, "ERROR: %s is empty\n", path);
+      fclose(stream);
+      return -EINVAL;
+    }
+
+  for (map->nbuckets = 16; map->nbuckets < nlines; map->nbuckets <<= 1);
+
+  replay->ops  = (FAR struct replay_op_s *)
+    malloc(nlines * sizeof(struct replay_op_s));
+  map->buckets = (FAR uint32_t *)malloc(map->nbuckets * sizeof(uint32_t));
+  map->next    = (FAR uint32_t *)malloc(nlines * sizeof(uint32_t));
+  map->addr    = (FAR uintptr_t *)malloc(nlines * sizeof(uintptr_t));
+
+  if (replay->ops == NULL || map->buckets == NULL || map->next == NULL ||
+      map->addr == NULL)
+    {
+      fclose(stream);
+      return -ENOMEM;
+    }
+
+  for (i = 0; i < map->nbuckets; i++)
+    {
+      map->buckets[i] = REPLAY_NOSLOT;
+    }
+
+  rewind(stream);
+  while (replay->nops < nlines && fgets(line, sizeof(line), stream) != NULL)
+    {
+      if (replay_parse(replay, line, &replay->ops[replay->nops]))
+        {
+          replay->nops++;
+        }
+    }
+
+  fclose(stream);
+
+  /* Only the slot numbers are needed from here on */
+
+  free(map->buckets);
+  free(map->next);
+  free(map->addr);
+  map->buckets = NULL;
+  map->next    = NULL;
+  map->addr    = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_bench_replay
+ ****************************************************************************/
+
+int mm_bench_replay(FAR const char *path, uint32_t interval)
+{
+  FAR struct replay_op_s *op;
+  struct mm_bench_stats_s stats;
+  struct replay_s replay;
+  FAR void **slots = NULL;
+  FAR size_t *sizes = NULL;
+  FAR void *mem;
+  uint64_t start;
+  uint64_t begin;
+  uint64_t elapsed;
+  uint32_t usec;
+  uint32_t i;
+  size_t live = 0;
+  size_t peaklive = 0;
+  int ret;
+
+  memset(&replay, 0, sizeof(struct replay_s));
+  memset(&stats, 0, sizeof(struct mm_bench_stats_s));
+
+  ret = replay_load(&replay, path);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  slots = (FAR void **)calloc(replay.nslots + 1, sizeof(FAR void *));
+  sizes = (FAR size_t *)calloc(replay.nslots + 1, sizeof(size_t));
+  if (slots == NULL || sizes == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  printf("Replaying %lu operations (%lu allocations, %lu skipped)\n",
+         (unsigned long)replay.nops, (unsigned long)replay.nslots,
+         (unsigned long)replay.nskipped);
+  printf("sample,msec,used,free,largest,frag,live\n");
+
+  begin = bench_usec();
+  mm_bench_sample(begin, 0);
+
+  for (i = 0; i < replay.nops; i++)
+    {
+      op = &replay.ops[i];
+
+      if (op->type == MM_TRACE_FREE)
+        {
+          /* The allocation may have failed during the replay */
+
+          if (slots[op->slot] != NULL)
+            {
+              start = bench_usec();
+              free(slots[op->slot]);
+              usec  = (uint32_t)(bench_usec() - start);
+
+              stats.nfrees++;
+              stats.freeusec += usec;
+              if (usec > stats.maxfree)
+                {
+                  stats.maxfree = usec;
+                }
+
+              live -= sizes[op->slot];
+              slots[op->slot] = NULL;
+            }
+        }
+      else
+        {
+          start = bench_usec();
+          switch (op->type)
+            {
+              case MM_TRACE_MALLOC:
+              default:
+                mem = malloc(op->size);
+                break;
+
+              case MM_TRACE_ZALLOC:
+                mem = zalloc(op->size);
+                break;
+
+              case MM_TRACE_MEMALIGN:
+                mem = memalign(op->align, op->size);
+                break;
+
+              case MM_TRACE_REALLOC:
+                mem = realloc(slots[op->oldslot], op->size);
+                break;
+            }
+
+          usec = (uint32_t)(bench_usec() - start);
+
+          stats.nallocs++;
+          stats.allocusec += usec;
+          if (usec > stats.maxalloc)
+            {
+              stats.maxalloc = usec;
+            }
+
+          if (mem == NULL)
+            {
+              stats.nfailed++;
+            }
+          else
+            {
+              if (op->type == MM_TRACE_REALLOC)
+                {
+                  live -= sizes[op->oldslot];
+                  sizes[op->oldslot] = 0;
+                  slots[op->oldslot] = NULL;
+                }
+
+              live += op->size;
+              slots[op->slot] = mem;
+              sizes[op->slot] = op->size;
+
+              if (live > peaklive)
+                {
+                  peaklive = live;
+                }
+            }
+        }
+
+      if (interval > 0 && (i + 1) % interval == 0)
+        {
+          mm_bench_sample(begin, live);
+        }
+    }
+
+  elapsed = bench_usec() - begin;
+  mm_bench_sample(begin, live);
+  mm_bench_report(&stats, elapsed, peaklive);
+
+  /* Whatever the trace did not free */
+
+  for (i = 0; i < replay.nslots; i++)
+    {
+      free(slots[i]);
+    }
+
+errout:
+  free(slots);
+  free(sizes);
+  free(replay.ops);
+  free(replay.map.buckets);
+  free(replay.map.next);
+  free(replay.map.addr);
+  return ret;
+}
@@ -0,0 +1,443 @@
+/****************************************************************************
+ * examples/mm_bench/mm_trace.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <errno.h>
+
+#include <nuttx/irq.h>
+
+#include "mm_bench.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TRACE_BATCH 16
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+enum mm_trace_state_e
+{
+  TRACE_STOPPED = 0,            /* No trace writer */
+  TRACE_STARTED,                /* Writer started, not yet recording */
+  TRACE_RUNNING,                /* Recording */
+  TRACE_STOP_REQUESTED          /* Writer asked to flush and exit */
+};
+
+struct mm_trace_record_s
+{
+  uint8_t   type;               /* MM_TRACE_* */
+  uintptr_t addr;               /* Allocation, or realloc() old address */
+  uintptr_t arg;                /* realloc() new address, memalign() align */
+  size_t    size;               /* Requested size */
+};
+
+struct mm_trace_s
+{
+  volatile uint8_t state;       /* See enum mm_trace_state_e */
+  sem_t interlock;              /* Start and stop handshakes */
+  sem_t wakeup;                 /* Ring half full or stop requested */
+  pid_t pid;                    /* Task ID of the writer */
+  FAR const char *path;         /* Trace file */
+  uint32_t head;                /* Next record to write to the file */
+  uint32_t tail;                /* Next free record */
+
+  /* head, tail, ndropped and the ring are accessed in a critical section,
+   * which also excludes the other CPUs in an SMP configuration.
+   */
+
+  uint32_t nrecorded;           /* Records written to the file */
+  uint32_t ndropped;            /* Records lost to a full ring */
+  struct mm_trace_record_s ring[CONFIG_EXAMPLES_MM_BENCH_TRACE_NRECORDS];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct mm_trace_s g_trace;
+static bool g_initialized;
+
+/****************************************************************************
+ * External Function Prototypes
+ ****************************************************************************/
+
+/* The real allocator, when linked with --wrap */
+
+FAR void *__real_malloc(size_t size);
+FAR void *__real_zalloc(size_t size);
+FAR void *__real_calloc(size_t n, size_t size);
+FAR void *__real_memalign(size_t alignment, size_t size);
+FAR void *__real_realloc(FAR void *oldmem, size_t size);
+void __real_free(FAR void *mem);
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_trace_record
+ *
+ * Description:
+ *   Add one operation to the ring.  This is called for every heap operation
+ *   of every task, so it only copies the record and wakes the writer when
+ *   the ring is half full.  The writer's own allocations are not recorded.
+ *
+ ****************************************************************************/
+
+static void mm_trace_record(uint8_t type, FAR void *addr, uintptr_t arg,
+                            size_t size)
+{
+  FAR struct mm_trace_record_s *rec;
+  irqstate_t flags;
+  uint32_t count;
+
+  if (g_trace.state != TRACE_RUNNING || getpid() == g_trace.pid)
+    {
+      return;
+    }
+
+  flags = enter_critical_section();
+
+  /* Check again:  the writer may have made its final drain while we were
+   * getting here on another CPU.
+   */
+
+  if (g_trace.state != TRACE_RUNNING)
+    {
+      leave_critical_section(flags);
+      return;
+    }
+
+  count = g_trace.tail - g_trace.head;
+  if (count >= CONFIG_EXAMPLES_MM_BENCH_TRACE_NRECORDS)
+    {
+      g_trace.ndropped++;
+    }
+  else
+    {
+      rec       = &g_trace.ring[g_trace.tail %
+                                CONFIG_EXAMPLES_MM_BENCH_TRACE_NRECORDS];
+      rec->type = type;
+      rec->addr = (uintptr_t)addr;
+      rec->arg  = arg;
+      rec->size = size;
+
+      g_trace.tail++;
+
+      if (count + 1 == CONFIG_EXAMPLES_MM_BENCH_TRACE_NRECORDS / 2)
+        {
+          sem_post(&g_trace.wakeup);
+        }
+    }
+
+  leave_critical_section(flags);
+}
+
+/****************************************************************************
+ * Name: mm_trace_drain
+ *
+ * Description:
+ *   Write all records in the ring to the trace file.  Records are copied
+ *   out in small batches so that the heap is not blocked by file I/O.
+ *
+ ****************************************************************************/
+
+static void mm_trace_drain(FAR FILE *stream)
+{
+  struct mm_trace_record_s batch[TRACE_BATCH];
+  FAR struct mm_trace_record_s *rec;
+  irqstate_t flags;
+  uint32_t nbatch;
+  uint32_t i;
+
+  do
+    {
+      flags = enter_critical_section();
+      for (nbatch = 0;
+           nbatch < TRACE_BATCH && g_trace.head != g_trace.tail;
+           nbatch++, g_trace.head++)
+        {
+          i = g_trace.head % CONFIG_EXAMPLES_MM_BENCH_TRACE_NRECORDS;
+          batch[nbatch] = g_trace.ring[i];
+        }
+
+      leave_critical_section(flags);
+
+      for (i = 0; i < nbatch; i++)
+        {
+          rec = &batch[i];
+          switch (rec->type)
+            {
+              case MM_TRACE_MALLOC:
+              case MM_TRACE_ZALLOC:
+                fprintf(stream, "%c %lx %lu\n", rec->type,
+                        (unsigned long)rec->addr, (unsigned long)rec->size);
+                break;
+
+              case MM_TRACE_MEMALIGN:
+                fprintf(stream, "%c %lx %lu %lu\n", rec->type,
+                        (unsigned long)rec->addr, (unsigned long)rec->arg,
+                        (unsigned long)rec->size);
+                break;
+
+              case MM_TRACE_REALLOC:
+                fprintf(stream, "%c %lx %lx %lu\n", rec->type,
+                        (unsigned long)rec->addr, (unsigned long)rec->arg,
+                        (unsigned long)rec->size);
+                break;
+
+              case MM_TRACE_FREE:
+                fprintf(stream, "%c %lx\n", rec->type,
+                        (unsigned long)rec->addr);
+                break;
+            }
+        }
+
+      g_trace.nrecorded += nbatch;
+    }
+  while (nbatch > 0);
+}
+
+/****************************************************************************
+ * Name: mm_trace_daemon
+ ****************************************************************************/
+
+static int mm_trace_daemon(int argc, FAR char *argv[])
+{
+  FAR FILE *stream;
+
+  g_trace.pid = getpid();
+
+  stream = fopen(g_trace.path, "w");
+  if (stream == NULL)
+    {
+      fprintf(stderr, "ERROR: Failed to open %s: %d\n", g_trace.path, errno);
+      g_trace.state = TRACE_STOPPED;
+      sem_post(&g_trace.interlock);
+      return EXIT_FAILURE;
+    }
+
+  fprintf(stream, "# mm_bench heap trace\n");
+
+  /* Recording starts now */
+
+  g_trace.state = TRACE_RUNNING;
+  sem_post(&g_trace.interlock);
+
+  while (g_trace.state == TRACE_RUNNING)
+    {
+      (void)sem_wait(&g_trace.wakeup);
+      mm_trace_drain(stream);
+    }
+
+  /* Stop requested:  nothing more is added to the ring */
+
+  mm_trace_drain(stream);
+  fclose(stream);
+
+  printf("mm_trace: %lu records written, %lu dropped\n",
+         (unsigned long)g_trace.nrecorded, (unsigned long)g_trace.ndropped);
+
+  g_trace.state = TRACE_STOPPED;
+  sem_post(&g_trace.interlock);
+  return EXIT_SUCCESS;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: __wrap_malloc, etc.
+ *
+ * Description:
+ *   With --wrap, every call to malloc() etc. in the program comes here.
+ *   Frees are recorded before the memory is released and allocations after
+ *   it is obtained, so that a reused address is never recorded out of
+ *   order.  realloc() releases and obtains in one call; if another thread
+ *   reuses the old address in between, the replay skips what it cannot
+ *   pair.
+ *
+ ****************************************************************************/
+
+FAR void *__wrap_malloc(size_t size)
+{
+  FAR void *mem = __real_malloc(size);
+  mm_trace_record(MM_TRACE_MALLOC, mem, 0, size);
+  return mem;
+}
+
+FAR void *__wrap_zalloc(size_t size)
+{
+  FAR void *mem = __real_zalloc(size);
+  mm_trace_record(MM_TRACE_ZALLOC, mem, 0, size);
+  return mem;
+}
+
+FAR void *__wrap_calloc(size_t n, size_t size)
+{
+  FAR void *mem = __real_calloc(n, size);
+  mm_trace_record(MM_TRACE_ZALLOC, mem, 0, n * size);
+  return mem;
+}
+
+FAR void *__wrap_memalign(size_t alignment, size_t size)
+{
+  FAR void *mem = __real_memalign(alignment, size);
+  mm_trace_record(MM_TRACE_MEMALIGN, mem, alignment, size);
+  return mem;
+}
+
+FAR void *__wrap_realloc(FAR void *oldmem, size_t size)
+{
+  FAR void *mem = __real_realloc(oldmem, size);
+  mm_trace_record(MM_TRACE_REALLOC, oldmem, (uintptr_t)mem, size);
+  return mem;
+}
+
+void __wrap_free(FAR void *mem)
+{
+  if (mem != NULL)
+    {
+      mm_trace_record(MM_TRACE_FREE, mem, 0, 0);
+    }
+
+  __real_free(mem);
+}
+
+/****************************************************************************
+ * Name: mm_trace_start
+ ****************************************************************************/
+
+int mm_trace_start(FAR const char *path)
+{
+  int ret = OK;
+
+  sched_lock();
+  if (g_trace.state != TRACE_STOPPED)
+    {
+      sched_unlock();
+      return -EBUSY;
+    }
+
+  if (!g_initialized)
+    {
+      sem_init(&g_trace.interlock, 0, 0);
+      sem_init(&g_trace.wakeup, 0, 0);
+      g_initialized = true;
+    }
+
+  g_trace.path      = path;
+  g_trace.pid       = -1;
+  g_trace.head      = 0;
+  g_trace.tail      = 0;
+  g_trace.nrecorded = 0;
+  g_trace.ndropped  = 0;
+  g_trace.state     = TRACE_STARTED;
+
+  ret = task_create("mm_trace", CONFIG_EXAMPLES_MM_BENCH_TRACE_PRIORITY,
+                    CONFIG_EXAMPLES_MM_BENCH_TRACE_STACKSIZE,
+                    mm_trace_daemon, NULL);
+  if (ret < 0)
+    {
+      ret = -errno;
+      g_trace.state = TRACE_STOPPED;
+      sched_unlock();
+      return ret;
+    }
+
+  /* Wait until the writer is recording or has failed */
+
+  do
+    {
+      (void)sem_wait(&g_trace.interlock);
+    }
+  while (g_trace.state == TRACE_STARTED);
+
+  ret = g_trace.state == TRACE_RUNNING ? OK : -EIO;
+  sched_unlock();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mm_trace_stop
+ ****************************************************************************/
+
+int mm_trace_stop(void)
+{
+  irqstate_t flags;
+
+  sched_lock();
+  if (g_trace.state != TRACE_RUNNING)
+    {
+      sched_unlock();
+      return -ESRCH;
+    }
+
+  /* Change the state inside the critical section so that a record in
+   * progress on another CPU is complete before the final drain.
+   */
+
+  flags = enter_critical_section();
+  g_trace.state = TRACE_STOP_REQUESTED;
+  leave_critical_section(flags);
+
+  sem_post(&g_trace.wakeup);
+
+  do
+    {
+      (void)sem_wait(&g_trace.interlock);
+    }
+  while (g_trace.state == TRACE_STOP_REQUESTED);
+
+  sched_unlock();
+  return OK;
+}
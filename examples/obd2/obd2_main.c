@@ -44,6 +44,49 @@
 #include "canutils/obd_pid.h"
 #include "canutils/obd_frame.h"
 
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_EXAMPLES_OBD2_SIMECU
+int obd2_simecu_start(FAR const char *devpath);
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: obd2_pollcb
+ *
+ * Description:
+ *   Show each response received by the polling engine.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_LIBOBD2_POLL
+static void obd2_pollcb(FAR struct obd_dev_s *dev, FAR void *arg,
+                        uint8_t ecu, uint8_t opmode, uint8_t pid,
+                        FAR const uint8_t *data, size_t len)
+{
+  FAR char *value;
+
+  if (data == NULL)
+    {
+      printf("Mode %02x PID %02x: no response\n", opmode, pid);
+    }
+  else if (opmode == OBD_RQST_VEHICLE_INFO && pid == OBD_INFO_VIN && len > 3)
+    {
+      printf("ECU %u: VIN = %.*s\n", ecu, (int)(len - 3), &data[3]);
+    }
+  else if (opmode == OBD_SHOW_DATA)
+    {
+      value = obd_decode_pid(dev, pid);
+      printf("ECU %u: PID %02x = %s\n", ecu, pid, value ? value : "?");
+    }
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -59,8 +102,20 @@ int obd2_main(int argc, char *argv[])
 #endif
 {
   struct obd_dev_s *dev;
+#ifdef CONFIG_LIBOBD2_POLL
+  struct obd_pollstats_s stats;
+#endif
   int ret;
 
+#ifdef CONFIG_EXAMPLES_OBD2_SIMECU
+  ret = obd2_simecu_start(CONFIG_EXAMPLES_OBD2_SIMECU_DEVPATH);
+  if (ret < 0)
+    {
+      printf("Failed to start the ECU stand-in!\n");
+      return -1;
+    }
+#endif
+
   dev = obd_init("/dev/can0", 0, 0);
   if (!dev)
     {
@@ -90,5 +145,40 @@ int obd2_main(int argc, char *argv[])
 
   printf("RPM = %s\n", obd_decode_pid(dev, OBD_PID_RPM));
 
+#ifdef CONFIG_LIBOBD2_POLL
+  /* Poll a small dashboard, each PID at its own rate */
+
+  ret = obd_poll_init(dev, obd2_pollcb, NULL);
+  if (ret < 0)
+    {
+      printf("Failed to initialize the polling engine!\n");
+      return -1;
+    }
+
+  obd_poll_add(dev, OBD_SHOW_DATA, OBD_PID_SUPPORTED, 0);
+  obd_poll_add(dev, OBD_SHOW_DATA, OBD_PID_RPM, 100);
+  obd_poll_add(dev, OBD_SHOW_DATA, OBD_PID_SPEED, 200);
+  obd_poll_add(dev, OBD_SHOW_DATA, OBD_PID_THROTTLE_POSITION, 200);
+  obd_poll_add(dev, OBD_SHOW_DATA, OBD_PID_ENGINE_TEMPERATURE, 1000);
+#ifdef CONFIG_LIBOBD2_MULTIFRAME
+  obd_poll_add(dev, OBD_RQST_VEHICLE_INFO, OBD_INFO_VIN, 0);
+#endif
+
+  ret = obd_poll_run(dev, CONFIG_EXAMPLES_OBD2_POLLTIME);
+  if (ret < 0)
+    {
+      printf("Polling failed: %d\n", ret);
+    }
+
+  obd_poll_getstats(dev, &stats);
+  printf("Requests: %lu Responses: %lu Timeouts: %lu Errors: %lu "
+         "Max RTT: %lu ms\n",
+         (unsigned long)stats.requests, (unsigned long)stats.responses,
+         (unsigned long)stats.timeouts, (unsigned long)stats.errors,
+         (unsigned long)stats.maxrtt);
+
+  obd_poll_uninit(dev);
+#endif
+
   return 0;
 }
@@ -0,0 +1,367 @@
+/****************************************************************************
+ * examples/obd2/obd2_simecu.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <errno.h>
+
+#include <nuttx/can/can.h>
+
+#include "canutils/obd.h"
+#include "canutils/obd_pid.h"
+#include "canutils/obd_frame.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define SIMECU_ENGINE        0          /* Answers on 0x7e8 */
+#define SIMECU_TRANSMISSION  1          /* Answers on 0x7e9 */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct obd2_simecu_s
+{
+  int fd;                               /* CAN device of the stand-in */
+  uint32_t nrequests;                   /* Drives the scripted values */
+  uint8_t vinpos;                       /* Next VIN byte to send, 0 = none */
+  uint8_t vinseq;                       /* Next consecutive frame number */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct obd2_simecu_s g_simecu;
+
+/* Mode 09 PID 02 response: mode, PID, number of data items, VIN */
+
+static const uint8_t g_vinresp[] =
+{
+  OBD_RQST_VEHICLE_INFO + OBD_RESP_BASE, OBD_INFO_VIN, 1,
+  '1', 'N', 'U', 'T', 'T', 'X', 'S', 'I', 'M', '0', '0', '0',
+  '0', '0', '0', '0', '1'
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: obd2_simecu_send
+ ****************************************************************************/
+
+static void obd2_simecu_send(FAR struct obd2_simecu_s *sim, int ecu,
+                             FAR const uint8_t *data)
+{
+  struct can_msg_s msg;
+
+  memset(&msg, 0, sizeof(struct can_msg_s));
+  msg.cm_hdr.ch_id  = OBD_PID_STD_RESPONSE_FIRST + ecu;
+  msg.cm_hdr.ch_dlc = 8;
+  memcpy(msg.cm_data, data, 8);
+
+  if (write(sim->fd, &msg, CAN_MSGLEN(8)) != CAN_MSGLEN(8))
+    {
+      printf("simecu: write failed: %d\n", errno);
+    }
+}
+
+/****************************************************************************
+ * Name: obd2_simecu_showdata
+ *
+ * Description:
+ *   Answer a mode 01 request.  Unknown PIDs are not answered, as by an ECU
+ *   that does not support them.
+ *
+ ****************************************************************************/
+
+static void obd2_simecu_showdata(FAR struct obd2_simecu_s *sim, uint8_t pid)
+{
+  uint8_t data[8];
+  uint32_t count = sim->nrequests;
+  uint32_t pids;
+  uint16_t rpm;
+  int len;
+
+  memset(data, 0, 8);
+  data[1] = OBD_SHOW_DATA + OBD_RESP_BASE;
+  data[2] = pid;
+
+  switch (pid)
+    {
+      case OBD_PID_SUPPORTED:
+
+        /* Bit 31 is PID 01, bit 0 is PID 20 */
+
+        pids = (1 << (32 - OBD_PID_ENGINE_TEMPERATURE)) |
+               (1 << (32 - OBD_PID_RPM)) |
+               (1 << (32 - OBD_PID_SPEED)) |
+               (1 << (32 - OBD_PID_THROTTLE_POSITION));
+
+        data[3] = pids >> 24;
+        data[4] = pids >> 16;
+        data[5] = pids >> 8;
+        data[6] = pids;
+        len     = 6;
+        break;
+
+      case OBD_PID_ENGINE_TEMPERATURE:
+        data[3] = 40 + 60 + (count / 64) % 30;
+        len     = 3;
+        break;
+
+      case OBD_PID_RPM:
+        rpm     = 4 * (800 + (count * 37) % 3000);
+        data[3] = rpm >> 8;
+        data[4] = rpm & 0xff;
+        len     = 4;
+        break;
+
+      case OBD_PID_SPEED:
+        data[3] = (count / 4) % 120;
+        len     = 3;
+        break;
+
+      case OBD_PID_THROTTLE_POSITION:
+        data[3] = (count * 7) & 0xff;
+        len     = 3;
+        break;
+
+      default:
+        return;
+    }
+
+  data[0] = OBD_SINGLE_FRAME | OBD_SF_DATA_LEN(len);
+  obd2_simecu_send(sim, SIMECU_ENGINE, data);
+
+  /* The transmission also knows the vehicle speed */
+
+  if (pid == OBD_PID_SPEED)
+    {
+      obd2_simecu_send(sim, SIMECU_TRANSMISSION, data);
+    }
+}
+
+/****************************************************************************
+ * Name: obd2_simecu_vin
+ *
+ * Description:
+ *   Send the first frame of the VIN.  The rest follows the flow control
+ *   frame from the tester.
+ *
+ ****************************************************************************/
+
+static void obd2_simecu_vin(FAR struct obd2_simecu_s *sim)
+{
+  uint8_t data[8];
+
+  data[0] = OBD_FIRST_FRAME | (sizeof(g_vinresp) >> 8);
+  data[1] = sizeof(g_vinresp) & 0xff;
+  memcpy(&data[2], g_vinresp, 6);
+
+  sim->vinpos = 6;
+  sim->vinseq = 1;
+  obd2_simecu_send(sim, SIMECU_ENGINE, data);
+}
+
+/****************************************************************************
+ * Name: obd2_simecu_flowcontrol
+ ****************************************************************************/
+
+static void obd2_simecu_flowcontrol(FAR struct obd2_simecu_s *sim)
+{
+  uint8_t data[8];
+  int ncopy;
+
+  while (sim->vinpos > 0 && sim->vinpos < sizeof(g_vinresp))
+    {
+      ncopy = sizeof(g_vinresp) - sim->vinpos;
+      if (ncopy > 7)
+        {
+          ncopy = 7;
+        }
+
+      memset(data, 0, 8);
+      data[0] = OBD_CONSEC_FRAME | OBD_CF_SEQ_NUM(sim->vinseq);
+      memcpy(&data[1], &g_vinresp[sim->vinpos], ncopy);
+      obd2_simecu_send(sim, SIMECU_ENGINE, data);
+
+      sim->vinpos += ncopy;
+      sim->vinseq  = (sim->vinseq + 1) & 0x0f;
+    }
+
+  sim->vinpos = 0;
+}
+
+/****************************************************************************
+ * Name: obd2_simecu_message
+ ****************************************************************************/
+
+static void obd2_simecu_message(FAR struct obd2_simecu_s *sim,
+                                FAR const struct can_msg_s *msg)
+{
+  FAR const uint8_t *data = msg->cm_data;
+
+  if (msg->cm_hdr.ch_dlc < 3)
+    {
+      return;
+    }
+
+  /* Functional requests to all ECUs */
+
+  if (msg->cm_hdr.ch_id == OBD_PID_STD_REQUEST &&
+      OBD_FRAME_TYPE(data[0]) == OBD_SINGLE_FRAME)
+    {
+      sim->nrequests++;
+
+      if (data[1] == OBD_SHOW_DATA)
+        {
+          obd2_simecu_showdata(sim, data[2]);
+        }
+      else if (data[1] == OBD_RQST_VEHICLE_INFO && data[2] == OBD_INFO_VIN)
+        {
+          obd2_simecu_vin(sim);
+        }
+    }
+
+  /* Flow control addressed to the engine ECU */
+
+  else if (msg->cm_hdr.ch_id == OBD_PID_STD_ECU_REQUEST + SIMECU_ENGINE &&
+           OBD_FRAME_TYPE(data[0]) == OBD_FLWCTRL_FRAME)
+    {
+      obd2_simecu_flowcontrol(sim);
+    }
+}
+
+/****************************************************************************
+ * Name: obd2_simecu_thread
+ ****************************************************************************/
+
+static FAR void *obd2_simecu_thread(FAR void *arg)
+{
+  FAR struct obd2_simecu_s *sim = (FAR struct obd2_simecu_s *)arg;
+  struct can_msg_s rxbuf[4];
+  struct can_msg_s msg;
+  FAR const uint8_t *ptr;
+  ssize_t nbytes;
+  size_t msglen;
+
+  for (; ; )
+    {
+      nbytes = read(sim->fd, rxbuf, sizeof(rxbuf));
+      if (nbytes < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          printf("simecu: read failed: %d\n", errno);
+          break;
+        }
+
+      /* The driver packs the messages, each only as long as its data */
+
+      ptr = (FAR const uint8_t *)rxbuf;
+      while (nbytes >= CAN_MSGLEN(0))
+        {
+          memcpy(&msg, ptr, CAN_MSGLEN(0));
+          msglen = CAN_MSGLEN(msg.cm_hdr.ch_dlc);
+          if (msglen > (size_t)nbytes)
+            {
+              break;
+            }
+
+          memcpy(&msg, ptr, msglen);
+          obd2_simecu_message(sim, &msg);
+
+          ptr    += msglen;
+          nbytes -= msglen;
+        }
+    }
+
+  close(sim->fd);
+  return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: obd2_simecu_start
+ *
+ * Description:
+ *   Start the scripted ECU stand-in on the CAN device at devpath.
+ *
+ ****************************************************************************/
+
+int obd2_simecu_start(FAR const char *devpath)
+{
+  pthread_t thread;
+  int ret;
+
+  g_simecu.fd = open(devpath, O_RDWR);
+  if (g_simecu.fd < 0)
+    {
+      int errcode = errno;
+      printf("simecu: open %s failed: %d\n", devpath, errcode);
+      return -errcode;
+    }
+
+  ret = pthread_create(&thread, NULL, obd2_simecu_thread, &g_simecu);
+  if (ret != 0)
+    {
+      printf("simecu: pthread_create failed: %d\n", ret);
+      close(g_simecu.fd);
+      return -ret;
+    }
+
+  pthread_detach(thread);
+  return OK;
+}
@@ -0,0 +1,323 @@
+/****************************************************************************
+ * examples/passwd_bench/passwd_bench_main.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+#include "fsutils/passwd.h"
+#include "testing/bench.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_PASSWD_BENCH_THREAD_STACKSIZE
+#  define CONFIG_EXAMPLES_PASSWD_BENCH_THREAD_STACKSIZE 2048
+#endif
+
+#define BENCH_MAXTHREADS 16
+#define BENCH_NAMELEN    16
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bench_thread_s
+{
+  pthread_t thread;             /* Login thread */
+  int first;                    /* First user this thread logs in as */
+  unsigned long nmatch;         /* Logins that matched */
+  unsigned long nfail;          /* Logins that did not */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int g_nusers = 32;
+static unsigned long g_nlogins = 200;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: bench_user
+ *
+ * Description:
+ *   Generate the user name and password of benchmark user number ndx.
+ *
+ ****************************************************************************/
+
+static void bench_user(int ndx, FAR char *username, FAR char *password)
+{
+  snprintf(username, BENCH_NAMELEN, "bench%03d", ndx);
+  snprintf(password, BENCH_NAMELEN, "pw%03d", ndx);
+}
+
+/****************************************************************************
+ * Name: bench_thread
+ *
+ * Description:
+ *   Log in g_nlogins times, cycling through the benchmark users.  Every
+ *   fourth login uses a wrong password.
+ *
+ ****************************************************************************/
+
+static FAR void *bench_thread(FAR void *arg)
+{
+  FAR struct bench_thread_s *bt = (FAR struct bench_thread_s *)arg;
+  char username[BENCH_NAMELEN];
+  char password[BENCH_NAMELEN];
+  unsigned long i;
+  bool good;
+  int ret;
+
+  for (i = 0; i < g_nlogins; i++)
+    {
+      bench_user((bt->first + i) % g_nusers, username, password);
+
+      good = (i & 3) != 3;
+      if (!good)
+        {
+          password[0] = 'x';
+        }
+
+      ret = passwd_verify(username, password);
+      if (PASSWORD_VERIFY_MATCH(ret) == good)
+        {
+          bt->nmatch++;
+        }
+      else
+        {
+          bt->nfail++;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: bench_setup
+ *
+ * Description:
+ *   Add (add == true) or remove the benchmark users.
+ *
+ ****************************************************************************/
+
+static int bench_setup(bool add)
+{
+  char username[BENCH_NAMELEN];
+  char password[BENCH_NAMELEN];
+  int ret;
+  int i;
+
+  for (i = 0; i < g_nusers; i++)
+    {
+      bench_user(i, username, password);
+
+      if (add)
+        {
+          ret = passwd_adduser(username, password);
+          if (ret == -EEXIST)
+            {
+              ret = passwd_update(username, password);
+            }
+        }
+      else
+        {
+          ret = passwd_deluser(username);
+        }
+
+      if (ret < 0)
+        {
+          fprintf(stderr, "ERROR: Failed to %s %s: %d\n",
+                  add ? "add" : "delete", username, ret);
+          return ret;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bench_showusage
+ ****************************************************************************/
+
+static void bench_showusage(FAR const char *progname)
+{
+  fprintf(stderr, "USAGE: %s [-u <users>] [-t <threads>] [-n <logins>] "
+          "[-k]\n", progname);
+  fprintf(stderr, "  -u  Number of users to add (default: 32)\n");
+  fprintf(stderr, "  -t  Number of login threads (default: 4, max: %d)\n",
+          BENCH_MAXTHREADS);
+  fprintf(stderr, "  -n  Logins per thread (default: 200)\n");
+  fprintf(stderr, "  -k  Keep the users in %s afterwards\n",
+          CONFIG_FSUTILS_PASSWD_PATH);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * passwd_bench_main
+ ****************************************************************************/
+
+#ifdef BUILD_MODULE
+int main(int argc, FAR char *argv[])
+#else
+int passwd_bench_main(int argc, char *argv[])
+#endif
+{
+  struct bench_thread_s threads[BENCH_MAXTHREADS];
+  pthread_attr_t attr;
+  unsigned long nmatch;
+  unsigned long nfail;
+  unsigned long msec;
+  uint64_t start;
+  bool keep = false;
+  int nthreads = 4;
+  int option;
+  int ret;
+  int i;
+
+  while ((option = getopt(argc, argv, "u:t:n:k")) != ERROR)
+    {
+      switch (option)
+        {
+          case 'u':
+            g_nusers = atoi(optarg);
+            break;
+
+          case 't':
+            nthreads = atoi(optarg);
+            break;
+
+          case 'n':
+            g_nlogins = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'k':
+            keep = true;
+            break;
+
+          default:
+            bench_showusage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+  if (optind != argc || g_nusers < 1 || g_nusers > 999 ||
+      nthreads < 1 || nthreads > BENCH_MAXTHREADS)
+    {
+      bench_showusage(argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  printf("Adding %d users to %s\n", g_nusers, CONFIG_FSUTILS_PASSWD_PATH);
+
+  ret = bench_setup(true);
+  if (ret < 0)
+    {
+      return EXIT_FAILURE;
+    }
+
+  /* Start all of the login threads at once */
+
+  memset(threads, 0, sizeof(threads));
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr,
+                            CONFIG_EXAMPLES_PASSWD_BENCH_THREAD_STACKSIZE);
+
+  start = bench_usec();
+
+  for (i = 0; i < nthreads; i++)
+    {
+      threads[i].first = i * g_nusers / nthreads;
+
+      ret = pthread_create(&threads[i].thread, &attr, bench_thread,
+                           &threads[i]);
+      if (ret != 0)
+        {
+          fprintf(stderr, "ERROR: pthread_create failed: %d\n", ret);
+          nthreads = i;
+          break;
+        }
+    }
+
+  nmatch = 0;
+  nfail  = 0;
+
+  for (i = 0; i < nthreads; i++)
+    {
+      pthread_join(threads[i].thread, NULL);
+      nmatch += threads[i].nmatch;
+      nfail  += threads[i].nfail;
+    }
+
+  msec = (unsigned long)((bench_usec() - start) / 1000);
+  pthread_attr_destroy(&attr);
+
+  printf("%d threads: %lu logins in %lu ms, %lu logins/s\n",
+         nthreads, nmatch + nfail, msec,
+         msec > 0 ?
+         (unsigned long)((uint64_t)(nmatch + nfail) * 1000 / msec) : 0);
+
+  if (nfail > 0)
+    {
+      fprintf(stderr, "ERROR: %lu logins gave the wrong result\n", nfail);
+    }
+
+  if (!keep)
+    {
+      (void)bench_setup(false);
+    }
+
+  return (ret != 0 || nfail > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
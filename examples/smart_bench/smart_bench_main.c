@@ -0,0 +1,891 @@
+/****************************************************************************
+ * examples/smart_bench/smart_bench_main.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <sys/mount.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+
+#include <nuttx/fs/ioctl.h>
+#include <nuttx/fs/smart.h>
+
+#include "fsutils/mksmartfs.h"
+#include "testing/bench.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_SMART_BENCH_MOUNTPT
+#  define CONFIG_EXAMPLES_SMART_BENCH_MOUNTPT "/mnt/smartbench"
+#endif
+
+/* The SMART statistics come from the procfs support in the SMART driver */
+
+#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
+#  define BENCH_HAVE_STATS 1
+#endif
+
+/* Latency chart: row n counts operations that took from 2^n up to
+ * 2^(n+1) microseconds; the last row takes everything slower.
+ */
+
+#define BENCH_NCHART     21
+
+#define BENCH_PATHSIZE   64
+#define BENCH_MAXIOSIZE  4096
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+enum bench_workload_e
+{
+  BENCH_APPEND = 0,             /* Small appends to one file */
+  BENCH_REWRITE,                /* Random rewrites within one file */
+  BENCH_FILES,                  /* Many small files */
+  BENCH_NWORKLOADS
+};
+
+struct bench_snapshot_s
+{
+#ifdef BENCH_HAVE_STATS
+  struct mtd_smart_procfs_data_s data; /* SMART driver statistics */
+#ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
+  FAR uint32_t *erasecounts;           /* Copy of the per block counts */
+#endif
+#endif
+  uint64_t usec;                       /* Time of the snapshot */
+};
+
+struct bench_config_s
+{
+  FAR const char *devpath;      /* SMART block device */
+  uint32_t nops;                /* Operations per workload */
+  uint32_t filesize;            /* Size of the rewrite file */
+  uint16_t iosize;              /* Bytes per operation */
+  uint16_t sectorsize;          /* Logical sector size to format with */
+  bool bulkerase;               /* Bulk erase before formatting */
+  bool verbose;                 /* Show per block erase counts */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static FAR const char *g_workload_name[BENCH_NWORKLOADS] =
+{
+  "append",
+  "rewrite",
+  "files"
+};
+
+static uint8_t g_iobuffer[BENCH_MAXIOSIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: bench_chart_show
+ *
+ * Description:
+ *   Show the latency histogram folded into power of two rows.  All of the
+ *   latencies held in one histogram bucket share the same top bit, so the
+ *   largest of them gives the row.
+ *
+ ****************************************************************************/
+
+static void bench_chart_show(FAR const struct bench_hist_s *hist)
+{
+  uint32_t chart[BENCH_NCHART];
+  uint32_t peak = 0;
+  uint32_t value;
+  int bucket;
+  int row;
+  int width;
+
+  memset(chart, 0, sizeof(chart));
+
+  for (bucket = 0; bucket < BENCH_NBUCKETS; bucket++)
+    {
+      value = bench_hist_bucketmax(bucket);
+      row   = 0;
+
+      while (row < BENCH_NCHART - 1 && (value >> (row + 1)) != 0)
+        {
+          row++;
+        }
+
+      chart[row] += hist->count[bucket];
+    }
+
+  for (row = 0; row < BENCH_NCHART; row++)
+    {
+      if (chart[row] > peak)
+        {
+          peak = chart[row];
+        }
+    }
+
+  for (row = 0; row < BENCH_NCHART; row++)
+    {
+      if (chart[row] == 0)
+        {
+          continue;
+        }
+
+      width = (int)((uint64_t)chart[row] * 40 / peak);
+      if (row < BENCH_NCHART - 1)
+        {
+          printf("  %8lu-%-8lu %7lu |%.*s\n",
+                 row == 0 ? 0ul : 1ul << row,
+                 (1ul << (row + 1)) - 1,
+                 (unsigned long)chart[row], width,
+                 "########################################");
+        }
+      else
+        {
+          printf("  %8lu+         %7lu |%.*s\n", 1ul << row,
+                 (unsigned long)chart[row], width,
+                 "########################################");
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: bench_snapshot
+ *
+ * Description:
+ *   Record the SMART statistics (if available) and the time.
+ *
+ ****************************************************************************/
+
+static int bench_snapshot(FAR const struct bench_config_s *cfg,
+                          FAR struct bench_snapshot_s *snap)
+{
+#ifdef BENCH_HAVE_STATS
+  int ret;
+  int fd;
+
+  fd = open(cfg->devpath, O_RDONLY);
+  if (fd < 0)
+    {
+      ret = -errno;
+      fprintf(stderr, "ERROR: Failed to open %s: %d\n", cfg->devpath, ret);
+      return ret;
+    }
+
+  ret = ioctl(fd, BIOC_GETPROCFSD,
+              (unsigned long)((uintptr_t)&snap->data));
+  close(fd);
+
+  if (ret < 0)
+    {
+      ret = -errno;
+      fprintf(stderr, "ERROR: BIOC_GETPROCFSD failed: %d\n", ret);
+      return ret;
+    }
+
+#ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
+  /* The counts belong to the driver; keep a copy to compare against */
+
+  free(snap->erasecounts);
+  snap->erasecounts = (FAR uint32_t *)
+    malloc(snap->data.neraseblocks * sizeof(uint32_t));
+
+  if (snap->erasecounts != NULL)
+    {
+      size_t block;
+
+      for (block = 0; block < snap->data.neraseblocks; block++)
+        {
+          snap->erasecounts[block] = snap->data.erasecounts[block];
+        }
+    }
+#endif
+#endif
+
+  snap->usec = bench_usec();
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bench_report
+ *
+ * Description:
+ *   Report throughput, latencies and the flash statistics of one workload.
+ *
+ ****************************************************************************/
+
+static void bench_report(FAR const struct bench_config_s *cfg,
+                         FAR const char *name, uint64_t nbytes,
+                         FAR const struct bench_hist_s *hist,
+                         FAR const struct bench_snapshot_s *start,
+                         FAR const struct bench_snapshot_s *end)
+{
+  uint64_t usec = end->usec - start->usec;
+#ifdef BENCH_HAVE_STATS
+  int64_t programmed;
+  uint32_t erases;
+#ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
+  uint32_t delta;
+  uint32_t mindelta;
+  uint32_t maxdelta;
+  uint32_t totdelta;
+  size_t block;
+#endif
+#endif
+
+  printf("%s: %lu ops, %lu bytes in %lu ms, %lu KiB/s, %lu ops/s\n",
+         name, (unsigned long)hist->nops, (unsigned long)nbytes,
+         (unsigned long)(usec / 1000),
+         usec > 0 ? (unsigned long)(nbytes * 1000000 / 1024 / usec) : 0,
+         usec > 0 ? (unsigned long)((uint64_t)hist->nops * 1000000 / usec)
+                  : 0);
+
+  if (hist->nops > 0)
+    {
+      printf("  Latency (usec): p50 %lu p90 %lu p99 %lu max %lu\n",
+             (unsigned long)bench_hist_percentile(hist, 500),
+             (unsigned long)bench_hist_percentile(hist, 900),
+             (unsigned long)bench_hist_percentile(hist, 990),
+             (unsigned long)hist->max);
+
+      bench_chart_show(hist);
+    }
+
+#ifdef BENCH_HAVE_STATS
+  /* SMART writes every logical sector update to a fresh physical sector,
+   * so the sectors programmed are those taken from the free pool plus
+   * those returned to it by block erases.
+   */
+
+  erases     = end->data.blockerases - start->data.blockerases;
+  programmed = (int64_t)start->data.freesectors -
+               (int64_t)end->data.freesectors +
+               (int64_t)erases * end->data.sectorsperblk;
+
+  if (programmed < 0)
+    {
+      programmed = 0;
+    }
+
+  printf("  Block erases: %lu, sectors programmed: %lu",
+         (unsigned long)erases, (unsigned long)programmed);
+
+  if (nbytes > 0)
+    {
+      printf(", write amplification: %lu.%02lu\n",
+             (unsigned long)(programmed * end->data.sectorsize / nbytes),
+             (unsigned long)(programmed * end->data.sectorsize * 100 /
+                             nbytes % 100));
+    }
+  else
+    {
+      printf("\n");
+    }
+
+  printf("  Free sectors: %u, released: %u\n",
+         end->data.freesectors, end->data.releasesectors);
+
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  printf("  Uneven wear count: %lu\n",
+         (unsigned long)end->data.unevenwearcount);
+#endif
+
+#ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
+  if (start->erasecounts != NULL && end->erasecounts != NULL)
+    {
+      mindelta = UINT32_MAX;
+      maxdelta = 0;
+      totdelta = 0;
+
+      for (block = 0; block < end->data.neraseblocks; block++)
+        {
+          delta = end->erasecounts[block] - start->erasecounts[block];
+          if (delta < mindelta)
+            {
+              mindelta = delta;
+            }
+
+          if (delta > maxdelta)
+            {
+              maxdelta = delta;
+            }
+
+          totdelta += delta;
+        }
+
+      printf("  Erases per block: min %lu max %lu avg %lu.%02lu\n",
+             (unsigned long)mindelta, (unsigned long)maxdelta,
+             (unsigned long)(totdelta / end->data.neraseblocks),
+             (unsigned long)(totdelta * 100 / end->data.neraseblocks % 100));
+
+      if (cfg->verbose)
+        {
+          for (block = 0; block < end->data.neraseblocks; block++)
+            {
+              if ((block & 15) == 0)
+                {
+                  printf("  %5lu:", (unsigned long)block);
+                }
+
+              printf(" %4lu", (unsigned long)(end->erasecounts[block] -
+                                              start->erasecounts[block]));
+
+              if ((block & 15) == 15 ||
+                  block == end->data.neraseblocks - 1)
+                {
+                  printf("\n");
+                }
+            }
+        }
+    }
+#endif
+#endif
+}
+
+/****************************************************************************
+ * Name: bench_write
+ *
+ * Description:
+ *   Write and sync one buffer.
+ *
+ ****************************************************************************/
+
+static int bench_write(int fd, size_t nbytes)
+{
+  ssize_t nwritten;
+  size_t remaining;
+
+  for (remaining = nbytes; remaining > 0; remaining -= nwritten)
+    {
+      nwritten = write(fd, &g_iobuffer[nbytes - remaining], remaining);
+      if (nwritten < 0)
+        {
+          if (errno == EINTR)
+            {
+              nwritten = 0;
+              continue;
+            }
+
+          return -errno;
+        }
+    }
+
+  if (fsync(fd) < 0)
+    {
+      return -errno;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bench_append
+ *
+ * Description:
+ *   Small appends to a single file, synced one by one as a logger would.
+ *
+ ****************************************************************************/
+
+static int bench_append(FAR const struct bench_config_s *cfg,
+                        FAR struct bench_hist_s *hist,
+                        FAR uint64_t *nbytes)
+{
+  uint64_t start;
+  uint32_t op;
+  int ret = OK;
+  int fd;
+
+  fd = open(CONFIG_EXAMPLES_SMART_BENCH_MOUNTPT "/append.dat",
+            O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0666);
+  if (fd < 0)
+    {
+      return -errno;
+    }
+
+  for (op = 0; op < cfg->nops; op++)
+    {
+      start = bench_usec();
+      ret   = bench_write(fd, cfg->iosize);
+      if (ret < 0)
+        {
+          break;
+        }
+
+      bench_hist_record(hist, start);
+      *nbytes += cfg->iosize;
+    }
+
+  close(fd);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: bench_rewrite_prepare
+ *
+ * Description:
+ *   Create the file for the random rewrite workload.  This is done before
+ *   the starting snapshot so that it is not counted.
+ *
+ ****************************************************************************/
+
+static int bench_rewrite_prepare(FAR const struct bench_config_s *cfg)
+{
+  uint32_t offset;
+  size_t nbytes;
+  int ret = OK;
+  int fd;
+
+  fd = open(CONFIG_EXAMPLES_SMART_BENCH_MOUNTPT "/rewrite.dat",
+            O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0)
+    {
+      return -errno;
+    }
+
+  for (offset = 0; offset < cfg->filesize; offset += nbytes)
+    {
+      nbytes = cfg->filesize - offset;
+      if (nbytes > BENCH_MAXIOSIZE)
+        {
+          nbytes = BENCH_MAXIOSIZE;
+        }
+
+      ret = bench_write(fd, nbytes);
+      if (ret < 0)
+        {
+          break;
+        }
+    }
+
+  close(fd);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: bench_rewrite
+ *
+ * Description:
+ *   Rewrite iosize bytes at random, iosize aligned offsets in a file of
+ *   filesize bytes, as a database or configuration store would.
+ *
+ ****************************************************************************/
+
+static int bench_rewrite(FAR const struct bench_config_s *cfg,
+                         FAR struct bench_hist_s *hist,
+                         FAR uint64_t *nbytes)
+{
+  uint64_t start;
+  uint32_t nslots;
+  uint32_t op;
+  off_t offset;
+  int ret = OK;
+  int fd;
+
+  fd = open(CONFIG_EXAMPLES_SMART_BENCH_MOUNTPT "/rewrite.dat", O_WRONLY);
+  if (fd < 0)
+    {
+      return -errno;
+    }
+
+  nslots = cfg->filesize / cfg->iosize;
+
+  for (op = 0; op < cfg->nops; op++)
+    {
+      offset = (off_t)(rand() % nslots) * cfg->iosize;
+      if (lseek(fd, offset, SEEK_SET) < 0)
+        {
+          ret = -errno;
+          break;
+        }
+
+      start = bench_usec();
+      ret   = bench_write(fd, cfg->iosize);
+      if (ret < 0)
+        {
+          break;
+        }
+
+      bench_hist_record(hist, start);
+      *nbytes += cfg->iosize;
+    }
+
+  close(fd);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: bench_files
+ *
+ * Description:
+ *   Create many small files of iosize bytes each.  Each operation is the
+ *   create, the write and the close.
+ *
+ ****************************************************************************/
+
+static int bench_files(FAR const struct bench_config_s *cfg,
+                       FAR struct bench_hist_s *hist,
+                       FAR uint64_t *nbytes)
+{
+  char path[BENCH_PATHSIZE];
+  uint64_t start;
+  uint32_t op;
+  int ret;
+  int fd;
+
+  ret = mkdir(CONFIG_EXAMPLES_SMART_BENCH_MOUNTPT "/files", 0777);
+  if (ret < 0 && errno != EEXIST)
+    {
+      return -errno;
+    }
+
+  for (op = 0; op < cfg->nops; op++)
+    {
+      snprintf(path, sizeof(path),
+               CONFIG_EXAMPLES_SMART_BENCH_MOUNTPT "/files/f%05lu",
+               (unsigned long)op);
+
+      start = bench_usec();
+
+      fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (fd < 0)
+        {
+          return -errno;
+        }
+
+      ret = bench_write(fd, cfg->iosize);
+      close(fd);
+
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      bench_hist_record(hist, start);
+      *nbytes += cfg->iosize;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bench_run
+ *
+ * Description:
+ *   Run one workload between two statistics snapshots and report on it.
+ *
+ ****************************************************************************/
+
+static int bench_run(FAR const struct bench_config_s *cfg,
+                     enum bench_workload_e workload)
+{
+  struct bench_snapshot_s start;
+  struct bench_snapshot_s end;
+  struct bench_hist_s hist;
+  uint64_t nbytes = 0;
+  int ret;
+
+  memset(&start, 0, sizeof(struct bench_snapshot_s));
+  memset(&end, 0, sizeof(struct bench_snapshot_s));
+  memset(&hist, 0, sizeof(struct bench_hist_s));
+
+  if (workload == BENCH_REWRITE)
+    {
+      ret = bench_rewrite_prepare(cfg);
+      if (ret < 0)
+        {
+          goto errout;
+        }
+    }
+
+  ret = bench_snapshot(cfg, &start);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  switch (workload)
+    {
+      case BENCH_APPEND:
+        ret = bench_append(cfg, &hist, &nbytes);
+        break;
+
+      case BENCH_REWRITE:
+        ret = bench_rewrite(cfg, &hist, &nbytes);
+        break;
+
+      case BENCH_FILES:
+      default:
+        ret = bench_files(cfg, &hist, &nbytes);
+        break;
+    }
+
+  if (ret < 0)
+    {
+      fprintf(stderr, "ERROR: %s workload failed after %lu ops: %d\n",
+              g_workload_name[workload], (unsigned long)hist.nops, ret);
+    }
+
+  if (bench_snapshot(cfg, &end) == OK)
+    {
+      bench_report(cfg, g_workload_name[workload], nbytes, &hist,
+                   &start, &end);
+    }
+
+errout:
+#if defined(BENCH_HAVE_STATS) && defined(CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG)
+  free(start.erasecounts);
+  free(end.erasecounts);
+#endif
+  return ret;
+}
+
+/****************************************************************************
+ * Name: bench_format
+ *
+ * Description:
+ *   Optionally bulk erase the flash, then format and mount the device.
+ *
+ ****************************************************************************/
+
+static int bench_format(FAR const struct bench_config_s *cfg)
+{
+  uint64_t start;
+  int ret;
+  int fd;
+
+  if (cfg->bulkerase)
+    {
+      /* The SMART driver passes MTD ioctls on to the MTD device */
+
+      fd = open(cfg->devpath, O_RDWR);
+      if (fd < 0)
+        {
+          ret = -errno;
+          fprintf(stderr, "ERROR: Failed to open %s: %d\n",
+                  cfg->devpath, ret);
+          return ret;
+        }
+
+      start = bench_usec();
+      ret   = ioctl(fd, MTDIOC_BULKERASE, 0);
+      close(fd);
+
+      if (ret < 0)
+        {
+          ret = -errno;
+          fprintf(stderr, "ERROR: MTDIOC_BULKERASE failed: %d\n", ret);
+          return ret;
+        }
+
+      printf("Bulk erase: %lu ms\n",
+             (unsigned long)((bench_usec() - start) / 1000));
+    }
+
+  start = bench_usec();
+
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+  ret = mksmartfs(cfg->devpath, cfg->sectorsize, 1);
+#else
+  ret = mksmartfs(cfg->devpath, cfg->sectorsize);
+#endif
+  if (ret < 0)
+    {
+      ret = -errno;
+      fprintf(stderr, "ERROR: mksmartfs failed: %d\n", ret);
+      return ret;
+    }
+
+  printf("Format: %lu ms\n", (unsigned long)((bench_usec() - start) / 1000));
+
+  ret = mount(cfg->devpath, CONFIG_EXAMPLES_SMART_BENCH_MOUNTPT, "smartfs",
+              0, NULL);
+  if (ret < 0)
+    {
+      ret = -errno;
+      fprintf(stderr, "ERROR: Failed to mount %s: %d\n", cfg->devpath, ret);
+      return ret;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bench_showusage
+ ****************************************************************************/
+
+static void bench_showusage(FAR const char *progname)
+{
+  fprintf(stderr, "USAGE: %s [-e] [-s <sectsize>] [-w <workload>] "
+          "[-n <ops>] [-z <iosize>] [-f <filesize>] [-v] <smartdev>\n",
+          progname);
+  fprintf(stderr, "  -e  Bulk erase the flash before formatting\n");
+  fprintf(stderr, "  -s  Logical sector size (default: "
+          "CONFIG_MTD_SMART_SECTOR_SIZE)\n");
+  fprintf(stderr, "  -w  append, rewrite or files (default: all three)\n");
+  fprintf(stderr, "  -n  Operations per workload (default: 256)\n");
+  fprintf(stderr, "  -z  Bytes per operation, max %d (default: 64)\n",
+          BENCH_MAXIOSIZE);
+  fprintf(stderr, "  -f  Size of the rewrite file (default: 16384)\n");
+  fprintf(stderr, "  -v  Show the erase count of every erase block\n");
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * smart_bench_main
+ ****************************************************************************/
+
+#ifdef BUILD_MODULE
+int main(int argc, FAR char *argv[])
+#else
+int smart_bench_main(int argc, char *argv[])
+#endif
+{
+  struct bench_config_s cfg;
+  int workload = -1;
+  int option;
+  int ret;
+  int i;
+
+  memset(&cfg, 0, sizeof(struct bench_config_s));
+  cfg.nops     = 256;
+  cfg.iosize   = 64;
+  cfg.filesize = 16384;
+
+  while ((option = getopt(argc, argv, "es:w:n:z:f:v")) != ERROR)
+    {
+      switch (option)
+        {
+          case 'e':
+            cfg.bulkerase = true;
+            break;
+
+          case 's':
+            cfg.sectorsize = (uint16_t)strtoul(optarg, NULL, 0);
+            break;
+
+          case 'w':
+            for (i = 0; i < BENCH_NWORKLOADS; i++)
+              {
+                if (strcmp(optarg, g_workload_name[i]) == 0)
+                  {
+                    workload = i;
+                    break;
+                  }
+              }
+
+            if (i >= BENCH_NWORKLOADS)
+              {
+                bench_showusage(argv[0]);
+                return EXIT_FAILURE;
+              }
+            break;
+
+          case 'n':
+            cfg.nops = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'z':
+            cfg.iosize = (uint16_t)strtoul(optarg, NULL, 0);
+            break;
+
+          case 'f':
+            cfg.filesize = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'v':
+            cfg.verbose = true;
+            break;
+
+          default:
+            bench_showusage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+  if (optind != argc - 1 || cfg.iosize == 0 ||
+      cfg.iosize > BENCH_MAXIOSIZE || cfg.filesize < cfg.iosize)
+    {
+      bench_showusage(argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  cfg.devpath = argv[optind];
+
+  for (i = 0; i < BENCH_MAXIOSIZE; i++)
+    {
+      g_iobuffer[i] = (uint8_t)i;
+    }
+
+  ret = bench_format(&cfg);
+  if (ret < 0)
+    {
+      return EXIT_FAILURE;
+    }
+
+  srand(1);
+
+  for (i = 0; i < BENCH_NWORKLOADS && ret >= 0; i++)
+    {
+      if (workload < 0 || workload == i)
+        {
+          ret = bench_run(&cfg, (enum bench_workload_e)i);
+        }
+    }
+
+  (void)umount(CONFIG_EXAMPLES_SMART_BENCH_MOUNTPT);
+  return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -61,6 +61,20 @@
 
 #  define TCPBLASTER_HAVE_SOLINGER 1
 
+   /* NuttX definitions used by the code shared with the host */
+
+#  ifndef FAR
+#    define FAR
+#  endif
+
+#  ifndef OK
+#    define OK 0
+#  endif
+
+#  ifndef ERROR
+#    define ERROR -1
+#  endif
+
 #else
 #  ifdef CONFIG_NET_SOLINGER
 #    define TCPBLASTER_HAVE_SOLINGER 1
@@ -92,9 +106,9 @@
  ****************************************************************************/
 
 #ifdef CONFIG_EXAMPLES_TCPBLASTER_IPv6
-uint16_t g_tcpblasterserver_ipv6[8];
+extern uint16_t g_tcpblasterserver_ipv6[8];
 #else
-uint32_t g_tcpblasterserver_ipv4;
+extern uint32_t g_tcpblasterserver_ipv4;
 #endif
 
 /****************************************************************************
@@ -109,4 +123,8 @@ void tcpblaster_cmdline(int argc, char **argv);
 extern void tcpblaster_client(void);
 extern void tcpblaster_server(void);
 
+#ifdef CONFIG_EXAMPLES_TCPBLASTER_BENCH
+int tcpblaster_bench(int argc, FAR char *argv[]);
+#endif
+
 #endif /* __APPS_EXAMPLES_TCPBLASTER_H */
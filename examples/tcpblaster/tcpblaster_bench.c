@@ -0,0 +1,1377 @@
+/****************************************************************************
+ * examples/tcpblaster/tcpblaster_bench.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name Gregory Nutt nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "config.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+#include <arpa/inet.h>
+
+#ifdef TCPBLASTER_HOST
+#  include <sys/resource.h>
+#endif
+
+#include "tcpblaster.h"
+#include "testing/bench.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_EXAMPLES_TCPBLASTER_BENCH_MAXSTREAMS
+#  define CONFIG_EXAMPLES_TCPBLASTER_BENCH_MAXSTREAMS 8
+#endif
+
+#ifndef CONFIG_EXAMPLES_TCPBLASTER_BENCH_STACKSIZE
+#  define CONFIG_EXAMPLES_TCPBLASTER_BENCH_STACKSIZE 2048
+#endif
+
+/* The CPU load of the whole target, network stack included, is available
+ * from procfs.  On the host the CPU time of the process is used instead.
+ */
+
+#if defined(CONFIG_FS_PROCFS) && defined(CONFIG_SCHED_CPULOAD) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_CPULOAD)
+#  define BENCH_HAVE_CPULOAD 1
+#endif
+
+#ifdef MSG_NOSIGNAL
+#  define BENCH_SENDFLAGS MSG_NOSIGNAL
+#else
+#  define BENCH_SENDFLAGS 0
+#endif
+
+/* Wire protocol.  Every message starts with a bench_msg_s header.  The
+ * server counts data messages and echoes requests.  A TCP connection
+ * starts with a hello giving the message size, so that the server can
+ * find the message boundaries, and ends with an end message that the
+ * server answers with the number of bytes it received; the client's time
+ * therefore includes draining the connection.  Over UDP, the client uses
+ * begin and end messages to reset and collect the server's counts.
+ */
+
+#define BENCH_MAGIC      0x54424e43  /* "TBNC", the TCP hello */
+
+#define BENCH_MSG_DATA   'D'         /* Stream data, counted */
+#define BENCH_MSG_REQ    'Q'         /* Request, echoed */
+#define BENCH_MSG_BEGIN  'B'         /* Reset the counts, acknowledged */
+#define BENCH_MSG_END    'E'         /* Report the counts */
+
+#define BENCH_HDRSIZE    16
+#define BENCH_MAXMSG     65000
+#define BENCH_UDPTIMEOUT 1           /* Seconds to wait for a UDP reply */
+#define BENCH_UDPRETRIES 3
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bench_config_s
+{
+  FAR const char *server;       /* Client: server address.  NULL: server */
+  uint32_t msgsize;             /* Bytes per message */
+  uint32_t duration;            /* Seconds */
+  int bufsize;                  /* SO_SNDBUF/SO_RCVBUF, 0: default */
+  int nstreams;                 /* Parallel connections */
+  uint16_t port;                /* Server port */
+  bool udp;                     /* UDP instead of TCP */
+  bool rr;                      /* Request/response instead of stream */
+  bool nodelay;                 /* TCP_NODELAY */
+  bool csv;                     /* Also print a CSV summary line */
+};
+
+/* All fields are in network order on the wire */
+
+struct bench_msg_s
+{
+  uint32_t type;                /* BENCH_MAGIC or BENCH_MSG_* */
+  uint32_t arg1;                /* Message size, sequence or count */
+  uint32_t arg2;                /* Byte count (high) */
+  uint32_t arg3;                /* Byte count (low) */
+};
+
+struct bench_stream_s
+{
+  pthread_t thread;
+  FAR const struct bench_config_s *cfg;
+  FAR uint8_t *buffer;          /* One message */
+  int id;                       /* Stream number */
+  int sd;                       /* Connected socket */
+  int result;                   /* OK or negated errno of first failure */
+  uint64_t bytes;               /* Bytes sent (stream) or echoed (RR) */
+  uint64_t acked;               /* Bytes the server reports received */
+  uint32_t nmsgs;               /* Messages sent */
+  uint32_t nlost;               /* UDP requests without a response */
+  uint64_t usec;                /* Time from connect to the server's count */
+  struct bench_hist_s hist;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Merged histogram of all streams, kept off the stack */
+
+static struct bench_hist_s g_hist;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: bench_cpuusec
+ *
+ * Description:
+ *   Host:  CPU time used by this process so far.
+ *
+ ****************************************************************************/
+
+#ifdef TCPBLASTER_HOST
+static uint64_t bench_cpuusec(void)
+{
+  struct rusage usage;
+
+  if (getrusage(RUSAGE_SELF, &usage) < 0)
+    {
+      return 0;
+    }
+
+  return (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 +
+         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+#endif
+
+/****************************************************************************
+ * Name: bench_cpuload
+ *
+ * Description:
+ *   Return the CPU load over a run that took 'usec' and started when
+ *   bench_cpuusec() was 'cpustart', in tenths of a percent, or -1 if it is
+ *   not known.  The target reports the load of the whole system over the
+ *   CPU load time constant, so runs should be several times longer than
+ *   that.  On a multi-core host the load can exceed 100%.
+ *
+ ****************************************************************************/
+
+static int bench_cpuload(uint64_t cpustart, uint64_t usec)
+{
+#if defined(TCPBLASTER_HOST)
+  if (usec == 0)
+    {
+      return -1;
+    }
+
+  return (int)((bench_cpuusec() - cpustart) * 1000 / usec);
+
+#elif defined(BENCH_HAVE_CPULOAD)
+  char buffer[16];
+  ssize_t nread;
+  int tenths = 0;
+  int whole;
+  int fd;
+
+  fd = open("/proc/cpuload", O_RDONLY);
+  if (fd < 0)
+    {
+      return -1;
+    }
+
+  nread = read(fd, buffer, sizeof(buffer) - 1);
+  close(fd);
+
+  if (nread <= 0)
+    {
+      return -1;
+    }
+
+  buffer[nread] = '\0';
+  if (sscanf(buffer, "%d.%d", &whole, &tenths) < 1)
+    {
+      return -1;
+    }
+
+  return whole * 10 + tenths;
+
+#else
+  return -1;
+#endif
+}
+
+/****************************************************************************
+ * Name: bench_sendall and bench_recvall
+ *
+ * Description:
+ *   Transfer exactly nbytes on a TCP connection.  Returns nbytes, 0 if the
+ *   peer closed the connection (receive only), or a negated errno value.
+ *
+ ****************************************************************************/
+
+static ssize_t bench_sendall(int sd, FAR const void *buffer, size_t nbytes)
+{
+  FAR const uint8_t *ptr = (FAR const uint8_t *)buffer;
+  size_t remaining = nbytes;
+  ssize_t nsent;
+
+  while (remaining > 0)
+    {
+      nsent = send(sd, ptr, remaining, BENCH_SENDFLAGS);
+      if (nsent < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          return -errno;
+        }
+
+      ptr       += nsent;
+      remaining -= nsent;
+    }
+
+  return nbytes;
+}
+
+static ssize_t bench_recvall(int sd, FAR void *buffer, size_t nbytes)
+{
+  FAR uint8_t *ptr = (FAR uint8_t *)buffer;
+  size_t remaining = nbytes;
+  ssize_t nrecvd;
+
+  while (remaining > 0)
+    {
+      nrecvd = recv(sd, ptr, remaining, 0);
+      if (nrecvd < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          return -errno;
+        }
+      else if (nrecvd == 0)
+        {
+          return 0;
+        }
+
+      ptr       += nrecvd;
+      remaining -= nrecvd;
+    }
+
+  return nbytes;
+}
+
+/****************************************************************************
+ * Name: bench_putmsg and bench_getmsg
+ *
+ * Description:
+ *   Convert a protocol header to and from network order.
+ *
+ ****************************************************************************/
+
+static void bench_putmsg(FAR void *buffer, uint32_t type, uint32_t arg1,
+                         uint32_t arg2, uint32_t arg3)
+{
+  struct bench_msg_s msg;
+
+  msg.type = htonl(type);
+  msg.arg1 = htonl(arg1);
+  msg.arg2 = htonl(arg2);
+  msg.arg3 = htonl(arg3);
+  memcpy(buffer, &msg, BENCH_HDRSIZE);
+}
+
+static void bench_getmsg(FAR const void *buffer,
+                         FAR struct bench_msg_s *msg)
+{
+  memcpy(msg, buffer, BENCH_HDRSIZE);
+  msg->type = ntohl(msg->type);
+  msg->arg1 = ntohl(msg->arg1);
+  msg->arg2 = ntohl(msg->arg2);
+  msg->arg3 = ntohl(msg->arg3);
+}
+
+/****************************************************************************
+ * Name: bench_sockopts
+ *
+ * Description:
+ *   Apply the socket buffer size and TCP_NODELAY options.  Options that
+ *   the network stack does not support are reported but not fatal, so the
+ *   same command line works on both ends.
+ *
+ ****************************************************************************/
+
+static void bench_sockopts(FAR const struct bench_config_s *cfg, int sd)
+{
+  int value;
+
+  if (cfg->bufsize > 0)
+    {
+      value = cfg->bufsize;
+      if (setsockopt(sd, SOL_SOCKET, SO_SNDBUF, &value, sizeof(int)) < 0 ||
+          setsockopt(sd, SOL_SOCKET, SO_RCVBUF, &value, sizeof(int)) < 0)
+        {
+          fprintf(stderr, "WARNING: Socket buffer size not set: %d\n",
+                  errno);
+        }
+    }
+
+  if (cfg->nodelay && !cfg->udp)
+    {
+#ifdef TCP_NODELAY
+      value = 1;
+      if (setsockopt(sd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(int)) < 0)
+        {
+          fprintf(stderr, "WARNING: TCP_NODELAY not set: %d\n", errno);
+        }
+#else
+      fprintf(stderr, "WARNING: TCP_NODELAY not supported\n");
+#endif
+    }
+}
+
+/****************************************************************************
+ * Name: bench_rcvtimeo
+ *
+ * Description:
+ *   Set the receive timeout for UDP replies.
+ *
+ ****************************************************************************/
+
+static void bench_rcvtimeo(int sd, int seconds)
+{
+  struct timeval tv;
+
+  tv.tv_sec  = seconds;
+  tv.tv_usec = 0;
+
+  if (setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, &tv,
+                 sizeof(struct timeval)) < 0)
+    {
+      fprintf(stderr, "WARNING: SO_RCVTIMEO not set: %d\n", errno);
+    }
+}
+
+/****************************************************************************
+ * Name: bench_address
+ *
+ * Description:
+ *   Set up the server address: 'host' on the client, any address on the
+ *   server (host == NULL).
+ *
+ ****************************************************************************/
+
+static int bench_address(FAR const char *host, uint16_t port,
+                         FAR struct sockaddr_storage *addr,
+                         FAR socklen_t *addrlen)
+{
+#ifdef CONFIG_EXAMPLES_TCPBLASTER_IPv6
+  FAR struct sockaddr_in6 *sin6 = (FAR struct sockaddr_in6 *)addr;
+#else
+  FAR struct sockaddr_in *sin = (FAR struct sockaddr_in *)addr;
+#endif
+
+  memset(addr, 0, sizeof(struct sockaddr_storage));
+
+#ifdef CONFIG_EXAMPLES_TCPBLASTER_IPv6
+  sin6->sin6_family = AF_INET6;
+  sin6->sin6_port   = htons(port);
+  *addrlen          = sizeof(struct sockaddr_in6);
+
+  if (host != NULL && inet_pton(AF_INET6, host, &sin6->sin6_addr) != 1)
+    {
+      return -EINVAL;
+    }
+#else
+  sin->sin_family   = AF_INET;
+  sin->sin_port     = htons(port);
+  *addrlen          = sizeof(struct sockaddr_in);
+
+  if (host == NULL)
+    {
+      sin->sin_addr.s_addr = INADDR_ANY;
+    }
+  else if (inet_pton(AF_INET, host, &sin->sin_addr) != 1)
+    {
+      return -EINVAL;
+    }
+#endif
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bench_tcpsession
+ *
+ * Description:
+ *   Server side of one TCP connection:  read the hello, then count or echo
+ *   messages until the end message and answer it with the byte count.
+ *
+ ****************************************************************************/
+
+static FAR void *bench_tcpsession(FAR void *arg)
+{
+  int sd = (int)(intptr_t)arg;
+  FAR uint8_t *buffer = NULL;
+  struct bench_msg_s msg;
+  uint8_t hdr[BENCH_HDRSIZE];
+  uint64_t received = 0;
+  uint64_t start;
+  uint64_t usec;
+  uint32_t msgsize;
+  bool rr = false;
+  ssize_t ret;
+
+  ret = bench_recvall(sd, hdr, BENCH_HDRSIZE);
+  if (ret <= 0)
+    {
+      goto errout;
+    }
+
+  bench_getmsg(hdr, &msg);
+  msgsize = msg.arg1;
+
+  if (msg.type != BENCH_MAGIC || msgsize < BENCH_HDRSIZE ||
+      msgsize > BENCH_MAXMSG)
+    {
+      fprintf(stderr, "server: Bad hello\n");
+      goto errout;
+    }
+
+  buffer = (FAR uint8_t *)malloc(msgsize);
+  if (buffer == NULL)
+    {
+      fprintf(stderr, "server: Failed to allocate %lu bytes\n",
+              (unsigned long)msgsize);
+      goto errout;
+    }
+
+  start = bench_usec();
+
+  for (; ; )
+    {
+      ret = bench_recvall(sd, buffer, msgsize);
+      if (ret <= 0)
+        {
+          fprintf(stderr, "server: recv failed: %d\n", (int)ret);
+          goto errout;
+        }
+
+      bench_getmsg(buffer, &msg);
+      if (msg.type == BENCH_MSG_END)
+        {
+          break;
+        }
+
+      received += msgsize;
+
+      if (msg.type == BENCH_MSG_REQ)
+        {
+          rr  = true;
+          ret = bench_sendall(sd, buffer, msgsize);
+          if (ret < 0)
+            {
+              fprintf(stderr, "server: send failed: %d\n", (int)ret);
+              goto errout;
+            }
+        }
+    }
+
+  usec = bench_usec() - start;
+
+  bench_putmsg(hdr, BENCH_MSG_END, 0, (uint32_t)(received >> 32),
+               (uint32_t)received);
+  (void)bench_sendall(sd, hdr, BENCH_HDRSIZE);
+
+  printf("server: %s %lu bytes: received %lu KiB in %lu ms (%lu KiB/s)\n",
+         rr ? "rr" : "stream", (unsigned long)msgsize,
+         (unsigned long)(received >> 10), (unsigned long)(usec / 1000),
+         (unsigned long)(usec > 0 ? (received * 1000000 / usec) >> 10 : 0));
+
+errout:
+  free(buffer);
+  close(sd);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: bench_tcpserver
+ *
+ * Description:
+ *   Accept connections forever, each served on its own thread.
+ *
+ ****************************************************************************/
+
+static int bench_tcpserver(FAR const struct bench_config_s *cfg)
+{
+  struct sockaddr_storage addr;
+  pthread_attr_t attr;
+  pthread_t thread;
+  socklen_t addrlen;
+  int listensd;
+  int acceptsd;
+  int optval;
+  int ret;
+
+  ret = bench_address(NULL, cfg->port, &addr, &addrlen);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  listensd = socket(PF_INETX, SOCK_STREAM, 0);
+  if (listensd < 0)
+    {
+      ret = -errno;
+      fprintf(stderr, "server: socket failure: %d\n", ret);
+      return ret;
+    }
+
+  optval = 1;
+  (void)setsockopt(listensd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(int));
+
+  if (bind(listensd, (FAR struct sockaddr *)&addr, addrlen) < 0 ||
+      listen(listensd, CONFIG_EXAMPLES_TCPBLASTER_BENCH_MAXSTREAMS) < 0)
+    {
+      ret = -errno;
+      fprintf(stderr, "server: bind/listen failure: %d\n", ret);
+      goto errout;
+    }
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr,
+                            CONFIG_EXAMPLES_TCPBLASTER_BENCH_STACKSIZE);
+
+  printf("server: Accepting TCP connections on port %d\n", cfg->port);
+
+  for (; ; )
+    {
+      addrlen  = sizeof(struct sockaddr_storage);
+      acceptsd = accept(listensd, (FAR struct sockaddr *)&addr, &addrlen);
+      if (acceptsd < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          ret = -errno;
+          fprintf(stderr, "server: accept failure: %d\n", ret);
+          break;
+        }
+
+      bench_sockopts(cfg, acceptsd);
+
+      ret = pthread_create(&thread, &attr, bench_tcpsession,
+                           (FAR void *)(intptr_t)acceptsd);
+      if (ret != 0)
+        {
+          fprintf(stderr, "server: pthread_create failed: %d\n", ret);
+          close(acceptsd);
+        }
+      else
+        {
+          (void)pthread_detach(thread);
+        }
+    }
+
+  pthread_attr_destroy(&attr);
+
+errout:
+  close(listensd);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: bench_udpserver
+ *
+ * Description:
+ *   Echo requests and count data from any number of clients on one socket.
+ *
+ ****************************************************************************/
+
+static int bench_udpserver(FAR const struct bench_config_s *cfg)
+{
+  struct sockaddr_storage addr;
+  struct bench_msg_s msg;
+  FAR uint8_t *buffer;
+  socklen_t addrlen;
+  uint64_t received = 0;
+  uint32_t nmsgs = 0;
+  ssize_t nrecvd;
+  int sd;
+  int ret;
+
+  ret = bench_address(NULL, cfg->port, &addr, &addrlen);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  buffer = (FAR uint8_t *)malloc(BENCH_MAXMSG);
+  if (buffer == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  sd = socket(PF_INETX, SOCK_DGRAM, 0);
+  if (sd < 0)
+    {
+      ret = -errno;
+      fprintf(stderr, "server: socket failure: %d\n", ret);
+      goto errout_with_buffer;
+    }
+
+  bench_sockopts(cfg, sd);
+
+  if (bind(sd, (FAR struct sockaddr *)&addr, addrlen) < 0)
+    {
+      ret = -errno;
+      fprintf(stderr, "server: bind failure: %d\n", ret);
+      goto errout;
+    }
+
+  printf("server: Receiving UDP on port %d\n", cfg->port);
+
+  for (; ; )
+    {
+      addrlen = sizeof(struct sockaddr_storage);
+      nrecvd  = recvfrom(sd, buffer, BENCH_MAXMSG, 0,
+                         (FAR struct sockaddr *)&addr, &addrlen);
+      if (nrecvd < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          ret = -errno;
+          fprintf(stderr, "server: recvfrom failed: %d\n", ret);
+          break;
+        }
+
+      if (nrecvd < BENCH_HDRSIZE)
+        {
+          continue;
+        }
+
+      bench_getmsg(buffer, &msg);
+      switch (msg.type)
+        {
+          case BENCH_MSG_DATA:
+            received += nrecvd;
+            nmsgs++;
+            break;
+
+          case BENCH_MSG_REQ:
+            received += nrecvd;
+            nmsgs++;
+            (void)sendto(sd, buffer, nrecvd, 0,
+                         (FAR struct sockaddr *)&addr, addrlen);
+            break;
+
+          case BENCH_MSG_BEGIN:
+            received = 0;
+            nmsgs    = 0;
+            (void)sendto(sd, buffer, nrecvd, 0,
+                         (FAR struct sockaddr *)&addr, addrlen);
+            break;
+
+          case BENCH_MSG_END:
+            printf("server: received %lu datagrams, %lu KiB\n",
+                   (unsigned long)nmsgs, (unsigned long)(received >> 10));
+
+            bench_putmsg(buffer, BENCH_MSG_END, nmsgs,
+                         (uint32_t)(received >> 32), (uint32_t)received);
+            (void)sendto(sd, buffer, BENCH_HDRSIZE, 0,
+                         (FAR struct sockaddr *)&addr, addrlen);
+            break;
+
+          default:
+            break;
+        }
+    }
+
+errout:
+  close(sd);
+
+errout_with_buffer:
+  free(buffer);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: bench_connect
+ *
+ * Description:
+ *   Open a client socket connected to the server.
+ *
+ ****************************************************************************/
+
+static int bench_connect(FAR const struct bench_config_s *cfg)
+{
+  struct sockaddr_storage addr;
+  socklen_t addrlen;
+  int ret;
+  int sd;
+
+  ret = bench_address(cfg->server, cfg->port, &addr, &addrlen);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  sd = socket(PF_INETX, cfg->udp ? SOCK_DGRAM : SOCK_STREAM, 0);
+  if (sd < 0)
+    {
+      return -errno;
+    }
+
+  bench_sockopts(cfg, sd);
+
+  if (connect(sd, (FAR struct sockaddr *)&addr, addrlen) < 0)
+    {
+      ret = -errno;
+      close(sd);
+      return ret;
+    }
+
+  return sd;
+}
+
+/****************************************************************************
+ * Name: bench_udpcontrol
+ *
+ * Description:
+ *   Send a begin or end message and wait for the server's reply, retrying
+ *   lost datagrams.
+ *
+ ****************************************************************************/
+
+static int bench_udpcontrol(int sd, uint32_t type,
+                            FAR struct bench_msg_s *reply)
+{
+  uint8_t buffer[BENCH_HDRSIZE];
+  ssize_t nrecvd;
+  int retry;
+
+  for (retry = 0; retry < BENCH_UDPRETRIES; retry++)
+    {
+      bench_putmsg(buffer, type, 0, 0, 0);
+      if (send(sd, buffer, BENCH_HDRSIZE, 0) < 0)
+        {
+          return -errno;
+        }
+
+      do
+        {
+          nrecvd = recv(sd, buffer, BENCH_HDRSIZE, 0);
+          if (nrecvd == BENCH_HDRSIZE)
+            {
+              bench_getmsg(buffer, reply);
+              if (reply->type == type)
+                {
+                  return OK;
+                }
+            }
+        }
+      while (nrecvd >= 0);
+    }
+
+  return -ETIMEDOUT;
+}
+
+/****************************************************************************
+ * Name: bench_client
+ *
+ * Description:
+ *   One client stream:  send messages, or run transactions, until the time
+ *   is up.
+ *
+ ****************************************************************************/
+
+static FAR void *bench_client(FAR void *arg)
+{
+  FAR struct bench_stream_s *stream = (FAR struct bench_stream_s *)arg;
+  FAR const struct bench_config_s *cfg = stream->cfg;
+  struct bench_msg_s msg;
+  uint8_t hdr[BENCH_HDRSIZE];
+  uint64_t start;
+  uint64_t end;
+  uint64_t now;
+  uint32_t seq = 0;
+  ssize_t ret = OK;
+
+  start = bench_usec();
+  end   = start + (uint64_t)cfg->duration * 1000000;
+
+  if (!cfg->udp)
+    {
+      bench_putmsg(hdr, BENCH_MAGIC, cfg->msgsize, 0, 0);
+
+      ret = bench_sendall(stream->sd, hdr, BENCH_HDRSIZE);
+      if (ret < 0)
+        {
+          goto errout;
+        }
+    }
+
+  for (now = start; now < end; now = bench_usec())
+    {
+      bench_putmsg(stream->buffer, cfg->rr ? BENCH_MSG_REQ : BENCH_MSG_DATA,
+                   seq++, 0, 0);
+
+      if (cfg->udp)
+        {
+          ret = send(stream->sd, stream->buffer, cfg->msgsize, 0);
+          if (ret < 0)
+            {
+              /* A full UDP send queue is not an error */
+
+              ret = -errno;
+              if (ret == -EINTR || ret == -ENOBUFS || ret == -EAGAIN)
+                {
+                  continue;
+                }
+
+              goto errout;
+            }
+        }
+      else
+        {
+          ret = bench_sendall(stream->sd, stream->buffer, cfg->msgsize);
+          if (ret < 0)
+            {
+              goto errout;
+            }
+        }
+
+      stream->nmsgs++;
+
+      if (!cfg->rr)
+        {
+          stream->bytes += cfg->msgsize;
+          continue;
+        }
+
+      /* Wait for the response */
+
+      if (cfg->udp)
+        {
+          /* Late responses to earlier requests are discarded */
+
+          do
+            {
+              ret = recv(stream->sd, stream->buffer, cfg->msgsize, 0);
+              if (ret >= BENCH_HDRSIZE)
+                {
+                  bench_getmsg(stream->buffer, &msg);
+                }
+            }
+          while (ret >= 0 && (ret < BENCH_HDRSIZE || msg.arg1 != seq - 1));
+
+          if (ret < 0)
+            {
+              stream->nlost++;
+              continue;
+            }
+        }
+      else
+        {
+          ret = bench_recvall(stream->sd, stream->buffer, cfg->msgsize);
+          if (ret <= 0)
+            {
+              ret = ret == 0 ? -ECONNRESET : ret;
+              goto errout;
+            }
+        }
+
+      bench_hist_record(&stream->hist, now);
+      stream->bytes += cfg->msgsize;
+    }
+
+  if (!cfg->udp)
+    {
+      /* Wait until the server has received everything */
+
+      bench_putmsg(stream->buffer, BENCH_MSG_END, 0, 0, 0);
+
+      ret = bench_sendall(stream->sd, stream->buffer, cfg->msgsize);
+      if (ret >= 0)
+        {
+          ret = bench_recvall(stream->sd, hdr, BENCH_HDRSIZE);
+        }
+
+      if (ret <= 0)
+        {
+          ret = ret == 0 ? -ECONNRESET : ret;
+          goto errout;
+        }
+
+      bench_getmsg(hdr, &msg);
+      stream->acked = ((uint64_t)msg.arg2 << 32) | msg.arg3;
+    }
+
+  stream->usec = bench_usec() - start;
+  return NULL;
+
+errout:
+  stream->usec   = bench_usec() - start;
+  stream->result = (int)ret;
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: bench_clients
+ *
+ * Description:
+ *   Run all streams against the server and report.
+ *
+ ****************************************************************************/
+
+static int bench_clients(FAR const struct bench_config_s *cfg)
+{
+  FAR struct bench_hist_s *hist = &g_hist;
+  FAR struct bench_stream_s *streams;
+  FAR struct bench_stream_s *stream;
+  struct bench_msg_s reply;
+  pthread_attr_t attr;
+  uint64_t cpustart = 0;
+  uint64_t bytes = 0;
+  uint64_t acked = 0;
+  uint64_t start;
+  uint64_t usec;
+  uint32_t nmsgs = 0;
+  uint32_t nlost = 0;
+  uint32_t kibps;
+  int nstarted;
+  int control = -1;
+  int cpuload;
+  int ret = OK;
+  int i;
+
+  streams = (FAR struct bench_stream_s *)
+    calloc(cfg->nstreams, sizeof(struct bench_stream_s));
+  if (streams == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  /* Connect everything before the clock starts */
+
+  for (i = 0; i < cfg->nstreams; i++)
+    {
+      stream         = &streams[i];
+      stream->cfg    = cfg;
+      stream->id     = i;
+      stream->sd     = -1;
+      stream->buffer = (FAR uint8_t *)malloc(cfg->msgsize);
+      if (stream->buffer == NULL)
+        {
+          ret = -ENOMEM;
+          goto errout;
+        }
+
+      memset(stream->buffer, 0x20 + i, cfg->msgsize);
+
+      stream->sd = bench_connect(cfg);
+      if (stream->sd < 0)
+        {
+          ret = stream->sd;
+          fprintf(stderr, "ERROR: connect to %s failed: %d\n",
+                  cfg->server, ret);
+          goto errout;
+        }
+
+      if (cfg->udp && cfg->rr)
+        {
+          bench_rcvtimeo(stream->sd, BENCH_UDPTIMEOUT);
+        }
+    }
+
+  if (cfg->udp)
+    {
+      control = bench_connect(cfg);
+      if (control < 0)
+        {
+          ret = control;
+          goto errout;
+        }
+
+      bench_rcvtimeo(control, BENCH_UDPTIMEOUT);
+
+      ret = bench_udpcontrol(control, BENCH_MSG_BEGIN, &reply);
+      if (ret < 0)
+        {
+          fprintf(stderr, "ERROR: No answer from %s: %d\n", cfg->server,
+                  ret);
+          goto errout;
+        }
+    }
+
+  printf("%s %s: %d stream%s of %lu byte messages for %lu s\n",
+         cfg->udp ? "udp" : "tcp", cfg->rr ? "rr" : "stream",
+         cfg->nstreams, cfg->nstreams > 1 ? "s" : "",
+         (unsigned long)cfg->msgsize, (unsigned long)cfg->duration);
+
+#ifdef TCPBLASTER_HOST
+  cpustart = bench_cpuusec();
+#endif
+  start = bench_usec();
+
+  if (cfg->nstreams == 1)
+    {
+      bench_client(&streams[0]);
+      nstarted = 1;
+    }
+  else
+    {
+      pthread_attr_init(&attr);
+      pthread_attr_setstacksize(&attr,
+                                CONFIG_EXAMPLES_TCPBLASTER_BENCH_STACKSIZE);
+
+      for (nstarted = 0; nstarted < cfg->nstreams; nstarted++)
+        {
+          ret = pthread_create(&streams[nstarted].thread, &attr,
+                               bench_client, &streams[nstarted]);
+          if (ret != 0)
+            {
+              fprintf(stderr, "ERROR: pthread_create failed: %d\n", ret);
+              ret = -ret;
+              break;
+            }
+        }
+
+      for (i = 0; i < nstarted; i++)
+        {
+          pthread_join(streams[i].thread, NULL);
+        }
+
+      pthread_attr_destroy(&attr);
+    }
+
+  usec    = bench_usec() - start;
+  cpuload = bench_cpuload(cpustart, usec);
+
+  if (usec == 0)
+    {
+      usec = 1;
+    }
+
+  /* Per stream and total results */
+
+  memset(hist, 0, sizeof(struct bench_hist_s));
+  for (i = 0; i < nstarted; i++)
+    {
+      stream = &streams[i];
+
+      if (stream->result < 0)
+        {
+          fprintf(stderr, "ERROR: stream %d failed: %d\n", i,
+                  stream->result);
+          if (ret == OK)
+            {
+              ret = stream->result;
+            }
+        }
+
+      if (cfg->nstreams > 1)
+        {
+          printf("  stream %d: %s %lu KiB in %lu ms (%lu KiB/s)\n", i,
+                 cfg->rr ? "completed" : "sent",
+                 (unsigned long)(stream->bytes >> 10),
+                 (unsigned long)(stream->usec / 1000),
+                 (unsigned long)(stream->usec > 0 ?
+                   (stream->bytes * 1000000 / stream->usec) >> 10 : 0));
+        }
+
+      bytes += stream->bytes;
+      acked += stream->acked;
+      nmsgs += stream->nmsgs;
+      nlost += stream->nlost;
+
+      bench_hist_merge(hist, &stream->hist);
+    }
+
+  if (cfg->udp)
+    {
+      /* The server's count tells how much arrived */
+
+      if (bench_udpcontrol(control, BENCH_MSG_END, &reply) < 0)
+        {
+          fprintf(stderr, "WARNING: No count from the server\n");
+        }
+      else
+        {
+          acked = ((uint64_t)reply.arg2 << 32) | reply.arg3;
+          printf("  sent %lu datagrams, server received %lu (%lu%% lost)\n",
+                 (unsigned long)nmsgs, (unsigned long)reply.arg1,
+                 (unsigned long)(nmsgs > reply.arg1 ?
+                   (uint64_t)(nmsgs - reply.arg1) * 100 / nmsgs : 0));
+        }
+    }
+
+  /* Throughput counts what the server received (for UDP stream) or what
+   * the client sent and had acknowledged.
+   */
+
+  if (cfg->udp && !cfg->rr && acked > 0)
+    {
+      bytes = acked;
+    }
+
+  kibps = (uint32_t)((bytes * 1000000 / usec) >> 10);
+
+  printf("  total: %lu KiB in %lu ms: %lu KiB/s (%lu Mbit/s)\n",
+         (unsigned long)(bytes >> 10), (unsigned long)(usec / 1000),
+         (unsigned long)kibps,
+         (unsigned long)(bytes * 8 / usec));
+
+  if (cfg->rr)
+    {
+      printf("  %lu transactions, %lu/s, %lu lost\n",
+             (unsigned long)hist->nops,
+             (unsigned long)((uint64_t)hist->nops * 1000000 / usec),
+             (unsigned long)nlost);
+      printf("  latency usec: p50 %lu p90 %lu p99 %lu p99.9 %lu max %lu\n",
+             (unsigned long)bench_hist_percentile(hist, 500),
+             (unsigned long)bench_hist_percentile(hist, 900),
+             (unsigned long)bench_hist_percentile(hist, 990),
+             (unsigned long)bench_hist_percentile(hist, 999),
+             (unsigned long)hist->max);
+    }
+
+  /* CPU per byte:  busy CPU time over the bytes moved, in ns per KiB */
+
+  if (cpuload >= 0)
+    {
+      printf("  CPU: %d.%d%%, %lu ns/KiB\n", cpuload / 10, cpuload % 10,
+             (unsigned long)(bytes >= 1024 ?
+               usec * cpuload / (bytes >> 10) : 0));
+    }
+  else
+    {
+      printf("  CPU: unknown\n");
+    }
+
+  if (cfg->csv)
+    {
+      printf("proto,mode,msgsize,streams,bufsize,nodelay,msec,bytes,kibps,"
+             "tps,p50,p90,p99,p999,max,cpu,nspkib\n");
+      printf("%s,%s,%lu,%d,%d,%d,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,"
+             "%d,%lu\n",
+             cfg->udp ? "udp" : "tcp", cfg->rr ? "rr" : "stream",
+             (unsigned long)cfg->msgsize, cfg->nstreams, cfg->bufsize,
+             cfg->nodelay, (unsigned long)(usec / 1000),
+             (unsigned long)bytes, (unsigned long)kibps,
+             (unsigned long)((uint64_t)hist->nops * 1000000 / usec),
+             (unsigned long)bench_hist_percentile(hist, 500),
+             (unsigned long)bench_hist_percentile(hist, 900),
+             (unsigned long)bench_hist_percentile(hist, 990),
+             (unsigned long)bench_hist_percentile(hist, 999),
+             (unsigned long)hist->max, cpuload,
+             (unsigned long)(cpuload >= 0 && bytes >= 1024 ?
+               usec * cpuload / (bytes >> 10) : 0));
+    }
+
+errout:
+  if (control >= 0)
+    {
+      close(control);
+    }
+
+  for (i = 0; i < cfg->nstreams; i++)
+    {
+      if (streams[i].sd >= 0)
+        {
+          close(streams[i].sd);
+        }
+
+      free(streams[i].buffer);
+    }
+
+  free(streams);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: bench_showusage
+ ****************************************************************************/
+
+static void bench_showusage(void)
+{
+  fprintf(stderr, "USAGE: tcpblaster -b -s [-u] [-p <port>] [-w <bytes>] "
+          "[-N]\n");
+  fprintf(stderr, "       tcpblaster -b -c <server> [-u] [-r] "
+          "[-P <streams>] [-l <size>]\n"
+          "                     [-t <secs>] [-p <port>] [-w <bytes>] [-N] "
+          "[-C]\n");
+  fprintf(stderr, "  -s  Server\n");
+  fprintf(stderr, "  -c  Client of <server>\n");
+  fprintf(stderr, "  -u  UDP (default: TCP)\n");
+  fprintf(stderr, "  -r  Request/response latency (default: stream)\n");
+  fprintf(stderr, "  -P  Parallel streams (default: 1, max: %d)\n",
+          CONFIG_EXAMPLES_TCPBLASTER_BENCH_MAXSTREAMS);
+  fprintf(stderr, "  -l  Message size (default: %d)\n", SENDSIZE);
+  fprintf(stderr, "  -t  Duration in seconds (default: 10)\n");
+  fprintf(stderr, "  -p  Port (default: %d)\n",
+          CONFIG_EXAMPLES_TCPBLASTER_SERVER_PORTNO);
+  fprintf(stderr, "  -w  Socket send and receive buffer size\n");
+  fprintf(stderr, "  -N  TCP_NODELAY\n");
+  fprintf(stderr, "  -C  Also print the results as CSV\n");
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcpblaster_bench
+ *
+ * Description:
+ *   The benchmark, 'tcpblaster -b ...'.  argv[0] is the "-b".
+ *
+ ****************************************************************************/
+
+int tcpblaster_bench(int argc, FAR char *argv[])
+{
+  struct bench_config_s cfg;
+  bool server = false;
+  int option;
+  int ret;
+
+  memset(&cfg, 0, sizeof(struct bench_config_s));
+  cfg.msgsize  = SENDSIZE;
+  cfg.duration = 10;
+  cfg.nstreams = 1;
+  cfg.port     = CONFIG_EXAMPLES_TCPBLASTER_SERVER_PORTNO;
+
+  while ((option = getopt(argc, argv, "sc:urP:l:t:p:w:NC")) != ERROR)
+    {
+      switch (option)
+        {
+          case 's':
+            server = true;
+            break;
+
+          case 'c':
+            cfg.server = optarg;
+            break;
+
+          case 'u':
+            cfg.udp = true;
+            break;
+
+          case 'r':
+            cfg.rr = true;
+            break;
+
+          case 'P':
+            cfg.nstreams = atoi(optarg);
+            break;
+
+          case 'l':
+            cfg.msgsize = strtoul(optarg, NULL, 0);
+            break;
+
+          case 't':
+            cfg.duration = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'p':
+            cfg.port = atoi(optarg);
+            break;
+
+          case 'w':
+            cfg.bufsize = atoi(optarg);
+            break;
+
+          case 'N':
+            cfg.nodelay = true;
+            break;
+
+          case 'C':
+            cfg.csv = true;
+            break;
+
+          default:
+            bench_showusage();
+            return EXIT_FAILURE;
+        }
+    }
+
+  if (optind != argc || server == (cfg.server != NULL) ||
+      cfg.nstreams < 1 ||
+      cfg.nstreams > CONFIG_EXAMPLES_TCPBLASTER_BENCH_MAXSTREAMS ||
+      cfg.msgsize < BENCH_HDRSIZE ||
+      cfg.msgsize > BENCH_MAXMSG || cfg.duration == 0)
+    {
+      bench_showusage();
+      return EXIT_FAILURE;
+    }
+
+  if (server)
+    {
+      ret = cfg.udp ? bench_udpserver(&cfg) : bench_tcpserver(&cfg);
+    }
+  else
+    {
+      ret = bench_clients(&cfg);
+    }
+
+  return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -38,12 +38,19 @@
  ****************************************************************************/
 
 #include "config.h"
+#include <string.h>
 #include "tcpblaster.h"
 
 /****************************************************************************
- * Private Data
+ * Public Data
  ****************************************************************************/
 
+#ifdef CONFIG_EXAMPLES_TCPBLASTER_IPv6
+uint16_t g_tcpblasterserver_ipv6[8];
+#else
+uint32_t g_tcpblasterserver_ipv4;
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -54,6 +61,15 @@
 
 int main(int argc, char **argv, char **envp)
 {
+#ifdef CONFIG_EXAMPLES_TCPBLASTER_BENCH
+  /* 'tcpblaster -b ...' runs the benchmark instead */
+
+  if (argc > 1 && strcmp(argv[1], "-b") == 0)
+    {
+      return tcpblaster_bench(argc - 1, &argv[1]);
+    }
+#endif
+
 #ifdef CONFIG_EXAMPLES_TCPBLASTER_SERVER
   tcpblaster_client();
 #else
@@ -43,6 +43,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <sched.h>
 #include <debug.h>
@@ -84,6 +85,15 @@ int tcpblaster_main(int argc, char *argv[])
 #endif
 #endif
 
+#ifdef CONFIG_EXAMPLES_TCPBLASTER_BENCH
+  /* 'tcpblaster -b ...' runs the benchmark instead */
+
+  if (argc > 1 && strcmp(argv[1], "-b") == 0)
+    {
+      return tcpblaster_bench(argc - 1, &argv[1]);
+    }
+#endif
+
   /* Parse any command line options */
 
   tcpblaster_cmdline(argc, argv);
@@ -39,6 +39,7 @@
 
 #include "config.h"
 #include <stdlib.h>
+#include <string.h>
 #include "tcpblaster.h"
 
 /****************************************************************************
@@ -51,6 +52,15 @@ int main(int argc, FAR char *argv[])
 int tcpblaster2_main(int argc, char *argv[])
 #endif
 {
+#ifdef CONFIG_EXAMPLES_TCPBLASTER_BENCH
+  /* 'tcpblaster -b ...' runs the benchmark instead */
+
+  if (argc > 1 && strcmp(argv[1], "-b") == 0)
+    {
+      return tcpblaster_bench(argc - 1, &argv[1]);
+    }
+#endif
+
   /* Parse any command line options */
 
   tcpblaster_cmdline(argc, argv);
@@ -39,9 +39,14 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
+#include <ctype.h>
+#include <errno.h>
 #include <debug.h>
 
 #include "fsutils/inifile.h"
@@ -60,6 +65,10 @@
 #  define CONFIG_FSUTILS_INIFILE_DEBUGLEVEL 0
 #endif
 
+/* End of a hash chain */
+
+#define INIFILE_NONE UINT32_MAX
+
 #ifdef CONFIG_CPP_HAVE_VARARGS
 #  if CONFIG_FSUTILS_INIFILE_DEBUGLEVEL > 0
 #    define inidbg(format, ...) \
@@ -100,12 +109,55 @@ struct inifile_var_s
   FAR char *value;
 };
 
+#ifdef CONFIG_FSUTILS_INIFILE_INDEX
+/* One variable in the index.  Strings are offsets into the string pool. */
+
+struct inifile_entry_s
+{
+  uint32_t hash;                        /* Hash of section and variable name */
+  uint32_t section;                     /* Section name */
+  uint32_t variable;                    /* Variable name */
+  uint32_t value;                       /* Value string, may be empty */
+  uint32_t next;                        /* Next entry in the hash chain */
+};
+
+/* The variables of the INI file that a lookup can reach */
+
+struct inifile_index_s
+{
+  FAR char *pool;                       /* Interned strings */
+  FAR struct inifile_entry_s *entries;  /* Variables in file order */
+  FAR uint32_t *buckets;                /* First entry of each hash chain */
+  uint32_t nentries;                    /* Number of entries */
+  uint32_t mask;                        /* Number of buckets - 1 */
+};
+
+/* Temporary state while the index is built */
+
+struct inifile_build_s
+{
+  size_t poolsize;                      /* Bytes used in the pool */
+  size_t poolalloc;                     /* Bytes allocated for the pool */
+  uint32_t entalloc;                    /* Entries allocated */
+  FAR uint32_t *slots;                  /* Intern table: offset + 1, 0=free */
+  uint32_t nslots;                      /* Size of the intern table */
+  uint32_t nstrings;                    /* Strings in the intern table */
+  FAR uint32_t *sections;               /* Sections seen so far */
+  uint32_t nsections;                   /* Number of sections seen */
+  uint32_t sectalloc;                   /* Sections allocated */
+};
+#endif
+
 /* This structure describes the state of one instance of the INI file parser */
 
 struct inifile_state_s
 {
   FILE *instream;
   int   nextch;
+#ifdef CONFIG_FSUTILS_INIFILE_INDEX
+  bool  indexed;                        /* Lookups use the index */
+  struct inifile_index_s index;
+#endif
   char  line[CONFIG_FSUTILS_INIFILE_MAXLINE+1];
 };
 
@@ -447,6 +499,459 @@ static FAR char *
     }
 }
 
+#ifdef CONFIG_FSUTILS_INIFILE_INDEX
+/****************************************************************************
+ * Name:  inifile_hash
+ *
+ * Description:
+ *   Case insensitive hash of a section and a variable name.
+ *
+ ****************************************************************************/
+
+static uint32_t inifile_hash(FAR const char *section,
+                             FAR const char *variable)
+{
+  uint32_t hash = 2166136261u;
+
+  while (*section != '\0')
+    {
+      hash = (hash ^ (uint8_t)tolower(*section++)) * 16777619u;
+    }
+
+  /* Keep "ab"/"c" apart from "a"/"bc" */
+
+  hash *= 16777619u;
+
+  while (*variable != '\0')
+    {
+      hash = (hash ^ (uint8_t)tolower(*variable++)) * 16777619u;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name:  inifile_grow
+ *
+ * Description:
+ *   Double the allocation of a growing array.
+ *
+ ****************************************************************************/
+
+static int inifile_grow(FAR void **array, FAR uint32_t *nalloc,
+                        size_t elemsize)
+{
+  FAR void *newarray;
+  uint32_t newalloc = *nalloc ? *nalloc * 2 : 16;
+
+  newarray = realloc(*array, newalloc * elemsize);
+  if (newarray == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  *array  = newarray;
+  *nalloc = newalloc;
+  return OK;
+}
+
+/****************************************************************************
+ * Name:  inifile_intern
+ *
+ * Description:
+ *   Return the pool offset of a string, adding it to the pool if it is not
+ *   already there.
+ *
+ ****************************************************************************/
+
+static int inifile_intern(FAR struct inifile_build_s *build,
+                          FAR struct inifile_index_s *index,
+                          FAR const char *str, FAR uint32_t *offset)
+{
+  FAR const uint8_t *ptr;
+  uint32_t hash;
+  uint32_t slot;
+  uint32_t i;
+  size_t len;
+
+  /* Keep the intern table at most half full */
+
+  if (build->nstrings * 2 >= build->nslots)
+    {
+      FAR uint32_t *oldslots = build->slots;
+      uint32_t oldnslots     = build->nslots;
+      uint32_t nslots        = oldnslots ? oldnslots * 2 : 64;
+
+      build->slots = (FAR uint32_t *)zalloc(nslots * sizeof(uint32_t));
+      if (build->slots == NULL)
+        {
+          build->slots = oldslots;
+          return -ENOMEM;
+        }
+
+      build->nslots = nslots;
+
+      /* Re-insert the strings already interned */
+
+      for (i = 0; i < oldnslots; i++)
+        {
+          if (oldslots[i] != 0)
+            {
+              hash = 2166136261u;
+              for (ptr = (FAR const uint8_t *)&index->pool[oldslots[i] - 1];
+                   *ptr != '\0'; ptr++)
+                {
+                  hash = (hash ^ *ptr) * 16777619u;
+                }
+
+              slot = hash & (nslots - 1);
+              while (build->slots[slot] != 0)
+                {
+                  slot = (slot + 1) & (nslots - 1);
+                }
+
+              build->slots[slot] = oldslots[i];
+            }
+        }
+
+      free(oldslots);
+    }
+
+  hash = 2166136261u;
+  for (ptr = (FAR const uint8_t *)str; *ptr != '\0'; ptr++)
+    {
+      hash = (hash ^ *ptr) * 16777619u;
+    }
+
+  /* Look for the string */
+
+  slot = hash & (build->nslots - 1);
+  while (build->slots[slot] != 0)
+    {
+      if (strcmp(&index->pool[build->slots[slot] - 1], str) == 0)
+        {
+          *offset = build->slots[slot] - 1;
+          return OK;
+        }
+
+      slot = (slot + 1) & (build->nslots - 1);
+    }
+
+  /* Not found: append it to the pool */
+
+  len = strlen(str) + 1;
+  if (build->poolsize + len > build->poolalloc)
+    {
+      FAR char *newpool;
+      size_t newalloc = build->poolalloc ? build->poolalloc * 2 : 256;
+
+      while (build->poolsize + len > newalloc)
+        {
+          newalloc *= 2;
+        }
+
+      newpool = (FAR char *)realloc(index->pool, newalloc);
+      if (newpool == NULL)
+        {
+          return -ENOMEM;
+        }
+
+      index->pool      = newpool;
+      build->poolalloc = newalloc;
+    }
+
+  memcpy(&index->pool[build->poolsize], str, len);
+  *offset             = build->poolsize;
+  build->slots[slot]  = build->poolsize + 1;
+  build->poolsize    += len;
+  build->nstrings++;
+  return OK;
+}
+
+/****************************************************************************
+ * Name:  inifile_new_section
+ *
+ * Description:
+ *   Handle a section header in the line buffer.  Only the first section of
+ *   a name can be found by a lookup, so the variables of a repeated section
+ *   are not indexed.  Returns 1 if the section is new, 0 if it is not and a
+ *   negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int inifile_new_section(FAR struct inifile_build_s *build,
+                               FAR struct inifile_index_s *index,
+                               FAR const char *name, FAR uint32_t *section)
+{
+  uint32_t i;
+  int ret;
+
+  for (i = 0; i < build->nsections; i++)
+    {
+      if (strcasecmp(&index->pool[build->sections[i]], name) == 0)
+        {
+          return 0;
+        }
+    }
+
+  if (build->nsections >= build->sectalloc)
+    {
+      ret = inifile_grow((FAR void **)&build->sections, &build->sectalloc,
+                         sizeof(uint32_t));
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  ret = inifile_intern(build, index, name, section);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  build->sections[build->nsections++] = *section;
+  return 1;
+}
+
+/****************************************************************************
+ * Name:  inifile_add_variable
+ *
+ * Description:
+ *   Add a variable to the index.
+ *
+ ****************************************************************************/
+
+static int inifile_add_variable(FAR struct inifile_build_s *build,
+                                FAR struct inifile_index_s *index,
+                                uint32_t section, FAR const char *variable,
+                                FAR const char *value)
+{
+  FAR struct inifile_entry_s *entry;
+  int ret;
+
+  if (index->nentries >= build->entalloc)
+    {
+      ret = inifile_grow((FAR void **)&index->entries, &build->entalloc,
+                         sizeof(struct inifile_entry_s));
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  entry          = &index->entries[index->nentries];
+  entry->section = section;
+
+  ret = inifile_intern(build, index, variable, &entry->variable);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = inifile_intern(build, index, value, &entry->value);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  entry->hash = inifile_hash(&index->pool[section], variable);
+  index->nentries++;
+  return OK;
+}
+
+/****************************************************************************
+ * Name:  inifile_free_index
+ ****************************************************************************/
+
+static void inifile_free_index(FAR struct inifile_index_s *index)
+{
+  free(index->pool);
+  free(index->entries);
+  free(index->buckets);
+  memset(index, 0, sizeof(struct inifile_index_s));
+}
+
+/****************************************************************************
+ * Name:  inifile_build_index
+ *
+ * Description:
+ *   Read the whole INI file once and index every variable that a lookup
+ *   could find.  The rules are those of inifile_seek_to_section() and
+ *   inifile_find_section_variable():  only the first section of a name is
+ *   searched, a section ends at a blank line or at a line beginning with
+ *   '[', and the first assignment to a variable wins.
+ *
+ ****************************************************************************/
+
+static int inifile_build_index(FAR struct inifile_state_s *priv)
+{
+  FAR struct inifile_index_s *index = &priv->index;
+  struct inifile_build_s build;
+  FAR struct inifile_entry_s *entry;
+  FAR char *ptr;
+  uint32_t section = 0;
+  uint32_t nbuckets;
+  uint32_t i;
+  bool insection = false;
+  int nbytes;
+  int ret = OK;
+
+  memset(&build, 0, sizeof(struct inifile_build_s));
+  memset(index, 0, sizeof(struct inifile_index_s));
+
+  rewind(priv->instream);
+  priv->nextch = getc(priv->instream);
+
+  do
+    {
+      nbytes = inifile_read_noncomment_line(priv);
+      if (nbytes == 0)
+        {
+          /* A blank line ends the section */
+
+          insection = false;
+        }
+      else if (priv->line[0] == '[')
+        {
+          insection = false;
+
+          /* It takes at least three bytes to be a section header */
+
+          if (nbytes >= 3)
+            {
+              ptr = strchr(&priv->line[1], ']');
+              if (ptr)
+                {
+                  *ptr = '\0';
+                }
+
+              ret = inifile_new_section(&build, index, &priv->line[1],
+                                        &section);
+              if (ret < 0)
+                {
+                  goto errout;
+                }
+
+              insection = (ret == 1);
+            }
+        }
+      else if (insection)
+        {
+          ptr = strchr(&priv->line[1], '=');
+          if (ptr)
+            {
+              *ptr = '\0';
+              ret  = inifile_add_variable(&build, index, section,
+                                          priv->line, ptr + 1);
+              if (ret < 0)
+                {
+                  goto errout;
+                }
+            }
+        }
+    }
+  while (priv->nextch != EOF);
+
+  /* Release the slack of the growing arrays */
+
+  if (build.poolsize > 0)
+    {
+      ptr = (FAR char *)realloc(index->pool, build.poolsize);
+      if (ptr != NULL)
+        {
+          index->pool = ptr;
+        }
+    }
+
+  if (index->nentries > 0)
+    {
+      entry = (FAR struct inifile_entry_s *)
+        realloc(index->entries,
+                index->nentries * sizeof(struct inifile_entry_s));
+      if (entry != NULL)
+        {
+          index->entries = entry;
+        }
+    }
+
+  /* Hash the entries.  Adding them in reverse leaves each chain in file
+   * order, so that the first assignment of a variable is found first.
+   */
+
+  nbuckets = 1;
+  while (nbuckets < index->nentries)
+    {
+      nbuckets <<= 1;
+    }
+
+  index->buckets = (FAR uint32_t *)malloc(nbuckets * sizeof(uint32_t));
+  if (index->buckets == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  index->mask = nbuckets - 1;
+  memset(index->buckets, 0xff, nbuckets * sizeof(uint32_t));
+
+  for (i = index->nentries; i-- > 0; )
+    {
+      entry       = &index->entries[i];
+      entry->next = index->buckets[entry->hash & index->mask];
+      index->buckets[entry->hash & index->mask] = i;
+    }
+
+  iniinfo("Indexed %lu variables, %lu bytes of strings\n",
+          (unsigned long)index->nentries, (unsigned long)build.poolsize);
+
+  free(build.slots);
+  free(build.sections);
+  return OK;
+
+errout:
+  inidbg("ERROR: Failed to index the INI file: %d\n", ret);
+  free(build.slots);
+  free(build.sections);
+  inifile_free_index(index);
+  return ret;
+}
+
+/****************************************************************************
+ * Name:  inifile_lookup
+ *
+ * Description:
+ *   Find a variable in the index.  Like inifile_find_variable(), this
+ *   returns NULL if the variable is not found or has no value.
+ *
+ ****************************************************************************/
+
+static FAR char *inifile_lookup(FAR struct inifile_index_s *index,
+                                FAR const char *section,
+                                FAR const char *variable)
+{
+  FAR struct inifile_entry_s *entry;
+  uint32_t hash = inifile_hash(section, variable);
+  uint32_t i;
+
+  for (i = index->buckets[hash & index->mask];
+       i != INIFILE_NONE;
+       i = entry->next)
+    {
+      entry = &index->entries[i];
+      if (entry->hash == hash &&
+          strcasecmp(&index->pool[entry->variable], variable) == 0 &&
+          strcasecmp(&index->pool[entry->section], section) == 0)
+        {
+          FAR char *value = &index->pool[entry->value];
+          return *value != '\0' ? value : NULL;
+        }
+    }
+
+  return NULL;
+}
+#endif
+
 /****************************************************************************
  * Name:  inifile_find_variable
  *
@@ -464,6 +969,13 @@ static FAR char *inifile_find_variable(FAR struct inifile_state_s *priv,
 
   iniinfo("section=\"%s\" variable=\"%s\"\n", section, variable);
 
+#ifdef CONFIG_FSUTILS_INIFILE_INDEX
+  if (priv->indexed)
+    {
+      return inifile_lookup(&priv->index, section, variable);
+    }
+#endif
+
   /* Seek to the first variable in the specified section of the INI file */
 
   if (priv->instream && inifile_seek_to_section(priv, section))
@@ -505,7 +1017,7 @@ INIHANDLE inifile_initialize(FAR const char *inifile_name)
   /* Allocate an INI file parser state structure */
 
   FAR struct inifile_state_s *priv =
-    (FAR struct inifile_state_s *)malloc(sizeof(struct inifile_state_s));
+    (FAR struct inifile_state_s *)zalloc(sizeof(struct inifile_state_s));
 
   if (!priv)
     {
@@ -516,19 +1028,34 @@ INIHANDLE inifile_initialize(FAR const char *inifile_name)
   /* Open the specified INI file for reading */
 
   priv->instream = fopen(inifile_name, "r");
+  if (!priv->instream)
+    {
+      inidbg("ERROR: Could not open \"%s\"\n", inifile_name);
+      free(priv);
+      return (INIHANDLE)NULL;
+    }
 
-  /* Prime the pump */
+#ifdef CONFIG_FSUTILS_INIFILE_INDEX
+  /* Read the file once and index it.  The file is no longer needed then.
+   * If there is not enough memory for the index, fall back to reading the
+   * file on each lookup.
+   */
 
-  if (priv->instream)
+  if (inifile_build_index(priv) == OK)
     {
-      priv->nextch = getc(priv->instream);
+      fclose(priv->instream);
+      priv->instream = NULL;
+      priv->indexed  = true;
       return (INIHANDLE)priv;
     }
-  else
-    {
-      inidbg("ERROR: Could not open \"%s\"\n", inifile_name);
-      return (INIHANDLE)NULL;
-    }
+
+  rewind(priv->instream);
+#endif
+
+  /* Prime the pump */
+
+  priv->nextch = getc(priv->instream);
+  return (INIHANDLE)priv;
 }
 
 /****************************************************************************
@@ -552,6 +1079,12 @@ void inifile_uninitialize(INIHANDLE handle)
           fclose(priv->instream);
         }
 
+#ifdef CONFIG_FSUTILS_INIFILE_INDEX
+      /* Release the index */
+
+      inifile_free_index(&priv->index);
+#endif
+
       /* Release the state structure */
 
       free(priv);
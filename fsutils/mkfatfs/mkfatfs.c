@@ -350,12 +350,29 @@ int mkfatfs(FAR const char *pathname, FAR struct fat_format_s *fmt)
       goto errout_with_driver;
     }
 
-  /* Allocate a buffer that will be working sector memory */
+  /* Allocate the working buffer: one sector image followed by the zeroed
+   * sectors that are written along with it.  Settle for fewer sectors if
+   * memory is short.
+   */
+
+  var.fv_nbufsects = CONFIG_FSUTILS_MKFATFS_BUFSECTORS;
+  for (; ; )
+    {
+      var.fv_sect = (FAR uint8_t *)
+        zalloc((var.fv_nbufsects + 1) << var.fv_sectshift);
+
+      if (var.fv_sect != NULL || var.fv_nbufsects <= 1)
+        {
+          break;
+        }
+
+      var.fv_nbufsects >>= 1;
+    }
 
-  var.fv_sect = (FAR uint8_t *)malloc(var.fv_sectorsize);
   if (!var.fv_sect)
     {
       ferr("ERROR: Failed to allocate working buffers\n");
+      ret = -ENOMEM;
       goto errout_with_driver;
     }
 
@@ -64,6 +64,12 @@
 
 #define FAT32_DEFAULT_ROOT_CLUSTER     2
 
+/* Number of sectors written at once */
+
+#ifndef CONFIG_FSUTILS_MKFATFS_BUFSECTORS
+#  define CONFIG_FSUTILS_MKFATFS_BUFSECTORS 16
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -86,7 +92,10 @@ struct fat_var_s
   uint32_t       fv_sectorsize;     /* Size of one hardware sector */
   uint32_t       fv_nfatsects;      /* Number of sectors in each FAT */
   uint32_t       fv_nclusters;      /* Number of clusters */
-  uint8_t       *fv_sect;           /* Allocated working sector buffer */
+  uint32_t       fv_nbufsects;      /* Number of sectors written at once */
+  uint32_t       fv_nwritten;       /* Number of sectors written so far */
+  uint32_t       fv_ntotal;         /* Number of sectors to be written */
+  uint8_t       *fv_sect;           /* Working buffer, fv_nbufsects + 1 */
   const uint8_t *fv_bootcode;       /* Points to boot code to put into MBR */
 };
 
@@ -60,34 +60,40 @@
  * Name: mkfatfs_devwrite
  *
  * Description:
- *   Write the content of the dedicate sector buffer beginning to the specified sector
+ *   Write nsectors sectors from buffer beginning at the specified sector
  *
  * Input:
- *    fmt  - User specified format parameters
- *    var  - Other format parameters that are not user specifiable
+ *    fmt      - User specified format parameters
+ *    var      - Other format parameters that are not user specifiable
+ *    sector   - The first sector to write
+ *    buffer   - The sector data
+ *    nsectors - The number of sectors in buffer
  *
  * Return:
- *    None; caller is responsible for providing valid parameters.
+ *    Zero on success; negated errno on failure
  *
  ****************************************************************************/
 
 static int mkfatfs_devwrite(FAR const struct fat_format_s *fmt,
-                            FAR const struct fat_var_s *var, off_t sector)
+                            FAR struct fat_var_s *var, off_t sector,
+                            FAR const uint8_t *buffer, uint32_t nsectors)
 {
   ssize_t nwritten;
+  size_t nbytes;
   off_t seekpos;
   off_t fpos;
   int ret;
 
   /* Convert the sector number to a byte offset */
 
-  if (sector < 0 || sector >= fmt->ff_nsectors)
+  if (sector < 0 || sector + nsectors > fmt->ff_nsectors)
     {
       ferr("sector out of range: %lu\n", (unsigned long)sector);
       return -ESPIPE;
     }
 
-  fpos = sector << var->fv_sectshift;
+  fpos   = sector << var->fv_sectshift;
+  nbytes = (size_t)nsectors << var->fv_sectshift;
 
   /* Seek to that offset */
 
@@ -105,23 +111,87 @@ static int mkfatfs_devwrite(FAR const struct fat_format_s *fmt,
       return -EINVAL;
     }
 
-  /* Write the sector to that offset.  Partial writes are not expected. */
+  /* Write the sectors to that offset.  Partial writes are not expected. */
 
-  nwritten = write(var->fv_fd, var->fv_sect, var->fv_sectorsize);
+  nwritten = write(var->fv_fd, buffer, nbytes);
   if (nwritten < 0)
     {
       ret = -errno;
       ferr("ERROR:  write failed: size=%lu pos=%lu error=%d\n",
-           (unsigned)var->fv_sectorsize, (unsigned long)fpos, ret);
+           (unsigned long)nbytes, (unsigned long)fpos, ret);
       return ret;
     }
-  else if (nwritten != (ssize_t)var->fv_sectorsize)
+  else if (nwritten != (ssize_t)nbytes)
     {
       ferr("ERROR:  Partial write: size=%lu written=%lu\n",
-           (unsigned)var->fv_sectorsize, (unsigned long)nwritten);
+           (unsigned long)nbytes, (unsigned long)nwritten);
       return -ENODATA;
     }
 
+  /* Report progress */
+
+  var->fv_nwritten += nsectors;
+  if (fmt->ff_progress != NULL)
+    {
+      fmt->ff_progress(fmt->ff_progarg, var->fv_nwritten, var->fv_ntotal);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mkfatfs_writerun
+ *
+ * Description:
+ *   Write a run of sectors made of the sector image at the beginning of
+ *   the working buffer followed by zeroed sectors.  The reserved area, each
+ *   FAT and the root directory all have this form.
+ *
+ *   The working buffer holds fv_nbufsects + 1 sectors, of which all but the
+ *   first are always zero.  The run is written fv_nbufsects sectors at a
+ *   time: the first write starts with the sector image, the others are
+ *   taken from the zeroed part of the buffer.
+ *
+ * Input:
+ *    fmt      - User specified format parameters
+ *    var      - Other format parameters that are not user specifiable
+ *    sector   - The first sector of the run
+ *    nsectors - The number of sectors in the run
+ *
+ * Return:
+ *    Zero on success; negated errno on failure
+ *
+ ****************************************************************************/
+
+static int mkfatfs_writerun(FAR const struct fat_format_s *fmt,
+                            FAR struct fat_var_s *var, off_t sector,
+                            uint32_t nsectors)
+{
+  FAR const uint8_t *buffer = var->fv_sect;
+  uint32_t count;
+  int ret;
+
+  while (nsectors > 0)
+    {
+      count = nsectors;
+      if (count > var->fv_nbufsects)
+        {
+          count = var->fv_nbufsects;
+        }
+
+      ret = mkfatfs_devwrite(fmt, var, sector, buffer, count);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      /* Everything after the first sector of the run is zero */
+
+      buffer    = &var->fv_sect[var->fv_sectorsize];
+      sector   += count;
+      nsectors -= count;
+    }
+
   return OK;
 }
 
@@ -391,24 +461,17 @@ static inline void mkfatfs_initrootdir(FAR struct fat_format_s *fmt,
 static inline int mkfatfs_writembr(FAR struct fat_format_s *fmt,
                                    FAR struct fat_var_s *var)
 {
-  int sectno;
   int ret;
 
   /* Create an image of the configured master boot record */
 
   mkfatfs_initmbr(fmt, var);
 
-  /* Write the master boot record as sector zero */
-
-  ret = mkfatfs_devwrite(fmt, var, 0);
-
-  /* Write all of the reserved sectors */
+  /* Write the master boot record as sector zero, followed by the rest of
+   * the reserved sectors.
+   */
 
-  memset(var->fv_sect, 0, var->fv_sectorsize);
-  for (sectno = 1; sectno < fmt->ff_rsvdseccount && ret >= 0; sectno++)
-    {
-      ret = mkfatfs_devwrite(fmt, var, sectno);
-    }
+  ret = mkfatfs_writerun(fmt, var, 0, fmt->ff_rsvdseccount);
 
   /* Write FAT32-specific sectors */
 
@@ -424,7 +487,8 @@ static inline int mkfatfs_writembr(FAR struct fat_format_s *fmt,
 
           /* Write it to the backup location */
 
-          ret = mkfatfs_devwrite(fmt, var, fmt->ff_backupboot);
+          ret = mkfatfs_devwrite(fmt, var, fmt->ff_backupboot,
+                                 var->fv_sect, 1);
         }
 
       if (ret >= 0)
@@ -435,7 +499,8 @@ static inline int mkfatfs_writembr(FAR struct fat_format_s *fmt,
 
           /* Write the fsinfo sector */
 
-          ret = mkfatfs_devwrite(fmt, var, FAT_DEFAULT_FSINFO_SECTOR);
+          ret = mkfatfs_devwrite(fmt, var, FAT_DEFAULT_FSINFO_SECTOR,
+                                 var->fv_sect, 1);
         }
     }
 
@@ -466,69 +531,58 @@ static inline int mkfatfs_writefat(FAR struct fat_format_s *fmt,
 {
   off_t offset = fmt->ff_rsvdseccount;
   int fatno;
-  int sectno;
   int ret;
 
-  /* Loop for each FAT copy */
+  /* Only the first sector of a FAT is not zero.  Mark the cluster
+   * allocations there.
+   */
 
-  for (fatno = 0; fatno < fmt->ff_nfats; fatno++)
+  memset(var->fv_sect, 0, var->fv_sectorsize);
+  switch (fmt->ff_fattype)
     {
-      /* Loop for each sector in the FAT */
-
-       for (sectno = 0; sectno < var->fv_nfatsects; sectno++)
-         {
-           memset(var->fv_sect, 0, var->fv_sectorsize);
+      case 12:
+        /* Mark the first two full FAT entries -- 24 bits, 3 bytes total */
 
-          /* Mark cluster allocations in sector one of each FAT */
+        memset(var->fv_sect, 0xff, 3);
+        break;
 
-           if (sectno == 0)
-             {
-               memset(var->fv_sect, 0, var->fv_sectorsize);
-               switch (fmt->ff_fattype)
-                 {
-                   case 12:
-                     /* Mark the first two full FAT entries -- 24 bits, 3 bytes total */
+      case 16:
+        /* Mark the first two full FAT entries -- 32 bits, 4 bytes total */
 
-                     memset(var->fv_sect, 0xff, 3);
-                     break;
+        memset(var->fv_sect, 0xff, 4);
+        break;
 
-                   case 16:
-                     /* Mark the first two full FAT entries -- 32 bits, 4 bytes total */
+      case 32:
+      default: /* Shouldn't happen */
+        /* Mark the first two full FAT entries -- 64 bits, 8 bytes total */
 
-                     memset(var->fv_sect, 0xff, 4);
-                     break;
+        memset(var->fv_sect, 0xff, 8);
 
-                   case 32:
-                   default: /* Shouldn't happen */
-                     /* Mark the first two full FAT entries -- 64 bits, 8 bytes total */
+        /* Cluster 2 is used as the root directory.  Mark as EOF */
 
-                     memset(var->fv_sect, 0xff, 8);
-
-                     /* Cluster 2 is used as the root directory.  Mark as EOF */
-
-                     var->fv_sect[8] =  0xf8;
-                     memset(&var->fv_sect[9], 0xff, 3);
-                     break;
-                 }
+        var->fv_sect[8] =  0xf8;
+        memset(&var->fv_sect[9], 0xff, 3);
+        break;
+    }
 
-               /* Save the media type in the first byte of the FAT */
+  /* Save the media type in the first byte of the FAT */
 
-               var->fv_sect[0] = FAT_DEFAULT_MEDIA_TYPE;
-            }
+  var->fv_sect[0] = FAT_DEFAULT_MEDIA_TYPE;
 
-           /* Write the FAT sector */
+  /* Write each FAT copy from the same image */
 
-           ret = mkfatfs_devwrite(fmt, var, offset);
-           if (ret < 0)
-             {
-               return ret;
-             }
+  for (fatno = 0; fatno < fmt->ff_nfats; fatno++)
+    {
+      ret = mkfatfs_writerun(fmt, var, offset, var->fv_nfatsects);
+      if (ret < 0)
+        {
+          return ret;
+        }
 
-           offset++;
-         }
-     }
+      offset += var->fv_nfatsects;
+    }
 
-   return OK;
+  return OK;
 }
 
 /****************************************************************************
@@ -550,31 +604,14 @@ static inline int mkfatfs_writerootdir(FAR struct fat_format_s *fmt,
                                        FAR struct fat_var_s *var)
 {
   off_t offset = fmt->ff_rsvdseccount + fmt->ff_nfats * var->fv_nfatsects;
-  int ret;
-  int i;
 
   /* Write the root directory after the last FAT. This is the root directory
-   * area for FAT12/16, and the first cluster on FAT32.
+   * area for FAT12/16, and the first cluster on FAT32.  Only the first
+   * sector holds an entry, the volume label.
    */
 
-  for (i = 0; i < var->fv_nrootdirsects; i++)
-    {
-      /* Format the next sector of the root directory */
-
-      mkfatfs_initrootdir(fmt, var, i);
-
-      /* Write the next sector of the root directory */
-
-      ret = mkfatfs_devwrite(fmt, var, offset);
-      if (ret < 0)
-        {
-          return ret;
-        }
-
-      offset++;
-    }
-
-  return 0;
+  mkfatfs_initrootdir(fmt, var, 0);
+  return mkfatfs_writerun(fmt, var, offset, var->fv_nrootdirsects);
 }
 
 /****************************************************************************
@@ -602,6 +639,18 @@ int mkfatfs_writefatfs(FAR struct fat_format_s *fmt,
 {
   int ret;
 
+  /* Count the sectors to be written for progress reports */
+
+  var->fv_nwritten = 0;
+  var->fv_ntotal   = fmt->ff_rsvdseccount +
+                     fmt->ff_nfats * var->fv_nfatsects +
+                     var->fv_nrootdirsects;
+
+  if (fmt->ff_fattype == 32)
+    {
+      var->fv_ntotal += (fmt->ff_backupboot != 0) ? 2 : 1;
+    }
+
   /* Write the master boot record (also the backup and fsinfo sectors) */
 
   ret = mkfatfs_writembr(fmt, var);
@@ -175,6 +175,7 @@ int mksmartfs(FAR const char *pathname, uint16_t sectorsize)
   fd = open(pathname, O_RDWR);
   if (fd < 0)
     {
+      ret = -errno;
       goto errout;
     }
 
@@ -187,12 +188,18 @@ int mksmartfs(FAR const char *pathname, uint16_t sectorsize)
 #endif
   if (ret != OK)
     {
+      ret = -errno;
       goto errout_with_driver;
     }
 
   /* Get the format information so we know how big the sectors are */
 
   ret = ioctl(fd, BIOC_GETFORMAT, (unsigned long) &fmt);
+  if (ret != OK)
+    {
+      ret = -errno;
+      goto errout_with_driver;
+    }
 
   /* Now Write the filesystem to media.  Loop for each root dir entry and
    * allocate the reserved Root Dir Enty, then write a blank root dir for it.
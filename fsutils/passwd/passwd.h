@@ -40,10 +40,13 @@
  * Included Files
  ****************************************************************************/
 
+#include <nuttx/config.h>
+
 #include <sys/types.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <semaphore.h>
+#include <pthread.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -61,10 +64,28 @@
 
 #define MAX_PASSWORD  (3 * MAX_ENCRYPTED / 4)
 
+/* Readers of the passwd file can share the lock in the FLAT and PROTECTED
+ * builds where a single pthread read/write lock is visible to every task.
+ * In the kernel build a named semaphore is used instead and readers are
+ * serialized just like writers.
+ */
+
+#if defined(CONFIG_FS_WRITABLE) && !defined(CONFIG_FSUTILS_PASSWD_READONLY)
+#  if !defined(CONFIG_BUILD_LOADABLE) && !defined(CONFIG_DISABLE_PTHREAD)
+#    define PASSWD_HAVE_RWLOCK 1
+#  endif
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+#ifdef PASSWD_HAVE_RWLOCK
+typedef pthread_rwlock_t passwd_lock_t;
+#else
+typedef sem_t passwd_lock_t;
+#endif
+
 struct passwd_s
 {
   off_t offset;                      /* File offset (start of record) */
@@ -76,7 +97,7 @@ struct passwd_s
  ****************************************************************************/
 
 /****************************************************************************
- * Name: passwd_lock and passwd_unlock
+ * Name: passwd_lock, passwd_rdlock and passwd_unlock
  *
  * Description:
  *   Lock the /etc/passwd file.  This is not a real lock at the level of the
@@ -85,6 +106,10 @@ struct passwd_s
  *   passwd_update().  Other accesses to /etc/passwd could still cause
  *   concurrency problem and file corruption.
  *
+ *   passwd_lock() takes the lock for modification; passwd_rdlock() takes
+ *   it for reading so that concurrent passwd_verify() calls do not block
+ *   one another.  Either is released with passwd_unlock().
+ *
  * Input Parameters:
  *
  * Returned Value:
@@ -94,13 +119,15 @@ struct passwd_s
  ****************************************************************************/
 
 #if defined(CONFIG_FS_WRITABLE) && !defined(CONFIG_FSUTILS_PASSWD_READONLY)
-#  define PASSWD_SEM_DECL(s) FAR sem_t *s
-int passwd_lock(FAR sem_t **semp);
-int passwd_unlock(FAR sem_t *sem);
+#  define PASSWD_LOCK_DECL(l) FAR passwd_lock_t *l
+int passwd_lock(FAR passwd_lock_t **lockp);
+int passwd_rdlock(FAR passwd_lock_t **lockp);
+int passwd_unlock(FAR passwd_lock_t *lock);
 #else
-#  define PASSWD_SEM_DECL(s)
-#  define passwd_lock(semp)  (0)
-#  define passwd_unlock(sem) (0)
+#  define PASSWD_LOCK_DECL(l)
+#  define passwd_lock(lockp)   (0)
+#  define passwd_rdlock(lockp) (0)
+#  define passwd_unlock(lock)  (0)
 #endif
 
 /****************************************************************************
@@ -136,6 +163,60 @@ int passwd_encrypt(FAR const char *password, char encrypted[MAX_ENCRYPTED + 1]);
 
 int passwd_append(FAR const char *username, FAR const char *password);
 
+/****************************************************************************
+ * Name: passwd_rewrite
+ *
+ * Description:
+ *   Write a new copy of the /etc/passwd file to a temporary file, dropping
+ *   the record at offset (if offset is not negative) and adding a record
+ *   for username at the end (if username is not NULL).  The new file then
+ *   replaces the old one with rename(), so that readers see either the
+ *   complete old file or the complete new file.
+ *
+ *   On file systems where rename() cannot replace an existing file (FAT,
+ *   tmpfs), the old file is first renamed to /etc/passwd.bak and only
+ *   removed once the new one is in place.  /etc/passwd does not exist
+ *   between those two renames.  Readers in this library hold the passwd
+ *   lock and never see that window, but other readers may.  If the system
+ *   is reset within it, passwd_recover() restores the backup on the next
+ *   lookup.
+ *
+ * Input Parameters:
+ *   offset    - File offset of the record to remove, or -1
+ *   username  - Name for the new record, or NULL
+ *   encrypted - Encrypted password for the new record
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+int passwd_rewrite(off_t offset, FAR const char *username,
+                   FAR const char *encrypted);
+
+/****************************************************************************
+ * Name: passwd_recover
+ *
+ * Description:
+ *   Restore /etc/passwd from the /etc/passwd.bak backup left by an
+ *   interrupted passwd_rewrite().  Called with the passwd lock held when
+ *   /etc/passwd does not exist.
+ *
+ * Input Parameters:
+ *
+ * Returned Value:
+ *   Zero (OK) is returned if the file was restored; a negated errno value
+ *   is returned otherwise (-ENOENT if there is no backup).
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_FS_WRITABLE) && !defined(CONFIG_FSUTILS_PASSWD_READONLY)
+int passwd_recover(void);
+#else
+#  define passwd_recover() (-ENOENT)
+#endif
+
 /****************************************************************************
  * Name: passwd_delete
  *
@@ -150,13 +231,15 @@ int passwd_append(FAR const char *username, FAR const char *password);
  *
  ****************************************************************************/
 
-int passwd_delete(off_t offset);
+#define passwd_delete(offset) passwd_rewrite(offset, NULL, NULL)
 
 /****************************************************************************
  * Name: passwd_find
  *
  * Description:
- *   Find a password in the
+ *   Find the record for username in the /etc/passwd file.  With
+ *   CONFIG_FSUTILS_PASSWD_CACHE the lookup is served from an in-memory,
+ *   hashed copy of the file (see passwd_cache.c).
  *
  * Input Parameters:
  *
@@ -168,4 +251,20 @@ int passwd_delete(off_t offset);
 
 int passwd_find(FAR const char *username, FAR struct passwd_s *passwd);
 
+/****************************************************************************
+ * Name: passwd_cache_invalidate
+ *
+ * Description:
+ *   Discard the cached copy of the /etc/passwd file so that the next
+ *   passwd_find() reloads it.  Called with the passwd lock held whenever
+ *   the file is rewritten.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FSUTILS_PASSWD_CACHE
+void passwd_cache_invalidate(void);
+#else
+#  define passwd_cache_invalidate()
+#endif
+
 #endif /* __APPS_FSUTILS_PASSWD_PASSWD_H */
@@ -67,12 +67,12 @@
 int passwd_adduser(FAR const char *username, FAR const char *password)
 {
   struct passwd_s passwd;
-  PASSWD_SEM_DECL(sem);
+  PASSWD_LOCK_DECL(lock);
   int ret;
 
   /* Get exclusive access to the /etc/passwd file */
 
-  ret = passwd_lock(&sem);
+  ret = passwd_lock(&lock);
   if (ret < 0)
     {
       return ret;
@@ -102,6 +102,6 @@ int passwd_adduser(FAR const char *username, FAR const char *password)
   ret = OK;
 
 errout_with_lock:
-  (void)passwd_unlock(sem);
+  (void)passwd_unlock(lock);
   return ret;
 }
@@ -37,9 +37,7 @@
  * Included Files
  ****************************************************************************/
 
-#include <stdio.h>
-#include <assert.h>
-#include <errno.h>
+#include <sys/types.h>
 
 #include "passwd.h"
 
@@ -64,7 +62,6 @@
 int passwd_append(FAR const char *username, FAR const char *password)
 {
   char encrypted[MAX_ENCRYPTED + 1];
-  FILE *stream;
   int ret;
 
   /* Encrypt the raw password */
@@ -75,30 +72,9 @@ int passwd_append(FAR const char *username, FAR const char *password)
       return ret;
     }
 
-  /* Append the new user record to the end of the password file */
+  /* Add the new user record to the end of a new copy of the password file.
+   * Appending in place could leave a partial record behind if interrupted.
+   */
 
-  stream = fopen(CONFIG_FSUTILS_PASSWD_PATH, "a");
-  if (stream == NULL)
-   {
-      int errcode = errno;
-      DEBUGASSERT(errcode > 0);
-      return errcode;
-   }
-
-  ret = fprintf(stream, "%s %s\n", username, encrypted);
-  if (ret < 0)
-    {
-      int errcode = errno;
-      DEBUGASSERT(errcode > 0);
-      ret = -errcode;
-      goto errout_with_stream;
-    }
-
-  /* Return success */
-
-  ret = OK;
-
-errout_with_stream:
-  (void)fclose(stream);
-  return ret;
+  return passwd_rewrite(-1, username, encrypted);
 }
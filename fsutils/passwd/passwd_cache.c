@@ -0,0 +1,578 @@
+/****************************************************************************
+ * apps/fsutils/passwd/passwd_cache.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <ctype.h>
+#include <semaphore.h>
+#include <assert.h>
+#include <errno.h>
+
+#include "passwd.h"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One record of the cached /etc/passwd file.  Records that are malformed
+ * are kept too so that passwd_find() reports the same error for them that
+ * a scan of the file would.
+ */
+
+struct passwd_entry_s
+{
+  FAR const char *username;          /* User name (in the file image) */
+  uint32_t hash;                     /* Hash of the user name */
+  int next;                          /* Next entry in the bucket, or -1 */
+  int status;                        /* OK or the negated errno to return */
+  off_t offset;                      /* File offset (start of record) */
+  char encrypted[MAX_ENCRYPTED + 1]; /* Encrypted password in file */
+};
+
+/* One cached copy of the /etc/passwd file.  A copy is never modified once
+ * it has been published, so lookups search it without holding any lock.
+ */
+
+struct passwd_cache_s
+{
+  int crefs;                         /* g_cache and lookups in progress */
+  time_t mtime;                      /* Modification time of the file */
+  off_t size;                        /* Size of the file */
+  FAR char *image;                   /* The file contents */
+  FAR struct passwd_entry_s *entries;
+  FAR int *buckets;                  /* First entry of each bucket, or -1 */
+  uint32_t mask;                     /* Number of buckets - 1 */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The cache is shared by all tasks that can see it.  g_cache_sem protects
+ * g_cache and the reference counts.  It is held only to take or drop a
+ * reference and during reloads, not while a copy is searched.  Taking and
+ * releasing it also orders the construction of a new copy before its
+ * publication on SMP.  A copy replaced by a reload is freed when the last
+ * lookup using it drops its reference.
+ */
+
+static FAR struct passwd_cache_s *g_cache;
+static sem_t g_cache_sem = SEM_INITIALIZER(1);
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: passwd_cache_lock and passwd_cache_unlock
+ ****************************************************************************/
+
+static void passwd_cache_lock(void)
+{
+  while (sem_wait(&g_cache_sem) < 0)
+    {
+      int errcode = errno;
+      DEBUGASSERT(errcode == EINTR || errcode == ECANCELED);
+      UNUSED(errcode);
+    }
+}
+
+static void passwd_cache_unlock(void)
+{
+  sem_post(&g_cache_sem);
+}
+
+/****************************************************************************
+ * Name: passwd_hash
+ *
+ * Description:
+ *   FNV-1a hash of a user name.
+ *
+ ****************************************************************************/
+
+static uint32_t passwd_hash(FAR const char *username)
+{
+  uint32_t hash = 2166136261u;
+
+  while (*username != '\0')
+    {
+      hash ^= (uint8_t)*username++;
+      hash *= 16777619u;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: passwd_lookup
+ *
+ * Description:
+ *   Find the cached entry for username.
+ *
+ ****************************************************************************/
+
+static FAR struct passwd_entry_s *
+passwd_lookup(FAR struct passwd_cache_s *cache, FAR const char *username,
+              uint32_t hash)
+{
+  FAR struct passwd_entry_s *entry;
+  int ndx;
+
+  for (ndx = cache->buckets[hash & cache->mask]; ndx >= 0;
+       ndx = entry->next)
+    {
+      entry = &cache->entries[ndx];
+      if (entry->hash == hash && strcmp(entry->username, username) == 0)
+        {
+          return entry;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: passwd_free
+ *
+ * Description:
+ *   Free one cached copy of the file.
+ *
+ ****************************************************************************/
+
+static void passwd_free(FAR struct passwd_cache_s *cache)
+{
+  free(cache->image);
+  free(cache->entries);
+  free(cache->buckets);
+  free(cache);
+}
+
+/****************************************************************************
+ * Name: passwd_release
+ *
+ * Description:
+ *   Drop one reference to a cached copy, freeing it with the last one.  The
+ *   caller must hold g_cache_sem.
+ *
+ ****************************************************************************/
+
+static void passwd_release(FAR struct passwd_cache_s *cache)
+{
+  DEBUGASSERT(cache->crefs > 0);
+
+  if (--cache->crefs == 0)
+    {
+      passwd_free(cache);
+    }
+}
+
+/****************************************************************************
+ * Name: passwd_parse
+ *
+ * Description:
+ *   Parse one line of the file image, which has been NUL terminated in
+ *   place, into a cache entry.  The rules are those of the line-by-line
+ *   scan that passwd_find() does without the cache.
+ *
+ * Returned Value:
+ *   true if the line holds a user name; false if it is to be ignored.
+ *
+ ****************************************************************************/
+
+static bool passwd_parse(FAR char *line, bool newline,
+                         FAR struct passwd_entry_s *entry)
+{
+  FAR char *src;
+  FAR char *dest;
+  int enclen;
+
+  /* Skip over any leading whitespace */
+
+  for (src = line; *src && isspace((int)*src); src++);
+  if (*src == '\0')
+    {
+      /* Bad file format? */
+
+      return false;
+    }
+
+  entry->username = src;
+
+  /* Skip to the end of the name and properly terminate it.  A name that
+   * is followed only by the newline has no password.
+   */
+
+  for (; *src && !isspace((int)*src); src++);
+  if (*src == '\0')
+    {
+      if (!newline)
+        {
+          /* Bad file format? */
+
+          return false;
+        }
+
+      entry->status = -EINVAL;
+      return true;
+    }
+
+  *src++ = '\0';
+
+  /* Skip over any whitespace after the user name */
+
+  for (; *src && isspace((int)*src); src++);
+  if (*src == '\0')
+    {
+      /* Bad file format? */
+
+      entry->status = -EINVAL;
+      return true;
+    }
+
+  /* Copy the password */
+
+  dest   = entry->encrypted;
+  enclen = 0;
+
+  while (*src && !isspace((int)*src) && enclen < MAX_ENCRYPTED)
+    {
+      *dest++ = *src++;
+      enclen++;
+    }
+
+  *dest = '\0';
+  entry->status = (enclen >= MAX_ENCRYPTED) ? -E2BIG : OK;
+  return true;
+}
+
+/****************************************************************************
+ * Name: passwd_reload
+ *
+ * Description:
+ *   Read the whole /etc/passwd file into memory and build the hashed index
+ *   of its records.  Only the first record for a user name is indexed, as
+ *   that is the one a scan of the file finds.  The new copy replaces the
+ *   current one in g_cache.  The caller must hold g_cache_sem.
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+static int passwd_reload(void)
+{
+  FAR struct passwd_cache_s *cache;
+  FAR struct passwd_entry_s *entry;
+  FAR char *line;
+  FAR char *end;
+  FAR char *next;
+  struct stat buf;
+  ssize_t nread;
+  size_t nlines;
+  size_t nbuckets;
+  size_t ndx;
+  bool newline;
+  int nentries;
+  int fd;
+  int ret;
+
+  cache = (FAR struct passwd_cache_s *)
+    zalloc(sizeof(struct passwd_cache_s));
+  if (cache == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  fd = open(CONFIG_FSUTILS_PASSWD_PATH, O_RDONLY);
+  if (fd < 0)
+    {
+      ret = -errno;
+      DEBUGASSERT(ret < 0);
+      goto errout_with_cache;
+    }
+
+  ret = fstat(fd, &buf);
+  if (ret < 0)
+    {
+      ret = -errno;
+      DEBUGASSERT(ret < 0);
+      goto errout_with_fd;
+    }
+
+  /* Read the file image */
+
+  cache->image = (FAR char *)malloc(buf.st_size + 1);
+  if (cache->image == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout_with_fd;
+    }
+
+  for (ndx = 0; ndx < (size_t)buf.st_size; ndx += nread)
+    {
+      nread = read(fd, &cache->image[ndx], buf.st_size - ndx);
+      if (nread < 0)
+        {
+          ret = -errno;
+          DEBUGASSERT(ret < 0);
+
+          if (ret == -EINTR)
+            {
+              nread = 0;
+              continue;
+            }
+
+          goto errout_with_fd;
+        }
+      else if (nread == 0)
+        {
+          /* Shorter than fstat() said */
+
+          break;
+        }
+    }
+
+  cache->image[ndx] = '\0';
+  end = &cache->image[ndx];
+
+  /* Size the entry table and the hash buckets from the number of lines */
+
+  for (nlines = 1, line = cache->image;
+       (line = strchr(line, '\n')) != NULL;
+       line++, nlines++);
+
+  for (nbuckets = 1; nbuckets < nlines; nbuckets <<= 1);
+
+  cache->entries = (FAR struct passwd_entry_s *)
+    malloc(nlines * sizeof(struct passwd_entry_s));
+  cache->buckets = (FAR int *)malloc(nbuckets * sizeof(int));
+
+  if (cache->entries == NULL || cache->buckets == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout_with_fd;
+    }
+
+  memset(cache->buckets, 0xff, nbuckets * sizeof(int));
+  cache->mask = nbuckets - 1;
+
+  /* Index each line */
+
+  for (nentries = 0, line = cache->image; line < end; line = next)
+    {
+      next = strchr(line, '\n');
+      if (next != NULL)
+        {
+          *next++ = '\0';
+          newline = true;
+        }
+      else
+        {
+          next    = end;
+          newline = false;
+        }
+
+      entry = &cache->entries[nentries];
+      if (passwd_parse(line, newline, entry))
+        {
+          entry->hash   = passwd_hash(entry->username);
+          entry->offset = line - cache->image;
+
+          if (passwd_lookup(cache, entry->username, entry->hash) == NULL)
+            {
+              entry->next = cache->buckets[entry->hash & cache->mask];
+              cache->buckets[entry->hash & cache->mask] = nentries;
+              nentries++;
+            }
+        }
+    }
+
+  cache->mtime = buf.st_mtime;
+  cache->size  = buf.st_size;
+  cache->crefs = 1;
+  close(fd);
+
+  /* Publish the new copy.  The old one is freed once no lookup uses it. */
+
+  if (g_cache != NULL)
+    {
+      passwd_release(g_cache);
+    }
+
+  g_cache = cache;
+  return OK;
+
+errout_with_fd:
+  close(fd);
+
+errout_with_cache:
+  passwd_free(cache);
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: passwd_find
+ *
+ * Description:
+ *   Find the record for username in the /etc/passwd file.  The file is
+ *   read into memory and indexed on first use and again whenever its
+ *   modification time or size changes, or after it has been rewritten
+ *   through passwd_rewrite().
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+int passwd_find(FAR const char *username, FAR struct passwd_s *passwd)
+{
+  FAR struct passwd_cache_s *cache;
+  FAR struct passwd_entry_s *entry;
+  struct stat buf;
+  int ret;
+
+  /* Check for changes made by others, e.g. by another process in the
+   * kernel build or by a new file system image.
+   */
+
+  ret = stat(CONFIG_FSUTILS_PASSWD_PATH, &buf);
+  if (ret < 0)
+    {
+      ret = -errno;
+      DEBUGASSERT(ret < 0);
+
+      /* It may only have been left as the backup by an interrupted
+       * passwd_rewrite().
+       */
+
+      if (ret != -ENOENT || passwd_recover() < 0)
+        {
+          return ret;
+        }
+
+      ret = stat(CONFIG_FSUTILS_PASSWD_PATH, &buf);
+      if (ret < 0)
+        {
+          ret = -errno;
+          DEBUGASSERT(ret < 0);
+          return ret;
+        }
+    }
+
+  /* Take a reference to an up-to-date copy */
+
+  passwd_cache_lock();
+
+  cache = g_cache;
+  if (cache == NULL || cache->mtime != buf.st_mtime ||
+      cache->size != buf.st_size)
+    {
+      ret = passwd_reload();
+      if (ret < 0)
+        {
+          passwd_cache_unlock();
+          return ret;
+        }
+
+      cache = g_cache;
+    }
+
+  cache->crefs++;
+  passwd_cache_unlock();
+
+  /* Search it without the lock */
+
+  entry = passwd_lookup(cache, username, passwd_hash(username));
+  if (entry == NULL)
+    {
+      ret = -ENOENT;
+    }
+  else if (entry->status < 0)
+    {
+      ret = entry->status;
+    }
+  else
+    {
+      passwd->offset = entry->offset;
+      strcpy(passwd->encrypted, entry->encrypted);
+      ret = OK;
+    }
+
+  passwd_cache_lock();
+  passwd_release(cache);
+  passwd_cache_unlock();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: passwd_cache_invalidate
+ *
+ * Description:
+ *   Discard the cached copy of the /etc/passwd file so that the next
+ *   passwd_find() reloads it.  The copy is freed once no lookup is using
+ *   it.
+ *
+ ****************************************************************************/
+
+void passwd_cache_invalidate(void)
+{
+  passwd_cache_lock();
+
+  if (g_cache != NULL)
+    {
+      passwd_release(g_cache);
+      g_cache = NULL;
+    }
+
+  passwd_cache_unlock();
+}
@@ -66,12 +66,12 @@
 int passwd_deluser(FAR const char *username)
 {
   struct passwd_s passwd;
-  PASSWD_SEM_DECL(sem);
+  PASSWD_LOCK_DECL(lock);
   int ret;
 
   /* Get exclusive access to the /etc/passwd file */
 
-  ret = passwd_lock(&sem);
+  ret = passwd_lock(&lock);
   if (ret < 0)
     {
       return ret;
@@ -92,6 +92,6 @@ int passwd_deluser(FAR const char *username)
   ret = passwd_delete(passwd.offset);
 
 errout_with_lock:
-  (void)passwd_unlock(sem);
+  (void)passwd_unlock(lock);
   return ret;
 }
@@ -54,7 +54,8 @@
  * Name: passwd_find
  *
  * Description:
- *   Find a password in the
+ *   Find the record for username in the /etc/passwd file by scanning the
+ *   file line by line.
  *
  * Input Parameters:
  *
@@ -72,6 +73,7 @@ int passwd_find(FAR const char *username, FAR struct passwd_s *passwd)
   FAR char *dest;
   FILE *stream;
   off_t offset;
+  off_t next;
   int enclen;
   int ret;
 
@@ -90,18 +92,40 @@ int passwd_find(FAR const char *username, FAR struct passwd_s *passwd)
     {
       int errcode = errno;
       DEBUGASSERT(errcode > 0);
-      return -errcode;
+
+      /* It may only have been left as the backup by an interrupted
+       * passwd_rewrite().
+       */
+
+      if (errcode == ENOENT && passwd_recover() == OK)
+        {
+          stream = fopen(CONFIG_FSUTILS_PASSWD_PATH, "r");
+          errcode = errno;
+        }
+
+      if (stream == NULL)
+        {
+          free(iobuffer);
+          return -errcode;
+        }
     }
 
   /* Read the password file line by line until the record with the matching
    * username is found, or until the end of the file is reached.
    */
 
-  offset = 0;
-  ret    = -ENOENT;
+  next = 0;
+  ret  = -ENOENT;
 
   while (fgets(iobuffer, CONFIG_FSUTILS_PASSWD_IOBUFFER_SIZE, stream) != NULL)
     {
+      /* Remember where this line starts and the next one begins.  This
+       * must be done before any blank or malformed line is skipped.
+       */
+
+      offset = next;
+      next   = ftell(stream);
+
       /* Skip over any leading whitespace */
 
       for (src = iobuffer; *src && isspace((int)*src); src++);
@@ -163,10 +187,6 @@ int passwd_find(FAR const char *username, FAR struct passwd_s *passwd)
           ret = OK;
           break;
         }
-
-      /* Get the next file offset */
-
-      offset = ftell(stream);
     }
 
   fclose(stream);
@@ -38,6 +38,7 @@
  ****************************************************************************/
 
 #include <semaphore.h>
+#include <pthread.h>
 #include <assert.h>
 #include <errno.h>
 
@@ -59,36 +60,34 @@
  * Private Data
  ****************************************************************************/
 
-#ifndef CONFIG_BUILD_LOADABLE
+#if defined(PASSWD_HAVE_RWLOCK)
 /* In the FLAT and PROTECTED build modes, we do not need to bother with a
- * named semaphore.  We use a single global semaphore in theses cases.
+ * named semaphore.  A single global read/write lock lets any number of
+ * readers proceed together while writers get exclusive access.
  */
 
-static sem_t g_passwd_sem =  SEM_INITIALIZER(1);
+static pthread_rwlock_t g_passwd_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+#elif !defined(CONFIG_BUILD_LOADABLE)
+/* Without pthreads we fall back to a single global semaphore. */
+
+static sem_t g_passwd_sem = SEM_INITIALIZER(1);
 #endif
 
 /****************************************************************************
- * Public Functions
+ * Private Functions
  ****************************************************************************/
+
 /****************************************************************************
- * Name: passwd_lock and passwd_unlock
+ * Name: passwd_semlock
  *
  * Description:
- *   Lock the /etc/passwd file.  This is not a real lock at the level of the
- *   file system.  Rather, it only prevents concurrent modification of the
- *   /etc/passwd file by passwd_adduser(), passwd_deluser(), and
- *   passwd_update().  Other accesses to /etc/passwd could still cause
- *   concurrency problem and file corruption.
- *
- * Input Parameters:
- *
- * Returned Value:
- *   Zero (OK) is returned on success; a negated errno value is returned on
- *   failure.
+ *   Get exclusive access using the global (or named) semaphore.
  *
  ****************************************************************************/
 
-int passwd_lock(FAR sem_t **semp)
+#ifndef PASSWD_HAVE_RWLOCK
+static int passwd_semlock(FAR sem_t **semp)
 {
   FAR sem_t *sem;
 
@@ -120,17 +119,86 @@ int passwd_lock(FAR sem_t **semp)
   *semp = sem;
   return OK;
 }
+#endif
 
-int passwd_unlock(FAR sem_t *sem)
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: passwd_lock, passwd_rdlock and passwd_unlock
+ *
+ * Description:
+ *   Lock the /etc/passwd file.  This is not a real lock at the level of the
+ *   file system.  Rather, it only prevents concurrent modification of the
+ *   /etc/passwd file by passwd_adduser(), passwd_deluser(), and
+ *   passwd_update().  Other accesses to /etc/passwd could still cause
+ *   concurrency problem and file corruption.
+ *
+ *   passwd_lock() takes the lock for modification; passwd_rdlock() takes
+ *   it for reading so that concurrent passwd_verify() calls do not block
+ *   one another.  Either is released with passwd_unlock().
+ *
+ * Input Parameters:
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+int passwd_lock(FAR passwd_lock_t **lockp)
+{
+#ifdef PASSWD_HAVE_RWLOCK
+  int ret;
+
+  ret = pthread_rwlock_wrlock(&g_passwd_lock);
+  if (ret != 0)
+    {
+      return -ret;
+    }
+
+  *lockp = &g_passwd_lock;
+  return OK;
+#else
+  return passwd_semlock(lockp);
+#endif
+}
+
+int passwd_rdlock(FAR passwd_lock_t **lockp)
 {
+#ifdef PASSWD_HAVE_RWLOCK
+  int ret;
+
+  ret = pthread_rwlock_rdlock(&g_passwd_lock);
+  if (ret != 0)
+    {
+      return -ret;
+    }
+
+  *lockp = &g_passwd_lock;
+  return OK;
+#else
+  /* Readers are serialized too */
+
+  return passwd_semlock(lockp);
+#endif
+}
+
+int passwd_unlock(FAR passwd_lock_t *lock)
+{
+#ifdef PASSWD_HAVE_RWLOCK
+  (void)pthread_rwlock_unlock(lock);
+#else
   /* Release our count on the semaphore */
 
-  sem_post(sem);
+  sem_post(lock);
 
 #ifdef CONFIG_BUILD_LOADABLE
   /* Close the named semaphore */
 
-  (void)sem_close(sem);
+  (void)sem_close(lock);
+#endif
 #endif
 
   return OK;
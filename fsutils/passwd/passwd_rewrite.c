@@ -1,5 +1,5 @@
 /****************************************************************************
- * apps/fsutils/passwd/passwd_delete.c
+ * apps/fsutils/passwd/passwd_rewrite.c
  *
  *   Copyright (C) 2016 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
@@ -41,7 +41,10 @@
 
 #include <sys/types.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include <assert.h>
 #include <errno.h>
 
@@ -193,17 +196,156 @@ static int passwd_copyfile(FAR char *iobuffer, FILE *instream,
   return OK;
 }
 
+/****************************************************************************
+ * Name: passwd_skipline
+ *
+ * Description:
+ *  Read from the instream and discard the rest of the current line.
+ *
+ ****************************************************************************/
+
+static int passwd_skipline(FILE *instream)
+{
+  for (; ; )
+    {
+      int ch = fgetc(instream);
+      if (ch == EOF)
+        {
+          if (feof(instream))
+            {
+              /* Could this really happen without encountering the
+               * newline terminator?
+               */
+
+              return OK;
+            }
+          else
+            {
+              int errcode = errno;
+              DEBUGASSERT(errcode > 0);
+              return -errcode;
+            }
+        }
+      else if (ch == '\n')
+        {
+          return OK;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: passwd_replace
+ *
+ * Description:
+ *  Replace the /etc/passwd file with the new copy at /etc/passwd.tmp.
+ *
+ *  Where rename() replaces an existing file, that is all that is needed
+ *  and the file is never missing.  rename() onto an existing file fails
+ *  with EEXIST on FAT and tmpfs, however.  Then the old file is first
+ *  moved aside to /etc/passwd.bak and only removed once the new one is in
+ *  place.  If the system is reset between the two renames, only the
+ *  backup is left; passwd_recover() restores it on the next lookup.
+ *
+ ****************************************************************************/
+
+static int passwd_replace(void)
+{
+  int ret;
+
+  ret = rename(CONFIG_FSUTILS_PASSWD_PATH ".tmp", CONFIG_FSUTILS_PASSWD_PATH);
+  if (ret == 0)
+    {
+      return OK;
+    }
+
+  ret = -errno;
+  DEBUGASSERT(ret < 0);
+
+  if (ret != -EEXIST)
+    {
+      return ret;
+    }
+
+  /* The /etc/passwd file exists, so any backup is left over from an
+   * earlier failure and would make the next rename fail in the same way.
+   */
+
+  (void)unlink(CONFIG_FSUTILS_PASSWD_PATH ".bak");
+
+  ret = rename(CONFIG_FSUTILS_PASSWD_PATH, CONFIG_FSUTILS_PASSWD_PATH ".bak");
+  if (ret < 0)
+    {
+      ret = -errno;
+      DEBUGASSERT(ret < 0);
+      return ret;
+    }
+
+  ret = rename(CONFIG_FSUTILS_PASSWD_PATH ".tmp", CONFIG_FSUTILS_PASSWD_PATH);
+  if (ret < 0)
+    {
+      ret = -errno;
+      DEBUGASSERT(ret < 0);
+
+      /* Restore the previous /etc/passwd file */
+
+      (void)rename(CONFIG_FSUTILS_PASSWD_PATH ".bak",
+                   CONFIG_FSUTILS_PASSWD_PATH);
+      return ret;
+    }
+
+  /* Delete the previous /etc/passwd file */
+
+  (void)unlink(CONFIG_FSUTILS_PASSWD_PATH ".bak");
+  return OK;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
 /****************************************************************************
- * Name: passwd_delete
+ * Name: passwd_recover
+ *
+ * Description:
+ *   Restore /etc/passwd from the backup left by a passwd_rewrite() that
+ *   was interrupted after the old file had been moved aside.  Called when
+ *   /etc/passwd does not exist, with the passwd lock held.
+ *
+ * Returned Value:
+ *   Zero (OK) is returned if /etc/passwd was restored; a negated errno
+ *   value is returned otherwise (-ENOENT if there is no backup).
+ *
+ ****************************************************************************/
+
+int passwd_recover(void)
+{
+  int ret;
+
+  ret = rename(CONFIG_FSUTILS_PASSWD_PATH ".bak", CONFIG_FSUTILS_PASSWD_PATH);
+  if (ret < 0)
+    {
+      ret = -errno;
+      DEBUGASSERT(ret < 0);
+      return ret;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: passwd_rewrite
  *
  * Description:
- *  Delete on record from the password file at offset.
+ *   Write a new copy of the /etc/passwd file to a temporary file, dropping
+ *   the record at offset (if offset is not negative) and adding a record
+ *   for username at the end (if username is not NULL).  The new file then
+ *   replaces the old one, so that the old file is left intact if anything
+ *   fails.
  *
  * Input Parameters:
+ *   offset    - File offset of the record to remove, or -1
+ *   username  - Name for the new record, or NULL
+ *   encrypted - Encrypted password for the new record
  *
  * Returned Value:
  *   Zero (OK) is returned on success; a negated errno value is returned on
@@ -211,7 +353,8 @@ static int passwd_copyfile(FAR char *iobuffer, FILE *instream,
  *
  ****************************************************************************/
 
-int passwd_delete(off_t offset)
+int passwd_rewrite(off_t offset, FAR const char *username,
+                   FAR const char *encrypted)
 {
   FAR char *iobuffer;
   FILE *instream;
@@ -226,30 +369,37 @@ int passwd_delete(off_t offset)
       return -ENOMEM;
     }
 
-  /* Rename the /set/password file */
-
-  ret = rename(CONFIG_FSUTILS_PASSWD_PATH,
-               CONFIG_FSUTILS_PASSWD_PATH ".tmp");
-  if (ret < 0)
-    {
-      ret = -errno;
-      DEBUGASSERT(ret < 0);
-      goto errout_with_iobuffer;
-    }
-
-  /* Open the renamed file for reading; re-create the /etc/passwd file for
-   * writing.
+  /* Open the current /etc/passwd file for reading.  It need not exist yet
+   * if we are only adding a record.
    */
 
-  instream = fopen(CONFIG_FSUTILS_PASSWD_PATH ".tmp", "r");
+  instream = fopen(CONFIG_FSUTILS_PASSWD_PATH, "r");
   if (instream == NULL)
     {
       ret = -errno;
       DEBUGASSERT(ret < 0);
-      goto errout_with_tmpfile;
+
+      /* It may only have been left as the backup by an interrupted rewrite */
+
+      if (ret == -ENOENT && passwd_recover() == OK)
+        {
+          instream = fopen(CONFIG_FSUTILS_PASSWD_PATH, "r");
+          if (instream == NULL)
+            {
+              ret = -errno;
+              DEBUGASSERT(ret < 0);
+              goto errout_with_iobuffer;
+            }
+        }
+      else if (ret != -ENOENT || offset >= 0)
+        {
+          goto errout_with_iobuffer;
+        }
     }
 
-  outstream = fopen(CONFIG_FSUTILS_PASSWD_PATH, "w");
+  /* Create the new copy alongside it */
+
+  outstream = fopen(CONFIG_FSUTILS_PASSWD_PATH ".tmp", "w");
   if (outstream == NULL)
     {
       ret = -errno;
@@ -257,64 +407,102 @@ int passwd_delete(off_t offset)
       goto errout_with_instream;
     }
 
-  /* Copy 'offset' bytes from the renamed file to the original file */
-
-  ret = passwd_copyfile(iobuffer, instream, outstream, offset);
-  if (ret < 0)
+  ret = OK;
+  if (instream != NULL)
     {
-      goto errout_with_outstream;
-    }
-
-  /* Now read from the instream and discard the current line */
-
-  for (; ; )
-    {
-      int ch = fgetc(instream);
-      if (ch == EOF)
+      if (offset >= 0)
         {
-          if (feof(instream))
-            {
-              /* Could this really happen without encountering the
-               * newline terminator?
-               */
+          /* Copy 'offset' bytes from the old file to the new file, then
+           * discard the record at that offset.
+           */
 
-              break;
+          ret = passwd_copyfile(iobuffer, instream, outstream, offset);
+          if (ret < 0)
+            {
+              goto errout_with_outstream;
             }
-          else
+
+          ret = passwd_skipline(instream);
+          if (ret < 0)
             {
-              ret = -errno;
-              DEBUGASSERT(ret < 0);
-              goto errout_with_instream;
+              goto errout_with_outstream;
             }
         }
-      else if (ch == '\n')
+
+      /* Copy the rest of the file */
+
+      ret = passwd_copyfile(iobuffer, instream, outstream, SIZE_MAX);
+      if (ret < 0)
         {
-          break;
+          goto errout_with_outstream;
         }
     }
 
-  /* Copy the rest of the file */
+  /* Then add the new record at the end */
 
-  ret = passwd_copyfile(iobuffer, instream, outstream, SIZE_MAX);
+  if (username != NULL)
+    {
+      ret = fprintf(outstream, "%s %s\n", username, encrypted);
+      if (ret < 0)
+        {
+          ret = -errno;
+          DEBUGASSERT(ret < 0);
+          goto errout_with_outstream;
+        }
+    }
 
-errout_with_outstream:
-  (void)fclose(outstream);
+  /* Make sure that the new file is complete on the media before it
+   * replaces the old one.
+   */
 
-errout_with_instream:
-  (void)fclose(instream);
+  if (fflush(outstream) < 0 || fsync(fileno(outstream)) < 0)
+    {
+      ret = -errno;
+      DEBUGASSERT(ret < 0);
+      goto errout_with_outstream;
+    }
 
-errout_with_tmpfile:
+  ret = fclose(outstream);
+  outstream = NULL;
   if (ret < 0)
     {
-      /* Restore the previous /etc/passwd file */
+      ret = -errno;
+      DEBUGASSERT(ret < 0);
+      goto errout_with_instream;
+    }
 
-      (void)unlink(CONFIG_FSUTILS_PASSWD_PATH);
-      (void)rename(CONFIG_FSUTILS_PASSWD_PATH ".tmp",
-                   CONFIG_FSUTILS_PASSWD_PATH);
+  if (instream != NULL)
+    {
+      (void)fclose(instream);
+      instream = NULL;
+    }
+
+  /* Replace the /etc/passwd file with the new copy.  On file systems where
+   * this needs a backup, the file is briefly missing, but all readers in
+   * this library hold the passwd lock, which we hold exclusively.
+   */
+
+  ret = passwd_replace();
+
+  /* Any cached copy of the file is now stale */
+
+  passwd_cache_invalidate();
+
+errout_with_outstream:
+  if (outstream != NULL)
+    {
+      (void)fclose(outstream);
+    }
+
+errout_with_instream:
+  if (instream != NULL)
+    {
+      (void)fclose(instream);
     }
-  else
+
+  if (ret < 0)
     {
-      /* Delete the previous /etc/passwd file */
+      /* The /etc/passwd file is unchanged, just remove the new copy */
 
       (void)unlink(CONFIG_FSUTILS_PASSWD_PATH ".tmp");
     }
@@ -40,7 +40,7 @@
 #include <semaphore.h>
 
 #include "fsutils/passwd.h"
-#include <passwd.h>
+#include "passwd.h"
 
 /****************************************************************************
  * Public Functions
@@ -64,12 +64,13 @@
 int passwd_update(FAR const char *username, FAR const char *password)
 {
   struct passwd_s passwd;
-  PASSWD_SEM_DECL(sem);
+  char encrypted[MAX_ENCRYPTED + 1];
+  PASSWD_LOCK_DECL(lock);
   int ret;
 
   /* Get exclusive access to the /etc/passwd file */
 
-  ret = passwd_lock(&sem);
+  ret = passwd_lock(&lock);
   if (ret < 0)
     {
       return ret;
@@ -85,19 +86,21 @@ int passwd_update(FAR const char *username, FAR const char *password)
       goto errout_with_lock;
     }
 
-  /* Remove the line containing this user from the /etc/passwd file */
+  /* Encrypt the new password */
 
-  ret = passwd_delete(passwd.offset);
+  ret = passwd_encrypt(password, encrypted);
   if (ret < 0)
     {
       goto errout_with_lock;
     }
 
-  /* Then append the new password record to the end of the file */
+  /* Replace the old record with the new one in a single rewrite of the
+   * /etc/passwd file.  The new record goes at the end of the file.
+   */
 
-  ret = passwd_append(username, password);
+  ret = passwd_rewrite(passwd.offset, username, encrypted);
 
 errout_with_lock:
-  (void)passwd_unlock(sem);
+  (void)passwd_unlock(lock);
   return ret;
 }
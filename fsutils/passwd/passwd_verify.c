@@ -67,32 +67,34 @@ int passwd_verify(FAR const char *username, FAR const char *password)
 {
   struct passwd_s passwd;
   char encrypted[MAX_ENCRYPTED + 1];
-  PASSWD_SEM_DECL(sem);
+  PASSWD_LOCK_DECL(lock);
   int ret;
 
-  /* Get exclusive access to the /etc/passwd file */
+  /* Encrypt the provided password.  This does not need the lock. */
 
-  ret = passwd_lock(&sem);
+  ret = passwd_encrypt(password, encrypted);
   if (ret < 0)
     {
       return ret;
     }
 
-  /* Verify that the username exists in the /etc/passwd file */
+  /* Get shared access to the /etc/passwd file.  Any number of logins can
+   * be verified at the same time; only modifications are exclusive.
+   */
 
-  ret = passwd_find(username, &passwd);
+  ret = passwd_rdlock(&lock);
   if (ret < 0)
     {
-      /* The username does not exist in the /etc/passwd file */
-
-      goto errout_with_lock;
+      return ret;
     }
 
-  /* Encrypt the provided password */
+  /* Verify that the username exists in the /etc/passwd file */
 
-  ret = passwd_encrypt(password, encrypted);
+  ret = passwd_find(username, &passwd);
   if (ret < 0)
     {
+      /* The username does not exist in the /etc/passwd file */
+
       goto errout_with_lock;
     }
 
@@ -101,6 +103,6 @@ int passwd_verify(FAR const char *username, FAR const char *password)
   ret = (strcmp(passwd.encrypted, encrypted) == 0) ? 1 : 0;
 
 errout_with_lock:
-  (void)passwd_unlock(sem);
+  (void)passwd_unlock(lock);
   return ret;
 }
@@ -0,0 +1,885 @@
+/****************************************************************************
+ * apps/gpsutils/minmea/minmea_stream.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "gpsutils/minmea.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Framing states */
+
+#define STREAM_IDLE        0  /* Waiting for '$' */
+#define STREAM_BODY        1  /* Collecting fields */
+#define STREAM_CKSUM_HI    2  /* Waiting for first checksum digit */
+#define STREAM_CKSUM_LO    3  /* Waiting for second checksum digit */
+
+/* Field types.  These follow the minmea_scan() format characters. */
+
+#define FIELD_CHAR         0  /* 'c': char, '\0' if empty */
+#define FIELD_DIRECTION    1  /* 'd': sign applied to the preceding float */
+#define FIELD_FLOAT        2  /* 'f': struct minmea_float */
+#define FIELD_INT          3  /* 'i': int, 0 if empty */
+#define FIELD_DATE         4  /* 'D': struct minmea_date */
+#define FIELD_TIME         5  /* 'T': struct minmea_time */
+#define FIELD_VALID        6  /* bool, true if 'A' */
+#define FIELD_SKIP         7  /* '_': ignored */
+
+#define FIELD(t,s,m)       { FIELD_##t, offsetof(struct s, m) }
+#define IGNORE             { FIELD_SKIP, 0 }
+
+#define DECODER(n,i,r,f)   { n, i, r, sizeof(f) / sizeof(f[0]), f }
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One field of a sentence: how to decode it and where to store it in
+ * union minmea_sentence_u.  For FIELD_DIRECTION the offset is that of the
+ * minmea_float the direction applies to.
+ */
+
+struct minmea_field_s
+{
+  uint8_t type;
+  uint8_t offset;
+};
+
+/* Everything needed to decode one sentence type */
+
+struct minmea_decoder_s
+{
+  char type[4];                         /* Sentence type without talker */
+  int8_t id;                            /* enum minmea_sentence_id */
+  uint8_t nrequired;                    /* Fields that must be present */
+  uint8_t nfields;                      /* Entries in fields[] */
+  FAR const struct minmea_field_s *fields;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* $GPRMC,081836,A,3751.65,S,14507.36,E,000.0,360.0,130998,011.3,E*62 */
+
+static const struct minmea_field_s g_rmc_fields[] =
+{
+  FIELD(TIME,      minmea_sentence_rmc, time),
+  FIELD(VALID,     minmea_sentence_rmc, valid),
+  FIELD(FLOAT,     minmea_sentence_rmc, latitude),
+  FIELD(DIRECTION, minmea_sentence_rmc, latitude),
+  FIELD(FLOAT,     minmea_sentence_rmc, longitude),
+  FIELD(DIRECTION, minmea_sentence_rmc, longitude),
+  FIELD(FLOAT,     minmea_sentence_rmc, speed),
+  FIELD(FLOAT,     minmea_sentence_rmc, course),
+  FIELD(DATE,      minmea_sentence_rmc, date),
+  FIELD(FLOAT,     minmea_sentence_rmc, variation),
+  FIELD(DIRECTION, minmea_sentence_rmc, variation)
+};
+
+/* $GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47 */
+
+static const struct minmea_field_s g_gga_fields[] =
+{
+  FIELD(TIME,      minmea_sentence_gga, time),
+  FIELD(FLOAT,     minmea_sentence_gga, latitude),
+  FIELD(DIRECTION, minmea_sentence_gga, latitude),
+  FIELD(FLOAT,     minmea_sentence_gga, longitude),
+  FIELD(DIRECTION, minmea_sentence_gga, longitude),
+  FIELD(INT,       minmea_sentence_gga, fix_quality),
+  FIELD(INT,       minmea_sentence_gga, satellites_tracked),
+  FIELD(FLOAT,     minmea_sentence_gga, hdop),
+  FIELD(FLOAT,     minmea_sentence_gga, altitude),
+  FIELD(CHAR,      minmea_sentence_gga, altitude_units),
+  FIELD(FLOAT,     minmea_sentence_gga, height),
+  FIELD(CHAR,      minmea_sentence_gga, height_units),
+  FIELD(INT,       minmea_sentence_gga, dgps_age),
+  IGNORE
+};
+
+/* $GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39 */
+
+static const struct minmea_field_s g_gsa_fields[] =
+{
+  FIELD(CHAR,      minmea_sentence_gsa, mode),
+  FIELD(INT,       minmea_sentence_gsa, fix_type),
+  FIELD(INT,       minmea_sentence_gsa, sats[0]),
+  FIELD(INT,       minmea_sentence_gsa, sats[1]),
+  FIELD(INT,       minmea_sentence_gsa, sats[2]),
+  FIELD(INT,       minmea_sentence_gsa, sats[3]),
+  FIELD(INT,       minmea_sentence_gsa, sats[4]),
+  FIELD(INT,       minmea_sentence_gsa, sats[5]),
+  FIELD(INT,       minmea_sentence_gsa, sats[6]),
+  FIELD(INT,       minmea_sentence_gsa, sats[7]),
+  FIELD(INT,       minmea_sentence_gsa, sats[8]),
+  FIELD(INT,       minmea_sentence_gsa, sats[9]),
+  FIELD(INT,       minmea_sentence_gsa, sats[10]),
+  FIELD(INT,       minmea_sentence_gsa, sats[11]),
+  FIELD(FLOAT,     minmea_sentence_gsa, pdop),
+  FIELD(FLOAT,     minmea_sentence_gsa, hdop),
+  FIELD(FLOAT,     minmea_sentence_gsa, vdop)
+};
+
+/* $GPGLL,3723.2475,N,12158.3416,W,161229.487,A,A*41 */
+
+static const struct minmea_field_s g_gll_fields[] =
+{
+  FIELD(FLOAT,     minmea_sentence_gll, latitude),
+  FIELD(DIRECTION, minmea_sentence_gll, latitude),
+  FIELD(FLOAT,     minmea_sentence_gll, longitude),
+  FIELD(DIRECTION, minmea_sentence_gll, longitude),
+  FIELD(TIME,      minmea_sentence_gll, time),
+  FIELD(CHAR,      minmea_sentence_gll, status),
+  FIELD(CHAR,      minmea_sentence_gll, mode)
+};
+
+/* $GPGST,024603.00,3.2,6.6,4.7,47.3,5.8,5.6,22.0*58 */
+
+static const struct minmea_field_s g_gst_fields[] =
+{
+  FIELD(TIME,      minmea_sentence_gst, time),
+  FIELD(FLOAT,     minmea_sentence_gst, rms_deviation),
+  FIELD(FLOAT,     minmea_sentence_gst, semi_major_deviation),
+  FIELD(FLOAT,     minmea_sentence_gst, semi_minor_deviation),
+  FIELD(FLOAT,     minmea_sentence_gst, semi_major_orientation),
+  FIELD(FLOAT,     minmea_sentence_gst, latitude_error_deviation),
+  FIELD(FLOAT,     minmea_sentence_gst, longitude_error_deviation),
+  FIELD(FLOAT,     minmea_sentence_gst, altitude_error_deviation)
+};
+
+/* $GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74 */
+
+static const struct minmea_field_s g_gsv_fields[] =
+{
+  FIELD(INT,       minmea_sentence_gsv, total_msgs),
+  FIELD(INT,       minmea_sentence_gsv, msg_nr),
+  FIELD(INT,       minmea_sentence_gsv, total_sats),
+  FIELD(INT,       minmea_sentence_gsv, sats[0].nr),
+  FIELD(INT,       minmea_sentence_gsv, sats[0].elevation),
+  FIELD(INT,       minmea_sentence_gsv, sats[0].azimuth),
+  FIELD(INT,       minmea_sentence_gsv, sats[0].snr),
+  FIELD(INT,       minmea_sentence_gsv, sats[1].nr),
+  FIELD(INT,       minmea_sentence_gsv, sats[1].elevation),
+  FIELD(INT,       minmea_sentence_gsv, sats[1].azimuth),
+  FIELD(INT,       minmea_sentence_gsv, sats[1].snr),
+  FIELD(INT,       minmea_sentence_gsv, sats[2].nr),
+  FIELD(INT,       minmea_sentence_gsv, sats[2].elevation),
+  FIELD(INT,       minmea_sentence_gsv, sats[2].azimuth),
+  FIELD(INT,       minmea_sentence_gsv, sats[2].snr),
+  FIELD(INT,       minmea_sentence_gsv, sats[3].nr),
+  FIELD(INT,       minmea_sentence_gsv, sats[3].elevation),
+  FIELD(INT,       minmea_sentence_gsv, sats[3].azimuth),
+  FIELD(INT,       minmea_sentence_gsv, sats[3].snr)
+};
+
+/* The decoders, most frequent sentences first.  A multi-constellation
+ * receiver sends several GSV and GSA sentences per fix.
+ */
+
+static const struct minmea_decoder_s g_decoders[] =
+{
+  DECODER("GSV", MINMEA_SENTENCE_GSV,  3, g_gsv_fields),
+  DECODER("GSA", MINMEA_SENTENCE_GSA, 17, g_gsa_fields),
+  DECODER("RMC", MINMEA_SENTENCE_RMC, 11, g_rmc_fields),
+  DECODER("GGA", MINMEA_SENTENCE_GGA, 14, g_gga_fields),
+  DECODER("GLL", MINMEA_SENTENCE_GLL,  6, g_gll_fields),
+  DECODER("GST", MINMEA_SENTENCE_GST,  8, g_gst_fields)
+};
+
+#define NDECODERS ((int)(sizeof(g_decoders) / sizeof(g_decoders[0])))
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int stream_hex2int(char c)
+{
+  if (c >= '0' && c <= '9')
+    {
+      return c - '0';
+    }
+
+  if (c >= 'A' && c <= 'F')
+    {
+      return c - 'A' + 10;
+    }
+
+  if (c >= 'a' && c <= 'f')
+    {
+      return c - 'a' + 10;
+    }
+
+  return -1;
+}
+
+static inline bool stream_isdigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+/* Two or more digits at the start of a field, already checked */
+
+static inline int stream_2digits(FAR const char *field)
+{
+  return (field[0] - '0') * 10 + (field[1] - '0');
+}
+
+/****************************************************************************
+ * Name: stream_float
+ *
+ * Description:
+ *   Decode a fractional field.  The rules are those of the 'f' format of
+ *   minmea_scan().
+ *
+ ****************************************************************************/
+
+static bool stream_float(FAR const char *field, size_t len,
+                         FAR struct minmea_float *f)
+{
+  int sign = 0;
+  int_least32_t value = -1;
+  int_least32_t scale = 0;
+
+  for (; len > 0; field++, len--)
+    {
+      char c = *field;
+
+      if (stream_isdigit(c))
+        {
+          int digit = c - '0';
+
+          if (value == -1)
+            {
+              value = 0;
+            }
+
+          if (value > (INT_LEAST32_MAX - digit) / 10)
+            {
+              /* Truncate extra precision, but fail on integer overflow */
+
+              if (scale)
+                {
+                  break;
+                }
+
+              return false;
+            }
+
+          value = (10 * value) + digit;
+          if (scale)
+            {
+              scale *= 10;
+            }
+        }
+      else if (c == '.' && scale == 0)
+        {
+          scale = 1;
+        }
+      else if ((c == '+' || c == '-') && !sign && value == -1)
+        {
+          sign = (c == '+') ? 1 : -1;
+        }
+      else if (c != ' ' || sign != 0 || value != -1 || scale != 0)
+        {
+          /* Only leading spaces are tolerated */
+
+          return false;
+        }
+    }
+
+  if ((sign || scale) && value == -1)
+    {
+      return false;
+    }
+
+  if (value == -1)
+    {
+      /* No digits were scanned */
+
+      value = 0;
+      scale = 0;
+    }
+  else if (scale == 0)
+    {
+      /* No decimal point */
+
+      scale = 1;
+    }
+
+  if (sign)
+    {
+      value *= sign;
+    }
+
+  f->value = value;
+  f->scale = scale;
+  return true;
+}
+
+/****************************************************************************
+ * Name: stream_int
+ *
+ * Description:
+ *   Decode a decimal field with optional leading spaces and sign.  An empty
+ *   field is zero.
+ *
+ ****************************************************************************/
+
+static bool stream_int(FAR const char *field, size_t len, FAR int *result)
+{
+  FAR const char *end = field + len;
+  bool negative = false;
+  int value = 0;
+
+  if (len == 0)
+    {
+      *result = 0;
+      return true;
+    }
+
+  while (field < end && *field == ' ')
+    {
+      field++;
+    }
+
+  if (field < end && (*field == '+' || *field == '-'))
+    {
+      negative = (*field++ == '-');
+    }
+
+  if (field == end)
+    {
+      return false;
+    }
+
+  for (; field < end; field++)
+    {
+      if (!stream_isdigit(*field))
+        {
+          return false;
+        }
+
+      value = value * 10 + (*field - '0');
+    }
+
+  *result = negative ? -value : value;
+  return true;
+}
+
+/****************************************************************************
+ * Name: stream_time
+ *
+ * Description:
+ *   Decode hhmmss[.ssssss].  All members are -1 if the field is empty.
+ *
+ ****************************************************************************/
+
+static bool stream_time(FAR const char *field, size_t len,
+                        FAR struct minmea_time *time_)
+{
+  size_t i;
+  int value;
+  int scale;
+
+  if (len == 0)
+    {
+      time_->hours        = -1;
+      time_->minutes      = -1;
+      time_->seconds      = -1;
+      time_->microseconds = -1;
+      return true;
+    }
+
+  if (len < 6)
+    {
+      return false;
+    }
+
+  for (i = 0; i < 6; i++)
+    {
+      if (!stream_isdigit(field[i]))
+        {
+          return false;
+        }
+    }
+
+  time_->hours   = stream_2digits(&field[0]);
+  time_->minutes = stream_2digits(&field[2]);
+  time_->seconds = stream_2digits(&field[4]);
+
+  /* Fractional seconds are saved as microseconds */
+
+  value = 0;
+  scale = 1000000;
+
+  if (len > 6 && field[6] == '.')
+    {
+      for (i = 7; i < len && stream_isdigit(field[i]) && scale > 1; i++)
+        {
+          value = (value * 10) + (field[i] - '0');
+          scale /= 10;
+        }
+    }
+  else
+    {
+      scale = 0;
+    }
+
+  time_->microseconds = value * scale;
+  return true;
+}
+
+/****************************************************************************
+ * Name: stream_date
+ *
+ * Description:
+ *   Decode ddmmyy.  All members are -1 if the field is empty.
+ *
+ ****************************************************************************/
+
+static bool stream_date(FAR const char *field, size_t len,
+                        FAR struct minmea_date *date)
+{
+  size_t i;
+
+  if (len == 0)
+    {
+      date->day   = -1;
+      date->month = -1;
+      date->year  = -1;
+      return true;
+    }
+
+  if (len < 6)
+    {
+      return false;
+    }
+
+  for (i = 0; i < 6; i++)
+    {
+      if (!stream_isdigit(field[i]))
+        {
+          return false;
+        }
+    }
+
+  date->day   = stream_2digits(&field[0]);
+  date->month = stream_2digits(&field[2]);
+  date->year  = stream_2digits(&field[4]);
+  return true;
+}
+
+/****************************************************************************
+ * Name: stream_decode
+ *
+ * Description:
+ *   Decode the fields of a complete sentence into stream->frame using the
+ *   field table of its sentence type.
+ *
+ ****************************************************************************/
+
+static bool stream_decode(FAR struct minmea_stream_s *stream,
+                          FAR const struct minmea_decoder_s *decoder)
+{
+  FAR uint8_t *frame = (FAR uint8_t *)&stream->frame;
+  FAR const struct minmea_field_s *desc;
+  FAR const char *field;
+  size_t len;
+  int dir;
+  int i;
+
+  /* Missing mandatory fields */
+
+  if (stream->nfields <= decoder->nrequired)
+    {
+      return false;
+    }
+
+  for (i = 0; i < decoder->nfields; i++)
+    {
+      desc = &decoder->fields[i];
+
+      /* Missing optional fields decode like empty ones */
+
+      if (i + 1 < stream->nfields)
+        {
+          field = &stream->buffer[stream->field[i + 1]];
+          len   = stream->field[i + 2] - stream->field[i + 1] - 1;
+        }
+      else
+        {
+          field = NULL;
+          len   = 0;
+        }
+
+      switch (desc->type)
+        {
+          case FIELD_CHAR:
+            *(FAR char *)&frame[desc->offset] = len > 0 ? field[0] : '\0';
+            break;
+
+          case FIELD_VALID:
+            *(FAR bool *)&frame[desc->offset] = len > 0 && field[0] == 'A';
+            break;
+
+          case FIELD_DIRECTION:
+
+            /* An empty direction zeroes the value, as with minmea_scan() */
+
+            dir = 0;
+            if (len > 0)
+              {
+                if (field[0] == 'N' || field[0] == 'E')
+                  {
+                    dir = 1;
+                  }
+                else if (field[0] == 'S' || field[0] == 'W')
+                  {
+                    dir = -1;
+                  }
+                else
+                  {
+                    return false;
+                  }
+              }
+
+            ((FAR struct minmea_float *)&frame[desc->offset])->value *= dir;
+            break;
+
+          case FIELD_FLOAT:
+            if (!stream_float(field, len,
+                              (FAR struct minmea_float *)&frame[desc->offset]))
+              {
+                return false;
+              }
+            break;
+
+          case FIELD_INT:
+            if (!stream_int(field, len, (FAR int *)&frame[desc->offset]))
+              {
+                return false;
+              }
+            break;
+
+          case FIELD_DATE:
+            if (!stream_date(field, len,
+                             (FAR struct minmea_date *)&frame[desc->offset]))
+              {
+                return false;
+              }
+            break;
+
+          case FIELD_TIME:
+            if (!stream_time(field, len,
+                             (FAR struct minmea_time *)&frame[desc->offset]))
+              {
+                return false;
+              }
+            break;
+
+          default:
+            break;
+        }
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: stream_dispatch
+ *
+ * Description:
+ *   Handle a complete sentence with a good checksum: find its decoder,
+ *   decode it and hand it to the callback.
+ *
+ ****************************************************************************/
+
+static void stream_dispatch(FAR struct minmea_stream_s *stream)
+{
+  FAR const struct minmea_decoder_s *decoder = NULL;
+  FAR const char *type;
+  enum minmea_sentence_id id;
+  int i;
+
+  stream->buffer[stream->len] = '\0';
+
+  /* The identifier is two talker characters and three of sentence type */
+
+  if (stream->field[1] - stream->field[0] - 1 == 5)
+    {
+      type = &stream->buffer[stream->field[0] + 2];
+      for (i = 0; i < NDECODERS; i++)
+        {
+          if (type[0] == g_decoders[i].type[0] &&
+              type[1] == g_decoders[i].type[1] &&
+              type[2] == g_decoders[i].type[2])
+            {
+              decoder = &g_decoders[i];
+              break;
+            }
+        }
+    }
+
+  if (decoder == NULL)
+    {
+      stream->stats.unknown++;
+      id = MINMEA_UNKNOWN;
+    }
+  else if (!stream_decode(stream, decoder))
+    {
+      stream->stats.badfield++;
+      id = MINMEA_INVALID;
+    }
+  else
+    {
+      stream->stats.sentences++;
+      id = (enum minmea_sentence_id)decoder->id;
+    }
+
+  if (stream->callback != NULL)
+    {
+      stream->callback(stream->arg, id,
+                       id > MINMEA_UNKNOWN ? &stream->frame : NULL,
+                       stream->buffer);
+    }
+}
+
+/****************************************************************************
+ * Name: stream_start
+ *
+ * Description:
+ *   Begin a new sentence at '$'.
+ *
+ ****************************************************************************/
+
+static inline void stream_start(FAR struct minmea_stream_s *stream)
+{
+  stream->buffer[0] = '$';
+  stream->len       = 1;
+  stream->checksum  = 0;
+  stream->field[0]  = 1;
+  stream->nfields   = 1;
+  stream->state     = STREAM_BODY;
+}
+
+/****************************************************************************
+ * Name: stream_endfields
+ *
+ * Description:
+ *   Close the last field of the body.
+ *
+ ****************************************************************************/
+
+static inline void stream_endfields(FAR struct minmea_stream_s *stream)
+{
+  stream->field[stream->nfields] = stream->len + 1;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: minmea_stream_init
+ *
+ * Description:
+ *   Initialize a streaming parser.
+ *
+ ****************************************************************************/
+
+void minmea_stream_init(FAR struct minmea_stream_s *stream, bool strict,
+                        minmea_stream_cb_t callback, FAR void *arg)
+{
+  memset(stream, 0, sizeof(struct minmea_stream_s));
+  stream->state    = STREAM_IDLE;
+  stream->strict   = strict;
+  stream->callback = callback;
+  stream->arg      = arg;
+}
+
+/****************************************************************************
+ * Name: minmea_stream_feed
+ *
+ * Description:
+ *   Frame, checksum and split sentences in a single pass over the received
+ *   bytes, decoding each sentence as soon as its checksum is complete.
+ *
+ ****************************************************************************/
+
+void minmea_stream_feed(FAR struct minmea_stream_s *stream,
+                        FAR const char *data, size_t len)
+{
+  FAR const char *end = data + len;
+  int digit;
+  char c;
+
+  for (; data < end; data++)
+    {
+      c = *data;
+
+      switch (stream->state)
+        {
+          case STREAM_IDLE:
+
+            /* Skip line endings and noise up to the next sentence.  Sentences
+             * are separated by at least a CR LF, so scan ahead for the '$'.
+             */
+
+            if (c != '$')
+              {
+                FAR const char *next = memchr(data, '$', end - data);
+                if (next == NULL)
+                  {
+                    return;
+                  }
+
+                data = next;
+              }
+
+            stream_start(stream);
+            break;
+
+          case STREAM_BODY:
+            if (c == ',')
+              {
+                if (stream->nfields < MINMEA_MAX_FIELDS)
+                  {
+                    stream->field[stream->nfields++] = stream->len + 1;
+                  }
+              }
+            else if (c == '*')
+              {
+                stream_endfields(stream);
+                stream->buffer[stream->len++] = c;
+                stream->state = STREAM_CKSUM_HI;
+                break;
+              }
+            else if (c == '\r' || c == '\n')
+              {
+                /* End of a sentence without checksum */
+
+                if (stream->strict)
+                  {
+                    stream->stats.badchecksum++;
+                  }
+                else
+                  {
+                    stream_endfields(stream);
+                    stream_dispatch(stream);
+                  }
+
+                stream->state = STREAM_IDLE;
+                break;
+              }
+            else if (c == '$')
+              {
+                /* Start of a new sentence: the current one was truncated */
+
+                stream->stats.badframe++;
+                stream_start(stream);
+                break;
+              }
+            else if (c < 0x20 || c > 0x7e)
+              {
+                stream->stats.badframe++;
+                stream->state = STREAM_IDLE;
+                break;
+              }
+
+            if (stream->len >= MINMEA_MAX_LENGTH)
+              {
+                stream->stats.badframe++;
+                stream->state = STREAM_IDLE;
+                break;
+              }
+
+            stream->checksum ^= c;
+            stream->buffer[stream->len++] = c;
+            break;
+
+          case STREAM_CKSUM_HI:
+          case STREAM_CKSUM_LO:
+            digit = stream_hex2int(c);
+            if (digit < 0)
+              {
+                stream->stats.badframe++;
+                if (c == '$')
+                  {
+                    stream_start(stream);
+                  }
+                else
+                  {
+                    stream->state = STREAM_IDLE;
+                  }
+
+                break;
+              }
+
+            stream->buffer[stream->len++] = c;
+
+            if (stream->state == STREAM_CKSUM_HI)
+              {
+                stream->expected = digit << 4;
+                stream->state    = STREAM_CKSUM_LO;
+                break;
+              }
+
+            /* The sentence is complete once both checksum digits are in; the
+             * line ending is not waited for.
+             */
+
+            stream->state = STREAM_IDLE;
+            if ((stream->expected | digit) != stream->checksum)
+              {
+                stream->stats.badchecksum++;
+                break;
+              }
+
+            stream_dispatch(stream);
+            break;
+
+          default:
+            stream->state = STREAM_IDLE;
+            break;
+        }
+    }
+}
@@ -0,0 +1,123 @@
+/////////////////////////////////////////////////////////////////////////////
+// apps/graphics/NxWidgets/UnitTests/CGraphicsPort/cgraphicsport_main.cxx
+//
+//   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+//   Author: Gregory Nutt <gnutt@nuttx.org>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in
+//    the documentation and/or other materials provided with the
+//    distribution.
+// 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+//    me be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Included Files
+/////////////////////////////////////////////////////////////////////////////
+
+#include <nuttx/config.h>
+
+#include <nuttx/init.h>
+#include <cstdio>
+#include <unistd.h>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+
+#include "nxwidgets/cgraphicsporttest.hxx"
+
+/////////////////////////////////////////////////////////////////////////////
+// Definitions
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Classes
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Data
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Function Prototypes
+/////////////////////////////////////////////////////////////////////////////
+
+// Suppress name-mangling
+
+extern "C" int cgraphicsport_main(int argc, char *argv[]);
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Functions
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// cgraphicsport_main
+/////////////////////////////////////////////////////////////////////////////
+
+int cgraphicsport_main(int argc, char *argv[])
+{
+  // Create an instance of the test
+
+  printf("cgraphicsport_main: Create CGraphicsPortTest instance\n");
+  CGraphicsPortTest *test = new CGraphicsPortTest();
+
+  // Connect the NX server
+
+  printf("cgraphicsport_main: Connect the CGraphicsPortTest instance to the NX server\n");
+  if (!test->connect())
+    {
+      printf("cgraphicsport_main: Failed to connect the CGraphicsPortTest instance to the NX server\n");
+      delete test;
+      return 1;
+    }
+
+  // Create a window to draw into
+
+  printf("cgraphicsport_main: Create a Window\n");
+  if (!test->createWindow())
+    {
+      printf("cgraphicsport_main: Failed to create a window\n");
+      delete test;
+      return 1;
+    }
+
+  // Time text drawn on a solid background and on the existing contents of
+  // the window
+
+  uint32_t opaque      = test->drawText(false);
+  uint32_t transparent = test->drawText(true);
+
+  printf("cgraphicsport_main: Opaque text:      %lu chars/sec\n",
+         (unsigned long)opaque);
+  printf("cgraphicsport_main: Transparent text: %lu chars/sec\n",
+         (unsigned long)transparent);
+  sleep(2);
+
+  // Clean up and exit
+
+  printf("cgraphicsport_main: Clean-up and exit\n");
+  delete test;
+  return 0;
+}
@@ -0,0 +1,252 @@
+/////////////////////////////////////////////////////////////////////////////
+// apps/graphics/NxWidgets/UnitTests/CGraphicsPort/cgraphicsporttest.cxx
+//
+//   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+//   Author: Gregory Nutt <gnutt@nuttx.org>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in
+//    the documentation and/or other materials provided with the
+//    distribution.
+// 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+//    me be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Included Files
+/////////////////////////////////////////////////////////////////////////////
+
+#include <nuttx/config.h>
+
+#include <nuttx/init.h>
+#include <cstdio>
+#include <cerrno>
+#include <ctime>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+#include <nuttx/nx/nxfonts.h>
+
+#include "nxwidgets/nxconfig.hxx"
+#include "nxwidgets/cgraphicsporttest.hxx"
+#include "nxwidgets/cbgwindow.hxx"
+
+/////////////////////////////////////////////////////////////////////////////
+// Definitions
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Classes
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Data
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Data
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Function Prototypes
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// CGraphicsPortTest Method Implementations
+/////////////////////////////////////////////////////////////////////////////
+
+// CGraphicsPortTest Constructor
+
+CGraphicsPortTest::CGraphicsPortTest()
+{
+  m_widgetControl = (CWidgetControl *)NULL;
+  m_bgWindow      = (CBgWindow *)NULL;
+  m_nxFont        = (CNxFont *)NULL;
+}
+
+// CGraphicsPortTest Descriptor
+
+CGraphicsPortTest::~CGraphicsPortTest()
+{
+  disconnect();
+}
+
+// Connect to the NX server
+
+bool CGraphicsPortTest::connect(void)
+{
+  // Connect to the server
+
+  bool nxConnected = CNxServer::connect();
+  if (nxConnected)
+    {
+      // Create the default font instance
+
+      m_nxFont = new CNxFont(NXFONT_DEFAULT,
+                            CONFIG_NXWIDGETS_DEFAULT_FONTCOLOR,
+                            CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
+      if (!m_nxFont)
+        {
+          printf("CGraphicsPortTest::connect: Failed to create the default font\n");
+        }
+
+      // Set the background color
+
+      if (!setBackgroundColor(CONFIG_CGRAPHICSPORTTEST_BGCOLOR))
+        {
+          printf("CGraphicsPortTest::connect: setBackgroundColor failed\n");
+        }
+    }
+
+  return nxConnected;
+}
+
+// Disconnect from the NX server
+
+void CGraphicsPortTest::disconnect(void)
+{
+  // Close the window
+
+  if (m_bgWindow)
+    {
+      delete m_bgWindow;
+      m_bgWindow = (CBgWindow *)NULL;
+    }
+
+  // Free the default font
+
+  if (m_nxFont)
+    {
+      delete m_nxFont;
+      m_nxFont = (CNxFont *)NULL;
+    }
+
+  // And disconnect from the server
+
+  CNxServer::disconnect();
+}
+
+// Create the background window instance
+
+bool CGraphicsPortTest::createWindow(void)
+{
+  // Initialize the widget control using the default style
+
+  m_widgetControl = new CWidgetControl((CWidgetStyle *)NULL);
+
+  // Get an (uninitialized) instance of the background window as a class
+  // that derives from INxWindow.
+
+  m_bgWindow = getBgWindow(m_widgetControl);
+  if (!m_bgWindow)
+    {
+      printf("CGraphicsPortTest::createWindow: Failed to create CBgWindow instance\n");
+      delete m_widgetControl;
+      return false;
+    }
+
+  // Open (and initialize) the window
+
+  bool success = m_bgWindow->open();
+  if (!success)
+    {
+      printf("CGraphicsPortTest::createWindow: Failed to open background window\n");
+      delete m_bgWindow;
+      m_bgWindow = (CBgWindow*)0;
+      return false;
+    }
+
+  return true;
+}
+
+// Return the time in microseconds
+
+uint32_t CGraphicsPortTest::getTime(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)ts.tv_sec * 1000000 + (uint32_t)ts.tv_nsec / 1000;
+}
+
+// Fill the window with lines of text and return characters per second
+
+uint32_t CGraphicsPortTest::drawText(bool transparent)
+{
+  static const char text[] =
+    "0123456789 The quick brown fox jumps over the lazy dog.";
+
+  struct nxgl_size_s windowSize;
+  if (!m_bgWindow->getSize(&windowSize))
+    {
+      printf("CGraphicsPortTest::drawText: Failed to get window size\n");
+      return 0;
+    }
+
+  CGraphicsPort *port = m_widgetControl->getGraphicsPort();
+  CNxString string(text);
+  CRect bound(0, 0, windowSize.w, windowSize.h);
+
+  nxgl_coord_t lineHeight = m_nxFont->getHeight();
+  uint32_t nchars = 0;
+
+  uint32_t start = getTime();
+
+  for (int frame = 0; frame < CONFIG_CGRAPHICSPORTTEST_NFRAMES; frame++)
+    {
+      for (nxgl_coord_t y = 0; y + lineHeight <= windowSize.h; y += lineHeight)
+        {
+          // Start each line at a different character so that the lines
+          // differ, as they would in a log
+
+          int startIndex = (y / lineHeight + frame) % 10;
+          int length     = string.getLength() - startIndex;
+
+          struct nxgl_point_s pos;
+          pos.x = 0;
+          pos.y = y;
+
+          if (transparent)
+            {
+              port->drawText(&pos, &bound, m_nxFont, string, startIndex,
+                             length);
+            }
+          else
+            {
+              port->drawText(&pos, &bound, m_nxFont, string, startIndex,
+                             length, m_nxFont->getColor(),
+                             CONFIG_CGRAPHICSPORTTEST_BGCOLOR);
+            }
+
+          nchars += length;
+        }
+    }
+
+  uint32_t elapsed = getTime() - start;
+  if (elapsed == 0)
+    {
+      elapsed = 1;
+    }
+
+  return (uint32_t)(((uint64_t)nchars * 1000000) / elapsed);
+}
@@ -0,0 +1,130 @@
+/////////////////////////////////////////////////////////////////////////////
+// apps/graphics/NxWidgets/UnitTests/CGraphicsPort/cgraphicsporttest.hxx
+//
+//   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+//   Author: Gregory Nutt <gnutt@nuttx.org>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in
+//    the documentation and/or other materials provided with the
+//    distribution.
+// 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+//    me be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef __UNITTESTS_CGRAPHICSPORT_CGRAPHICSPORTTEST_HXX
+#define __UNITTESTS_CGRAPHICSPORT_CGRAPHICSPORTTEST_HXX
+
+/////////////////////////////////////////////////////////////////////////////
+// Included Files
+/////////////////////////////////////////////////////////////////////////////
+
+#include <nuttx/config.h>
+
+#include <nuttx/init.h>
+#include <cstdio>
+#include <semaphore.h>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+
+#include "nxwidgets/nxconfig.hxx"
+#include "nxwidgets/cwidgetcontrol.hxx"
+#include "nxwidgets/ccallback.hxx"
+#include "nxwidgets/cbgwindow.hxx"
+#include "nxwidgets/cnxserver.hxx"
+#include "nxwidgets/cnxfont.hxx"
+#include "nxwidgets/cnxstring.hxx"
+#include "nxwidgets/cgraphicsport.hxx"
+#include "nxwidgets/crect.hxx"
+
+/////////////////////////////////////////////////////////////////////////////
+// Definitions
+/////////////////////////////////////////////////////////////////////////////
+// Configuration ////////////////////////////////////////////////////////////
+
+#ifndef CONFIG_HAVE_CXX
+#  error "CONFIG_HAVE_CXX must be defined"
+#endif
+
+#ifndef CONFIG_CGRAPHICSPORTTEST_BGCOLOR
+#  define CONFIG_CGRAPHICSPORTTEST_BGCOLOR CONFIG_NXWIDGETS_DEFAULT_BACKGROUNDCOLOR
+#endif
+
+// The number of times that the window is filled with text for each method
+
+#ifndef CONFIG_CGRAPHICSPORTTEST_NFRAMES
+#  define CONFIG_CGRAPHICSPORTTEST_NFRAMES 20
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Classes
+/////////////////////////////////////////////////////////////////////////////
+
+using namespace NXWidgets;
+
+class CGraphicsPortTest : public CNxServer
+{
+private:
+  CWidgetControl    *m_widgetControl;  // The controlling widget for the window
+  CNxFont           *m_nxFont;         // Default font
+  CBgWindow         *m_bgWindow;       // Background window instance
+
+  // Return the time in microseconds
+
+  uint32_t getTime(void);
+
+public:
+  // Constructor/destructors
+
+  CGraphicsPortTest();
+  ~CGraphicsPortTest();
+
+  // Initializer/unitializer.  These methods encapsulate the basic steps for
+  // starting and stopping the NX server
+
+  bool connect(void);
+  void disconnect(void);
+
+  // Create a window.  This method provides the general operations for
+  // creating a window that you can draw within.
+
+  bool createWindow(void);
+
+  // Fill the window with lines of text, as a log or table view would,
+  // and return the number of characters drawn per second.
+
+  uint32_t drawText(bool transparent);
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Data
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Function Prototypes
+/////////////////////////////////////////////////////////////////////////////
+
+
+#endif // __UNITTESTS_CGRAPHICSPORT_CGRAPHICSPORTTEST_HXX
@@ -0,0 +1,130 @@
+/////////////////////////////////////////////////////////////////////////////
+// apps/graphics/NxWidgets/UnitTests/CMultiLineTextBox/cmultilinetextbox_main.cxx
+//
+//   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+//   Author: Gregory Nutt <gnutt@nuttx.org>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in
+//    the documentation and/or other materials provided with the
+//    distribution.
+// 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+//    me be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Included Files
+/////////////////////////////////////////////////////////////////////////////
+
+#include <nuttx/config.h>
+
+#include <nuttx/init.h>
+#include <cstdio>
+#include <unistd.h>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+
+#include "nxwidgets/cmultilinetextboxtest.hxx"
+
+/////////////////////////////////////////////////////////////////////////////
+// Definitions
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Classes
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Data
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Function Prototypes
+/////////////////////////////////////////////////////////////////////////////
+
+// Suppress name-mangling
+
+extern "C" int cmultilinetextbox_main(int argc, char *argv[]);
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Functions
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// cmultilinetextbox_main
+/////////////////////////////////////////////////////////////////////////////
+
+int cmultilinetextbox_main(int argc, char *argv[])
+{
+  // Create an instance of the test
+
+  printf("cmultilinetextbox_main: Create CMultiLineTextBoxTest instance\n");
+  CMultiLineTextBoxTest *test = new CMultiLineTextBoxTest();
+
+  // Connect the NX server
+
+  printf("cmultilinetextbox_main: Connect the CMultiLineTextBoxTest instance to the NX server\n");
+  if (!test->connect())
+    {
+      printf("cmultilinetextbox_main: Failed to connect the CMultiLineTextBoxTest instance to the NX server\n");
+      delete test;
+      return 1;
+    }
+
+  // Create a window to draw into
+
+  printf("cmultilinetextbox_main: Create a Window\n");
+  if (!test->createWindow())
+    {
+      printf("cmultilinetextbox_main: Failed to create a window\n");
+      delete test;
+      return 1;
+    }
+
+  // Time appends to a short log and to a long one.  The cost of an append
+  // should not depend on the number of lines kept.
+
+  uint32_t shortLog = test->appendLines(16);
+  uint32_t longLog  = test->appendLines(256);
+
+  printf("cmultilinetextbox_main: 16 line log:  %lu usec/append\n",
+         (unsigned long)shortLog);
+  printf("cmultilinetextbox_main: 256 line log: %lu usec/append\n",
+         (unsigned long)longLog);
+
+  // Check the rows kept by incremental wrapping and trimming against a
+  // full wrap of the same text
+
+  bool verified = test->verifyLines(16);
+  printf("cmultilinetextbox_main: Wrapped rows %s\n",
+         verified ? "match" : "DO NOT MATCH");
+  sleep(2);
+
+  // Clean up and exit
+
+  printf("cmultilinetextbox_main: Clean-up and exit\n");
+  delete test;
+  return verified ? 0 : 1;
+}
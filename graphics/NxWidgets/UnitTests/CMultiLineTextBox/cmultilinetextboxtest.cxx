@@ -0,0 +1,315 @@
+/////////////////////////////////////////////////////////////////////////////
+// apps/graphics/NxWidgets/UnitTests/CMultiLineTextBox/cmultilinetextboxtest.cxx
+//
+//   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+//   Author: Gregory Nutt <gnutt@nuttx.org>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in
+//    the documentation and/or other materials provided with the
+//    distribution.
+// 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+//    me be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Included Files
+/////////////////////////////////////////////////////////////////////////////
+
+#include <nuttx/config.h>
+
+#include <nuttx/init.h>
+#include <cstdio>
+#include <cerrno>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+#include <nuttx/nx/nxfonts.h>
+
+#include "nxwidgets/nxconfig.hxx"
+#include "nxwidgets/cmultilinetextboxtest.hxx"
+#include "nxwidgets/cbgwindow.hxx"
+#include "nxwidgets/ctext.hxx"
+
+#include "testing/bench.h"
+
+/////////////////////////////////////////////////////////////////////////////
+// Definitions
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Classes
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Data
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Data
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Function Prototypes
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// CMultiLineTextBoxTest Method Implementations
+/////////////////////////////////////////////////////////////////////////////
+
+// CMultiLineTextBoxTest Constructor
+
+CMultiLineTextBoxTest::CMultiLineTextBoxTest()
+{
+  m_widgetControl = (CWidgetControl *)NULL;
+  m_bgWindow      = (CBgWindow *)NULL;
+  m_nxFont        = (CNxFont *)NULL;
+}
+
+// CMultiLineTextBoxTest Descriptor
+
+CMultiLineTextBoxTest::~CMultiLineTextBoxTest()
+{
+  disconnect();
+}
+
+// Connect to the NX server
+
+bool CMultiLineTextBoxTest::connect(void)
+{
+  // Connect to the server
+
+  bool nxConnected = CNxServer::connect();
+  if (nxConnected)
+    {
+      // Create the default font instance
+
+      m_nxFont = new CNxFont(NXFONT_DEFAULT,
+                            CONFIG_NXWIDGETS_DEFAULT_FONTCOLOR,
+                            CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
+      if (!m_nxFont)
+        {
+          printf("CMultiLineTextBoxTest::connect: Failed to create the default font\n");
+        }
+
+      // Set the background color
+
+      if (!setBackgroundColor(CONFIG_CMULTILINETEXTBOXTEST_BGCOLOR))
+        {
+          printf("CMultiLineTextBoxTest::connect: setBackgroundColor failed\n");
+        }
+    }
+
+  return nxConnected;
+}
+
+// Disconnect from the NX server
+
+void CMultiLineTextBoxTest::disconnect(void)
+{
+  // Close the window
+
+  if (m_bgWindow)
+    {
+      delete m_bgWindow;
+      m_bgWindow = (CBgWindow *)NULL;
+    }
+
+  // Free the default font
+
+  if (m_nxFont)
+    {
+      delete m_nxFont;
+      m_nxFont = (CNxFont *)NULL;
+    }
+
+  // And disconnect from the server
+
+  CNxServer::disconnect();
+}
+
+// Create the background window instance
+
+bool CMultiLineTextBoxTest::createWindow(void)
+{
+  // Initialize the widget control using the default style
+
+  m_widgetControl = new CWidgetControl((CWidgetStyle *)NULL);
+
+  // Get an (uninitialized) instance of the background window as a class
+  // that derives from INxWindow.
+
+  m_bgWindow = getBgWindow(m_widgetControl);
+  if (!m_bgWindow)
+    {
+      printf("CMultiLineTextBoxTest::createWindow: Failed to create CBgWindow instance\n");
+      delete m_widgetControl;
+      return false;
+    }
+
+  // Open (and initialize) the window
+
+  bool success = m_bgWindow->open();
+  if (!success)
+    {
+      printf("CMultiLineTextBoxTest::createWindow: Failed to open background window\n");
+      delete m_bgWindow;
+      m_bgWindow = (CBgWindow*)0;
+      return false;
+    }
+
+  return true;
+}
+
+// Check the incrementally wrapped rows against a fresh wrap of the text
+
+bool CMultiLineTextBoxTest::checkWrap(const CMultiLineTextBox *textBox)
+{
+  const CText *text = textBox->getText();
+
+  CRect rect;
+  textBox->getClientRect(rect);
+
+  CText *fresh = new CText(m_nxFont, *text, rect.getWidth());
+  if (!fresh)
+    {
+      printf("CMultiLineTextBoxTest::checkWrap: Failed to create CText\n");
+      return false;
+    }
+
+  bool match = fresh->getLineCount() == text->getLineCount() &&
+               fresh->getPixelWidth() == text->getPixelWidth() &&
+               fresh->getPixelHeight() == text->getPixelHeight();
+
+  for (int i = 0; match && i < text->getLineCount(); i++)
+    {
+      match = fresh->getLineStartIndex(i) == text->getLineStartIndex(i) &&
+              fresh->getLinePixelLength(i) == text->getLinePixelLength(i);
+      if (!match)
+        {
+          printf("CMultiLineTextBoxTest::checkWrap: Row %d differs\n", i);
+        }
+    }
+
+  if (!match)
+    {
+      printf("CMultiLineTextBoxTest::checkWrap: %d rows, %d expected\n",
+             text->getLineCount(), fresh->getLineCount());
+    }
+
+  delete fresh;
+  return match;
+}
+
+// Append lines to a bounded text box and return microseconds per append
+
+uint32_t CMultiLineTextBoxTest::appendLines(nxgl_coord_t maxRows)
+{
+  struct nxgl_size_s windowSize;
+  if (!m_bgWindow->getSize(&windowSize))
+    {
+      printf("CMultiLineTextBoxTest::appendLines: Failed to get window size\n");
+      return 0;
+    }
+
+  CMultiLineTextBox *textBox =
+    new CMultiLineTextBox(m_widgetControl, 0, 0, windowSize.w, windowSize.h,
+                          CNxString(""), 0, maxRows);
+  if (!textBox)
+    {
+      printf("CMultiLineTextBoxTest::appendLines: Failed to create CMultiLineTextBox\n");
+      return 0;
+    }
+
+  textBox->setFont(m_nxFont);
+  textBox->enable();
+  textBox->enableDrawing();
+
+  uint64_t start = bench_usec();
+
+  for (int i = 0; i < CONFIG_CMULTILINETEXTBOXTEST_NLINES; i++)
+    {
+      textBox->appendText(CNxString::format("%4d: The quick brown fox jumps "
+                                            "over the lazy dog.\n", i));
+    }
+
+  uint64_t elapsed = bench_usec() - start;
+
+  if (!checkWrap(textBox))
+    {
+      printf("CMultiLineTextBoxTest::appendLines: Wrapped rows are wrong\n");
+    }
+
+  textBox->destroy();
+  return (uint32_t)(elapsed / CONFIG_CMULTILINETEXTBOXTEST_NLINES);
+}
+
+// Append lines of varying length, some wrapping over several rows, and
+// check the rows after each append and the trim that follows it
+
+bool CMultiLineTextBoxTest::verifyLines(nxgl_coord_t maxRows)
+{
+  struct nxgl_size_s windowSize;
+  if (!m_bgWindow->getSize(&windowSize))
+    {
+      printf("CMultiLineTextBoxTest::verifyLines: Failed to get window size\n");
+      return false;
+    }
+
+  CMultiLineTextBox *textBox =
+    new CMultiLineTextBox(m_widgetControl, 0, 0, windowSize.w, windowSize.h,
+                          CNxString(""), 0, maxRows);
+  if (!textBox)
+    {
+      printf("CMultiLineTextBoxTest::verifyLines: Failed to create CMultiLineTextBox\n");
+      return false;
+    }
+
+  textBox->setFont(m_nxFont);
+  textBox->enable();
+  textBox->enableDrawing();
+
+  bool success = true;
+  for (int i = 0; success && i < CONFIG_CMULTILINETEXTBOXTEST_NLINES; i++)
+    {
+      CNxString line = CNxString::format("%4d:", i);
+      for (int j = 0; j < i % 23; j++)
+        {
+          line.append(CNxString(" jumps"));
+        }
+
+      line.append(CNxString("\n"));
+      textBox->appendText(line);
+
+      success = checkWrap(textBox);
+      if (!success)
+        {
+          printf("CMultiLineTextBoxTest::verifyLines: Failed after line %d\n",
+                 i);
+        }
+    }
+
+  textBox->destroy();
+  return success;
+}
@@ -0,0 +1,136 @@
+/////////////////////////////////////////////////////////////////////////////
+// apps/graphics/NxWidgets/UnitTests/CMultiLineTextBox/cmultilinetextboxtest.hxx
+//
+//   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+//   Author: Gregory Nutt <gnutt@nuttx.org>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in
+//    the documentation and/or other materials provided with the
+//    distribution.
+// 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+//    me be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef __UNITTESTS_CMULTILINETEXTBOX_CMULTILINETEXTBOXTEST_HXX
+#define __UNITTESTS_CMULTILINETEXTBOX_CMULTILINETEXTBOXTEST_HXX
+
+/////////////////////////////////////////////////////////////////////////////
+// Included Files
+/////////////////////////////////////////////////////////////////////////////
+
+#include <nuttx/config.h>
+
+#include <nuttx/init.h>
+#include <cstdio>
+#include <semaphore.h>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+
+#include "nxwidgets/nxconfig.hxx"
+#include "nxwidgets/cwidgetcontrol.hxx"
+#include "nxwidgets/ccallback.hxx"
+#include "nxwidgets/cbgwindow.hxx"
+#include "nxwidgets/cnxserver.hxx"
+#include "nxwidgets/cnxfont.hxx"
+#include "nxwidgets/cnxstring.hxx"
+#include "nxwidgets/cmultilinetextbox.hxx"
+#include "nxwidgets/crect.hxx"
+
+/////////////////////////////////////////////////////////////////////////////
+// Definitions
+/////////////////////////////////////////////////////////////////////////////
+// Configuration ////////////////////////////////////////////////////////////
+
+#ifndef CONFIG_HAVE_CXX
+#  error "CONFIG_HAVE_CXX must be defined"
+#endif
+
+#ifndef CONFIG_CMULTILINETEXTBOXTEST_BGCOLOR
+#  define CONFIG_CMULTILINETEXTBOXTEST_BGCOLOR CONFIG_NXWIDGETS_DEFAULT_BACKGROUNDCOLOR
+#endif
+
+// The number of lines appended for each log size
+
+#ifndef CONFIG_CMULTILINETEXTBOXTEST_NLINES
+#  define CONFIG_CMULTILINETEXTBOXTEST_NLINES 500
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Classes
+/////////////////////////////////////////////////////////////////////////////
+
+using namespace NXWidgets;
+
+class CMultiLineTextBoxTest : public CNxServer
+{
+private:
+  CWidgetControl    *m_widgetControl;  // The controlling widget for the window
+  CNxFont           *m_nxFont;         // Default font
+  CBgWindow         *m_bgWindow;       // Background window instance
+
+  // Check that the wrapped rows of the text box match those of a CText
+  // freshly built from the same text
+
+  bool checkWrap(const CMultiLineTextBox *textBox);
+
+public:
+  // Constructor/destructors
+
+  CMultiLineTextBoxTest();
+  ~CMultiLineTextBoxTest();
+
+  // Initializer/unitializer.  These methods encapsulate the basic steps for
+  // starting and stopping the NX server
+
+  bool connect(void);
+  void disconnect(void);
+
+  // Create a window.  This method provides the general operations for
+  // creating a window that you can draw within.
+
+  bool createWindow(void);
+
+  // Append lines to a text box that keeps at most maxRows lines, as a log
+  // view would, and return the average time per append in microseconds.
+
+  uint32_t appendLines(nxgl_coord_t maxRows);
+
+  // Append lines of varying length to a text box that keeps at most maxRows
+  // lines and check the wrapped rows after every append and trim.
+
+  bool verifyLines(nxgl_coord_t maxRows);
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Data
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Function Prototypes
+/////////////////////////////////////////////////////////////////////////////
+
+
+#endif // __UNITTESTS_CMULTILINETEXTBOX_CMULTILINETEXTBOXTEST_HXX
@@ -0,0 +1,140 @@
+/////////////////////////////////////////////////////////////////////////////
+// apps/graphics/NxWidgets/UnitTests/CWidgetControl/cwidgetcontrol_main.cxx
+//
+//   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+//   Author: Gregory Nutt <gnutt@nuttx.org>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in
+//    the documentation and/or other materials provided with the
+//    distribution.
+// 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+//    me be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Included Files
+/////////////////////////////////////////////////////////////////////////////
+
+#include <nuttx/config.h>
+
+#include <nuttx/init.h>
+#include <cstdio>
+#include <unistd.h>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+
+#include "nxwidgets/cwidgetcontroltest.hxx"
+
+/////////////////////////////////////////////////////////////////////////////
+// Definitions
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Classes
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Data
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Function Prototypes
+/////////////////////////////////////////////////////////////////////////////
+
+// Suppress name-mangling
+
+extern "C" int cwidgetcontrol_main(int argc, char *argv[]);
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Functions
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// cwidgetcontrol_main
+/////////////////////////////////////////////////////////////////////////////
+
+int cwidgetcontrol_main(int argc, char *argv[])
+{
+  // Create an instance of the test
+
+  printf("cwidgetcontrol_main: Create CWidgetControlTest instance\n");
+  CWidgetControlTest *test = new CWidgetControlTest();
+
+  // Connect the NX server
+
+  printf("cwidgetcontrol_main: Connect the CWidgetControlTest instance to the NX server\n");
+  if (!test->connect())
+    {
+      printf("cwidgetcontrol_main: Failed to connect the CWidgetControlTest instance to the NX server\n");
+      delete test;
+      return 1;
+    }
+
+  // Create a window to draw into
+
+  printf("cwidgetcontrol_main: Create a Window\n");
+  if (!test->createWindow())
+    {
+      printf("cwidgetcontrol_main: Failed to create a window\n");
+      delete test;
+      return 1;
+    }
+
+  // Fill the window with labels
+
+  if (!test->createLabels())
+    {
+      printf("cwidgetcontrol_main: Failed to create the labels\n");
+      delete test;
+      return 1;
+    }
+
+  // Time the two ways of updating the display
+
+  uint32_t full   = test->fullRedraw();
+  uint32_t damage = test->damageRedraw();
+#ifdef CONFIG_NX_XYINPUT
+  uint32_t touch  = test->touchLatency();
+#endif
+
+  printf("cwidgetcontrol_main: %d labels, %d frames\n",
+         CWIDGETCONTROLTEST_NLABELS, CONFIG_CWIDGETCONTROLTEST_NFRAMES);
+  printf("cwidgetcontrol_main:   Full redraw:   %lu usec/frame\n",
+         (unsigned long)full);
+  printf("cwidgetcontrol_main:   Damage redraw: %lu usec/frame\n",
+         (unsigned long)damage);
+#ifdef CONFIG_NX_XYINPUT
+  printf("cwidgetcontrol_main:   Touch to click: %lu usec/tap\n",
+         (unsigned long)touch);
+#endif
+  sleep(2);
+
+  // Clean up and exit
+
+  printf("cwidgetcontrol_main: Clean-up and exit\n");
+  delete test;
+  return 0;
+}
@@ -0,0 +1,349 @@
+/////////////////////////////////////////////////////////////////////////////
+// apps/graphics/NxWidgets/UnitTests/CWidgetControl/cwidgetcontroltest.cxx
+//
+//   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+//   Author: Gregory Nutt <gnutt@nuttx.org>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in
+//    the documentation and/or other materials provided with the
+//    distribution.
+// 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+//    me be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Included Files
+/////////////////////////////////////////////////////////////////////////////
+
+#include <nuttx/config.h>
+
+#include <nuttx/init.h>
+#include <cstdio>
+#include <cerrno>
+#include <ctime>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+#include <nuttx/nx/nxfonts.h>
+
+#include "nxwidgets/nxconfig.hxx"
+#include "nxwidgets/cwidgetcontroltest.hxx"
+#include "nxwidgets/cbgwindow.hxx"
+
+/////////////////////////////////////////////////////////////////////////////
+// Definitions
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Classes
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Data
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Data
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Function Prototypes
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// CWidgetControlTest Method Implementations
+/////////////////////////////////////////////////////////////////////////////
+
+// CWidgetControlTest Constructor
+
+CWidgetControlTest::CWidgetControlTest()
+{
+  m_widgetControl = (CWidgetControl *)NULL;
+  m_bgWindow      = (CBgWindow *)NULL;
+  m_nxFont        = (CNxFont *)NULL;
+  m_tick          = 0;
+  m_clickTime     = 0;
+
+  for (int i = 0; i < CWIDGETCONTROLTEST_NLABELS; i++)
+    {
+      m_labels[i] = (CLabel *)NULL;
+    }
+}
+
+// CWidgetControlTest Descriptor
+
+CWidgetControlTest::~CWidgetControlTest()
+{
+  disconnect();
+}
+
+// Connect to the NX server
+
+bool CWidgetControlTest::connect(void)
+{
+  // Connect to the server
+
+  bool nxConnected = CNxServer::connect();
+  if (nxConnected)
+    {
+      // Create the default font instance
+
+      m_nxFont = new CNxFont(NXFONT_DEFAULT,
+                            CONFIG_NXWIDGETS_DEFAULT_FONTCOLOR,
+                            CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
+      if (!m_nxFont)
+        {
+          printf("CWidgetControlTest::connect: Failed to create the default font\n");
+        }
+
+      // Set the background color
+
+      if (!setBackgroundColor(CONFIG_CWIDGETCONTROLTEST_BGCOLOR))
+        {
+          printf("CWidgetControlTest::connect: setBackgroundColor failed\n");
+        }
+    }
+
+  return nxConnected;
+}
+
+// Disconnect from the NX server
+
+void CWidgetControlTest::disconnect(void)
+{
+  // Free the labels
+
+  for (int i = 0; i < CWIDGETCONTROLTEST_NLABELS; i++)
+    {
+      if (m_labels[i])
+        {
+          delete m_labels[i];
+          m_labels[i] = (CLabel *)NULL;
+        }
+    }
+
+  // Close the window
+
+  if (m_bgWindow)
+    {
+      delete m_bgWindow;
+      m_bgWindow = (CBgWindow *)NULL;
+    }
+
+  // Free the default font
+
+  if (m_nxFont)
+    {
+      delete m_nxFont;
+      m_nxFont = (CNxFont *)NULL;
+    }
+
+  // And disconnect from the server
+
+  CNxServer::disconnect();
+}
+
+// Create the background window instance
+
+bool CWidgetControlTest::createWindow(void)
+{
+  // Initialize the widget control using the default style
+
+  m_widgetControl = new CWidgetControl((CWidgetStyle *)NULL);
+
+  // Get an (uninitialized) instance of the background window as a class
+  // that derives from INxWindow.
+
+  m_bgWindow = getBgWindow(m_widgetControl);
+  if (!m_bgWindow)
+    {
+      printf("CWidgetControlTest::createWindow: Failed to create CBgWindow instance\n");
+      delete m_widgetControl;
+      return false;
+    }
+
+  // Open (and initialize) the window
+
+  bool success = m_bgWindow->open();
+  if (!success)
+    {
+      printf("CWidgetControlTest::createWindow: Failed to open background window\n");
+      delete m_bgWindow;
+      m_bgWindow = (CBgWindow*)0;
+      return false;
+    }
+
+  return true;
+}
+
+// Fill the window with a grid of labels
+
+bool CWidgetControlTest::createLabels(void)
+{
+  // Get the size of the display
+
+  struct nxgl_size_s windowSize;
+  if (!m_bgWindow->getSize(&windowSize))
+    {
+      printf("CWidgetControlTest::createLabels: Failed to get window size\n");
+      return false;
+    }
+
+  nxgl_coord_t labelWidth  = windowSize.w / CONFIG_CWIDGETCONTROLTEST_COLUMNS;
+  nxgl_coord_t labelHeight = windowSize.h / CONFIG_CWIDGETCONTROLTEST_ROWS;
+
+  for (int row = 0; row < CONFIG_CWIDGETCONTROLTEST_ROWS; row++)
+    {
+      for (int col = 0; col < CONFIG_CWIDGETCONTROLTEST_COLUMNS; col++)
+        {
+          int index = row * CONFIG_CWIDGETCONTROLTEST_COLUMNS + col;
+
+          char buffer[8];
+          snprintf(buffer, sizeof(buffer), "%d", index);
+
+          m_labels[index] = new CLabel(m_widgetControl,
+                                       col * labelWidth, row * labelHeight,
+                                       labelWidth, labelHeight,
+                                       CNxString(buffer));
+          if (!m_labels[index])
+            {
+              printf("CWidgetControlTest::createLabels: Failed to create label %d\n",
+                     index);
+              return false;
+            }
+
+          m_labels[index]->addWidgetEventHandler(this);
+          m_labels[index]->enableDrawing();
+          m_labels[index]->redraw();
+        }
+    }
+
+  return true;
+}
+
+// Change the text of the "clock" label without drawing it
+
+CLabel *CWidgetControlTest::tick(void)
+{
+  char buffer[12];
+  snprintf(buffer, sizeof(buffer), "%u", ++m_tick);
+
+  CLabel *clock = m_labels[0];
+  clock->disableDrawing();
+  clock->setText(CNxString(buffer));
+  clock->enableDrawing();
+  return clock;
+}
+
+// Return the time in microseconds
+
+uint32_t CWidgetControlTest::getTime(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)ts.tv_sec * 1000000 + (uint32_t)ts.tv_nsec / 1000;
+}
+
+// Time frames in which the whole window is repainted
+
+uint32_t CWidgetControlTest::fullRedraw(void)
+{
+  uint32_t start = getTime();
+
+  for (int frame = 0; frame < CONFIG_CWIDGETCONTROLTEST_NFRAMES; frame++)
+    {
+      (void)tick();
+
+      for (int i = 0; i < CWIDGETCONTROLTEST_NLABELS; i++)
+        {
+          m_labels[i]->redraw();
+        }
+    }
+
+  return (getTime() - start) / CONFIG_CWIDGETCONTROLTEST_NFRAMES;
+}
+
+// Time frames in which only the damaged region is repainted
+
+uint32_t CWidgetControlTest::damageRedraw(void)
+{
+  uint32_t start = getTime();
+
+  for (int frame = 0; frame < CONFIG_CWIDGETCONTROLTEST_NFRAMES; frame++)
+    {
+      // Invalidate twice, as a widget might when several of its properties
+      // change in one frame.  The second region merges into the first.
+
+      CLabel *clock = tick();
+      clock->invalidate();
+      clock->invalidate();
+
+      m_widgetControl->redrawDamage();
+    }
+
+  return (getTime() - start) / CONFIG_CWIDGETCONTROLTEST_NFRAMES;
+}
+
+#ifdef CONFIG_NX_XYINPUT
+// Time mouse/touch dispatch from the press until the click callback
+
+uint32_t CWidgetControlTest::touchLatency(void)
+{
+  uint32_t total = 0;
+
+  for (int frame = 0; frame < CONFIG_CWIDGETCONTROLTEST_NFRAMES; frame++)
+    {
+      // Visit the labels in a scattered order so that consecutive taps do
+      // not land on neighbouring widgets
+
+      CLabel *label = m_labels[(frame * 7) % CWIDGETCONTROLTEST_NLABELS];
+
+      struct nxgl_point_s pos;
+      pos.x = label->getX() + (label->getWidth() >> 1);
+      pos.y = label->getY() + (label->getHeight() >> 1);
+
+      uint32_t start = getTime();
+      m_clickTime    = start;
+
+      m_widgetControl->newMouseEvent(&pos, NX_MOUSE_LEFTBUTTON);
+      m_widgetControl->pollEvents();
+      total += m_clickTime - start;
+
+      // Release the button so that the next press is a new click
+
+      m_widgetControl->newMouseEvent(&pos, 0);
+      m_widgetControl->pollEvents();
+    }
+
+  return total / CONFIG_CWIDGETCONTROLTEST_NFRAMES;
+}
+#endif
+
+// Record the time of each label click
+
+void CWidgetControlTest::handleClickEvent(const CWidgetEventArgs &e)
+{
+  m_clickTime = getTime();
+}
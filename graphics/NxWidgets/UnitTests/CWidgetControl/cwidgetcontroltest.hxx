@@ -0,0 +1,173 @@
+/////////////////////////////////////////////////////////////////////////////
+// apps/graphics/NxWidgets/UnitTests/CWidgetControl/cwidgetcontroltest.hxx
+//
+//   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+//   Author: Gregory Nutt <gnutt@nuttx.org>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in
+//    the documentation and/or other materials provided with the
+//    distribution.
+// 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+//    me be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef __UNITTESTS_CWIDGETCONTROL_CWIDGETCONTROLTEST_HXX
+#define __UNITTESTS_CWIDGETCONTROL_CWIDGETCONTROLTEST_HXX
+
+/////////////////////////////////////////////////////////////////////////////
+// Included Files
+/////////////////////////////////////////////////////////////////////////////
+
+#include <nuttx/config.h>
+
+#include <nuttx/init.h>
+#include <cstdio>
+#include <semaphore.h>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+
+#include "nxwidgets/nxconfig.hxx"
+#include "nxwidgets/cwidgetcontrol.hxx"
+#include "nxwidgets/ccallback.hxx"
+#include "nxwidgets/cbgwindow.hxx"
+#include "nxwidgets/cnxserver.hxx"
+#include "nxwidgets/cnxfont.hxx"
+#include "nxwidgets/cnxstring.hxx"
+#include "nxwidgets/clabel.hxx"
+#include "nxwidgets/cwidgeteventhandler.hxx"
+#include "nxwidgets/cwidgeteventargs.hxx"
+
+/////////////////////////////////////////////////////////////////////////////
+// Definitions
+/////////////////////////////////////////////////////////////////////////////
+// Configuration ////////////////////////////////////////////////////////////
+
+#ifndef CONFIG_HAVE_CXX
+#  error "CONFIG_HAVE_CXX must be defined"
+#endif
+
+#ifndef CONFIG_CWIDGETCONTROLTEST_BGCOLOR
+#  define CONFIG_CWIDGETCONTROLTEST_BGCOLOR CONFIG_NXWIDGETS_DEFAULT_BACKGROUNDCOLOR
+#endif
+
+// The number of labels across and down the window
+
+#ifndef CONFIG_CWIDGETCONTROLTEST_COLUMNS
+#  define CONFIG_CWIDGETCONTROLTEST_COLUMNS 6
+#endif
+
+#ifndef CONFIG_CWIDGETCONTROLTEST_ROWS
+#  define CONFIG_CWIDGETCONTROLTEST_ROWS 8
+#endif
+
+#define CWIDGETCONTROLTEST_NLABELS \
+  (CONFIG_CWIDGETCONTROLTEST_COLUMNS * CONFIG_CWIDGETCONTROLTEST_ROWS)
+
+// The number of frames timed for each method
+
+#ifndef CONFIG_CWIDGETCONTROLTEST_NFRAMES
+#  define CONFIG_CWIDGETCONTROLTEST_NFRAMES 100
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Classes
+/////////////////////////////////////////////////////////////////////////////
+
+using namespace NXWidgets;
+
+class CWidgetControlTest : public CNxServer, public CWidgetEventHandler
+{
+private:
+  CWidgetControl    *m_widgetControl;  // The controlling widget for the window
+  CNxFont           *m_nxFont;         // Default font
+  CBgWindow         *m_bgWindow;       // Background window instance
+  CLabel            *m_labels[CWIDGETCONTROLTEST_NLABELS]; // The label grid
+  unsigned int       m_tick;           // Value shown by the "clock" label
+  uint32_t           m_clickTime;      // Time of the last click callback
+
+  // Change the text of the "clock" label without drawing it
+
+  CLabel *tick(void);
+
+  // Return the time in microseconds
+
+  uint32_t getTime(void);
+
+public:
+  // Constructor/destructors
+
+  CWidgetControlTest();
+  ~CWidgetControlTest();
+
+  // Initializer/unitializer.  These methods encapsulate the basic steps for
+  // starting and stopping the NX server
+
+  bool connect(void);
+  void disconnect(void);
+
+  // Create a window.  This method provides the general operations for
+  // creating a window that you can draw within.
+
+  bool createWindow(void);
+
+  // Fill the window with a grid of labels.  The first label serves as
+  // a clock that changes on every frame.
+
+  bool createLabels(void);
+
+  // Time frames in which the clock changes and the whole window is
+  // repainted.  Returns the average time per frame in microseconds.
+
+  uint32_t fullRedraw(void);
+
+  // Time frames in which the clock changes and only the damaged region
+  // is repainted.  Returns the average time per frame in microseconds.
+
+  uint32_t damageRedraw(void);
+
+#ifdef CONFIG_NX_XYINPUT
+  // Tap the labels in a scattered order and time each press from the
+  // mouse event until the click callback runs.  Returns the average
+  // latency in microseconds.
+
+  uint32_t touchLatency(void);
+#endif
+
+  // Record the time of each label click
+
+  void handleClickEvent(const CWidgetEventArgs &e);
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Data
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Function Prototypes
+/////////////////////////////////////////////////////////////////////////////
+
+
+#endif // __UNITTESTS_CWIDGETCONTROL_CWIDGETCONTROLTEST_HXX
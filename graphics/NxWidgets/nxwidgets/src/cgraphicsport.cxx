@@ -76,6 +76,7 @@
 #include <sys/types.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <cstring>
 #include <cerrno>
 #include <debug.h>
 
@@ -113,13 +114,19 @@ using namespace NXWidgets;
 #ifdef CONFIG_NX_WRITEONLY
 CGraphicsPort::CGraphicsPort(INxWindow *pNxWnd, nxgl_mxpixel_t backColor)
 {
-  m_pNxWnd    = pNxWnd;
-  m_backColor = backColor;
+  m_pNxWnd         = pNxWnd;
+  m_backColor      = backColor;
+  m_clipped        = false;
+  m_textBuffer     = (FAR uint8_t *)NULL;
+  m_textBufferSize = 0;
 }
 #else
 CGraphicsPort::CGraphicsPort(INxWindow *pNxWnd)
 {
-  m_pNxWnd = pNxWnd;
+  m_pNxWnd         = pNxWnd;
+  m_clipped        = false;
+  m_textBuffer     = (FAR uint8_t *)NULL;
+  m_textBufferSize = 0;
 }
 #endif
 
@@ -132,8 +139,42 @@ CGraphicsPort::~CGraphicsPort(void)
   // m_pNxWnd is not deleted.  This is an abstract base class and
   // the caller of the CGraphicsPort instance is responsible for
   // the window destruction.
+
+  if (m_textBuffer)
+    {
+      delete [] m_textBuffer;
+    }
 };
 
+/**
+ * Limit all following drawing to a rectangle.
+ *
+ * @param rect The window-relative clipping rectangle.
+ */
+
+void CGraphicsPort::setClipRect(FAR const struct nxgl_rect_s *rect)
+{
+  nxgl_rectcopy(&m_clipRect, rect);
+  m_clipped = true;
+}
+
+/**
+ * Get the current clipping rectangle.
+ *
+ * @param rect The location to return the clipping rectangle.
+ * @return False if there is no clipping rectangle.
+ */
+
+bool CGraphicsPort::getClipRect(FAR struct nxgl_rect_s *rect) const
+{
+  if (m_clipped)
+    {
+      nxgl_rectcopy(rect, &m_clipRect);
+    }
+
+  return m_clipped;
+}
+
 /**
  * Return the absolute x coordinate of the upper left hand corner of the
  * underlying window.
@@ -176,7 +217,11 @@ void CGraphicsPort::drawPixel(nxgl_coord_t x, nxgl_coord_t y,
   struct nxgl_point_s pos;
   pos.x = x;
   pos.y = y;
-  m_pNxWnd->setPixel(&pos, color);
+
+  if (!m_clipped || nxgl_rectinside(&m_clipRect, &pos))
+    {
+      m_pNxWnd->setPixel(&pos, color);
+    }
 }
 
 /**
@@ -202,7 +247,7 @@ void CGraphicsPort::drawHorizLine(nxgl_coord_t x, nxgl_coord_t y,
 
   // Draw the line
 
-  if (!m_pNxWnd->fill(&dest, color))
+  if (clip(&dest) && !m_pNxWnd->fill(&dest, color))
     {
       gerr("ERROR: INxWindow::fill failed\n");
     }
@@ -232,7 +277,7 @@ void CGraphicsPort::drawVertLine(nxgl_coord_t x, nxgl_coord_t y,
 
   // Draw the line
 
-  if (!m_pNxWnd->fill(&dest, color))
+  if (clip(&dest) && !m_pNxWnd->fill(&dest, color))
     {
       gerr("ERROR: INxWindow::fill failed\n");
     }
@@ -261,7 +306,15 @@ void CGraphicsPort::drawLine(nxgl_coord_t x1, nxgl_coord_t y1,
   vector.pt2.x = x2;
   vector.pt2.y = y2;
 
-  if (!m_pNxWnd->drawLine(&vector, 1, color, caps))
+  // NX cannot clip a line, so only skip lines that are entirely outside
+
+  struct nxgl_rect_s bounds;
+  bounds.pt1.x = ngl_min(x1, x2);
+  bounds.pt1.y = ngl_min(y1, y2);
+  bounds.pt2.x = ngl_max(x1, x2);
+  bounds.pt2.y = ngl_max(y1, y2);
+
+  if (isVisible(&bounds) && !m_pNxWnd->drawLine(&vector, 1, color, caps))
     {
       gerr("ERROR: INxWindow::drawLine failed\n");
     }
@@ -286,7 +339,36 @@ void CGraphicsPort::drawFilledRect(nxgl_coord_t x, nxgl_coord_t y,
   rect.pt1.y = y;
   rect.pt2.x = x + width - 1;
   rect.pt2.y = y + height - 1;
-  m_pNxWnd->fill(&rect, color);
+
+  if (clip(&rect))
+    {
+      m_pNxWnd->fill(&rect, color);
+    }
+}
+
+/**
+ * Draw a filled circle at the specified position, size, and color.  The
+ * circle is only culled, not clipped, by the clipping rectangle.
+ *
+ * @param center The window-relative coordinates of the circle center.
+ * @param radius The radius of the rectangle in pixels.
+ * @param color The color of the rectangle.
+ */
+
+void CGraphicsPort::drawFilledCircle(struct nxgl_point_s *center,
+                                     nxgl_coord_t radius,
+                                     nxgl_mxpixel_t color)
+{
+  struct nxgl_rect_s bounds;
+  bounds.pt1.x = center->x - radius;
+  bounds.pt1.y = center->y - radius;
+  bounds.pt2.x = center->x + radius;
+  bounds.pt2.y = center->y + radius;
+
+  if (isVisible(&bounds))
+    {
+      (void)m_pNxWnd->drawFilledCircle(center, radius, color);
+    }
 }
 
 /**
@@ -367,9 +449,14 @@ void CGraphicsPort::drawBitmap(nxgl_coord_t x, nxgl_coord_t y,
   dest.pt2.x = x + width - 1;
   dest.pt2.y = y + height - 1;
 
-  // Blit the bitmap
+  // Blit the bitmap.  Clipping dest is enough, the origin still locates
+  // the bitmap data.
 
-  (void)m_pNxWnd->bitmap(&dest, (FAR const void *)bitmap->data, &origin, bitmap->stride);
+  if (clip(&dest))
+    {
+      (void)m_pNxWnd->bitmap(&dest, (FAR const void *)bitmap->data, &origin,
+                             bitmap->stride);
+    }
 }
 
 /**
@@ -507,7 +594,11 @@ void CGraphicsPort::drawBitmap(nxgl_coord_t x, nxgl_coord_t y,
 
       // Blit the bitmap
 
-      (void)m_pNxWnd->bitmap(&dest, (FAR const void *)runPtr, &origin, bitmap->stride);
+      if (clip(&dest))
+        {
+          (void)m_pNxWnd->bitmap(&dest, (FAR const void *)runPtr, &origin,
+                                 bitmap->stride);
+        }
     }
 }
 
@@ -582,7 +673,12 @@ void CGraphicsPort::drawBitmapGreyScale(nxgl_coord_t x, nxgl_coord_t y,
 
       // Now blit the single row
 
-      (void)m_pNxWnd->bitmap(&dest, run, &origin, bitmap->stride);
+      struct nxgl_rect_s clipped;
+      nxgl_rectcopy(&clipped, &dest);
+      if (clip(&clipped))
+        {
+          (void)m_pNxWnd->bitmap(&clipped, run, &origin, bitmap->stride);
+        }
 
        // Setup for the next source row
 
@@ -690,6 +786,37 @@ void CGraphicsPort::drawText(struct nxgl_point_s *pos, CRect *bound,
   font->setColor(savedColor);
 }
 
+/**
+ * Clip a destination rectangle to the clipping rectangle, if any.
+ *
+ * @param rect The rectangle to clip.  Modified in place.
+ * @return False if nothing is left to draw.
+ */
+
+bool CGraphicsPort::clip(FAR struct nxgl_rect_s *rect) const
+{
+  if (m_clipped)
+    {
+      nxgl_rectintersect(rect, rect, &m_clipRect);
+    }
+
+  return !nxgl_nullrect(rect);
+}
+
+/**
+ * Test if any part of a rectangle lies within the clipping rectangle.
+ *
+ * @param rect The rectangle to test.
+ * @return True if the rectangle is (partly) visible.
+ */
+
+bool CGraphicsPort::isVisible(FAR const struct nxgl_rect_s *rect) const
+{
+  return !m_clipped ||
+         (rect->pt1.x <= m_clipRect.pt2.x && rect->pt2.x >= m_clipRect.pt1.x &&
+          rect->pt1.y <= m_clipRect.pt2.y && rect->pt2.y >= m_clipRect.pt1.y);
+}
+
 /**
  * The underlying implementation for drawText functions
  * @param pos The window-relative x/y coordinate of the string.
@@ -733,113 +860,186 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
     }
 #endif
 
-  // Allocate a bit of memory to hold the largest rendered font
-
-  unsigned int bmWidth   = ((unsigned int)font->getMaxWidth() * CONFIG_NXWIDGETS_BPP + 7) >> 3;
-  unsigned int bmHeight  = (unsigned int)font->getHeight();
+  // Get the bounding rectangle in NX form and limit that to the clipping
+  // rectangle
 
-  unsigned int glyphSize =  bmWidth * bmHeight;
-  FAR uint8_t  *glyph    =  new uint8_t[glyphSize];
-
-  // Get the bounding rectangle in NX form
+  nxgl_coord_t height = (nxgl_coord_t)font->getHeight();
 
   struct nxgl_rect_s boundingBox;
   bound->getNxRect(&boundingBox);
 
-  // Loop setup
+  if (!clip(&boundingBox) || pos->y > boundingBox.pt2.y ||
+      pos->y + height - 1 < boundingBox.pt1.y)
+    {
+      // Nothing visible, but the position must still advance
 
-  struct SBitmap bitmap;
-  bitmap.bpp    = CONFIG_NXWIDGETS_BPP;
-  bitmap.fmt    = CONFIG_NXWIDGETS_FMT;
-  bitmap.data   = (FAR const nxgl_mxpixel_t*)glyph;
+      pos->x += font->getStringWidth(string, startIndex, endIndex - startIndex);
+      return;
+    }
 
-  // Loop for each letter in the sub-string
+  // Skip over the letters that lie completely to the left of the bounding
+  // box
 
-  for (int i = startIndex; i < endIndex; i++)
+  int index = startIndex;
+  for (; index < endIndex; index++)
     {
-      // Get the next letter in the string
+      nxgl_coord_t width = font->getCharWidth(string.getCharAt(index));
+      if (pos->x + width > boundingBox.pt1.x)
+        {
+          break;
+        }
 
-      const nxwidget_char_t letter = string.getCharAt(i);
+      pos->x += width;
+    }
 
-      // Get the font metrics for this letter
+  // Find the run of letters that overlaps the bounding box.  The run is
+  // composed in one buffer and put on the display with a single bitmap
+  // operation.
 
-      struct nx_fontmetric_s metrics;
-      font->getCharMetrics(letter, &metrics);
+  int runStart          = index;
+  nxgl_coord_t runWidth = 0;
 
-      // Get the width of the font (in pixels)
+  for (; index < endIndex && pos->x + runWidth <= boundingBox.pt2.x; index++)
+    {
+      runWidth += font->getCharWidth(string.getCharAt(index));
+    }
 
-      nxgl_coord_t fontWidth  = (nxgl_coord_t)(metrics.width + metrics.xoffset);
+  if (runWidth > 0 && reserveTextBuffer(runWidth, height))
+    {
+      unsigned int stride = ((unsigned int)runWidth * CONFIG_NXWIDGETS_BPP + 7) >> 3;
 
-      // Does the letter have height?  Spaces have width, but no height
+      // Describe the destination of the run as a bounding box
 
-      if (metrics.height > 0 || !transparent)
+      struct nxgl_rect_s dest;
+      dest.pt1.x = pos->x;
+      dest.pt1.y = pos->y;
+      dest.pt2.x = pos->x + runWidth - 1;
+      dest.pt2.y = pos->y + height - 1;
+
+      struct SBitmap bitmap;
+      bitmap.bpp    = CONFIG_NXWIDGETS_BPP;
+      bitmap.fmt    = CONFIG_NXWIDGETS_FMT;
+      bitmap.width  = runWidth;
+      bitmap.height = height;
+      bitmap.stride = stride;
+      bitmap.data   = (FAR const void *)m_textBuffer;
+
+      bool complete = true;
+      unsigned int offset = 0;
+
+      if (transparent)
         {
-          // Set the current, effective size of the bitmap
+          // Read the current contents of the destination and render the
+          // letters over it.  The font renderer always renders the fonts
+          // on a transparent background.
 
-          bitmap.width  = fontWidth;
-          bitmap.height = bmHeight;
-          bitmap.stride = (fontWidth * bitmap.bpp + 7) >> 3;
+          m_pNxWnd->getRectangle(&dest, &bitmap);
 
-          // Describe the destination of the font as a bounding box
+          for (int i = runStart; i < index; i++)
+            {
+              const nxwidget_char_t letter = string.getCharAt(i);
 
-          struct nxgl_rect_s dest;
-          dest.pt1.x = pos->x;
-          dest.pt1.y = pos->y;
-          dest.pt2.x = pos->x + fontWidth - 1;
-          dest.pt2.y = pos->y + bmHeight - 1;
+              struct nx_fontmetric_s metrics;
+              font->getCharMetrics(letter, &metrics);
 
-          // Get the interection of the font box and the bounding box
+              nxgl_coord_t width = (nxgl_coord_t)(metrics.width + metrics.xoffset);
 
-          struct nxgl_rect_s intersection;
-          nxgl_rectintersect(&intersection, &dest, &boundingBox);
+              // Spaces have width, but no height
 
-          // Skip to the next character if this one is completely outside
-          // the bounding box.
+              if (metrics.height > 0)
+                {
+                  struct SBitmap glyph = bitmap;
+                  glyph.width = width;
+                  glyph.data  = (FAR const void *)&m_textBuffer[offset];
 
-          if (!nxgl_nullrect(&intersection))
+                  font->drawChar(&glyph, letter);
+                }
+
+              offset += ((unsigned int)width * CONFIG_NXWIDGETS_BPP) >> 3;
+            }
+        }
+      else
+        {
+          // Copy each letter, already rendered on the background color,
+          // into place
+
+          unsigned int glyphStride =
+            ((unsigned int)font->getMaxWidth() * CONFIG_NXWIDGETS_BPP + 7) >> 3;
+
+          for (int i = runStart; i < index; i++)
             {
-              // If we have been given a background color, use it to fill the array.
-              // Otherwise initialize the bitmap memory by reading from the display.
-              // The font renderer always renders the fonts on a transparent background.
+              nxgl_coord_t width;
+              FAR const uint8_t *glyph =
+                font->getGlyph(string.getCharAt(i), background, &width);
 
-              if (!transparent)
+              if (!glyph)
                 {
-                  // Set the glyph memory to the background color
-
-                  nxwidget_pixel_t *bmPtr   = (nxwidget_pixel_t *)bitmap.data;
-                  unsigned int      npixels = fontWidth * bmHeight;
-                  for (unsigned int j = 0; j < npixels; j++)
-                    {
-                      *bmPtr++ = background;
-                    }
+                  complete = false;
+                  break;
                 }
-              else
-                {
-                  // Read the current contents of the destination into the glyph memory
 
-                  m_pNxWnd->getRectangle(&dest, &bitmap);
+              unsigned int nbytes = ((unsigned int)width * CONFIG_NXWIDGETS_BPP) >> 3;
+              FAR uint8_t *row    = &m_textBuffer[offset];
+
+              for (nxgl_coord_t y = 0; y < height; y++)
+                {
+                  memcpy(row, glyph, nbytes);
+                  row   += stride;
+                  glyph += glyphStride;
                 }
 
-              // Render the font into the initialized bitmap
+              offset += nbytes;
+            }
+        }
 
-              font->drawChar(&bitmap, letter);
+      // Then put the visible part of the run on the display
 
-              // Then put the font on the display
+      struct nxgl_rect_s intersection;
+      nxgl_rectintersect(&intersection, &dest, &boundingBox);
 
-              if (!m_pNxWnd->bitmap(&intersection, (FAR const void *)bitmap.data,
-                                   pos, bitmap.stride))
-                {
-                  ginfo("nx_bitmapwindow failed: %d\n", errno);
-                }
-            }
+      if (complete &&
+          !m_pNxWnd->bitmap(&intersection, (FAR const void *)m_textBuffer,
+                            pos, stride))
+        {
+          ginfo("nx_bitmapwindow failed: %d\n", errno);
         }
+    }
+
+  pos->x += runWidth;
+
+  // Skip over the letters to the right of the bounding box
+
+  if (index < endIndex)
+    {
+      pos->x += font->getStringWidth(string, index, endIndex - index);
+    }
+}
 
-      // Adjust the X position for the next character in the string
+/**
+ * Make sure that the text composition buffer can hold a run of text.
+ *
+ * @param width The width of the run in pixels.
+ * @param height The height of the run in rows.
+ * @return False if the memory could not be allocated.
+ */
+
+bool CGraphicsPort::reserveTextBuffer(nxgl_coord_t width, nxgl_coord_t height)
+{
+  unsigned int stride = ((unsigned int)width * CONFIG_NXWIDGETS_BPP + 7) >> 3;
+  unsigned int size   = stride * (unsigned int)height;
+
+  if (size > m_textBufferSize)
+    {
+      if (m_textBuffer)
+        {
+          delete [] m_textBuffer;
+        }
 
-      pos->x += fontWidth;
+      m_textBuffer     = new uint8_t[size];
+      m_textBufferSize = m_textBuffer ? size : 0;
     }
 
-  delete glyph;
+  return m_textBuffer != (FAR uint8_t *)NULL;
 }
 
 /**
@@ -912,6 +1112,24 @@ void CGraphicsPort::move(nxgl_coord_t x, nxgl_coord_t y,
 void CGraphicsPort::greyScale(nxgl_coord_t x, nxgl_coord_t y,
                               nxgl_coord_t width, nxgl_coord_t height)
 {
+  // Limit the region to the clipping rectangle
+
+  struct nxgl_rect_s region;
+  region.pt1.x = x;
+  region.pt1.y = y;
+  region.pt2.x = x + width - 1;
+  region.pt2.y = y + height - 1;
+
+  if (!clip(&region))
+    {
+      return;
+    }
+
+  x      = region.pt1.x;
+  y      = region.pt1.y;
+  width  = region.pt2.x - region.pt1.x + 1;
+  height = region.pt2.y - region.pt1.y + 1;
+
   // Allocate memory to hold one row of graphics data
 
   unsigned int stride    = ((unsigned int)width * CONFIG_NXWIDGETS_BPP + 7) >> 3;
@@ -995,6 +1213,24 @@ void CGraphicsPort::greyScale(nxgl_coord_t x, nxgl_coord_t y,
 void CGraphicsPort::invert(nxgl_coord_t x, nxgl_coord_t y,
                            nxgl_coord_t width, nxgl_coord_t height)
 {
+  // Limit the region to the clipping rectangle
+
+  struct nxgl_rect_s region;
+  region.pt1.x = x;
+  region.pt1.y = y;
+  region.pt2.x = x + width - 1;
+  region.pt2.y = y + height - 1;
+
+  if (!clip(&region))
+    {
+      return;
+    }
+
+  x      = region.pt1.x;
+  y      = region.pt1.y;
+  width  = region.pt2.x - region.pt1.x + 1;
+  height = region.pt2.y - region.pt1.y + 1;
+
   // Allocate memory to hold one row of graphics data
 
   unsigned int stride    = ((unsigned int)width * CONFIG_NXWIDGETS_BPP + 7) >> 3;
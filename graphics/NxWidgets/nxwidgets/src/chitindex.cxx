@@ -0,0 +1,337 @@
+/****************************************************************************
+ * apps/graphics/NxWidgets/nxwidgets/src/chitindex.cxx
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+ *    me be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <cstdint>
+#include <cstdbool>
+#include <cstring>
+
+#include "graphics/nxwidgets/nxconfig.hxx"
+#include "graphics/nxwidgets/cnxwidget.hxx"
+#include "graphics/nxwidgets/chitindex.hxx"
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Method Implementations
+ ****************************************************************************/
+
+using namespace NXWidgets;
+
+/**
+ * Constructor.  The index is initially empty and invalid.
+ */
+
+CHitIndex::CHitIndex(void)
+{
+  m_cells      = (FAR uint16_t *)NULL;
+  m_entries    = (FAR uint16_t *)NULL;
+  m_nCells     = 0;
+  m_nEntries   = 0;
+  m_x          = 0;
+  m_y          = 0;
+  m_cellWidth  = 1;
+  m_cellHeight = 1;
+  m_cols       = 0;
+  m_rows       = 0;
+  m_valid      = false;
+}
+
+/**
+ * Destructor.
+ */
+
+CHitIndex::~CHitIndex(void)
+{
+  delete[] m_cells;
+  delete[] m_entries;
+}
+
+/**
+ * Rebuild the index from a list of widgets.
+ *
+ * @param widgets The widgets to index.
+ * @param absolute True: index the widgets by their window coordinates;
+ * false: index them by their coordinates relative to their parent.
+ * @return True if the index was built; false if memory could not be
+ * allocated, in which case the index remains invalid.
+ */
+
+bool CHitIndex::build(const TNxArray<CNxWidget*> &widgets, bool absolute)
+{
+  m_valid = false;
+
+  int count = widgets.size();
+  if (count > UINT16_MAX)
+    {
+      return false;
+    }
+
+  // Find the bounding box of all of the widgets
+
+  struct nxgl_rect_s bounds;
+  struct nxgl_rect_s rect;
+  bool empty = true;
+
+  for (int i = 0; i < count; i++)
+    {
+      if (getWidgetRect(widgets[i], absolute, rect))
+        {
+          if (empty)
+            {
+              bounds = rect;
+              empty  = false;
+            }
+          else
+            {
+              bounds.pt1.x = ngl_min(bounds.pt1.x, rect.pt1.x);
+              bounds.pt1.y = ngl_min(bounds.pt1.y, rect.pt1.y);
+              bounds.pt2.x = ngl_max(bounds.pt2.x, rect.pt2.x);
+              bounds.pt2.y = ngl_max(bounds.pt2.y, rect.pt2.y);
+            }
+        }
+    }
+
+  if (empty)
+    {
+      // Nothing can be hit
+
+      m_cols  = 0;
+      m_rows  = 0;
+      m_valid = true;
+      return true;
+    }
+
+  // Aim for about one widget per cell
+
+  int side = 1;
+  while (side * side < count && side < CONFIG_NXWIDGETS_HITINDEX_GRIDSIZE)
+    {
+      side++;
+    }
+
+  nxgl_coord_t width  = bounds.pt2.x - bounds.pt1.x + 1;
+  nxgl_coord_t height = bounds.pt2.y - bounds.pt1.y + 1;
+
+  m_x          = bounds.pt1.x;
+  m_y          = bounds.pt1.y;
+  m_cols       = side < width  ? side : width;
+  m_rows       = side < height ? side : height;
+  m_cellWidth  = (width  + m_cols - 1) / m_cols;
+  m_cellHeight = (height + m_rows - 1) / m_rows;
+
+  int nCells = m_cols * m_rows;
+  if (m_nCells < nCells + 1)
+    {
+      delete[] m_cells;
+      m_cells  = new uint16_t[nCells + 1];
+      m_nCells = m_cells ? nCells + 1 : 0;
+      if (!m_cells)
+        {
+          return false;
+        }
+    }
+
+  // Count the widgets that overlap each cell.  The count for cell n is kept
+  // in m_cells[n + 1]
+
+  memset(m_cells, 0, (nCells + 1) * sizeof(uint16_t));
+
+  struct nxgl_rect_s range;
+  int total = 0;
+
+  for (int i = 0; i < count; i++)
+    {
+      if (getWidgetRect(widgets[i], absolute, rect))
+        {
+          getCellRange(rect, range);
+          for (int row = range.pt1.y; row <= range.pt2.y; row++)
+            {
+              for (int col = range.pt1.x; col <= range.pt2.x; col++)
+                {
+                  m_cells[row * m_cols + col + 1]++;
+                }
+            }
+
+          total += (range.pt2.x - range.pt1.x + 1) *
+                   (range.pt2.y - range.pt1.y + 1);
+        }
+    }
+
+  if (total > UINT16_MAX)
+    {
+      return false;
+    }
+
+  if (m_nEntries < total)
+    {
+      delete[] m_entries;
+      m_entries  = new uint16_t[total];
+      m_nEntries = m_entries ? total : 0;
+      if (!m_entries)
+        {
+          return false;
+        }
+    }
+
+  // Turn the counts into the offset of the first entry of each cell
+
+  for (int i = 1; i <= nCells; i++)
+    {
+      m_cells[i] += m_cells[i - 1];
+    }
+
+  // Fill in the entries in widget order, using m_cells[n] as the insertion
+  // point for cell n.  Afterwards m_cells[n] is the end of cell n.
+
+  for (int i = 0; i < count; i++)
+    {
+      if (getWidgetRect(widgets[i], absolute, rect))
+        {
+          getCellRange(rect, range);
+          for (int row = range.pt1.y; row <= range.pt2.y; row++)
+            {
+              for (int col = range.pt1.x; col <= range.pt2.x; col++)
+                {
+                  m_entries[m_cells[row * m_cols + col]++] = (uint16_t)i;
+                }
+            }
+        }
+    }
+
+  // Shift the ends back so that m_cells[n] is the start of cell n again
+
+  for (int i = nCells; i > 0; i--)
+    {
+      m_cells[i] = m_cells[i - 1];
+    }
+
+  m_cells[0] = 0;
+  m_valid    = true;
+  return true;
+}
+
+/**
+ * Find the widgets whose rectangles may contain a point.  The index must
+ * be valid.
+ *
+ * @param x The x coordinate of the point.
+ * @param y The y coordinate of the point.
+ * @param entries Receives a pointer to the indexes of the widgets, in
+ * ascending order.
+ * @return The number of widget indexes.
+ */
+
+int CHitIndex::lookup(nxgl_coord_t x, nxgl_coord_t y,
+                      FAR const uint16_t *&entries) const
+{
+  if (m_cols == 0 || x < m_x || y < m_y)
+    {
+      return 0;
+    }
+
+  int col = (x - m_x) / m_cellWidth;
+  int row = (y - m_y) / m_cellHeight;
+
+  if (col >= m_cols || row >= m_rows)
+    {
+      return 0;
+    }
+
+  int cell = row * m_cols + col;
+  entries  = &m_entries[m_cells[cell]];
+  return m_cells[cell + 1] - m_cells[cell];
+}
+
+/**
+ * Get the rectangle occupied by a widget.
+ *
+ * @param widget The widget.
+ * @param absolute True: use window coordinates; false: use coordinates
+ * relative to the widget's parent.
+ * @param rect Receives the widget's rectangle.
+ * @return True if the widget occupies any pixels.
+ */
+
+bool CHitIndex::getWidgetRect(const CNxWidget *widget, bool absolute,
+                              struct nxgl_rect_s &rect)
+{
+  nxgl_coord_t width  = widget->getWidth();
+  nxgl_coord_t height = widget->getHeight();
+
+  if (width <= 0 || height <= 0)
+    {
+      return false;
+    }
+
+  if (absolute)
+    {
+      rect.pt1.x = widget->getX();
+      rect.pt1.y = widget->getY();
+    }
+  else
+    {
+      rect.pt1.x = widget->getRelativeX();
+      rect.pt1.y = widget->getRelativeY();
+    }
+
+  rect.pt2.x = rect.pt1.x + width - 1;
+  rect.pt2.y = rect.pt1.y + height - 1;
+  return true;
+}
+
+/**
+ * Get the range of cells overlapped by a rectangle.  The rectangle must lie
+ * within the bounding box used to build the grid.
+ *
+ * @param rect The rectangle.
+ * @param range Receives the first and last column (x) and row (y).
+ */
+
+void CHitIndex::getCellRange(const struct nxgl_rect_s &rect,
+                             struct nxgl_rect_s &range) const
+{
+  range.pt1.x = (rect.pt1.x - m_x) / m_cellWidth;
+  range.pt1.y = (rect.pt1.y - m_y) / m_cellHeight;
+  range.pt2.x = (rect.pt2.x - m_x) / m_cellWidth;
+  range.pt2.y = (rect.pt2.y - m_y) / m_cellHeight;
+}
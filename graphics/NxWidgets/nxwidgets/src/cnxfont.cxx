@@ -58,11 +58,42 @@
  ****************************************************************************/
 
 /****************************************************************************
- * CNxFont Method Implementations
+ * Private Functions
  ****************************************************************************/
 
 using namespace NXWidgets;
 
+/**
+ * Fill pixel memory with one color.
+ *
+ * @param dest The first pixel to fill.
+ * @param npixels The number of pixels to fill.
+ * @param color The color to fill with.
+ */
+
+static void fillPixels(FAR uint8_t *dest, unsigned int npixels,
+                       nxgl_mxpixel_t color)
+{
+#if CONFIG_NXWIDGETS_BPP == 24
+  for (unsigned int i = 0; i < npixels; i++)
+    {
+      *dest++ = (uint8_t)color;
+      *dest++ = (uint8_t)(color >> 8);
+      *dest++ = (uint8_t)(color >> 16);
+    }
+#else
+  FAR nxwidget_pixel_t *pixel = (FAR nxwidget_pixel_t *)dest;
+  for (unsigned int i = 0; i < npixels; i++)
+    {
+      *pixel++ = (nxwidget_pixel_t)color;
+    }
+#endif
+}
+
+/****************************************************************************
+ * CNxFont Method Implementations
+ ****************************************************************************/
+
 /**
  * CNxFont Constructor.
  *
@@ -80,6 +111,20 @@ CNxFont::CNxFont(enum nx_fontid_e fontid, nxgl_mxpixel_t fontColor,
   m_pFontSet         = nxf_getfontset(m_fontHandle);
   m_fontColor        = fontColor;
   m_transparentColor = transparentColor;
+  m_glyphMemory      = (FAR uint8_t *)NULL;
+  m_nGlyphs          = 0;
+}
+
+/**
+ * CNxFont Destructor.
+ */
+
+CNxFont::~CNxFont()
+{
+  if (m_glyphMemory)
+    {
+      delete [] m_glyphMemory;
+    }
 }
 
 /**
@@ -123,13 +168,110 @@ void CNxFont::drawChar(FAR SBitmap *bitmap, nxwidget_char_t letter)
 
       uint8_t fwidth  = fbm->metric.width + fbm->metric.xoffset;
       uint8_t fheight = fbm->metric.height + fbm->metric.yoffset;
-      uint8_t fstride = (fwidth * bitmap->bpp + 7) >> 3;
 
       // Then render the glyph into the bitmap memory
 
       (void)FONT_RENDERER((FAR nxgl_mxpixel_t*)bitmap->data, fheight,
-                          fwidth, fstride, fbm, m_fontColor);
+                          fwidth, bitmap->stride, fbm, m_fontColor);
+    }
+}
+
+/**
+ * Get a character rendered in the current color on a solid background.
+ * The most recently used characters are kept, so text is only rendered
+ * once per character and pair of colors.
+ *
+ * @param letter The character to get.
+ * @param background The background color.
+ * @param width The location to return the width of the character.
+ * @return The rendered pixels (getMaxWidth() pixels per row and
+ *   getHeight() rows) or NULL if the cache could not be allocated.
+ */
+
+FAR const uint8_t *CNxFont::getGlyph(nxwidget_char_t letter,
+                                     nxgl_mxpixel_t background,
+                                     FAR nxgl_coord_t *width)
+{
+  // Look for the glyph in the cache
+
+  int index;
+  for (index = 0; index < m_nGlyphs; index++)
+    {
+      if (m_glyphs[index].letter == letter &&
+          m_glyphs[index].color == m_fontColor &&
+          m_glyphs[index].background == background)
+        {
+          break;
+        }
+    }
+
+  unsigned int stride = ((unsigned int)getMaxWidth() * CONFIG_NXWIDGETS_BPP + 7) >> 3;
+  unsigned int height = getHeight();
+
+  if (index >= m_nGlyphs)
+    {
+      // Not cached.  Allocate the cache memory on first use.
+
+      if (!m_glyphMemory)
+        {
+          unsigned int glyphSize = stride * height;
+
+          m_glyphMemory = new uint8_t[CONFIG_NXWIDGETS_GLYPHCACHE_SIZE * glyphSize];
+          if (!m_glyphMemory)
+            {
+              return (FAR const uint8_t *)NULL;
+            }
+
+          for (int i = 0; i < CONFIG_NXWIDGETS_GLYPHCACHE_SIZE; i++)
+            {
+              m_glyphs[i].data = &m_glyphMemory[i * glyphSize];
+            }
+        }
+
+      // Use a free entry or else replace the least recently used glyph
+
+      if (m_nGlyphs < CONFIG_NXWIDGETS_GLYPHCACHE_SIZE)
+        {
+          index = m_nGlyphs++;
+        }
+      else
+        {
+          index = CONFIG_NXWIDGETS_GLYPHCACHE_SIZE - 1;
+        }
+
+      // Render the glyph on its background
+
+      FAR struct SGlyph *glyph = &m_glyphs[index];
+      glyph->letter            = letter;
+      glyph->color             = m_fontColor;
+      glyph->background        = background;
+      glyph->width             = (uint8_t)getCharWidth(letter);
+
+      fillPixels(glyph->data, stride * height * 8 / CONFIG_NXWIDGETS_BPP,
+                 background);
+
+      struct SBitmap bitmap;
+      bitmap.bpp    = CONFIG_NXWIDGETS_BPP;
+      bitmap.fmt    = CONFIG_NXWIDGETS_FMT;
+      bitmap.width  = getMaxWidth();
+      bitmap.height = height;
+      bitmap.stride = stride;
+      bitmap.data   = (FAR const void *)glyph->data;
+
+      drawChar(&bitmap, letter);
     }
+
+  // Move the glyph to the front of the list
+
+  if (index > 0)
+    {
+      struct SGlyph glyph = m_glyphs[index];
+      memmove(&m_glyphs[1], &m_glyphs[0], index * sizeof(struct SGlyph));
+      m_glyphs[0] = glyph;
+    }
+
+  *width = m_glyphs[0].width;
+  return m_glyphs[0].data;
 }
 
 /**
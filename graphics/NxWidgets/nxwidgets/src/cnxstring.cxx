@@ -95,6 +95,7 @@ using namespace NXWidgets;
 
 CNxString::CNxString()
 {
+  m_storage       = (FAR nxwidget_char_t *)NULL;
   m_text          = (FAR nxwidget_char_t *)NULL;
   m_stringLength  = 0;
   m_allocatedSize = 0;
@@ -110,6 +111,7 @@ CNxString::CNxString()
 
 CNxString::CNxString(FAR const char *text)
 {
+  m_storage       = (FAR nxwidget_char_t *)NULL;
   m_text          = (FAR nxwidget_char_t *)NULL;
   m_stringLength  = 0;
   m_allocatedSize = 0;
@@ -125,6 +127,7 @@ CNxString::CNxString(FAR const char *text)
 
 CNxString::CNxString(const nxwidget_char_t text)
 {
+  m_storage       = (FAR nxwidget_char_t *)NULL;
   m_text          = (FAR nxwidget_char_t *)NULL;
   m_stringLength  = 0;
   m_allocatedSize = 0;
@@ -135,6 +138,7 @@ CNxString::CNxString(const nxwidget_char_t text)
 
 CNxString::CNxString(const CNxString &string)
 {
+  m_storage       = (FAR nxwidget_char_t *)NULL;
   m_text          = (FAR nxwidget_char_t *)NULL;
   m_stringLength  = 0;
   m_allocatedSize = 0;
@@ -308,84 +312,33 @@ void CNxString::insert(const CNxString &text, int index)
       return;
     }
 
-  // Get the total size of the string that we need
+  // Ensure we've got enough memory available.  This may move the existing
+  // text but preserves its content
 
   int newLength = m_stringLength + text.getLength();
-  int newSize   = newLength * sizeof(nxwidget_char_t);
+  allocateMemory(newLength, true);
 
-  // Reallocate memory if the existing memory isn't large enough
+  // Make space in string for insert
 
-  if (m_allocatedSize < newSize)
-    {
-      int allocLength = newLength + m_growAmount;
-
-      // Allocate new string large enough to contain additional data
-
-      FAR nxwidget_char_t *newText = new nxwidget_char_t[allocLength];
-
-      // Copy the start of the existing text to the newly allocated string
-
-      FAR nxwidget_char_t       *dest = newText;
-      FAR const nxwidget_char_t *src  = m_text;
-
-      for (int i = 0; i < index; i++)
-        {
-          *dest++ = *src++;
-        }
-
-      // Insert the additional text into the new string
-
-      src = text.getCharArray();
-
-      for (unsigned int i = 0; i < text.getLength(); i++)
-        {
-          *dest++ = *src++;
-        }
-
-      // Copy the end of the existing text the the newly allocated string
-
-      src = &m_text[index];
-
-      for (int i = index; i < m_stringLength; i++)
-        {
-          *dest++ = *src++;
-        }
-
-      m_allocatedSize = allocLength * sizeof(nxwidget_char_t);
-
-      // Delete existing string
+  FAR nxwidget_char_t       *dest = &m_text[newLength - 1];
+  FAR const nxwidget_char_t *src  = &m_text[m_stringLength - 1];
 
-      delete[] m_text;
-
-      // Swap pointers
-
-      m_stringLength = newLength;
-      m_text         = newText;
-    }
-  else
+  for (int i = 0; i < m_stringLength - index; i++)
     {
-      // Existing size is large enough, so make space in string for insert
-
-      FAR nxwidget_char_t       *dest = &m_text[newLength - 1];
-      FAR const nxwidget_char_t *src  = &m_text[m_stringLength - 1];
-
-      for (int i = 0; i < m_stringLength - index; i++)
-        {
-          *dest-- = *src--;
-        }
-
-      // Insert the additional text into the new string
+      *dest-- = *src--;
+    }
 
-      dest = &m_text[index];
-      src  = text.getCharArray();
+  // Insert the additional text into the new string
 
-      for (unsigned int i = 0; i < text.getLength(); i++)
-        {
-          *dest++ = *src++;
-        }
+  dest = &m_text[index];
+  src  = text.getCharArray();
 
-      m_stringLength = newLength;
+  for (unsigned int i = 0; i < text.getLength(); i++)
+    {
+      *dest++ = *src++;
     }
+
+  m_stringLength = newLength;
 }
 
 /**
@@ -404,9 +357,14 @@ void CNxString::remove(const int startIndex)
     }
 
   // Removing characters from the end of the string is trivial - simply
-  // decrease the length
+  // decrease the length.  If nothing remains, reclaim any space trimmed
+  // from the front as well.
 
   m_stringLength  = startIndex;
+  if (m_stringLength == 0)
+    {
+      m_text = m_storage;
+    }
 }
 
 /**
@@ -435,21 +393,24 @@ void CNxString::remove(const int startIndex, const int count)
       return;
     }
 
-  // Copy characters from a point after the area to be deleted into the space created
-  // by the deletion
+  // Close the gap by moving whichever side of it is shorter.  Removing
+  // characters from the front of the string just advances the start of the
+  // text and does not copy anything.
 
-  FAR nxwidget_char_t       *dest = &m_text[startIndex];
-  FAR const nxwidget_char_t *src  = &m_text[endIndex];
-
-  for (int i = m_stringLength - endIndex; i > 0; i--)
+  if (startIndex < m_stringLength - endIndex)
     {
-      *dest++ = *src++;
+      memmove(&m_text[count], m_text, sizeof(nxwidget_char_t) * startIndex);
+      m_text += count;
+    }
+  else
+    {
+      memmove(&m_text[startIndex], &m_text[endIndex],
+              sizeof(nxwidget_char_t) * (m_stringLength - endIndex));
     }
 
   // Decrease length
 
   m_stringLength -= count;
-
 }
 
 /**
@@ -741,42 +702,72 @@ int CNxString::compareTo(const CNxString &string) const
 
 void CNxString::allocateMemory(int nChars, bool preserve)
 {
-  // This is the size of the allocation that we need
+  // This is the space available after the start of the text and in the
+  // whole allocation
+
+  int capacity  = m_allocatedSize / sizeof(nxwidget_char_t);
+  int offset    = m_text - m_storage;
+
+  // Do we already have enough memory after the start of the text?  If so, we
+  // can avoid deallocating and allocating new memory by re-using the old
+
+  if (nChars <= capacity - offset)
+    {
+      return;
+    }
 
-  int nBytesNeeded = nChars * sizeof(nxwidget_char_t);
+  // Characters have been trimmed from the front of the string.  Slide the
+  // text back to the start of the allocation if that leaves at least as
+  // much free space as text; sliding any sooner would make a string that
+  // is trimmed at the front and appended at the end copy itself on every
+  // append.
 
-  // Do we already have enough memory allocated to contain this new size?
-  // If so, we can avoid deallocating and allocating new memory by re-using the old
+  if (!preserve && nChars <= capacity)
+    {
+      m_text = m_storage;
+      return;
+    }
 
-  if (nBytesNeeded > m_allocatedSize)
+  if (preserve && 2 * nChars <= capacity)
     {
-      // Not enough space in existing memory; allocate new memory
+      memmove(m_storage, m_text, sizeof(nxwidget_char_t) * m_stringLength);
+      m_text = m_storage;
+      return;
+    }
+
+  // Not enough space in existing memory; allocate new memory.  Grow
+  // geometrically so that repeated appends are amortized constant time
 
-      int allocChars = nChars + m_growAmount;
-      nxwidget_char_t *newText = new nxwidget_char_t[allocChars];
+  int allocChars = nChars + m_growAmount;
+  if (allocChars < 2 * capacity)
+    {
+      allocChars = 2 * capacity;
+    }
 
-      // Free old memory if necessary
+  nxwidget_char_t *newText = new nxwidget_char_t[allocChars];
 
-      if (m_text != NULL)
-        {
-          // Preserve existing data if required
+  // Free old memory if necessary
 
-          if (preserve)
-            {
-              memcpy(newText, m_text, sizeof(nxwidget_char_t) * m_stringLength);
-            }
+  if (m_storage != NULL)
+    {
+      // Preserve existing data if required
 
-          delete[] m_text;
+      if (preserve)
+        {
+          memcpy(newText, m_text, sizeof(nxwidget_char_t) * m_stringLength);
         }
 
-      // Set pointer to new memory
+      delete[] m_storage;
+    }
+
+  // Set pointer to new memory
 
-      m_text = newText;
+  m_storage = newText;
+  m_text    = newText;
 
-      // Remember how much memory we've allocated.
+  // Remember how much memory we've allocated.
 
-      m_allocatedSize = allocChars * sizeof(nxwidget_char_t);
-    }
+  m_allocatedSize = allocChars * sizeof(nxwidget_char_t);
 }
 
 /**
@@ -83,6 +83,7 @@
 #include "graphics/nxwidgets/cwidgetstyle.hxx"
 #include "graphics/nxwidgets/cwidgeteventargs.hxx"
 #include "graphics/nxwidgets/cwidgetcontrol.hxx"
+#include "graphics/nxwidgets/chitindex.hxx"
 #include "graphics/nxwidgets/singletons.hxx"
 
 /****************************************************************************
@@ -178,6 +179,7 @@ CNxWidget::CNxWidget(CWidgetControl *pWidgetControl,
 
   m_parent                = (CNxWidget *)NULL;
   m_focusedChild          = (CNxWidget *)NULL;
+  m_hitIndex              = (CHitIndex *)NULL;
 
   // Double-click
 
@@ -234,6 +236,7 @@ CNxWidget::~CNxWidget(void)
   // widget.  It persists until the window is closed.
 
   delete m_widgetEventHandlers;
+  delete m_hitIndex;
 }
 
 /**
@@ -503,6 +506,126 @@ void CNxWidget::redraw(void)
     }
 }
 
+/**
+ * Add the area of this widget to the window's damage region.
+ */
+
+void CNxWidget::invalidate(void)
+{
+  CRect rect(getX(), getY(), getWidth(), getHeight());
+  m_widgetControl->invalidate(rect);
+}
+
+/**
+ * Redraw the parts of the widget and its children that fall within a
+ * damaged region.
+ *
+ * @param damage The window-relative damaged region.
+ */
+
+void CNxWidget::redrawDamaged(FAR const struct nxgl_rect_s *damage)
+{
+  if (!isDrawingEnabled())
+    {
+      return;
+    }
+
+  // Limit the damaged region to the area of this widget
+
+  struct nxgl_rect_s bounds;
+  bounds.pt1.x = getX();
+  bounds.pt1.y = getY();
+  bounds.pt2.x = bounds.pt1.x + getWidth() - 1;
+  bounds.pt2.y = bounds.pt1.y + getHeight() - 1;
+
+  struct nxgl_rect_s region;
+  nxgl_rectintersect(&region, &bounds, damage);
+  if (nxgl_nullrect(&region))
+    {
+      return;
+    }
+
+  // Draw the widget with the graphics port clipped to the region, keeping
+  // any clipping already applied by the parent.
+
+  CGraphicsPort *port = m_widgetControl->getGraphicsPort();
+
+  struct nxgl_rect_s saved;
+  bool wasClipped = port->getClipRect(&saved);
+  port->setClipRect(&region);
+
+  drawBorder(port);
+  drawContents(port);
+
+  // Remember that the widget is no longer erased
+
+  m_flags.erased = false;
+
+  // Draw the children that overlap the region.  Children are drawn in
+  // z-order, so a child can be skipped when any later sibling hides it.
+
+  for (int i = 0; i < m_children.size(); i++)
+    {
+      CNxWidget *child = m_children[i];
+
+      struct nxgl_rect_s childRect;
+      childRect.pt1.x = child->getX();
+      childRect.pt1.y = child->getY();
+      childRect.pt2.x = childRect.pt1.x + child->getWidth() - 1;
+      childRect.pt2.y = childRect.pt1.y + child->getHeight() - 1;
+
+      struct nxgl_rect_s visible;
+      nxgl_rectintersect(&visible, &childRect, &region);
+      if (nxgl_nullrect(&visible))
+        {
+          continue;
+        }
+
+      bool covered = false;
+      for (int j = i + 1; j < m_children.size() && !covered; j++)
+        {
+          covered = m_children[j]->coversRect(&visible);
+        }
+
+      if (!covered)
+        {
+          child->redrawDamaged(&region);
+        }
+    }
+
+  // Restore the clipping rectangle
+
+  if (wasClipped)
+    {
+      port->setClipRect(&saved);
+    }
+  else
+    {
+      port->clearClipRect();
+    }
+}
+
+/**
+ * Test if the widget is drawn and completely covers a region.
+ *
+ * @param rect The window-relative region to test.
+ * @return True if nothing beneath the widget is visible in the region.
+ */
+
+bool CNxWidget::coversRect(FAR const struct nxgl_rect_s *rect) const
+{
+  if (!isDrawingEnabled())
+    {
+      return false;
+    }
+
+  nxgl_coord_t x = getX();
+  nxgl_coord_t y = getY();
+
+  return rect->pt1.x >= x && rect->pt2.x < x + getWidth() &&
+         rect->pt1.y >= y && rect->pt2.y < y + getHeight();
+}
+
 /**
  * Enables the widget.
  *
@@ -643,12 +766,9 @@ bool CNxWidget::click(nxgl_coord_t x, nxgl_coord_t y)
 
   // Work out which child was clicked
 
-  for (int i = m_children.size() - 1; i > -1; i--)
+  if (clickChildren(x, y))
     {
-      if (m_children[i]->click(x, y))
-        {
-          return true;
-        }
+      return true;
     }
 
   // Handle clicks on this
@@ -728,12 +848,9 @@ bool CNxWidget::doubleClick(nxgl_coord_t x, nxgl_coord_t y)
   // in case the second click has fallen on a different
   // child to the first.
 
-  for (int i = m_children.size() - 1; i > -1; i--)
+  if (clickChildren(x, y))
     {
-      if (m_children[i]->click(x, y))
-        {
-          return true;
-        }
+      return true;
     }
 
   m_flags.clicked = true;
@@ -1059,6 +1176,7 @@ bool CNxWidget::moveTo(nxgl_coord_t x, nxgl_coord_t y)
 
       m_rect.setX(x);
       m_rect.setY(y);
+      hitAreaChanged();
 
       redraw();
       m_widgetEventHandlers->raiseMoveEvent(x, y, x - oldX, y - oldY);
@@ -1118,6 +1236,7 @@ bool CNxWidget::resize(nxgl_coord_t width, nxgl_coord_t height)
 
       m_rect.setWidth(width);
       m_rect.setHeight(height);
+      hitAreaChanged();
 
       onResize(width, height);
 
@@ -1180,6 +1299,7 @@ void CNxWidget::moveChildToDeleteQueue(CNxWidget *widget)
           // Remove widget from main vector
 
           m_children.erase(i);
+          widget->hitAreaChanged();
           break;
         }
     }
@@ -1296,6 +1416,7 @@ void CNxWidget::addWidget(CNxWidget *widget)
     {
       widget->setParent(this);
       m_children.push_back(widget);
+      widget->hitAreaChanged();
 
       // Should the widget steal the focus?
 
@@ -1324,6 +1445,7 @@ void CNxWidget::insertWidget(CNxWidget *widget)
     {
       widget->setParent(this);
       m_children.insert(0, widget);
+      widget->hitAreaChanged();
 
       widget->enableDrawing();
       widget->redraw();
@@ -1379,6 +1501,7 @@ bool CNxWidget::removeChild(CNxWidget *widget)
 
   // Divorce child from parent
 
+  widget->hitAreaChanged();
   widget->setParent((CNxWidget *)NULL);
   widget->disableDrawing();
 
@@ -1532,6 +1655,75 @@ void CNxWidget::closeChild(CNxWidget *widget)
   moveChildToDeleteQueue(widget);
 }
 
+/**
+ * Pass a click to the topmost child widget that accepts it.  With
+ * many children, only the children that the hit index places under
+ * the click are tried.
+ *
+ * @param x The x coordinate of the click.
+ * @param y The y coordinate of the click.
+ * @return True if a child accepted the click.
+ */
+
+bool CNxWidget::clickChildren(nxgl_coord_t x, nxgl_coord_t y)
+{
+  if (m_children.size() >= CONFIG_NXWIDGETS_HITINDEX_MINWIDGETS)
+    {
+      if (m_hitIndex == (CHitIndex *)NULL)
+        {
+          m_hitIndex = new CHitIndex();
+        }
+
+      // The index holds the children's positions relative to this widget
+
+      if (m_hitIndex != (CHitIndex *)NULL &&
+          (m_hitIndex->isValid() || m_hitIndex->build(m_children, false)))
+        {
+          FAR const uint16_t *entries;
+          int count = m_hitIndex->lookup(x - getX(), y - getY(), entries);
+
+          for (int i = count - 1; i > -1; i--)
+            {
+              if (entries[i] < m_children.size() &&
+                  m_children[entries[i]]->click(x, y))
+                {
+                  return true;
+                }
+            }
+
+          return false;
+        }
+    }
+
+  for (int i = m_children.size() - 1; i > -1; i--)
+    {
+      if (m_children[i]->click(x, y))
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+
+/**
+ * Notify the parent and the controlling widget that the area covered
+ * by this widget has changed, so their hit indexes are out of date.
+ */
+
+void CNxWidget::hitAreaChanged(void)
+{
+  // Moving a widget also moves its children, so the window coordinates
+  // of every widget in the control may have changed
+
+  m_widgetControl->invalidateHitIndex();
+
+  if (m_parent != (CNxWidget *)NULL && m_parent->m_hitIndex != (CHitIndex *)NULL)
+    {
+      m_parent->m_hitIndex->invalidate();
+    }
+}
+
 /**
  * Notify this widget that it is being dragged, and set its drag point.
  *
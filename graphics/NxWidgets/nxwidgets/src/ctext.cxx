@@ -83,6 +83,52 @@
  * Pre-Processor Definitions
  ****************************************************************************/
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/**
+ * Resize a run of entries in an array, moving the entries that follow it.
+ * The contents of the resized run are undefined.
+ *
+ * @param array The array to modify.
+ * @param index The index of the first entry in the run.
+ * @param oldCount The current number of entries in the run.
+ * @param newCount The required number of entries in the run.
+ */
+
+template <class T>
+static void resizeRun(TNxArray<T> &array, int index,
+                      int oldCount, int newCount)
+{
+  int tail = array.size() - (index + oldCount);
+
+  if (newCount > oldCount)
+    {
+      for (int i = oldCount; i < newCount; i++)
+        {
+          array.push_back(T());
+        }
+
+      for (int i = tail - 1; i >= 0; i--)
+        {
+          array[index + newCount + i] = array[index + oldCount + i];
+        }
+    }
+  else if (newCount < oldCount)
+    {
+      for (int i = 0; i < tail; i++)
+        {
+          array[index + newCount + i] = array[index + oldCount + i];
+        }
+
+      for (int i = newCount; i < oldCount; i++)
+        {
+          array.pop_back();
+        }
+    }
+}
+
 /****************************************************************************
  * Method Implementations
  ****************************************************************************/
@@ -103,6 +149,8 @@ CText::CText(CNxFont *font, const CNxString &text, nxgl_coord_t width)
   m_font        = font;
   m_width       = width;
   m_lineSpacing = 1;
+  m_firstLine   = 0;
+  m_firstChar   = 0;
   wrap();
 }
 
@@ -150,8 +198,9 @@ void CText::setText(const nxwidget_char_t text)
 
 void CText::append(const CNxString &text)
 {
+  int oldLength = getLength();
   CNxString::append(text);
-  wrap(getLength() - 1);
+  rewrap(oldLength, getLength() - oldLength);
 }
 
 /**
@@ -163,8 +212,9 @@ void CText::append(const CNxString &text)
 
 void CText::insert(const CNxString &text, const int index)
 {
+  int oldLength = getLength();
   CNxString::insert(text, index);
-  wrap(index);
+  rewrap(index < oldLength ? index : oldLength, getLength() - oldLength);
 }
 
 /**
@@ -188,8 +238,9 @@ void CText::remove(const int startIndex)
 
 void CText::remove(const int startIndex, const int count)
 {
+  int oldLength = getLength();
   CNxString::remove(startIndex, count);
-  wrap(startIndex);
+  rewrap(startIndex, getLength() - oldLength);
 }
 
 
@@ -241,10 +292,10 @@ const int CText::getLineLength(const int lineNumber) const
 {
   if (lineNumber < getLineCount() - 1)
     {
-      return m_linePositions[lineNumber + 1] - m_linePositions[lineNumber];
+      return getLineStartIndex(lineNumber + 1) - getLineStartIndex(lineNumber);
     }
 
-  return getLength() - m_linePositions[lineNumber];
+  return getLength() - getLineStartIndex(lineNumber);
 }
 
 /**
@@ -265,7 +316,7 @@ const int CText::getLineTrimmedLength(const int lineNumber) const
 
   // Get char at the end of the line
 
-  if (iterator->moveTo(m_linePositions[lineNumber] + length - 1))
+  if (iterator->moveTo(getLineStartIndex(lineNumber) + length - 1))
     {
       do
         {
@@ -314,6 +365,27 @@ const nxgl_coord_t CText::getLineTrimmedPixelLength(const int lineNumber) const
                                 getLineTrimmedLength(lineNumber));
 }
 
+/**
+ * Get the width of the longest line in pixels.
+ *
+ * @return The width of the longest line.
+ */
+
+const nxgl_coord_t CText::getPixelWidth(void) const
+{
+  nxgl_coord_t width = 0;
+
+  for (int i = m_firstLine; i < m_lineWidths.size(); i++)
+    {
+      if (m_lineWidths[i] > width)
+        {
+          width = m_lineWidths[i];
+        }
+    }
+
+  return width;
+}
+
 /**
  * Get a pointer to the CText object's font.
  *
@@ -326,29 +398,50 @@ CNxFont *CText::getFont(void) const
 }
 
 /**
- * Removes lines of text from the start of the text buffer.
+ * Removes lines of text from the start of the text buffer.  The remaining
+ * lines are not re-wrapped.
  *
  * @param lines Number of lines to remove
  */
 
 void CText::stripTopLines(const int lines)
 {
-  // Get the start point of the text we want to keep
+  if (lines <= 0)
+    {
+      return;
+    }
 
-  nxgl_coord_t textStart = 0;
+  // Stripping every line just leaves an empty string
 
-  for (int i = 0; i < lines; i++)
+  if (lines >= getLineCount())
     {
-      textStart += getLineLength(i);
+      CNxString::remove(0);
+      wrap();
+      return;
     }
 
-  // Remove the characters from the start of the string to the found location
+  // Get the start point of the text we want to keep and remove the
+  // characters before it.  This does not copy the remaining text.
 
-  remove(0, textStart);
+  int textStart = getLineStartIndex(lines);
+  CNxString::remove(0, textStart);
 
-  // Rewrap the text
+  // The line breaks after that point do not change.  Drop the stripped
+  // lines from the front of the line arrays and offset the remaining
+  // positions by the number of chars removed.
 
-  wrap();
+  m_firstLine += lines;
+  m_firstChar += textStart;
+
+  // Reclaim the stripped entries once they outnumber the live ones, so the
+  // cost of the copy is spread over the lines stripped
+
+  if (m_firstLine > getLineCount())
+    {
+      compactLines();
+    }
+
+  updatePixelHeight();
 }
 
 /**
@@ -369,14 +462,9 @@ void CText::wrap(void)
 
 void CText::wrap(int charIndex)
 {
-  // Declare vars in advance of loop
-
   int pos = 0;
-  int lineWidth;
-  int breakIndex;
-  bool endReached = false;
 
-  if (m_linePositions.size() == 0)
+  if (getLineCount() <= 0)
     {
       charIndex = 0;
     }
@@ -386,64 +474,36 @@ void CText::wrap(int charIndex)
 
   if (charIndex > 0)
     {
-      // Remove wrapping data past this point
-
       // Get the index of the line in which the char index appears
 
       int lineIndex = getLineContainingCharIndex(charIndex);
 
-      // Remove any longest line records that occur from the line index onwards
+      // Remove any wrapping data from this line index onwards, except for
+      // the start of the line itself
 
-      while ((m_longestLines.size() > 0) &&
-             (m_longestLines[m_longestLines.size() - 1].index >= lineIndex))
+      while (m_linePositions.size() > m_firstLine + lineIndex + 1)
         {
-          m_longestLines.pop_back();
+          m_linePositions.pop_back();
         }
 
-      // If there are any longest line records remaining, update the text pixel width
-      // The last longest line record will always be the last valid longest line as
-      // the vector is sorted by length
-
-      if (m_longestLines.size() > 0)
+      while (m_lineWidths.size() > m_firstLine + lineIndex)
         {
-          m_textPixelWidth = m_longestLines[m_longestLines.size() - 1].width;
-        }
-      else
-        {
-          m_textPixelWidth = 0;
-        }
-
-      // Remove any wrapping data from after this line index onwards
-
-      while ((m_linePositions.size() > 0) &&
-             (m_linePositions.size() - 1 > (int)lineIndex))
-       {
-          m_linePositions.pop_back();
+          m_lineWidths.pop_back();
         }
 
       // Adjust start position of wrapping loop so that it starts with
       // the current line index
 
-      if (m_linePositions.size() > 0)
-        {
-          pos = m_linePositions[m_linePositions.size() - 1];
-        }
+      pos = getLineStartIndex(lineIndex);
     }
   else
     {
       // Remove all wrapping data
 
-      // Wipe the width variable
-
-      m_textPixelWidth = 0;
-
-      // Empty existing longest lines
-
-      m_longestLines.clear();
-
-      // Empty existing line positions
-
       m_linePositions.clear();
+      m_lineWidths.clear();
+      m_firstLine = 0;
+      m_firstChar = 0;
 
       // Push first line start into vector
 
@@ -453,140 +513,284 @@ void CText::wrap(int charIndex)
   // Loop through string until the end
 
   CStringIterator *iterator = newStringIterator();
+  nxgl_coord_t lineWidth;
 
-  while (!endReached)
+  for (; ; )
     {
-      breakIndex = 0;
-      lineWidth = 0;
+      int next = findLineEnd(iterator, pos, lineWidth);
+      m_lineWidths.push_back(lineWidth);
 
-      if (iterator->moveTo(pos))
+      if (next < 0)
         {
-          // Search for line breaks and valid breakpoints until we
-          // exceed the width of the text field or we run out of
-          // string to process
-
-          while (lineWidth + m_font->getCharWidth(iterator->getChar()) <= m_width)
-            {
-              lineWidth += m_font->getCharWidth(iterator->getChar());
-
-              // Check for line return
-
-              if (iterator->getChar() == '\n')
-                {
-                  // Remember this breakpoint
-
-                  breakIndex = iterator->getIndex();
-                  break;
-                }
-              else if ((iterator->getChar() == ' ') ||
-                       (iterator->getChar() == ',') ||
-                       (iterator->getChar() == '.') ||
-                       (iterator->getChar() == '-') ||
-                       (iterator->getChar() == ':') ||
-                       (iterator->getChar() == ';') ||
-                       (iterator->getChar() == '?') ||
-                       (iterator->getChar() == '!') ||
-                       (iterator->getChar() == '+') ||
-                       (iterator->getChar() == '=') ||
-                       (iterator->getChar() == '/') ||
-                       (iterator->getChar() == '\0'))
-                {
-                  // Remember the most recent breakpoint
-
-                  breakIndex = iterator->getIndex();
-                }
-
-              // Move to the next character
-
-              if (!iterator->moveToNext())
-                {
-                  // No more text; abort loop
-
-                  endReached = true;
-                  break;
-                }
-            }
+          break;
         }
-      else
+
+      // Add the start of the next line to the vector
+
+      m_linePositions.push_back(next + m_firstChar);
+      pos = next;
+    }
+
+  delete iterator;
+
+  // Add marker indicating end of text
+
+  m_linePositions.push_back(getLength() + m_firstChar);
+
+  updatePixelHeight();
+}
+
+/**
+ * Re-wrap the text after an insertion or removal.  Wrapping starts
+ * with the line before the edit and stops as soon as a new line starts
+ * at the same place as an old line after the edit; the remaining line
+ * positions are adjusted by the change in length.
+ *
+ * @param charIndex The index of the first changed char.
+ * @param delta The number of chars inserted (positive) or removed
+ * (negative).
+ */
+
+void CText::rewrap(int charIndex, int delta)
+{
+  int oldCount = getLineCount();
+
+  if (oldCount <= 0 || charIndex <= 0)
+    {
+      wrap();
+      return;
+    }
+
+  // Start with the line before the one containing the edit; removing text
+  // at the start of a line may let its first word move up a line.  The line
+  // data still describes the text as it was before the edit, which is the
+  // same up to charIndex.
+
+  int first = getLineContainingCharIndex(charIndex);
+
+  if (first > 0)
+    {
+      first--;
+    }
+
+  // New line breaks past this char index are in the unchanged tail of the
+  // text.  If an old line started at the same place then every line from
+  // there on is unchanged apart from its position.
+
+  int unchanged = charIndex + (delta > 0 ? delta : 0);
+
+  TNxArray<int>          newPositions;
+  TNxArray<nxgl_coord_t> newWidths;
+  CStringIterator       *iterator = newStringIterator();
+  nxgl_coord_t           lineWidth;
+  int                    pos      = getLineStartIndex(first);
+  int                    oldLine  = first + 1;
+
+  for (; ; )
+    {
+      int next = findLineEnd(iterator, pos, lineWidth);
+      newWidths.push_back(lineWidth);
+
+      if (next < 0)
         {
-          endReached = true;
+          // Reached the end of the text; all old lines have been replaced
+          // and only the end of text marker remains
+
+          oldLine = oldCount;
+          break;
         }
 
-      if ((!endReached) && (iterator->getIndex() > pos))
+      if (next > unchanged)
         {
-          // Process any found data
+          // Look for an old line starting at the same char
 
-          // If we didn't find a breakpoint split at the current position
+          while (oldLine < oldCount &&
+                 getLineStartIndex(oldLine) < next - delta)
+            {
+              oldLine++;
+            }
 
-          if (breakIndex == 0)
+          if (oldLine < oldCount && getLineStartIndex(oldLine) == next - delta)
             {
-              breakIndex = iterator->getIndex() - 1;
+              break;
             }
+        }
 
-          // Trim blank space from the start of the next line
+      newPositions.push_back(next);
+      pos = next;
+    }
 
-          CStringIterator *breakIterator = newStringIterator();
+  delete iterator;
 
-          if (breakIterator->moveTo(breakIndex + 1))
-            {
-              while (breakIterator->getChar() == ' ')
-                {
-                  if (breakIterator->moveToNext())
-                    {
-                      breakIndex++;
-                    }
-                  else
-                    {
-                      break;
-                    }
-                }
-            }
+  // Replace lines first..oldLine-1 with the new lines.  The start of the
+  // first line has not changed.
 
-          delete breakIterator;
+  int newCount = newWidths.size();
+  int base     = m_firstLine + first;
 
-          // Add the start of the next line to the vector
+  resizeRun(m_lineWidths, base, oldLine - first, newCount);
+  resizeRun(m_linePositions, base + 1, oldLine - first - 1, newCount - 1);
 
-          pos = breakIndex + 1;
-          m_linePositions.push_back(pos);
+  for (int i = 0; i < newCount; i++)
+    {
+      m_lineWidths[base + i] = newWidths[i];
+    }
+
+  for (int i = 0; i < newCount - 1; i++)
+    {
+      m_linePositions[base + 1 + i] = newPositions[i] + m_firstChar;
+    }
 
-          // Is this the longest line observed so far?
+  // Move the unchanged lines and the end of text marker
 
-          if (lineWidth > m_textPixelWidth)
-            {
-              m_textPixelWidth = lineWidth;
+  for (int i = base + newCount; i < m_linePositions.size(); i++)
+    {
+      m_linePositions[i] += delta;
+    }
 
-              // Push the description of the line into the longest lines
-              // vector (note that we store the index in m_linePositions that
-              // refers to the start of the line, *not* the position of the
-              // line in the char array)
+  updatePixelHeight();
+}
 
-              LongestLine line;
-              line.index = m_linePositions.size() - 2;
-              line.width = lineWidth;
-              m_longestLines.push_back(line);
-            }
+/**
+ * Find where the line of text starting at the specified char index
+ * wraps.
+ *
+ * @param iterator Iterator over this string.
+ * @param pos The index of the first char in the line.
+ * @param lineWidth Receives the pixel width of the line.
+ * @return The index of the first char of the next line, or -1 if the
+ * line runs to the end of the text.
+ */
+
+int CText::findLineEnd(CStringIterator *iterator, int pos,
+                       nxgl_coord_t &lineWidth) const
+{
+  int breakIndex = -1;
+
+  lineWidth = 0;
+
+  if (!iterator->moveTo(pos))
+    {
+      return -1;
+    }
+
+  // Search for line breaks and valid breakpoints until we exceed the width
+  // of the text field or we run out of string to process
+
+  while (lineWidth + m_font->getCharWidth(iterator->getChar()) <= m_width)
+    {
+      lineWidth += m_font->getCharWidth(iterator->getChar());
+
+      // Check for line return
+
+      if (iterator->getChar() == '\n')
+        {
+          // Remember this breakpoint
+
+          breakIndex = iterator->getIndex();
+          break;
         }
-      else if (!endReached)
+      else if ((iterator->getChar() == ' ') ||
+               (iterator->getChar() == ',') ||
+               (iterator->getChar() == '.') ||
+               (iterator->getChar() == '-') ||
+               (iterator->getChar() == ':') ||
+               (iterator->getChar() == ';') ||
+               (iterator->getChar() == '?') ||
+               (iterator->getChar() == '!') ||
+               (iterator->getChar() == '+') ||
+               (iterator->getChar() == '=') ||
+               (iterator->getChar() == '/') ||
+               (iterator->getChar() == '\0'))
         {
-          // Add a blank row if we're not at the end of the string
+          // Remember the most recent breakpoint
 
-          pos++;
-          m_linePositions.push_back(pos);
+          breakIndex = iterator->getIndex();
+        }
+
+      // Move to the next character
+
+      if (!iterator->moveToNext())
+        {
+          // No more text; this is the last line
+
+          return -1;
         }
     }
 
-  // Add marker indicating end of text
-  // If we reached the end of the text, append the stopping point
+  if (iterator->getIndex() == pos)
+    {
+      // The first char is too wide to fit; give it a row of its own
+
+      return pos + 1;
+    }
 
-  if ((unsigned int)m_linePositions[m_linePositions.size() - 1] != getLength() + 1)
+  // If we didn't find a breakpoint split at the current position
+
+  if (breakIndex < 0)
     {
-      m_linePositions.push_back(getLength());
+      breakIndex = iterator->getIndex() - 1;
     }
 
-  delete iterator;
+  // Trim blank space from the start of the next line
 
-  // Calculate the total height of the text
+  if (iterator->moveTo(breakIndex + 1))
+    {
+      while (iterator->getChar() == ' ')
+        {
+          if (iterator->moveToNext())
+            {
+              breakIndex++;
+            }
+          else
+            {
+              break;
+            }
+        }
+    }
+
+  return breakIndex + 1;
+}
+
+/**
+ * Move the live line data to the start of the line arrays, discarding
+ * the entries of any stripped lines.
+ */
+
+void CText::compactLines(void)
+{
+  int count = m_linePositions.size() - m_firstLine;
+
+  for (int i = 0; i < count; i++)
+    {
+      m_linePositions[i] = m_linePositions[m_firstLine + i] - m_firstChar;
+    }
+
+  for (int i = 0; i < count - 1; i++)
+    {
+      m_lineWidths[i] = m_lineWidths[m_firstLine + i];
+    }
+
+  while (m_linePositions.size() > count)
+    {
+      m_linePositions.pop_back();
+    }
+
+  while (m_lineWidths.size() > count - 1)
+    {
+      m_lineWidths.pop_back();
+    }
+
+  m_firstLine = 0;
+  m_firstChar = 0;
+}
+
+/**
+ * Recalculate the total height of the text.
+ */
 
+void CText::updatePixelHeight(void)
+{
   m_textPixelHeight = getLineCount() * (m_font->getHeight() + m_lineSpacing);
 
   // Ensure height is always at least one row
@@ -610,69 +814,31 @@ const int CText::getLineContainingCharIndex(const int index) const
 {
   // Early exit if there is no existing line data
 
-  if (m_linePositions.size() == 0)
+  if (getLineCount() <= 0)
     {
       return 0;
     }
 
-  // Early exit if the character is in the last row
-
-  if (index >= m_linePositions[m_linePositions.size() - 2])
-    {
-      return m_linePositions.size() - 2;
-    }
-
-  // Binary search the line vector for the line containing the supplied index
+  // Binary search the line starts for the last line that starts at or
+  // before the index.  The index we're looking for can be within a line;
+  // it isn't necessarily the start of a line.
 
   int bottom = 0;
-  int top = m_linePositions.size() - 1;
-  int mid;
+  int top    = getLineCount() - 1;
 
-  while (bottom <= top)
+  while (bottom < top)
     {
-      // Standard binary search
-
-      mid = (bottom + top) >> 1;
+      int mid = (bottom + top + 1) >> 1;
 
-      if (index < m_linePositions[mid])
+      if (getLineStartIndex(mid) <= index)
         {
-          // Index is somewhere in the lower search space
-
-          top = mid - 1;
-        }
-      else if (index > m_linePositions[mid])
-        {
-          // Index is somewhere in the upper search space
-
-          bottom = mid + 1;
+          bottom = mid;
         }
-      else if (index == m_linePositions[mid])
-        {
-          // Located the index
-
-          return mid;
-        }
-
-      // Check to see if we've moved past the line that contains the index
-      // We have to do this because the index we're looking for can be within
-      // a line; it isn't necessarily the start of a line (which is what is
-      // stored in the m_linePositions vector)
-
-      if (index > m_linePositions[top])
-        {
-          // Search index falls within the line represented by the top position
-
-          return top;
-        }
-      else if (index < m_linePositions[bottom])
+      else
         {
-          // Search index falls within the line represented by the bottom position
-
-          return bottom - 1;
+          top = mid - 1;
         }
     }
 
-  // Line cannot be found
-
-  return 0;
+  return bottom;
 }
@@ -65,6 +65,20 @@
 
 using namespace NXWidgets;
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/**
+ * Return the number of pixels in a rectangle.
+ */
+
+static inline uint32_t rectArea(FAR const struct nxgl_rect_s *rect)
+{
+  return (uint32_t)(rect->pt2.x - rect->pt1.x + 1) *
+         (uint32_t)(rect->pt2.y - rect->pt1.y + 1);
+}
+
 /****************************************************************************
  * Method Implementations
  ****************************************************************************/
@@ -106,6 +120,7 @@ CWidgetControl::CWidgetControl(FAR const CWidgetStyle *style)
 #endif
   m_nCh                = 0;
   m_nCc                = 0;
+  m_nDamage            = 0;
 
   // Intialize semaphores:
   //
@@ -230,6 +245,7 @@ void CWidgetControl::postWindowEvent(void)
  *   pollMouseEvents(widget)
  *   pollKeyboardEvents()
  *   pollCursorControlEvents()
+ *   redrawDamage()
  *
  * @param widget.  Specific widget to poll.  Use NULL to run the
  *    all widgets in the window.
@@ -253,7 +269,104 @@ bool CWidgetControl::pollEvents(CNxWidget *widget)
   // Handle cursor control input
 
   bool cursorControlEvent = pollCursorControlEvents();
-  return mouseEvent || keyboardEvent || cursorControlEvent;
+
+  // Redraw whatever was damaged by the events above (or since the last
+  // poll)
+
+  bool redrawn = redrawDamage();
+  return mouseEvent || keyboardEvent || cursorControlEvent || redrawn;
+}
+
+/**
+ * Mark a region of the window as needing to be redrawn.  Nothing is
+ * drawn until redrawDamage() is called.
+ *
+ * @param rect The window-relative region to redraw.
+ */
+
+void CWidgetControl::invalidate(const CRect &rect)
+{
+  struct nxgl_rect_s nxRect;
+  rect.getNxRect(&nxRect);
+
+  sched_lock();
+  addDamage(&nxRect);
+  sched_unlock();
+}
+
+/**
+ * Redraw every damaged region.  Only the widgets that overlap a region
+ * are redrawn, clipped to that region, and widgets that are completely
+ * hidden by a later widget are skipped.
+ *
+ * @return True if anything was redrawn.
+ */
+
+bool CWidgetControl::redrawDamage(void)
+{
+  if (m_nDamage == 0 || !m_port)
+    {
+      return false;
+    }
+
+  // Take a copy of the damage list so that redraw events received while
+  // drawing are kept for the next pass
+
+  struct nxgl_rect_s damage[CONFIG_NXWIDGETS_DAMAGE_NRECTS];
+  int nDamage;
+
+  sched_lock();
+  nDamage = m_nDamage;
+  memcpy(damage, m_damage, nDamage * sizeof(struct nxgl_rect_s));
+  m_nDamage = 0;
+  sched_unlock();
+
+  // Redraw the top level widgets (children are handled by their parents)
+  // in z-order.
+
+  for (int i = 0; i < nDamage; i++)
+    {
+      for (int j = 0; j < m_widgets.size(); j++)
+        {
+          CNxWidget *widget = m_widgets[j];
+          if (widget->getParent() != (CNxWidget *)NULL)
+            {
+              continue;
+            }
+
+          // Skip the widget if a later top level widget hides all of the
+          // damaged part of it
+
+          struct nxgl_rect_s bounds;
+          bounds.pt1.x = widget->getX();
+          bounds.pt1.y = widget->getY();
+          bounds.pt2.x = bounds.pt1.x + widget->getWidth() - 1;
+          bounds.pt2.y = bounds.pt1.y + widget->getHeight() - 1;
+
+          struct nxgl_rect_s visible;
+          nxgl_rectintersect(&visible, &bounds, &damage[i]);
+          if (nxgl_nullrect(&visible))
+            {
+              continue;
+            }
+
+          bool covered = false;
+          for (int k = j + 1; k < m_widgets.size() && !covered; k++)
+            {
+              if (m_widgets[k]->getParent() == (CNxWidget *)NULL)
+                {
+                  covered = m_widgets[k]->coversRect(&visible);
+                }
+            }
+
+          if (!covered)
+            {
+              widget->redrawDamaged(&damage[i]);
+            }
+        }
+    }
+
+  return true;
 }
 
 /**
@@ -290,6 +403,7 @@ void CWidgetControl::removeControlledWidget(CNxWidget *widget)
   if (index >= 0)
     {
       m_widgets.erase(index);
+      m_hitIndex.invalidate();
     }
 }
 
@@ -433,10 +547,23 @@ void CWidgetControl::geometryEvent(NXHANDLE hWindow,
 
 void CWidgetControl::redrawEvent(FAR const struct nxgl_rect_s *nxRect, bool more)
 {
-  // REVISIT.  This is not not yet used and not fully implemented.
-  CRect rect;
-  rect.setNxRect(nxRect);
-  m_eventHandlers.raiseRedrawEvent();
+  // Accumulate the exposed region.  It is redrawn on the next call to
+  // pollEvents() (or redrawDamage()) on the widget thread.
+
+  sched_lock();
+  addDamage(nxRect);
+  sched_unlock();
+
+  // Notify listeners and wake up any waiting logic once the last region
+  // of the exposure has been received.
+
+  if (!more)
+    {
+      m_eventHandlers.raiseRedrawEvent();
+#ifdef CONFIG_NXWIDGET_EVENTWAIT
+      postWindowEvent();
+#endif
+    }
 }
 
 /**
@@ -747,7 +874,26 @@ void CWidgetControl::handleLeftClick(nxgl_coord_t x, nxgl_coord_t y, CNxWidget *
 
   if (widget == (CNxWidget *)NULL)
     {
-      // All widgets
+      // All widgets.  With many widgets, only try the ones that the hit
+      // index places under the click, in the same (topmost first) order.
+
+      if (m_widgets.size() >= CONFIG_NXWIDGETS_HITINDEX_MINWIDGETS &&
+          (m_hitIndex.isValid() || m_hitIndex.build(m_widgets, true)))
+        {
+          FAR const uint16_t *entries;
+          int count = m_hitIndex.lookup(x, y, entries);
+
+          for (int i = count - 1; i > -1; i--)
+            {
+              if (entries[i] < m_widgets.size() &&
+                  m_widgets[entries[i]]->click(x, y))
+                {
+                  return;
+                }
+            }
+
+          return;
+        }
 
       for (int i = m_widgets.size() - 1; i > -1; i--)
         {
@@ -765,6 +911,78 @@ void CWidgetControl::handleLeftClick(nxgl_coord_t x, nxgl_coord_t y, CNxWidget *
     }
 }
 
+/**
+ * Merge a region into the damage list.  Regions that are contained in or
+ * that are cheap to combine with an existing region are merged.  When the
+ * list is full, the region is merged with the entry whose bounding box
+ * grows the least.
+ *
+ * @param rect The window-relative region to add.
+ */
+
+void CWidgetControl::addDamage(FAR const struct nxgl_rect_s *rect)
+{
+  if (nxgl_nullrect(rect))
+    {
+      return;
+    }
+
+  struct nxgl_rect_s merged;
+  nxgl_rectcopy(&merged, rect);
+
+  // Each merge may make the result overlap other entries, so keep going
+  // until the new region no longer combines with anything.
+
+  bool changed = true;
+  while (changed)
+    {
+      changed = false;
+      for (int i = 0; i < m_nDamage; i++)
+        {
+          struct nxgl_rect_s combined;
+          nxgl_rectunion(&combined, &m_damage[i], &merged);
+
+          // Merge if the bounding box is no larger than the two regions
+          // drawn separately.  This also covers containment either way.
+
+          if (rectArea(&combined) <=
+              rectArea(&m_damage[i]) + rectArea(&merged))
+            {
+              nxgl_rectcopy(&merged, &combined);
+              m_damage[i] = m_damage[--m_nDamage];
+              changed = true;
+              break;
+            }
+        }
+    }
+
+  if (m_nDamage < CONFIG_NXWIDGETS_DAMAGE_NRECTS)
+    {
+      nxgl_rectcopy(&m_damage[m_nDamage++], &merged);
+      return;
+    }
+
+  // The list is full.  Grow the entry that needs the least extra area.
+
+  int best = 0;
+  uint32_t bestGrowth = UINT32_MAX;
+
+  for (int i = 0; i < m_nDamage; i++)
+    {
+      struct nxgl_rect_s combined;
+      nxgl_rectunion(&combined, &m_damage[i], &merged);
+
+      uint32_t growth = rectArea(&combined) - rectArea(&m_damage[i]);
+      if (growth < bestGrowth)
+        {
+          best       = i;
+          bestGrowth = growth;
+        }
+    }
+
+  nxgl_rectunion(&m_damage[best], &m_damage[best], &merged);
+}
+
 /**
  * Delete any widgets in the deletion queue.
  */
@@ -100,6 +100,16 @@
 
 #define FT80X_CMDFIFO_MASK  (FT80X_CMDFIFO_SIZE - 1)
 
+/* When the CMD FIFO is full, transfers resume once this much space (or the
+ * size of the remaining data, if smaller) has been freed.
+ */
+
+#define FT80X_CMDFIFO_MINXFER 256
+
+#ifndef CONFIG_GRAPHICS_FT80X_FIFO_POLLS
+#  define CONFIG_GRAPHICS_FT80X_FIFO_POLLS 32
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -270,13 +280,13 @@ int ft80x_ramcmd_append(int fd, FAR const void *data, size_t len);
  *   avail  - Pointer to location to return the FIFO free space
  *
  * Returned Value:
- *   The (positive) number of free bytes in RAM CMD on success.  A negated
- *   errno value is returned on any failure.
+ *   Zero (OK) on success.  A negated errno value is returned on any
+ *   failure.
  *
  ****************************************************************************/
 
-uint16_t ft80x_ramcmd_freespace(int fd, FAR uint16_t *offset,
-                                FAR uint16_t *avail);
+int ft80x_ramcmd_freespace(int fd, FAR uint16_t *offset,
+                           FAR uint16_t *avail);
 
 /****************************************************************************
  * Name: ft80x_ramcmd_waitfifoempty
@@ -211,6 +211,23 @@ int ft80x_dl_start(int fd, FAR struct ft80x_dlbuffer_s *buffer, bool coproc)
 
   if (!coproc)
     {
+      /* The co-processor may still be writing the previous display list
+       * to DL memory.  Let it finish before DL memory is written directly.
+       */
+
+      if (buffer->pending)
+        {
+          ret = ft80x_ramcmd_waitfifoempty(fd);
+          if (ret < 0)
+            {
+              ft80x_err("ERROR: ft80x_ramcmd_waitfifoempty failed: %d\n",
+                        ret);
+              return ret;
+            }
+
+          buffer->pending = false;
+        }
+
       /* 3) Reposition the VFS so that subsequent writes will be to the
        *    beginning of the hardware display list.
        */
@@ -253,7 +270,9 @@ int ft80x_dl_start(int fd, FAR struct ft80x_dlbuffer_s *buffer, bool coproc)
  *      buffer offset to zero.
  *   4) Swap to the newly created display list (DL memory case only).
  *   5) For the case of the co-processor RAM CMD, it will also wait for the
- *      FIFO to be emptied.
+ *      FIFO to be emptied.  If CONFIG_GRAPHICS_FT80X_PIPELINE is selected,
+ *      it returns without waiting so that the next display list can be
+ *      built while the co-processor executes this one.
  *
  * Input Parameters:
  *   fd     - The file descriptor of the FT80x device.  Opened by the caller
@@ -326,17 +345,24 @@ int ft80x_dl_end(int fd, FAR struct ft80x_dlbuffer_s *buffer)
     }
 
   /* 5) For the case of the co-processor RAM CMD, it will also wait for the
-   *    FIFO to be emptied.
+   *    FIFO to be emptied.  When pipelining, just remember that the
+   *    co-processor may still be busy.  There is no need to wait before
+   *    the next co-processor display list:  CMD_DLSTART will not execute
+   *    until this display list has been swapped in.
    */
 
   if (buffer->coproc)
     {
+#ifdef CONFIG_GRAPHICS_FT80X_PIPELINE
+      buffer->pending = true;
+#else
       ret = ft80x_ramcmd_waitfifoempty(fd);
       if (ret < 0)
         {
           ft80x_err("ERROR: ft80x_ramcmd_waitfifoempty failed: %d\n", ret);
           return ret;
         }
+#endif
     }
 
   return ret;
@@ -641,14 +667,17 @@ int ft80x_dl_flush(int fd, FAR struct ft80x_dlbuffer_s *buffer, bool wait)
 
   /* Write the content of the local display buffer to hardware. */
 
-  ret = ft80x_dl_append(fd, buffer, buffer->dlbuffer, buffer->dloffset);
-  if (ret < 0)
+  if (buffer->dloffset > 0)
     {
-      ft80x_err("ERROR: ft80x_dl_append failed: %d\n", ret);
-      return ret;
-    }
+      ret = ft80x_dl_append(fd, buffer, buffer->dlbuffer, buffer->dloffset);
+      if (ret < 0)
+        {
+          ft80x_err("ERROR: ft80x_dl_append failed: %d\n", ret);
+          return ret;
+        }
 
-  buffer->dloffset = 0;
+      buffer->dloffset = 0;
+    }
 
   /* For the case of the co-processor RAM CMD, it will also wait for the
    * FIFO to be emptied if wait == true.
@@ -662,6 +691,8 @@ int ft80x_dl_flush(int fd, FAR struct ft80x_dlbuffer_s *buffer, bool wait)
           ft80x_err("ERROR: ft80x_ramcmd_waitfifoempty failed: %d\n", ret);
           return ret;
         }
+
+      buffer->pending = false;
     }
 
   return OK;
@@ -51,6 +51,76 @@
 #include "graphics/ft80x.h"
 #include "ft80x.h"
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ft80x_ramcmd_waitspace
+ *
+ * Description:
+ *   Wait until at least 'needed' bytes are free in the RAM CMD FIFO.  The
+ *   FIFO read pointer is polled first so that the transfer can resume as
+ *   soon as the co-processor has consumed some commands.  If the co-
+ *   processor is busy with a long running command, then fall back to
+ *   sleeping until the FIFO is empty.
+ *
+ * Input Parameters:
+ *   fd     - The file descriptor of the FT80x device.  Opened by the caller
+ *            with write access.
+ *   needed - The number of free bytes required
+ *   offset - Pointer to location to return the write offset.
+ *   avail  - Pointer to location to return the FIFO free space
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int ft80x_ramcmd_waitspace(int fd, size_t needed,
+                                  FAR uint16_t *offset, FAR uint16_t *avail)
+{
+  int npolls;
+  int ret;
+
+  for (npolls = 0; ; npolls++)
+    {
+      /* Get the amount of free space in the FIFO. */
+
+      *avail = 0;
+      ret    = ft80x_ramcmd_freespace(fd, offset, avail);
+      if (ret < 0)
+        {
+          ft80x_err("ERROR: ft80x_ramcmd_freespace() failed: %d\n", ret);
+          return ret;
+        }
+
+      if ((size_t)*avail >= needed)
+        {
+          return OK;
+        }
+
+      /* Still not enough space.  Sleep until the co-processor catches up
+       * if it has not done so within the polling interval.
+       */
+
+      if (npolls >= CONFIG_GRAPHICS_FT80X_FIFO_POLLS)
+        {
+          ft80x_warn("WARNING: FIFO is full: %u\n", *avail);
+
+          ret = ft80x_ramcmd_waitfifoempty(fd);
+          if (ret < 0)
+            {
+              ft80x_err("ERROR: ft80x_ramcmd_waitfifoempty() failed: %d\n",
+                        ret);
+              return ret;
+            }
+
+          npolls = 0;
+        }
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -59,7 +129,9 @@
  * Name: ft80x_ramcmd_append
  *
  * Description:
- *   Append new display list data to RAM CMD
+ *   Append new display list data to RAM CMD.  The data is streamed into the
+ *   FIFO as space is freed by the co-processor;  this function does not
+ *   wait for the co-processor to execute the commands.
  *
  * Input Parameters:
  *   fd     - The file descriptor of the FT80x device.  Opened by the caller
@@ -78,6 +150,7 @@ int ft80x_ramcmd_append(int fd, FAR const void *data, size_t len)
   FAR const uint8_t *src;
   ssize_t remaining;
   size_t wrsize;
+  size_t needed;
   uint16_t offset;
   uint16_t maxsize;
   int ret;
@@ -98,46 +171,21 @@ int ft80x_ramcmd_append(int fd, FAR const void *data, size_t len)
 
       wrsize = remaining;
 
-      /* Get the amount of free space in the FIFO. */
+      /* Wait for free space in the FIFO.  Avoid trickling the data into
+       * the FIFO a few words at a time:  Wait until a reasonable amount of
+       * space has been freed.
+       */
 
-      maxsize = 0;
-      ret     = ft80x_ramcmd_freespace(fd, &offset, &maxsize);
-      if (ret < 0)
+      needed = wrsize;
+      if (needed > FT80X_CMDFIFO_MINXFER)
         {
-          ft80x_err("ERROR: ft80x_ramcmd_freespace() failed: %d\n", ret);
-          return ret;
+          needed = FT80X_CMDFIFO_MINXFER;
         }
 
-      /* If the FIFO full?
-       *
-       * REVISIT:  Will the FIFO be consumed as we generate the display
-       * list?  Is it fatal if it becomes full?  Or could we wait for space
-       * to free up.
-       */
-
-      if (maxsize == 0)
+      ret = ft80x_ramcmd_waitspace(fd, needed, &offset, &maxsize);
+      if (ret < 0)
         {
-#if 1
-          /* Yes.. wait for the FIFO to empty, then try again.
-           *
-           * REVISIT:  Would it not be sufficient to wait only until the
-           * FIFO is not full?
-           */
-
-          ft80x_warn("WARNING: FIFO is full: %d\n", ret);
-          ret = ft80x_ramcmd_waitfifoempty(fd);
-          if (ret < 0)
-            {
-              ft80x_err("ERROR: ft80x_ramcmd_waitfifoempty() failed: %d\n",
-                        ret);
-              return ret;
-            }
-
-          continue;
-#else
-          ft80x_err("ERROR: FIFO is full: %d\n", ret);
-          return -ENOSPC;
-#endif
+          return ret;
         }
 
       /* Limit the write size to the size of the available FIFO memory */
@@ -163,28 +211,18 @@ int ft80x_ramcmd_append(int fd, FAR const void *data, size_t len)
           return -errcode;
         }
 
-      /* Update the command FIFO */
+      /* Update the command FIFO.  The co-processor starts executing the
+       * new commands while the next chunk is being prepared.
+       */
 
-      ret = ft80x_putreg16(fd, FT80X_REG_CMD_WRITE, offset + wrsize);
+      ret = ft80x_putreg16(fd, FT80X_REG_CMD_WRITE,
+                           (offset + wrsize) & FT80X_CMDFIFO_MASK);
       if (ret < 0)
         {
           ft80x_err("ERROR: ft80x_putreg16() failed: %d\n", ret);
           return ret;
         }
 
-      /* Wait for the FIFO to empty */
-
-      if (remaining > wrsize)
-        {
-          ret = ft80x_ramcmd_waitfifoempty(fd);
-          if (ret < 0)
-            {
-              ft80x_err("ERROR: ft80x_ramcmd_waitfifoempty() failed: %d\n",
-                        ret);
-              return ret;
-            }
-        }
-
       /* Set up for the next time through the loop. */
 
       remaining -= wrsize;
@@ -209,13 +247,13 @@ int ft80x_ramcmd_append(int fd, FAR const void *data, size_t len)
  *   avail  - Pointer to location to return the FIFO free space
  *
  * Returned Value:
- *   The (positive) number of free bytes in RAM CMD on success.  A negated
- *   errno value is returned on any failure.
+ *   Zero (OK) on success.  A negated errno value is returned on any
+ *   failure.
  *
  ****************************************************************************/
 
-uint16_t ft80x_ramcmd_freespace(int fd, FAR uint16_t *offset,
-                                FAR uint16_t *avail)
+int ft80x_ramcmd_freespace(int fd, FAR uint16_t *offset,
+                           FAR uint16_t *avail)
 {
   uint32_t regs[2];
   int ret;
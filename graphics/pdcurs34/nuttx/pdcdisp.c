@@ -38,6 +38,7 @@
  ****************************************************************************/
 
 #include <sys/ioctl.h>
+#include <string.h>
 #include <errno.h>
 
 #ifdef CONFIG_SYSTEM_TERMCURSES
@@ -222,13 +223,14 @@ static inline pdc_color_t PDC_color(FAR struct pdc_fbstate_s *fbstate,
  * Description:
  *   Set memory to the device background RGB color.  For the case of BPP < 8,
  *   this is byte-aligned font buffer.  For other cases, this clears a patch
- *   of memory in the framebuffer.
+ *   of memory in the framebuffer or a glyph in the glyph cache.
  *
  ****************************************************************************/
 
 #if PDCURSES_BPP < 8
 static inline void PDC_set_bg(FAR struct pdc_fbstate_s *fbstate,
-                              FAR uint8_t *fbuffer, short bg)
+                              FAR uint8_t *fbuffer, unsigned int stride,
+                              short bg)
 {
   uint8_t color8;
   int row;
@@ -240,7 +242,7 @@ static inline void PDC_set_bg(FAR struct pdc_fbstate_s *fbstate,
 
   /* Now copy the color into the entire glyph region */
 
-  for (row = 0; row < fbstate->fheight; row++, fbuffer += fbstate->fstride)
+  for (row = 0; row < fbstate->fheight; row++, fbuffer += stride)
     {
       FAR uint8_t *fbdest = fbuffer;
 
@@ -257,7 +259,8 @@ static inline void PDC_set_bg(FAR struct pdc_fbstate_s *fbstate,
 }
 #else
 static inline void PDC_set_bg(FAR struct pdc_fbstate_s *fbstate,
-                              FAR uint8_t *fbstart, short bg)
+                              FAR uint8_t *fbstart, unsigned int stride,
+                              short bg)
 {
   pdc_color_t bgcolor = PDC_color(fbstate, bg);
   int row;
@@ -265,7 +268,7 @@ static inline void PDC_set_bg(FAR struct pdc_fbstate_s *fbstate,
 
   /* Set the glyph to the background color. */
 
-  for (row = 0; row < fbstate->fheight; row++, fbstart += fbstate->stride)
+  for (row = 0; row < fbstate->fheight; row++, fbstart += stride)
     {
       FAR pdc_color_t *fbdest;
 
@@ -284,28 +287,20 @@ static inline void PDC_set_bg(FAR struct pdc_fbstate_s *fbstate,
  *
  * Description:
  *   Render the font into the glyph memory using the foreground RGB color.
+ *   The glyph memory may be the framebuffer, the font buffer, or a glyph
+ *   in the glyph cache.  The only difference is the stride value.
  *
  ****************************************************************************/
 
 static inline void PDC_render_glyph(FAR struct pdc_fbstate_s *fbstate,
                                     FAR const struct nx_fontbitmap_s *fbm,
-                                    FAR uint8_t *fbstart, short fg)
+                                    FAR uint8_t *fbstart,
+                                    unsigned int stride, short fg)
 {
   pdc_color_t fgcolor = PDC_color(fbstate, fg);
-  unsigned int stride;
   int ret;
 
-  /* Are we rendering into the framebuffer or the font buffer.  The only
-   * difference here is the stride value.
-   */
-
-#if PDCURSES_BPP < 8
-  stride = fbstate->fstride;  /* Width of the font buffer in bytes */
-#else
-  stride = fbstate->stride;   /* Width of the framebuffer in bytes */
-#endif
-
-  /* Then render the glyph into the allocated memory
+  /* Render the glyph into the allocated memory
    *
    * REVISIT:  The case where visibility==1 is not yet handled.  In that
    * case, only the lower quarter of the glyph should be reversed.
@@ -325,8 +320,8 @@ static inline void PDC_render_glyph(FAR struct pdc_fbstate_s *fbstate,
  * Name: PDC_copy_glyph
  *
  * Description:
- *   Copy the font from the the font buffer into the correct location in the
- *   the frame buffer.
+ *   Copy the font from the the font buffer (or from the glyph cache) into
+ *   the correct location in the the frame buffer.
  *
  *   For the case of pixel depth less then 1-byte, we will need to rend the
  *   font into a font buffer first, then copy it into the frame buffer at
@@ -336,6 +331,7 @@ static inline void PDC_render_glyph(FAR struct pdc_fbstate_s *fbstate,
 
 #if PDCURSES_BPP < 8
 static inline void  PDC_copy_glyph(FAR struct pdc_fbstate_s *fbstate,
+                                   FAR const uint8_t *src,
                                    FAR uint8_t *dest, unsigned int xpos)
 {
   FAR const uint8_t *srcrow;
@@ -403,7 +399,7 @@ static inline void  PDC_copy_glyph(FAR struct pdc_fbstate_s *fbstate,
 
   /* Then copy the image */
 
-  for (row = 0, srcrow  = fbstate->fbuffer, destrow = dest;
+  for (row = 0, srcrow  = src, destrow = dest;
        row < fbstate->fheight;
        row++, srcrow += fbstate->fstride, destrow += fbstate->stride)
     {
@@ -500,6 +496,76 @@ static inline void  PDC_copy_glyph(FAR struct pdc_fbstate_s *fbstate,
 }
 #endif
 
+/****************************************************************************
+ * Name: PDC_blit_glyph
+ *
+ * Description:
+ *   Copy a glyph from the glyph cache into the correct location in the frame
+ *   buffer.
+ *
+ ****************************************************************************/
+
+#if PDCURSES_BPP >= 8 && CONFIG_PDCURSES_GLYPH_CACHE > 0
+static inline void PDC_blit_glyph(FAR struct pdc_fbstate_s *fbstate,
+                                  FAR const uint8_t *src, FAR uint8_t *dest)
+{
+  size_t rowsize = fbstate->fwidth * sizeof(pdc_color_t);
+  int row;
+
+  for (row = 0; row < fbstate->fheight; row++)
+    {
+      memcpy(dest, src, rowsize);
+      src  += rowsize;
+      dest += fbstate->stride;
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: PDC_draw_glyph
+ *
+ * Description:
+ *   Render one character in the selected colors into glyph memory.
+ *
+ ****************************************************************************/
+
+static void PDC_draw_glyph(FAR struct pdc_fbstate_s *fbstate,
+                           FAR uint8_t *dest, unsigned int stride,
+                           chtype ch, short fg, short bg)
+{
+  FAR const struct nx_fontbitmap_s *fbm;
+#ifdef HAVE_BOLD_FONT
+  bool bold = ((ch & A_BOLD) != 0);
+#endif
+
+  /* Initialize the glyph to the (possibly reversed) background color */
+
+  PDC_set_bg(fbstate, dest, stride, bg);
+
+  /* Does the code map to a font? */
+
+#ifdef HAVE_BOLD_FONT
+  fbm = nxf_getbitmap(bold ? fbstate->hbold : fbstate->hfont,
+                      ch & A_CHARTEXT);
+#else
+  fbm = nxf_getbitmap(fbstate->hfont, ch & A_CHARTEXT);
+#endif
+
+  if (fbm != NULL)
+    {
+      /* Yes.. render the glyph */
+
+      PDC_render_glyph(fbstate, fbm, dest, stride, fg);
+    }
+
+  /* Apply more attributes */
+
+  if ((ch & (A_UNDERLINE | A_LEFTLINE | A_RIGHTLINE)) != 0)
+    {
+#warning Missing logic
+    }
+}
+
 /****************************************************************************
  * Name: PDC_update
  *
@@ -535,7 +601,7 @@ static void PDC_update(FAR struct pdc_fbstate_s *fbstate, int row, int col,
     }
 }
 #else
-#  define PDC_update(f,r,c,n)
+#  define PDC_update(f,r,c,n) ((void)(n))
 #endif
 
 /****************************************************************************
@@ -543,20 +609,25 @@ static void PDC_update(FAR struct pdc_fbstate_s *fbstate, int row, int col,
  *
  * Description:
  *   Put one character with selected attributes at the selected drawing
- *   position.
+ *   position.  Returns true if the framebuffer was modified.
  *
  ****************************************************************************/
 
-static void PDC_putc(FAR struct pdc_fbstate_s *fbstate, int row, int col,
+static bool PDC_putc(FAR struct pdc_fbstate_s *fbstate, int row, int col,
                      chtype ch)
 {
-  FAR const struct nx_fontbitmap_s *fbm;
   FAR uint8_t *dest;
+  FAR uint8_t *glyph;
+  unsigned int stride;
+#ifdef CONFIG_PDCURSES_SHADOW
+  FAR chtype *cell;
+#endif
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+  uint32_t key;
+  int slot;
+#endif
   short fg;
   short bg;
-#ifdef HAVE_BOLD_FONT
-  bool bold = ((ch & A_BOLD) != 0);
-#endif
 #ifdef CONFIG_PDCURSES_MULTITHREAD
   FAR struct pdc_context_s *ctx = PDC_ctx();
 #endif
@@ -566,9 +637,21 @@ static void PDC_putc(FAR struct pdc_fbstate_s *fbstate, int row, int col,
   if (row < 0 || row >= SP->lines || col < 0 || col >= SP->cols)
     {
       PDC_LOG(("ERROR: Position out of range: row=%d col=%d\n", row, col));
-      return;
+      return false;
+    }
+
+#ifdef CONFIG_PDCURSES_SHADOW
+  /* There is nothing to do if the cell already shows this character */
+
+  cell = &fbstate->shadow[row * SP->cols + col];
+  if (*cell == ch)
+    {
+      return false;
     }
 
+  *cell = ch;
+#endif
+
  /* Get the forground and background colors of the character */
 
  PDC_pair_content(PAIR_NUMBER(ch), &fg, &bg);
@@ -595,65 +678,73 @@ static void PDC_putc(FAR struct pdc_fbstate_s *fbstate, int row, int col,
     }
 #endif
 
-#if PDCURSES_BPP < 8
-  /* For the case of pixel depth less then 1-byte, we will need to rend the
-   * font into a font buffer first, then copy it into the frame buffer at
-   * the correct position when the font is completely rendered.
-   */
-
-  dest = fbstate->fbuffer;
-#else
-  /* Otherwise, we can rend directly into the frame buffer.  Calculate the
-   * destination address in the framebuffer.
-   */
+  /* Calculate the destination address in the framebuffer. */
 
   dest = (FAR uint8_t *)fbstate->fbmem +
                         PDC_fbmem_y(fbstate, row) +
                         PDC_fbmem_x(fbstate, col);
-#endif
 
-  /* Initialize the glyph to the (possibly reversed) background color */
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+  /* Has this character already been rendered in these colors?  The key
+   * holds everything that affects the rendered glyph.
+   */
 
-  PDC_set_bg(fbstate, dest, bg);
+  key = ((uint32_t)(ch & A_CHARTEXT) << 12) |
+        ((uint32_t)(fg & 15) << 4) | (uint32_t)(bg & 15);
+#ifdef HAVE_BOLD_FONT
+  if ((ch & A_BOLD) != 0)
+    {
+      key |= (1 << 8);
+    }
+#endif
 
-  /* Does the code map to a font? */
+  slot  = ((key * 2654435761u) >> 16) % CONFIG_PDCURSES_GLYPH_CACHE;
+  glyph = &fbstate->gcache[slot * fbstate->tilesize];
 
-#ifdef HAVE_BOLD_FONT
-  fbm = nxf_getbitmap(bold ? fbstate->hfont : fbstate->hbold,
-                      ch & A_CHARTEXT);
+#if PDCURSES_BPP < 8
+  stride = fbstate->fstride;
 #else
-  fbm = nxf_getbitmap(fbstate->hfont, ch & A_CHARTEXT);
+  stride = fbstate->fwidth * sizeof(pdc_color_t);
 #endif
 
-  if (fbm != NULL)
+  if (fbstate->gkey[slot] != key)
     {
-      /* Yes.. render the glyph */
+      /* No.. render it into the cache, replacing the old glyph */
 
-      PDC_render_glyph(fbstate, fbm, dest, fg);
+      PDC_draw_glyph(fbstate, glyph, stride, ch, fg, bg);
+      fbstate->gkey[slot] = key;
     }
 
-  /* Apply more attributes */
-
-  if ((ch & (A_UNDERLINE | A_LEFTLINE | A_RIGHTLINE)) != 0)
-    {
-#warning Missing logic
-    }
+  /* Then copy the glyph into the framebuffer */
 
 #if PDCURSES_BPP < 8
-  /* Font is now completely rendered into the font buffer and can be copied
-   * to the framebuffer.
-   *
-   * Calculate the destination address in the framebuffer.
+  PDC_copy_glyph(fbstate, glyph, dest, col);
+#else
+  PDC_blit_glyph(fbstate, glyph, dest);
+#endif
+
+#elif PDCURSES_BPP < 8
+  /* For the case of pixel depth less then 1-byte, we will need to rend the
+   * font into a font buffer first, then copy it into the frame buffer at
+   * the correct position when the font is completely rendered.
    */
 
-  dest = (FAR uint8_t *)fbstate->fbmem +
-                        PDC_fbmem_y(fbstate, row) +
-                        PDC_fbmem_x(fbstate, col);
+  glyph  = fbstate->fbuffer;
+  stride = fbstate->fstride;
 
-  /* Then copy the glyph */
+  PDC_draw_glyph(fbstate, glyph, stride, ch, fg, bg);
+  PDC_copy_glyph(fbstate, glyph, dest, col);
 
-  PDC_copy_glyph(fbstate, dest, col);
+#else
+  /* Otherwise, we can rend directly into the frame buffer. */
+
+  glyph  = dest;
+  stride = fbstate->stride;
+
+  PDC_draw_glyph(fbstate, glyph, stride, ch, fg, bg);
 #endif
+
+  return true;
 }
 
 /****************************************************************************
@@ -679,31 +770,19 @@ static void PDC_gotoyx_term(FAR SCREEN *sp, int row, int col)
 #endif
 
 /****************************************************************************
- * Name: PDC_set_char_attrib_term
+ * Name: PDC_set_attrib_term
  *
  * Description:
- *   Sets the specified character attributes.
+ *   Sets the specified rendition attributes (bold, blink, etc. and the
+ *   alternate character set) if they differ from the current ones.
  *
  ****************************************************************************/
 
 #ifdef CONFIG_SYSTEM_TERMCURSES
-static void PDC_set_char_attrib_term(FAR struct pdc_termscreen_s *termscreen,
-              chtype ch)
+static void PDC_set_attrib_term(FAR struct pdc_termstate_s *termstate,
+                                long attrib)
 {
-  FAR struct pdc_termstate_s *termstate = &termscreen->termstate;
-  struct termcurses_colors_s   colors;
-  short fg;
-  short bg;
-  long  attrib;
-  long  term_attrib;
-
-  /* Handle the attributes */
-
-#ifdef CONFIG_PDCURSES_CHTYPE_LONG
-  attrib = ch & (A_BOLD | A_BLINK | A_UNDERLINE | A_INVIS);
-#else
-  attrib = ch & (A_BOLD | A_BLINK);
-#endif
+  long term_attrib;
 
   if (attrib != termstate->attrib)
     {
@@ -730,12 +809,44 @@ static void PDC_set_char_attrib_term(FAR struct pdc_termscreen_s *termscreen,
         {
           term_attrib |= TCURS_ATTRIB_INVIS;
         }
-
-      termcurses_setattribute(termstate->tcurs, term_attrib);
 #endif
 
+      if (attrib & A_ALTCHARSET)
+        {
+          term_attrib |= TCURS_ATTRIB_ALTCHARSET;
+        }
+
+      termcurses_setattribute(termstate->tcurs, term_attrib);
       termstate->attrib = attrib;
     }
+}
+#endif
+
+/****************************************************************************
+ * Name: PDC_set_char_attrib_term
+ *
+ * Description:
+ *   Sets the specified character attributes.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SYSTEM_TERMCURSES
+static void PDC_set_char_attrib_term(FAR struct pdc_termscreen_s *termscreen,
+              chtype ch)
+{
+  FAR struct pdc_termstate_s *termstate = &termscreen->termstate;
+  struct termcurses_colors_s   colors;
+  short fg;
+  short bg;
+
+  /* Handle the attributes */
+
+#ifdef CONFIG_PDCURSES_CHTYPE_LONG
+  PDC_set_attrib_term(termstate, ch & (A_BOLD | A_BLINK | A_UNDERLINE |
+                                       A_INVIS | A_ALTCHARSET));
+#else
+  PDC_set_attrib_term(termstate, ch & (A_BOLD | A_BLINK | A_ALTCHARSET));
+#endif
 
   /* Get the character colors */
 
@@ -866,18 +977,11 @@ static void PDC_transform_line_term(FAR SCREEN *sp, int lineno, int x,
           buffer[i] = ch;
         }
 
-      /* Update source pointer and write data */
+      /* Update source pointer and write data.  The character set was
+       * selected along with the other attributes.
+       */
 
-      if (*srcp & A_ALTCHARSET)
-        {
-          write(termstate->out_fd, "\x1b(0", 3);
-          write(termstate->out_fd, buffer, i);
-          write(termstate->out_fd, "\x1b(B", 3);
-        }
-      else
-        {
-          write(termstate->out_fd, buffer, i);
-        }
+      termcurses_write(termstate->tcurs, buffer, i);
 
       srcp += i;
       c += i;
@@ -929,8 +1033,10 @@ void PDC_gotoyx(int row, int col)
   oldrow = SP->cursrow;
   oldcol = SP->curscol;
 
-  PDC_putc(fbstate, oldrow, oldcol, curscr->_y[oldrow][oldcol]);
-  PDC_update(fbstate, oldrow, oldcol, 1);
+  if (PDC_putc(fbstate, oldrow, oldcol, curscr->_y[oldrow][oldcol]))
+    {
+      PDC_update(fbstate, oldrow, oldcol, 1);
+    }
 
   if (SP->visibility != 0)
     {
@@ -939,11 +1045,44 @@ void PDC_gotoyx(int row, int col)
        */
 
       ch = curscr->_y[row][col] ^ A_REVERSE;
-      PDC_putc(fbstate, row, col, ch);
-      PDC_update(fbstate, row, col, 1);
+      if (PDC_putc(fbstate, row, col, ch))
+        {
+          PDC_update(fbstate, row, col, 1);
+        }
     }
 }
 
+/****************************************************************************
+ * Name: PDC_doupdate
+ *
+ * Description:
+ *   Called at the end of doupdate().  Terminal output is buffered by
+ *   termcurses, so send everything that doupdate() produced with a single
+ *   write.
+ *
+ ****************************************************************************/
+
+void PDC_doupdate(void)
+{
+#ifdef CONFIG_SYSTEM_TERMCURSES
+#ifdef CONFIG_PDCURSES_MULTITHREAD
+  FAR struct pdc_context_s *ctx = PDC_ctx();
+#endif
+
+  if (!graphic_screen)
+    {
+      FAR struct pdc_termscreen_s *termscreen =
+        (FAR struct pdc_termscreen_s *)SP;
+      FAR struct pdc_termstate_s *termstate = &termscreen->termstate;
+
+      /* Leave the terminal in the normal character set between updates */
+
+      PDC_set_attrib_term(termstate, termstate->attrib & ~A_ALTCHARSET);
+      termcurses_flush(termstate->tcurs);
+    }
+#endif
+}
+
 /****************************************************************************
  * Name: PDC_transform_line
  *
@@ -963,6 +1102,8 @@ void PDC_transform_line(int lineno, int x, int len, const chtype *srcp)
 #endif
   FAR struct pdc_fbscreen_s *fbscreen = (FAR struct pdc_fbscreen_s *)SP;
   FAR struct pdc_fbstate_s *fbstate;
+  int firstx;
+  int lastx;
   int nextx;
   int i;
 
@@ -983,9 +1124,13 @@ void PDC_transform_line(int lineno, int x, int len, const chtype *srcp)
   fbstate = &fbscreen->fbstate;
 
   /* Add each character to the framebuffer at the current position,
-   * incrementing the horizontal position after each character.
+   * incrementing the horizontal position after each character.  Keep
+   * track of the range of cells that were actually modified.
    */
 
+  firstx = SP->cols;
+  lastx  = -1;
+
   for (i = 0, nextx = x; i < len; i++, nextx++)
     {
       if (nextx >= SP->cols)
@@ -996,10 +1141,18 @@ void PDC_transform_line(int lineno, int x, int len, const chtype *srcp)
 
       /* Render the font glyph into the framebuffer */
 
-      PDC_putc(fbstate, lineno, nextx, srcp[i]);
+      if (PDC_putc(fbstate, lineno, nextx, srcp[i]))
+        {
+          if (nextx < firstx)
+            {
+              firstx = nextx;
+            }
+
+          lastx = nextx;
+        }
     }
 
-  PDC_update(fbstate, lineno, x, nextx - x);
+  PDC_update(fbstate, lineno, firstx, lastx - firstx + 1);
 }
 
 /****************************************************************************
@@ -1065,6 +1218,10 @@ void PDC_clear_screen(FAR struct pdc_fbstate_s *fbstate)
          }
     }
 
+  /* Nothing is drawn in any cell now */
+
+  PDC_invalidate(fbstate, false);
+
 #ifdef CONFIG_LCD_UPDATE
   /* Update the entire display */
   /* Setup the bounding rectangle */
@@ -1083,3 +1240,39 @@ void PDC_clear_screen(FAR struct pdc_fbstate_s *fbstate)
     }
 #endif
 }
+
+/****************************************************************************
+ * Name: PDC_invalidate
+ *
+ * Description:
+ *   Discard the cell shadow and/or the glyph cache after a change that
+ *   affects how the characters are drawn.  'colors' is true if the color
+ *   table has changed and rendered glyphs can no longer be reused.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_PDCURSES_SHADOW) || CONFIG_PDCURSES_GLYPH_CACHE > 0
+void PDC_invalidate(FAR struct pdc_fbstate_s *fbstate, bool colors)
+{
+#ifdef CONFIG_PDCURSES_MULTITHREAD
+  FAR struct pdc_context_s *ctx = PDC_ctx();
+#endif
+
+#ifdef CONFIG_PDCURSES_SHADOW
+  /* No cell matches an all-ones chtype, so every cell will be redrawn */
+
+  if (fbstate->shadow != NULL)
+    {
+      memset(fbstate->shadow, 0xff, SP->lines * SP->cols * sizeof(chtype));
+    }
+#endif
+
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+  if (colors && fbstate->gkey != NULL)
+    {
+      memset(fbstate->gkey, 0xff,
+             CONFIG_PDCURSES_GLYPH_CACHE * sizeof(uint32_t));
+    }
+#endif
+}
+#endif
@@ -43,6 +43,7 @@
 #include "nuttx/config.h"
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "nuttx/input/djoystick.h"
 #include "nuttx/nx/nx.h"
@@ -189,6 +190,14 @@
 #  error "Unsupported bits-per-pixel"
 #endif
 
+/* Glyph cache */
+
+#ifndef CONFIG_PDCURSES_GLYPH_CACHE
+#  define CONFIG_PDCURSES_GLYPH_CACHE 0
+#endif
+
+#define PDC_GLYPH_INVALID      0xffffffff
+
 /* Convert bits to bytes to hold an even number of pixels */
 
 #define PDCURSES_ALIGN_UP(n)   (((n) + PDCURSES_BPP_MASK) >> 3)
@@ -264,6 +273,14 @@ struct pdc_fbstate_s
   uint8_t fstride;         /* Width of the font buffer (bytes) */
   FAR uint8_t *fbuffer;    /* Allocated font buffer */
 #endif
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+  uint16_t tilesize;       /* Size of one rendered glyph (bytes) */
+  FAR uint32_t *gkey;      /* Font/color key of each cached glyph */
+  FAR uint8_t *gcache;     /* Rendered glyphs */
+#endif
+#ifdef CONFIG_PDCURSES_SHADOW
+  FAR chtype *shadow;      /* Character last drawn in each cell */
+#endif
 
   /* Drawable area (See also SP->lines and SP->cols) */
 
@@ -364,6 +381,22 @@ EXTERN struct pdc_fbstate_s g_pdc_fbstate;
 
 void PDC_clear_screen(FAR struct pdc_fbstate_s *fbstate);
 
+/****************************************************************************
+ * Name: PDC_invalidate
+ *
+ * Description:
+ *   Discard the cell shadow and/or the glyph cache after a change that
+ *   affects how the characters are drawn.  'colors' is true if the color
+ *   table has changed and rendered glyphs can no longer be reused.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_PDCURSES_SHADOW) || CONFIG_PDCURSES_GLYPH_CACHE > 0
+void PDC_invalidate(FAR struct pdc_fbstate_s *fbstate, bool colors);
+#else
+#  define PDC_invalidate(f,c)
+#endif
+
 /****************************************************************************
  * Name: PDC_input_open
  *
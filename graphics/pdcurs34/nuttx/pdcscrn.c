@@ -391,6 +391,16 @@ void PDC_scr_free(void)
   close(fbstate->fbfd);
 #ifdef CONFIG_PDCURSES_HAVE_INPUT
   PDC_input_close(fbstate);
+#endif
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+  free(fbstate->gcache);
+  free(fbstate->gkey);
+#endif
+#ifdef CONFIG_PDCURSES_SHADOW
+  free(fbstate->shadow);
+#endif
+#if PDCURSES_BPP < 8
+  free(fbstate->fbuffer);
 #endif
   free(fbscreen);
   SP = NULL;
@@ -651,6 +661,45 @@ int PDC_scr_open(int argc, char **argv)
   fbstate->hoffset = (fbstate->xres - fbstate->fwidth * SP->cols) / 2;
   fbstate->voffset = (fbstate->yres - fbstate->fheight * SP->lines) / 2;
 
+#ifdef CONFIG_PDCURSES_SHADOW
+  /* Allocate the record of the character drawn in each cell */
+
+  fbstate->shadow = (FAR chtype *)
+    malloc(SP->lines * SP->cols * sizeof(chtype));
+
+  if (fbstate->shadow == NULL)
+    {
+      PDC_LOG(("ERROR: Failed to allocate shadow: %d\n", errno));
+      goto errout_with_fbuffer;
+    }
+#endif
+
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+  /* Allocate the glyph cache.  Glyphs are held in the format of the font
+   * buffer (BPP < 8) or as rows of pixels without padding.
+   */
+
+#if PDCURSES_BPP < 8
+  fbstate->tilesize = fbstate->fstride * fbstate->fheight;
+#else
+  fbstate->tilesize = fbstate->fwidth * fbstate->fheight *
+                      sizeof(pdc_color_t);
+#endif
+
+  fbstate->gkey   = (FAR uint32_t *)
+    malloc(CONFIG_PDCURSES_GLYPH_CACHE * sizeof(uint32_t));
+  fbstate->gcache = (FAR uint8_t *)
+    malloc(CONFIG_PDCURSES_GLYPH_CACHE * fbstate->tilesize);
+
+  if (fbstate->gkey == NULL || fbstate->gcache == NULL)
+    {
+      PDC_LOG(("ERROR: Failed to allocate glyph cache: %d\n", errno));
+      goto errout_with_cache;
+    }
+
+  PDC_invalidate(fbstate, true);
+#endif
+
   /* Set the framebuffer to a known state */
 
   PDC_clear_screen(fbstate);
@@ -661,13 +710,25 @@ int PDC_scr_open(int argc, char **argv)
   ret = PDC_input_open(fbstate);
   if (ret == ERR)
     {
-      goto errout_with_fbuffer;
+      goto errout_with_cache;
     }
 #endif
 
   return OK;
 
-#ifdef CONFIG_PDCURSES_HAVE_INPUT
+#if defined(CONFIG_PDCURSES_HAVE_INPUT) || CONFIG_PDCURSES_GLYPH_CACHE > 0
+errout_with_cache:
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+  free(fbstate->gcache);
+  free(fbstate->gkey);
+#endif
+#ifdef CONFIG_PDCURSES_SHADOW
+  free(fbstate->shadow);
+#endif
+#endif
+
+#if defined(CONFIG_PDCURSES_HAVE_INPUT) || defined(CONFIG_PDCURSES_SHADOW) || \
+    CONFIG_PDCURSES_GLYPH_CACHE > 0
 errout_with_fbuffer:
 #if PDCURSES_BPP < 8
   free(fbstate->fbuffer);
@@ -807,6 +868,13 @@ void PDC_init_pair(short pair, short fg, short bg)
   DEBUGASSERT(fbscreen != NULL);
   fbstate = &fbscreen->fbstate;
 
+  /* Cells drawn with this pair must be drawn again */
+
+  if (fbstate->colorpair[pair].fg != fg || fbstate->colorpair[pair].bg != bg)
+    {
+      PDC_invalidate(fbstate, false);
+    }
+
   fbstate->colorpair[pair].fg = fg;
   fbstate->colorpair[pair].bg = bg;
 }
@@ -955,5 +1023,8 @@ int PDC_init_color(short color, short red, short green, short blue)
   fbstate->rgbcolor[color].blue  = DIVROUND(blue * 255, 1000);
 #endif
 
+  /* Glyphs rendered in the old color can no longer be used */
+
+  PDC_invalidate(fbstate, true);
   return OK;
 }
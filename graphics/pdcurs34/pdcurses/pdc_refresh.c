@@ -289,6 +289,7 @@ int doupdate(void)
   SP->cursrow = curscr->_cury;
   SP->curscol = curscr->_curx;
 
+  PDC_doupdate();
   return OK;
 }
 
@@ -40,19 +40,31 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <string.h>
 #include <semaphore.h>
+#include <unistd.h>
 #include <errno.h>
 
+#ifdef CONFIG_SCREENSHOT_FB
+#  include <sys/ioctl.h>
+#  include <sys/mman.h>
+#  include <fcntl.h>
+#endif
+
 #include "graphics/tiff.h"
 
-#include <nuttx/nx/nx.h>
+#ifdef CONFIG_SCREENSHOT_NX
+#  include <nuttx/nx/nx.h>
+#endif
 
-#ifdef CONFIG_VNCSERVER
+#include <nuttx/video/fb.h>
+
+#if defined(CONFIG_SCREENSHOT_NX) && defined(CONFIG_VNCSERVER)
 #  include <nuttx/video/vnc.h>
 #endif
 
@@ -72,17 +84,52 @@
 #  define CONFIG_SCREENSHOT_FORMAT FB_FMT_RGB16_565
 #endif
 
+#ifndef CONFIG_SCREENSHOT_FBDEV
+#  define CONFIG_SCREENSHOT_FBDEV "/dev/fb0"
+#endif
+
+#ifndef CONFIG_SCREENSHOT_RPS
+#  define CONFIG_SCREENSHOT_RPS 16
+#endif
+
+#if defined(CONFIG_SCREENSHOT_COMPRESS_LZW)
+#  define SCREENSHOT_COMPRESS TAG_COMP_LZW
+#elif defined(CONFIG_SCREENSHOT_COMPRESS_PACKBITS)
+#  define SCREENSHOT_COMPRESS TAG_COMP_PACKBITS
+#else
+#  define SCREENSHOT_COMPRESS TAG_COMP_NONE
+#endif
+
+/* Size of the TIFF library I/O buffer */
+
+#define SCREENSHOT_IOSIZE 1024
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
-/****************************************************************************
- * Private Data
- ****************************************************************************/
+#ifdef CONFIG_SCREENSHOT_FB
+/* The state of the framebuffer capture */
 
-/****************************************************************************
- * Public Data
- ****************************************************************************/
+struct screenshot_fb_s
+{
+  int fd;                   /* Framebuffer device file descriptor */
+  bool mapped;              /* True: fbmem is mapped, false: allocated */
+  uint8_t fbfmt;            /* Framebuffer color format */
+  uint8_t colorfmt;         /* TIFF color format */
+  nxgl_coord_t xres;        /* Width in pixels */
+  nxgl_coord_t yres;        /* Height in rows */
+  size_t stride;            /* Length of a framebuffer row (bytes) */
+  size_t rowsize;           /* Length of a TIFF row (bytes) */
+  size_t fblen;             /* Size of the framebuffer (bytes) */
+  FAR uint8_t *fbmem;       /* The framebuffer (mapped or a copy) */
+  FAR uint8_t *strip;       /* Strip buffer when the data must be copied */
+#ifdef CONFIG_SCREENSHOT_CONTINUOUS
+  int nbands;               /* Number of bands */
+  FAR uint32_t *checksum;   /* Checksum of each band in the last capture */
+#endif
+};
+#endif
 
 /****************************************************************************
  * Private Functions
@@ -108,6 +155,516 @@ static void replace_extension(FAR const char *filename, FAR const char *newext,
   strncpy(dest + len, newext, size - len);
 }
 
+/****************************************************************************
+ * Name: screenshot_rowsize
+ *
+ * Description:
+ *   Return the number of bytes in one row of a TIFF image.
+ *
+ ****************************************************************************/
+
+static size_t screenshot_rowsize(uint8_t colorfmt, nxgl_coord_t width)
+{
+  switch (colorfmt)
+    {
+      case FB_FMT_Y1:
+        return (width + 7) >> 3;
+
+      case FB_FMT_Y4:
+        return (width + 1) >> 1;
+
+      case FB_FMT_Y8:
+        return width;
+
+      case FB_FMT_RGB16_565:
+        return 2 * width;
+
+      default:
+        return 3 * width;
+    }
+}
+
+/****************************************************************************
+ * Name: screenshot_initialize
+ *
+ * Description:
+ *   Prepare a TIFF file for the image.  The file is created in a single
+ *   pass (no temporary files).
+ *
+ ****************************************************************************/
+
+static int screenshot_initialize(FAR struct tiff_info_s *info,
+                                 FAR const char *filename, uint8_t colorfmt,
+                                 nxgl_coord_t width, nxgl_coord_t height)
+{
+  int ret;
+
+  memset(info, 0, sizeof(struct tiff_info_s));
+  info->outfile   = filename;
+  info->colorfmt  = colorfmt;
+  info->rps       = CONFIG_SCREENSHOT_RPS;
+  info->imgwidth  = width;
+  info->imgheight = height;
+  info->compress  = SCREENSHOT_COMPRESS;
+  info->iobuffer  = (FAR uint8_t *)malloc(SCREENSHOT_IOSIZE);
+  info->iosize    = SCREENSHOT_IOSIZE;
+
+  if (info->iobuffer == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  ret = tiff_initialize(info);
+  if (ret < 0)
+    {
+      printf("tiff_initialize() failed: %d\n", ret);
+      free(info->iobuffer);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: screenshot_fbopen
+ *
+ * Description:
+ *   Open the framebuffer device and get access to the framebuffer memory.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCREENSHOT_FB
+static int screenshot_fbopen(FAR struct screenshot_fb_s *fb)
+{
+  struct fb_videoinfo_s vinfo;
+  struct fb_planeinfo_s pinfo;
+  int ret;
+
+  memset(fb, 0, sizeof(struct screenshot_fb_s));
+
+  fb->fd = open(CONFIG_SCREENSHOT_FBDEV, O_RDONLY);
+  if (fb->fd < 0)
+    {
+      ret = -errno;
+      printf("Failed to open %s: %d\n", CONFIG_SCREENSHOT_FBDEV, ret);
+      return ret;
+    }
+
+  ret = ioctl(fb->fd, FBIOGET_VIDEOINFO,
+              (unsigned long)((uintptr_t)&vinfo));
+  if (ret >= 0)
+    {
+      ret = ioctl(fb->fd, FBIOGET_PLANEINFO,
+                  (unsigned long)((uintptr_t)&pinfo));
+    }
+
+  if (ret < 0)
+    {
+      ret = -errno;
+      printf("Failed to get framebuffer info: %d\n", ret);
+      goto errout_with_fd;
+    }
+
+  /* Formats that the TIFF library accepts are passed through; RGB32 is
+   * reduced to RGB24.
+   */
+
+  fb->fbfmt = vinfo.fmt;
+  switch (vinfo.fmt)
+    {
+      case FB_FMT_Y1:
+      case FB_FMT_Y4:
+      case FB_FMT_Y8:
+      case FB_FMT_RGB16_565:
+      case FB_FMT_RGB24:
+        fb->colorfmt = vinfo.fmt;
+        break;
+
+      case FB_FMT_RGB32:
+        fb->colorfmt = FB_FMT_RGB24;
+        break;
+
+      default:
+        printf("Unsupported color format: %u\n", vinfo.fmt);
+        ret = -ENOSYS;
+        goto errout_with_fd;
+    }
+
+  fb->xres    = vinfo.xres;
+  fb->yres    = vinfo.yres;
+  fb->stride  = pinfo.stride;
+  fb->fblen   = pinfo.fblen;
+  fb->rowsize = screenshot_rowsize(fb->colorfmt, fb->xres);
+
+  /* Map the framebuffer.  If that is not possible, it will be read into
+   * memory with one read() for each capture.
+   */
+
+  fb->fbmem = (FAR uint8_t *)mmap(NULL, fb->fblen, PROT_READ,
+                                  MAP_SHARED | MAP_FILE, fb->fd, 0);
+  if (fb->fbmem != MAP_FAILED)
+    {
+      fb->mapped = true;
+    }
+  else
+    {
+      fb->fbmem = (FAR uint8_t *)malloc(fb->fblen);
+      if (fb->fbmem == NULL)
+        {
+          ret = -ENOMEM;
+          goto errout_with_fd;
+        }
+    }
+
+  /* A strip buffer is needed unless the strips can be taken directly from
+   * the framebuffer.  It is also used for the last, partial strip.
+   */
+
+  fb->strip = (FAR uint8_t *)malloc(CONFIG_SCREENSHOT_RPS * fb->rowsize);
+  if (fb->strip == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout_with_fbmem;
+    }
+
+  return OK;
+
+errout_with_fbmem:
+  if (fb->mapped)
+    {
+      munmap(fb->fbmem, fb->fblen);
+    }
+  else
+    {
+      free(fb->fbmem);
+    }
+
+errout_with_fd:
+  close(fb->fd);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: screenshot_fbclose
+ ****************************************************************************/
+
+static void screenshot_fbclose(FAR struct screenshot_fb_s *fb)
+{
+  if (fb->mapped)
+    {
+      munmap(fb->fbmem, fb->fblen);
+    }
+  else
+    {
+      free(fb->fbmem);
+    }
+
+#ifdef CONFIG_SCREENSHOT_CONTINUOUS
+  free(fb->checksum);
+#endif
+  free(fb->strip);
+  close(fb->fd);
+}
+
+/****************************************************************************
+ * Name: screenshot_fbread
+ *
+ * Description:
+ *   Get the current framebuffer content.  Nothing needs to be done if the
+ *   framebuffer is mapped.
+ *
+ ****************************************************************************/
+
+static int screenshot_fbread(FAR struct screenshot_fb_s *fb)
+{
+  size_t nread;
+  ssize_t ret;
+
+  if (fb->mapped)
+    {
+      return OK;
+    }
+
+  if (lseek(fb->fd, 0, SEEK_SET) == (off_t)-1)
+    {
+      return -errno;
+    }
+
+  for (nread = 0; nread < fb->fblen; nread += ret)
+    {
+      ret = read(fb->fd, fb->fbmem + nread, fb->fblen - nread);
+      if (ret <= 0)
+        {
+          return ret < 0 ? -errno : -EIO;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: screenshot_fbstrip
+ *
+ * Description:
+ *   Return the TIFF strip beginning at the given row.  The framebuffer is
+ *   used directly if its rows are packed and need no conversion.
+ *
+ ****************************************************************************/
+
+static FAR const uint8_t *
+screenshot_fbstrip(FAR struct screenshot_fb_s *fb, nxgl_coord_t row,
+                   nxgl_coord_t endrow)
+{
+  FAR const uint8_t *src;
+  FAR uint8_t *dest;
+  nxgl_coord_t nrows;
+  nxgl_coord_t i;
+  nxgl_coord_t x;
+
+  src   = fb->fbmem + row * fb->stride;
+  nrows = endrow - row;
+
+  if (nrows >= CONFIG_SCREENSHOT_RPS && fb->fbfmt == fb->colorfmt &&
+      fb->stride == fb->rowsize)
+    {
+      return src;
+    }
+
+  if (nrows > CONFIG_SCREENSHOT_RPS)
+    {
+      nrows = CONFIG_SCREENSHOT_RPS;
+    }
+
+  dest = fb->strip;
+  for (i = 0; i < nrows; i++, src += fb->stride)
+    {
+      if (fb->fbfmt == FB_FMT_RGB32)
+        {
+          FAR const uint32_t *rgb32 = (FAR const uint32_t *)src;
+
+          for (x = 0; x < fb->xres; x++)
+            {
+              uint32_t rgb = *rgb32++;
+
+              *dest++ = (uint8_t)(rgb >> 16);
+              *dest++ = (uint8_t)(rgb >> 8);
+              *dest++ = (uint8_t)rgb;
+            }
+        }
+      else
+        {
+          memcpy(dest, src, fb->rowsize);
+          dest += fb->rowsize;
+        }
+    }
+
+  /* Clear the rows of a partial strip that are beyond the image */
+
+  memset(dest, 0, fb->strip + CONFIG_SCREENSHOT_RPS * fb->rowsize - dest);
+  return fb->strip;
+}
+
+/****************************************************************************
+ * Name: screenshot_fbsave
+ *
+ * Description:
+ *   Save rows [row, endrow) of the last capture to a TIFF file.
+ *
+ ****************************************************************************/
+
+static int screenshot_fbsave(FAR struct screenshot_fb_s *fb,
+                             FAR const char *filename, nxgl_coord_t row,
+                             nxgl_coord_t endrow)
+{
+  struct tiff_info_s info;
+  int ret;
+
+  ret = screenshot_initialize(&info, filename, fb->colorfmt, fb->xres,
+                              endrow - row);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  for (; row < endrow; row += CONFIG_SCREENSHOT_RPS)
+    {
+      ret = tiff_addstrip(&info, screenshot_fbstrip(fb, row, endrow));
+      if (ret < 0)
+        {
+          printf("tiff_addstrip() #%d failed: %d\n", row, ret);
+          goto errout;
+        }
+    }
+
+  ret = tiff_finalize(&info);
+  if (ret < 0)
+    {
+      printf("tiff_finalize() failed: %d\n", ret);
+    }
+
+errout:
+  free(info.iobuffer);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: screenshot_checksum
+ *
+ * Description:
+ *   Return a checksum (FNV-1a) of one band of the framebuffer.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCREENSHOT_CONTINUOUS
+static uint32_t screenshot_checksum(FAR struct screenshot_fb_s *fb, int band)
+{
+  FAR const uint32_t *src;
+  FAR const uint32_t *end;
+  nxgl_coord_t row;
+  nxgl_coord_t endrow;
+  uint32_t hash = 2166136261u;
+
+  row    = band * CONFIG_SCREENSHOT_RPS;
+  endrow = row + CONFIG_SCREENSHOT_RPS;
+  if (endrow > fb->yres)
+    {
+      endrow = fb->yres;
+    }
+
+  /* Any padding at the end of the rows is included */
+
+  if ((fb->stride & 3) != 0)
+    {
+      FAR const uint8_t *ptr = fb->fbmem + row * fb->stride;
+      FAR const uint8_t *last = fb->fbmem + endrow * fb->stride;
+
+      while (ptr < last)
+        {
+          hash = (hash ^ *ptr++) * 16777619u;
+        }
+
+      return hash;
+    }
+
+  /* Usually the rows are word aligned and can be read a word at a time */
+
+  src = (FAR const uint32_t *)(fb->fbmem + row * fb->stride);
+  end = (FAR const uint32_t *)(fb->fbmem + endrow * fb->stride);
+
+  while (src < end)
+    {
+      hash = (hash ^ *src++) * 16777619u;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: screenshot_continuous
+ *
+ * Description:
+ *   Capture the framebuffer ncaptures times (0=forever), delay milliseconds
+ *   apart.  Each capture saves only the band of rows that contains all
+ *   changes since the previous capture.
+ *
+ ****************************************************************************/
+
+static int screenshot_continuous(FAR const char *filename, int ncaptures,
+                                 int delay)
+{
+  struct screenshot_fb_s fb;
+  char basename[48];
+  char name[80];
+  uint32_t checksum;
+  int capture;
+  int first;
+  int last;
+  int band;
+  int ret;
+
+  ret = screenshot_fbopen(&fb);
+  if (ret < 0)
+    {
+      return 1;
+    }
+
+  fb.nbands   = (fb.yres + CONFIG_SCREENSHOT_RPS - 1) / CONFIG_SCREENSHOT_RPS;
+  fb.checksum = (FAR uint32_t *)malloc(fb.nbands * sizeof(uint32_t));
+  if (fb.checksum == NULL)
+    {
+      screenshot_fbclose(&fb);
+      return 1;
+    }
+
+  replace_extension(filename, "", basename, sizeof(basename));
+
+  for (capture = 0; ncaptures == 0 || capture < ncaptures; capture++)
+    {
+      if (capture > 0)
+        {
+          usleep(1000 * delay);
+        }
+
+      ret = screenshot_fbread(&fb);
+      if (ret < 0)
+        {
+          printf("Failed to read the framebuffer: %d\n", ret);
+          break;
+        }
+
+      /* Find the first and last changed bands.  Everything has changed
+       * in the first capture.
+       */
+
+      first = fb.nbands;
+      last  = -1;
+
+      for (band = 0; band < fb.nbands; band++)
+        {
+          checksum = screenshot_checksum(&fb, band);
+          if (capture == 0 || checksum != fb.checksum[band])
+            {
+              fb.checksum[band] = checksum;
+              if (band < first)
+                {
+                  first = band;
+                }
+
+              last = band;
+            }
+        }
+
+      if (last < 0)
+        {
+          continue;
+        }
+
+      /* Save only the changed rows */
+
+      first *= CONFIG_SCREENSHOT_RPS;
+      last   = (last + 1) * CONFIG_SCREENSHOT_RPS;
+      if (last > fb.yres)
+        {
+          last = fb.yres;
+        }
+
+      snprintf(name, sizeof(name), "%s-%04d-%04d.tif", basename, capture,
+               first);
+
+      ret = screenshot_fbsave(&fb, name, first, last);
+      if (ret < 0)
+        {
+          break;
+        }
+
+      printf("%s: rows %d-%d\n", name, first, last - 1);
+    }
+
+  screenshot_fbclose(&fb);
+  return ret < 0 ? 1 : 0;
+}
+#endif /* CONFIG_SCREENSHOT_CONTINUOUS */
+#endif /* CONFIG_SCREENSHOT_FB */
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -120,6 +677,28 @@ static void replace_extension(FAR const char *filename, FAR const char *newext,
  *
  ****************************************************************************/
 
+#ifdef CONFIG_SCREENSHOT_FB
+int save_screenshot(FAR const char *filename)
+{
+  struct screenshot_fb_s fb;
+  int ret;
+
+  ret = screenshot_fbopen(&fb);
+  if (ret < 0)
+    {
+      return 1;
+    }
+
+  ret = screenshot_fbread(&fb);
+  if (ret >= 0)
+    {
+      ret = screenshot_fbsave(&fb, filename, 0, fb.yres);
+    }
+
+  screenshot_fbclose(&fb);
+  return ret < 0 ? 1 : 0;
+}
+#else
 int save_screenshot(FAR const char *filename)
 {
   struct tiff_info_s info;
@@ -128,14 +707,10 @@ int save_screenshot(FAR const char *filename)
   FAR uint8_t *strip;
   NXHANDLE server;
   NXWINDOW window;
-  char tempf1[64];
-  char tempf2[64];
+  size_t rowsize;
   int row;
   int ret;
 
-  replace_extension(filename, ".tm1", tempf1, sizeof(tempf1));
-  replace_extension(filename, ".tm2", tempf2, sizeof(tempf2));
-
   /* Connect to NX server */
 
   server = nx_connect();
@@ -178,36 +753,35 @@ int save_screenshot(FAR const char *filename)
 
   nx_setsize(window, &size);
 
-  /* Configure the TIFF structure */
-
-  memset(&info, 0, sizeof(struct tiff_info_s));
-  info.outfile   = filename;
-  info.tmpfile1  = tempf1;
-  info.tmpfile2  = tempf2;
-  info.colorfmt  = CONFIG_SCREENSHOT_FORMAT;
-  info.rps       = 1;
-  info.imgwidth  = size.w;
-  info.imgheight = size.h;
-  info.iobuffer  = (uint8_t *)malloc(300);
-  info.iosize    = 300;
-
   /* Initialize the TIFF library */
 
-  ret = tiff_initialize(&info);
+  ret = screenshot_initialize(&info, filename, CONFIG_SCREENSHOT_FORMAT,
+                              size.w, size.h);
   if (ret < 0)
     {
-      printf("tiff_initialize() failed: %d\n", ret);
+      nx_closewindow(window);
+      nx_disconnect(server);
       return 1;
     }
 
-  /* Add each strip to the TIFF file */
+  /* Add each strip to the TIFF file.  Each strip is read with one request
+   * to the server.
+   */
 
-  strip = malloc(size.w * 3);
+  rowsize = screenshot_rowsize(CONFIG_SCREENSHOT_FORMAT, size.w);
+  strip   = calloc(CONFIG_SCREENSHOT_RPS, rowsize);
 
-  for (row = 0; row < size.h; row++)
+  for (row = 0; strip != NULL && row < size.h; row += CONFIG_SCREENSHOT_RPS)
   {
-    struct nxgl_rect_s rect = {{0, row}, {size.w - 1, row}};
-    nx_getrectangle(window, &rect, 0, strip, 0);
+    struct nxgl_rect_s rect = {{0, row},
+                               {size.w - 1, row + CONFIG_SCREENSHOT_RPS - 1}};
+
+    if (rect.pt2.y >= size.h)
+      {
+        rect.pt2.y = size.h - 1;
+      }
+
+    nx_getrectangle(window, &rect, 0, strip, rowsize);
 
     ret = tiff_addstrip(&info, strip);
     if (ret < 0)
@@ -221,10 +795,13 @@ int save_screenshot(FAR const char *filename)
 
   /* Then finalize the TIFF file */
 
-  ret = tiff_finalize(&info);
-  if (ret < 0)
+  if (ret >= 0)
     {
-      printf("tiff_finalize() failed: %d\n", ret);
+      ret = tiff_finalize(&info);
+      if (ret < 0)
+        {
+          printf("tiff_finalize() failed: %d\n", ret);
+        }
     }
 
   free(info.iobuffer);
@@ -233,6 +810,7 @@ int save_screenshot(FAR const char *filename)
 
   return 0;
 }
+#endif
 
 /****************************************************************************
  * Name: screenshot_main
@@ -248,6 +826,50 @@ int main(int argc, FAR char *argv[])
 int screenshot_main(int argc, char *argv[])
 #endif
 {
+#ifdef CONFIG_SCREENSHOT_CONTINUOUS
+  bool continuous = false;
+  int ncaptures = 0;
+  int delay = 1000;
+  int option;
+
+  while ((option = getopt(argc, argv, "n:d:")) != ERROR)
+    {
+      switch (option)
+        {
+          case 'n':
+            ncaptures  = atoi(optarg);
+            continuous = true;
+            break;
+
+          case 'd':
+            delay      = atoi(optarg);
+            continuous = true;
+            break;
+
+          default:
+            goto usage;
+        }
+    }
+
+  if (optind != argc - 1)
+    {
+      goto usage;
+    }
+
+  if (continuous)
+    {
+      return screenshot_continuous(argv[optind], ncaptures, delay);
+    }
+
+  return save_screenshot(argv[optind]);
+
+usage:
+  fprintf(stderr, "Usage: screenshot [-n <captures>] [-d <msec>] file.tif\n");
+  fprintf(stderr, "  -n  Capture repeatedly (0=forever), saving only the "
+                  "changed rows\n");
+  fprintf(stderr, "  -d  Delay between captures (default 1000)\n");
+  return 1;
+#else
   if (argc != 2)
     {
       fprintf(stderr, "Usage: screenshot file.tif\n");
@@ -255,4 +877,5 @@ int screenshot_main(int argc, char *argv[])
     }
 
   return save_screenshot(argv[1]);
+#endif
 }
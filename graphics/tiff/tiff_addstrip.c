@@ -39,6 +39,7 @@
 
 #include <nuttx/config.h>
 
+#include <unistd.h>
 #include <assert.h>
 #include <errno.h>
 #include <debug.h>
@@ -68,28 +69,59 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Name: tiff_addstrip
+ * Name: tiff_putstrip
  *
  * Description:
- *   Convert an RGB565 strip to an RGB888 strip and write it to tmpfile2.
+ *   Write strip data to the file, compressing it first if so configured.
  *
- *   Add an image data strip.  The size of the strip in pixels must be equal
- *   to the RowsPerStrip x ImageWidth values that were provided to
- *   tiff_initialize().
+ * Input Parameters:
+ *   info   - A pointer to the caller allocated parameter passing/TIFF state
+ *            instance.
+ *   fd     - The file receiving the strip data
+ *   buffer - The strip data
+ *   count  - The number of bytes in buffer
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int tiff_putstrip(FAR struct tiff_info_s *info, int fd,
+                         FAR const uint8_t *buffer, size_t count)
+{
+#ifdef HAVE_TIFF_COMPRESS
+  if (info->comp != NULL)
+    {
+      return tiff_compress_data(info, buffer, count);
+    }
+#endif
+
+  return tiff_write(fd, buffer, count);
+}
+
+/****************************************************************************
+ * Name: tiff_convstrip
+ *
+ * Description:
+ *   Convert an RGB565 strip to an RGB888 strip and write it to the file.
  *
  * Input Parameters:
  *   info    - A pointer to the caller allocated parameter passing/TIFF state instance.
- *   buffer  - A buffer containing a single row of data.
+ *   fd      - The file receiving the strip data
+ *   strip   - A buffer containing the RGB565 strip
  *
  * Returned Value:
  *   Zero (OK) on success.  A negated errno value on failure.
  *
  ****************************************************************************/
-int tiff_convstrip(FAR struct tiff_info_s *info, FAR const uint8_t *strip)
+
+static int tiff_convstrip(FAR struct tiff_info_s *info, int fd,
+                          FAR const uint8_t *strip)
 {
 #ifdef CONFIG_DEBUG_GRAPHICS
   size_t ntotal;
 #endif
+  size_t iosize;
   size_t nbytes;
   FAR uint16_t *src;
   FAR uint8_t *dest;
@@ -99,6 +131,16 @@ int tiff_convstrip(FAR struct tiff_info_s *info, FAR const uint8_t *strip)
 
   DEBUGASSERT(info->iobuffer != NULL);
 
+  /* The upper half of the I/O buffer holds compressed output */
+
+  iosize = info->iosize;
+#ifdef HAVE_TIFF_COMPRESS
+  if (info->comp != NULL)
+    {
+      iosize -= info->comp->outsize;
+    }
+#endif
+
   /* Convert each RGB565 pixel to RGB888 */
 
   src    = (FAR uint16_t *)strip;
@@ -124,11 +166,11 @@ int tiff_convstrip(FAR struct tiff_info_s *info, FAR const uint8_t *strip)
       ntotal += 3;
 #endif
 
-      /* Flush the conversion buffer to tmpfile2 when it becomes full */
+      /* Flush the conversion buffer when it becomes full */
 
-      if (nbytes > (info->iosize-3))
+      if (nbytes > (iosize-3))
         {
-          ret = tiff_write(info->tmp2fd, info->iobuffer, nbytes);
+          ret = tiff_putstrip(info, fd, info->iobuffer, nbytes);
           if (ret < 0)
             {
               return ret;
@@ -141,15 +183,88 @@ int tiff_convstrip(FAR struct tiff_info_s *info, FAR const uint8_t *strip)
         }
     }
 
-  /* Flush any buffer data to tmpfile2 */
+  /* Flush any buffer data */
 
-  ret = tiff_write(info->tmp2fd, info->iobuffer, nbytes);
+  ret = tiff_putstrip(info, fd, info->iobuffer, nbytes);
 #ifdef CONFIG_DEBUG_GRAPHICS
   DEBUGASSERT(ntotal == info->bps);
 #endif
   return ret;
 }
 
+/****************************************************************************
+ * Name: tiff_putstripinfo
+ *
+ * Description:
+ *   Update the StripByteCounts and StripOffsets values of a compressed
+ *   strip in a file that is created in a single pass.  The values reserved
+ *   by tiff_initialize() assumed uncompressed strips.
+ *
+ * Input Parameters:
+ *   info    - A pointer to the caller allocated parameter passing/TIFF state
+ *             instance.
+ *   offset  - The file offset of the strip data
+ *   nbytes  - The size of the strip data
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_TIFF_COMPRESS
+static int tiff_putstripinfo(FAR struct tiff_info_s *info, off_t offset,
+                             uint32_t nbytes)
+{
+  off_t sbcpos;
+  off_t sopos;
+  int ret;
+
+  /* A single value is held in the IFD entry itself */
+
+  if (info->maxstrips > 1)
+    {
+      sbcpos = info->filefmt->sbcoffset + 4 * info->nstrips;
+      sopos  = sbcpos + 4 * info->maxstrips;
+    }
+  else
+    {
+      sbcpos = info->filefmt->sbcifdoffset + 8;
+      sopos  = info->filefmt->soifdoffset + 8;
+    }
+
+  if (lseek(info->outfd, sbcpos, SEEK_SET) == (off_t)-1)
+    {
+      return -errno;
+    }
+
+  ret = tiff_putint32(info->outfd, nbytes);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (lseek(info->outfd, sopos, SEEK_SET) == (off_t)-1)
+    {
+      return -errno;
+    }
+
+  ret = tiff_putint32(info->outfd, (uint32_t)offset);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* Return to the end of the file for the next strip */
+
+  if (lseek(info->outfd, 0, SEEK_END) == (off_t)-1)
+    {
+      return -errno;
+    }
+
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -174,22 +289,54 @@ int tiff_convstrip(FAR struct tiff_info_s *info, FAR const uint8_t *strip)
 int tiff_addstrip(FAR struct tiff_info_s *info, FAR const uint8_t *strip)
 {
   ssize_t newsize;
+  ssize_t nbytes;
+  off_t stripoff;
+  int fd;
   int ret;
 
+  /* In a single pass, the strip data goes directly to the outfile.
+   * Otherwise, it is collected in tmpfile2.
+   */
+
+  if (TIFF_SINGLEPASS(info))
+    {
+      if (info->nstrips >= info->maxstrips)
+        {
+          gerr("ERROR: More than %d strips\n", info->maxstrips);
+          ret = -E2BIG;
+          goto errout;
+        }
+
+      fd       = info->outfd;
+      stripoff = info->outsize;
+    }
+  else
+    {
+      fd       = info->tmp2fd;
+      stripoff = info->tmp2size;
+    }
+
+#ifdef HAVE_TIFF_COMPRESS
+  if (info->comp != NULL)
+    {
+      tiff_compress_begin(info, fd);
+    }
+#endif
+
   /* Add the new strip based on the color format.  For FB_FMT_RGB16_565,
    * will have to perform a conversion to RGB888.
    */
 
   if (info->colorfmt == FB_FMT_RGB16_565)
     {
-      ret = tiff_convstrip(info, strip);
+      ret = tiff_convstrip(info, fd, strip);
     }
 
   /* For other formats, it is a simple write using the number of bytes per strip */
 
   else
     {
-      ret = tiff_write(info->tmp2fd, strip, info->bps);
+      ret = tiff_putstrip(info, fd, strip, info->bps);
     }
 
   if (ret < 0)
@@ -197,35 +344,80 @@ int tiff_addstrip(FAR struct tiff_info_s *info, FAR const uint8_t *strip)
       goto errout;
     }
 
-  /* Write the byte count to the outfile and the offset to tmpfile1 */
+  /* Get the size of the strip data as written */
 
-  ret = tiff_putint32(info->outfd, info->bps);
-  if (ret < 0)
+  nbytes = info->bps;
+#ifdef HAVE_TIFF_COMPRESS
+  if (info->comp != NULL)
     {
-      goto errout;
+      nbytes = tiff_compress_end(info);
+      if (nbytes < 0)
+        {
+          ret = (int)nbytes;
+          goto errout;
+        }
     }
-  info->outsize += 4;
+#endif
 
-  ret = tiff_putint32(info->tmp1fd, info->tmp2size);
-  if (ret < 0)
+  if (TIFF_SINGLEPASS(info))
     {
-      goto errout;
-    }
-  info->tmp1size += 4;
+      /* Pad the outfile as necessary to achieve word alignment */
 
-  /* Increment the size of tmp2file. */
+      info->outsize += nbytes;
 
-  info->tmp2size += info->bps;
+      newsize = tiff_wordalign(info->outfd, info->outsize);
+      if (newsize < 0)
+        {
+          ret = (int)newsize;
+          goto errout;
+        }
+      info->outsize = (size_t)newsize;
 
-  /* Pad tmpfile2 as necessary achieve word alignment */
+#ifdef HAVE_TIFF_COMPRESS
+      /* The size of compressed strips was not known in advance */
 
-  newsize = tiff_wordalign(info->tmp2fd, info->tmp2size);
-  if (newsize < 0)
+      if (info->comp != NULL)
+        {
+          ret = tiff_putstripinfo(info, stripoff, nbytes);
+          if (ret < 0)
+            {
+              goto errout;
+            }
+        }
+#endif
+    }
+  else
     {
-      ret = (int)newsize;
-      goto errout;
+      /* Write the byte count to the outfile and the offset to tmpfile1 */
+
+      ret = tiff_putint32(info->outfd, nbytes);
+      if (ret < 0)
+        {
+          goto errout;
+        }
+      info->outsize += 4;
+
+      ret = tiff_putint32(info->tmp1fd, stripoff);
+      if (ret < 0)
+        {
+          goto errout;
+        }
+      info->tmp1size += 4;
+
+      /* Increment the size of tmp2file. */
+
+      info->tmp2size += nbytes;
+
+      /* Pad tmpfile2 as necessary achieve word alignment */
+
+      newsize = tiff_wordalign(info->tmp2fd, info->tmp2size);
+      if (newsize < 0)
+        {
+          ret = (int)newsize;
+          goto errout;
+        }
+      info->tmp2size = (size_t)newsize;
     }
-  info->tmp2size = (size_t)newsize;
 
   /* Increment the number of strips in the TIFF file */
 
@@ -236,4 +428,3 @@ errout:
   tiff_abort(info);
   return ret;
 }
-
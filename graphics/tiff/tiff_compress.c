@@ -0,0 +1,500 @@
+/****************************************************************************
+ * apps/graphics/tiff/tiff_compress.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include "graphics/tiff.h"
+
+#include "tiff_internal.h"
+
+#ifdef HAVE_TIFF_COMPRESS
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tiff_putbyte
+ *
+ * Description:
+ *   Add one byte of compressed output, writing the output buffer when it
+ *   becomes full.  Write errors are remembered and reported when the strip
+ *   is completed.
+ *
+ ****************************************************************************/
+
+static void tiff_putbyte(FAR struct tiff_compress_s *comp, uint8_t value)
+{
+  int ret;
+
+  comp->outbuf[comp->nout++] = value;
+  comp->nbytes++;
+
+  if (comp->nout >= comp->outsize)
+    {
+      ret = tiff_write(comp->fd, comp->outbuf, comp->nout);
+      if (ret < 0 && comp->errcode == OK)
+        {
+          comp->errcode = ret;
+        }
+
+      comp->nout = 0;
+    }
+}
+
+/****************************************************************************
+ * Name: tiff_packbits_*
+ *
+ * Description:
+ *   PackBits compression.  Three or more identical bytes are output as a
+ *   run (count byte 1-n followed by the repeated byte); anything else is
+ *   collected into literals (count byte n-1 followed by n bytes).  Neither
+ *   may exceed 128 bytes nor cross the end of a row.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_TIFF_PACKBITS
+static void tiff_packbits_literal(FAR struct tiff_compress_s *comp,
+                                  int nlit)
+{
+  int i;
+
+  if (nlit > 0)
+    {
+      tiff_putbyte(comp, (uint8_t)(nlit - 1));
+      for (i = 0; i < nlit; i++)
+        {
+          tiff_putbyte(comp, comp->lit[i]);
+        }
+    }
+}
+
+static void tiff_packbits_flush(FAR struct tiff_compress_s *comp)
+{
+  if (comp->nrun > 0)
+    {
+      tiff_putbyte(comp, (uint8_t)(1 - (int)comp->nrun));
+      tiff_putbyte(comp, comp->runbyte);
+      comp->nrun = 0;
+    }
+  else
+    {
+      tiff_packbits_literal(comp, comp->nlit);
+    }
+
+  comp->nlit = 0;
+}
+
+static void tiff_packbits_data(FAR struct tiff_compress_s *comp,
+                               FAR const uint8_t *buffer, size_t count)
+{
+  uint8_t value;
+  int nlit;
+
+  while (count-- > 0)
+    {
+      value = *buffer++;
+
+      /* Extend the current run if possible, otherwise output it */
+
+      if (comp->nrun > 0)
+        {
+          if (value == comp->runbyte && comp->nrun < TIFF_PACKBITS_MAXRUN)
+            {
+              comp->nrun++;
+              goto nextbyte;
+            }
+
+          tiff_packbits_flush(comp);
+        }
+
+      /* Add the byte to the literal.  When the literal ends with three
+       * identical bytes, output the preceding part and start a run.
+       */
+
+      nlit = comp->nlit;
+      comp->lit[nlit++] = value;
+
+      if (nlit >= 3 && comp->lit[nlit - 2] == value &&
+          comp->lit[nlit - 3] == value)
+        {
+          tiff_packbits_literal(comp, nlit - 3);
+          comp->runbyte = value;
+          comp->nrun    = 3;
+          nlit          = 0;
+        }
+      else if (nlit >= TIFF_PACKBITS_MAXRUN)
+        {
+          tiff_packbits_literal(comp, nlit);
+          nlit = 0;
+        }
+
+      comp->nlit = (uint8_t)nlit;
+
+nextbyte:
+      /* Runs and literals may not cross rows */
+
+      if (++comp->rowndx >= comp->rowbytes)
+        {
+          tiff_packbits_flush(comp);
+          comp->rowndx = 0;
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: tiff_lzw_*
+ *
+ * Description:
+ *   TIFF LZW compression:  Codes of 9 to 12 bits, most significant bit
+ *   first, that begin with a Clear code and end with an EndOfInformation
+ *   code.  The code width increases one code early ("early change") as
+ *   required by TIFF 6.0 decoders.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_TIFF_LZW
+static void tiff_lzw_putcode(FAR struct tiff_compress_s *comp,
+                             uint16_t code)
+{
+  comp->bitbuf  = (comp->bitbuf << comp->codelen) | code;
+  comp->nbits  += comp->codelen;
+
+  while (comp->nbits >= 8)
+    {
+      comp->nbits -= 8;
+      tiff_putbyte(comp, (uint8_t)(comp->bitbuf >> comp->nbits));
+    }
+
+  comp->bitbuf &= (1 << comp->nbits) - 1;
+}
+
+static void tiff_lzw_reset(FAR struct tiff_compress_s *comp)
+{
+  /* Forget all strings longer than one byte */
+
+  memset(comp->child, 0, 256 * sizeof(uint16_t));
+  comp->nextcode = TIFF_LZW_FIRST;
+  comp->codelen  = TIFF_LZW_MINBITS;
+}
+
+static void tiff_lzw_addcode(FAR struct tiff_compress_s *comp)
+{
+  /* Account for the string table entry that the decoder adds for every
+   * code after the first.  Reset the table when it is full; otherwise
+   * widen the codes when the next code would not fit.
+   */
+
+  comp->nextcode++;
+  if (comp->nextcode >= TIFF_LZW_FULL)
+    {
+      tiff_lzw_putcode(comp, TIFF_LZW_CLEAR);
+      tiff_lzw_reset(comp);
+    }
+  else if (comp->nextcode >= (1 << comp->codelen))
+    {
+      comp->codelen++;
+    }
+}
+
+static void tiff_lzw_data(FAR struct tiff_compress_s *comp,
+                          FAR const uint8_t *buffer, size_t count)
+{
+  uint16_t prefix = comp->prefix;
+  uint16_t code;
+  uint8_t value;
+
+  if (count > 0 && prefix == TIFF_LZW_NONE)
+    {
+      prefix = *buffer++;
+      count--;
+    }
+
+  while (count-- > 0)
+    {
+      value = *buffer++;
+
+      /* Is prefix + value already in the table? */
+
+      for (code = comp->child[prefix];
+           code != 0 && comp->suffix[code] != value;
+           code = comp->sibling[code]);
+
+      if (code != 0)
+        {
+          prefix = code;
+          continue;
+        }
+
+      /* No.. output the prefix and add prefix + value to the table */
+
+      tiff_lzw_putcode(comp, prefix);
+
+      code                = comp->nextcode;
+      comp->suffix[code]  = value;
+      comp->child[code]   = 0;
+      comp->sibling[code] = comp->child[prefix];
+      comp->child[prefix] = code;
+
+      tiff_lzw_addcode(comp);
+      prefix = value;
+    }
+
+  comp->prefix = prefix;
+}
+
+static void tiff_lzw_end(FAR struct tiff_compress_s *comp)
+{
+  if (comp->prefix != TIFF_LZW_NONE)
+    {
+      tiff_lzw_putcode(comp, comp->prefix);
+      tiff_lzw_addcode(comp);
+    }
+
+  tiff_lzw_putcode(comp, TIFF_LZW_EOI);
+
+  /* Output any partial byte, padded with zeros */
+
+  if (comp->nbits > 0)
+    {
+      tiff_putbyte(comp, (uint8_t)(comp->bitbuf << (8 - comp->nbits)));
+      comp->nbits = 0;
+    }
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tiff_compress_initialize
+ *
+ * Description:
+ *   Allocate and initialize the compressor selected by info->compress.
+ *
+ ****************************************************************************/
+
+int tiff_compress_initialize(FAR struct tiff_info_s *info)
+{
+  FAR struct tiff_compress_s *comp;
+  size_t allocsize;
+
+  DEBUGASSERT(info->comp == NULL);
+
+  if (info->iosize < 8)
+    {
+      return -EINVAL;
+    }
+
+  allocsize = sizeof(struct tiff_compress_s);
+#ifdef CONFIG_TIFF_LZW
+  if (info->compress == TAG_COMP_LZW)
+    {
+      allocsize += TIFF_LZW_TABSIZE *
+                   (2 * sizeof(uint16_t) + sizeof(uint8_t));
+    }
+#endif
+
+  comp = (FAR struct tiff_compress_s *)zalloc(allocsize);
+  if (comp == NULL)
+    {
+      gerr("ERROR: Failed to allocate the compressor\n");
+      return -ENOMEM;
+    }
+
+  /* The lower half of the I/O buffer is left for color conversion */
+
+  comp->outsize = info->iosize >> 1;
+  comp->outbuf  = info->iobuffer + (info->iosize - comp->outsize);
+
+#ifdef CONFIG_TIFF_PACKBITS
+  /* Each row of the strip is packed separately */
+
+  comp->rowbytes = info->bps / info->rps;
+#endif
+
+#ifdef CONFIG_TIFF_LZW
+  if (info->compress == TAG_COMP_LZW)
+    {
+      comp->child   = (FAR uint16_t *)&comp[1];
+      comp->sibling = &comp->child[TIFF_LZW_TABSIZE];
+      comp->suffix  = (FAR uint8_t *)&comp->sibling[TIFF_LZW_TABSIZE];
+    }
+#endif
+
+  info->comp = comp;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tiff_compress_uninitialize
+ *
+ * Description:
+ *   Free the compressor state, if any.
+ *
+ ****************************************************************************/
+
+void tiff_compress_uninitialize(FAR struct tiff_info_s *info)
+{
+  if (info->comp != NULL)
+    {
+      free(info->comp);
+      info->comp = NULL;
+    }
+}
+
+/****************************************************************************
+ * Name: tiff_compress_begin
+ *
+ * Description:
+ *   Begin a new compressed strip.
+ *
+ ****************************************************************************/
+
+void tiff_compress_begin(FAR struct tiff_info_s *info, int fd)
+{
+  FAR struct tiff_compress_s *comp = info->comp;
+
+  comp->fd      = fd;
+  comp->errcode = OK;
+  comp->nout    = 0;
+  comp->nbytes  = 0;
+
+#ifdef CONFIG_TIFF_PACKBITS
+  comp->rowndx  = 0;
+  comp->nlit    = 0;
+  comp->nrun    = 0;
+#endif
+
+#ifdef CONFIG_TIFF_LZW
+  if (info->compress == TAG_COMP_LZW)
+    {
+      /* Each strip starts with a Clear code and an empty table */
+
+      comp->bitbuf  = 0;
+      comp->nbits   = 0;
+      comp->prefix  = TIFF_LZW_NONE;
+
+      tiff_lzw_reset(comp);
+      tiff_lzw_putcode(comp, TIFF_LZW_CLEAR);
+    }
+#endif
+}
+
+/****************************************************************************
+ * Name: tiff_compress_data
+ *
+ * Description:
+ *   Compress the next part of the current strip.
+ *
+ ****************************************************************************/
+
+int tiff_compress_data(FAR struct tiff_info_s *info,
+                       FAR const uint8_t *buffer, size_t count)
+{
+  FAR struct tiff_compress_s *comp = info->comp;
+
+#ifdef CONFIG_TIFF_LZW
+  if (info->compress == TAG_COMP_LZW)
+    {
+      tiff_lzw_data(comp, buffer, count);
+    }
+#endif
+
+#ifdef CONFIG_TIFF_PACKBITS
+  if (info->compress == TAG_COMP_PACKBITS)
+    {
+      tiff_packbits_data(comp, buffer, count);
+    }
+#endif
+
+  return comp->errcode;
+}
+
+/****************************************************************************
+ * Name: tiff_compress_end
+ *
+ * Description:
+ *   Complete the current strip and write all remaining output.
+ *
+ ****************************************************************************/
+
+ssize_t tiff_compress_end(FAR struct tiff_info_s *info)
+{
+  FAR struct tiff_compress_s *comp = info->comp;
+  int ret;
+
+#ifdef CONFIG_TIFF_LZW
+  if (info->compress == TAG_COMP_LZW)
+    {
+      tiff_lzw_end(comp);
+    }
+#endif
+
+#ifdef CONFIG_TIFF_PACKBITS
+  if (info->compress == TAG_COMP_PACKBITS)
+    {
+      tiff_packbits_flush(comp);
+    }
+#endif
+
+  if (comp->errcode < 0)
+    {
+      return comp->errcode;
+    }
+
+  ret = tiff_write(comp->fd, comp->outbuf, comp->nout);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  comp->nout = 0;
+  return (ssize_t)comp->nbytes;
+}
+
+#endif /* HAVE_TIFF_COMPRESS */
@@ -179,8 +179,17 @@ static void tiff_cleanup(FAR struct tiff_info_s *info)
 
   /* And remove the temporary files */
 
-  (void)unlink(info->tmpfile1);
-  (void)unlink(info->tmpfile2);
+  if (!TIFF_SINGLEPASS(info))
+    {
+      (void)unlink(info->tmpfile1);
+      (void)unlink(info->tmpfile2);
+    }
+
+#ifdef HAVE_TIFF_COMPRESS
+  /* Free the compressor */
+
+  tiff_compress_uninitialize(info);
+#endif
 }
 
 /****************************************************************************
@@ -228,7 +237,27 @@ int tiff_finalize(FAR struct tiff_info_s *info)
    *    no fixups are required.
    */
 
-  DEBUGASSERT(info && info->outfd >= 0 && info->tmp1fd >= 0 && info->tmp2fd >= 0);
+  DEBUGASSERT(info && info->outfd >= 0);
+
+  /* When the file is created in a single pass, the strip data and the
+   * StripOffsets and StripByteCounts are already in place.
+   */
+
+  if (TIFF_SINGLEPASS(info))
+    {
+      if (info->nstrips != info->maxstrips)
+        {
+          gerr("ERROR: %d of %d strips added\n",
+               info->nstrips, info->maxstrips);
+          ret = -EINVAL;
+          goto errout;
+        }
+
+      tiff_cleanup(info);
+      return OK;
+    }
+
+  DEBUGASSERT(info->tmp1fd >= 0 && info->tmp2fd >= 0);
   DEBUGASSERT((info->outsize & 3) == 0 && (info->tmp1size & 3) == 0);
 
   /* Fix-up the count value in the StripByteCounts IFD entry in the outfile.
@@ -244,6 +273,24 @@ int tiff_finalize(FAR struct tiff_info_s *info)
 
   tiff_put32(ifdentry.count, info->nstrips);
 
+  /* A single value must be held in the IFD entry itself */
+
+  if (info->nstrips == 1)
+    {
+      offset = lseek(info->outfd, info->filefmt->sbcoffset, SEEK_SET);
+      if (offset == (off_t)-1)
+        {
+          ret = -errno;
+          goto errout;
+        }
+
+      if (tiff_read(info->outfd, ifdentry.offset, 4) != 4)
+        {
+          ret = -ENOSPC;
+          goto errout;
+        }
+    }
+
   ret = tiff_writeifdentry(info->outfd, info->filefmt->sbcifdoffset, &ifdentry);
   if (ret < 0)
     {
@@ -262,7 +309,8 @@ int tiff_finalize(FAR struct tiff_info_s *info)
     }
 
   tiff_put32(ifdentry.count, info->nstrips);
-  tiff_put32(ifdentry.offset, info->outsize);
+  tiff_put32(ifdentry.offset, info->nstrips == 1 ?
+             info->outsize + info->tmp1size : info->outsize);
 
   ret = tiff_writeifdentry(info->outfd, info->filefmt->soifdoffset, &ifdentry);
   if (ret < 0)
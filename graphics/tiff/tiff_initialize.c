@@ -87,6 +87,12 @@
  *          xxx    StripOffsets                Beginning of strip offsets
  *          xxx    [Probably padding]
  *          xxx    Data for strips             Beginning of strip data
+ *
+ * When the file is created in a single pass, the StripByteCounts and
+ * StripOffsets are reserved by tiff_initialize() and the strip data
+ * follows them directly.  If there is only one strip, there are no
+ * StripByteCounts or StripOffsets values;  the single value is held in
+ * the IFD entry itself.
  */
 
 #define TIFF_IFD_OFFSET           (SIZEOF_TIFF_HEADER+2)
@@ -429,6 +435,74 @@ static int tiff_datetime(FAR char *timbuf, unsigned int buflen)
   return OK;
 }
 
+/****************************************************************************
+ * Name: tiff_putstripinfo
+ *
+ * Description:
+ *   Reserve space for the StripByteCounts and StripOffsets in a file that
+ *   is created in a single pass.  These are filled with the values for
+ *   uncompressed strips;  tiff_addstrip() corrects them for compressed
+ *   strips.
+ *
+ * Input Parameters:
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int tiff_putstripinfo(FAR struct tiff_info_s *info)
+{
+  FAR uint8_t *ptr;
+  uint32_t stripsize;
+  uint32_t dataoff;
+  size_t maxvalues;
+  size_t nvalues;
+  int strip;
+  int pass;
+  int ret;
+
+  /* Each strip is padded to a word boundary; the strip data begins after
+   * the StripByteCounts and StripOffsets.
+   */
+
+  stripsize = (info->bps + 3) & ~3;
+  dataoff   = info->filefmt->sbcoffset + 8 * info->maxstrips;
+  maxvalues = info->iosize >> 2;
+
+  /* Pass 0 writes the StripByteCounts, pass 1 the StripOffsets */
+
+  for (pass = 0; pass < 2; pass++)
+    {
+      for (strip = 0; strip < info->maxstrips; )
+        {
+          nvalues = info->maxstrips - strip;
+          if (nvalues > maxvalues)
+            {
+              nvalues = maxvalues;
+            }
+
+          for (ptr = info->iobuffer;
+               ptr < info->iobuffer + (nvalues << 2);
+               ptr += 4, strip++)
+            {
+              tiff_put32(ptr, pass == 0 ? info->bps :
+                                          dataoff + strip * stripsize);
+            }
+
+          ret = tiff_write(info->outfd, info->iobuffer, nvalues << 2);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+    }
+
+  return OK;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -454,9 +528,16 @@ int tiff_initialize(FAR struct tiff_info_s *info)
   off_t offset = 0;
 #endif
   char timbuf[TIFF_DATETIME_STRLEN + 8];
+  uint32_t sooffset;
+  uint32_t sbcoffset;
   int ret = -EINVAL;
 
-  DEBUGASSERT(info && info->outfile && info->tmpfile1 && info->tmpfile2);
+  DEBUGASSERT(info && info->outfile && info->rps > 0 &&
+              (info->tmpfile1 == NULL) == (info->tmpfile2 == NULL));
+
+  info->outfd  = -1;
+  info->tmp1fd = -1;
+  info->tmp2fd = -1;
 
   /* Open all output files */
 
@@ -468,20 +549,27 @@ int tiff_initialize(FAR struct tiff_info_s *info)
       goto errout;
     }
 
-  info->tmp1fd = open(info->tmpfile1, O_RDWR|O_CREAT|O_TRUNC, 0666);
-  if (info->tmp1fd < 0)
-    {
-      gerr("ERROR: Failed to open %s for reading/writing: %d\n",
-           info->tmpfile1, errno);
-      goto errout;
-    }
+  /* The temporary files are not used if the file is created in a single
+   * pass.
+   */
 
-  info->tmp2fd = open(info->tmpfile2, O_RDWR|O_CREAT|O_TRUNC, 0666);
-  if (info->tmp2fd < 0)
+  if (!TIFF_SINGLEPASS(info))
     {
-      gerr("ERROR: Failed to open %s for reading/writing: %d\n",
-           info->tmpfile2, errno);
-      goto errout;
+      info->tmp1fd = open(info->tmpfile1, O_RDWR|O_CREAT|O_TRUNC, 0666);
+      if (info->tmp1fd < 0)
+        {
+          gerr("ERROR: Failed to open %s for reading/writing: %d\n",
+               info->tmpfile1, errno);
+          goto errout;
+        }
+
+      info->tmp2fd = open(info->tmpfile2, O_RDWR|O_CREAT|O_TRUNC, 0666);
+      if (info->tmp2fd < 0)
+        {
+          gerr("ERROR: Failed to open %s for reading/writing: %d\n",
+               info->tmpfile2, errno);
+          goto errout;
+        }
     }
 
   /* Make some decisions using the color format.  Only the following are
@@ -526,6 +614,60 @@ int tiff_initialize(FAR struct tiff_info_s *info)
         return -EINVAL;
     }
 
+  /* Set up the strip compression */
+
+  switch (info->compress)
+    {
+      case 0:
+        info->compress = TAG_COMP_NONE;
+        break;
+
+      case TAG_COMP_NONE:
+        break;
+
+#ifdef CONFIG_TIFF_PACKBITS
+      case TAG_COMP_PACKBITS:
+#endif
+#ifdef CONFIG_TIFF_LZW
+      case TAG_COMP_LZW:
+#endif
+#ifdef HAVE_TIFF_COMPRESS
+        ret = tiff_compress_initialize(info);
+        if (ret < 0)
+          {
+            goto errout;
+          }
+        break;
+#endif
+
+      default:
+        gerr("ERROR: Unsupported compression: %u\n", info->compress);
+        ret = -ENOSYS;
+        goto errout;
+    }
+
+  /* Get the location of the StripOffsets and StripByteCounts values.  In a
+   * single pass, the number of strips is known now.  A single value is
+   * held in the IFD entry.
+   */
+
+  sbcoffset = info->filefmt->sbcoffset;
+  sooffset  = 0;
+
+  if (TIFF_SINGLEPASS(info))
+    {
+      info->maxstrips = (info->imgheight + info->rps - 1) / info->rps;
+      if (info->maxstrips > 1)
+        {
+          sooffset = sbcoffset + 4 * info->maxstrips;
+        }
+      else
+        {
+          sooffset  = sbcoffset;
+          sbcoffset = info->bps;
+        }
+    }
+
   /* Write the TIFF header data to the outfile:
    *
    * Header:    0    Byte Order                  "II" or "MM"
@@ -621,12 +763,12 @@ int tiff_initialize(FAR struct tiff_info_s *info)
 
   /* Write Compression:
    *
-   * Bi-level Images: Offset 48 Hard-coded no compression (for now)
-   * Greyscale:       Offset 60  "  " "   " "" "          " " " " "
-   * RGB:             Offset 60 "  " "   " "" "          " " " " "
+   * Bi-level Images: Offset 48 Value is a user parameter
+   * Greyscale:       Offset 60 Value is a user parameter
+   * RGB:             Offset 60 Value is a user parameter
    */
 
-  ret = tiff_putifdentry16(info, IFD_TAG_COMPRESSION, IFD_FIELD_SHORT, 1, TAG_COMP_NONE);
+  ret = tiff_putifdentry16(info, IFD_TAG_COMPRESSION, IFD_FIELD_SHORT, 1, info->compress);
   if (ret < 0)
     {
       goto errout;
@@ -664,7 +806,7 @@ int tiff_initialize(FAR struct tiff_info_s *info)
    */
 
   tiff_checkoffs(offset, info->filefmt->soifdoffset);
-  ret = tiff_putifdentry(info, IFD_TAG_STRIPOFFSETS, IFD_FIELD_LONG, 0, 0);
+  ret = tiff_putifdentry(info, IFD_TAG_STRIPOFFSETS, IFD_FIELD_LONG, info->maxstrips, sooffset);
   if (ret < 0)
     {
       goto errout;
@@ -710,7 +852,7 @@ int tiff_initialize(FAR struct tiff_info_s *info)
    */
 
   tiff_checkoffs(offset, info->filefmt->sbcifdoffset);
-  ret = tiff_putifdentry(info, IFD_TAG_STRIPCOUNTS, IFD_FIELD_LONG, 0, info->filefmt->sbcoffset);
+  ret = tiff_putifdentry(info, IFD_TAG_STRIPCOUNTS, IFD_FIELD_LONG, info->maxstrips, sbcoffset);
   if (ret < 0)
     {
       goto errout;
@@ -900,10 +1042,24 @@ int tiff_initialize(FAR struct tiff_info_s *info)
     }
   tiff_offset(offset, 2);
 
-  /* And that should do it! */
+  /* And that should do it!  Unless the file is created in a single pass,
+   * then the StripByteCounts and StripOffsets follow.
+   */
 
   tiff_checkoffs(offset, info->filefmt->sbcoffset);
   info->outsize = info->filefmt->sbcoffset;
+
+  if (info->maxstrips > 1)
+    {
+      ret = tiff_putstripinfo(info);
+      if (ret < 0)
+        {
+          goto errout;
+        }
+
+      info->outsize += 8 * info->maxstrips;
+    }
+
   return OK;
 
 errout:
@@ -76,10 +76,78 @@
 #define IMGFLAGS_ISRGB(f) \
   (((f) & IMGFLAGS_FMT_RGB24) != 0)
 
+/* Single pass creation (no temporary files) ********************************/
+
+#define TIFF_SINGLEPASS(i)     ((i)->tmpfile1 == NULL)
+
+/* Compression **************************************************************/
+
+#if defined(CONFIG_TIFF_PACKBITS) || defined(CONFIG_TIFF_LZW)
+#  define HAVE_TIFF_COMPRESS 1
+#endif
+
+#define TIFF_PACKBITS_MAXRUN   128   /* Longest PackBits run or literal */
+
+#define TIFF_LZW_CLEAR         256   /* Clear code */
+#define TIFF_LZW_EOI           257   /* End of information code */
+#define TIFF_LZW_FIRST         258   /* First string code */
+#define TIFF_LZW_FULL          4094  /* Table is reset at this code */
+#define TIFF_LZW_TABSIZE       4096  /* Number of codes (12-bit codes) */
+#define TIFF_LZW_MINBITS       9     /* Initial code width */
+#define TIFF_LZW_NONE          0xffff
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
+#ifdef HAVE_TIFF_COMPRESS
+/* State of the strip compressor.  This is allocated by tiff_initialize()
+ * when the strips are to be compressed.  Each strip is compressed
+ * independently.  Compressed output is collected in the upper half of the
+ * caller's I/O buffer and written when that fills.
+ */
+
+struct tiff_compress_s
+{
+  /* Compressed output */
+
+  int fd;                   /* File receiving the compressed strip */
+  int errcode;              /* First write error (negated errno) */
+  FAR uint8_t *outbuf;      /* Output buffer (part of the I/O buffer) */
+  size_t outsize;           /* Size of the output buffer */
+  size_t nout;              /* Number of bytes in the output buffer */
+  uint32_t nbytes;          /* Compressed size of the current strip */
+
+#ifdef CONFIG_TIFF_PACKBITS
+  /* PackBits.  Rows are compressed separately as required by TIFF. */
+
+  size_t rowbytes;          /* Bytes in one uncompressed row */
+  size_t rowndx;            /* Bytes of the current row seen so far */
+  uint8_t nlit;             /* Number of bytes in lit[] */
+  uint8_t nrun;             /* Length of the current run (0=none) */
+  uint8_t runbyte;          /* The repeated byte of the current run */
+  uint8_t lit[TIFF_PACKBITS_MAXRUN]; /* Pending literal bytes */
+#endif
+
+#ifdef CONFIG_TIFF_LZW
+  /* LZW.  The string table is kept as a tree:  child[] is the first
+   * extension of a string, sibling[] the next extension of the same
+   * prefix, and suffix[] the final byte of each string.  The tables follow
+   * this structure in memory.
+   */
+
+  uint32_t bitbuf;          /* Bits not yet output (LS bits are valid) */
+  uint8_t nbits;            /* Number of valid bits in bitbuf */
+  uint8_t codelen;          /* Current code width in bits */
+  uint16_t nextcode;        /* Next code to be assigned */
+  uint16_t prefix;          /* Code of the current string */
+  FAR uint16_t *child;      /* First extension of each string */
+  FAR uint16_t *sibling;    /* Next extension of the same prefix */
+  FAR uint8_t *suffix;      /* Final byte of each string */
+#endif
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -203,6 +271,98 @@ int tiff_putstring(int fd, FAR const char *string, int len);
 
 ssize_t tiff_wordalign(int fd, size_t size);
 
+/****************************************************************************
+ * Name: tiff_compress_initialize
+ *
+ * Description:
+ *   Allocate and initialize the compressor selected by info->compress.
+ *
+ * Input Parameters:
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_TIFF_COMPRESS
+int tiff_compress_initialize(FAR struct tiff_info_s *info);
+
+/****************************************************************************
+ * Name: tiff_compress_uninitialize
+ *
+ * Description:
+ *   Free the compressor state, if any.
+ *
+ * Input Parameters:
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void tiff_compress_uninitialize(FAR struct tiff_info_s *info);
+
+/****************************************************************************
+ * Name: tiff_compress_begin
+ *
+ * Description:
+ *   Begin a new compressed strip.
+ *
+ * Input Parameters:
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
+ *   fd   - The file that will receive the compressed strip.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void tiff_compress_begin(FAR struct tiff_info_s *info, int fd);
+
+/****************************************************************************
+ * Name: tiff_compress_data
+ *
+ * Description:
+ *   Compress the next part of the current strip.
+ *
+ * Input Parameters:
+ *   info   - A pointer to the caller allocated parameter passing/TIFF state
+ *            instance.
+ *   buffer - The uncompressed strip data
+ *   count  - The number of bytes in buffer
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int tiff_compress_data(FAR struct tiff_info_s *info,
+                       FAR const uint8_t *buffer, size_t count);
+
+/****************************************************************************
+ * Name: tiff_compress_end
+ *
+ * Description:
+ *   Complete the current strip and write all remaining output.
+ *
+ * Input Parameters:
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
+ *
+ * Returned Value:
+ *   The compressed size of the strip on success.  A negated errno value on
+ *   failure.
+ *
+ ****************************************************************************/
+
+ssize_t tiff_compress_end(FAR struct tiff_info_s *info);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -88,10 +88,10 @@ struct trv_graphics_info_s
   NXHANDLE bgwnd;               /* Background window handle */
 #else
   int fb;                       /* Framebuffer device file descriptor */
+#endif
   trv_coord_t xoffset;          /* Horizontal offset to start of data (pixels) */
   trv_coord_t yoffset;          /* Vertical offset to start of data (rows) */
-  trv_coord_t stride;           /* Length of a line (bytes) */
-#endif
+  trv_coord_t stride;           /* Length of a line in hwbuffer (bytes) */
   trv_coord_t xres;             /* Physical display width (pixels) */
   trv_coord_t yres;             /* Physical display height (rows) */
   trv_coord_t imgwidth;         /* Width of visible display region (bytes) */
@@ -107,7 +107,7 @@ struct trv_graphics_info_s
  ****************************************************************************/
 
 #ifdef CONFIG_GRAPHICS_TRAVELER_NX
-extern FAR const struct nx_callback_s *g_trv_nxcallback;
+extern const struct nx_callback_s g_trv_nxcallback;
 extern sem_t g_trv_nxevent;
 extern volatile bool g_trv_nxresolution;
 extern volatile bool g_trv_nxrconnected;
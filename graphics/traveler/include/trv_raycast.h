@@ -42,6 +42,7 @@
  ****************************************************************************/
 
 #include "trv_types.h"
+#include "trv_world.h"
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -128,34 +129,48 @@ struct trv_raycast_s
   int16_t zdist;    /* Z distance to the hit (not used) */
 };
 
-/****************************************************************************
- * Public Data
- ****************************************************************************/
-
-/* This structure holds pre-calculated pitch data for all ray casts.  NOTE:
- * would be a performance improvement if this structure is an even power of
- *two in size (don't have to multiply to calculate indices)
+/* This structure holds the working state of one ray caster.  Each render
+ * thread has its own instance so that several column bands of the same
+ * horizontal swathe may be cast and rendered concurrently.
  */
 
-/* The following array describes the hits from X/Y/Z-ray casting for the
- * current HGULP_SIZE x VGULP_SIZE cell
- */
+struct trv_raystate_s
+{
+  /* The camera position with the pitch and yaw of the current cast */
 
-extern struct trv_raycast_s g_ray_hit[VGULP_SIZE][HGULP_SIZE+1];
+  struct trv_camera_s camera;
 
-/* This structure points to the double buffer row corresponding to the
- * pitch angle
- */
+  /* The tangent and the cotangent of the pitch angle adjusted for the
+   * viewing yaw angle (see trv_raycast())
+   */
 
-extern uint8_t *g_buffer_row[VGULP_SIZE];
+  int32_t adj_tanpitch;
+  int32_t adj_cotpitch;
 
-/* The is the "column" offset in g_buffer_row for the current cell being
- * operated on.  This value is updated in a loop by trv_raycaster.
- */
+  /* This is the "column" offset in buffer_row for the current cell being
+   * operated on.  This value is updated in a loop by trv_raycaster.
+   */
+
+  int16_t cell_column;
 
-extern int16_t g_cell_column;
+  /* This points to the render buffer row corresponding to each pitch angle
+   * of the current swathe.
+   */
+
+  FAR uint8_t *buffer_row[VGULP_SIZE];
+
+  /* The following array describes the hits from X/Y/Z-ray casting for the
+   * current HGULP_SIZE x VGULP_SIZE cell
+   */
+
+  struct trv_raycast_s hit[VGULP_SIZE][HGULP_SIZE+1];
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
 
-/* This structure holds the parameters used in the current ray cast */
+/* This structure holds the camera parameters used in the current frame */
 
 extern struct trv_camera_s g_camera;
 
@@ -163,7 +178,8 @@ extern struct trv_camera_s g_camera;
  * Public Function Prototypes
  ****************************************************************************/
 
-void trv_raycast(int16_t pitch, int16_t yaw, int16_t screenyaw,
+void trv_raycast(FAR struct trv_raystate_s *state, int16_t pitch,
+                 int16_t yaw, int16_t screenyaw,
                  FAR struct trv_raycast_s *result);
 
 #endif /* __APPS_GRAPHICS_TRAVELER_INCLUDE_TRV_RAYCAST_H */
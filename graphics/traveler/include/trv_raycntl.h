@@ -61,9 +61,13 @@
 
 struct trv_camera_s;
 struct trv_graphics_info_s;
+struct trv_raystate_s;
 
+int trv_raycaster_initialize(int nthreads);
+void trv_raycaster_terminate(void);
 void trv_raycaster(FAR struct trv_camera_s *player,
                    FAR struct trv_graphics_info_s *ginfo);
-uint8_t trv_get_texture(uint8_t row, uint8_t col);
+uint8_t trv_get_texture(FAR struct trv_raystate_s *state,
+                        uint8_t row, uint8_t col);
 
 #endif /* __APPS_GRAPHICS_TRAVELER_INCLUDE_TRV_RAYCNTL_H */
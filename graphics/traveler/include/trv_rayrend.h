@@ -83,13 +83,18 @@
 struct trv_camera_s;
 struct trv_graphics_info_s;
 struct trv_bitmap_s;
+struct trv_raystate_s;
 
 void trv_rend_backdrop(FAR struct trv_camera_s *camera,
                        FAR struct trv_graphics_info_s *ginfo);
-void trv_rend_cell(uint8_t row, uint8_t col, uint8_t height, uint8_t width);
-void trv_rend_row(uint8_t row, uint8_t col, uint8_t width);
-void trv_rend_column(uint8_t row, uint8_t col, uint8_t height);
-void trv_rend_pixel(uint8_t row, uint8_t col);
+void trv_rend_cell(FAR struct trv_raystate_s *state, uint8_t row,
+                   uint8_t col, uint8_t height, uint8_t width);
+void trv_rend_row(FAR struct trv_raystate_s *state, uint8_t row,
+                  uint8_t col, uint8_t width);
+void trv_rend_column(FAR struct trv_raystate_s *state, uint8_t row,
+                     uint8_t col, uint8_t height);
+void trv_rend_pixel(FAR struct trv_raystate_s *state, uint8_t row,
+                    uint8_t col);
 trv_pixel_t trv_get_rectpixel(int16_t hPos, int16_t vPos,
                               FAR struct trv_bitmap_s *bmp, uint8_t scale);
 
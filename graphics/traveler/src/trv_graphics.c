@@ -50,9 +50,9 @@
 #  include <sys/ioctl.h>
 #  include <sys/mman.h>
 #  include <fcntl.h>
-#  include <errno.h>
 #endif
 #include <string.h>
+#include <errno.h>
 #include <semaphore.h>
 
 #ifdef CONFIG_GRAPHICS_TRAVELER_FB
@@ -62,15 +62,31 @@
 #  include <nuttx/video/vnc.h>
 #endif
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* With 16-bit pixels, two adjacent device pixels are written as one 32-bit
+ * word.  TRV_PIXPAIR() forms that word from the pixel at the lower address
+ * (a) and the pixel at the higher address (b).
+ */
+
+#if TRV_BPP == 16
+#  ifdef CONFIG_ENDIAN_BIG
+#    define TRV_PIXPAIR(a,b) (((uint32_t)(a) << 16) | (uint32_t)(b))
+#  else
+#    define TRV_PIXPAIR(a,b) ((uint32_t)(a) | ((uint32_t)(b) << 16))
+#  endif
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
 
 #ifdef CONFIG_GRAPHICS_TRAVELER_NX
-FAR const struct nx_callback_s *g_trv_nxcallback;
 sem_t g_trv_nxevent = SEM_INITIZIALIZER(0);
-bool g_trv_nxresolution = false;
-bool g_trv_nxrconnected = false;
+volatile bool g_trv_nxresolution = false;
+volatile bool g_trv_nxrconnected = false;
 #endif
 
 /****************************************************************************
@@ -88,9 +104,11 @@ bool g_trv_nxrconnected = false;
 #ifdef CONFIG_GRAPHICS_TRAVELER_NX
 static void trv_use_bgwindow(FAR struct trv_graphics_info_s *ginfo)
 {
+  int ret;
+
   /* Get the background window */
 
-  ret = nx_requestbkgd(g_hnx, &g_trv_nxcallback, ginfo);
+  ret = nx_requestbkgd(ginfo->hnx, &g_trv_nxcallback, ginfo);
   if (ret < 0)
     {
       trv_abort("nx_requestbkgd failed: %d\n", errno);
@@ -290,30 +308,135 @@ static inline int trv_nx_initialize(FAR struct trv_graphics_info_s *ginfo)
  * Name: trv_row_update
  *
  * Description:
- *   Expand one one either directly into the frame buffer or else into an
- *   intermediate line buffer.
+ *   Expand one row from the render buffer into the device row, mapping
+ *   each pixel through the palette and replicating it xscale times.
+ *
+ *   This is where every displayed pixel passes, so the common scale
+ *   factors are handled separately and, for 16-bit pixels, two device
+ *   pixels are written with each 32-bit store whenever the destination is
+ *   word aligned.
  *
  ****************************************************************************/
 
-void trv_row_update(struct trv_graphics_info_s *ginfo,
-                    FAR const trv_pixel_t *src,
-                    FAR dev_pixel_t *dest)
+static void trv_row_update(FAR struct trv_graphics_info_s *ginfo,
+                           FAR const trv_pixel_t *src,
+                           FAR dev_pixel_t *dest)
 {
+  FAR const dev_pixel_t *lut = ginfo->palette.lut;
+  FAR const trv_pixel_t *end = src + TRV_SCREEN_WIDTH;
+  int xscale = ginfo->xscale;
+#if TRV_BPP == 16
+  FAR uint32_t *dest32;
+  uint32_t pair;
+#endif
   dev_pixel_t pixel;
-  trv_coord_t srccol;
   int i;
 
-  /* Loop for each column in the src render buffer */
+#if TRV_BPP == 16
+  if (xscale == 1)
+    {
+      /* Get the destination word aligned by writing one pixel */
+
+      if (((uintptr_t)dest & 3) != 0)
+        {
+          *dest++ = lut[*src++];
+        }
+
+      /* Then map and store two pixels at a time */
+
+      dest32 = (FAR uint32_t *)dest;
+      while (src + 1 < end)
+        {
+          *dest32++ = TRV_PIXPAIR(lut[src[0]], lut[src[1]]);
+          src += 2;
+        }
+
+      /* There may be one pixel left over */
+
+      if (src < end)
+        {
+          *(FAR dev_pixel_t *)dest32 = lut[*src];
+        }
 
-  for (srccol = 0; srccol < TRV_SCREEN_WIDTH; srccol++)
+      return;
+    }
+  else if ((xscale & 1) == 0 && ((uintptr_t)dest & 3) == 0)
+    {
+      /* Even scale factors are a whole number of pixel pairs */
+
+      dest32 = (FAR uint32_t *)dest;
+
+      if (xscale == 2)
+        {
+          while (src < end)
+            {
+              pixel     = lut[*src++];
+              *dest32++ = TRV_PIXPAIR(pixel, pixel);
+            }
+        }
+      else
+        {
+          xscale >>= 1;
+
+          while (src < end)
+            {
+              pixel = lut[*src++];
+              pair  = TRV_PIXPAIR(pixel, pixel);
+
+              for (i = 0; i < xscale; i++)
+                {
+                  *dest32++ = pair;
+                }
+            }
+        }
+
+      return;
+    }
+#else
+  if (xscale == 1)
+    {
+      /* Device pixels are already full words; just unroll the loop */
+
+      while (src + 3 < end)
+        {
+          dest[0] = lut[src[0]];
+          dest[1] = lut[src[1]];
+          dest[2] = lut[src[2]];
+          dest[3] = lut[src[3]];
+          dest   += 4;
+          src    += 4;
+        }
+
+      while (src < end)
+        {
+          *dest++ = lut[*src++];
+        }
+
+      return;
+    }
+  else if (xscale == 2)
     {
-      /* Map the source pixel */
+      while (src < end)
+        {
+          pixel   = lut[*src++];
+          dest[0] = pixel;
+          dest[1] = pixel;
+          dest   += 2;
+        }
 
-      pixel = ginfo->palette.lut[*src++];
+      return;
+    }
+#endif
 
-      /* Expand pixels horizontally via pixel replication */
+  /* Any other scale factor:  Expand pixels horizontally via pixel
+   * replication.
+   */
 
-      for (i = 0; i < ginfo->xscale; i++)
+  while (src < end)
+    {
+      pixel = lut[*src++];
+
+      for (i = 0; i < xscale; i++)
         {
           *dest++ = pixel;
         }
@@ -321,20 +444,41 @@ void trv_row_update(struct trv_graphics_info_s *ginfo,
 }
 
 /****************************************************************************
- * Name: trv_row_transfer
+ * Name: trv_frame_transfer
  *
  * Description:
- *   Transfer one line from the line buffer to the NX window.
+ *   Transfer the expanded image to the NX window.  The whole frame is
+ *   expanded into hwbuffer first and then sent with a single bitmap
+ *   operation rather than one operation for each device row.
  *
  ****************************************************************************/
 
 #ifdef CONFIG_GRAPHICS_TRAVELER_NX
-void trv_display_update(struct trv_graphics_info_s *ginfo,
-                        FAR dev_pixel_t *dest, trv_coord_t destrow)
+static void trv_frame_transfer(FAR struct trv_graphics_info_s *ginfo)
 {
-  /* Transfer the row buffer to the NX window */
-#warning Missing logic
+  FAR const void *src[CONFIG_NX_NPLANES];
+  struct nxgl_rect_s dest;
+  struct nxgl_point_s origin;
+  int ret;
+
+  dest.pt1.x = ginfo->xoffset;
+  dest.pt1.y = ginfo->yoffset;
+  dest.pt2.x = ginfo->xoffset + ginfo->xscale * TRV_SCREEN_WIDTH - 1;
+  dest.pt2.y = ginfo->yoffset + ginfo->yscale * TRV_SCREEN_HEIGHT - 1;
 
+  origin.x   = dest.pt1.x;
+  origin.y   = dest.pt1.y;
+
+  src[0]     = (FAR const void *)ginfo->hwbuffer;
+#if CONFIG_NX_NPLANES > 1
+# warning "More logic is needed for the case where CONFIG_NX_PLANES > 1"
+#endif
+
+  ret = nx_bitmap(ginfo->bgwnd, &dest, src, &origin, ginfo->stride);
+  if (ret < 0)
+    {
+      trv_debug("nx_bitmap failed: %d\n", errno);
+    }
 }
 #endif
 
@@ -416,15 +560,18 @@ int trv_graphics_initialize(FAR struct trv_graphics_info_s *ginfo)
    *   nor freed.
    *
    * Using NX
-   *   ginfo->hwbuffer - This address of one line of the final expanded
-   *   image that must transferred to the window.
+   *   ginfo->hwbuffer - The final, expanded image.  It holds only the
+   *   visible image (no borders) and is transferred to the window as one
+   *   bitmap each frame.
    */
 
 #ifdef CONFIG_GRAPHICS_TRAVELER_NX
-   ginfo->hwbuffer = (trv_pixel_t*)trv_malloc(ginfo->imgwidth);
+   ginfo->stride   = ginfo->imgwidth;
+   ginfo->hwbuffer = (FAR dev_pixel_t *)
+     trv_malloc(ginfo->imgwidth * ginfo->yscale * TRV_SCREEN_HEIGHT);
    if (!ginfo->hwbuffer)
      {
-       trv_abort("ERROR: Failed to allocate hardware line buffer\n");
+       trv_abort("ERROR: Failed to allocate hardware frame buffer\n");
      }
 #endif
 
@@ -482,30 +629,28 @@ void trv_display_update(struct trv_graphics_info_s *ginfo)
 {
   FAR const uint8_t *src;
   FAR uint8_t *dest;
-  trv_coord_t srcrow;
-#ifdef CONFIG_GRAPHICS_TRAVELER_NX
-  trv_coord_t destrow;
-#else
   FAR uint8_t *first;
-#endif
+  trv_coord_t srcrow;
   int i;
 
-  /* Get the star tof the first source row */
+  /* Get the start of the first source row */
 
   src = (FAR const uint8_t *)ginfo->swbuffer;
 
-  /* Get the start of the first destination row */
+  /* Get the start of the first destination row.  The NX buffer holds only
+   * the image; the offsets are applied when it is transferred.
+   */
 
+#ifdef CONFIG_GRAPHICS_TRAVELER_NX
+  dest = (FAR uint8_t *)ginfo->hwbuffer;
+#else
   dest = (FAR uint8_t *)ginfo->hwbuffer +
          (ginfo->yoffset * ginfo->stride) +
          (ginfo->xoffset * sizeof(dev_pixel_t));
+#endif
 
   /* Loop for each row in the src render buffer */
 
-#ifdef CONFIG_GRAPHICS_TRAVELER_NX
-  destrow = 0;
-#endif
-
   for (srcrow = 0; srcrow < TRV_SCREEN_HEIGHT; srcrow++)
     {
       /* Transfer the row to the device row/buffer */
@@ -513,36 +658,25 @@ void trv_display_update(struct trv_graphics_info_s *ginfo)
       trv_row_update(ginfo, (FAR const trv_pixel_t *)src,
                      (FAR dev_pixel_t *)dest);
 
-#ifdef CONFIG_GRAPHICS_TRAVELER_NX
-      /* Transfer the row buffer to the NX window */
-
-      trv_row_transfer(ginfo, dest, destrow);
-      destrow++;
-#else
       first = dest;
       dest += ginfo->stride;
-#endif
 
       /* Then replicate as many times as is necessary */
 
       for (i = 1; i < ginfo->yscale; i++)
         {
-#ifdef CONFIG_GRAPHICS_TRAVELER_NX
-          /* Transfer the row buffer to the NX window */
-
-          trv_row_transfer(ginfo, dest, destrow);
-          destrow++;
-#else
-          /* Point to the next row in the frame buffer */
-
           memcpy(dest, first, ginfo->imgwidth);
           dest += ginfo->stride;
-#endif
         }
 
       /* Point to the next src row */
 
       src += TRV_SCREEN_WIDTH;
     }
-}
 
+#ifdef CONFIG_GRAPHICS_TRAVELER_NX
+  /* Transfer the completed frame to the NX window */
+
+  trv_frame_transfer(ginfo);
+#endif
+}
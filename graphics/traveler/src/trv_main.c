@@ -48,6 +48,7 @@
 #include "trv_world.h"
 #include "trv_doors.h"
 #include "trv_pov.h"
+#include "trv_trigtbl.h"
 #include "trv_raycntl.h"
 #include "trv_rayrend.h"
 #include "trv_input.h"
@@ -81,6 +82,16 @@
 
 #define MIN_FRAME_USEC (1000000 / CONFIG_GRAPHICS_TRAVELER_MAXFPS)
 
+/* Ray caster threads */
+
+#ifndef CONFIG_GRAPHICS_TRAVELER_NTHREADS
+#  define CONFIG_GRAPHICS_TRAVELER_NTHREADS 1
+#endif
+
+/* Number of frames rendered with each thread count by the -b benchmark */
+
+#define BENCHMARK_FRAMES 100
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -111,6 +122,7 @@ static void trv_exit(int exitcode)
   /* Release memory held by the ray casting engine */
 
   trv_world_destroy();
+  trv_raycaster_terminate();
 
   /* Close off input */
 
@@ -130,6 +142,10 @@ static void trv_usage(char *execname)
 {
   fprintf(stderr, "Usage: %s [-b] [-p<path>] [world]\n", execname);
   fprintf(stderr, "Where:\n");
+#ifdef CONFIG_GRAPHICS_TRAVELER_PERFMON
+  fprintf(stderr, "  -b       Benchmark the frame rate with 1 to %d render "
+                  "threads\n", CONFIG_GRAPHICS_TRAVELER_NTHREADS);
+#endif
   fprintf(stderr, "  -p<path> Selects the path to the world data file\n");
   fprintf(stderr, "  world    Selects the world file name\n");
   exit(EXIT_FAILURE);
@@ -234,6 +250,100 @@ errout:
 }
 #endif
 
+/****************************************************************************
+ * Name: trv_benchmark
+ *
+ * Description:
+ *   Render the same sequence of frames, turning a full circle from the
+ *   initial POV, with 1 to CONFIG_GRAPHICS_TRAVELER_NTHREADS render
+ *   threads.  Report the frame rate of each and verify that every thread
+ *   count renders exactly the same images.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_PERFMON
+static void trv_benchmark(void)
+{
+  struct trv_camera_s camera;
+  struct timespec start_time;
+  struct timespec now;
+  FAR const uint8_t *ptr;
+  uint32_t checksum;
+  uint32_t refsum = 0;
+  uint32_t elapsed_usec;
+  uint32_t base_usec = 0;
+  int nthreads;
+  int pass;
+  int frame;
+  int ret;
+  int i;
+
+  fprintf(stderr, "Threads      fps  Speedup  Image\n");
+
+  for (nthreads = 1; nthreads <= CONFIG_GRAPHICS_TRAVELER_NTHREADS;
+       nthreads++)
+    {
+      ret = trv_raycaster_initialize(nthreads);
+      if (ret < 0)
+        {
+          trv_abort("ERROR: Failed to start %d render threads: %d\n",
+                    nthreads, ret);
+        }
+
+      /* The order of coplanar rectangles in the plane lists, and hence a
+       * few pixels, depends upon the frames previously rendered.  The
+       * first, untimed pass through the sequence brings the lists to the
+       * same state for each thread count.
+       */
+
+      for (pass = 0; pass < 2; pass++)
+        {
+          checksum     = 0;
+          elapsed_usec = 0;
+
+          for (frame = 0; frame < BENCHMARK_FRAMES; frame++)
+            {
+              camera      = g_player;
+              camera.yaw += (int16_t)(((int32_t)frame * ANGLE_360) /
+                                      BENCHMARK_FRAMES);
+              if (camera.yaw >= ANGLE_360)
+                {
+                  camera.yaw -= ANGLE_360;
+                }
+
+              trv_current_time(&start_time);
+              trv_rend_backdrop(&camera, &g_trv_ginfo);
+              trv_raycaster(&camera, &g_trv_ginfo);
+              elapsed_usec += trv_elapsed_time(&now, &start_time);
+
+              /* Fold the image into the checksum */
+
+              ptr = (FAR const uint8_t *)g_trv_ginfo.swbuffer;
+              for (i = 0; i < TRV_SCREEN_WIDTH * TRV_SCREEN_HEIGHT; i++)
+                {
+                  checksum = ((checksum << 5) | (checksum >> 27)) ^ ptr[i];
+                }
+            }
+        }
+
+      /* Show the last frame */
+
+      trv_display_update(&g_trv_ginfo);
+
+      if (nthreads == 1)
+        {
+          refsum    = checksum;
+          base_usec = elapsed_usec;
+        }
+
+      fprintf(stderr, "%7d %8.2f %7.2fx  %s\n", nthreads,
+              (double)BENCHMARK_FRAMES * 1000000.0 / (double)elapsed_usec,
+              (double)base_usec / (double)elapsed_usec,
+              checksum == refsum ? "identical" : "DIFFERENT");
+    }
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -263,6 +373,9 @@ int traveler_main(int argc, char *argv[])
 #endif
   struct timespec now;
   uint32_t elapsed_usec;
+#endif
+#ifdef CONFIG_GRAPHICS_TRAVELER_PERFMON
+  bool benchmark = false;
 #endif
   int ret;
   int i;
@@ -282,6 +395,12 @@ int traveler_main(int argc, char *argv[])
           ptr++;
           switch (*ptr)
             {
+#ifdef CONFIG_GRAPHICS_TRAVELER_PERFMON
+            case 'b' :
+              benchmark = true;
+              break;
+#endif
+
             case 'p' :
               wldpath = ptr++;
               break;
@@ -330,6 +449,24 @@ int traveler_main(int argc, char *argv[])
 
   trv_input_initialize();
 
+#ifdef CONFIG_GRAPHICS_TRAVELER_PERFMON
+  /* Run the frame rate benchmark instead of the game if so requested */
+
+  if (benchmark)
+    {
+      trv_benchmark();
+      trv_exit(EXIT_SUCCESS);
+    }
+#endif
+
+  /* Start the ray caster render threads */
+
+  ret = trv_raycaster_initialize(CONFIG_GRAPHICS_TRAVELER_NTHREADS);
+  if (ret < 0)
+    {
+      trv_abort("ERROR: Failed to start render threads: %d\n", ret);
+    }
+
 #ifdef CONFIG_GRAPHICS_TRAVELER_PERFMON
   /* Get the start time for performance monitoring */
 
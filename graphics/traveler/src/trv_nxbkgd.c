@@ -136,16 +136,16 @@ static void trv_nxposition(NXWINDOW hwnd, FAR const struct nxgl_size_s *size,
     {
       /* Save the background window handle */
 
-      ginnfo->bgwnd = hwnd;
+      ginfo->bgwnd = hwnd;
 
       /* Save the background window size */
 
-      ginfo->width  = size->w;
-      ginfo->height = size->h;
+      ginfo->xres = size->w;
+      ginfo->yres = size->h;
 
       g_trv_nxresolution = true;
       sem_post(&g_trv_nxevent);
-      trv_vdebug("Have width=%d height=%d\n", ginfo->width, ginfo->height);
+      trv_vdebug("Have width=%d height=%d\n", ginfo->xres, ginfo->yres);
     }
 }
 
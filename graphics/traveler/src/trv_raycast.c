@@ -64,26 +64,23 @@
  * Private Function Prototypes
  ****************************************************************************/
 
-static void trv_ray_xcaster14(FAR struct trv_raycast_s *result);
-static void trv_ray_xcaster23(FAR struct trv_raycast_s *result);
-static void trv_ray_ycaster12(FAR struct trv_raycast_s *result);
-static void trv_ray_ycaster34(FAR struct trv_raycast_s *result);
-static void trv_ray_zcasteru(FAR struct trv_raycast_s *result);
-static void trv_ray_zcasterl(FAR struct trv_raycast_s *result);
+static void trv_ray_xcaster14(FAR struct trv_raystate_s *state,
+                              FAR struct trv_raycast_s *result);
+static void trv_ray_xcaster23(FAR struct trv_raystate_s *state,
+                              FAR struct trv_raycast_s *result);
+static void trv_ray_ycaster12(FAR struct trv_raystate_s *state,
+                              FAR struct trv_raycast_s *result);
+static void trv_ray_ycaster34(FAR struct trv_raystate_s *state,
+                              FAR struct trv_raycast_s *result);
+static void trv_ray_zcasteru(FAR struct trv_raystate_s *state,
+                             FAR struct trv_raycast_s *result);
+static void trv_ray_zcasterl(FAR struct trv_raystate_s *state,
+                             FAR struct trv_raycast_s *result);
 
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
-/* The following are the tangent and the cotangent of the pitch angle
- * adjusted for the viewing yaw angle so that the view is correct for the
- * "fish eye" effect which results from the projection of the polar ray cast
- * onto the flat display
- */
-
-static int32_t g_adj_tanpitch;
-static int32_t g_adj_cotpitch;
-
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -105,7 +102,8 @@ static int32_t g_adj_cotpitch;
  *
  ****************************************************************************/
 
-static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
+static void trv_ray_xcaster14(FAR struct trv_raystate_s *state,
+                              FAR struct trv_raycast_s *result)
 {
   struct trv_rect_list_s *list; /* Points to the current X plane rectangle */
   struct trv_rect_data_s *rect; /* Points to the rectangle data */
@@ -121,7 +119,7 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
    * are possible!
    */
 
-  if (g_camera.yaw == ANGLE_270)
+  if (state->camera.yaw == ANGLE_270)
     {
       return;
     }
@@ -131,14 +129,14 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
    * X-axis.  The tangent is stored at double the "normal" scaling.
    */
 
-  dydx = TAN(g_camera.yaw);
+  dydx = TAN(state->camera.yaw);
 
   /* Determine the rate of change of the Z with respect to X. The tangent is
    * "double" precision; the secant is "double" precision.  dzdx will be
    * retained as "double" precision.
    */
 
-  dzdx = qTOd(g_adj_tanpitch * ABS(g_sec_table[g_camera.yaw]));
+  dzdx = qTOd(state->adj_tanpitch * ABS(g_sec_table[state->camera.yaw]));
 
   /* Look at every rectangle lying in the X plane */
   /* This logic should be improved at some point so that non-visible planes
@@ -153,11 +151,11 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
        * position
        */
 
-      if (rect->plane > g_camera.x)
+      if (rect->plane > state->camera.x)
         {
           /* get the X distance to the plane */
 
-          relx = rect->plane - g_camera.x;
+          relx = rect->plane - state->camera.x;
 
 #if 0
           /* g_ray_xplane is an ordered list, if we have already hit something
@@ -184,7 +182,7 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
                */
 
               deltay    = dydx * ((int32_t) relx);
-              absy      = tTOs(deltay) + g_camera.y; /* back to "single" */
+              absy      = tTOs(deltay) + state->camera.y; /* back to "single" */
               lastrelx1 = relx;
             }
 
@@ -207,7 +205,8 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
                    */
 
                   deltaz    = dzdx * ((int32_t) relx);
-                  absz      = tTOs(deltaz) + g_camera.z; /* Back to single */
+                  absz      = tTOs(deltaz) +
+                              state->camera.z; /* Back to single */
                   lastrelx2 = relx;
                 }
 
@@ -230,8 +229,8 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
                       result->ypos = absz;
 
                       result->xdist = relx;
-                      result->ydist = ABS(absy - g_camera.y);
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->ydist = ABS(absy - state->camera.y);
+                      result->zdist = ABS(absz - state->camera.z);
 
                       /* Terminate X casting */
 
@@ -253,8 +252,8 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
                           result->ypos = absz;
 
                           result->xdist = relx;
-                          result->ydist = ABS(absy - g_camera.y);
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->ydist = ABS(absy - state->camera.y);
+                          result->zdist = ABS(absz - state->camera.z);
 
                           /* Terminate X casting */
 
@@ -277,8 +276,8 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
                           result->ypos = absz - g_opendoor.zdist;
 
                           result->xdist = relx;
-                          result->ydist = ABS(absy - g_camera.y);
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->ydist = ABS(absy - state->camera.y);
+                          result->zdist = ABS(absz - state->camera.z);
 
                           /* Terminate X casting */
 
@@ -304,8 +303,8 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
                       result->ypos = absz;
 
                       result->xdist = relx;
-                      result->ydist = ABS(absy - g_camera.y);
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->ydist = ABS(absy - state->camera.y);
+                      result->zdist = ABS(absz - state->camera.z);
 
                       /* Terminate X casting */
 
@@ -334,7 +333,8 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
  *
  ****************************************************************************/
 
-static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
+static void trv_ray_xcaster23(FAR struct trv_raystate_s *state,
+                              FAR struct trv_raycast_s *result)
 {
   struct trv_rect_list_s *list; /* Points to the current X plane rectangle */
   struct trv_rect_data_s *rect; /* Points to the rectangle data */
@@ -350,7 +350,7 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
    * possible!
    */
 
-  if (g_camera.yaw == ANGLE_90)
+  if (state->camera.yaw == ANGLE_90)
     {
       return;
     }
@@ -360,14 +360,14 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
    * to the X-axis.  The tangent is stored at double the "normal" scaling.
    */
 
-  dydx = -TAN(g_camera.yaw);
+  dydx = -TAN(state->camera.yaw);
 
   /* Determine the rate of change of the Z with respect to X. dydx is
    * "double" precision; the secant is "double" precision.  dzdx will be
    * retained as "double" precision.
    */
 
-  dzdx = qTOd(g_adj_tanpitch * ABS(g_sec_table[g_camera.yaw]));
+  dzdx = qTOd(state->adj_tanpitch * ABS(g_sec_table[state->camera.yaw]));
 
   /* Look at every rectangle lying in the X plane */
   /* This logic should be improved at some point so that non-visible planes
@@ -382,11 +382,11 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
        * position
        */
 
-      if (rect->plane < g_camera.x)
+      if (rect->plane < state->camera.x)
         {
           /* get the X distance to the plane */
 
-          relx = g_camera.x - rect->plane;
+          relx = state->camera.x - rect->plane;
 #if 0
           /* g_ray_xplane is an ordered list, if we have already hit something
            * closer, then we can abort the casting now.
@@ -412,7 +412,7 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
                */
 
               deltay    = dydx * ((int32_t) relx);
-              absy      = tTOs(deltay) + g_camera.y; /* back to "single" */
+              absy      = tTOs(deltay) + state->camera.y; /* back to "single" */
               lastrelx1 = relx;
             }
 
@@ -435,7 +435,8 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
                    */
 
                   deltaz    = dzdx * ((int32_t) relx);
-                  absz      = tTOs(deltaz) + g_camera.z; /* Back to single */
+                  absz      = tTOs(deltaz) +
+                              state->camera.z; /* Back to single */
                   lastrelx2 = relx;
                 }
 
@@ -458,8 +459,8 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
                       result->ypos = absz;
 
                       result->xdist = relx;
-                      result->ydist = ABS(absy - g_camera.y);
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->ydist = ABS(absy - state->camera.y);
+                      result->zdist = ABS(absz - state->camera.z);
 
                       /* Terminate X casting */
 
@@ -481,8 +482,8 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
                           result->ypos = absz;
 
                           result->xdist = relx;
-                          result->ydist = ABS(absy - g_camera.y);
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->ydist = ABS(absy - state->camera.y);
+                          result->zdist = ABS(absz - state->camera.z);
 
                           /* Terminate X casting */
 
@@ -505,8 +506,8 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
                           result->ypos = absz - g_opendoor.zdist;
 
                           result->xdist = relx;
-                          result->ydist = ABS(absy - g_camera.y);
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->ydist = ABS(absy - state->camera.y);
+                          result->zdist = ABS(absz - state->camera.z);
 
                           /* Terminate X casting */
 
@@ -532,8 +533,8 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
                       result->ypos = absz;
 
                       result->xdist = relx;
-                      result->ydist = ABS(absy - g_camera.y);
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->ydist = ABS(absy - state->camera.y);
+                      result->zdist = ABS(absz - state->camera.z);
 
                       /* Terminate X casting */
 
@@ -561,7 +562,8 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
  *
  ****************************************************************************/
 
-static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
+static void trv_ray_ycaster12(FAR struct trv_raystate_s *state,
+                              FAR struct trv_raycast_s *result)
 {
   struct trv_rect_list_s *list; /* Points to the current P plane rectangle */
   struct trv_rect_data_s *rect; /* Points to the rectangle data */
@@ -577,7 +579,7 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
    * possible!
    */
 
-  if (g_camera.yaw == ANGLE_0)
+  if (state->camera.yaw == ANGLE_0)
     {
       return;
     }
@@ -587,14 +589,14 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
    * the Y-axis.  The cotangent is stored at double the "normal" scaling.
    */
 
-  dxdy = g_cot_table(g_camera.yaw);
+  dxdy = g_cot_table(state->camera.yaw);
 
   /* Determine the rate of change of the Z with respect to Y.  The tangent
    * is "double" precision; the cosecant is "double" precision.  dzdy will
    * be retained as "double" precision.
    */
 
-  dzdy = qTOd(g_adj_tanpitch * ABS(g_csc_table[g_camera.yaw]));
+  dzdy = qTOd(state->adj_tanpitch * ABS(g_csc_table[state->camera.yaw]));
 
   /* Look at every rectangle lying in a Y plane */
   /* This logic should be improved at some point so that non-visible planes
@@ -609,11 +611,11 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
        * position
        */
 
-      if (rect->plane > g_camera.y)
+      if (rect->plane > state->camera.y)
         {
           /* get the Y distance to the plane */
 
-          rely = rect->plane - g_camera.y;
+          rely = rect->plane - state->camera.y;
 
           /* g_ray_yplane is an ordered list, if we have already hit something
            * closer, then we can abort the casting now.
@@ -638,7 +640,7 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
                */
 
               deltax    = dxdy * ((int32_t) rely);
-              absx      = tTOs(deltax) + g_camera.x; /* back to "single" */
+              absx      = tTOs(deltax) + state->camera.x; /* back to "single" */
               lastrely1 = rely;
             }
 
@@ -661,7 +663,8 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
                    */
 
                   deltaz    = dzdy * ((int32_t) rely);
-                  absz      = tTOs(deltaz) + g_camera.z; /* Back to single */
+                  absz      = tTOs(deltaz) +
+                              state->camera.z; /* Back to single */
                   lastrely2 = rely;
                 }
 
@@ -683,9 +686,9 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
                       result->xpos = absx;
                       result->ypos = absz;
 
-                      result->xdist = ABS(absx - g_camera.x);
+                      result->xdist = ABS(absx - state->camera.x);
                       result->ydist = rely;
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->zdist = ABS(absz - state->camera.z);
 
                       /* Terminate Y casting */
 
@@ -706,9 +709,9 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
                           result->xpos = absx;
                           result->ypos = absz;
 
-                          result->xdist = ABS(absx - g_camera.x);
+                          result->xdist = ABS(absx - state->camera.x);
                           result->ydist = rely;
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->zdist = ABS(absz - state->camera.z);
 
                           /* Terminate Y casting */
 
@@ -730,9 +733,9 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
                           result->xpos = absx;
                           result->ypos = absz - g_opendoor.zdist;
 
-                          result->xdist = ABS(absx - g_camera.x);
+                          result->xdist = ABS(absx - state->camera.x);
                           result->ydist = rely;
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->zdist = ABS(absz - state->camera.z);
 
                           /* Terminate Y casting */
 
@@ -757,9 +760,9 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
                       result->xpos = absx;
                       result->ypos = absz;
 
-                      result->xdist = ABS(absx - g_camera.x);
+                      result->xdist = ABS(absx - state->camera.x);
                       result->ydist = rely;
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->zdist = ABS(absz - state->camera.z);
 
                       /* Terminate Y casting */
 
@@ -787,7 +790,8 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
  *
  ****************************************************************************/
 
-static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
+static void trv_ray_ycaster34(FAR struct trv_raystate_s *state,
+                              FAR struct trv_raycast_s *result)
 {
   struct trv_rect_list_s *list; /* Points to the current P plane rectangle */
   struct trv_rect_data_s *rect; /* Points to the rectangle data */
@@ -803,7 +807,7 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
    * are possible!
    */
 
-  if (g_camera.yaw == ANGLE_180)
+  if (state->camera.yaw == ANGLE_180)
     {
       return;
     }
@@ -814,14 +818,14 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
    * "normal" scaling.
    */
 
-  dxdy = -g_cot_table(g_camera.yaw - ANGLE_180);
+  dxdy = -g_cot_table(state->camera.yaw - ANGLE_180);
 
   /* Determine the rate of change of the Z with respect to Y.  The tangent
    * is "double" precision; the cosecant is "double" precision.  dzdy will
    * be retained as "double" precision.
    */
 
-  dzdy = qTOd(g_adj_tanpitch * ABS(g_csc_table[g_camera.yaw]));
+  dzdy = qTOd(state->adj_tanpitch * ABS(g_csc_table[state->camera.yaw]));
 
   /* Look at every rectangle lying in a Y plane */
   /* This logic should be improved at some point so that non-visible planes
@@ -836,11 +840,11 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
        * position
        */
 
-      if (rect->plane < g_camera.y)
+      if (rect->plane < state->camera.y)
         {
           /* get the Y distance to the plane */
 
-          rely = g_camera.y - rect->plane;
+          rely = state->camera.y - rect->plane;
 
           /* g_ray_yplane is an ordered list, if we have already hit something
            * closer, then we can abort the casting now.
@@ -865,7 +869,7 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
                */
 
               deltax    = dxdy * ((int32_t) rely);
-              absx      = tTOs(deltax) + g_camera.x; /* back to "single" */
+              absx      = tTOs(deltax) + state->camera.x; /* back to "single" */
               lastrely1 = rely;
             }
 
@@ -889,7 +893,8 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
                    */
 
                   deltaz    = dzdy * ((int32_t) rely);
-                  absz      = tTOs(deltaz) + g_camera.z; /* Back to single */
+                  absz      = tTOs(deltaz) +
+                              state->camera.z; /* Back to single */
                   lastrely2 = rely;
                 }
 
@@ -912,9 +917,9 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
                       result->xpos = absx;
                       result->ypos = absz;
 
-                      result->xdist = ABS(absx - g_camera.x);
+                      result->xdist = ABS(absx - state->camera.x);
                       result->ydist = rely;
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->zdist = ABS(absz - state->camera.z);
 
                       /* Terminate Y casting */
 
@@ -935,9 +940,9 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
                           result->xpos = absx;
                           result->ypos = absz;
 
-                          result->xdist = ABS(absx - g_camera.x);
+                          result->xdist = ABS(absx - state->camera.x);
                           result->ydist = rely;
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->zdist = ABS(absz - state->camera.z);
 
                           /* Terminate Y casting */
 
@@ -959,9 +964,9 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
                           result->xpos = absx;
                           result->ypos = absz - g_opendoor.zdist;
 
-                          result->xdist = ABS(absx - g_camera.x);
+                          result->xdist = ABS(absx - state->camera.x);
                           result->ydist = rely;
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->zdist = ABS(absz - state->camera.z);
 
                           /* Terminate Y casting */
 
@@ -986,9 +991,9 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
                       result->xpos = absx;
                       result->ypos = absz;
 
-                      result->xdist = ABS(absx - g_camera.x);
+                      result->xdist = ABS(absx - state->camera.x);
                       result->ydist = rely;
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->zdist = ABS(absz - state->camera.z);
 
                       /* Terminate Y casting */
 
@@ -1016,7 +1021,8 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
  *   ran!
  ****************************************************************************/
 
-static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
+static void trv_ray_zcasteru(FAR struct trv_raystate_s *state,
+                             FAR struct trv_raycast_s *result)
 {
   struct trv_rect_list_s *list; /* Points to the current Z plane rectangle */
   struct trv_rect_data_s *rect; /* Points to the rectangle data */
@@ -1032,7 +1038,7 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
    * possible!
    */
 
-  if (g_camera.pitch == ANGLE_0)
+  if (state->camera.pitch == ANGLE_0)
     {
       return;
     }
@@ -1044,14 +1050,14 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
    * precision.
    */
 
-  dxdz = qTOd(g_adj_cotpitch * ((int32_t) g_cos_table[g_camera.yaw]));
+  dxdz = qTOd(state->adj_cotpitch * ((int32_t) g_cos_table[state->camera.yaw]));
 
   /* Calculate the rate of change of Y with respect to the Z-axis. The
    * cotangent is stored at double the "normal" scaling and the sine is also
    * at double scaling.  dxdz will be also be stored at double precision.
    */
 
-  dydz = qTOd(g_adj_cotpitch * ((int32_t) g_sin_table[g_camera.yaw]));
+  dydz = qTOd(state->adj_cotpitch * ((int32_t) g_sin_table[state->camera.yaw]));
 
   /* Look at every rectangle lying in the Z plane */
   /* This logic should be improved at some point so that non-visible planes
@@ -1066,11 +1072,11 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
        * position
        */
 
-      if (rect->plane > g_camera.z)
+      if (rect->plane > state->camera.z)
         {
           /* get the Z distance to the plane */
 
-          relz = rect->plane - g_camera.z;
+          relz = rect->plane - state->camera.z;
 
           /* g_ray_zplane is an ordered list, if we have already hit something
            * closer, then we can abort the casting now.
@@ -1095,7 +1101,7 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
                */
 
               deltax    = dxdz * ((int32_t) relz);
-              absx      = tTOs(deltax) + g_camera.x; /* back to "single" */
+              absx      = tTOs(deltax) + state->camera.x; /* back to "single" */
               lastrelz1 = relz;
             }
 
@@ -1118,7 +1124,8 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
                    */
 
                   deltay    = dydz * ((int32_t) relz);
-                  absy      = tTOs(deltay) + g_camera.y; /* back to "single" */
+                  absy      = tTOs(deltay) +
+                              state->camera.y; /* back to "single" */
                   lastrelz2 = relz;
                 }
 
@@ -1135,8 +1142,8 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
                   result->xpos = absx;
                   result->ypos = absy;
 
-                  result->xdist = ABS(absx - g_camera.x);
-                  result->ydist = ABS(absy - g_camera.y);
+                  result->xdist = ABS(absx - state->camera.x);
+                  result->ydist = ABS(absy - state->camera.y);
                   result->zdist = relz;
 
                   /* Terminate Z casting */
@@ -1165,7 +1172,8 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
  *
  ****************************************************************************/
 
-static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
+static void trv_ray_zcasterl(FAR struct trv_raystate_s *state,
+                             FAR struct trv_raycast_s *result)
 {
   struct trv_rect_list_s *list; /* Points to the current Z plane rectangle */
   struct trv_rect_data_s *rect; /* Points to the rectangle data */
@@ -1181,7 +1189,7 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
    * possible!
    */
 
-  if (g_camera.pitch == ANGLE_0)
+  if (state->camera.pitch == ANGLE_0)
     {
       return;
     }
@@ -1193,7 +1201,7 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
    * precision.
    */
 
-  dxdz = qTOd(g_adj_cotpitch * ((int32_t) g_cos_table[g_camera.yaw]));
+  dxdz = qTOd(state->adj_cotpitch * ((int32_t) g_cos_table[state->camera.yaw]));
 
   /* Calculate the rate of change of Y with respect to the Z-axis. The
    * cotangent is stored at double the "normal" scaling and the sine is
@@ -1201,7 +1209,7 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
    * precision.
    */
 
-  dydz = qTOd(g_adj_cotpitch * ((int32_t) g_sin_table[g_camera.yaw]));
+  dydz = qTOd(state->adj_cotpitch * ((int32_t) g_sin_table[state->camera.yaw]));
 
   /* Look at every rectangle lying in the Z plane */
   /* This logic should be improved at some point so that non-visible planes
@@ -1216,11 +1224,11 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
        * position
        */
 
-      if (rect->plane < g_camera.z)
+      if (rect->plane < state->camera.z)
         {
           /* get the Z distance to the plane */
 
-          relz = g_camera.z - rect->plane;
+          relz = state->camera.z - rect->plane;
 
           /* g_ray_zplane is an ordered list, if we have already hit something
            * closer, then we can abort the casting now.
@@ -1245,7 +1253,7 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
                */
 
               deltax    = dxdz * ((int32_t) relz);
-              absx      = tTOs(deltax) + g_camera.x; /* back to "single" */
+              absx      = tTOs(deltax) + state->camera.x; /* back to "single" */
               lastrelz1 = relz;
             }
 
@@ -1268,7 +1276,8 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
                    */
 
                   deltay    = dydz * ((int32_t) relz);
-                  absy      = tTOs(deltay) + g_camera.y; /* back to "single" */
+                  absy      = tTOs(deltay) +
+                              state->camera.y; /* back to "single" */
                   lastrelz2 = relz;
                 }
 
@@ -1285,8 +1294,8 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
                   result->xpos = absx;
                   result->ypos = absy;
 
-                  result->xdist = ABS(absx - g_camera.x);
-                  result->ydist = ABS(absy - g_camera.y);
+                  result->xdist = ABS(absx - state->camera.x);
+                  result->ydist = ABS(absy - state->camera.y);
                   result->zdist = relz;
 
                   /* Terminate Z casting */
@@ -1312,13 +1321,14 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
  *
  ****************************************************************************/
 
-void trv_raycast(int16_t pitch, int16_t yaw, int16_t screenyaw,
-                FAR struct trv_raycast_s *result)
+void trv_raycast(FAR struct trv_raystate_s *state, int16_t pitch,
+                 int16_t yaw, int16_t screenyaw,
+                 FAR struct trv_raycast_s *result)
 {
   /* Set the camera pitch and yaw angles for this cast */
 
-  g_camera.pitch = pitch;
-  g_camera.yaw = yaw;
+  state->camera.pitch = pitch;
+  state->camera.yaw = yaw;
 
   /* Initialize the result structure, assuming that there will be no hit */
 
@@ -1339,37 +1349,37 @@ void trv_raycast(int16_t pitch, int16_t yaw, int16_t screenyaw,
 
   screenyaw = ABS(screenyaw);
 #if ENABLE_VIEW_CORRECTION
-  g_adj_tanpitch = qTOd(TAN(pitch) * ((int32_t) g_cos_table[screenyaw]));
+  state->adj_tanpitch = qTOd(TAN(pitch) * ((int32_t) g_cos_table[screenyaw]));
 #else
-  g_adj_tanpitch = TAN(pitch);
+  state->adj_tanpitch = TAN(pitch);
 #endif
 
   /* Perform X & Y raycasting based on the quadrant of the yaw angle */
 
-  if (g_camera.yaw < ANGLE_90)
+  if (state->camera.yaw < ANGLE_90)
     {
-      trv_ray_xcaster14(result);
-      trv_ray_ycaster12(result);
+      trv_ray_xcaster14(state, result);
+      trv_ray_ycaster12(state, result);
     }
-  else if (g_camera.yaw < ANGLE_180)
+  else if (state->camera.yaw < ANGLE_180)
     {
-      trv_ray_xcaster23(result);
-      trv_ray_ycaster12(result);
+      trv_ray_xcaster23(state, result);
+      trv_ray_ycaster12(state, result);
     }
-  else if (g_camera.yaw < ANGLE_270)
+  else if (state->camera.yaw < ANGLE_270)
     {
-      trv_ray_xcaster23(result);
-      trv_ray_ycaster34(result);
+      trv_ray_xcaster23(state, result);
+      trv_ray_ycaster34(state, result);
     }
   else
     {
-      trv_ray_xcaster14(result);
-      trv_ray_ycaster34(result);
+      trv_ray_xcaster14(state, result);
+      trv_ray_ycaster34(state, result);
     }
 
   /* Perform Z ray casting based upon if we are looking up or down */
 
-  if (g_camera.pitch < ANGLE_90)
+  if (state->camera.pitch < ANGLE_90)
     {
       /* Get the adjusted cotangent of the pitch angle which is used to correct
        * for the "fish eye" distortion.  This correction consists of
@@ -1379,11 +1389,11 @@ void trv_raycast(int16_t pitch, int16_t yaw, int16_t screenyaw,
        */
 
 #if ENABLE_VIEW_CORRECTION
-      g_adj_cotpitch = qTOd(g_cot_table(pitch) * g_sec_table[screenyaw]);
+      state->adj_cotpitch = qTOd(g_cot_table(pitch) * g_sec_table[screenyaw]);
 #else
-      g_adj_cotpitch = g_cot_table(pitch);
+      state->adj_cotpitch = g_cot_table(pitch);
 #endif
-      trv_ray_zcasteru(result);
+      trv_ray_zcasteru(state, result);
     }
   else
     {
@@ -1395,11 +1405,11 @@ void trv_raycast(int16_t pitch, int16_t yaw, int16_t screenyaw,
        */
 
 #if ENABLE_VIEW_CORRECTION
-      g_adj_cotpitch =
+      state->adj_cotpitch =
         qTOd(g_cot_table(ANGLE_360 - pitch) * g_sec_table[screenyaw]);
 #else
-      g_adj_cotpitch = g_cot_table(ANGLE_360 - pitch);
+      state->adj_cotpitch = g_cot_table(ANGLE_360 - pitch);
 #endif
-      trv_ray_zcasterl(result);
+      trv_ray_zcasterl(state, result);
     }
 }
@@ -39,6 +39,14 @@
  ****************************************************************************/
 
 #include "trv_types.h"
+
+#if CONFIG_GRAPHICS_TRAVELER_NTHREADS > 1
+#  include <sched.h>
+#  include <string.h>
+#  include <pthread.h>
+#  include <semaphore.h>
+#endif
+
 #include "trv_debug.h"
 #include "trv_world.h"
 #include "trv_plane.h"
@@ -56,6 +64,16 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_GRAPHICS_TRAVELER_NTHREADS
+#  define CONFIG_GRAPHICS_TRAVELER_NTHREADS 1
+#endif
+
+#ifndef CONFIG_GRAPHICS_TRAVELER_RENDER_STACKSIZE
+#  define CONFIG_GRAPHICS_TRAVELER_RENDER_STACKSIZE 2048
+#endif
+
 /* These definitions simplify creation of the initial ray casting cell */
 
 #define TOP_HEIGHT  (VGULP_SIZE/2)
@@ -78,32 +96,22 @@
 
 #define RELYAW(i)  (((i) + WINDOW_LEFT) - (WINDOW_WIDTH/2))
 
+/* Each horizontal swathe is cast as NUMBER_HGULPS cells, working from the
+ * right side of the image (cell 0) to the left.  This macro gives the
+ * column offset of a cell.
+ */
+
+#define CELL_COLUMN(n) ((IMAGE_WIDTH - HGULP_SIZE + 1) - (n) * HGULP_SIZE)
+
 /* Macro to determine if two hits "hit" the same object */
 
-#define SAME_CELL(i1,j1,i2,j2) \
-  (g_ray_hit[i1][j1].rect == g_ray_hit[i2][j2].rect)
+#define SAME_CELL(s,i1,j1,i2,j2) \
+  ((s)->hit[i1][j1].rect == (s)->hit[i2][j2].rect)
 
 /****************************************************************************
  * Public Data
  ****************************************************************************/
 
-/* The following array describes the hits from X/Y/Z-ray casting for the
- * current HGULP_SIZE x VGULP_SIZE cell
- */
-
-struct trv_raycast_s g_ray_hit[VGULP_SIZE][HGULP_SIZE + 1];
-
-/* This array points to the screen buffer row corresponding to the
- * pitch angle
- */
-
-FAR uint8_t *g_buffer_row[VGULP_SIZE];
-
-/* The is the "column" offset in g_buffer_row for the current cell being
- * operated on.  This value is updated in a loop by trv_raycaster. */
-
-int16_t g_cell_column;
-
 /* This structure holds the parameters used in the current ray cast */
 
 struct trv_camera_s g_camera;
@@ -112,11 +120,18 @@ struct trv_camera_s g_camera;
  * Private Data
  ****************************************************************************/
 
+/* This array points to the screen buffer row corresponding to the
+ * pitch angle
+ */
+
+static FAR uint8_t *g_buffer_row[VGULP_SIZE];
+
 /* These are all of the yaw angles which will be used by the ray caster
- * on a given cycle
+ * on a given cycle.  The right corners of the right-most cell are at
+ * IMAGE_WIDTH + 1.
  */
 
-static int16_t g_yaw[IMAGE_WIDTH + 1];
+static int16_t g_yaw[IMAGE_WIDTH + 2];
 
 /* These are all of the pitch angles which will be used by the ray caster
  * on each horizontal pass of a given cycle
@@ -124,10 +139,57 @@ static int16_t g_yaw[IMAGE_WIDTH + 1];
 
 static int16_t g_pitch[VGULP_SIZE];
 
+/* This is the ray caster state of each column band.  Each swathe is divided
+ * into g_nbands bands of cells, band 0 on the right.  Band 0 is cast by the
+ * caller of trv_raycaster(); the others by the render threads.
+ */
+
+static struct trv_raystate_s g_ray_state[CONFIG_GRAPHICS_TRAVELER_NTHREADS];
+static int g_nbands = 1;
+
+#if CONFIG_GRAPHICS_TRAVELER_NTHREADS > 1
+/* Adjacent cells share one column of pixels and a cell may leave a pixel
+ * untouched where a transparent wall shows nothing behind it.  So that the
+ * result does not depend upon the order in which the bands finish, each
+ * band renders into its own copy of the swathe and then copies back only
+ * the columns that it owns.
+ */
+
+static uint8_t g_band_buffer[CONFIG_GRAPHICS_TRAVELER_NTHREADS]
+                            [VGULP_SIZE][TRV_SCREEN_WIDTH];
+
+/* Render thread control.  Each render thread waits on its g_swathe_start
+ * semaphore for the next swathe and posts g_swathe_done when its band has
+ * been rendered.
+ */
+
+static pthread_t g_render_thread[CONFIG_GRAPHICS_TRAVELER_NTHREADS];
+static sem_t g_swathe_start[CONFIG_GRAPHICS_TRAVELER_NTHREADS];
+static sem_t g_swathe_done;
+static volatile bool g_render_terminate;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Function: trv_cast_hit
+ *
+ * Description:
+ *   Cast the ray for one row and column of the current cell.
+ *
+ ****************************************************************************/
+
+static inline void trv_cast_hit(FAR struct trv_raystate_s *state,
+                                uint8_t row, uint8_t col)
+{
+  int16_t column = state->cell_column + col;
+
+  trv_raycast(state, g_pitch[row], g_yaw[column], RELYAW(column),
+              &state->hit[row][col]);
+}
+
 /****************************************************************************
  * Function: trv_resolve_cell
  *
@@ -138,7 +200,8 @@ static int16_t g_pitch[VGULP_SIZE];
  *
  ****************************************************************************/
 
-static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
+static void trv_resolve_cell(FAR struct trv_raystate_s *state,
+                             uint8_t toprow, uint8_t leftcol,
                              uint8_t height, uint8_t width)
 {
   uint8_t midrow;
@@ -162,19 +225,20 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
            * the same cell type
            */
 
-          if (!SAME_CELL(toprow, leftcol, toprow, (leftcol + width - 1)))
+          if (!SAME_CELL(state, toprow, leftcol, toprow, (leftcol + width - 1)))
             {
               /* No.. the top corners are different.  Compare the top left and
                * bottom left corners to decide how to divide this up
                */
 
-              if (!SAME_CELL(toprow, leftcol, (toprow + height - 1), leftcol))
+              if (!SAME_CELL(state, toprow, leftcol,
+                             (toprow + height - 1), leftcol))
                 {
                   /* The left corners are not the same.  Check the right
                    * corners.
                    */
 
-                  if (!SAME_CELL(toprow, (leftcol + width - 1),
+                  if (!SAME_CELL(state, toprow, (leftcol + width - 1),
                                  (toprow + height - 1), (leftcol + width - 1)))
                     {
                       /* The right corners are not the same either.  Divide the
@@ -197,10 +261,7 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                           /* Get the top middle hit */
 
-                          trv_raycast(g_pitch[toprow],
-                                      g_yaw[g_cell_column + midcol],
-                                      RELYAW(g_cell_column + midcol),
-                                      &g_ray_hit[toprow][midcol]);
+                          trv_cast_hit(state, toprow, midcol);
                         }
 
                       topheight = ((height + 1) >> 1);
@@ -218,33 +279,27 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                           /* Get the middle left hit */
 
-                          trv_raycast(g_pitch[midrow],
-                                      g_yaw[g_cell_column + leftcol],
-                                      RELYAW(g_cell_column + leftcol),
-                                      &g_ray_hit[midrow][leftcol]);
+                          trv_cast_hit(state, midrow, leftcol);
 
                           /* Get the center hit */
 
                           if (rightwidth > 1)
                             {
-                              trv_raycast(g_pitch[midrow],
-                                          g_yaw[g_cell_column + midcol],
-                                          RELYAW(g_cell_column + midcol),
-                                          &g_ray_hit[midrow][midcol]);
+                              trv_cast_hit(state, midrow, midcol);
                             }
 
                           /* Get the middle right hit */
 
                           rightcol = leftcol + width - 1;
-                          trv_raycast(g_pitch[midrow],
-                                      g_yaw[g_cell_column + rightcol],
-                                      RELYAW(g_cell_column + rightcol),
-                                      &g_ray_hit[midrow][rightcol]);
+                          trv_cast_hit(state, midrow, rightcol);
                         }
 
-                      trv_resolve_cell(toprow, leftcol, topheight, leftwidth);
-                      trv_resolve_cell(toprow, midcol, topheight, rightwidth);
-                      trv_resolve_cell(midrow, leftcol, botheight, width);
+                      trv_resolve_cell(state, toprow, leftcol,
+                                       topheight, leftwidth);
+                      trv_resolve_cell(state, toprow, midcol,
+                                       topheight, rightwidth);
+                      trv_resolve_cell(state, midrow, leftcol,
+                                       botheight, width);
                     }
 
                   /* The left corners are not the same, but the right are.
@@ -268,18 +323,12 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                           /* Get the top middle hit */
 
-                          trv_raycast(g_pitch[toprow],
-                                      g_yaw[g_cell_column + midcol],
-                                      RELYAW(g_cell_column + midcol),
-                                      &g_ray_hit[toprow][midcol]);
+                          trv_cast_hit(state, toprow, midcol);
 
                           /* Get the bottom middle hit */
 
                           botrow = toprow + height - 1;
-                          trv_raycast(g_pitch[botrow],
-                                      g_yaw[g_cell_column + midcol],
-                                      RELYAW(g_cell_column + midcol),
-                                      &g_ray_hit[botrow][midcol]);
+                          trv_cast_hit(state, botrow, midcol);
                         }
 
                       topheight = ((height + 1) >> 1);
@@ -297,25 +346,22 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                           /* Get the middle left hit */
 
-                          trv_raycast(g_pitch[midrow],
-                                      g_yaw[g_cell_column + leftcol],
-                                      RELYAW(g_cell_column + leftcol),
-                                      &g_ray_hit[midrow][leftcol]);
+                          trv_cast_hit(state, midrow, leftcol);
 
                           /* Get the center hit */
 
                           if (rightwidth > 1)
                             {
-                              trv_raycast(g_pitch[midrow],
-                                          g_yaw[g_cell_column + midcol],
-                                          RELYAW(g_cell_column + midcol),
-                                          &g_ray_hit[midrow][midcol]);
+                              trv_cast_hit(state, midrow, midcol);
                             }
                         }
 
-                      trv_resolve_cell(toprow, leftcol, topheight, leftwidth);
-                      trv_resolve_cell(midrow, leftcol, botheight, leftwidth);
-                      trv_resolve_cell(toprow, midcol, height, rightwidth);
+                      trv_resolve_cell(state, toprow, leftcol,
+                                       topheight, leftwidth);
+                      trv_resolve_cell(state, midrow, leftcol,
+                                       botheight, leftwidth);
+                      trv_resolve_cell(state, toprow, midcol,
+                                       height, rightwidth);
                     }
                 }
 
@@ -339,20 +385,16 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                       /* Get the top middle hit */
 
-                      trv_raycast(g_pitch[toprow], g_yaw[g_cell_column + midcol],
-                                  RELYAW(g_cell_column + midcol),
-                                  &g_ray_hit[toprow][midcol]);
+                      trv_cast_hit(state, toprow, midcol);
 
                       /* Get the bottom middle hit */
 
                       botrow = toprow + height - 1;
-                      trv_raycast(g_pitch[botrow], g_yaw[g_cell_column + midcol],
-                                  RELYAW(g_cell_column + midcol),
-                                  &g_ray_hit[botrow][midcol]);
+                      trv_cast_hit(state, botrow, midcol);
                     }
 
-                  trv_resolve_cell(toprow, leftcol, height, leftwidth);
-                  trv_resolve_cell(toprow, midcol, height, rightwidth);
+                  trv_resolve_cell(state, toprow, leftcol, height, leftwidth);
+                  trv_resolve_cell(state, toprow, midcol, height, rightwidth);
                 }
             }
 
@@ -360,7 +402,8 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
            * left corners
            */
 
-          else if (!SAME_CELL(toprow, leftcol, (toprow + height - 1), leftcol))
+          else if (!SAME_CELL(state, toprow, leftcol,
+                              (toprow + height - 1), leftcol))
             {
               /* The top corners are the same, but left corners are not. Divide
                * the cell into two cells horizontally
@@ -381,27 +424,24 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                   /* Get the middle left hit */
 
-                  trv_raycast(g_pitch[midrow], g_yaw[g_cell_column + leftcol],
-                              RELYAW(g_cell_column + leftcol),
-                              &g_ray_hit[midrow][leftcol]);
+                  trv_cast_hit(state, midrow, leftcol);
 
                   /* Get the middle right hit */
 
                   rightcol = leftcol + width - 1;
-                  trv_raycast(g_pitch[midrow], g_yaw[g_cell_column + rightcol],
-                              RELYAW(g_cell_column + rightcol),
-                              &g_ray_hit[midrow][rightcol]);
+                  trv_cast_hit(state, midrow, rightcol);
                 }
 
-              trv_resolve_cell(toprow, leftcol, topheight, width);
-              trv_resolve_cell(midrow, leftcol, botheight, width);
+              trv_resolve_cell(state, toprow, leftcol, topheight, width);
+              trv_resolve_cell(state, midrow, leftcol, botheight, width);
             }
 
           /* The top and left corners are the same.  Check the lower right
            * corner
            */
 
-          else if (!SAME_CELL(toprow, leftcol, (toprow + height - 1), (leftcol + width - 1)))
+          else if (!SAME_CELL(state, toprow, leftcol,
+                              (toprow + height - 1), (leftcol + width - 1)))
             {
               /* The lower right corner differs from all of the others.  Divide
                * the cell into three cells, retaining the left half
@@ -422,16 +462,12 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                   /* Get the top middle hit */
 
-                  trv_raycast(g_pitch[toprow], g_yaw[g_cell_column + midcol],
-                              RELYAW(g_cell_column + midcol),
-                              &g_ray_hit[toprow][midcol]);
+                  trv_cast_hit(state, toprow, midcol);
 
                   /* Get the bottom middle hit */
 
                   botrow = toprow + height - 1;
-                  trv_raycast(g_pitch[botrow], g_yaw[g_cell_column + midcol],
-                              RELYAW(g_cell_column + midcol),
-                              &g_ray_hit[botrow][midcol]);
+                  trv_cast_hit(state, botrow, midcol);
                 }
 
               topheight = ((height + 1) >> 1);
@@ -450,23 +486,19 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
                   /* Get the middle right hit */
 
                   rightcol = leftcol + width - 1;
-                  trv_raycast(g_pitch[midrow], g_yaw[g_cell_column + rightcol],
-                              RELYAW(g_cell_column + rightcol),
-                              &g_ray_hit[midrow][rightcol]);
+                  trv_cast_hit(state, midrow, rightcol);
 
                   /* Get the center hit */
 
                   if (rightwidth > 1)
                     {
-                      trv_raycast(g_pitch[midrow], g_yaw[g_cell_column + midcol],
-                                  RELYAW(g_cell_column + midcol),
-                                  &g_ray_hit[midrow][midcol]);
+                      trv_cast_hit(state, midrow, midcol);
                     }
                 }
 
-              trv_resolve_cell(toprow, leftcol, height, leftwidth);
-              trv_resolve_cell(toprow, midcol, topheight, rightwidth);
-              trv_resolve_cell(midrow, midcol, botheight, rightwidth);
+              trv_resolve_cell(state, toprow, leftcol, height, leftwidth);
+              trv_resolve_cell(state, toprow, midcol, topheight, rightwidth);
+              trv_resolve_cell(state, midrow, midcol, botheight, rightwidth);
             }
 
           /* The four corners are the same! */
@@ -475,7 +507,7 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
             {
               /* Apply texturing */
 
-              trv_rend_cell(toprow, leftcol, height, width);
+              trv_rend_cell(state, toprow, leftcol, height, width);
             }
         }
 
@@ -485,7 +517,7 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
         {
           /* Check if the endpoints of the horizontal line are the same */
 
-          if (!SAME_CELL(toprow, leftcol, toprow, (leftcol + width - 1)))
+          if (!SAME_CELL(state, toprow, leftcol, toprow, (leftcol + width - 1)))
             {
               /* No.. they are different.  Divide the line in half */
 
@@ -504,13 +536,11 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                   /* Get the middle hit */
 
-                  trv_raycast(g_pitch[toprow], g_yaw[g_cell_column + midcol],
-                              RELYAW(g_cell_column + midcol),
-                              &g_ray_hit[toprow][midcol]);
+                  trv_cast_hit(state, toprow, midcol);
                 }
 
-              trv_resolve_cell(toprow, leftcol, 1, leftwidth);
-              trv_resolve_cell(toprow, midcol, 1, rightwidth);
+              trv_resolve_cell(state, toprow, leftcol, 1, leftwidth);
+              trv_resolve_cell(state, toprow, midcol, 1, rightwidth);
             }
 
           /* The endpoints of the horizontal line are the same! */
@@ -519,7 +549,7 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
             {
               /* Apply texturing */
 
-              trv_rend_row(toprow, leftcol, width);
+              trv_rend_row(state, toprow, leftcol, width);
             }
         }
     }
@@ -534,7 +564,7 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
        * endpoints are the same.
        */
 
-      if (!SAME_CELL(toprow, leftcol, (toprow + height - 1), leftcol))
+      if (!SAME_CELL(state, toprow, leftcol, (toprow + height - 1), leftcol))
         {
           /* No.. they are different.  Divide the line in half */
 
@@ -553,13 +583,11 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
               /* Get the middle hit */
 
-              trv_raycast(g_pitch[midrow], g_yaw[g_cell_column + leftcol],
-                          RELYAW(g_cell_column + leftcol),
-                          &g_ray_hit[midrow][leftcol]);
+              trv_cast_hit(state, midrow, leftcol);
             }
 
-          trv_resolve_cell(toprow, leftcol, topheight, 1);
-          trv_resolve_cell(midrow, leftcol, botheight, 1);
+          trv_resolve_cell(state, toprow, leftcol, topheight, 1);
+          trv_resolve_cell(state, midrow, leftcol, botheight, 1);
         }
 
       /* The endpoints of the vertical line are the same! */
@@ -568,7 +596,7 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
         {
           /* Apply texturing */
 
-          trv_rend_column(toprow, leftcol, height);
+          trv_rend_column(state, toprow, leftcol, height);
         }
     }
 
@@ -578,14 +606,259 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
     {
       /* Apply texturing */
 
-      trv_rend_pixel(toprow, leftcol);
+      trv_rend_pixel(state, toprow, leftcol);
     }
 }
 
+/****************************************************************************
+ * Function: trv_rend_band
+ *
+ * Description:
+ *   Cast and render one column band of the current horizontal swathe.
+ *
+ ****************************************************************************/
+
+static void trv_rend_band(int band)
+{
+  FAR struct trv_raystate_s *state = &g_ray_state[band];
+  int firstcell = (band * NUMBER_HGULPS) / g_nbands;
+  int endcell   = ((band + 1) * NUMBER_HGULPS) / g_nbands;
+  int cell      = firstcell;
+  int i;
+
+#if CONFIG_GRAPHICS_TRAVELER_NTHREADS > 1
+  int16_t leftcol;
+  int16_t rightcol;
+
+  if (g_nbands > 1)
+    {
+      /* The band owns the columns from the right corners of its first cell
+       * up to, but not including, the left corners of its last cell.  Those
+       * belong to the next band, if there is one.
+       */
+
+      leftcol  = CELL_COLUMN(endcell - 1);
+      rightcol = CELL_COLUMN(firstcell) + HGULP_SIZE;
+
+      if (band < g_nbands - 1)
+        {
+          leftcol++;
+        }
+
+      /* The right-most column is shared with the last cell of the band to
+       * the right.  Start one cell early so that that column is rendered
+       * exactly as it would be if the cells were rendered in sequence.
+       */
+
+      if (band > 0)
+        {
+          cell--;
+        }
+
+      /* Render into the private copy of the swathe, starting with the
+       * background that is already in the render buffer.  Only the owned
+       * columns are meaningful; the others are discarded.
+       */
+
+      for (i = 0; i < VGULP_SIZE; i++)
+        {
+          state->buffer_row[i] = g_band_buffer[band][i];
+          memcpy(&state->buffer_row[i][leftcol], &g_buffer_row[i][leftcol],
+                 rightcol - leftcol + 1);
+        }
+    }
+  else
+#endif
+    {
+      for (i = 0; i < VGULP_SIZE; i++)
+        {
+          state->buffer_row[i] = g_buffer_row[i];
+        }
+    }
+
+  /* Seed the algorithm PART III: These initial hits will be moved to the
+   * beginning the hit array on the first pass through the loop.
+   */
+
+  state->cell_column = CELL_COLUMN(cell) + HGULP_SIZE;
+  trv_cast_hit(state, TOP_ROW, LEFT_COL);
+  trv_cast_hit(state, BOT_ROW, LEFT_COL);
+
+  /* Loop through all columns at each yaw angle in the band */
+
+  for (; cell < endcell; cell++)
+    {
+      state->cell_column = CELL_COLUMN(cell);
+
+      trv_vdebug("\ncell_column=%d yaw=%d", state->cell_column,
+                 g_yaw[state->cell_column]);
+
+      /* Perform Ray VGULP_SIZE x HGULP_SIZE Casting */
+
+      /* The hits at the right corners will be the same as the hits for for
+       * the left hand corners on the next pass */
+
+      state->hit[TOP_ROW][RIGHT_COL] = state->hit[TOP_ROW][LEFT_COL];
+      state->hit[BOT_ROW][RIGHT_COL] = state->hit[BOT_ROW][LEFT_COL];
+
+      /* Now get new hits in the right corners. */
+
+      trv_cast_hit(state, TOP_ROW, LEFT_COL);
+      trv_cast_hit(state, BOT_ROW, LEFT_COL);
+
+      /* Now, resolve the cell recursively until the hits are the same in
+       * all four corners */
+
+      trv_resolve_cell(state, TOP_ROW, LEFT_COL, VGULP_SIZE,
+                       (HGULP_SIZE + 1));
+    }
+
+#if CONFIG_GRAPHICS_TRAVELER_NTHREADS > 1
+  if (g_nbands > 1)
+    {
+      /* Copy back the columns owned by this band */
+
+      for (i = 0; i < VGULP_SIZE; i++)
+        {
+          memcpy(&g_buffer_row[i][leftcol], &state->buffer_row[i][leftcol],
+                 rightcol - leftcol + 1);
+        }
+    }
+#endif
+}
+
+/****************************************************************************
+ * Function: trv_rend_thread
+ *
+ * Description:
+ *   This is the body of each render thread.  It renders its column band of
+ *   each swathe until trv_raycaster_terminate() is called.
+ *
+ ****************************************************************************/
+
+#if CONFIG_GRAPHICS_TRAVELER_NTHREADS > 1
+static FAR void *trv_rend_thread(FAR void *arg)
+{
+  int band = (int)((intptr_t)arg);
+
+  for (; ; )
+    {
+      while (sem_wait(&g_swathe_start[band]) < 0);
+      if (g_render_terminate)
+        {
+          break;
+        }
+
+      trv_rend_band(band);
+      sem_post(&g_swathe_done);
+    }
+
+  return NULL;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Function: trv_raycaster_initialize
+ *
+ * Description:
+ *   Select the number of column bands that each swathe is divided into and
+ *   start one render thread for each band after the first.  The first band
+ *   is always rendered by the caller of trv_raycaster().  'nthreads' is
+ *   limited to CONFIG_GRAPHICS_TRAVELER_NTHREADS.
+ *
+ ****************************************************************************/
+
+int trv_raycaster_initialize(int nthreads)
+{
+#if CONFIG_GRAPHICS_TRAVELER_NTHREADS > 1
+  struct sched_param param;
+  pthread_attr_t attr;
+  int ret;
+  int i;
+
+  /* Stop any render threads from a previous call */
+
+  trv_raycaster_terminate();
+
+  if (nthreads > CONFIG_GRAPHICS_TRAVELER_NTHREADS)
+    {
+      nthreads = CONFIG_GRAPHICS_TRAVELER_NTHREADS;
+    }
+
+  if (nthreads <= 1)
+    {
+      return OK;
+    }
+
+  (void)sem_init(&g_swathe_done, 0, 0);
+  g_render_terminate = false;
+
+  /* The render threads run at the priority of the caller */
+
+  (void)sched_getparam(0, &param);
+  (void)pthread_attr_init(&attr);
+  (void)pthread_attr_setstacksize(&attr,
+                                  CONFIG_GRAPHICS_TRAVELER_RENDER_STACKSIZE);
+  (void)pthread_attr_setschedparam(&attr, &param);
+
+  for (i = 1; i < nthreads; i++)
+    {
+      (void)sem_init(&g_swathe_start[i], 0, 0);
+      ret = pthread_create(&g_render_thread[i], &attr, trv_rend_thread,
+                           (FAR void *)((intptr_t)i));
+      if (ret != 0)
+        {
+          trv_debug("ERROR: Failed to start render thread %d: %d\n", i, ret);
+
+          /* Stop the threads that were started */
+
+          (void)sem_destroy(&g_swathe_start[i]);
+          g_nbands = i;
+          trv_raycaster_terminate();
+          return -ret;
+        }
+    }
+
+  g_nbands = nthreads;
+#endif
+
+  return OK;
+}
+
+/****************************************************************************
+ * Function: trv_raycaster_terminate
+ *
+ * Description:
+ *   Stop the render threads started by trv_raycaster_initialize().
+ *
+ ****************************************************************************/
+
+void trv_raycaster_terminate(void)
+{
+#if CONFIG_GRAPHICS_TRAVELER_NTHREADS > 1
+  int i;
+
+  if (g_nbands > 1)
+    {
+      g_render_terminate = true;
+
+      for (i = 1; i < g_nbands; i++)
+        {
+          sem_post(&g_swathe_start[i]);
+          (void)pthread_join(g_render_thread[i], NULL);
+          (void)sem_destroy(&g_swathe_start[i]);
+        }
+
+      (void)sem_destroy(&g_swathe_done);
+      g_nbands = 1;
+    }
+#endif
+}
+
 /****************************************************************************
  * Function: trv_raycaster
  *
@@ -607,15 +880,22 @@ void trv_raycaster(FAR struct trv_camera_s *player,
   trv_vdebug("\ntrv_raycaster: x=%d y=%d z=%d yaw=%d pitch=%d",
              player->x, player->x, player->z, player->yaw, player->pitch);
 
-  /* Copy the input "player" to the working "camera */
+  /* Copy the input "player" to the working "camera and to the camera of
+   * each column band.
+   */
 
   g_camera = *player;
+  for (i = 0; i < g_nbands; i++)
+    {
+      g_ray_state[i].camera = g_camera;
+    }
 
   /* The horizontal field of view is determined by the width of the window
    * (centered at the yaw angle)
    */
 
-  yaw = g_camera.yaw - (IMAGE_WIDTH / 2) + (HGULP_SIZE * VIDEO_COLUMN_ANGLE);
+  yaw = g_camera.yaw - (IMAGE_WIDTH / 2) +
+        ((HGULP_SIZE - 1) * VIDEO_COLUMN_ANGLE);
   if (yaw < 0)
     {
       yaw += ANGLE_360;
@@ -634,13 +914,13 @@ void trv_raycaster(FAR struct trv_camera_s *player,
 
   /* Loop through all columns at each yaw angle on the screen */
 
-  for (g_cell_column = IMAGE_WIDTH; g_cell_column >= 0; g_cell_column--)
+  for (i = IMAGE_WIDTH + 1; i >= 0; i--)
     {
       /* Save the yaw angle.  By saving all of the yaw angles, we can avoid
        * complex tests for 360 degree wraps.
        */
 
-      g_yaw[g_cell_column] = yaw;
+      g_yaw[i] = yaw;
 
       /* Test if viewing yaw angle needs to wrap around */
 
@@ -653,7 +933,7 @@ void trv_raycaster(FAR struct trv_camera_s *player,
 
   /* Seed the algorithm PART I: Set up the raycaster this yaw range. */
 
-  trv_ray_yawprune(g_yaw[IMAGE_WIDTH], g_yaw[0]);
+  trv_ray_yawprune(g_yaw[IMAGE_WIDTH + 1], g_yaw[0]);
 
   /* Top of Ray Casting Loops */
 
@@ -692,43 +972,27 @@ void trv_raycaster(FAR struct trv_camera_s *player,
 
       trv_ray_pitchprune(g_pitch[VGULP_SIZE - 1], g_pitch[0]);
 
-      /* Seed the algorithm PART III: These initial hits will be moved to the
-       * beginning the hit array on the first pass through the loop.
-       */
-
-      trv_raycast(g_pitch[TOP_ROW], g_yaw[IMAGE_WIDTH],
-                  RELYAW(IMAGE_WIDTH), &g_ray_hit[TOP_ROW][LEFT_COL]);
-      trv_raycast(g_pitch[BOT_ROW], g_yaw[IMAGE_WIDTH],
-                  RELYAW(IMAGE_WIDTH), &g_ray_hit[BOT_ROW][LEFT_COL]);
-
-      /* Loop through all columns at each yaw angle on the screen window */
+#if CONFIG_GRAPHICS_TRAVELER_NTHREADS > 1
+      /* Start the render threads on the other column bands */
 
-      for (g_cell_column = (IMAGE_WIDTH - HGULP_SIZE + 1);
-           g_cell_column >= 0; g_cell_column -= HGULP_SIZE)
+      for (i = 1; i < g_nbands; i++)
         {
-          trv_vdebug("\ng_cell_column=%d yaw=%d", g_cell_column,
-                     g_yaw[g_cell_column]);
-
-          /* Perform Ray VGULP_SIZE x HGULP_SIZE Casting */
-
-          /* The hits at the right corners will be the same as the hits for for
-           * the left hand corners on the next pass */
-
-          g_ray_hit[TOP_ROW][RIGHT_COL] = g_ray_hit[TOP_ROW][LEFT_COL];
-          g_ray_hit[BOT_ROW][RIGHT_COL] = g_ray_hit[BOT_ROW][LEFT_COL];
+          sem_post(&g_swathe_start[i]);
+        }
+#endif
 
-          /* Now get new hits in the right corners. */
+      /* Cast and render the first column band */
 
-          trv_raycast(g_pitch[TOP_ROW], g_yaw[g_cell_column],
-                      RELYAW(g_cell_column), &g_ray_hit[TOP_ROW][LEFT_COL]);
-          trv_raycast(g_pitch[BOT_ROW], g_yaw[g_cell_column],
-                      RELYAW(g_cell_column), &g_ray_hit[BOT_ROW][LEFT_COL]);
+      trv_rend_band(0);
 
-          /* Now, resolve the cell recursively until the hits are the same in
-           * all four corners */
+#if CONFIG_GRAPHICS_TRAVELER_NTHREADS > 1
+      /* Wait for the other bands to complete */
 
-          trv_resolve_cell(TOP_ROW, LEFT_COL, VGULP_SIZE, (HGULP_SIZE + 1));
+      for (i = 1; i < g_nbands; i++)
+        {
+          while (sem_wait(&g_swathe_done) < 0);
         }
+#endif
 
       /* End of the pitch loop.  Bump up the pitch angle and the rending buffer
        * pointer for the next time through the outer loop */
@@ -766,16 +1030,16 @@ void trv_raycaster(FAR struct trv_camera_s *player,
  *
  ****************************************************************************/
 
-uint8_t trv_get_texture(uint8_t row, uint8_t col)
+uint8_t trv_get_texture(FAR struct trv_raystate_s *state,
+                        uint8_t row, uint8_t col)
 {
-  FAR struct trv_raycast_s *ptr = &g_ray_hit[row][col];
+  FAR struct trv_raycast_s *ptr = &state->hit[row][col];
   FAR uint8_t *palptr;
   int16_t zone;
 
   /* Perform a ray cast to get the hit at this row & column */
 
-  trv_raycast(g_pitch[row], g_yaw[g_cell_column + col],
-              RELYAW(g_cell_column + col), ptr);
+  trv_cast_hit(state, row, col);
 
   /* Check if we hit anything */
 
@@ -50,6 +50,32 @@
 
 #include <nuttx/can/can.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifdef CONFIG_LIBOBD2_POLL
+#  ifndef CONFIG_LIBOBD2_POLL_MAXPIDS
+#    define CONFIG_LIBOBD2_POLL_MAXPIDS  32
+#  endif
+#  ifndef CONFIG_LIBOBD2_POLL_INFLIGHT
+#    define CONFIG_LIBOBD2_POLL_INFLIGHT 4
+#  endif
+#  ifndef CONFIG_LIBOBD2_POLL_TIMEOUT
+#    define CONFIG_LIBOBD2_POLL_TIMEOUT  100
+#  endif
+#  ifndef CONFIG_LIBOBD2_POLL_MAXECUS
+#    define CONFIG_LIBOBD2_POLL_MAXECUS  2
+#  endif
+#  ifndef CONFIG_LIBOBD2_POLL_MAXLEN
+#    define CONFIG_LIBOBD2_POLL_MAXLEN   256
+#  endif
+
+/* ECU ID passed to the poll callback for a request that timed out */
+
+#  define OBD_POLL_NOECU                 0xff
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -64,6 +90,8 @@ enum
 
 /* OBD-II structure */
 
+struct obd_poll_s;
+
 struct obd_dev_s
 {
   struct  can_msg_s can_txmsg;       /* TX Message                          */
@@ -71,12 +99,43 @@ struct obd_dev_s
   struct  canioc_bittiming_s can_bt; /* Current bitrate                     */
   uint8_t can_mode;                  /* Current mode (Standard or Extended) */
   int     can_fd;                    /* File Descriptor of CAN Device       */
-#ifdef CONFIG_MULTIFRAME_SUPPORT
+#ifdef CONFIG_LIBOBD2_MULTIFRAME
   uint8_t data[4096];                /* Up to 4096 bytes                    */
 #else
   uint8_t data[8];                   /* Single Frame = 8 bytes              */
 #endif
+#ifdef CONFIG_LIBOBD2_POLL
+  FAR struct obd_poll_s *poll;       /* Polling engine state                */
+#endif
+};
+
+#ifdef CONFIG_LIBOBD2_POLL
+/* Called by obd_poll_run() for each response to a polled PID.  data points
+ * to the response payload starting with the response mode (opmode +
+ * OBD_RESP_BASE) and the PID, and len counts all of it.  The payload is
+ * also left in dev->data as by obd_wait_response(), so obd_decode_pid() can
+ * be used on it.  ecu is the number of the ECU that answered (0-7 for
+ * standard IDs, the ECU address for extended IDs).
+ *
+ * A request that is not answered in time is reported once with ecu set to
+ * OBD_POLL_NOECU, data NULL and len 0.
+ */
+
+typedef CODE void (*obd_pollcb_t)(FAR struct obd_dev_s *dev, FAR void *arg,
+                                  uint8_t ecu, uint8_t opmode, uint8_t pid,
+                                  FAR const uint8_t *data, size_t len);
+
+/* Polling engine statistics */
+
+struct obd_pollstats_s
+{
+  uint32_t requests;                 /* Requests sent                       */
+  uint32_t responses;                /* Responses passed to the callback    */
+  uint32_t timeouts;                 /* Requests not answered in time       */
+  uint32_t errors;                   /* Send failures, bad multi-frames     */
+  uint32_t maxrtt;                   /* Longest request to response (msec) */
 };
+#endif
 
 /****************************************************************************
  * Name: obd_init
@@ -129,4 +188,82 @@ int obd_wait_response(FAR struct obd_dev_s *dev, uint8_t opmode, uint8_t pid,
 
 FAR char *obd_decode_pid(FAR struct obd_dev_s *dev, uint8_t pid);
 
+#ifdef CONFIG_LIBOBD2_POLL
+/****************************************************************************
+ * Name: obd_poll_init
+ *
+ * Description:
+ *   Prepare the device for polling.  callback is called with arg for each
+ *   response received by obd_poll_run().
+ *
+ *   Returns OK or a negated errno value.
+ *
+ ****************************************************************************/
+
+int obd_poll_init(FAR struct obd_dev_s *dev, obd_pollcb_t callback,
+                  FAR void *arg);
+
+/****************************************************************************
+ * Name: obd_poll_uninit
+ *
+ * Description:
+ *   Release the polling engine.
+ *
+ ****************************************************************************/
+
+void obd_poll_uninit(FAR struct obd_dev_s *dev);
+
+/****************************************************************************
+ * Name: obd_poll_add
+ *
+ * Description:
+ *   Poll a PID every "period" milliseconds, or only once if period is zero.
+ *   Adding a PID that is already polled changes its period.  The first
+ *   request is sent by the next obd_poll_run().
+ *
+ *   Returns OK or a negated errno value.
+ *
+ ****************************************************************************/
+
+int obd_poll_add(FAR struct obd_dev_s *dev, uint8_t opmode, uint8_t pid,
+                 unsigned int period);
+
+/****************************************************************************
+ * Name: obd_poll_remove
+ *
+ * Description:
+ *   Stop polling a PID.  A response still in flight is ignored.
+ *
+ *   Returns OK or -ENOENT if the PID was not polled.
+ *
+ ****************************************************************************/
+
+int obd_poll_remove(FAR struct obd_dev_s *dev, uint8_t opmode, uint8_t pid);
+
+/****************************************************************************
+ * Name: obd_poll_run
+ *
+ * Description:
+ *   Run the polling engine for "msec" milliseconds: send requests as they
+ *   fall due, keeping up to CONFIG_LIBOBD2_POLL_INFLIGHT of them in flight,
+ *   and pass the responses to the callback as they arrive.
+ *
+ *   Returns OK or a negated errno value if the CAN device fails.
+ *
+ ****************************************************************************/
+
+int obd_poll_run(FAR struct obd_dev_s *dev, unsigned int msec);
+
+/****************************************************************************
+ * Name: obd_poll_getstats
+ *
+ * Description:
+ *   Return the polling engine statistics.
+ *
+ ****************************************************************************/
+
+void obd_poll_getstats(FAR struct obd_dev_s *dev,
+                       FAR struct obd_pollstats_s *stats);
+#endif
+
 #endif /*__APPS_INCLUDE_CANUTILS_OBD_H */
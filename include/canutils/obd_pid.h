@@ -50,6 +50,17 @@
 #define OBD_PID_STD_RESPONSE            0x7e8       /* Standard PID RESPONSE Message ID = 0x7e8 */
 #define OBD_PID_EXT_RESPONSE            0x18daf110  /* Extended PID RESPONSE Message ID = 0x18daf111 or 0x18daf11d */
 
+/* Each ECU answers on its own ID and accepts flow control frames on the
+ * matching physical request ID.
+ */
+
+#define OBD_PID_STD_RESPONSE_FIRST      0x7e8       /* Standard responses from ECU 0-7 = 0x7e8-0x7ef */
+#define OBD_PID_STD_RESPONSE_LAST       0x7ef
+#define OBD_PID_STD_ECU_REQUEST         0x7e0       /* Standard physical request ID = response ID - 8 */
+#define OBD_PID_EXT_RESPONSE_MASK       0xffffff00
+#define OBD_PID_EXT_RESPONSE_BASE       0x18daf100  /* Extended responses = 0x18daf1xx, xx = ECU address */
+#define OBD_PID_EXT_ECU_REQUEST         0x18da00f1  /* Extended physical request ID = 0x18daxxf1 */
+
 #define OBD_RESP_BASE                   0x40        /* Response mode = (0x40 + OpMode) */
 
 /* OBD Operation Modes */
@@ -135,4 +146,10 @@
 #define OBD_PID_CATAL_TEMP_BK1SS2       0x3e /* Catalyst Temperature Bank 1, Sensor 2 */
 #define OBD_PID_CATAL_TEMP_BK2SS2       0x3f /* Catalyst Temperature Bank 2, Sensor 2 */
 
+/* Vehicle Information (OBD_RQST_VEHICLE_INFO) */
+
+#define OBD_INFO_VIN_COUNT              0x01 /* VIN message count */
+#define OBD_INFO_VIN                    0x02 /* Vehicle Identification Number (multi-frame) */
+#define OBD_INFO_CALID                  0x04 /* Calibration ID (multi-frame) */
+
 #endif /* __APPS_INCLUDE_CANUTILS_OBD_PID_H */
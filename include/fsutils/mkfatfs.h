@@ -58,6 +58,8 @@
 #define MKFATFS_DEFAULT_HIDSEC       0     /* No hidden sectors */
 #define MKFATFS_DEFAULT_VOLUMEID     0     /* No volume ID */
 #define MKFATFS_DEFAULT_NSECTORS     0     /* 0: Use all sectors on device */
+#define MKFATFS_DEFAULT_PROGRESS     NULL  /* No progress reports */
+#define MKFATFS_DEFAULT_PROGARG      NULL
 
 #define FAT_FORMAT_INITIALIZER \
 { \
@@ -70,13 +72,22 @@
   MKFATFS_DEFAULT_RSVDSECCOUNT, \
   MKFATFS_DEFAULT_HIDSEC, \
   MKFATFS_DEFAULT_VOLUMEID, \
-  MKFATFS_DEFAULT_NSECTORS \
+  MKFATFS_DEFAULT_NSECTORS, \
+  MKFATFS_DEFAULT_PROGRESS, \
+  MKFATFS_DEFAULT_PROGARG \
 }
 
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
+/* Called after each write while the file system is written.  nwritten
+ * and ntotal are the number of sectors written so far and in total.
+ */
+
+typedef CODE void (*mkfatfs_progress_t)(FAR void *arg, uint32_t nwritten,
+                                        uint32_t ntotal);
+
 /* These are input parameters for the format.  On return, these values may be
  * overwritten with actual values used in the format.
  */
@@ -93,6 +104,8 @@ struct fat_format_s
    uint32_t ff_hidsec;          /* Count of hidden sectors preceding fat */
    uint32_t ff_volumeid;        /* FAT volume id */
    uint32_t ff_nsectors;        /* Number of sectors from device to use: 0: Use all */
+   mkfatfs_progress_t ff_progress; /* Progress callback (may be NULL) */
+   FAR void *ff_progarg;        /* Argument passed to ff_progress */
 };
 
 /****************************************************************************
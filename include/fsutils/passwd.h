@@ -74,7 +74,7 @@
  *
  ****************************************************************************/
 
-#if defined(CONFIG_FS_WRITABLE) && defined(CONFIG_FSUTILS_PASSWD_READONLY)
+#if defined(CONFIG_FS_WRITABLE) && !defined(CONFIG_FSUTILS_PASSWD_READONLY)
 int passwd_adduser(FAR const char *username, FAR const char *password);
 
 /****************************************************************************
@@ -113,7 +113,7 @@ int passwd_deluser(FAR const char *username);
  ****************************************************************************/
 
 int passwd_update(FAR const char *username, FAR const char *password);
-#endif /* CONFIG_FS_WRITABLE && CONFIG_FSUTILS_PASSWD_READONLY */
+#endif /* CONFIG_FS_WRITABLE && !CONFIG_FSUTILS_PASSWD_READONLY */
 
 /****************************************************************************
  * Name: passwd_verify
@@ -41,7 +41,10 @@
  * Included Files
  ****************************************************************************/
 
+#include <nuttx/config.h>
+
 #include <stdio.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <errno.h>
@@ -54,6 +57,10 @@
 
 #define MINMEA_MAX_LENGTH 80
 
+/* The longest supported sentence, GSV, has 20 fields after the identifier */
+
+#define MINMEA_MAX_FIELDS 24
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -191,6 +198,68 @@ struct minmea_sentence_gsv
   struct minmea_sat_info  sats[4];
 };
 
+#ifdef CONFIG_GPSUTILS_MINMEA_STREAM
+/* Any decoded sentence, as handed to a stream callback */
+
+union minmea_sentence_u
+{
+  struct minmea_sentence_rmc rmc;
+  struct minmea_sentence_gga gga;
+  struct minmea_sentence_gsa gsa;
+  struct minmea_sentence_gll gll;
+  struct minmea_sentence_gst gst;
+  struct minmea_sentence_gsv gsv;
+};
+
+/* Called for every framed sentence with a good checksum.  id is
+ * MINMEA_UNKNOWN (and frame NULL) for sentences that have no decoder and
+ * MINMEA_INVALID (frame NULL) for known sentences whose fields do not
+ * parse.  sentence is the NUL terminated text without the line ending.
+ * Both pointers are only valid for the duration of the call.
+ */
+
+typedef CODE void
+  (*minmea_stream_cb_t)(FAR void *arg, enum minmea_sentence_id id,
+                        FAR const union minmea_sentence_u *frame,
+                        FAR const char *sentence);
+
+struct minmea_stream_stats_s
+{
+  uint32_t sentences;           /* Sentences decoded */
+  uint32_t unknown;             /* Sentences without a decoder */
+  uint32_t badchecksum;         /* Sentences dropped: checksum mismatch */
+  uint32_t badframe;            /* Sentences dropped: too long, bad bytes */
+  uint32_t badfield;            /* Sentences dropped: field did not parse */
+};
+
+/* Streaming parser state.  Everything the parser needs is held here so that
+ * it can be statically allocated by the caller.
+ */
+
+struct minmea_stream_s
+{
+  uint8_t state;                /* Framing state */
+  uint8_t checksum;             /* XOR of the bytes between '$' and '*' */
+  uint8_t expected;             /* Checksum received after '*' */
+  uint8_t nfields;              /* Number of fields found so far */
+  uint8_t len;                  /* Number of bytes in buffer */
+  bool strict;                  /* Drop sentences without checksum */
+  minmea_stream_cb_t callback;  /* Sentence consumer */
+  FAR void *arg;                /* Callback argument */
+  struct minmea_stream_stats_s stats;
+
+  /* Offset of the first byte of each field in buffer.  Field 0 is the
+   * talker and sentence identifier following the '$'.  Once the sentence
+   * is complete, field[nfields] is one past the '*' (or the end of line)
+   * so that every field ends one byte before the start of the next.
+   */
+
+  uint8_t field[MINMEA_MAX_FIELDS + 1];
+  char buffer[MINMEA_MAX_LENGTH + 4];
+  union minmea_sentence_u frame;
+};
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -239,6 +308,24 @@ bool minmea_parse_gll(struct minmea_sentence_gll *frame, const char *sentence);
 bool minmea_parse_gst(struct minmea_sentence_gst *frame, const char *sentence);
 bool minmea_parse_gsv(struct minmea_sentence_gsv *frame, const char *sentence);
 
+#ifdef CONFIG_GPSUTILS_MINMEA_STREAM
+/* Initialize a streaming parser.  In strict mode sentences without a
+ * checksum are dropped.
+ */
+
+void minmea_stream_init(FAR struct minmea_stream_s *stream, bool strict,
+                        minmea_stream_cb_t callback, FAR void *arg);
+
+/* Feed raw receiver bytes to a streaming parser.  The data need not be
+ * aligned to sentence boundaries; partial sentences are kept for the next
+ * call.  The callback is invoked from within this function for every
+ * complete sentence.
+ */
+
+void minmea_stream_feed(FAR struct minmea_stream_s *stream,
+                        FAR const char *data, size_t len);
+#endif
+
 /* Convert GPS UTC date/time representation to a UNIX timestamp. */
 
 int minmea_gettime(FAR struct timespec *ts,
@@ -65,6 +65,8 @@
 struct ft80x_dlbuffer_s
 {
   bool coproc;       /* True: Use co-processor FIFO; false: Use DL memory */
+  bool pending;      /* True: Co-processor may still be executing the last
+                      * display list */
   uint16_t dlsize;   /* Total sizeof the display list written to hardware */
   uint16_t dloffset; /* The number display list bytes buffered locally */
   uint32_t dlbuffer[FT80X_DL_BUFWORDS];
@@ -148,7 +150,9 @@ int ft80x_dl_start(int fd, FAR struct ft80x_dlbuffer_s *buffer, bool coproc);
  *      buffer offset to zero.
  *   4) Swap to the newly created display list (DL memory case only).
  *   5) For the case of the co-processor RAM CMD, it will also wait for the
- *      FIFO to be emptied.
+ *      FIFO to be emptied.  If CONFIG_GRAPHICS_FT80X_PIPELINE is selected,
+ *      it returns without waiting so that the next display list can be
+ *      built while the co-processor executes this one.
  *
  * Input Parameters:
  *   fd     - The file descriptor of the FT80x device.  Opened by the caller
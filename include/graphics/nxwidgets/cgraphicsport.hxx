@@ -110,6 +110,39 @@ namespace NXWidgets
 #ifdef CONFIG_NX_WRITEONLY
     nxgl_mxpixel_t m_backColor;  /**< The background color to use */
 #endif
+    struct nxgl_rect_s m_clipRect; /**< Drawing is limited to this area */
+    bool           m_clipped;    /**< True: m_clipRect is in effect */
+    FAR uint8_t   *m_textBuffer; /**< Text is composed here before drawing */
+    unsigned int   m_textBufferSize; /**< Size of m_textBuffer in bytes */
+
+    /**
+     * Clip a destination rectangle to the clipping rectangle, if any.
+     *
+     * @param rect The rectangle to clip.  Modified in place.
+     * @return False if nothing is left to draw.
+     */
+
+    bool clip(FAR struct nxgl_rect_s *rect) const;
+
+    /**
+     * Test if any part of a rectangle lies within the clipping rectangle.
+     * Used for operations that cannot be clipped exactly.
+     *
+     * @param rect The rectangle to test.
+     * @return True if the rectangle is (partly) visible.
+     */
+
+    bool isVisible(FAR const struct nxgl_rect_s *rect) const;
+
+    /**
+     * Make sure that the text composition buffer can hold a run of text.
+     *
+     * @param width The width of the run in pixels.
+     * @param height The height of the run in rows.
+     * @return False if the memory could not be allocated.
+     */
+
+    bool reserveTextBuffer(nxgl_coord_t width, nxgl_coord_t height);
 
     /**
      * The underlying implementation for drawText functions
@@ -150,6 +183,35 @@ namespace NXWidgets
 
     virtual ~CGraphicsPort();
 
+    /**
+     * Limit all following drawing to a rectangle.  Fills, bitmaps and text
+     * are clipped exactly.  Lines and circles cannot be clipped by NX, so
+     * they are drawn whole if any part of their bounding box is inside the
+     * rectangle.  move() and copy() are not clipped.
+     *
+     * @param rect The window-relative clipping rectangle.
+     */
+
+    void setClipRect(FAR const struct nxgl_rect_s *rect);
+
+    /**
+     * Remove the clipping rectangle.
+     */
+
+    inline void clearClipRect(void)
+    {
+      m_clipped = false;
+    }
+
+    /**
+     * Get the current clipping rectangle.
+     *
+     * @param rect The location to return the clipping rectangle.
+     * @return False if there is no clipping rectangle.
+     */
+
+    bool getClipRect(FAR struct nxgl_rect_s *rect) const;
+
     /**
      * Return the absolute x coordinate of the upper left hand corner of the
      * underlying window.
@@ -301,11 +363,8 @@ namespace NXWidgets
      * @param color The color of the rectangle.
      */
 
-    inline void drawFilledCircle(struct nxgl_point_s *center, nxgl_coord_t radius,
-                                 nxgl_mxpixel_t color)
-    {
-      (void)m_pNxWnd->drawFilledCircle(center, radius, color);
-    }
+    void drawFilledCircle(struct nxgl_point_s *center, nxgl_coord_t radius,
+                          nxgl_mxpixel_t color);
 
     /**
      * Draw a string to the window.
@@ -0,0 +1,194 @@
+/****************************************************************************
+ * apps/include/graphics/nxwidgets/chitindex.hxx
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+ *    me be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_INCLUDE_GRAPHICS_NXWIDGETS_CHITINDEX_HXX
+#define __APPS_INCLUDE_GRAPHICS_NXWIDGETS_CHITINDEX_HXX
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <nuttx/nx/nxglib.h>
+
+#include "graphics/nxwidgets/nxconfig.hxx"
+#include "graphics/nxwidgets/tnxarray.hxx"
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Implementation Classes
+ ****************************************************************************/
+
+#if defined(__cplusplus)
+
+namespace NXWidgets
+{
+  class CNxWidget;
+
+  /**
+   * Spatial index used to find the widgets that may contain a point without
+   * testing every widget in a list.
+   *
+   * The bounding box of the widgets is divided into a grid of up to
+   * CONFIG_NXWIDGETS_HITINDEX_GRIDSIZE x CONFIG_NXWIDGETS_HITINDEX_GRIDSIZE
+   * cells.  Each cell lists the indexes of the widgets that overlap it, in
+   * ascending order, so a lookup returns only the widgets near the point in
+   * the same stacking order as the list.
+   *
+   * The index does not track the widgets.  The owner must call invalidate()
+   * whenever a widget in the list moves, is resized, or the list changes; the
+   * index is then rebuilt by the next call to build().  invalidate() does
+   * not free memory, so entries returned by lookup() remain readable (though
+   * possibly stale) if the index is invalidated while they are being used.
+   */
+
+  class CHitIndex
+  {
+  private:
+    FAR uint16_t *m_cells;      /**< Offset of the first entry of each cell,
+                                     plus one past the end of the last */
+    FAR uint16_t *m_entries;    /**< Widget indexes listed by each cell */
+    int           m_nCells;     /**< Number of cells allocated */
+    int           m_nEntries;   /**< Number of entries allocated */
+    nxgl_coord_t  m_x;          /**< Left edge of the grid */
+    nxgl_coord_t  m_y;          /**< Top edge of the grid */
+    nxgl_coord_t  m_cellWidth;  /**< Width of each cell in pixels */
+    nxgl_coord_t  m_cellHeight; /**< Height of each cell in pixels */
+    uint8_t       m_cols;       /**< Number of columns of cells */
+    uint8_t       m_rows;       /**< Number of rows of cells */
+    bool          m_valid;      /**< True: the index matches the widgets */
+
+    /**
+     * Get the rectangle occupied by a widget.
+     *
+     * @param widget The widget.
+     * @param absolute True: use window coordinates; false: use coordinates
+     * relative to the widget's parent.
+     * @param rect Receives the widget's rectangle.
+     * @return True if the widget occupies any pixels.
+     */
+
+    static bool getWidgetRect(const CNxWidget *widget, bool absolute,
+                              struct nxgl_rect_s &rect);
+
+    /**
+     * Get the range of cells overlapped by a rectangle.  The rectangle
+     * must lie within the bounding box used to build the grid.
+     *
+     * @param rect The rectangle.
+     * @param range Receives the first and last column (x) and row (y).
+     */
+
+    void getCellRange(const struct nxgl_rect_s &rect,
+                      struct nxgl_rect_s &range) const;
+
+    /**
+     * Copy constructor is private to prevent usage.
+     */
+
+    inline CHitIndex(const CHitIndex &hitIndex) { }
+
+  public:
+
+    /**
+     * Constructor.  The index is initially empty and invalid.
+     */
+
+    CHitIndex(void);
+
+    /**
+     * Destructor.
+     */
+
+    ~CHitIndex(void);
+
+    /**
+     * Mark the index as out of date.
+     */
+
+    inline void invalidate(void)
+    {
+      m_valid = false;
+    }
+
+    /**
+     * Check if the index matches the widgets.
+     *
+     * @return True if the index is valid.
+     */
+
+    inline bool isValid(void) const
+    {
+      return m_valid;
+    }
+
+    /**
+     * Rebuild the index from a list of widgets.
+     *
+     * @param widgets The widgets to index.
+     * @param absolute True: index the widgets by their window coordinates;
+     * false: index them by their coordinates relative to their parent.
+     * @return True if the index was built; false if memory could not be
+     * allocated, in which case the index remains invalid.
+     */
+
+    bool build(const TNxArray<CNxWidget*> &widgets, bool absolute);
+
+    /**
+     * Find the widgets whose rectangles may contain a point.  The index must
+     * be valid.
+     *
+     * @param x The x coordinate of the point.
+     * @param y The y coordinate of the point.
+     * @param entries Receives a pointer to the indexes of the widgets, in
+     * ascending order.
+     * @return The number of widget indexes.
+     */
+
+    int lookup(nxgl_coord_t x, nxgl_coord_t y,
+               FAR const uint16_t *&entries) const;
+  };
+}
+
+#endif // __cplusplus
+
+#endif // __APPS_INCLUDE_GRAPHICS_NXWIDGETS_CHITINDEX_HXX
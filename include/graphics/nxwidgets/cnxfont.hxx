@@ -48,6 +48,8 @@
 #include <nuttx/nx/nxglib.h>
 #include <nuttx/nx/nxfonts.h>
 
+#include "graphics/nxwidgets/nxconfig.hxx"
+
 /****************************************************************************
  * Pre-Processor Definitions
  ****************************************************************************/
@@ -76,6 +78,30 @@ namespace NXWidgets
     nxgl_mxpixel_t m_fontColor;             /**< Color to draw the font with when rendering. */
     nxgl_mxpixel_t m_transparentColor;      /**< Background color that should not be rendered. */
 
+    /**
+     * One character pre-rendered in one color on a solid background.
+     */
+
+    struct SGlyph
+    {
+      FAR uint8_t    *data;                 /**< Pixels, getMaxWidth() per row */
+      nxgl_mxpixel_t  color;                /**< Font color */
+      nxgl_mxpixel_t  background;           /**< Background color */
+      nxwidget_char_t letter;               /**< The character */
+      uint8_t         width;                /**< Width in pixels */
+    };
+
+    FAR uint8_t *m_glyphMemory;             /**< Memory for all cached glyphs */
+    struct SGlyph m_glyphs[CONFIG_NXWIDGETS_GLYPHCACHE_SIZE];
+                                            /**< Cached glyphs, most recent first */
+    uint8_t m_nGlyphs;                      /**< Number of cached glyphs */
+
+    /**
+     * Copy constructor is private to prevent usage.
+     */
+
+    inline CNxFont(const CNxFont &font) { }
+
   public:
 
     /**
@@ -94,7 +120,7 @@ namespace NXWidgets
      * CNxFont Destructor.
      */
 
-    ~CNxFont() { }
+    ~CNxFont();
 
     /**
      * Checks if supplied character is blank in the current font.
@@ -151,6 +177,9 @@ namespace NXWidgets
 
     /**
      * Draw an individual character of the font to the specified bitmap.
+     * The character is drawn at the top left of the bitmap using the
+     * bitmap's stride, so it may be drawn into a wider bitmap holding a
+     * whole line of text.
      *
      * @param bitmap The bitmap to draw to.
      * @param letter The character to output.
@@ -158,6 +187,31 @@ namespace NXWidgets
 
     void drawChar(FAR SBitmap *bitmap, nxwidget_char_t letter);
 
+    /**
+     * Get a character rendered in the current color on a solid
+     * background.  The most recently used characters are kept, so text
+     * is only rendered once per character and pair of colors.
+     *
+     * @param letter The character to get.
+     * @param background The background color.
+     * @param width The location to return the width of the character.
+     * @return The rendered pixels (getMaxWidth() pixels per row and
+     *   getHeight() rows) or NULL if the cache could not be allocated.
+     */
+
+    FAR const uint8_t *getGlyph(nxwidget_char_t letter,
+                                nxgl_mxpixel_t background,
+                                FAR nxgl_coord_t *width);
+
+    /**
+     * Discard all cached glyphs.
+     */
+
+    inline void flushGlyphCache(void)
+    {
+      m_nGlyphs = 0;
+    }
+
     /**
      * Get the width of a string in pixels when drawn with this font.
      *
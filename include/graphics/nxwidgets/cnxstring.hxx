@@ -109,9 +109,17 @@ namespace NXWidgets
    * It also means that increasing the length of such a string is a cheaper
    * operation as memory does not need to allocated and copied.
    *
-   * Additionally, the string increases its array size by m_growAmount every
-   * time it needs to allocate extra memory, potentially reducing the number
-   * of reallocs needed.
+   * Additionally, the string at least doubles its array size (and grows by
+   * no less than m_growAmount) every time it needs to allocate extra
+   * memory, so a string built up by repeated appends is copied only
+   * O(log n) times.
+   *
+   * Characters removed from the front of the string are not moved; the
+   * start of the string simply advances through the allocated memory and
+   * the text is slid back to the start of the allocation only when the
+   * tail runs out of room.  This lets a log-style buffer that appends at
+   * the end and trims at the front run in amortized constant time per
+   * character.
    *
    * The string is not null-terminated.  Instead, it uses a m_stringLength
    * member that stores the number of characters in the string.  This saves a
@@ -125,9 +133,11 @@ namespace NXWidgets
 
     int m_stringLength;  /**< Number of characters in the string */
     int m_allocatedSize; /**< Number of bytes allocated for this string */
-    int m_growAmount;    /**< Number of chars that the string grows by
-                              whenever it needs to get larger */
-
+    int m_growAmount;    /**< Minimum number of chars that the string
+                              grows by whenever it needs to get larger */
+    FAR nxwidget_char_t *m_storage; /**< Start of the allocated memory;
+                                         m_text may point past characters
+                                         trimmed from the front */
 
   protected:
     FAR nxwidget_char_t *m_text;  /**< Raw char array data */
@@ -222,8 +232,9 @@ namespace NXWidgets
 
     virtual inline ~CNxString()
     {
-      delete[] m_text;
-      m_text = (FAR nxwidget_char_t *)NULL;
+      delete[] m_storage;
+      m_storage = (FAR nxwidget_char_t *)NULL;
+      m_text    = (FAR nxwidget_char_t *)NULL;
     };
 
     /**
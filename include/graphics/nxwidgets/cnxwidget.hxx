@@ -112,6 +112,7 @@ namespace NXWidgets
   class CGraphicsPort;
   class CNxFont;
   class CWidgetEventHandlerList;
+  class CHitIndex;
 
   /**
    * Class providing all the basic functionality of a NxWidget.  All other
@@ -202,6 +203,8 @@ namespace NXWidgets
     CNxWidget *m_parent;              /**< Pointer to the widget's parent. */
     CNxWidget *m_focusedChild;        /**< Pointer to the child widget that has focus. */
     TNxArray<CNxWidget*> m_children;  /**< List of child widgets. */
+    CHitIndex *m_hitIndex;            /**< Index of the children by position; only
+                                           allocated for widgets with many children. */
 
     // Borders
 
@@ -243,6 +246,25 @@ namespace NXWidgets
 
     void closeChild(CNxWidget *widget);
 
+    /**
+     * Pass a click to the topmost child widget that accepts it.  With
+     * many children, only the children that the hit index places under
+     * the click are tried.
+     *
+     * @param x The x coordinate of the click.
+     * @param y The y coordinate of the click.
+     * @return True if a child accepted the click.
+     */
+
+    bool clickChildren(nxgl_coord_t x, nxgl_coord_t y);
+
+    /**
+     * Notify the parent and the controlling widget that the area covered
+     * by this widget has changed, so their hit indexes are out of date.
+     */
+
+    void hitAreaChanged(void);
+
     /**
      * Notify this widget that it is being dragged, and set its drag point.
      *
@@ -1023,6 +1045,37 @@ namespace NXWidgets
 
     void redraw(void);
 
+    /**
+     * Add the area of this widget to the window's damage region.  The
+     * widget (and anything beneath or above it that overlaps) is redrawn,
+     * clipped to the damaged area, the next time the widget control
+     * processes its damage.  Unlike redraw(), this may be called any
+     * number of times per frame for the cost of one draw.
+     *
+     * @see CWidgetControl::invalidate().
+     */
+
+    void invalidate(void);
+
+    /**
+     * Redraw the parts of the widget and its children that fall within a
+     * damaged region.  Drawing is clipped to the region, and children
+     * that are completely covered by a later sibling are skipped.
+     *
+     * @param damage The window-relative damaged region.
+     */
+
+    void redrawDamaged(FAR const struct nxgl_rect_s *damage);
+
+    /**
+     * Test if the widget is drawn and completely covers a region.
+     *
+     * @param rect The window-relative region to test.
+     * @return True if nothing beneath the widget is visible in the region.
+     */
+
+    bool coversRect(FAR const struct nxgl_rect_s *rect) const;
+
     /**
      * Enables the widget.
      *
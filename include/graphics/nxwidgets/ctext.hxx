@@ -103,36 +103,77 @@ namespace NXWidgets
    * This class functions as a wrapper around a char array offering
    * more advanced functionality - it can wrap text, calculate its
    * height in pixels, calculate the width of a row, etc.
+   *
+   * The wrapping is maintained incrementally.  Appending text only
+   * re-wraps the last line and the new text.  Inserting or removing text
+   * re-wraps from the affected line until the new line breaks fall back
+   * into step with the old ones (at the latest, at the end of the edited
+   * paragraph); the breaks after that point are just moved by the change
+   * in length.  Lines stripped from the top of the text are dropped from
+   * the front of the line table without re-wrapping anything, so a text
+   * used as a bounded log costs O(new text) per append.
    */
 
   class CText : public CNxString
   {
   private:
+    CNxFont               *m_font;            /**< Font to be used for output */
+    TNxArray<int>          m_linePositions;   /**< Array containing start indexes
+                                                   of each wrapped line, plus an
+                                                   end of text marker */
+    TNxArray<nxgl_coord_t> m_lineWidths;      /**< Array containing the pixel
+                                                   width of each wrapped line */
+    int                    m_firstLine;       /**< Index of the first line in the
+                                                   arrays; earlier entries have
+                                                   been stripped */
+    int                    m_firstChar;       /**< Offset of the stored line
+                                                   positions from the char
+                                                   indexes in the string */
+    nxgl_coord_t           m_lineSpacing;     /**< Spacing between lines of text */
+    int32_t                m_textPixelHeight; /**< Total height of the wrapped
+                                                   text in pixels */
+    nxgl_coord_t           m_width;           /**< Width in pixels available t
+                                                   the text */
 
     /**
-     * Struct defining the position and length of a longest line within
-     * the m_linePositions array.
+     * Find where the line of text starting at the specified char index
+     * wraps.
+     *
+     * @param iterator Iterator over this string.
+     * @param pos The index of the first char in the line.
+     * @param lineWidth Receives the pixel width of the line.
+     * @return The index of the first char of the next line, or -1 if the
+     * line runs to the end of the text.
      */
 
-    typedef struct
-    {
-      int     index;
-      uint8_t width;
-    } LongestLine;
-
-    CNxFont              *m_font;            /**< Font to be used for output */
-    TNxArray<int>         m_linePositions;   /**< Array containing start indexes
-                                                  of each wrapped line */
-    TNxArray<LongestLine> m_longestLines;    /**< Array containing data describing
-                                                  successively longer wrapped
-                                                  lines */
-    nxgl_coord_t          m_lineSpacing;     /**< Spacing between lines of text */
-    int32_t               m_textPixelHeight; /**< Total height of the wrapped
-                                                  text in pixels */
-    uint8_t               m_textPixelWidth;  /**< Total width of the wrapped text
-                                                  in pixels */
-    nxgl_coord_t          m_width;           /**< Width in pixels available t
-                                                  the text */
+    int findLineEnd(CStringIterator *iterator, int pos,
+                    nxgl_coord_t &lineWidth) const;
+
+    /**
+     * Re-wrap the text after an insertion or removal.  Wrapping starts
+     * with the line before the edit and stops as soon as a new line starts
+     * at the same place as an old line after the edit; the remaining line
+     * positions are adjusted by the change in length.
+     *
+     * @param charIndex The index of the first changed char.
+     * @param delta The number of chars inserted (positive) or removed
+     * (negative).
+     */
+
+    void rewrap(int charIndex, int delta);
+
+    /**
+     * Move the live line data to the start of the line arrays, discarding
+     * the entries of any stripped lines.
+     */
+
+    void compactLines(void);
+
+    /**
+     * Recalculate the total height of the text.
+     */
+
+    void updatePixelHeight(void);
 
   public:
 
@@ -285,15 +326,13 @@ namespace NXWidgets
     }
 
     /**
-     * Get the width of the longest line in pixels.
+     * Get the width of the longest line in pixels.  This is calculated
+     * from the cached line widths each time it is called.
      *
      * @return The width of the longest line.
      */
 
-    inline const uint8_t getPixelWidth(void) const
-    {
-      return m_textPixelWidth;
-    }
+    const nxgl_coord_t getPixelWidth(void) const;
 
     /**
      * Get the pixel spacing between each line of text.
@@ -326,7 +365,7 @@ namespace NXWidgets
 
     inline const int getLineCount(void) const
     {
-      return m_linePositions.size() - 1;
+      return m_linePositions.size() - m_firstLine - 1;
     }
 
     /**
@@ -338,7 +377,8 @@ namespace NXWidgets
     CNxFont *getFont(void) const;
 
     /**
-     * Removes lines of text from the start of the text buffer.
+     * Removes lines of text from the start of the text buffer.  The
+     * remaining lines are not re-wrapped.
      *
      * @param lines Number of lines to remove
      */
@@ -381,7 +421,7 @@ namespace NXWidgets
 
     const int getLineStartIndex(const int line) const
     {
-      return m_linePositions[line];
+      return m_linePositions[m_firstLine + line] - m_firstChar;
     }
   };
 }
@@ -51,6 +51,7 @@
 #include "graphics/nxwidgets/nxconfig.hxx"
 #include "graphics/nxwidgets/cgraphicsport.hxx"
 #include "graphics/nxwidgets/cnxwidget.hxx"
+#include "graphics/nxwidgets/chitindex.hxx"
 #include "graphics/nxwidgets/crect.hxx"
 #include "graphics/nxwidgets/cwidgetstyle.hxx"
 #include "graphics/nxwidgets/cwindoweventhandler.hxx"
@@ -179,6 +180,8 @@ namespace NXWidgets
                                                        awaiting deletion. */
     TNxArray<CNxWidget*>        m_widgets;        /**< List of controlled
                                                        widgets. */
+    CHitIndex                   m_hitIndex;       /**< Index of the controlled
+                                                       widgets by position */
     bool                        m_haveGeometry;   /**< True: indicates that we
                                                        have valid geometry data. */
 #ifdef CONFIG_NXWIDGET_EVENTWAIT
@@ -207,6 +210,10 @@ namespace NXWidgets
     uint8_t                     m_controls[CONFIG_NXWIDGETS_CURSORCONTROL_SIZE];
     uint8_t                     m_nCc;            /**< Number of buffered
                                                        cursor controls */
+    struct nxgl_rect_s          m_damage[CONFIG_NXWIDGETS_DAMAGE_NRECTS];
+                                                  /**< Regions awaiting redraw */
+    uint8_t                     m_nDamage;        /**< Number of damaged
+                                                       regions */
     /**
      * The following were picked off from the position callback.
      */
@@ -266,6 +273,17 @@ namespace NXWidgets
 
     const int getWidgetIndex(const CNxWidget *widget) const;
 
+    /**
+     * Merge a region into the damage list.  Regions that are contained in
+     * or that are cheap to combine with an existing region are merged.
+     * When the list is full, the region is merged with the entry whose
+     * bounding box grows the least.
+     *
+     * @param rect The window-relative region to add.
+     */
+
+    void addDamage(FAR const struct nxgl_rect_s *rect);
+
     /**
      * Delete any widgets in the deletion queue.
      */
@@ -436,6 +454,7 @@ namespace NXWidgets
      *   pollMouseEvents(widget)
      *   pollKeyboardEvents()
      *   pollCursorControlEvents()
+     *   redrawDamage()
      *
      * @param widget.  Specific widget to poll.  Use NULL to run the
      *    all widgets in the window.
@@ -444,6 +463,38 @@ namespace NXWidgets
 
     bool pollEvents(CNxWidget *widget = (CNxWidget *)NULL);
 
+    /**
+     * Mark a region of the window as needing to be redrawn.  Nothing is
+     * drawn until redrawDamage() is called (pollEvents() does this after
+     * processing input), so many changes within one frame cost a single,
+     * clipped redraw of the affected area.
+     *
+     * @param rect The window-relative region to redraw.
+     */
+
+    void invalidate(const CRect &rect);
+
+    /**
+     * Redraw every damaged region.  Only the widgets that overlap a region
+     * are redrawn, clipped to that region, and widgets that are completely
+     * hidden by a later widget are skipped.  The damage list is emptied.
+     *
+     * @return True if anything was redrawn.
+     */
+
+    bool redrawDamage(void);
+
+    /**
+     * Test if there are regions waiting to be redrawn.
+     *
+     * @return True if the window has damaged regions.
+     */
+
+    inline const bool hasDamage(void) const
+    {
+      return m_nDamage > 0;
+    }
+
     /**
      * Swaps the depth of the supplied widget.
      * This function presumes that all child widgets are screens.
@@ -463,6 +514,7 @@ namespace NXWidgets
     inline void addControlledWidget(CNxWidget* widget)
     {
       m_widgets.push_back(widget);
+      m_hitIndex.invalidate();
     }
 
     /**
@@ -473,6 +525,17 @@ namespace NXWidgets
 
     void removeControlledWidget(CNxWidget* widget);
 
+    /**
+     * Notify the control that a widget has moved, been resized or changed
+     * parent.  The index used to find the widget under the mouse is rebuilt
+     * at the next click.
+     */
+
+    inline void invalidateHitIndex(void)
+    {
+      m_hitIndex.invalidate();
+    }
+
     /**
      * Get the number of controlled widgets.
      *
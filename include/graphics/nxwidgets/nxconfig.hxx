@@ -127,6 +127,15 @@
  * CONFIG_NXWIDGETS_CURSORCONTROL_SIZE - Size of incoming cursor control
  *   buffer, i.e., the maximum number of cursor controls that can between
  *   entered by NX polling cycles without losing data.  Default: 4
+ * CONFIG_NXWIDGETS_DAMAGE_NRECTS - Maximum number of separate damaged
+ *   rectangles kept per window between redraws.  Default: 8
+ * CONFIG_NXWIDGETS_GLYPHCACHE_SIZE - Number of pre-rendered characters
+ *   cached by each font (1-255).  Default: 32
+ * CONFIG_NXWIDGETS_HITINDEX_MINWIDGETS - Minimum number of widgets in a
+ *   window, or of children in a widget, before clicks are dispatched
+ *   through a spatial index instead of testing every widget.  Default: 16
+ * CONFIG_NXWIDGETS_HITINDEX_GRIDSIZE - Maximum number of cells along each
+ *   side of a spatial index grid (1-255).  Default: 16
  */
 
 /* Prerequisites ************************************************************/
@@ -432,6 +441,35 @@
 #  define CONFIG_NXWIDGETS_CURSORCONTROL_SIZE 4
 #endif
 
+/**
+ * Maximum number of separate damaged rectangles kept per window between
+ * redraws.  Additional damage is merged into the existing rectangles.
+ */
+
+#ifndef CONFIG_NXWIDGETS_DAMAGE_NRECTS
+#  define CONFIG_NXWIDGETS_DAMAGE_NRECTS 8
+#endif
+
+/**
+ * Glyph cache
+ */
+
+#ifndef CONFIG_NXWIDGETS_GLYPHCACHE_SIZE
+#  define CONFIG_NXWIDGETS_GLYPHCACHE_SIZE 32
+#endif
+
+/**
+ * Click dispatch
+ */
+
+#ifndef CONFIG_NXWIDGETS_HITINDEX_MINWIDGETS
+#  define CONFIG_NXWIDGETS_HITINDEX_MINWIDGETS 16
+#endif
+
+#ifndef CONFIG_NXWIDGETS_HITINDEX_GRIDSIZE
+#  define CONFIG_NXWIDGETS_HITINDEX_GRIDSIZE 16
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
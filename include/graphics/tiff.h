@@ -282,6 +282,10 @@ struct tiff_filefmt_s
   uint16_t sbcoffset;      /* Offset to StripByteCount values */
 };
 
+/* Internal state of the strip compressor (see tiff_internal.h) */
+
+struct tiff_compress_s;
+
 /* These type is used to hold information about the TIFF file under
  * construction
  */
@@ -291,11 +295,18 @@ struct tiff_info_s
   /* The first fields are used to pass information to the TIFF file creation
    * logic via tiff_initialize().
    *
-   * Filenames.  Three file names are required.  (1) path to the final
+   * Filenames.  Up to three file names are used.  (1) path to the final
    * output file and (2) two paths to temporary files.  One temporary file
    * (tmpfile1) will be used to hold the strip image data and the other
    * (tmpfile2) will be used to hold strip offset and count information.
    *
+   * If both tmpfile1 and tmpfile2 are NULL, the file is created in a single
+   * pass:  Space for the StripOffsets and StripByteCounts is reserved in
+   * outfile by tiff_initialize() (the number of strips follows from
+   * imgheight and rps) and each strip is written directly to outfile.  No
+   * temporary files are needed and tiff_finalize() does not copy any data.
+   * In this mode, exactly (imgheight + rps - 1) / rps strips must be added.
+   *
    * colorfmt  - Specifies the form of the color data that will be provided
    *             in the strip data.  These are the FB_FMT_* definitions
    *             provided in include/nuttx/video/fb.h.  Only the following values
@@ -310,6 +321,9 @@ struct tiff_info_s
    * rps       - TIFF RowsPerStrip
    * imgwidth  - TIFF ImageWidth, Number of columns in the image
    * imgheight - TIFF ImageLength, Number of rows in the image
+   * compress  - TIFF Compression of the strip data:  TAG_COMP_NONE (or
+   *             zero), TAG_COMP_PACKBITS (CONFIG_TIFF_PACKBITS), or
+   *             TAG_COMP_LZW (CONFIG_TIFF_LZW).
    */
 
   FAR const char *outfile;  /* Full path to the final output file name */
@@ -320,10 +334,12 @@ struct tiff_info_s
   nxgl_coord_t rps;         /* TIFF RowsPerStrip */
   nxgl_coord_t imgwidth;    /* TIFF ImageWidth, Number of columns in the image */
   nxgl_coord_t imgheight;   /* TIFF ImageLength, Number of rows in the image */
+  uint16_t     compress;    /* TIFF Compression, TAG_COMP_* definitions above */
 
   /* The caller must provide an I/O buffer as well.  This I/O buffer will
    * used for color conversions and as the intermediate buffer for copying
-   * files.  The larger the buffer, the better the performance.
+   * files.  The larger the buffer, the better the performance.  When the
+   * strips are compressed, half of the buffer holds compressed output.
    */
 
   FAR uint8_t *iobuffer;    /* IO buffer allocated by the caller */
@@ -347,6 +363,8 @@ struct tiff_info_s
   off_t        outsize;     /* Current size of outfile */
   off_t        tmp1size;    /* Current size of tmpfile1 */
   off_t        tmp2size;    /* Current size of tmpfile2 */
+  nxgl_coord_t maxstrips;   /* Number of strips reserved (single pass only) */
+  FAR struct tiff_compress_s *comp; /* Compressor state (if compressed) */
 
   /* Points to an internal constant structure of file offsets */
 
@@ -53,6 +53,32 @@
 /****************************************************************************
  * Public Type Declarations
  ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+/* Read-ahead statistics for the current (or last) playback.  Waits are
+ * only counted once the audio device has been started; waiting while the
+ * pipeline is first filled is not an underrun.
+ */
+
+struct nxplayer_stats_s
+{
+  uint32_t    nbytes;         /* Bytes read from the media file */
+  uint32_t    underruns;      /* Buffers that had to wait for file data */
+  uint32_t    waitmax;        /* Longest of those waits (msec) */
+  uint32_t    waittotal;      /* Total time spent waiting (msec) */
+  uint32_t    readmax;        /* Longest single read of the file (msec) */
+  uint32_t    minfill;        /* Lowest read-ahead fill level (bytes) */
+  uint32_t    bufsize;        /* Size of the read-ahead buffer (bytes) */
+};
+#endif
+
+#ifdef CONFIG_NXPLAYER_MIXER
+/* A software mixer owning an audio device (see nxplayer_mixer_create()) */
+
+struct nxplayer_mixer_s;
+struct nxplayer_stream_s;
+#endif
+
 /* This structure describes the internal state of the NxPlayer */
 
 struct nxplayer_s
@@ -86,6 +112,23 @@ struct nxplayer_s
   uint16_t    treble;         /* Treble as a whole % */
   uint16_t    bass;           /* Bass as a whole % */
 #endif
+#ifdef CONFIG_NXPLAYER_MIXER
+  FAR struct nxplayer_mixer_s  *mixer;  /* Mixer to play through, if any */
+  FAR struct nxplayer_stream_s *stream; /* Our stream on the mixer */
+#endif
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  pthread_t   readId;         /* Thread ID of the read-ahead thread */
+  pthread_mutex_t rdlock;     /* Protects the read-ahead ring */
+  pthread_cond_t  rdcond;     /* Signals data or space in the ring */
+  FAR uint8_t *rdbuf;         /* Read-ahead ring (NULL if not active) */
+  size_t      rdsize;         /* Size of the ring */
+  size_t      rdhead;         /* Write index (read-ahead thread) */
+  size_t      rdtail;         /* Read index (playthread) */
+  size_t      rdcount;        /* Number of bytes in the ring */
+  bool        rdeof;          /* End of file reached by read-ahead */
+  bool        rdstop;         /* Request read-ahead thread to exit */
+  struct nxplayer_stats_s stats; /* Read-ahead statistics */
+#endif
 };
 
 typedef int (*nxplayer_func)(FAR struct nxplayer_s *pPlayer, char *pargs);
@@ -493,6 +536,96 @@ int nxplayer_settreble(FAR struct nxplayer_s *pPlayer, uint8_t treble);
 int nxplayer_systemreset(FAR struct nxplayer_s *pPlayer);
 #endif
 
+/****************************************************************************
+ * Name: nxplayer_mixer_create
+ *
+ *   Opens the audio device at devpath, configures it for 16-bit stereo PCM
+ *   at samprate and starts a mixer thread that feeds it.  Players attached
+ *   to the mixer with nxplayer_setmixer() do not open a device of their
+ *   own: their PCM files (raw or WAV) are resampled to samprate, scaled by
+ *   the player's volume and balance and summed into the mixer output.  The
+ *   device plays silence while no stream is active.
+ *
+ * Input Parameters:
+ *   devpath   - Path of the audio device, e.g. "/dev/audio/pcm0"
+ *   samprate  - Output sample rate in Hz
+ *
+ * Returned Value:
+ *   The mixer or NULL on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_MIXER
+FAR struct nxplayer_mixer_s *nxplayer_mixer_create(FAR const char *devpath,
+                                                   uint32_t samprate);
+
+/****************************************************************************
+ * Name: nxplayer_mixer_destroy
+ *
+ *   Stops the mixer, ends all of its streams and closes the device.
+ *   Players must be detached (or no longer used) afterwards.
+ *
+ ****************************************************************************/
+
+void nxplayer_mixer_destroy(FAR struct nxplayer_mixer_s *mixer);
+
+/****************************************************************************
+ * Name: nxplayer_setmixer
+ *
+ *   Attaches the player to a mixer, or detaches it if mixer is NULL.
+ *
+ * Returned Value:
+ *   OK or -EBUSY if the player is not idle.
+ *
+ ****************************************************************************/
+
+int nxplayer_setmixer(FAR struct nxplayer_s *pPlayer,
+                      FAR struct nxplayer_mixer_s *mixer);
+
+/****************************************************************************
+ * Name: nxplayer_mixer_bench
+ *
+ *   Measures the time the mixer needs to produce one second of output at
+ *   outrate from a single stream of the given input format.  The input is
+ *   a generated signal, so no file system time is included.
+ *
+ * Input Parameters:
+ *   outrate   - Output sample rate in Hz
+ *   inrate    - Stream sample rate in Hz
+ *   nchannels - Stream channels (1 or 2)
+ *   bpsamp    - Stream bits per sample (8 or 16)
+ *   usec      - Returned time in microseconds
+ *
+ * Returned Value:
+ *   OK or a negated errno value.
+ *
+ ****************************************************************************/
+
+int nxplayer_mixer_bench(uint32_t outrate, uint32_t inrate,
+                         uint8_t nchannels, uint8_t bpsamp,
+                         FAR uint32_t *usec);
+#endif
+
+/****************************************************************************
+ * Name: nxplayer_getstats
+ *
+ *   Returns the read-ahead statistics of the current playback or, if the
+ *   player is idle, of the last one.
+ *
+ * Input Parameters:
+ *   pPlayer   - Pointer to the context
+ *   stats     - Location to return the statistics
+ *
+ * Returned Value:
+ *   OK
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+int nxplayer_getstats(FAR struct nxplayer_s *pPlayer,
+                      FAR struct nxplayer_stats_s *stats);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
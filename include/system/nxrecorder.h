@@ -50,6 +50,28 @@
  * Public Type Declarations
  ****************************************************************************/
 
+/* Recording file formats */
+
+#define NXRECORDER_FMT_RAW        0   /* Raw PCM data, no header */
+#define NXRECORDER_FMT_WAV        1   /* PCM in a RIFF/WAVE file */
+#define NXRECORDER_FMT_ADPCM      2   /* IMA ADPCM in a RIFF/WAVE file */
+
+#ifdef CONFIG_NXRECORDER_WRITER
+/* Writer statistics for the current (or last) recording */
+
+struct nxrecorder_stats_s
+{
+  uint32_t    nbytes;         /* Bytes captured from the audio device */
+  uint32_t    nwritten;       /* Bytes written to the file */
+  uint32_t    dropped;        /* Buffers dropped because the ring was full */
+  uint32_t    nwrites;        /* Number of writes to the file */
+  uint32_t    writemax;       /* Longest single write (msec) */
+  uint32_t    writetotal;     /* Total time spent writing (msec) */
+  uint32_t    maxfill;        /* Highest ring fill level (bytes) */
+  uint32_t    bufsize;        /* Size of the ring (bytes) */
+};
+#endif
+
 /* This structure describes the internal state of the NxRecorder */
 
 struct nxrecorder_s
@@ -65,6 +87,33 @@ struct nxrecorder_s
   char        device[CONFIG_NAME_MAX]; /* Preferred audio device */
 #ifdef CONFIG_AUDIO_MULTI_SESSION
   FAR void    *session;       /* Session assigment from device */
+#endif
+  uint8_t     format;         /* File format, NXRECORDER_FMT_* */
+  uint8_t     nchannels;      /* Number of channels recorded */
+  uint8_t     bpsamp;         /* Bits per sample recorded */
+  uint32_t    samprate;       /* Sample rate recorded */
+  uint32_t    ndata;          /* Bytes in the data chunk of the file */
+#ifdef CONFIG_NXRECORDER_WRITER
+  pthread_t   writeId;        /* Thread ID of the writer thread */
+  sem_t       wrsem;          /* Wakes the writer thread */
+  FAR uint8_t *wrbuf;         /* Capture ring (NULL if not active) */
+  size_t      wrsize;         /* Size of the ring */
+  volatile size_t wrhead;     /* Write index (record thread only) */
+  volatile size_t wrtail;     /* Read index (writer thread only) */
+  volatile bool wrstop;       /* Request writer thread to flush and exit */
+  FAR uint8_t *wrout;         /* Staging buffer for file writes */
+  size_t      wrfill;         /* Bytes in the staging buffer */
+  size_t      wrlimit;        /* Staging size for the next write */
+  struct nxrecorder_stats_s stats; /* Writer statistics */
+#endif
+#ifdef CONFIG_NXRECORDER_ADPCM
+  FAR int16_t *adin;          /* One block of PCM input to encode */
+  FAR uint8_t *adout;         /* One encoded block */
+  uint16_t    adblock;        /* Encoded block size (bytes) */
+  uint16_t    adframes;       /* Frames per encoded block */
+  uint16_t    adfill;         /* Frames in adin */
+  uint8_t     adindex[2];     /* Step index of each channel */
+  uint32_t    nframes;        /* Frames encoded (for the fact chunk) */
 #endif
 };
 
@@ -188,6 +237,52 @@ int nxrecorder_recordraw(FAR struct nxrecorder_s *pRecorder,
                          FAR const char *filename, uint8_t nchannels,
                          uint8_t bpsamp, uint32_t samprate);
 
+/****************************************************************************
+ * Name: nxrecorder_recordwav
+ *
+ *   Records PCM data into a RIFF/WAVE file.  The header is written with the
+ *   sizes left zero and completed when the recording ends.
+ *
+ * Input Parameters:
+ *   pRecorder - Pointer to the context to initialize
+ *   filename  - Pointer to pathname of the file to record
+ *   nchannels - channels num
+ *   bpsamp    - bit width
+ *   samprate  - sample rate
+ *
+ * Returned Value:
+ *   OK if file created, device found, and recording started.
+ *
+ ****************************************************************************/
+
+int nxrecorder_recordwav(FAR struct nxrecorder_s *pRecorder,
+                         FAR const char *filename, uint8_t nchannels,
+                         uint8_t bpsamp, uint32_t samprate);
+
+/****************************************************************************
+ * Name: nxrecorder_recordadpcm
+ *
+ *   Records 16-bit PCM data from the device and stores it IMA ADPCM
+ *   encoded (4 bits per sample) in a RIFF/WAVE file.  Encoding is done by
+ *   the writer thread.
+ *
+ * Input Parameters:
+ *   pRecorder - Pointer to the context to initialize
+ *   filename  - Pointer to pathname of the file to record
+ *   nchannels - channels num (1 or 2)
+ *   samprate  - sample rate
+ *
+ * Returned Value:
+ *   OK if file created, device found, and recording started.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_ADPCM
+int nxrecorder_recordadpcm(FAR struct nxrecorder_s *pRecorder,
+                           FAR const char *filename, uint8_t nchannels,
+                           uint32_t samprate);
+#endif
+
 /****************************************************************************
  * Name: nxrecorder_stop
  *
@@ -239,6 +334,26 @@ int nxrecorder_pause(FAR struct nxrecorder_s *pRecorder);
 int nxrecorder_resume(FAR struct nxrecorder_s *pRecorder);
 #endif
 
+/****************************************************************************
+ * Name: nxrecorder_getstats
+ *
+ *   Returns the writer statistics of the current recording or, if the
+ *   recorder is idle, of the last one.
+ *
+ * Input Parameters:
+ *   pRecorder - Pointer to the context
+ *   stats     - Location to return the statistics
+ *
+ * Returned Value:
+ *   OK
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_WRITER
+int nxrecorder_getstats(FAR struct nxrecorder_s *pRecorder,
+                        FAR struct nxrecorder_stats_s *stats);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
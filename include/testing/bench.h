@@ -0,0 +1,236 @@
+/****************************************************************************
+ * apps/include/testing/bench.h
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_INCLUDE_TESTING_BENCH_H
+#define __APPS_INCLUDE_TESTING_BENCH_H 1
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <time.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* These helpers are shared by the benchmark examples and are also built
+ * into the host side of some of them, so nothing here may depend on NuttX.
+ */
+
+#ifndef FAR
+#  define FAR
+#endif
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define BENCH_CLOCK CLOCK_MONOTONIC
+#else
+#  define BENCH_CLOCK CLOCK_REALTIME
+#endif
+
+/* Latencies are kept in a log-linear histogram: exact below 16 usec, then
+ * eight buckets per power of two.  Percentiles are therefore accurate to
+ * within 12.5% while the histogram stays a fixed 1KiB.
+ */
+
+#define BENCH_LINEAR     16
+#define BENCH_SUBBITS    3
+#define BENCH_NBUCKETS   (BENCH_LINEAR + (32 - 4) * (1 << BENCH_SUBBITS))
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+struct bench_hist_s
+{
+  uint32_t count[BENCH_NBUCKETS];
+  uint32_t max;                 /* Slowest operation (usec) */
+  uint32_t nops;                /* Operations recorded */
+};
+
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: bench_usec
+ *
+ * Description:
+ *   Return a free running time in microseconds.
+ *
+ ****************************************************************************/
+
+static inline uint64_t bench_usec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(BENCH_CLOCK, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: bench_hist_bucket and bench_hist_bucketmax
+ *
+ * Description:
+ *   Map a latency to its histogram bucket and a bucket to the largest
+ *   latency that it holds.
+ *
+ ****************************************************************************/
+
+static inline int bench_hist_bucket(uint32_t usec)
+{
+  int msb;
+
+  if (usec < BENCH_LINEAR)
+    {
+      return usec;
+    }
+
+  msb = 4;
+  while (msb < 31 && (usec >> (msb + 1)) != 0)
+    {
+      msb++;
+    }
+
+  return BENCH_LINEAR + ((msb - 4) << BENCH_SUBBITS) +
+         ((usec >> (msb - BENCH_SUBBITS)) & ((1 << BENCH_SUBBITS) - 1));
+}
+
+static inline uint32_t bench_hist_bucketmax(int bucket)
+{
+  uint32_t sub;
+  int msb;
+
+  if (bucket < BENCH_LINEAR)
+    {
+      return bucket;
+    }
+
+  msb = ((bucket - BENCH_LINEAR) >> BENCH_SUBBITS) + 4;
+  sub = (bucket - BENCH_LINEAR) & ((1 << BENCH_SUBBITS) - 1);
+
+  /* Unsigned, as the top buckets reach 2^32 - 1 */
+
+  return ((((uint32_t)1 << BENCH_SUBBITS) + sub + 1) <<
+          (msb - BENCH_SUBBITS)) - 1;
+}
+
+/****************************************************************************
+ * Name: bench_hist_record
+ *
+ * Description:
+ *   Record the latency of one operation that started at 'start', a time
+ *   from bench_usec().
+ *
+ ****************************************************************************/
+
+static inline void bench_hist_record(FAR struct bench_hist_s *hist,
+                                     uint64_t start)
+{
+  uint64_t elapsed = bench_usec() - start;
+  uint32_t usec = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+
+  hist->count[bench_hist_bucket(usec)]++;
+  hist->nops++;
+
+  if (usec > hist->max)
+    {
+      hist->max = usec;
+    }
+}
+
+/****************************************************************************
+ * Name: bench_hist_merge
+ *
+ * Description:
+ *   Add the operations recorded in 'src' to 'dest'.
+ *
+ ****************************************************************************/
+
+static inline void bench_hist_merge(FAR struct bench_hist_s *dest,
+                                    FAR const struct bench_hist_s *src)
+{
+  int bucket;
+
+  for (bucket = 0; bucket < BENCH_NBUCKETS; bucket++)
+    {
+      dest->count[bucket] += src->count[bucket];
+    }
+
+  dest->nops += src->nops;
+  if (src->max > dest->max)
+    {
+      dest->max = src->max;
+    }
+}
+
+/****************************************************************************
+ * Name: bench_hist_percentile
+ *
+ * Description:
+ *   Return the latency (usec) below which 'permille'/1000 of the
+ *   operations fall.
+ *
+ ****************************************************************************/
+
+static inline uint32_t
+bench_hist_percentile(FAR const struct bench_hist_s *hist, uint32_t permille)
+{
+  uint64_t target;
+  uint64_t seen;
+  uint32_t value;
+  int bucket;
+
+  if (hist->nops == 0)
+    {
+      return 0;
+    }
+
+  target = ((uint64_t)hist->nops * permille + 999) / 1000;
+  for (bucket = 0, seen = 0; bucket < BENCH_NBUCKETS; bucket++)
+    {
+      seen += hist->count[bucket];
+      if (seen >= target)
+        {
+          break;
+        }
+    }
+
+  value = bench_hist_bucketmax(bucket);
+  return value < hist->max ? value : hist->max;
+}
+
+#endif /* __APPS_INCLUDE_TESTING_BENCH_H */
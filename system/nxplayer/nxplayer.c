@@ -65,34 +65,41 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <dirent.h>
+#include <pthread.h>
+#include <time.h>
 #include <debug.h>
 
 #include <netutils/netlib.h>
 #include <nuttx/audio/audio.h>
 #include "system/nxplayer.h"
 
+#include "nxplayer_priv.h"
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
-#define NXPLAYER_STATE_IDLE      0
-#define NXPLAYER_STATE_PLAYING   1
-#define NXPLAYER_STATE_PAUSED    2
-
-#ifndef CONFIG_AUDIO_NUM_BUFFERS
-#  define CONFIG_AUDIO_NUM_BUFFERS  2
-#endif
-
-#ifndef CONFIG_AUDIO_BUFFER_NUMBYTES
-#  define CONFIG_AUDIO_BUFFER_NUMBYTES  8192
-#endif
-
-#ifndef CONFIG_NXPLAYER_MSG_PRIO
-#  define CONFIG_NXPLAYER_MSG_PRIO  1
-#endif
-
-#ifndef CONFIG_NXPLAYER_PLAYTHREAD_STACKSIZE
-#  define CONFIG_NXPLAYER_PLAYTHREAD_STACKSIZE    1500
+#ifdef CONFIG_NXPLAYER_MIXER
+#  define NXPLAYER_MIXED(p)  ((p)->mixer != NULL)
+#else
+#  define NXPLAYER_MIXED(p)  false
+#endif
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+#  ifndef CONFIG_NXPLAYER_READAHEAD_BUFSIZE
+#    define CONFIG_NXPLAYER_READAHEAD_BUFSIZE     98304
+#  endif
+#  ifndef CONFIG_NXPLAYER_READAHEAD_READSIZE
+#    define CONFIG_NXPLAYER_READAHEAD_READSIZE    4096
+#  endif
+#  ifndef CONFIG_NXPLAYER_READAHEAD_STACKSIZE
+#    define CONFIG_NXPLAYER_READAHEAD_STACKSIZE   1024
+#  endif
+#  ifdef CONFIG_CLOCK_MONOTONIC
+#    define NXPLAYER_CLOCK                        CLOCK_MONOTONIC
+#  else
+#    define NXPLAYER_CLOCK                        CLOCK_REALTIME
+#  endif
 #endif
 
 /****************************************************************************
@@ -615,6 +622,329 @@ static int nxplayer_mediasearch(FAR struct nxplayer_s *pPlayer,
 }
 #endif
 
+/****************************************************************************
+ * Name: nxplayer_msec
+ *
+ *  Return a free running time in milliseconds for the statistics.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+static uint32_t nxplayer_msec(void)
+{
+  struct timespec ts;
+
+  (void)clock_gettime(NXPLAYER_CLOCK, &ts);
+  return (uint32_t)ts.tv_sec * 1000 + (uint32_t)ts.tv_nsec / 1000000;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxplayer_readthread
+ *
+ *  The read-ahead thread.  It keeps the read-ahead ring filled from the
+ *  media file so that a slow read (an SD card busy with a write, a
+ *  network stall, ...) is absorbed by the ring rather than starving the
+ *  audio device.  Reads are done in chunks of
+ *  CONFIG_NXPLAYER_READAHEAD_READSIZE without holding the ring lock.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+static void *nxplayer_readthread(pthread_addr_t pvarg)
+{
+  FAR struct nxplayer_s *pPlayer = (FAR struct nxplayer_s *)pvarg;
+  size_t   chunk;
+  size_t   nread;
+  size_t   head;
+  ssize_t  ret;
+  uint32_t start;
+  uint32_t elapsed;
+
+  chunk = CONFIG_NXPLAYER_READAHEAD_READSIZE;
+  if (chunk > pPlayer->rdsize)
+    {
+      chunk = pPlayer->rdsize;
+    }
+
+  pthread_mutex_lock(&pPlayer->rdlock);
+  while (!pPlayer->rdstop)
+    {
+      /* Wait until there is room for a full chunk */
+
+      nread = pPlayer->rdsize - pPlayer->rdcount;
+      if (nread < chunk)
+        {
+          pthread_cond_wait(&pPlayer->rdcond, &pPlayer->rdlock);
+          continue;
+        }
+
+      /* Read no further than the end of the ring */
+
+      head = pPlayer->rdhead;
+      if (nread > pPlayer->rdsize - head)
+        {
+          nread = pPlayer->rdsize - head;
+        }
+
+      if (nread > chunk)
+        {
+          nread = chunk;
+        }
+
+      /* Only this thread writes at the head, so the ring can be filled
+       * without holding the lock.
+       */
+
+      pthread_mutex_unlock(&pPlayer->rdlock);
+
+      start = nxplayer_msec();
+      ret   = read(pPlayer->fd, &pPlayer->rdbuf[head], nread);
+      elapsed = nxplayer_msec() - start;
+
+      pthread_mutex_lock(&pPlayer->rdlock);
+
+      if (elapsed > pPlayer->stats.readmax)
+        {
+          pPlayer->stats.readmax = elapsed;
+        }
+
+      if (ret <= 0)
+        {
+          if (ret < 0)
+            {
+              int errcode = errno;
+
+              if (errcode == EINTR)
+                {
+                  continue;
+                }
+
+              auderr("ERROR: read failed: %d\n", errcode);
+            }
+
+          /* End of file or read error.  The playthread sends whatever is
+           * left in the ring and then finishes the stream.
+           */
+
+          pPlayer->rdeof = true;
+          pthread_cond_broadcast(&pPlayer->rdcond);
+          break;
+        }
+
+      head += ret;
+      if (head >= pPlayer->rdsize)
+        {
+          head = 0;
+        }
+
+      pPlayer->rdhead        = head;
+      pPlayer->rdcount      += ret;
+      pPlayer->stats.nbytes += ret;
+      pthread_cond_broadcast(&pPlayer->rdcond);
+    }
+
+  pthread_mutex_unlock(&pPlayer->rdlock);
+  return NULL;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxplayer_startreadahead
+ *
+ *  Allocate the read-ahead ring and start the read-ahead thread.  If that
+ *  is not possible, the playthread falls back to reading the file
+ *  directly.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+static int nxplayer_startreadahead(FAR struct nxplayer_s *pPlayer)
+{
+  struct sched_param  sparam;
+  pthread_attr_t      tattr;
+  int                 ret;
+
+  pthread_mutex_lock(&pPlayer->rdlock);
+  memset(&pPlayer->stats, 0, sizeof(struct nxplayer_stats_s));
+  pthread_mutex_unlock(&pPlayer->rdlock);
+
+  pPlayer->rdbuf = (FAR uint8_t *)malloc(CONFIG_NXPLAYER_READAHEAD_BUFSIZE);
+  if (pPlayer->rdbuf == NULL)
+    {
+      auderr("ERROR: Failed to allocate the read-ahead buffer\n");
+      return -ENOMEM;
+    }
+
+  pPlayer->rdsize          = CONFIG_NXPLAYER_READAHEAD_BUFSIZE;
+  pPlayer->rdhead          = 0;
+  pPlayer->rdtail          = 0;
+  pPlayer->rdcount         = 0;
+  pPlayer->rdeof           = false;
+  pPlayer->rdstop          = false;
+  pPlayer->stats.bufsize   = CONFIG_NXPLAYER_READAHEAD_BUFSIZE;
+  pPlayer->stats.minfill   = CONFIG_NXPLAYER_READAHEAD_BUFSIZE;
+
+  /* Run just below the playthread so that refilling the ring never delays
+   * the servicing of the audio device.
+   */
+
+  pthread_attr_init(&tattr);
+  sparam.sched_priority = sched_get_priority_max(SCHED_FIFO) - 10;
+  (void)pthread_attr_setschedparam(&tattr, &sparam);
+  (void)pthread_attr_setstacksize(&tattr,
+                                  CONFIG_NXPLAYER_READAHEAD_STACKSIZE);
+
+  ret = pthread_create(&pPlayer->readId, &tattr, nxplayer_readthread,
+                       (pthread_addr_t)pPlayer);
+  if (ret != OK)
+    {
+      auderr("ERROR: Failed to create readthread: %d\n", ret);
+      free(pPlayer->rdbuf);
+      pPlayer->rdbuf = NULL;
+      return -ret;
+    }
+
+  pthread_setname_np(pPlayer->readId, "readthread");
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxplayer_stopreadahead
+ *
+ *  Stop the read-ahead thread, if running, and free the ring.  This must
+ *  be done before the media file is closed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+static void nxplayer_stopreadahead(FAR struct nxplayer_s *pPlayer)
+{
+  FAR void *value;
+
+  if (pPlayer->rdbuf == NULL)
+    {
+      return;
+    }
+
+  pthread_mutex_lock(&pPlayer->rdlock);
+  pPlayer->rdstop = true;
+  pthread_cond_broadcast(&pPlayer->rdcond);
+  pthread_mutex_unlock(&pPlayer->rdlock);
+
+  pthread_join(pPlayer->readId, &value);
+
+  free(pPlayer->rdbuf);
+  pPlayer->rdbuf = NULL;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxplayer_closefile
+ *
+ *  Close the media file, stopping the read-ahead thread first.
+ *
+ ****************************************************************************/
+
+static void nxplayer_closefile(FAR struct nxplayer_s *pPlayer)
+{
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  nxplayer_stopreadahead(pPlayer);
+#endif
+
+  close(pPlayer->fd);
+  pPlayer->fd = -1;
+}
+
+/****************************************************************************
+ * Name: nxplayer_readahead
+ *
+ *  Take the next block of data for the audio buffer from the read-ahead
+ *  ring, waiting for the read-ahead thread if needed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+static void nxplayer_readahead(FAR struct nxplayer_s *pPlayer,
+                               FAR struct ap_buffer_s *apb)
+{
+  size_t   nbytes;
+  size_t   ncopy;
+  uint32_t start;
+  uint32_t elapsed;
+  bool     playing;
+
+  /* Waiting before the device has been started just fills the pipeline.
+   * Once playing, every wait eats into the data already queued in the
+   * device and is counted as an underrun.
+   */
+
+  playing = (pPlayer->state != NXPLAYER_STATE_IDLE);
+
+  pthread_mutex_lock(&pPlayer->rdlock);
+  if (pPlayer->rdcount < apb->nmaxbytes && !pPlayer->rdeof)
+    {
+      start = nxplayer_msec();
+
+      do
+        {
+          pthread_cond_wait(&pPlayer->rdcond, &pPlayer->rdlock);
+        }
+      while (pPlayer->rdcount < apb->nmaxbytes && !pPlayer->rdeof);
+
+      if (playing)
+        {
+          elapsed = nxplayer_msec() - start;
+
+          pPlayer->stats.underruns++;
+          pPlayer->stats.waittotal += elapsed;
+          if (elapsed > pPlayer->stats.waitmax)
+            {
+              pPlayer->stats.waitmax = elapsed;
+            }
+        }
+    }
+
+  /* Copy out of the ring, which may take two pieces if it wraps */
+
+  nbytes = pPlayer->rdcount;
+  if (nbytes > apb->nmaxbytes)
+    {
+      nbytes = apb->nmaxbytes;
+    }
+
+  ncopy = pPlayer->rdsize - pPlayer->rdtail;
+  if (ncopy > nbytes)
+    {
+      ncopy = nbytes;
+    }
+
+  memcpy(apb->samp, &pPlayer->rdbuf[pPlayer->rdtail], ncopy);
+  if (ncopy < nbytes)
+    {
+      memcpy(&apb->samp[ncopy], pPlayer->rdbuf, nbytes - ncopy);
+    }
+
+  pPlayer->rdtail += nbytes;
+  if (pPlayer->rdtail >= pPlayer->rdsize)
+    {
+      pPlayer->rdtail -= pPlayer->rdsize;
+    }
+
+  pPlayer->rdcount -= nbytes;
+  if (playing && pPlayer->rdcount < pPlayer->stats.minfill)
+    {
+      pPlayer->stats.minfill = pPlayer->rdcount;
+    }
+
+  pthread_cond_broadcast(&pPlayer->rdcond);
+  pthread_mutex_unlock(&pPlayer->rdlock);
+
+  apb->nbytes = nbytes;
+}
+#endif
+
 /****************************************************************************
  * Name: nxplayer_readbuffer
  *
@@ -642,7 +972,17 @@ static int nxplayer_readbuffer(FAR struct nxplayer_s *pPlayer,
 
   /* Read data into the buffer. */
 
-  apb->nbytes  = read(pPlayer->fd, apb->samp, apb->nmaxbytes);
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  if (pPlayer->rdbuf != NULL)
+    {
+      nxplayer_readahead(pPlayer, apb);
+    }
+  else
+#endif
+    {
+      apb->nbytes = read(pPlayer->fd, apb->samp, apb->nmaxbytes);
+    }
+
   apb->curbyte = 0;
   apb->flags   = 0;
 
@@ -676,8 +1016,7 @@ static int nxplayer_readbuffer(FAR struct nxplayer_s *pPlayer,
        * event.
        */
 
-      close(pPlayer->fd);
-      pPlayer->fd = -1;
+      nxplayer_closefile(pPlayer);
 
       /* Set a flag to indicate that this is the final buffer in the stream */
 
@@ -790,6 +1129,12 @@ static void *nxplayer_playthread(pthread_addr_t pvarg)
 
   audinfo("Entry\n");
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  /* Start reading ahead while the audio buffers are allocated */
+
+  (void)nxplayer_startreadahead(pPlayer);
+#endif
+
   /* Query the audio device for it's preferred buffer size / qty */
 
 #ifdef CONFIG_AUDIO_DRIVER_SPECIFIC_BUFFERS
@@ -908,8 +1253,7 @@ static void *nxplayer_playthread(pthread_addr_t pvarg)
                * file so that no further data is read.
                */
 
-              close(pPlayer->fd);
-              pPlayer->fd = -1;
+              nxplayer_closefile(pPlayer);
 
               /* We are no longer streaming data from the file.  Be we will
                * need to wait for any outstanding buffers to be recovered.  We
@@ -1067,8 +1411,7 @@ static void *nxplayer_playthread(pthread_addr_t pvarg)
                          * Close the file so that no further data is read.
                          */
 
-                        close(pPlayer->fd);
-                        pPlayer->fd = -1;
+                        nxplayer_closefile(pPlayer);
 
                         /* Stop streaming and wait for buffers to be
                          * returned and to receive the AUDIO_MSG_COMPLETE
@@ -1182,6 +1525,10 @@ err_out:
 
   /* Cleanup */
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  nxplayer_stopreadahead(pPlayer);
+#endif
+
   while (sem_wait(&pPlayer->sem) < 0)
     ;
 
@@ -1241,7 +1588,7 @@ int nxplayer_setvolume(FAR struct nxplayer_s *pPlayer, uint16_t volume)
    * be applied before the next playback begins.
    */
 
-  if (pPlayer->state == NXPLAYER_STATE_PLAYING)
+  if (pPlayer->state == NXPLAYER_STATE_PLAYING && !NXPLAYER_MIXED(pPlayer))
     {
       /* Send a CONFIGURE ioctl to the device to set the volume */
 
@@ -1328,7 +1675,7 @@ int nxplayer_setbass(FAR struct nxplayer_s *pPlayer, uint8_t level)
    * be applied before the next playback begins.
    */
 
-  if (pPlayer->state == NXPLAYER_STATE_PLAYING)
+  if (pPlayer->state == NXPLAYER_STATE_PLAYING && !NXPLAYER_MIXED(pPlayer))
     {
       /* Send a CONFIGURE ioctl to the device to set the volume */
 
@@ -1380,7 +1727,7 @@ int nxplayer_settreble(FAR struct nxplayer_s *pPlayer, uint8_t level)
    * be applied before the next playback begins.
    */
 
-  if (pPlayer->state == NXPLAYER_STATE_PLAYING)
+  if (pPlayer->state == NXPLAYER_STATE_PLAYING && !NXPLAYER_MIXED(pPlayer))
     {
       /* Send a CONFIGURE ioctl to the device to set the volume */
 
@@ -1427,7 +1774,7 @@ int nxplayer_setbalance(FAR struct nxplayer_s *pPlayer, uint16_t balance)
    * be applied before the next playback begins.
    */
 
-  if (pPlayer->state == NXPLAYER_STATE_PLAYING)
+  if (pPlayer->state == NXPLAYER_STATE_PLAYING && !NXPLAYER_MIXED(pPlayer))
     {
       /* Send a CONFIGURE ioctl to the device to set the volume */
 
@@ -1463,7 +1810,13 @@ int nxplayer_pause(FAR struct nxplayer_s *pPlayer)
 {
   int   ret = OK;
 
-  if (pPlayer->state == NXPLAYER_STATE_PLAYING)
+  if (pPlayer->state == NXPLAYER_STATE_PLAYING && NXPLAYER_MIXED(pPlayer))
+    {
+      /* The mixer skips paused streams */
+
+      pPlayer->state = NXPLAYER_STATE_PAUSED;
+    }
+  else if (pPlayer->state == NXPLAYER_STATE_PLAYING)
     {
 #ifdef CONFIG_AUDIO_MULTI_SESSION
       ret = ioctl(pPlayer->devFd, AUDIOIOC_PAUSE,
@@ -1493,7 +1846,11 @@ int nxplayer_resume(FAR struct nxplayer_s *pPlayer)
 {
   int ret = OK;
 
-  if (pPlayer->state == NXPLAYER_STATE_PAUSED)
+  if (pPlayer->state == NXPLAYER_STATE_PAUSED && NXPLAYER_MIXED(pPlayer))
+    {
+      pPlayer->state = NXPLAYER_STATE_PLAYING;
+    }
+  else if (pPlayer->state == NXPLAYER_STATE_PAUSED)
     {
 #ifdef CONFIG_AUDIO_MULTI_SESSION
       ret = ioctl(pPlayer->devFd, AUDIOIOC_RESUME,
@@ -1758,6 +2115,15 @@ int nxplayer_stop(FAR struct nxplayer_s *pPlayer)
 
   sem_post(&pPlayer->sem);
 
+#ifdef CONFIG_NXPLAYER_MIXER
+  /* Streams on a mixer have no playthread of their own */
+
+  if (pPlayer->mixer != NULL)
+    {
+      return nxplayer_mixer_stop(pPlayer);
+    }
+#endif
+
   /* Notify the playback thread that it needs to cancel the playback */
 
   term_msg.msgId = AUDIO_MSG_STOP;
@@ -1901,6 +2267,25 @@ static int nxplayer_playinternal(FAR struct nxplayer_s *pPlayer,
       subfmt = tmpsubfmt;
     }
 
+#ifdef CONFIG_NXPLAYER_MIXER
+  /* If the player is attached to a mixer, the mixer plays the file on its
+   * own device.
+   */
+
+  if (pPlayer->mixer != NULL)
+    {
+      ret = nxplayer_mixer_addstream(pPlayer, filefmt, nchannels, bpsamp,
+                                     samprate);
+      if (ret < 0)
+        {
+          auderr("ERROR: nxplayer_mixer_addstream failed: %d\n", ret);
+          goto err_out_nodev;
+        }
+
+      return OK;
+    }
+#endif
+
   /* Try to open the device */
 
   ret = nxplayer_opendevice(pPlayer, filefmt, subfmt);
@@ -2095,6 +2480,39 @@ int nxplayer_playraw(FAR struct nxplayer_s *pPlayer,
                                nchannels, bpsamp, samprate);
 }
 
+/****************************************************************************
+ * Name: nxplayer_setmixer
+ *
+ *   nxplayer_setmixer() attaches the player to a software mixer (or
+ *   detaches it if mixer is NULL).  The player must be idle.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_MIXER
+int nxplayer_setmixer(FAR struct nxplayer_s *pPlayer,
+                      FAR struct nxplayer_mixer_s *mixer)
+{
+  int ret = OK;
+
+  DEBUGASSERT(pPlayer != NULL);
+
+  while (sem_wait(&pPlayer->sem) < 0)
+    ;
+
+  if (pPlayer->state != NXPLAYER_STATE_IDLE)
+    {
+      ret = -EBUSY;
+    }
+  else
+    {
+      pPlayer->mixer = mixer;
+    }
+
+  sem_post(&pPlayer->sem);
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name: nxplayer_setmediadir
  *
@@ -2150,6 +2568,18 @@ FAR struct nxplayer_s *nxplayer_create(void)
   pPlayer->playId = 0;
   pPlayer->crefs = 1;
 
+#ifdef CONFIG_NXPLAYER_MIXER
+  pPlayer->mixer = NULL;
+  pPlayer->stream = NULL;
+#endif
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  pPlayer->rdbuf = NULL;
+  memset(&pPlayer->stats, 0, sizeof(struct nxplayer_stats_s));
+  pthread_mutex_init(&pPlayer->rdlock, NULL);
+  pthread_cond_init(&pPlayer->rdcond, NULL);
+#endif
+
 #ifndef CONFIG_AUDIO_EXCLUDE_TONE
   pPlayer->bass = 50;
   pPlayer->treble = 50;
@@ -2238,6 +2668,10 @@ void nxplayer_release(FAR struct nxplayer_s *pPlayer)
 
   if (refcount == 1)
     {
+#ifdef CONFIG_NXPLAYER_READAHEAD
+      pthread_cond_destroy(&pPlayer->rdcond);
+      pthread_mutex_destroy(&pPlayer->rdlock);
+#endif
       free(pPlayer);
     }
 }
@@ -2385,3 +2819,25 @@ int nxplayer_systemreset(FAR struct nxplayer_s *pPlayer)
 }
 #endif  /* CONFIG_NXPLAYER_INCLUDE_SYSTEM_RESET */
 
+
+/****************************************************************************
+ * Name: nxplayer_getstats
+ *
+ *   nxplayer_getstats() returns the read-ahead statistics of the current
+ *   or last playback.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+int nxplayer_getstats(FAR struct nxplayer_s *pPlayer,
+                      FAR struct nxplayer_stats_s *stats)
+{
+  DEBUGASSERT(pPlayer != NULL && stats != NULL);
+
+  pthread_mutex_lock(&pPlayer->rdlock);
+  memcpy(stats, &pPlayer->stats, sizeof(struct nxplayer_stats_s));
+  pthread_mutex_unlock(&pPlayer->rdlock);
+
+  return OK;
+}
+#endif
@@ -100,6 +100,16 @@ static int nxplayer_cmd_resume(FAR struct nxplayer_s *pPlayer, char *parg);
 static int nxplayer_cmd_mediadir(FAR struct nxplayer_s *pPlayer, char *parg);
 #endif
 
+#ifdef CONFIG_NXPLAYER_MIXER
+static int nxplayer_cmd_mixer(FAR struct nxplayer_s *pPlayer, char *parg);
+static int nxplayer_cmd_mix(FAR struct nxplayer_s *pPlayer, char *parg);
+static int nxplayer_cmd_mixbench(FAR struct nxplayer_s *pPlayer, char *parg);
+#endif
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+static int nxplayer_cmd_stats(FAR struct nxplayer_s *pPlayer, char *parg);
+#endif
+
 #ifndef CONFIG_AUDIO_EXCLUDE_STOP
 static int nxplayer_cmd_stop(FAR struct nxplayer_s *pPlayer, char *parg);
 #endif
@@ -143,6 +153,11 @@ static struct mp_cmd_s g_nxplayer_cmds[] =
 #endif
 #ifdef CONFIG_NXPLAYER_INCLUDE_MEDIADIR
   { "mediadir", "path",     nxplayer_cmd_mediadir,  NXPLAYER_HELP_TEXT(Change the media directory) },
+#endif
+#ifdef CONFIG_NXPLAYER_MIXER
+  { "mix",      "filename", nxplayer_cmd_mix,       NXPLAYER_HELP_TEXT(Play a PCM file over the current playback) },
+  { "mixbench", "[rate]",   nxplayer_cmd_mixbench,  NXPLAYER_HELP_TEXT(Measure mixer CPU time per stream) },
+  { "mixer",    "devfile [rate]|off", nxplayer_cmd_mixer, NXPLAYER_HELP_TEXT(Play through a software mixer) },
 #endif
   { "play",     "filename", nxplayer_cmd_play,      NXPLAYER_HELP_TEXT(Play a media file) },
   { "playraw",  "filename", nxplayer_cmd_playraw,   NXPLAYER_HELP_TEXT(Play a raw data file) },
@@ -155,6 +170,9 @@ static struct mp_cmd_s g_nxplayer_cmds[] =
 #ifndef CONFIG_AUDIO_EXCLUDE_PAUSE_RESUME
   { "resume",   "",         nxplayer_cmd_resume,    NXPLAYER_HELP_TEXT(Resume playback) },
 #endif
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  { "stats",    "",         nxplayer_cmd_stats,     NXPLAYER_HELP_TEXT(Show read-ahead statistics) },
+#endif
 #ifndef CONFIG_AUDIO_EXCLUDE_STOP
   { "stop",     "",         nxplayer_cmd_stop,      NXPLAYER_HELP_TEXT(Stop playback) },
 #endif
@@ -170,6 +188,10 @@ static struct mp_cmd_s g_nxplayer_cmds[] =
 };
 static const int g_nxplayer_cmd_count = sizeof(g_nxplayer_cmds) / sizeof(struct mp_cmd_s);
 
+#ifdef CONFIG_NXPLAYER_MIXER
+static FAR struct nxplayer_mixer_s *g_mixer;
+#endif
+
 
 /****************************************************************************
  * Private Functions
@@ -449,6 +471,201 @@ static int nxplayer_cmd_mediadir(FAR struct nxplayer_s *pPlayer, char *parg)
 }
 #endif
 
+/****************************************************************************
+ * Name: nxplayer_cmd_mixer
+ *
+ *   nxplayer_cmd_mixer() starts a software mixer on the specified device
+ *   and plays through it, or stops it again with "off".
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_MIXER
+static int nxplayer_cmd_mixer(FAR struct nxplayer_s *pPlayer, char *parg)
+{
+  char devfile[64];
+  int  samprate = 48000;
+  int  ret;
+
+  if (parg == NULL || *parg == '\0')
+    {
+      printf("mixer: %s\n", g_mixer != NULL ? "on" : "off");
+      return OK;
+    }
+
+  if (strcmp(parg, "off") == 0)
+    {
+      if (g_mixer != NULL)
+        {
+#ifndef CONFIG_AUDIO_EXCLUDE_STOP
+          nxplayer_stop(pPlayer);
+#endif
+          nxplayer_setmixer(pPlayer, NULL);
+          nxplayer_mixer_destroy(g_mixer);
+          g_mixer = NULL;
+        }
+
+      return OK;
+    }
+
+  if (g_mixer != NULL)
+    {
+      printf("Mixer already running\n");
+      return -EBUSY;
+    }
+
+  sscanf(parg, "%63s %d", devfile, &samprate);
+
+  g_mixer = nxplayer_mixer_create(devfile, samprate);
+  if (g_mixer == NULL)
+    {
+      printf("Failed to start mixer on %s\n", devfile);
+      return -ENODEV;
+    }
+
+  ret = nxplayer_setmixer(pPlayer, g_mixer);
+  if (ret < 0)
+    {
+      printf("Stop playback first\n");
+      nxplayer_mixer_destroy(g_mixer);
+      g_mixer = NULL;
+    }
+
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxplayer_cmd_mix
+ *
+ *   nxplayer_cmd_mix() plays a PCM file on the mixer with a player of its
+ *   own, so that it is heard on top of the current playback.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_MIXER
+static int nxplayer_cmd_mix(FAR struct nxplayer_s *pPlayer, char *parg)
+{
+  FAR struct nxplayer_s *pMix;
+  int ret;
+
+  if (g_mixer == NULL)
+    {
+      printf("No mixer, use 'mixer devfile' first\n");
+      return -ENODEV;
+    }
+
+  pMix = nxplayer_create();
+  if (pMix == NULL)
+    {
+      printf("Error:  Out of RAM\n");
+      return -ENOMEM;
+    }
+
+#ifdef CONFIG_NXPLAYER_INCLUDE_MEDIADIR
+  nxplayer_setmediadir(pMix, pPlayer->mediadir);
+#endif
+#ifndef CONFIG_AUDIO_EXCLUDE_VOLUME
+  nxplayer_setvolume(pMix, pPlayer->volume);
+#endif
+
+  nxplayer_setmixer(pMix, g_mixer);
+  ret = nxplayer_playfile(pMix, parg, AUDIO_FMT_UNDEF, AUDIO_FMT_UNDEF);
+  if (ret < 0)
+    {
+      printf("Error mixing file: %d\n", -ret);
+    }
+
+  /* The mixer holds its own reference until the file has been played */
+
+  nxplayer_release(pMix);
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxplayer_cmd_mixbench
+ *
+ *   nxplayer_cmd_mixbench() reports the CPU time the mixer needs for one
+ *   stream of several common formats.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_MIXER
+static int nxplayer_cmd_mixbench(FAR struct nxplayer_s *pPlayer, char *parg)
+{
+  static const struct
+  {
+    uint32_t rate;
+    uint8_t  nchannels;
+    uint8_t  bpsamp;
+  } formats[] =
+  {
+    {  8000, 1,  8 },
+    { 16000, 1, 16 },
+    { 22050, 2, 16 },
+    { 44100, 2, 16 },
+    { 48000, 2, 16 },
+  };
+
+  uint32_t outrate = 48000;
+  uint32_t usec;
+  int x;
+
+  if (parg != NULL && *parg != '\0')
+    {
+      outrate = (uint32_t)atoi(parg);
+    }
+
+  printf("Mixing one second at %lu Hz stereo:\n", (unsigned long)outrate);
+
+  for (x = 0; x < sizeof(formats) / sizeof(formats[0]); x++)
+    {
+      if (nxplayer_mixer_bench(outrate, formats[x].rate,
+                               formats[x].nchannels, formats[x].bpsamp,
+                               &usec) < 0)
+        {
+          printf("Benchmark failed\n");
+          return -EINVAL;
+        }
+
+      printf("  %5lu Hz %d ch %2d bit: %7lu usec/stream (%lu.%lu%% CPU)\n",
+             (unsigned long)formats[x].rate, formats[x].nchannels,
+             formats[x].bpsamp, (unsigned long)usec,
+             (unsigned long)(usec / 10000),
+             (unsigned long)((usec / 1000) % 10));
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxplayer_cmd_stats
+ *
+ *   nxplayer_cmd_stats() displays the read-ahead statistics of the current
+ *   or last playback.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+static int nxplayer_cmd_stats(FAR struct nxplayer_s *pPlayer, char *parg)
+{
+  struct nxplayer_stats_s stats;
+
+  nxplayer_getstats(pPlayer, &stats);
+
+  printf("bytes read:    %lu\n", (unsigned long)stats.nbytes);
+  printf("buffer size:   %lu  min fill: %lu\n",
+         (unsigned long)stats.bufsize, (unsigned long)stats.minfill);
+  printf("underruns:     %lu\n", (unsigned long)stats.underruns);
+  printf("wait (msec):   max %lu  total %lu\n",
+         (unsigned long)stats.waitmax, (unsigned long)stats.waittotal);
+  printf("read (msec):   max %lu\n", (unsigned long)stats.readmax);
+
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: nxplayer_cmd_stop
  *
@@ -581,6 +798,15 @@ static int nxplayer_cmd_quit(FAR struct nxplayer_s *pPlayer, char *parg)
   nxplayer_stop(pPlayer);
 #endif
 
+#ifdef CONFIG_NXPLAYER_MIXER
+  if (g_mixer != NULL)
+    {
+      nxplayer_setmixer(pPlayer, NULL);
+      nxplayer_mixer_destroy(g_mixer);
+      g_mixer = NULL;
+    }
+#endif
+
   return OK;
 }
 
@@ -0,0 +1,1365 @@
+/****************************************************************************
+ * apps/system/nxplayer/nxplayer_mixer.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/ioctl.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <mqueue.h>
+#include <time.h>
+#include <debug.h>
+
+#include <nuttx/audio/audio.h>
+#include "system/nxplayer.h"
+
+#include "nxplayer_priv.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_NXPLAYER_MIXER_PREFETCH
+#  define CONFIG_NXPLAYER_MIXER_PREFETCH      8192
+#endif
+
+#ifndef CONFIG_NXPLAYER_MIXER_READSTACKSIZE
+#  define CONFIG_NXPLAYER_MIXER_READSTACKSIZE 1024
+#endif
+
+/* Input frames decoded per refill from a stream's prefetch ring */
+
+#define NXMIXER_INFRAMES   256
+
+/* The reader thread refills a stream's prefetch ring once this many bytes
+ * of it are free.
+ */
+
+#define NXMIXER_READSIZE   (CONFIG_NXPLAYER_MIXER_PREFETCH / 4)
+
+/* Output frames mixed per pass over the streams */
+
+#define NXMIXER_CHUNK      64
+
+/* Unity gain in the Q15 format used for volume and balance */
+
+#define NXMIXER_UNITY      32768
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define NXMIXER_CLOCK    CLOCK_MONOTONIC
+#else
+#  define NXMIXER_CLOCK    CLOCK_REALTIME
+#endif
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/* One stream being mixed.  The reader thread reads the file into the
+ * prefetch ring.  The mixthread decodes the data from the ring to 16-bit
+ * stereo frames in inbuf and resamples them by linear interpolation between
+ * frame pos and pos+1, frac being the Q16 position between them and step
+ * the Q16 number of input frames per output frame.
+ *
+ * The ring fields are protected by the mixer lock, but only the reader
+ * thread writes at rdhead, which it does without holding the lock.
+ */
+
+struct nxplayer_stream_s
+{
+  FAR struct nxplayer_stream_s *flink;  /* Next stream of the mixer */
+  FAR struct nxplayer_s *player;        /* Owning player (NULL in bench) */
+  int         fd;                       /* Source file (-1: test signal) */
+  uint32_t    remaining;                /* Bytes of PCM data left in file */
+  uint32_t    rdhead;                   /* Ring offset of the next read */
+  uint32_t    rdtail;                   /* Ring offset of the next refill */
+  uint32_t    rdcount;                  /* Bytes in the ring */
+  uint32_t    step;                     /* Input frames per output (Q16) */
+  uint32_t    frac;                     /* Fraction of input frame (Q16) */
+  uint16_t    pos;                      /* Current frame in inbuf */
+  uint16_t    inframes;                 /* Number of frames in inbuf */
+  uint16_t    rawlen;                   /* Partial frame bytes in rawbuf */
+  uint8_t     nchannels;                /* Input channels (1 or 2) */
+  uint8_t     bpsamp;                   /* Input bits per sample (8 or 16) */
+  uint8_t     framesize;                /* Input bytes per frame */
+  bool        stop;                     /* Stop requested */
+  bool        rdeof;                    /* End of file or read error */
+  bool        reading;                  /* Reader thread is reading */
+  int16_t     inbuf[2 * (NXMIXER_INFRAMES + 1)];
+  uint8_t     rawbuf[4 * NXMIXER_INFRAMES];
+  uint8_t     ring[CONFIG_NXPLAYER_MIXER_PREFETCH];
+};
+
+struct nxplayer_mixer_s
+{
+  FAR struct nxplayer_stream_s *streams; /* Active streams */
+  pthread_mutex_t lock;                 /* Protects the stream list */
+  pthread_cond_t  cond;                 /* Signals removal of a stream */
+  pthread_cond_t  rdcond;               /* Signals room in a ring */
+  bool        rdstop;                   /* Stop the reader thread */
+  uint32_t    samprate;                 /* Output sample rate */
+  int         devFd;                    /* Audio device */
+  mqd_t       mq;                       /* Message queue of the mixthread */
+  char        mqname[16];               /* Name of the message queue */
+  pthread_t   mixId;                    /* Thread ID of the mixthread */
+  pthread_t   readId;                   /* Thread ID of the reader thread */
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  FAR void    *session;                 /* Session from the device */
+#endif
+  int32_t     acc[2 * NXMIXER_CHUNK];   /* Mix accumulator */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxplayer_mixer_le16/le32
+ *
+ *   Get little endian values from a WAV header.
+ *
+ ****************************************************************************/
+
+static uint16_t nxplayer_mixer_le16(FAR const uint8_t *p)
+{
+  return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+static uint32_t nxplayer_mixer_le32(FAR const uint8_t *p)
+{
+  return (uint32_t)nxplayer_mixer_le16(p) |
+         ((uint32_t)nxplayer_mixer_le16(&p[2]) << 16);
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_parsewav
+ *
+ *   Read the format of a WAV file and leave the file positioned at the
+ *   start of the sample data.
+ *
+ ****************************************************************************/
+
+static int nxplayer_mixer_parsewav(int fd, FAR uint8_t *nchannels,
+                                   FAR uint8_t *bpsamp,
+                                   FAR uint32_t *samprate,
+                                   FAR uint32_t *datalen)
+{
+  uint8_t  hdr[16];
+  uint32_t len;
+  bool     havefmt = false;
+
+  if (read(fd, hdr, 12) != 12 || memcmp(hdr, "RIFF", 4) != 0 ||
+      memcmp(&hdr[8], "WAVE", 4) != 0)
+    {
+      return -ENOSYS;
+    }
+
+  /* Walk the chunks up to the sample data */
+
+  while (read(fd, hdr, 8) == 8)
+    {
+      len = nxplayer_mixer_le32(&hdr[4]);
+
+      if (memcmp(hdr, "data", 4) == 0)
+        {
+          if (!havefmt)
+            {
+              break;
+            }
+
+          *datalen = len;
+          return OK;
+        }
+
+      if (memcmp(hdr, "fmt ", 4) == 0 && len >= 16)
+        {
+          if (read(fd, hdr, 16) != 16 || nxplayer_mixer_le16(hdr) != 1)
+            {
+              /* Not integer PCM */
+
+              break;
+            }
+
+          *nchannels = (uint8_t)nxplayer_mixer_le16(&hdr[2]);
+          *samprate  = nxplayer_mixer_le32(&hdr[4]);
+          *bpsamp    = (uint8_t)nxplayer_mixer_le16(&hdr[14]);
+          havefmt    = true;
+          len       -= 16;
+        }
+
+      /* Skip the (rest of the) chunk, which is padded to an even size */
+
+      if (lseek(fd, len + (len & 1), SEEK_CUR) < 0)
+        {
+          break;
+        }
+    }
+
+  return -ENOSYS;
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_newstream
+ *
+ *   Allocate a stream for the given input format.
+ *
+ ****************************************************************************/
+
+static FAR struct nxplayer_stream_s *
+nxplayer_mixer_newstream(FAR struct nxplayer_mixer_s *mixer,
+                         uint8_t nchannels, uint8_t bpsamp,
+                         uint32_t samprate)
+{
+  FAR struct nxplayer_stream_s *stream;
+
+  if (nchannels < 1 || nchannels > 2 || (bpsamp != 8 && bpsamp != 16) ||
+      samprate == 0 || samprate / mixer->samprate >= 256)
+    {
+      return NULL;
+    }
+
+  stream = (FAR struct nxplayer_stream_s *)
+    zalloc(sizeof(struct nxplayer_stream_s));
+  if (stream == NULL)
+    {
+      return NULL;
+    }
+
+  stream->fd        = -1;
+  stream->remaining = UINT32_MAX;
+  stream->step      = (uint32_t)((((uint64_t)samprate << 16) +
+                                  mixer->samprate / 2) / mixer->samprate);
+  stream->nchannels = nchannels;
+  stream->bpsamp    = bpsamp;
+  stream->framesize = nchannels * (bpsamp >> 3);
+
+  return stream;
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_refill
+ *
+ *   Decode more input frames of a stream from its prefetch ring.  The last
+ *   decoded frame is kept since it is needed to interpolate towards the new
+ *   ones.  This never reads the file.  Called with the mixer locked.
+ *
+ * Returned Value:
+ *   The number of bytes taken from the ring; zero at the end of the stream
+ *   or -EAGAIN if the ring is empty but more data is still to come.
+ *
+ ****************************************************************************/
+
+static ssize_t nxplayer_mixer_refill(FAR struct nxplayer_stream_s *stream)
+{
+  FAR const uint8_t *src;
+  FAR int16_t *dest;
+  size_t   nbytes;
+  size_t   ncopy;
+  ssize_t  nread;
+  uint16_t keep;
+  int      nframes;
+  int      i;
+
+  if (stream->inframes > 0)
+    {
+      keep = stream->inframes - 1;
+      stream->inbuf[0]  = stream->inbuf[2 * keep];
+      stream->inbuf[1]  = stream->inbuf[2 * keep + 1];
+      stream->pos      -= keep;
+      stream->inframes  = 1;
+    }
+
+  nbytes = NXMIXER_INFRAMES * stream->framesize - stream->rawlen;
+
+  if (stream->fd < 0)
+    {
+      /* Benchmark: generate a test signal instead of reading a file */
+
+      for (i = 0; i < nbytes; i++)
+        {
+          stream->rawbuf[stream->rawlen + i] = (uint8_t)(i * 37);
+        }
+
+      nread = nbytes;
+    }
+  else
+    {
+      if (stream->rdcount == 0)
+        {
+          if (stream->rdeof || stream->remaining == 0)
+            {
+              return 0;
+            }
+
+          return -EAGAIN;
+        }
+
+      /* Copy out of the ring, which may take two pieces if it wraps */
+
+      if (nbytes > stream->rdcount)
+        {
+          nbytes = stream->rdcount;
+        }
+
+      ncopy = CONFIG_NXPLAYER_MIXER_PREFETCH - stream->rdtail;
+      if (ncopy > nbytes)
+        {
+          ncopy = nbytes;
+        }
+
+      memcpy(&stream->rawbuf[stream->rawlen],
+             &stream->ring[stream->rdtail], ncopy);
+      if (ncopy < nbytes)
+        {
+          memcpy(&stream->rawbuf[stream->rawlen + ncopy], stream->ring,
+                 nbytes - ncopy);
+        }
+
+      stream->rdtail += nbytes;
+      if (stream->rdtail >= CONFIG_NXPLAYER_MIXER_PREFETCH)
+        {
+          stream->rdtail -= CONFIG_NXPLAYER_MIXER_PREFETCH;
+        }
+
+      stream->rdcount -= nbytes;
+      nread = nbytes;
+    }
+
+  /* Decode all complete frames to 16-bit stereo */
+
+  nbytes  = stream->rawlen + nread;
+  nframes = nbytes / stream->framesize;
+  src     = stream->rawbuf;
+  dest    = &stream->inbuf[2 * stream->inframes];
+
+  if (stream->bpsamp == 16)
+    {
+      for (i = 0; i < nframes; i++, dest += 2)
+        {
+          dest[0] = (int16_t)nxplayer_mixer_le16(src);
+          src    += 2;
+          dest[1] = dest[0];
+          if (stream->nchannels == 2)
+            {
+              dest[1] = (int16_t)nxplayer_mixer_le16(src);
+              src    += 2;
+            }
+        }
+    }
+  else
+    {
+      /* 8-bit PCM is unsigned */
+
+      for (i = 0; i < nframes; i++, dest += 2)
+        {
+          dest[0] = (int16_t)((*src++ - 128) << 8);
+          dest[1] = dest[0];
+          if (stream->nchannels == 2)
+            {
+              dest[1] = (int16_t)((*src++ - 128) << 8);
+            }
+        }
+    }
+
+  stream->inframes += nframes;
+
+  /* Keep a trailing partial frame for the next read */
+
+  stream->rawlen = nbytes - nframes * stream->framesize;
+  if (stream->rawlen > 0)
+    {
+      memmove(stream->rawbuf, src, stream->rawlen);
+    }
+
+  return nread;
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_resample
+ *
+ *   Resample nframes output frames of a stream, scale them by the Q15 gains
+ *   and add them to the accumulator.
+ *
+ *   A stream whose prefetch ring ran dry adds nothing for the rest of the
+ *   frames.
+ *
+ * Returned Value:
+ *   false if the stream ended.
+ *
+ ****************************************************************************/
+
+static bool nxplayer_mixer_resample(FAR struct nxplayer_stream_s *stream,
+                                    FAR int32_t *acc, int nframes,
+                                    int32_t gainl, int32_t gainr)
+{
+  FAR const int16_t *in;
+  ssize_t nread;
+  int32_t frac;
+  int32_t left;
+  int32_t right;
+  int     i;
+
+  for (i = 0; i < nframes; i++, acc += 2)
+    {
+      while (stream->pos + 1 >= stream->inframes)
+        {
+          nread = nxplayer_mixer_refill(stream);
+          if (nread == -EAGAIN)
+            {
+              return true;
+            }
+          else if (nread <= 0)
+            {
+              return false;
+            }
+        }
+
+      in = &stream->inbuf[2 * stream->pos];
+      if (stream->frac == 0)
+        {
+          left  = in[0];
+          right = in[1];
+        }
+      else
+        {
+          /* Q15 fraction so that the product fits in 32 bits */
+
+          frac  = stream->frac >> 1;
+          left  = in[0] + (((in[2] - in[0]) * frac) >> 15);
+          right = in[1] + (((in[3] - in[1]) * frac) >> 15);
+        }
+
+      acc[0] += (left * gainl) >> 15;
+      acc[1] += (right * gainr) >> 15;
+
+      stream->frac += stream->step;
+      stream->pos  += stream->frac >> 16;
+      stream->frac &= 0xffff;
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_gains
+ *
+ *   Get the Q15 left and right gains from a player's volume and balance
+ *   (both in tenths of a percent).
+ *
+ ****************************************************************************/
+
+static void nxplayer_mixer_gains(FAR struct nxplayer_s *pPlayer,
+                                 FAR int32_t *gainl, FAR int32_t *gainr)
+{
+  int32_t gain = NXMIXER_UNITY;
+
+  *gainl = gain;
+  *gainr = gain;
+
+  if (pPlayer == NULL)
+    {
+      return;
+    }
+
+#ifndef CONFIG_AUDIO_EXCLUDE_VOLUME
+  gain = (int32_t)pPlayer->volume * NXMIXER_UNITY / 1000;
+  *gainl = gain;
+  *gainr = gain;
+
+#ifndef CONFIG_AUDIO_EXCLUDE_BALANCE
+  /* 0 is left off, 1000 is right off */
+
+  if (pPlayer->balance < 500)
+    {
+      *gainl = gain * pPlayer->balance / 500;
+    }
+  else if (pPlayer->balance > 500)
+    {
+      *gainr = gain * (1000 - pPlayer->balance) / 500;
+    }
+#endif
+#endif
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_finish
+ *
+ *   Free a stream that ended or was stopped and set its player idle.
+ *   Called with the mixer locked and the stream unlinked.
+ *
+ ****************************************************************************/
+
+static void nxplayer_mixer_finish(FAR struct nxplayer_mixer_s *mixer,
+                                  FAR struct nxplayer_stream_s *stream)
+{
+  FAR struct nxplayer_s *pPlayer = stream->player;
+
+  if (stream->fd >= 0)
+    {
+      close(stream->fd);
+    }
+
+  free(stream);
+
+  if (pPlayer != NULL)
+    {
+      pPlayer->stream = NULL;
+      pPlayer->state  = NXPLAYER_STATE_IDLE;
+      pthread_cond_broadcast(&mixer->cond);
+
+      /* Drop the reference taken by nxplayer_mixer_addstream() */
+
+      nxplayer_release(pPlayer);
+    }
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_mix
+ *
+ *   Mix nframes frames of all active streams into out.  Called with the
+ *   mixer locked.
+ *
+ ****************************************************************************/
+
+static void nxplayer_mixer_mix(FAR struct nxplayer_mixer_s *mixer,
+                               FAR int16_t *out, int nframes)
+{
+  FAR struct nxplayer_stream_s *stream;
+  FAR struct nxplayer_stream_s *prev;
+  FAR struct nxplayer_stream_s *next;
+  int32_t gainl;
+  int32_t gainr;
+  int32_t sample;
+  int     n;
+  int     i;
+
+  while (nframes > 0)
+    {
+      n = nframes < NXMIXER_CHUNK ? nframes : NXMIXER_CHUNK;
+      memset(mixer->acc, 0, 2 * n * sizeof(int32_t));
+
+      for (prev = NULL, stream = mixer->streams; stream; stream = next)
+        {
+          next = stream->flink;
+
+          if (!stream->stop)
+            {
+              if (stream->player != NULL &&
+                  stream->player->state == NXPLAYER_STATE_PAUSED)
+                {
+                  prev = stream;
+                  continue;
+                }
+
+              nxplayer_mixer_gains(stream->player, &gainl, &gainr);
+              if (nxplayer_mixer_resample(stream, mixer->acc, n,
+                                          gainl, gainr))
+                {
+                  prev = stream;
+                  continue;
+                }
+            }
+
+          /* Stopped or at the end of its data.  The reader thread may still
+           * be reading into its ring; it is removed on a later pass.
+           */
+
+          if (stream->reading)
+            {
+              prev = stream;
+              continue;
+            }
+
+          if (prev != NULL)
+            {
+              prev->flink = next;
+            }
+          else
+            {
+              mixer->streams = next;
+            }
+
+          nxplayer_mixer_finish(mixer, stream);
+        }
+
+      /* Saturate to the 16-bit output */
+
+      for (i = 0; i < 2 * n; i++)
+        {
+          sample = mixer->acc[i];
+          if (sample > INT16_MAX)
+            {
+              sample = INT16_MAX;
+            }
+          else if (sample < INT16_MIN)
+            {
+              sample = INT16_MIN;
+            }
+
+          *out++ = (int16_t)sample;
+        }
+
+      nframes -= n;
+    }
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_fill
+ *
+ *   Fill an audio buffer with the mixer output.
+ *
+ ****************************************************************************/
+
+static void nxplayer_mixer_fill(FAR struct nxplayer_mixer_s *mixer,
+                                FAR struct ap_buffer_s *apb)
+{
+  int nframes = apb->nmaxbytes / (2 * sizeof(int16_t));
+
+  pthread_mutex_lock(&mixer->lock);
+  nxplayer_mixer_mix(mixer, (FAR int16_t *)apb->samp, nframes);
+
+  /* Let the reader thread refill the rings that were drained */
+
+  pthread_cond_signal(&mixer->rdcond);
+  pthread_mutex_unlock(&mixer->lock);
+
+  apb->nbytes  = nframes * 2 * sizeof(int16_t);
+  apb->curbyte = 0;
+  apb->flags   = 0;
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_enqueue
+ ****************************************************************************/
+
+static int nxplayer_mixer_enqueue(FAR struct nxplayer_mixer_s *mixer,
+                                  FAR struct ap_buffer_s *apb)
+{
+  struct audio_buf_desc_s bufdesc;
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  bufdesc.session   = mixer->session;
+#endif
+  bufdesc.numbytes  = apb->nbytes;
+  bufdesc.u.pBuffer = apb;
+
+  if (ioctl(mixer->devFd, AUDIOIOC_ENQUEUEBUFFER,
+            (unsigned long)&bufdesc) < 0)
+    {
+      int errcode = errno;
+
+      auderr("ERROR: AUDIOIOC_ENQUEUEBUFFER ioctl failed: %d\n", errcode);
+      return -errcode;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_readsize
+ *
+ *   Get the number of bytes the reader thread should read into a stream's
+ *   prefetch ring next, or zero if the stream needs no read now.  The read
+ *   goes no further than the end of the ring.  Called with the mixer
+ *   locked.
+ *
+ ****************************************************************************/
+
+static size_t nxplayer_mixer_readsize(FAR struct nxplayer_stream_s *stream)
+{
+  size_t nbytes;
+
+  if (stream->fd < 0 || stream->stop || stream->rdeof ||
+      stream->remaining == 0)
+    {
+      return 0;
+    }
+
+  /* Wait for a reasonable amount of room, unless that is all that is left
+   * in the file.
+   */
+
+  nbytes = CONFIG_NXPLAYER_MIXER_PREFETCH - stream->rdcount;
+  if (nbytes < NXMIXER_READSIZE && nbytes < stream->remaining)
+    {
+      return 0;
+    }
+
+  if (nbytes > CONFIG_NXPLAYER_MIXER_PREFETCH - stream->rdhead)
+    {
+      nbytes = CONFIG_NXPLAYER_MIXER_PREFETCH - stream->rdhead;
+    }
+
+  if (nbytes > stream->remaining)
+    {
+      nbytes = stream->remaining;
+    }
+
+  return nbytes;
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_readthread
+ *
+ *  The reader thread.  It keeps the prefetch rings of all streams filled
+ *  from their files, always serving the emptiest ring first.  The files
+ *  are read without holding the mixer lock, so a slow read never delays
+ *  the mixthread or the control calls.
+ *
+ ****************************************************************************/
+
+static void *nxplayer_mixer_readthread(pthread_addr_t pvarg)
+{
+  FAR struct nxplayer_mixer_s *mixer = (FAR struct nxplayer_mixer_s *)pvarg;
+  FAR struct nxplayer_stream_s *stream;
+  FAR struct nxplayer_stream_s *next;
+  size_t   nbytes;
+  size_t   head;
+  ssize_t  nread;
+
+  pthread_mutex_lock(&mixer->lock);
+  while (!mixer->rdstop)
+    {
+      /* Find the emptiest ring that needs data */
+
+      for (stream = NULL, next = mixer->streams; next; next = next->flink)
+        {
+          if (nxplayer_mixer_readsize(next) > 0 &&
+              (stream == NULL || next->rdcount < stream->rdcount))
+            {
+              stream = next;
+            }
+        }
+
+      if (stream == NULL)
+        {
+          pthread_cond_wait(&mixer->rdcond, &mixer->lock);
+          continue;
+        }
+
+      /* The mixthread does not remove the stream while we read */
+
+      nbytes          = nxplayer_mixer_readsize(stream);
+      head            = stream->rdhead;
+      stream->reading = true;
+      pthread_mutex_unlock(&mixer->lock);
+
+      nread = read(stream->fd, &stream->ring[head], nbytes);
+
+      pthread_mutex_lock(&mixer->lock);
+      stream->reading = false;
+
+      if (nread <= 0)
+        {
+          if (nread < 0)
+            {
+              int errcode = errno;
+
+              if (errcode == EINTR)
+                {
+                  continue;
+                }
+
+              auderr("ERROR: read failed: %d\n", errcode);
+            }
+
+          /* End of file or read error.  The stream ends once the data
+           * already in its ring has been played.
+           */
+
+          stream->rdeof = true;
+          continue;
+        }
+
+      head += nread;
+      if (head >= CONFIG_NXPLAYER_MIXER_PREFETCH)
+        {
+          head = 0;
+        }
+
+      stream->rdhead   = head;
+      stream->rdcount += nread;
+      if (stream->remaining != UINT32_MAX)
+        {
+          stream->remaining -= nread;
+        }
+    }
+
+  pthread_mutex_unlock(&mixer->lock);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixthread
+ *
+ *  The thread that feeds the mixer output to the audio device.  It runs
+ *  until the mixer is destroyed, playing silence when no stream is active.
+ *
+ ****************************************************************************/
+
+static void *nxplayer_mixthread(pthread_addr_t pvarg)
+{
+  FAR struct nxplayer_mixer_s *mixer = (FAR struct nxplayer_mixer_s *)pvarg;
+  FAR struct nxplayer_stream_s *stream;
+  FAR struct ap_buffer_s      **pBuffers = NULL;
+  struct audio_buf_desc_s     buf_desc;
+  struct audio_msg_s          msg;
+#ifdef CONFIG_AUDIO_DRIVER_SPECIFIC_BUFFERS
+  struct ap_buffer_info_s     buf_info;
+#endif
+  struct sched_param          sparam;
+  pthread_attr_t              tattr;
+  FAR void                    *value;
+  bool                        running = true;
+  bool                        streaming = true;
+  bool                        reading = false;
+  ssize_t                     size;
+  int                         nbuffers;
+  int                         bufsize;
+  int                         prio;
+  int                         ret;
+  int                         x;
+
+  audinfo("Entry\n");
+
+  /* Start the reader thread just below our priority so that refilling the
+   * rings never delays the servicing of the audio device.
+   */
+
+  pthread_attr_init(&tattr);
+  sparam.sched_priority = sched_get_priority_max(SCHED_FIFO) - 10;
+  (void)pthread_attr_setschedparam(&tattr, &sparam);
+  (void)pthread_attr_setstacksize(&tattr,
+                                  CONFIG_NXPLAYER_MIXER_READSTACKSIZE);
+
+  ret = pthread_create(&mixer->readId, &tattr, nxplayer_mixer_readthread,
+                       (pthread_addr_t)mixer);
+  if (ret != OK)
+    {
+      auderr("ERROR: Failed to create the reader thread: %d\n", ret);
+      running = false;
+      goto err_out;
+    }
+
+  pthread_setname_np(mixer->readId, "mixreader");
+  reading = true;
+
+  nbuffers = CONFIG_AUDIO_NUM_BUFFERS;
+  bufsize  = CONFIG_AUDIO_BUFFER_NUMBYTES;
+
+#ifdef CONFIG_AUDIO_DRIVER_SPECIFIC_BUFFERS
+  if (ioctl(mixer->devFd, AUDIOIOC_GETBUFFERINFO,
+            (unsigned long)&buf_info) == OK)
+    {
+      nbuffers = buf_info.nbuffers;
+      bufsize  = buf_info.buffer_size;
+    }
+#endif
+
+  pBuffers = (FAR struct ap_buffer_s **)
+    zalloc(nbuffers * sizeof(FAR struct ap_buffer_s *));
+  if (pBuffers == NULL)
+    {
+      running = false;
+      goto err_out;
+    }
+
+  /* Allocate the buffers and fill the pipeline */
+
+  for (x = 0; x < nbuffers && running; x++)
+    {
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+      buf_desc.session    = mixer->session;
+#endif
+      buf_desc.numbytes   = bufsize;
+      buf_desc.u.ppBuffer = &pBuffers[x];
+
+      if (ioctl(mixer->devFd, AUDIOIOC_ALLOCBUFFER,
+                (unsigned long)&buf_desc) != sizeof(buf_desc))
+        {
+          auderr("ERROR: Could not allocate buffer %d\n", x);
+          running = false;
+          break;
+        }
+
+      nxplayer_mixer_fill(mixer, pBuffers[x]);
+      if (nxplayer_mixer_enqueue(mixer, pBuffers[x]) != OK)
+        {
+          running = false;
+        }
+    }
+
+  /* Start the audio device */
+
+  if (running)
+    {
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+      running = ioctl(mixer->devFd, AUDIOIOC_START,
+                      (unsigned long)mixer->session) >= 0;
+#else
+      running = ioctl(mixer->devFd, AUDIOIOC_START, 0) >= 0;
+#endif
+    }
+
+  while (running)
+    {
+      size = mq_receive(mixer->mq, (FAR char *)&msg, sizeof(msg), &prio);
+      if (size != sizeof(msg))
+        {
+          continue;
+        }
+
+      switch (msg.msgId)
+        {
+          case AUDIO_MSG_DEQUEUE:
+            if (streaming)
+              {
+                nxplayer_mixer_fill(mixer, msg.u.pPtr);
+                if (nxplayer_mixer_enqueue(mixer, msg.u.pPtr) != OK)
+                  {
+                    streaming = false;
+                  }
+              }
+            break;
+
+          case AUDIO_MSG_STOP:
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+            ioctl(mixer->devFd, AUDIOIOC_STOP,
+                  (unsigned long)mixer->session);
+#else
+            ioctl(mixer->devFd, AUDIOIOC_STOP, 0);
+#endif
+            streaming = false;
+            break;
+
+          case AUDIO_MSG_COMPLETE:
+            running = false;
+            break;
+
+          default:
+            break;
+        }
+    }
+
+err_out:
+  audinfo("Clean-up and exit\n");
+
+  /* Stop the reader thread before the streams' files are closed */
+
+  if (reading)
+    {
+      pthread_mutex_lock(&mixer->lock);
+      mixer->rdstop = true;
+      pthread_cond_signal(&mixer->rdcond);
+      pthread_mutex_unlock(&mixer->lock);
+
+      pthread_join(mixer->readId, &value);
+    }
+
+  /* End all streams that are still active */
+
+  pthread_mutex_lock(&mixer->lock);
+  while ((stream = mixer->streams) != NULL)
+    {
+      mixer->streams = stream->flink;
+      nxplayer_mixer_finish(mixer, stream);
+    }
+
+  pthread_mutex_unlock(&mixer->lock);
+
+  if (pBuffers != NULL)
+    {
+      for (x = 0; x < nbuffers; x++)
+        {
+          if (pBuffers[x] != NULL)
+            {
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+              buf_desc.session = mixer->session;
+#endif
+              buf_desc.u.pBuffer = pBuffers[x];
+              ioctl(mixer->devFd, AUDIOIOC_FREEBUFFER,
+                    (unsigned long)&buf_desc);
+            }
+        }
+
+      free(pBuffers);
+    }
+
+  audinfo("Exit\n");
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_usec
+ ****************************************************************************/
+
+static uint32_t nxplayer_mixer_usec(void)
+{
+  struct timespec ts;
+
+  (void)clock_gettime(NXMIXER_CLOCK, &ts);
+  return (uint32_t)ts.tv_sec * 1000000 + (uint32_t)ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxplayer_mixer_create
+ *
+ *   nxplayer_mixer_create() opens and configures the audio device and
+ *   starts the mixthread.
+ *
+ ****************************************************************************/
+
+FAR struct nxplayer_mixer_s *nxplayer_mixer_create(FAR const char *devpath,
+                                                   uint32_t samprate)
+{
+  FAR struct nxplayer_mixer_s *mixer;
+  struct audio_caps_desc_s cap_desc;
+  struct sched_param  sparam;
+  struct mq_attr      attr;
+  pthread_attr_t      tattr;
+  int                 ret;
+
+  DEBUGASSERT(devpath != NULL && samprate > 0);
+
+  mixer = (FAR struct nxplayer_mixer_s *)
+    zalloc(sizeof(struct nxplayer_mixer_s));
+  if (mixer == NULL)
+    {
+      return NULL;
+    }
+
+  mixer->samprate = samprate;
+  mixer->devFd    = open(devpath, O_RDWR);
+  if (mixer->devFd < 0)
+    {
+      auderr("ERROR: Failed to open %s: %d\n", devpath, errno);
+      goto err_out_nodev;
+    }
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  ret = ioctl(mixer->devFd, AUDIOIOC_RESERVE,
+              (unsigned long)&mixer->session);
+#else
+  ret = ioctl(mixer->devFd, AUDIOIOC_RESERVE, 0);
+#endif
+  if (ret < 0)
+    {
+      auderr("ERROR: Failed to reserve device: %d\n", errno);
+      goto err_out;
+    }
+
+  /* The mixer always produces 16-bit stereo PCM */
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  cap_desc.session                = mixer->session;
+#endif
+  cap_desc.caps.ac_len            = sizeof(struct audio_caps_s);
+  cap_desc.caps.ac_type           = AUDIO_TYPE_OUTPUT;
+  cap_desc.caps.ac_channels       = 2;
+  cap_desc.caps.ac_controls.hw[0] = samprate;
+  cap_desc.caps.ac_controls.b[3]  = samprate >> 16;
+  cap_desc.caps.ac_controls.b[2]  = 16;
+
+  ioctl(mixer->devFd, AUDIOIOC_CONFIGURE, (unsigned long)&cap_desc);
+
+  /* Create the message queue of the mixthread */
+
+  attr.mq_maxmsg  = 16;
+  attr.mq_msgsize = sizeof(struct audio_msg_s);
+  attr.mq_curmsgs = 0;
+  attr.mq_flags   = 0;
+
+  snprintf(mixer->mqname, sizeof(mixer->mqname), "/tmp/%0lx",
+           (unsigned long)((uintptr_t)mixer));
+
+  mixer->mq = mq_open(mixer->mqname, O_RDWR | O_CREAT, 0644, &attr);
+  if (mixer->mq == NULL)
+    {
+      auderr("ERROR: mq_open failed: %d\n", errno);
+      goto err_out_release;
+    }
+
+  ioctl(mixer->devFd, AUDIOIOC_REGISTERMQ, (unsigned long)mixer->mq);
+
+  pthread_mutex_init(&mixer->lock, NULL);
+  pthread_cond_init(&mixer->cond, NULL);
+  pthread_cond_init(&mixer->rdcond, NULL);
+
+  pthread_attr_init(&tattr);
+  sparam.sched_priority = sched_get_priority_max(SCHED_FIFO) - 9;
+  (void)pthread_attr_setschedparam(&tattr, &sparam);
+  (void)pthread_attr_setstacksize(&tattr,
+                                  CONFIG_NXPLAYER_PLAYTHREAD_STACKSIZE);
+
+  ret = pthread_create(&mixer->mixId, &tattr, nxplayer_mixthread,
+                       (pthread_addr_t)mixer);
+  if (ret != OK)
+    {
+      auderr("ERROR: Failed to create mixthread: %d\n", ret);
+      pthread_cond_destroy(&mixer->rdcond);
+      pthread_cond_destroy(&mixer->cond);
+      pthread_mutex_destroy(&mixer->lock);
+      ioctl(mixer->devFd, AUDIOIOC_UNREGISTERMQ, (unsigned long)mixer->mq);
+      mq_close(mixer->mq);
+      mq_unlink(mixer->mqname);
+      goto err_out_release;
+    }
+
+  pthread_setname_np(mixer->mixId, "mixthread");
+  return mixer;
+
+err_out_release:
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  ioctl(mixer->devFd, AUDIOIOC_RELEASE, (unsigned long)mixer->session);
+#else
+  ioctl(mixer->devFd, AUDIOIOC_RELEASE, 0);
+#endif
+
+err_out:
+  close(mixer->devFd);
+
+err_out_nodev:
+  free(mixer);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_destroy
+ *
+ *   nxplayer_mixer_destroy() stops the mixthread and closes the device.
+ *
+ ****************************************************************************/
+
+void nxplayer_mixer_destroy(FAR struct nxplayer_mixer_s *mixer)
+{
+  struct audio_msg_s msg;
+  FAR void *value;
+
+  DEBUGASSERT(mixer != NULL);
+
+  msg.msgId  = AUDIO_MSG_STOP;
+  msg.u.data = 0;
+  mq_send(mixer->mq, (FAR const char *)&msg, sizeof(msg),
+          CONFIG_NXPLAYER_MSG_PRIO);
+
+  pthread_join(mixer->mixId, &value);
+
+  ioctl(mixer->devFd, AUDIOIOC_UNREGISTERMQ, (unsigned long)mixer->mq);
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  ioctl(mixer->devFd, AUDIOIOC_RELEASE, (unsigned long)mixer->session);
+#else
+  ioctl(mixer->devFd, AUDIOIOC_RELEASE, 0);
+#endif
+
+  close(mixer->devFd);
+  mq_close(mixer->mq);
+  mq_unlink(mixer->mqname);
+
+  pthread_cond_destroy(&mixer->rdcond);
+  pthread_cond_destroy(&mixer->cond);
+  pthread_mutex_destroy(&mixer->lock);
+  free(mixer);
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_addstream
+ *
+ *   Add the player's open media file as a stream of its mixer.
+ *
+ ****************************************************************************/
+
+int nxplayer_mixer_addstream(FAR struct nxplayer_s *pPlayer, int filefmt,
+                             uint8_t nchannels, uint8_t bpsamp,
+                             uint32_t samprate)
+{
+  FAR struct nxplayer_mixer_s *mixer = pPlayer->mixer;
+  FAR struct nxplayer_stream_s *stream;
+  uint32_t datalen = UINT32_MAX;
+  ssize_t nread;
+  int ret;
+
+  if (filefmt != AUDIO_FMT_PCM)
+    {
+      return -ENOSYS;
+    }
+
+  /* nxplayer_playfile() does not know the format, get it from the file */
+
+  if (nchannels == 0)
+    {
+      ret = nxplayer_mixer_parsewav(pPlayer->fd, &nchannels, &bpsamp,
+                                    &samprate, &datalen);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  stream = nxplayer_mixer_newstream(mixer, nchannels, bpsamp, samprate);
+  if (stream == NULL)
+    {
+      return -ENOSYS;
+    }
+
+  /* The stream takes over the file */
+
+  stream->player    = pPlayer;
+  stream->fd        = pPlayer->fd;
+  stream->remaining = datalen;
+  pPlayer->fd       = -1;
+
+  /* Fill the prefetch ring before the stream is mixed, so that it does not
+   * start with silence.  The stream is not shared yet.
+   */
+
+  nread = read(stream->fd, stream->ring,
+               datalen < CONFIG_NXPLAYER_MIXER_PREFETCH ?
+               datalen : CONFIG_NXPLAYER_MIXER_PREFETCH);
+  if (nread > 0)
+    {
+      stream->rdhead  = nread < CONFIG_NXPLAYER_MIXER_PREFETCH ? nread : 0;
+      stream->rdcount = nread;
+      if (stream->remaining != UINT32_MAX)
+        {
+          stream->remaining -= nread;
+        }
+    }
+
+  nxplayer_reference(pPlayer);
+
+  pthread_mutex_lock(&mixer->lock);
+  pPlayer->stream = stream;
+  pPlayer->state  = NXPLAYER_STATE_PLAYING;
+  stream->flink   = mixer->streams;
+  mixer->streams  = stream;
+  pthread_cond_signal(&mixer->rdcond);
+  pthread_mutex_unlock(&mixer->lock);
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_stop
+ *
+ *   Stop the player's stream and wait until the mixthread removed it.
+ *
+ ****************************************************************************/
+
+int nxplayer_mixer_stop(FAR struct nxplayer_s *pPlayer)
+{
+  FAR struct nxplayer_mixer_s *mixer = pPlayer->mixer;
+
+  pthread_mutex_lock(&mixer->lock);
+  if (pPlayer->stream != NULL)
+    {
+      pPlayer->stream->stop = true;
+      while (pPlayer->stream != NULL)
+        {
+          pthread_cond_wait(&mixer->cond, &mixer->lock);
+        }
+    }
+
+  pthread_mutex_unlock(&mixer->lock);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxplayer_mixer_bench
+ *
+ *   nxplayer_mixer_bench() times the mixing of one second of output from
+ *   one generated stream.
+ *
+ ****************************************************************************/
+
+int nxplayer_mixer_bench(uint32_t outrate, uint32_t inrate,
+                         uint8_t nchannels, uint8_t bpsamp,
+                         FAR uint32_t *usec)
+{
+  FAR struct nxplayer_mixer_s *mixer;
+  FAR int16_t *out;
+  uint32_t start;
+  uint32_t nframes;
+  int ret = OK;
+
+  mixer = (FAR struct nxplayer_mixer_s *)
+    zalloc(sizeof(struct nxplayer_mixer_s));
+  out   = (FAR int16_t *)malloc(2 * NXMIXER_INFRAMES * sizeof(int16_t));
+  if (mixer == NULL || out == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  mixer->samprate = outrate;
+  mixer->streams  = nxplayer_mixer_newstream(mixer, nchannels, bpsamp,
+                                             inrate);
+  if (mixer->streams == NULL)
+    {
+      ret = -EINVAL;
+      goto errout;
+    }
+
+  start = nxplayer_mixer_usec();
+  for (nframes = 0; nframes < outrate; nframes += NXMIXER_INFRAMES)
+    {
+      nxplayer_mixer_mix(mixer, out, NXMIXER_INFRAMES);
+    }
+
+  *usec = nxplayer_mixer_usec() - start;
+
+  free(mixer->streams);
+
+errout:
+  free(out);
+  free(mixer);
+  return ret;
+}
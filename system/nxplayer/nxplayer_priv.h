@@ -0,0 +1,103 @@
+/****************************************************************************
+ * apps/system/nxplayer/nxplayer_priv.h
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_SYSTEM_NXPLAYER_NXPLAYER_PRIV_H
+#define __APPS_SYSTEM_NXPLAYER_NXPLAYER_PRIV_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+#include "system/nxplayer.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define NXPLAYER_STATE_IDLE      0
+#define NXPLAYER_STATE_PLAYING   1
+#define NXPLAYER_STATE_PAUSED    2
+
+#ifndef CONFIG_AUDIO_NUM_BUFFERS
+#  define CONFIG_AUDIO_NUM_BUFFERS  2
+#endif
+
+#ifndef CONFIG_AUDIO_BUFFER_NUMBYTES
+#  define CONFIG_AUDIO_BUFFER_NUMBYTES  8192
+#endif
+
+#ifndef CONFIG_NXPLAYER_MSG_PRIO
+#  define CONFIG_NXPLAYER_MSG_PRIO  1
+#endif
+
+#ifndef CONFIG_NXPLAYER_PLAYTHREAD_STACKSIZE
+#  define CONFIG_NXPLAYER_PLAYTHREAD_STACKSIZE    1500
+#endif
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_MIXER
+/****************************************************************************
+ * Name: nxplayer_mixer_addstream
+ *
+ *   Hand the media file opened by nxplayer_playinternal() over to the mixer
+ *   the player is attached to.  Only PCM is supported.  nchannels, bpsamp
+ *   and samprate are zero for nxplayer_playfile(); the format is then taken
+ *   from the WAV header.  On success the mixer owns the file and holds a
+ *   reference to the player until the stream ends.
+ *
+ ****************************************************************************/
+
+int nxplayer_mixer_addstream(FAR struct nxplayer_s *pPlayer, int filefmt,
+                             uint8_t nchannels, uint8_t bpsamp,
+                             uint32_t samprate);
+
+/****************************************************************************
+ * Name: nxplayer_mixer_stop
+ *
+ *   Stop the player's stream on its mixer and wait until it is removed.
+ *
+ ****************************************************************************/
+
+int nxplayer_mixer_stop(FAR struct nxplayer_s *pPlayer);
+#endif
+
+#endif /* __APPS_SYSTEM_NXPLAYER_NXPLAYER_PRIV_H */
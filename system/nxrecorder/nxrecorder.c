@@ -51,6 +51,10 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <dirent.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
 #include <debug.h>
 
 #include <nuttx/audio/audio.h>
@@ -80,6 +84,65 @@
 #  define CONFIG_NXRECORDER_RECORDTHREAD_STACKSIZE    1500
 #endif
 
+#ifdef CONFIG_NXRECORDER_WRITER
+#  ifndef CONFIG_NXRECORDER_WRITER_BUFSIZE
+#    define CONFIG_NXRECORDER_WRITER_BUFSIZE          65536
+#  endif
+#  ifndef CONFIG_NXRECORDER_WRITER_WRITESIZE
+#    define CONFIG_NXRECORDER_WRITER_WRITESIZE        4096
+#  endif
+#  ifndef CONFIG_NXRECORDER_WRITER_STACKSIZE
+#    define CONFIG_NXRECORDER_WRITER_STACKSIZE        1024
+#  endif
+#  ifdef CONFIG_CLOCK_MONOTONIC
+#    define NXRECORDER_CLOCK                          CLOCK_MONOTONIC
+#  else
+#    define NXRECORDER_CLOCK                          CLOCK_REALTIME
+#  endif
+
+/* The capture ring is shared by the record thread and the writer thread
+ * without a lock.  The barrier orders the ring data against the index
+ * that publishes it.
+ */
+
+#  define NXRECORDER_MB()                             __sync_synchronize()
+#endif
+
+/* RIFF/WAVE file headers */
+
+#define NXRECORDER_WAVE_FORMAT_PCM        0x0001
+#define NXRECORDER_WAVE_FORMAT_IMA_ADPCM  0x0011
+
+#define NXRECORDER_WAV_HDRSIZE            44
+#define NXRECORDER_ADPCM_HDRSIZE          60
+#define NXRECORDER_MAX_HDRSIZE            60
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_ADPCM
+/* IMA ADPCM quantizer step sizes and step index adjustments */
+
+static const int16_t g_ima_steps[89] =
+{
+  7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+  19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+  50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+  130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+  337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+  876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+  2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+  5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+  15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t g_ima_index[8] =
+{
+  -1, -1, -1, -1, 2, 4, 6, 8
+};
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -103,34 +166,803 @@ static int nxrecorder_opendevice(FAR struct nxrecorder_s *pRecorder)
 {
   /* If we have a device, then open it */
 
-  if (pRecorder->device[0] != '\0')
+  if (pRecorder->device[0] != '\0')
+    {
+      /* Use the saved prefformat to test if the requested
+       * format is specified by the device
+       */
+
+      /* Device supports the format.  Open the device file. */
+
+      pRecorder->devFd = open(pRecorder->device, O_RDWR);
+      if (pRecorder->devFd == -1)
+        {
+          int errcode = errno;
+          DEBUGASSERT(errcode > 0);
+
+          auderr("ERROR: Failed to open %s: %d\n", -errcode);
+          UNUSED(errcode);
+          return -ENOENT;
+        }
+
+      return OK;
+    }
+
+  /* Device not found */
+
+  auderr("ERROR: Device not found\n");
+  pRecorder->devFd = -1;
+  return -ENODEV;
+}
+
+/****************************************************************************
+ * Name: nxrecorder_putle16/32
+ *
+ *  Store little endian values in a file header.
+ *
+ ****************************************************************************/
+
+static void nxrecorder_putle16(FAR uint8_t *dest, uint16_t value)
+{
+  dest[0] = (uint8_t)value;
+  dest[1] = (uint8_t)(value >> 8);
+}
+
+static void nxrecorder_putle32(FAR uint8_t *dest, uint32_t value)
+{
+  dest[0] = (uint8_t)value;
+  dest[1] = (uint8_t)(value >> 8);
+  dest[2] = (uint8_t)(value >> 16);
+  dest[3] = (uint8_t)(value >> 24);
+}
+
+/****************************************************************************
+ * Name: nxrecorder_wavheader
+ *
+ *  Build the RIFF/WAVE header for the recording in hdr and return its
+ *  size.  The RIFF, data and (for ADPCM) fact sizes are taken from the
+ *  counts kept while recording, so the same function produces both the
+ *  placeholder written when the file is created and the final header.
+ *
+ ****************************************************************************/
+
+static size_t nxrecorder_wavheader(FAR struct nxrecorder_s *pRecorder,
+                                   FAR uint8_t *hdr)
+{
+  size_t   hdrsize;
+  uint16_t blockalign;
+  uint32_t byterate;
+
+  blockalign = pRecorder->nchannels * (pRecorder->bpsamp >> 3);
+  byterate   = pRecorder->samprate * blockalign;
+  hdrsize    = NXRECORDER_WAV_HDRSIZE;
+
+  memcpy(&hdr[0], "RIFF", 4);
+  memcpy(&hdr[8], "WAVEfmt ", 8);
+  nxrecorder_putle32(&hdr[16], 16);
+  nxrecorder_putle16(&hdr[20], NXRECORDER_WAVE_FORMAT_PCM);
+  nxrecorder_putle16(&hdr[22], pRecorder->nchannels);
+  nxrecorder_putle32(&hdr[24], pRecorder->samprate);
+
+#ifdef CONFIG_NXRECORDER_ADPCM
+  if (pRecorder->format == NXRECORDER_FMT_ADPCM)
+    {
+      /* IMA ADPCM: 4 bits per sample and a format extension giving the
+       * number of samples per block.  A fact chunk holds the number of
+       * frames since that cannot be derived from the data size.
+       */
+
+      blockalign = pRecorder->adblock;
+      byterate   = (uint32_t)(((uint64_t)pRecorder->samprate * blockalign) /
+                              pRecorder->adframes);
+      hdrsize    = NXRECORDER_ADPCM_HDRSIZE;
+
+      nxrecorder_putle32(&hdr[16], 20);
+      nxrecorder_putle16(&hdr[20], NXRECORDER_WAVE_FORMAT_IMA_ADPCM);
+      nxrecorder_putle16(&hdr[34], 4);
+      nxrecorder_putle16(&hdr[36], 2);
+      nxrecorder_putle16(&hdr[38], pRecorder->adframes);
+      memcpy(&hdr[40], "fact", 4);
+      nxrecorder_putle32(&hdr[44], 4);
+      nxrecorder_putle32(&hdr[48], pRecorder->nframes);
+    }
+  else
+#endif
+    {
+      nxrecorder_putle16(&hdr[34], pRecorder->bpsamp);
+    }
+
+  nxrecorder_putle32(&hdr[4], hdrsize - 8 + pRecorder->ndata);
+  nxrecorder_putle32(&hdr[28], byterate);
+  nxrecorder_putle16(&hdr[32], blockalign);
+  memcpy(&hdr[hdrsize - 8], "data", 4);
+  nxrecorder_putle32(&hdr[hdrsize - 4], pRecorder->ndata);
+
+  return hdrsize;
+}
+
+/****************************************************************************
+ * Name: nxrecorder_writeheader
+ *
+ *  Write the file header at the start of the file.  This is called when
+ *  the file is created and again, with the final sizes, when it is closed.
+ *
+ ****************************************************************************/
+
+static int nxrecorder_writeheader(FAR struct nxrecorder_s *pRecorder)
+{
+  uint8_t hdr[NXRECORDER_MAX_HDRSIZE];
+  size_t  hdrsize;
+
+  if (pRecorder->format == NXRECORDER_FMT_RAW)
+    {
+      return OK;
+    }
+
+  hdrsize = nxrecorder_wavheader(pRecorder, hdr);
+  if (lseek(pRecorder->fd, 0, SEEK_SET) != 0 ||
+      write(pRecorder->fd, hdr, hdrsize) != (ssize_t)hdrsize)
+    {
+      int errcode = errno;
+      DEBUGASSERT(errcode > 0);
+
+      auderr("ERROR: Failed to write the file header: %d\n", errcode);
+      return -errcode;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxrecorder_hdrsize
+ *
+ *  Return the size of the header of the file being recorded.
+ *
+ ****************************************************************************/
+
+static size_t nxrecorder_hdrsize(FAR struct nxrecorder_s *pRecorder)
+{
+  switch (pRecorder->format)
+    {
+      case NXRECORDER_FMT_WAV:
+        return NXRECORDER_WAV_HDRSIZE;
+
+#ifdef CONFIG_NXRECORDER_ADPCM
+      case NXRECORDER_FMT_ADPCM:
+        return NXRECORDER_ADPCM_HDRSIZE;
+#endif
+
+      default:
+        return 0;
+    }
+}
+
+/****************************************************************************
+ * Name: nxrecorder_msec
+ *
+ *  Return a free running time in milliseconds for the statistics.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_WRITER
+static uint32_t nxrecorder_msec(void)
+{
+  struct timespec ts;
+
+  (void)clock_gettime(NXRECORDER_CLOCK, &ts);
+  return (uint32_t)ts.tv_sec * 1000 + (uint32_t)ts.tv_nsec / 1000000;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxrecorder_flush
+ *
+ *  Write the staging buffer to the file.  Except for the first write,
+ *  which is shortened by the size of the file header, and the last one,
+ *  every write is exactly CONFIG_NXRECORDER_WRITER_WRITESIZE bytes at a
+ *  file offset that is a multiple of that size.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_WRITER
+static void nxrecorder_flush(FAR struct nxrecorder_s *pRecorder)
+{
+  FAR uint8_t *ptr = pRecorder->wrout;
+  size_t       remaining = pRecorder->wrfill;
+  uint32_t     start;
+  uint32_t     elapsed;
+  ssize_t      ret;
+
+  start = nxrecorder_msec();
+  while (remaining > 0)
+    {
+      ret = write(pRecorder->fd, ptr, remaining);
+      if (ret < 0)
+        {
+          int errcode = errno;
+
+          if (errcode == EINTR)
+            {
+              continue;
+            }
+
+          /* The data is lost, but keep draining the ring so that the
+           * record thread can continue and the header is still completed.
+           */
+
+          auderr("ERROR: write failed: %d\n", errcode);
+          break;
+        }
+
+      ptr       += ret;
+      remaining -= ret;
+      pRecorder->ndata          += ret;
+      pRecorder->stats.nwritten += ret;
+    }
+
+  elapsed = nxrecorder_msec() - start;
+
+  pRecorder->stats.nwrites++;
+  pRecorder->stats.writetotal += elapsed;
+  if (elapsed > pRecorder->stats.writemax)
+    {
+      pRecorder->stats.writemax = elapsed;
+    }
+
+  pRecorder->wrfill  = 0;
+  pRecorder->wrlimit = CONFIG_NXRECORDER_WRITER_WRITESIZE;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxrecorder_output
+ *
+ *  Append data for the file to the staging buffer, writing it out each
+ *  time it fills.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_WRITER
+static void nxrecorder_output(FAR struct nxrecorder_s *pRecorder,
+                              FAR const uint8_t *data, size_t nbytes)
+{
+  size_t ncopy;
+
+  while (nbytes > 0)
+    {
+      ncopy = pRecorder->wrlimit - pRecorder->wrfill;
+      if (ncopy > nbytes)
+        {
+          ncopy = nbytes;
+        }
+
+      memcpy(&pRecorder->wrout[pRecorder->wrfill], data, ncopy);
+      pRecorder->wrfill += ncopy;
+      data              += ncopy;
+      nbytes            -= ncopy;
+
+      if (pRecorder->wrfill >= pRecorder->wrlimit)
+        {
+          nxrecorder_flush(pRecorder);
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: nxrecorder_adpcmsample
+ *
+ *  Encode one sample as a 4-bit IMA ADPCM code, updating the predictor and
+ *  step index.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_ADPCM
+static uint8_t nxrecorder_adpcmsample(FAR int32_t *pred,
+                                      FAR uint8_t *index, int16_t sample)
+{
+  int32_t diff;
+  int32_t step;
+  int32_t vpdiff;
+  uint8_t code = 0;
+  int     ndx;
+
+  step = g_ima_steps[*index];
+  diff = (int32_t)sample - *pred;
+  if (diff < 0)
+    {
+      code = 8;
+      diff = -diff;
+    }
+
+  vpdiff = step >> 3;
+  if (diff >= step)
+    {
+      code   |= 4;
+      diff   -= step;
+      vpdiff += step;
+    }
+
+  step >>= 1;
+  if (diff >= step)
+    {
+      code   |= 2;
+      diff   -= step;
+      vpdiff += step;
+    }
+
+  step >>= 1;
+  if (diff >= step)
+    {
+      code   |= 1;
+      vpdiff += step;
+    }
+
+  /* Track the value the decoder will reconstruct */
+
+  *pred += (code & 8) ? -vpdiff : vpdiff;
+  if (*pred > INT16_MAX)
+    {
+      *pred = INT16_MAX;
+    }
+  else if (*pred < INT16_MIN)
+    {
+      *pred = INT16_MIN;
+    }
+
+  ndx = *index + g_ima_index[code & 7];
+  if (ndx < 0)
+    {
+      ndx = 0;
+    }
+  else if (ndx > 88)
+    {
+      ndx = 88;
+    }
+
+  *index = (uint8_t)ndx;
+  return code;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxrecorder_adpcmblock
+ *
+ *  Encode the collected block of PCM frames into one IMA ADPCM block and
+ *  pass it to the staging buffer.  A short final block is padded with
+ *  silence; the fact chunk records the real number of frames.
+ *
+ *  Block layout: for each channel a 4 byte header holding the first
+ *  sample and the step index, then for each channel in turn 4 bytes
+ *  holding the codes of the next 8 samples of that channel, low nibble
+ *  first.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_ADPCM
+static void nxrecorder_adpcmblock(FAR struct nxrecorder_s *pRecorder)
+{
+  FAR const int16_t *in = pRecorder->adin;
+  FAR uint8_t       *out = pRecorder->adout;
+  int                nch = pRecorder->nchannels;
+  int32_t            pred[2];
+  uint8_t            code;
+  int                frame;
+  int                ch;
+  int                i;
+
+  if (pRecorder->adfill < pRecorder->adframes)
+    {
+      memset(&pRecorder->adin[pRecorder->adfill * nch], 0,
+             (pRecorder->adframes - pRecorder->adfill) * nch *
+             sizeof(int16_t));
+    }
+
+  for (ch = 0; ch < nch; ch++)
+    {
+      /* The first sample of the block is stored verbatim */
+
+      pred[ch] = in[ch];
+      nxrecorder_putle16(out, (uint16_t)in[ch]);
+      out[2] = pRecorder->adindex[ch];
+      out[3] = 0;
+      out   += 4;
+    }
+
+  for (frame = 1; frame < pRecorder->adframes; frame += 8)
+    {
+      for (ch = 0; ch < nch; ch++)
+        {
+          for (i = 0; i < 8; i += 2)
+            {
+              code  = nxrecorder_adpcmsample(&pred[ch],
+                                             &pRecorder->adindex[ch],
+                                             in[(frame + i) * nch + ch]);
+              code |= nxrecorder_adpcmsample(&pred[ch],
+                                             &pRecorder->adindex[ch],
+                                             in[(frame + i + 1) * nch + ch])
+                      << 4;
+              *out++ = code;
+            }
+        }
+    }
+
+  pRecorder->nframes += pRecorder->adfill;
+  pRecorder->adfill   = 0;
+
+  nxrecorder_output(pRecorder, pRecorder->adout, pRecorder->adblock);
+}
+#endif
+
+/****************************************************************************
+ * Name: nxrecorder_adpcm
+ *
+ *  Collect 16-bit PCM data from the ring into blocks for the encoder.
+ *  Returns the number of bytes consumed, which is always a whole number
+ *  of samples.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_ADPCM
+static size_t nxrecorder_adpcm(FAR struct nxrecorder_s *pRecorder,
+                               FAR const uint8_t *data, size_t nbytes)
+{
+  size_t framesize = pRecorder->nchannels * sizeof(int16_t);
+  size_t nframes;
+
+  nframes = nbytes / framesize;
+  if (nframes > pRecorder->adframes - pRecorder->adfill)
+    {
+      nframes = pRecorder->adframes - pRecorder->adfill;
+    }
+
+  memcpy(&pRecorder->adin[pRecorder->adfill * pRecorder->nchannels], data,
+         nframes * framesize);
+
+  pRecorder->adfill += nframes;
+  if (pRecorder->adfill >= pRecorder->adframes)
+    {
+      nxrecorder_adpcmblock(pRecorder);
+    }
+
+  return nframes * framesize;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxrecorder_writethread
+ *
+ *  The writer thread.  It drains the capture ring filled by the record
+ *  thread into the file (ADPCM encoding it on the way if requested), so
+ *  that a slow write to the media never delays the re-enqueueing of audio
+ *  buffers.  The record thread only advances wrhead and this thread only
+ *  advances wrtail, so the ring needs no lock; wrsem just wakes this
+ *  thread when data arrives.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_WRITER
+static void *nxrecorder_writethread(pthread_addr_t pvarg)
+{
+  FAR struct nxrecorder_s *pRecorder = (FAR struct nxrecorder_s *)pvarg;
+  size_t head;
+  size_t tail;
+  size_t nbytes;
+  bool   stop;
+
+  for (; ; )
+    {
+      while (sem_wait(&pRecorder->wrsem) < 0)
+        {
+          DEBUGASSERT(errno == EINTR);
+        }
+
+      /* Sample the stop flag before the ring so that everything queued
+       * before the stop request is still written.
+       */
+
+      stop = pRecorder->wrstop;
+      NXRECORDER_MB();
+
+      head = pRecorder->wrhead;
+      tail = pRecorder->wrtail;
+      NXRECORDER_MB();
+
+      while (head != tail)
+        {
+          /* Take what is contiguous in the ring */
+
+          nbytes = (head > tail ? head : pRecorder->wrsize) - tail;
+
+#ifdef CONFIG_NXRECORDER_ADPCM
+          if (pRecorder->format == NXRECORDER_FMT_ADPCM)
+            {
+              nbytes = nxrecorder_adpcm(pRecorder, &pRecorder->wrbuf[tail],
+                                        nbytes);
+              if (nbytes == 0)
+                {
+                  /* The ring size is a multiple of the frame size, so this
+                   * only happens if the device returned a partial frame.
+                   * Discard it rather than stall.
+                   */
+
+                  nbytes = (head > tail ? head : pRecorder->wrsize) - tail;
+                }
+            }
+          else
+#endif
+            {
+              nxrecorder_output(pRecorder, &pRecorder->wrbuf[tail], nbytes);
+            }
+
+          tail += nbytes;
+          if (tail >= pRecorder->wrsize)
+            {
+              tail -= pRecorder->wrsize;
+            }
+
+          /* Release the space to the record thread */
+
+          NXRECORDER_MB();
+          pRecorder->wrtail = tail;
+        }
+
+      if (stop)
+        {
+          break;
+        }
+    }
+
+  /* Write out what is left, including a final short ADPCM block */
+
+#ifdef CONFIG_NXRECORDER_ADPCM
+  if (pRecorder->format == NXRECORDER_FMT_ADPCM && pRecorder->adfill > 0)
+    {
+      nxrecorder_adpcmblock(pRecorder);
+    }
+#endif
+
+  if (pRecorder->wrfill > 0)
+    {
+      nxrecorder_flush(pRecorder);
+    }
+
+  return NULL;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxrecorder_startwriter
+ *
+ *  Allocate the capture ring and start the writer thread.  The file
+ *  header must already have been written.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_WRITER
+static int nxrecorder_startwriter(FAR struct nxrecorder_s *pRecorder)
+{
+  struct sched_param  sparam;
+  pthread_attr_t      tattr;
+  int                 ret;
+
+  memset(&pRecorder->stats, 0, sizeof(struct nxrecorder_stats_s));
+
+  pRecorder->wrbuf = (FAR uint8_t *)malloc(CONFIG_NXRECORDER_WRITER_BUFSIZE);
+  pRecorder->wrout =
+    (FAR uint8_t *)malloc(CONFIG_NXRECORDER_WRITER_WRITESIZE);
+  if (pRecorder->wrbuf == NULL || pRecorder->wrout == NULL)
+    {
+      auderr("ERROR: Failed to allocate the writer buffers\n");
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+#ifdef CONFIG_NXRECORDER_ADPCM
+  if (pRecorder->format == NXRECORDER_FMT_ADPCM)
+    {
+      pRecorder->adin =
+        (FAR int16_t *)malloc(pRecorder->adframes * pRecorder->nchannels *
+                              sizeof(int16_t));
+      pRecorder->adout = (FAR uint8_t *)malloc(pRecorder->adblock);
+      if (pRecorder->adin == NULL || pRecorder->adout == NULL)
+        {
+          auderr("ERROR: Failed to allocate the ADPCM buffers\n");
+          ret = -ENOMEM;
+          goto errout;
+        }
+
+      pRecorder->adfill     = 0;
+      pRecorder->adindex[0] = 0;
+      pRecorder->adindex[1] = 0;
+    }
+#endif
+
+  /* Keep the ring a multiple of a 16-bit stereo frame so that the ADPCM
+   * encoder never sees a frame split across the end of the ring.
+   */
+
+  pRecorder->wrsize        = CONFIG_NXRECORDER_WRITER_BUFSIZE & ~3;
+  pRecorder->wrhead        = 0;
+  pRecorder->wrtail        = 0;
+  pRecorder->wrstop        = false;
+  pRecorder->wrfill        = 0;
+  pRecorder->stats.bufsize = pRecorder->wrsize;
+
+  /* Shorten the first write by the size of the header so that all later
+   * writes start on a CONFIG_NXRECORDER_WRITER_WRITESIZE boundary.
+   */
+
+  pRecorder->wrlimit = CONFIG_NXRECORDER_WRITER_WRITESIZE -
+                       nxrecorder_hdrsize(pRecorder) %
+                       CONFIG_NXRECORDER_WRITER_WRITESIZE;
+
+  sem_init(&pRecorder->wrsem, 0, 0);
+
+  /* Run just below the record thread so that writing never delays the
+   * servicing of the audio device.
+   */
+
+  pthread_attr_init(&tattr);
+  sparam.sched_priority = sched_get_priority_max(SCHED_FIFO) - 10;
+  (void)pthread_attr_setschedparam(&tattr, &sparam);
+  (void)pthread_attr_setstacksize(&tattr,
+                                  CONFIG_NXRECORDER_WRITER_STACKSIZE);
+
+  ret = pthread_create(&pRecorder->writeId, &tattr, nxrecorder_writethread,
+                       (pthread_addr_t)pRecorder);
+  if (ret != OK)
+    {
+      auderr("ERROR: Failed to create writethread: %d\n", ret);
+      sem_destroy(&pRecorder->wrsem);
+      ret = -ret;
+      goto errout;
+    }
+
+  pthread_setname_np(pRecorder->writeId, "writethread");
+  return OK;
+
+errout:
+#ifdef CONFIG_NXRECORDER_ADPCM
+  free(pRecorder->adin);
+  free(pRecorder->adout);
+  pRecorder->adin  = NULL;
+  pRecorder->adout = NULL;
+#endif
+  free(pRecorder->wrbuf);
+  free(pRecorder->wrout);
+  pRecorder->wrbuf = NULL;
+  pRecorder->wrout = NULL;
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxrecorder_stopwriter
+ *
+ *  Stop the writer thread, if running, after it has written everything in
+ *  the ring, and free the buffers.  This must be done before the file is
+ *  closed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_WRITER
+static void nxrecorder_stopwriter(FAR struct nxrecorder_s *pRecorder)
+{
+  FAR void *value;
+
+  if (pRecorder->wrbuf == NULL)
+    {
+      return;
+    }
+
+  pRecorder->wrstop = true;
+  NXRECORDER_MB();
+  sem_post(&pRecorder->wrsem);
+
+  pthread_join(pRecorder->writeId, &value);
+  sem_destroy(&pRecorder->wrsem);
+
+#ifdef CONFIG_NXRECORDER_ADPCM
+  free(pRecorder->adin);
+  free(pRecorder->adout);
+  pRecorder->adin  = NULL;
+  pRecorder->adout = NULL;
+#endif
+  free(pRecorder->wrbuf);
+  free(pRecorder->wrout);
+  pRecorder->wrbuf = NULL;
+  pRecorder->wrout = NULL;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxrecorder_closefile
+ *
+ *  Close the recorded file, first stopping the writer thread and then
+ *  completing the file header.
+ *
+ ****************************************************************************/
+
+static void nxrecorder_closefile(FAR struct nxrecorder_s *pRecorder)
+{
+#ifdef CONFIG_NXRECORDER_WRITER
+  nxrecorder_stopwriter(pRecorder);
+#endif
+
+  (void)nxrecorder_writeheader(pRecorder);
+
+  close(pRecorder->fd);
+  pRecorder->fd = -1;
+}
+
+/****************************************************************************
+ * Name: nxrecorder_queuebuffer
+ *
+ *  Copy a captured buffer into the capture ring for the writer thread.
+ *  This never waits: if the writer has fallen so far behind that the
+ *  buffer does not fit, it is dropped and counted.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_WRITER
+static void nxrecorder_queuebuffer(FAR struct nxrecorder_s *pRecorder,
+                                   FAR struct ap_buffer_s *apb)
+{
+  size_t size = pRecorder->wrsize;
+  size_t head;
+  size_t tail;
+  size_t used;
+  size_t ncopy;
+
+  head = pRecorder->wrhead;
+  tail = pRecorder->wrtail;
+  NXRECORDER_MB();
+
+  /* One byte is always left free to tell a full ring from an empty one */
+
+  used = (head >= tail) ? head - tail : size - tail + head;
+  pRecorder->stats.nbytes += apb->nbytes;
+
+  if (apb->nbytes > size - 1 - used)
     {
-      /* Use the saved prefformat to test if the requested
-       * format is specified by the device
-       */
+      pRecorder->stats.dropped++;
+      return;
+    }
 
-      /* Device supports the format.  Open the device file. */
+  /* Copy in, which may take two pieces if the ring wraps */
 
-      pRecorder->devFd = open(pRecorder->device, O_RDWR);
-      if (pRecorder->devFd == -1)
-        {
-          int errcode = errno;
-          DEBUGASSERT(errcode > 0);
+  ncopy = size - head;
+  if (ncopy > apb->nbytes)
+    {
+      ncopy = apb->nbytes;
+    }
 
-          auderr("ERROR: Failed to open %s: %d\n", -errcode);
-          UNUSED(errcode);
-          return -ENOENT;
-        }
+  memcpy(&pRecorder->wrbuf[head], apb->samp, ncopy);
+  if (ncopy < apb->nbytes)
+    {
+      memcpy(pRecorder->wrbuf, &apb->samp[ncopy], apb->nbytes - ncopy);
+    }
 
-      return OK;
+  head += apb->nbytes;
+  if (head >= size)
+    {
+      head -= size;
     }
 
-  /* Device not found */
+  used += apb->nbytes;
+  if (used > pRecorder->stats.maxfill)
+    {
+      pRecorder->stats.maxfill = used;
+    }
 
-  auderr("ERROR: Device not found\n");
-  pRecorder->devFd = -1;
-  return -ENODEV;
+  /* Publish the data to the writer thread */
+
+  NXRECORDER_MB();
+  pRecorder->wrhead = head;
+  sem_post(&pRecorder->wrsem);
 }
+#endif
 
 /****************************************************************************
  * Name: nxrecorder_writebuffer
@@ -159,12 +991,25 @@ static int nxrecorder_writebuffer(FAR struct nxrecorder_s *pRecorder,
       return -ENODATA;
     }
 
-  /* Write data to the file. */
+  /* Hand the data to the writer thread, if running, or write it to the
+   * file directly.
+   */
 
-  ret = write(pRecorder->fd, apb->samp, apb->nbytes);
-  if (ret < 0)
+#ifdef CONFIG_NXRECORDER_WRITER
+  if (pRecorder->wrbuf != NULL)
     {
-      return ret;
+      nxrecorder_queuebuffer(pRecorder, apb);
+    }
+  else
+#endif
+    {
+      ret = write(pRecorder->fd, apb->samp, apb->nbytes);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      pRecorder->ndata += ret;
     }
 
   apb->curbyte = 0;
@@ -357,8 +1202,7 @@ static void *nxrecorder_recordthread(pthread_addr_t pvarg)
            * file so that no further data is written.
            */
 
-          close(pRecorder->fd);
-          pRecorder->fd = -1;
+          nxrecorder_closefile(pRecorder);
 
           /* We are no longer streaming data to the file.  Be we will
            * need to wait for any outstanding buffers to be recovered.  We
@@ -499,8 +1343,7 @@ static void *nxrecorder_recordthread(pthread_addr_t pvarg)
                          * Close the file so that no further data is written.
                          */
 
-                        close(pRecorder->fd);
-                        pRecorder->fd = -1;
+                        nxrecorder_closefile(pRecorder);
 
                         /* Stop streaming and wait for buffers to be
                          * returned and to receive the AUDIO_MSG_COMPLETE
@@ -557,91 +1400,332 @@ static void *nxrecorder_recordthread(pthread_addr_t pvarg)
         }
     }
 
-  /* Release our audio buffers and unregister / release the device */
+  /* Release our audio buffers and unregister / release the device */
+
+err_out:
+  audinfo("Clean-up and exit\n");
+
+#ifdef CONFIG_AUDIO_DRIVER_SPECIFIC_BUFFERS
+  if (pBuffers != NULL)
+    {
+      audinfo("Freeing buffers\n");
+      for (x = 0; x < buf_info.nbuffers; x++)
+        {
+          /* Fill in the buffer descriptor struct to issue a free request */
+
+          if (pBuffers[x] != NULL)
+            {
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+              buf_desc.session = pPlayer->session;
+#endif
+              buf_desc.u.pBuffer = pBuffers[x];
+              ioctl(pRecorder->devFd, AUDIOIOC_FREEBUFFER, (unsigned long) &buf_desc);
+            }
+        }
+
+      /* Free the pointers to the buffers */
+
+      free(pBuffers);
+    }
+#else
+    audinfo("Freeing buffers\n");
+    for (x = 0; x < CONFIG_AUDIO_NUM_BUFFERS; x++)
+      {
+        /* Fill in the buffer descriptor struct to issue a free request */
+
+        if (pBuffers[x] != NULL)
+          {
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+            buf_desc.session = pPlayer->session;
+#endif
+            buf_desc.u.pBuffer = pBuffers[x];
+            ioctl(pRecorder->devFd, AUDIOIOC_FREEBUFFER, (unsigned long) &buf_desc);
+          }
+      }
+#endif
+
+  /* Unregister the message queue and release the session */
+
+  ioctl(pRecorder->devFd, AUDIOIOC_UNREGISTERMQ, (unsigned long) pRecorder->mq);
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  ioctl(pRecorder->devFd, AUDIOIOC_RELEASE, (unsigned long) pRecorder->session);
+#else
+  ioctl(pRecorder->devFd, AUDIOIOC_RELEASE, 0);
+#endif
+
+  /* Cleanup */
+
+  while (sem_wait(&pRecorder->sem) < 0)
+    {
+    }
+
+  /* Close the files */
+
+  if (0 < pRecorder->fd)
+    {
+      nxrecorder_closefile(pRecorder);      /* Close the file */
+    }
+
+  close(pRecorder->devFd);                  /* Close the device */
+  pRecorder->devFd = -1;                    /* Mark device as closed */
+  mq_close(pRecorder->mq);                  /* Close the message queue */
+  mq_unlink(pRecorder->mqname);             /* Unlink the message queue */
+  pRecorder->state = NXRECORDER_STATE_IDLE; /* Go to IDLE */
+
+  sem_post(&pRecorder->sem);                /* Release the semaphore */
+
+  /* The record thread is done with the context.  Release it, which may
+   * actually cause the context to be freed if the creator has already
+   * abandoned (released) the context too.
+   */
+
+  nxrecorder_release(pRecorder);
+
+  audinfo("Exit\n");
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: nxrecorder_recordinternal
+ *
+ *   nxrecorder_recordinternal() creates the file, writes its header and
+ *   starts the recordthread that fills it from the audio device.
+ *
+ * Returns:
+ *   OK         File is being recorded
+ *   -EBUSY     The media device is busy
+ *   -ENOSYS    The media file is an unsupported type
+ *   -ENODEV    No audio device suitable to record the media type
+ *   -ENOENT    The media file was not found
+ *
+ ****************************************************************************/
+
+static int nxrecorder_recordinternal(FAR struct nxrecorder_s *pRecorder,
+                                     FAR const char *pFilename,
+                                     uint8_t format, uint8_t nchannels,
+                                     uint8_t bpsamp, uint32_t samprate)
+{
+  struct mq_attr           attr;
+  struct sched_param       sparam;
+  pthread_attr_t           tattr;
+  struct audio_caps_desc_s cap_desc;
+  FAR void                 *value;
+  int                      ret;
+
+  DEBUGASSERT(pRecorder != NULL);
+  DEBUGASSERT(pFilename != NULL);
+
+  if (pRecorder->state != NXRECORDER_STATE_IDLE)
+    {
+      return -EBUSY;
+    }
+
+  audinfo("==============================\n");
+  audinfo("Recording file %s\n", pFilename);
+  audinfo("==============================\n");
+
+  pRecorder->format    = format;
+  pRecorder->nchannels = nchannels ? nchannels : 2;
+  pRecorder->bpsamp    = bpsamp ? bpsamp : 16;
+  pRecorder->samprate  = samprate ? samprate : 48000;
+  pRecorder->ndata     = 0;
+
+#ifdef CONFIG_NXRECORDER_ADPCM
+  if (format == NXRECORDER_FMT_ADPCM)
+    {
+      /* The encoder takes 16-bit mono or stereo input.  Use the usual
+       * block sizes: 256 bytes per channel up to 11KHz, 512 up to 22KHz
+       * and 1024 above.
+       */
+
+      if (pRecorder->bpsamp != 16 || pRecorder->nchannels > 2)
+        {
+          return -ENOSYS;
+        }
+
+      pRecorder->adblock  = 256 * pRecorder->nchannels;
+      if (pRecorder->samprate > 11025)
+        {
+          pRecorder->adblock <<= 1;
+        }
+
+      if (pRecorder->samprate > 22050)
+        {
+          pRecorder->adblock <<= 1;
+        }
+
+      pRecorder->adframes = (pRecorder->adblock / pRecorder->nchannels - 4) *
+                            2 + 1;
+      pRecorder->nframes  = 0;
+    }
+#endif
+
+  /* Create the file */
+
+  pRecorder->fd = open(pFilename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (pRecorder->fd == -1)
+    {
+      /* File not found.  Test if its in the mediadir */
+
+        auderr("ERROR: Could not open %s\n", pFilename);
+        return -ENOENT;
+    }
+
+  /* Write the header with the sizes still zero.  It is completed when
+   * the file is closed.
+   */
+
+  ret = nxrecorder_writeheader(pRecorder);
+  if (ret < 0)
+    {
+      goto err_out_nodev;
+    }
+
+  /* Try to open the device */
+
+  ret = nxrecorder_opendevice(pRecorder);
+  if (ret < 0)
+    {
+      /* Error opening the device */
+
+      auderr("ERROR: nxrecorder_opendevice failed: %d\n", ret);
+      goto err_out_nodev;
+    }
+
+  /* Try to reserve the device */
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  ret = ioctl(pRecorder->devFd, AUDIOIOC_RESERVE,
+              (unsigned long)&pRecorder->session);
+#else
+  ret = ioctl(pRecorder->devFd, AUDIOIOC_RESERVE, 0);
+#endif
+  if (ret < 0)
+    {
+      /* Device is busy or error */
+
+      auderr("ERROR: Failed to reserve device: %d\n", ret);
+      ret = -errno;
+      goto err_out;
+    }
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  cap_desc.session = pRecorder->session;
+#endif
+  cap_desc.caps.ac_len = sizeof(struct audio_caps_s);
+  cap_desc.caps.ac_type = AUDIO_TYPE_INPUT;
+  cap_desc.caps.ac_channels = pRecorder->nchannels;
+  cap_desc.caps.ac_controls.hw[0] = pRecorder->samprate;
+  cap_desc.caps.ac_controls.b[3] = pRecorder->samprate >> 16;
+  cap_desc.caps.ac_controls.b[2]  = pRecorder->bpsamp;
+  ret = ioctl(pRecorder->devFd, AUDIOIOC_CONFIGURE,
+              (unsigned long)&cap_desc);
+  if (ret < 0)
+    {
+      ret = -errno;
+      goto err_out;
+    }
+
+  /* Create a message queue for the recordthread */
+
+  attr.mq_maxmsg  = 16;
+  attr.mq_msgsize = sizeof(struct audio_msg_s);
+  attr.mq_curmsgs = 0;
+  attr.mq_flags   = 0;
+
+  snprintf(pRecorder->mqname, sizeof(pRecorder->mqname), "/tmp/%0lx",
+           (unsigned long)((uintptr_t)pRecorder));
+
+  pRecorder->mq = mq_open(pRecorder->mqname, O_RDWR | O_CREAT, 0644, &attr);
+  if (pRecorder->mq == NULL)
+    {
+      /* Unable to open message queue! */
+
+      ret = -errno;
+      auderr("ERROR: mq_open failed: %d\n", ret);
+      goto err_out;
+    }
+
+  /* Register our message queue with the audio device */
+
+  ioctl(pRecorder->devFd, AUDIOIOC_REGISTERMQ, (unsigned long)pRecorder->mq);
+
+  /* Check if there was a previous thread and join it if there was
+   * to perform clean-up.
+   */
+
+  if (pRecorder->recordId != 0)
+    {
+      pthread_join(pRecorder->recordId, &value);
+    }
 
-err_out:
-  audinfo("Clean-up and exit\n");
+  /* Start the writer thread.  Without it the file is written directly by
+   * the recordthread, which the ADPCM encoder cannot do.
+   */
 
-#ifdef CONFIG_AUDIO_DRIVER_SPECIFIC_BUFFERS
-  if (pBuffers != NULL)
+#ifdef CONFIG_NXRECORDER_WRITER
+  ret = nxrecorder_startwriter(pRecorder);
+  if (ret < 0)
     {
-      audinfo("Freeing buffers\n");
-      for (x = 0; x < buf_info.nbuffers; x++)
+#ifdef CONFIG_NXRECORDER_ADPCM
+      if (format == NXRECORDER_FMT_ADPCM)
         {
-          /* Fill in the buffer descriptor struct to issue a free request */
-
-          if (pBuffers[x] != NULL)
-            {
-#ifdef CONFIG_AUDIO_MULTI_SESSION
-              buf_desc.session = pPlayer->session;
-#endif
-              buf_desc.u.pBuffer = pBuffers[x];
-              ioctl(pRecorder->devFd, AUDIOIOC_FREEBUFFER, (unsigned long) &buf_desc);
-            }
+          goto err_out_mq;
         }
-
-      /* Free the pointers to the buffers */
-
-      free(pBuffers);
-    }
-#else
-    audinfo("Freeing buffers\n");
-    for (x = 0; x < CONFIG_AUDIO_NUM_BUFFERS; x++)
-      {
-        /* Fill in the buffer descriptor struct to issue a free request */
-
-        if (pBuffers[x] != NULL)
-          {
-#ifdef CONFIG_AUDIO_MULTI_SESSION
-            buf_desc.session = pPlayer->session;
-#endif
-            buf_desc.u.pBuffer = pBuffers[x];
-            ioctl(pRecorder->devFd, AUDIOIOC_FREEBUFFER, (unsigned long) &buf_desc);
-          }
-      }
 #endif
 
-  /* Unregister the message queue and release the session */
-
-  ioctl(pRecorder->devFd, AUDIOIOC_UNREGISTERMQ, (unsigned long) pRecorder->mq);
-#ifdef CONFIG_AUDIO_MULTI_SESSION
-  ioctl(pRecorder->devFd, AUDIOIOC_RELEASE, (unsigned long) pRecorder->session);
-#else
-  ioctl(pRecorder->devFd, AUDIOIOC_RELEASE, 0);
+      auderr("ERROR: Writer not started, writing directly: %d\n", ret);
+    }
 #endif
 
-  /* Cleanup */
+  /* Start the recordfile thread to stream the media file to the
+   * audio device.
+   */
 
-  while (sem_wait(&pRecorder->sem) < 0)
-    {
-    }
+  pthread_attr_init(&tattr);
+  sparam.sched_priority = sched_get_priority_max(SCHED_FIFO) - 9;
+  (void)pthread_attr_setschedparam(&tattr, &sparam);
+  (void)pthread_attr_setstacksize(&tattr,
+                                  CONFIG_NXRECORDER_RECORDTHREAD_STACKSIZE);
 
-  /* Close the files */
+  /* Add a reference count to the recorder for the thread and start the
+   * thread.  We increment for the thread to avoid thread start-up
+   * race conditions.
+   */
 
-  if (0 < pRecorder->fd)
+  nxrecorder_reference(pRecorder);
+  ret = pthread_create(&pRecorder->recordId, &tattr, nxrecorder_recordthread,
+                       (pthread_addr_t) pRecorder);
+  if (ret != OK)
     {
-      close(pRecorder->fd);                 /* Close the file */
-      pRecorder->fd = -1;                   /* Clear out the FD */
+      auderr("ERROR: Failed to create recordthread: %d\n", ret);
+      ret = -ret;
+      goto err_out_mq;
     }
 
-  close(pRecorder->devFd);                  /* Close the device */
-  pRecorder->devFd = -1;                    /* Mark device as closed */
-  mq_close(pRecorder->mq);                  /* Close the message queue */
-  mq_unlink(pRecorder->mqname);             /* Unlink the message queue */
-  pRecorder->state = NXRECORDER_STATE_IDLE; /* Go to IDLE */
+  /* Name the thread */
 
-  sem_post(&pRecorder->sem);                /* Release the semaphore */
+  pthread_setname_np(pRecorder->recordId, "recordthread");
+  return OK;
 
-  /* The record thread is done with the context.  Release it, which may
-   * actually cause the context to be freed if the creator has already
-   * abandoned (released) the context too.
-   */
+err_out_mq:
+  ioctl(pRecorder->devFd, AUDIOIOC_UNREGISTERMQ, (unsigned long)pRecorder->mq);
+  mq_close(pRecorder->mq);
+  mq_unlink(pRecorder->mqname);
+  pRecorder->mq = NULL;
 
-  nxrecorder_release(pRecorder);
+err_out:
+  close(pRecorder->devFd);
+  pRecorder->devFd = -1;
 
-  audinfo("Exit\n");
+err_out_nodev:
+  if (0 < pRecorder->fd)
+    {
+      nxrecorder_closefile(pRecorder);
+    }
 
-  return NULL;
+  return ret;
 }
 
 /****************************************************************************
@@ -815,155 +1899,62 @@ int nxrecorder_recordraw(FAR struct nxrecorder_s *pRecorder,
                          FAR const char *pFilename, uint8_t nchannels,
                          uint8_t bpsamp, uint32_t samprate)
 {
-  struct mq_attr           attr;
-  struct sched_param       sparam;
-  pthread_attr_t           tattr;
-  struct audio_caps_desc_s cap_desc;
-  FAR void                 *value;
-  int                      ret;
-
-  DEBUGASSERT(pRecorder != NULL);
-  DEBUGASSERT(pFilename != NULL);
-
-  if (pRecorder->state != NXRECORDER_STATE_IDLE)
-    {
-      return -EBUSY;
-    }
-
-  audinfo("==============================\n");
-  audinfo("Recording file %s\n", pFilename);
-  audinfo("==============================\n");
-
-  /* Test that the specified file exists */
-
-  if ((pRecorder->fd = open(pFilename, O_WRONLY | O_CREAT)) == -1)
-    {
-      /* File not found.  Test if its in the mediadir */
-
-        auderr("ERROR: Could not open %s\n", pFilename);
-        return -ENOENT;
-    }
-
-  /* Try to open the device */
-
-  ret = nxrecorder_opendevice(pRecorder);
-  if (ret < 0)
-    {
-      /* Error opening the device */
-
-      auderr("ERROR: nxrecorder_opendevice failed: %d\n", ret);
-      goto err_out_nodev;
-    }
+  return nxrecorder_recordinternal(pRecorder, pFilename, NXRECORDER_FMT_RAW,
+                                   nchannels, bpsamp, samprate);
+}
 
-  /* Try to reserve the device */
+/****************************************************************************
+ * Name: nxrecorder_recordwav
+ *
+ *   nxrecorder_recordwav() records like nxrecorder_recordraw() but stores
+ *   the data in a RIFF/WAVE file.
+ *
+ ****************************************************************************/
 
-#ifdef CONFIG_AUDIO_MULTI_SESSION
-  ret = ioctl(pRecorder->devFd, AUDIOIOC_RESERVE,
-              (unsigned long)&pRecorder->session);
-#else
-  ret = ioctl(pRecorder->devFd, AUDIOIOC_RESERVE, 0);
-#endif
-  if (ret < 0)
-    {
-      /* Device is busy or error */
+int nxrecorder_recordwav(FAR struct nxrecorder_s *pRecorder,
+                         FAR const char *pFilename, uint8_t nchannels,
+                         uint8_t bpsamp, uint32_t samprate)
+{
+  return nxrecorder_recordinternal(pRecorder, pFilename, NXRECORDER_FMT_WAV,
+                                   nchannels, bpsamp, samprate);
+}
 
-      auderr("ERROR: Failed to reserve device: %d\n", ret);
-      ret = -errno;
-      goto err_out;
-    }
+/****************************************************************************
+ * Name: nxrecorder_recordadpcm
+ *
+ *   nxrecorder_recordadpcm() records 16-bit data and stores it IMA ADPCM
+ *   encoded in a RIFF/WAVE file.
+ *
+ ****************************************************************************/
 
-#ifdef CONFIG_AUDIO_MULTI_SESSION
-  cap_desc.session = pRecorder->session;
+#ifdef CONFIG_NXRECORDER_ADPCM
+int nxrecorder_recordadpcm(FAR struct nxrecorder_s *pRecorder,
+                           FAR const char *pFilename, uint8_t nchannels,
+                           uint32_t samprate)
+{
+  return nxrecorder_recordinternal(pRecorder, pFilename,
+                                   NXRECORDER_FMT_ADPCM, nchannels, 16,
+                                   samprate);
+}
 #endif
-  cap_desc.caps.ac_len = sizeof(struct audio_caps_s);
-  cap_desc.caps.ac_type = AUDIO_TYPE_INPUT;
-  cap_desc.caps.ac_channels = nchannels ? nchannels : 2;
-  cap_desc.caps.ac_controls.hw[0] = samprate ? samprate : 48000;
-  cap_desc.caps.ac_controls.b[3] = samprate >> 16;
-  cap_desc.caps.ac_controls.b[2]  = bpsamp ? bpsamp : 16;
-  ret = ioctl(pRecorder->devFd, AUDIOIOC_CONFIGURE,
-              (unsigned long)&cap_desc);
-  if (ret < 0)
-    {
-      ret = -errno;
-      goto err_out;
-    }
-
-  /* Create a message queue for the recordthread */
-
-  attr.mq_maxmsg  = 16;
-  attr.mq_msgsize = sizeof(struct audio_msg_s);
-  attr.mq_curmsgs = 0;
-  attr.mq_flags   = 0;
-
-  snprintf(pRecorder->mqname, sizeof(pRecorder->mqname), "/tmp/%0lx",
-           (unsigned long)((uintptr_t)pRecorder));
-
-  pRecorder->mq = mq_open(pRecorder->mqname, O_RDWR | O_CREAT, 0644, &attr);
-  if (pRecorder->mq == NULL)
-    {
-      /* Unable to open message queue! */
 
-      ret = -errno;
-      auderr("ERROR: mq_open failed: %d\n", ret);
-      goto err_out;
-    }
-
-  /* Register our message queue with the audio device */
-
-  ioctl(pRecorder->devFd, AUDIOIOC_REGISTERMQ, (unsigned long)pRecorder->mq);
-
-  /* Check if there was a previous thread and join it if there was
-   * to perform clean-up.
-   */
-
-  if (pRecorder->recordId != 0)
-    {
-      pthread_join(pRecorder->recordId, &value);
-    }
-
-  /* Start the recordfile thread to stream the media file to the
-   * audio device.
-   */
-
-  pthread_attr_init(&tattr);
-  sparam.sched_priority = sched_get_priority_max(SCHED_FIFO) - 9;
-  (void)pthread_attr_setschedparam(&tattr, &sparam);
-  (void)pthread_attr_setstacksize(&tattr,
-                                  CONFIG_NXRECORDER_RECORDTHREAD_STACKSIZE);
-
-  /* Add a reference count to the recorder for the thread and start the
-   * thread.  We increment for the thread to avoid thread start-up
-   * race conditions.
-   */
-
-  nxrecorder_reference(pRecorder);
-  ret = pthread_create(&pRecorder->recordId, &tattr, nxrecorder_recordthread,
-                       (pthread_addr_t) pRecorder);
-  if (ret != OK)
-    {
-      auderr("ERROR: Failed to create recordthread: %d\n", ret);
-      goto err_out;
-    }
+/****************************************************************************
+ * Name: nxrecorder_getstats
+ *
+ *   nxrecorder_getstats() returns the writer statistics.
+ *
+ ****************************************************************************/
 
-  /* Name the thread */
+#ifdef CONFIG_NXRECORDER_WRITER
+int nxrecorder_getstats(FAR struct nxrecorder_s *pRecorder,
+                        FAR struct nxrecorder_stats_s *stats)
+{
+  DEBUGASSERT(pRecorder != NULL && stats != NULL);
 
-  pthread_setname_np(pRecorder->recordId, "recordthread");
+  memcpy(stats, &pRecorder->stats, sizeof(struct nxrecorder_stats_s));
   return OK;
-
-err_out:
-  close(pRecorder->devFd);
-  pRecorder->devFd = -1;
-
-err_out_nodev:
-  if (0 < pRecorder->fd)
-    {
-      close(pRecorder->fd);
-      pRecorder->fd = -1;
-    }
-
-  return ret;
 }
+#endif
 
 /****************************************************************************
  * Name: nxrecorder_create
@@ -1000,6 +1991,18 @@ FAR struct nxrecorder_s *nxrecorder_create(void)
   pRecorder->mq = NULL;
   pRecorder->recordId = 0;
   pRecorder->crefs = 1;
+  pRecorder->format = NXRECORDER_FMT_RAW;
+
+#ifdef CONFIG_NXRECORDER_WRITER
+  pRecorder->wrbuf = NULL;
+  pRecorder->wrout = NULL;
+  memset(&pRecorder->stats, 0, sizeof(struct nxrecorder_stats_s));
+#endif
+
+#ifdef CONFIG_NXRECORDER_ADPCM
+  pRecorder->adin = NULL;
+  pRecorder->adout = NULL;
+#endif
 
 #ifdef CONFIG_AUDIO_MULTI_SESSION
   pRecorder->session = NULL;
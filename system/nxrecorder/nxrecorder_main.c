@@ -81,6 +81,10 @@ struct mp_cmd_s
 
 static int nxrecorder_cmd_quit(FAR struct nxrecorder_s *pRecorder, char *parg);
 static int nxrecorder_cmd_recordraw(FAR struct nxrecorder_s *pRecorder, char *parg);
+static int nxrecorder_cmd_recordwav(FAR struct nxrecorder_s *pRecorder, char *parg);
+#ifdef CONFIG_NXRECORDER_ADPCM
+static int nxrecorder_cmd_recordadpcm(FAR struct nxrecorder_s *pRecorder, char *parg);
+#endif
 static int nxrecorder_cmd_device(FAR struct nxrecorder_s *pRecorder, char *parg);
 
 #ifndef CONFIG_AUDIO_EXCLUDE_PAUSE_RESUME
@@ -88,6 +92,10 @@ static int nxrecorder_cmd_pause(FAR struct nxrecorder_s *pRecorder, char *parg);
 static int nxrecorder_cmd_resume(FAR struct nxrecorder_s *pRecorder, char *parg);
 #endif
 
+#ifdef CONFIG_NXRECORDER_WRITER
+static int nxrecorder_cmd_stats(FAR struct nxrecorder_s *pRecorder, char *parg);
+#endif
+
 #ifndef CONFIG_AUDIO_EXCLUDE_STOP
 static int nxrecorder_cmd_stop(FAR struct nxrecorder_s *pRecorder, char *parg);
 #endif
@@ -108,10 +116,17 @@ static const struct mp_cmd_s g_nxrecorder_cmds[] =
   { "help",      "",         nxrecorder_cmd_help,      NXRECORDER_HELP_TEXT(Display help for commands) },
 #endif
   { "recordraw", "filename", nxrecorder_cmd_recordraw, NXRECORDER_HELP_TEXT(Record a pcm raw file) },
+  { "recordwav", "filename", nxrecorder_cmd_recordwav, NXRECORDER_HELP_TEXT(Record a pcm wav file) },
+#ifdef CONFIG_NXRECORDER_ADPCM
+  { "recordadpcm", "filename", nxrecorder_cmd_recordadpcm, NXRECORDER_HELP_TEXT(Record an IMA ADPCM wav file) },
+#endif
 #ifndef CONFIG_AUDIO_EXCLUDE_PAUSE_RESUME
   { "pause",     "",         nxrecorder_cmd_pause,     NXRECORDER_HELP_TEXT(Pause record) },
   { "resume",    "",         nxrecorder_cmd_resume,    NXRECORDER_HELP_TEXT(Resume record) },
 #endif
+#ifdef CONFIG_NXRECORDER_WRITER
+  { "stats",     "",         nxrecorder_cmd_stats,     NXRECORDER_HELP_TEXT(Show writer statistics) },
+#endif
 #ifndef CONFIG_AUDIO_EXCLUDE_STOP
   { "stop",      "",         nxrecorder_cmd_stop,      NXRECORDER_HELP_TEXT(Stop record) },
 #endif
@@ -126,14 +141,15 @@ static const int g_nxrecorder_cmd_count = sizeof(g_nxrecorder_cmds) / sizeof(str
  ****************************************************************************/
 
 /****************************************************************************
- * Name: nxrecorder_cmd_recordraw
+ * Name: nxrecorder_record
  *
- *   nxrecorder_cmd_recordraw() records the raw data file using the nxrecorder
- *   context.
+ *   nxrecorder_record() parses the arguments of the record commands, starts
+ *   the recording in the requested format and reports any error.
  *
  ****************************************************************************/
 
-static int nxrecorder_cmd_recordraw(FAR struct nxrecorder_s *pRecorder, char *parg)
+static int nxrecorder_record(FAR struct nxrecorder_s *pRecorder, char *parg,
+                             int format)
 {
   int ret;
   int channels = 0;
@@ -145,7 +161,26 @@ static int nxrecorder_cmd_recordraw(FAR struct nxrecorder_s *pRecorder, char *pa
 
   /* Try to record the file specified */
 
-  ret = nxrecorder_recordraw(pRecorder, filename, channels, bpsamp, samprate);
+  switch (format)
+    {
+      case NXRECORDER_FMT_WAV:
+        ret = nxrecorder_recordwav(pRecorder, filename, channels, bpsamp,
+                                   samprate);
+        break;
+
+#ifdef CONFIG_NXRECORDER_ADPCM
+      case NXRECORDER_FMT_ADPCM:
+        /* There is no bit width argument, the encoder takes 16-bit data */
+
+        ret = nxrecorder_recordadpcm(pRecorder, filename, channels, bpsamp);
+        break;
+#endif
+
+      default:
+        ret = nxrecorder_recordraw(pRecorder, filename, channels, bpsamp,
+                                   samprate);
+        break;
+    }
 
   /* nxrecorder_recordfile returned values:
    *
@@ -185,6 +220,76 @@ static int nxrecorder_cmd_recordraw(FAR struct nxrecorder_s *pRecorder, char *pa
   return ret;
 }
 
+/****************************************************************************
+ * Name: nxrecorder_cmd_recordraw
+ *
+ *   nxrecorder_cmd_recordraw() records the raw data file using the nxrecorder
+ *   context.
+ *
+ ****************************************************************************/
+
+static int nxrecorder_cmd_recordraw(FAR struct nxrecorder_s *pRecorder, char *parg)
+{
+  return nxrecorder_record(pRecorder, parg, NXRECORDER_FMT_RAW);
+}
+
+/****************************************************************************
+ * Name: nxrecorder_cmd_recordwav
+ *
+ *   nxrecorder_cmd_recordwav() records a WAV file using the nxrecorder
+ *   context.
+ *
+ ****************************************************************************/
+
+static int nxrecorder_cmd_recordwav(FAR struct nxrecorder_s *pRecorder, char *parg)
+{
+  return nxrecorder_record(pRecorder, parg, NXRECORDER_FMT_WAV);
+}
+
+/****************************************************************************
+ * Name: nxrecorder_cmd_recordadpcm
+ *
+ *   nxrecorder_cmd_recordadpcm() records an IMA ADPCM WAV file using the
+ *   nxrecorder context.  The arguments are the file name, the number of
+ *   channels and the sample rate.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_ADPCM
+static int nxrecorder_cmd_recordadpcm(FAR struct nxrecorder_s *pRecorder, char *parg)
+{
+  return nxrecorder_record(pRecorder, parg, NXRECORDER_FMT_ADPCM);
+}
+#endif
+
+/****************************************************************************
+ * Name: nxrecorder_cmd_stats
+ *
+ *   nxrecorder_cmd_stats() displays the writer statistics of the current
+ *   or last recording.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXRECORDER_WRITER
+static int nxrecorder_cmd_stats(FAR struct nxrecorder_s *pRecorder, char *parg)
+{
+  struct nxrecorder_stats_s stats;
+
+  nxrecorder_getstats(pRecorder, &stats);
+
+  printf("bytes captured: %lu  written: %lu\n",
+         (unsigned long)stats.nbytes, (unsigned long)stats.nwritten);
+  printf("buffer size:    %lu  max fill: %lu\n",
+         (unsigned long)stats.bufsize, (unsigned long)stats.maxfill);
+  printf("dropped:        %lu\n", (unsigned long)stats.dropped);
+  printf("writes:         %lu\n", (unsigned long)stats.nwrites);
+  printf("write (msec):   max %lu  total %lu\n",
+         (unsigned long)stats.writemax, (unsigned long)stats.writetotal);
+
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: nxrecorder_cmd_stop
  *
@@ -51,6 +51,7 @@
 #include <debug.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <syslog.h>
 
 #include "tcurses_priv.h"
 #include "graphics/curses.h"
@@ -69,6 +70,15 @@
 #define KEY_HOME        0x106  /* home key */
 #define KEY_F0          0x108  /* function keys; 64 reserved */
 
+#ifndef CONFIG_SYSTEM_TERMCURSES_VT100_OUTBUFSIZE
+#  define CONFIG_SYSTEM_TERMCURSES_VT100_OUTBUFSIZE 256
+#endif
+
+/* Attributes that are sent with the SGR (Select Graphic Rendition) sequence */
+
+#define VT100_SGR_ATTRIBS (TCURS_ATTRIB_BOLD | TCURS_ATTRIB_BLINK | \
+                           TCURS_ATTRIB_UNDERLINE)
+
 #ifdef CONFIG_TERMINFO_INCLUDE_NAME
 #define TINFO_ENTRY(n, d, c)  n, d, c
 #else
@@ -89,6 +99,27 @@ struct tcurses_vt100_s
   int    out_fd;
   int    keycount;
   char   keybuf[16];
+
+  /* Terminal state as last sent, used to suppress redundant escape
+   * sequences.  A value of -1 means that the state is not known.
+   */
+
+  int    row;                      /* Cursor row */
+  int    col;                      /* Cursor column */
+  int    fgcolor;                  /* Foreground color index */
+  int    bgcolor;                  /* Background color index */
+  long   attrib;                   /* SGR and character set attributes */
+  int    cursor;                   /* 0=Hidden 1=Visible */
+
+  /* Buffered output */
+
+  int    outlen;
+  char   outbuf[CONFIG_SYSTEM_TERMCURSES_VT100_OUTBUFSIZE];
+
+#ifdef CONFIG_SYSTEM_TERMCURSES_STATS
+  unsigned long nbytes;            /* Bytes sent to the terminal */
+  unsigned long nwrites;           /* Number of write() calls */
+#endif
 };
 
 /************************************************************************************
@@ -108,6 +139,10 @@ static int tcurses_vt100_setattributes(FAR struct termcurses_s *dev,
 static int tcurses_vt100_getkeycode(FAR struct termcurses_s *dev,
               FAR int *specialkey, FAR int *keymodifers);
 static bool tcurses_vt100_checkkey(FAR struct termcurses_s *dev);
+static int tcurses_vt100_write(FAR struct termcurses_s *dev,
+              FAR const char *buffer, size_t buflen);
+static int tcurses_vt100_flush(FAR struct termcurses_s *dev);
+static int tcurses_vt100_terminate(FAR struct termcurses_s *dev);
 
 /************************************************************************************
  * Private Data
@@ -122,7 +157,10 @@ static const struct termcurses_ops_s g_vt100_ops =
   tcurses_vt100_setcolors,
   tcurses_vt100_setattributes,
   tcurses_vt100_getkeycode,
-  tcurses_vt100_checkkey
+  tcurses_vt100_checkkey,
+  tcurses_vt100_write,
+  tcurses_vt100_flush,
+  tcurses_vt100_terminate
 };
 
 /* VT100 terminal codes */
@@ -132,17 +170,22 @@ static const char *g_clreos         = "\033[J";       /* Clear to end of screen
 static const char *g_clreol         = "\033[K";       /* Clear to end of line */
 
 static const char *g_movecurs       = "\033[%d;%dH";  /* Move cursor to x,y */
+static const char *g_movehome       = "\033[H";      /* Move cursor to 0,0 */
 static const char *g_getwinsize     = "\x1b[s\x1b[999;999H\x1b[6n\x1bu";
 static const char *g_setfgcolor     = "\x1b[38;5;%dm";
 static const char *g_setbgcolor     = "\x1b[48;5;%dm";
+static const char *g_setfgbgcolor   = "\x1b[38;5;%d;48;5;%dm";
 static const char *g_showcursor     = "\x1b[?25h";
 static const char *g_hidecursor     = "\x1b[?25l";
-static const char *g_setbold        = "\x1b[1";
-static const char *g_setnobold      = "\x1b[22";
-static const char *g_setblink       = ";5";
-static const char *g_setnoblink     = ";25";
-static const char *g_setunderline   = ";4";
-static const char *g_setnounderline = ";24";
+static const char *g_setrendition   = "\x1b[";
+static const char *g_setbold        = "1;";
+static const char *g_setnobold      = "22;";
+static const char *g_setblink       = "5;";
+static const char *g_setnoblink     = "25;";
+static const char *g_setunderline   = "4;";
+static const char *g_setnounderline = "24;";
+static const char *g_setaltcharset  = "\x1b(0";
+static const char *g_setnoaltcharset = "\x1b(B";
 
 struct keycodes_s
 {
@@ -382,6 +425,99 @@ struct termcurses_dev_s g_vt100_tcurs =
  * Private Functions
  ************************************************************************************/
 
+/************************************************************************************
+ * Output buffering
+ ************************************************************************************/
+
+/************************************************************************************
+ * Send all buffered output to the terminal.
+ ************************************************************************************/
+
+static int tcurses_vt100_flushout(FAR struct tcurses_vt100_s *priv)
+{
+  FAR const char *ptr = priv->outbuf;
+  int remaining = priv->outlen;
+  ssize_t nwritten;
+
+  while (remaining > 0)
+    {
+      nwritten = write(priv->out_fd, ptr, remaining);
+      if (nwritten < 0)
+        {
+          int errcode = errno;
+          if (errcode != EINTR)
+            {
+              priv->outlen = 0;
+              return -errcode;
+            }
+        }
+      else
+        {
+          ptr       += nwritten;
+          remaining -= nwritten;
+        }
+    }
+
+#ifdef CONFIG_SYSTEM_TERMCURSES_STATS
+  if (priv->outlen > 0)
+    {
+      priv->nbytes += priv->outlen;
+      priv->nwrites++;
+    }
+#endif
+
+  priv->outlen = 0;
+  return OK;
+}
+
+/************************************************************************************
+ * Add bytes to the output buffer, sending the buffer first if they don't fit.
+ ************************************************************************************/
+
+static int tcurses_vt100_out(FAR struct tcurses_vt100_s *priv,
+                             FAR const char *buffer, size_t buflen)
+{
+  int ret;
+
+  while (buflen > 0)
+    {
+      size_t nbytes = CONFIG_SYSTEM_TERMCURSES_VT100_OUTBUFSIZE - priv->outlen;
+
+      if (nbytes == 0)
+        {
+          ret = tcurses_vt100_flushout(priv);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          continue;
+        }
+
+      if (nbytes > buflen)
+        {
+          nbytes = buflen;
+        }
+
+      memcpy(&priv->outbuf[priv->outlen], buffer, nbytes);
+      priv->outlen += nbytes;
+      buffer       += nbytes;
+      buflen       -= nbytes;
+    }
+
+  return OK;
+}
+
+/************************************************************************************
+ * Add a NUL terminated escape sequence to the output buffer.
+ ************************************************************************************/
+
+static int tcurses_vt100_outstr(FAR struct tcurses_vt100_s *priv,
+                                FAR const char *str)
+{
+  return tcurses_vt100_out(priv, str, strlen(str));
+}
+
 /************************************************************************************
  * Clear screen / line operations
  ************************************************************************************/
@@ -389,43 +525,28 @@ struct termcurses_dev_s g_vt100_tcurs =
 static int tcurses_vt100_clear(FAR struct termcurses_s *dev, int type)
 {
   FAR struct tcurses_vt100_s *priv;
-  int ret = -ENOSYS;
-  int fd;
 
   priv = (FAR struct tcurses_vt100_s *) dev;
-  fd = priv->out_fd;
 
   /* Perform operation based on type */
 
   switch (type)
     {
       case TCURS_CLEAR_SCREEN:
-        ret = write(fd, g_clrscr, strlen(g_clrscr));
-        break;
+        return tcurses_vt100_outstr(priv, g_clrscr);
 
       case TCURS_CLEAR_LINE:
-        break;
+        return -ENOSYS;
 
       case TCURS_CLEAR_EOS:
-        ret = write(fd, g_clrscr, strlen(g_clreos));
-        break;
+        return tcurses_vt100_outstr(priv, g_clreos);
 
       case TCURS_CLEAR_EOL:
-        ret = write(fd, g_clrscr, strlen(g_clreol));
-        break;
+        return tcurses_vt100_outstr(priv, g_clreol);
 
       default:
         return -ENOSYS;
     }
-
-  /* If data written successfully, return OK */
-
-  if (ret > 0)
-    {
-      ret = OK;
-    }
-
-  return ret;
 }
 
 /************************************************************************************
@@ -436,34 +557,53 @@ static int tcurses_vt100_move(FAR struct termcurses_s *dev, int type, int col,
                               int row)
 {
   FAR struct tcurses_vt100_s *priv;
-  int   ret = -ENOSYS;
-  int   fd;
   char  str[16];
 
   priv = (FAR struct tcurses_vt100_s *)dev;
-  fd   = priv->out_fd;
 
   /* Perform operation based on type */
 
   switch (type)
     {
       case TCURS_MOVE_YX:
-        sprintf(str, g_movecurs, row+1, col+1);
-        ret = write(fd, str, strlen(str));
         break;
 
       default:
         return -ENOSYS;
     }
 
-  /* If bytes written, return OK */
+  /* Nothing to do if the cursor is already there */
 
-  if (ret > 0)
+  if (row == priv->row && col == priv->col)
     {
-      ret = OK;
+      return OK;
     }
 
-  return ret;
+  /* Use the shortest sequence that gets there.  CR and LF are only used
+   * relative to a known cursor position.
+   */
+
+  if (col == 0 && row == priv->row)
+    {
+      strcpy(str, "\r");
+    }
+  else if (col == 0 && priv->row >= 0 && row == priv->row + 1)
+    {
+      strcpy(str, "\r\n");
+    }
+  else if (col == 0 && row == 0)
+    {
+      strcpy(str, g_movehome);
+    }
+  else
+    {
+      snprintf(str, sizeof(str), g_movecurs, row + 1, col + 1);
+    }
+
+  priv->row = row;
+  priv->col = col;
+
+  return tcurses_vt100_outstr(priv, str);
 }
 
 /************************************************************************************
@@ -560,21 +700,22 @@ static int tcurses_vt100_setcolors(FAR struct termcurses_s *dev,
                                    FAR struct termcurses_colors_s *colors)
 {
   FAR struct tcurses_vt100_s *priv;
-  int  ret = -ENOSYS;
-  int  fd;
+  int  fgcolor = -1;
+  int  bgcolor = -1;
   char str[48];
 
   priv = (FAR struct tcurses_vt100_s *) dev;
-  fd   = priv->out_fd;
 
   /* Test if FG color to be set */
 
   if ((colors->color_mask & TCURS_COLOR_FG) != 0)
     {
-      sprintf(str, g_setfgcolor,
-              tcurses_vt100_getcolorindex(colors->fg_red, colors->fg_green,
-                                          colors->fg_blue));
-      ret = write(fd, str, strlen(str));
+      fgcolor = tcurses_vt100_getcolorindex(colors->fg_red, colors->fg_green,
+                                            colors->fg_blue);
+      if (fgcolor == priv->fgcolor)
+        {
+          fgcolor = -1;
+        }
     }
 
   /* Test if BG color to be set */
@@ -586,20 +727,46 @@ static int tcurses_vt100_setcolors(FAR struct termcurses_s *dev,
           colors->bg_red = 0;
         }
 
-      sprintf(str, g_setbgcolor,
-              tcurses_vt100_getcolorindex(colors->bg_red, colors->bg_green,
-                                          colors->bg_blue));
-      ret = write(fd, str, strlen(str));
+      bgcolor = tcurses_vt100_getcolorindex(colors->bg_red, colors->bg_green,
+                                            colors->bg_blue);
+      if (bgcolor == priv->bgcolor)
+        {
+          bgcolor = -1;
+        }
     }
 
-  /* If bytes written, return OK */
+  /* Send both colors in one sequence if both changed */
 
-  if (ret > 0)
+  if (fgcolor >= 0 && bgcolor >= 0)
+    {
+      snprintf(str, sizeof(str), g_setfgbgcolor, fgcolor, bgcolor);
+    }
+  else if (fgcolor >= 0)
+    {
+      snprintf(str, sizeof(str), g_setfgcolor, fgcolor);
+    }
+  else if (bgcolor >= 0)
     {
-      ret = OK;
+      snprintf(str, sizeof(str), g_setbgcolor, bgcolor);
     }
+  else
+    {
+      /* The terminal already has these colors */
 
-  return ret;
+      return OK;
+    }
+
+  if (fgcolor >= 0)
+    {
+      priv->fgcolor = fgcolor;
+    }
+
+  if (bgcolor >= 0)
+    {
+      priv->bgcolor = bgcolor;
+    }
+
+  return tcurses_vt100_outstr(priv, str);
 }
 
 /************************************************************************************
@@ -628,10 +795,18 @@ static int tcurses_vt100_getwinsize(FAR struct termcurses_s *dev,
       return OK;
     }
 
-  /* Write command to get window size */
+  /* Write command to get window size.  This also moves the cursor. */
+
+  priv->row = -1;
+  priv->col = -1;
+
+  ret = tcurses_vt100_outstr(priv, g_getwinsize);
+  if (ret >= 0)
+    {
+      ret = tcurses_vt100_flushout(priv);
+    }
 
-  ret = write(fd, g_getwinsize, strlen(g_getwinsize));
-  if (ret <= 0)
+  if (ret < 0)
     {
       return ret;
     }
@@ -707,12 +882,11 @@ static int tcurses_vt100_setattributes(FAR struct termcurses_s *dev,
                                        unsigned long attrib)
 {
   FAR struct tcurses_vt100_s *priv;
+  unsigned long changed;
   int ret;
-  int fd;
   char str[48];
 
   priv = (FAR struct tcurses_vt100_s *) dev;
-  fd   = priv->out_fd;
 
   /* Test for cursor hide */
 
@@ -720,56 +894,85 @@ static int tcurses_vt100_setattributes(FAR struct termcurses_s *dev,
     {
       /* Send sequence to hide the cursor */
 
-      ret = write(fd, g_hidecursor, strlen(g_hidecursor));
-      return ret;
+      if (priv->cursor == 0)
+        {
+          return OK;
+        }
+
+      priv->cursor = 0;
+      return tcurses_vt100_outstr(priv, g_hidecursor);
     }
 
   if (attrib & TCURS_ATTRIB_CURS_SHOW)
     {
-      /* Send sequence to hide the cursor */
+      /* Send sequence to show the cursor */
 
-      ret = write(fd, g_showcursor, strlen(g_showcursor));
-      return ret;
+      if (priv->cursor == 1)
+        {
+          return OK;
+        }
+
+      priv->cursor = 1;
+      return tcurses_vt100_outstr(priv, g_showcursor);
     }
 
-  /* Build attribute string */
+  /* Select the character set if it changed */
 
-  if (attrib & TCURS_ATTRIB_BOLD)
-    {
-      strcpy(str, g_setbold);
-    }
-  else
+  if (priv->attrib < 0 ||
+      ((attrib ^ priv->attrib) & TCURS_ATTRIB_ALTCHARSET) != 0)
     {
-      strcpy(str, g_setnobold);
+      ret = tcurses_vt100_outstr(priv, (attrib & TCURS_ATTRIB_ALTCHARSET) ?
+                                 g_setaltcharset : g_setnoaltcharset);
+      if (ret < 0)
+        {
+          return ret;
+        }
     }
 
-  if (attrib & TCURS_ATTRIB_BLINK)
+  /* Only the renditions that changed need to be sent.  All of them are sent
+   * if the terminal state is not known.
+   */
+
+  if (priv->attrib < 0)
     {
-      strcat(str, g_setblink);
+      changed = VT100_SGR_ATTRIBS;
     }
   else
     {
-      strcat(str, g_setnoblink);
+      changed = (attrib ^ priv->attrib) & VT100_SGR_ATTRIBS;
     }
 
-  if (attrib & TCURS_ATTRIB_UNDERLINE)
-    {
-      strcat(str, g_setunderline);
-    }
-  else
+  priv->attrib = attrib & (VT100_SGR_ATTRIBS | TCURS_ATTRIB_ALTCHARSET);
+
+  if (changed == 0)
     {
-      strcat(str, g_setnounderline);
+      return OK;
     }
 
-  strcat(str, "m");
+  /* Build attribute string.  The ';' after the last parameter is replaced
+   * with the final 'm'.
+   */
 
-  ret = write(fd, str, strlen(str));
+  strcpy(str, g_setrendition);
 
-  /* If bytes written, return OK */
+  if (changed & TCURS_ATTRIB_BOLD)
+    {
+      strcat(str, (attrib & TCURS_ATTRIB_BOLD) ? g_setbold : g_setnobold);
+    }
 
-  ret = (ret > 0) ? OK : -ENOSYS;
+  if (changed & TCURS_ATTRIB_BLINK)
+    {
+      strcat(str, (attrib & TCURS_ATTRIB_BLINK) ? g_setblink : g_setnoblink);
+    }
 
-  return ret;
+  if (changed & TCURS_ATTRIB_UNDERLINE)
+    {
+      strcat(str, (attrib & TCURS_ATTRIB_UNDERLINE) ?
+                  g_setunderline : g_setnounderline);
+    }
+
+  str[strlen(str) - 1] = 'm';
+  return tcurses_vt100_outstr(priv, str);
 }
 
 /************************************************************************************
@@ -811,6 +1014,10 @@ static int tcurses_vt100_getkeycode(FAR struct termcurses_s *dev, FAR int *speci
   priv = (FAR struct tcurses_vt100_s *) dev;
   fd   = priv->in_fd;
 
+  /* Send any pending output before waiting for input */
+
+  tcurses_vt100_flush(dev);
+
   /* Watch stdin (fd 0) to see when it has input. */
 
   FD_ZERO(&rfds);
@@ -1085,6 +1292,10 @@ static bool tcurses_vt100_checkkey(FAR struct termcurses_s *dev)
       return true;
     }
 
+  /* Send any pending output before polling for input */
+
+  tcurses_vt100_flush(dev);
+
   /* Watch stdin (fd 0) to see when it has input. */
 
   FD_ZERO(&rfds);
@@ -1104,6 +1315,69 @@ static bool tcurses_vt100_checkkey(FAR struct termcurses_s *dev)
   return false;
 }
 
+/************************************************************************************
+ * Write text at the current cursor position
+ ************************************************************************************/
+
+static int tcurses_vt100_write(FAR struct termcurses_s *dev,
+                               FAR const char *buffer, size_t buflen)
+{
+  FAR struct tcurses_vt100_s *priv = (FAR struct tcurses_vt100_s *) dev;
+
+  /* The cursor advances with the text.  The terminal handles wrapping, so
+   * the position is no longer known once the text reaches the right margin,
+   * but any later move to a different position will still be sent.
+   */
+
+  if (priv->col >= 0)
+    {
+      priv->col += buflen;
+    }
+
+  return tcurses_vt100_out(priv, buffer, buflen);
+}
+
+/************************************************************************************
+ * Send all buffered output to the terminal
+ ************************************************************************************/
+
+static int tcurses_vt100_flush(FAR struct termcurses_s *dev)
+{
+  FAR struct tcurses_vt100_s *priv = (FAR struct tcurses_vt100_s *) dev;
+  int ret;
+
+  ret = tcurses_vt100_flushout(priv);
+
+  /* Other writers to the terminal (and echo of typed characters) may move
+   * the cursor between updates, so its position is only trusted until the
+   * output is flushed.
+   */
+
+  priv->row = -1;
+  priv->col = -1;
+
+  return ret;
+}
+
+/************************************************************************************
+ * Send remaining output and report statistics before the instance is freed
+ ************************************************************************************/
+
+static int tcurses_vt100_terminate(FAR struct termcurses_s *dev)
+{
+  FAR struct tcurses_vt100_s *priv = (FAR struct tcurses_vt100_s *) dev;
+  int ret;
+
+  ret = tcurses_vt100_flushout(priv);
+
+#ifdef CONFIG_SYSTEM_TERMCURSES_STATS
+  syslog(LOG_INFO, "termcurses: %lu bytes in %lu writes\n",
+         priv->nbytes, priv->nwrites);
+#endif
+
+  return ret;
+}
+
 /************************************************************************************
  * Public Functions
  ************************************************************************************/
@@ -1138,5 +1412,14 @@ FAR struct termcurses_s *tcurses_vt100_initialize(int in_fd, int out_fd)
   priv->out_fd   = out_fd;
   priv->keycount = 0;
 
+  /* Nothing is known about the terminal state yet */
+
+  priv->row      = -1;
+  priv->col      = -1;
+  priv->fgcolor  = -1;
+  priv->bgcolor  = -1;
+  priv->attrib   = -1;
+  priv->cursor   = -1;
+
   return (FAR struct termcurses_s *) priv;
 }
@@ -141,6 +141,7 @@ int termcurses_initterm(FAR const char *term_type, int in_fd, int out_fd,
 
 int termcurses_deinitterm(FAR struct termcurses_s *dev)
 {
+  FAR struct termcurses_dev_s *pdev = (FAR struct termcurses_dev_s *) dev;
   struct termcurses_colors_s colors;
 
   /* Ensure terminal has default color scheme */
@@ -154,7 +155,14 @@ int termcurses_deinitterm(FAR struct termcurses_s *dev)
   colors.color_mask = 0xFF;
   termcurses_setcolors(dev, &colors);
 
-  /* For now, simply free the memory */
+  /* Perform any device specific de-initialization (e.g. sending buffered
+   * output), then free the memory.
+   */
+
+  if (pdev->ops->terminate)
+    {
+      pdev->ops->terminate(dev);
+    }
 
   free(dev);
 
@@ -294,3 +302,48 @@ bool termcurses_checkkey(FAR struct termcurses_s *term)
 
   return 0;
 }
+
+/************************************************************************************
+ * Name: termcurses_write
+ *
+ * Description:
+ *   Write text to the terminal at the current cursor position.
+ *
+ ************************************************************************************/
+
+int termcurses_write(FAR struct termcurses_s *term, FAR const char *buffer,
+                     size_t buflen)
+{
+  FAR struct termcurses_dev_s *dev = (FAR struct termcurses_dev_s *) term;
+
+  /* Call the dev function */
+
+  if (dev->ops->write)
+    {
+      return dev->ops->write(term, buffer, buflen);
+    }
+
+  return -ENOSYS;
+}
+
+/************************************************************************************
+ * Name: termcurses_flush
+ *
+ * Description:
+ *   Send all buffered output to the terminal.
+ *
+ ************************************************************************************/
+
+int termcurses_flush(FAR struct termcurses_s *term)
+{
+  FAR struct termcurses_dev_s *dev = (FAR struct termcurses_dev_s *) term;
+
+  /* Call the dev function */
+
+  if (dev->ops->flush)
+    {
+      return dev->ops->flush(term);
+    }
+
+  return OK;
+}
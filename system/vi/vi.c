@@ -105,6 +105,10 @@
 #define CONFIG_SYSTEM_VI_YANK_THRESHOLD 128
 #endif
 
+#ifndef CONFIG_SYSTEM_VI_OUTBUFSIZE
+#  define CONFIG_SYSTEM_VI_OUTBUFSIZE 512
+#endif
+
 /* Control characters */
 
 #undef  CTRL
@@ -332,6 +336,26 @@ struct vi_undo_s
 };
 #endif
 
+#ifdef CONFIG_SYSTEM_VI_OUTSTATS
+/* Display output statistics */
+
+struct vi_outstats_s
+{
+  unsigned long nbytes;     /* Number of bytes sent to the terminal */
+  unsigned long nwrites;    /* Number of write() calls */
+  unsigned long nrefresh;   /* Number of screen refreshes */
+};
+
+/* One step of the benchmark:  The key sequence is replayed 'repeat' times */
+
+struct vi_benchseq_s
+{
+  FAR const char *name;     /* Description of the edit sequence */
+  FAR const char *keys;     /* Key presses to replay */
+  uint8_t repeat;           /* Number of times to replay the keys */
+};
+#endif
+
 /* This structure describes the overall state of the editor */
 
 struct vi_s
@@ -373,6 +397,27 @@ struct vi_s
   size_t yankalloc;         /* Current allocated size of the yank buffer */
   size_t yanksize;          /* Current size of the text in the yank buffer */
 
+  /* Display output.  shadow[] holds what is currently shown on each text
+   * row of the display; newscr[] holds the rows composed by the current
+   * refresh.  Only the differences between the two are sent.
+   */
+
+  FAR char *shadow;         /* Current content of the text rows */
+  FAR char *newscr;         /* New content of the text rows */
+  FAR bool *rowvalid;       /* True: shadow[] row matches the display */
+  size_t outlen;            /* Number of bytes in outbuf[] */
+  char outbuf[CONFIG_SYSTEM_VI_OUTBUFSIZE]; /* Buffered display output */
+
+#ifdef CONFIG_SYSTEM_VI_OUTSTATS
+  struct vi_outstats_s stats;     /* Running output statistics */
+  struct vi_outstats_s benchbase; /* Statistics at start of the sequence */
+  FAR struct vi_outstats_s *benchres; /* Per-sequence benchmark results */
+  uint16_t benchseq;        /* Index of the current benchmark sequence */
+  uint16_t benchkey;        /* Index of the next key in the sequence */
+  uint8_t benchrep;         /* Number of completed repetitions */
+  bool benchmark;           /* True: Replaying the benchmark sequences */
+#endif
+
   char filename[MAX_FILENAME];    /* Holds the currently selected filename */
   char findstr[MAX_STRING];       /* Holds the current search string */
   char scratch[SCRATCH_BUFSIZE];  /* For general, scratch usage */
@@ -398,6 +443,9 @@ struct vi_s
 
 /* Low-level display and data entry functions */
 
+static void     vi_rawwrite(FAR struct vi_s *vi, FAR const char *buffer,
+                  size_t buflen);
+static void     vi_flush(FAR struct vi_s *vi);
 static void     vi_write(FAR struct vi_s *vi, FAR const char *buffer,
                   size_t buflen);
 static void     vi_putch(FAR struct vi_s *vi, char ch);
@@ -460,6 +508,11 @@ static void     vi_exitsubmode(FAR struct vi_s *vi, uint8_t mode);
 static void     vi_windowpos(FAR struct vi_s *vi, off_t start, off_t end,
                   uint16_t *pcolumn, off_t *ppos);
 static void     vi_scrollcheck(FAR struct vi_s *vi);
+static bool     vi_allocscreen(FAR struct vi_s *vi);
+static void     vi_invalidate(FAR struct vi_s *vi);
+static void     vi_shiftrows(FAR struct vi_s *vi, uint16_t top,
+                  uint16_t bottom);
+static void     vi_drawrow(FAR struct vi_s *vi, uint16_t row);
 static void     vi_showtext(FAR struct vi_s *vi);
 static void     vi_showlinecol(FAR struct vi_s *vi);
 
@@ -530,6 +583,13 @@ static void     vi_saverepeat(FAR struct vi_s *vi, uint16_t ch);
 static void     vi_appendrepeat(FAR struct vi_s *vi, uint16_t ch);
 #endif
 
+/* Output statistics */
+
+#ifdef CONFIG_SYSTEM_VI_OUTSTATS
+static int      vi_benchkey(FAR struct vi_s *vi);
+static void     vi_benchreport(FAR struct vi_s *vi);
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -559,6 +619,11 @@ static const char g_blinkoff[]      = VT100_BLINKOFF;
 
 static const char g_fmtcursorpos[]  = VT100_FMT_CURSORPOS;
 
+/* Set the scrolling region (DECSTBM) and reset it to the full screen */
+
+static const char g_fmtsetwin[]     = "\033[%d;%dr";
+static const char g_resetwin[]      = "\033[r";
+
 /* Error format strings */
 
 static const char g_fmtallocfail[]  = "Failed to allocate memory";
@@ -572,6 +637,34 @@ static const char g_fmtsrcbot[]     = "search hit BOTTOM, continuing at TOP";
 static const char g_fmtsrctop[]     = "search hit TOP, continuing at BOTTOM";
 static const char g_fmtinsert[]     = "--INSERT--";
 
+#ifdef CONFIG_SYSTEM_VI_OUTSTATS
+/* Edit sequences replayed by the '-b' benchmark option.  The first entry
+ * has no keys and so measures the initial screen paint.
+ */
+
+static const struct vi_benchseq_s g_benchseq[] =
+{
+  { "initial paint",   "",                         1 },
+  { "line down",       "j",                       40 },
+  { "line up",         "k",                       40 },
+  { "page down",       "\006",                     4 },
+  { "page up",         "\002",                     4 },
+  { "half page down",  "\004",                     4 },
+  { "half page up",    "\025",                     4 },
+  { "insert mid-line", "0wiquick brown fox \033",  4 },
+  { "append at eol",   "A jumps over\033",         4 },
+  { "open line below", "oa new line\033",         10 },
+  { "open line above", "Oanother line\033",       10 },
+  { "delete char",     "x",                       20 },
+  { "delete line",     "dd",                      10 },
+  { "join lines",      "J",                       10 },
+  { "paste line",      "yyp",                     10 },
+  { "goto end/top",    "Ggg",                      4 }
+};
+
+#define NBENCHSEQ (sizeof(g_benchseq) / sizeof(struct vi_benchseq_s))
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -609,15 +702,15 @@ static int vi_debug(FAR const char *fmt, ...)
  ****************************************************************************/
 
 /****************************************************************************
- * Name: vi_write
+ * Name: vi_rawwrite
  *
  * Description:
  *   Write a sequence of bytes to the console device (stdout, fd = 1).
  *
  ****************************************************************************/
 
-static void vi_write(FAR struct vi_s *vi, FAR const char *buffer,
-                     size_t buflen)
+static void vi_rawwrite(FAR struct vi_s *vi, FAR const char *buffer,
+                        size_t buflen)
 {
   ssize_t nwritten;
   size_t  nremaining = buflen;
@@ -630,7 +723,7 @@ static void vi_write(FAR struct vi_s *vi, FAR const char *buffer,
     {
       /* Take the next gulp */
 
-      nwritten = write(1, buffer, buflen);
+      nwritten = write(1, buffer, nremaining);
 
       /* Handle write errors.  write() should neve return 0. */
 
@@ -655,10 +748,64 @@ static void vi_write(FAR struct vi_s *vi, FAR const char *buffer,
 
       else
         {
+          buffer     += nwritten;
           nremaining -= nwritten;
         }
     }
   while (nremaining > 0);
+
+#ifdef CONFIG_SYSTEM_VI_OUTSTATS
+  vi->stats.nbytes += buflen;
+  vi->stats.nwrites++;
+#endif
+}
+
+/****************************************************************************
+ * Name: vi_flush
+ *
+ * Description:
+ *   Send all buffered display output to the console device.
+ *
+ ****************************************************************************/
+
+static void vi_flush(FAR struct vi_s *vi)
+{
+  if (vi->outlen > 0)
+    {
+      vi_rawwrite(vi, vi->outbuf, vi->outlen);
+      vi->outlen = 0;
+    }
+}
+
+/****************************************************************************
+ * Name: vi_write
+ *
+ * Description:
+ *   Add a sequence of bytes to the display output buffer.  The buffer is
+ *   sent when it fills or when vi_flush() is called.
+ *
+ ****************************************************************************/
+
+static void vi_write(FAR struct vi_s *vi, FAR const char *buffer,
+                     size_t buflen)
+{
+  /* Make room in the output buffer if necessary */
+
+  if (vi->outlen + buflen > CONFIG_SYSTEM_VI_OUTBUFSIZE)
+    {
+      vi_flush(vi);
+
+      /* Send anything that would not fit into an empty buffer directly */
+
+      if (buflen > CONFIG_SYSTEM_VI_OUTBUFSIZE)
+        {
+          vi_rawwrite(vi, buffer, buflen);
+          return;
+        }
+    }
+
+  memcpy(&vi->outbuf[vi->outlen], buffer, buflen);
+  vi->outlen += buflen;
 }
 
 /****************************************************************************
@@ -671,7 +818,12 @@ static void vi_write(FAR struct vi_s *vi, FAR const char *buffer,
 
 static void vi_putch(FAR struct vi_s *vi, char ch)
 {
-  vi_write(vi, &ch, 1);
+  if (vi->outlen >= CONFIG_SYSTEM_VI_OUTBUFSIZE)
+    {
+      vi_flush(vi);
+    }
+
+  vi->outbuf[vi->outlen++] = ch;
 }
 
 /****************************************************************************
@@ -687,6 +839,19 @@ static int vi_getch(FAR struct vi_s *vi)
   char buffer;
   ssize_t nread;
 
+  /* Send all pending display output before waiting for input */
+
+  vi_flush(vi);
+
+#ifdef CONFIG_SYSTEM_VI_OUTSTATS
+  /* Replay the benchmark key sequences instead of reading the input */
+
+  if (vi->benchmark)
+    {
+      return vi_benchkey(vi);
+    }
+#endif
+
   /* Loop until we successfully read a character (or until an unexpected
    * error occurs).
    */
@@ -760,7 +925,7 @@ static void vi_boldon(FAR struct vi_s *vi)
 {
   /* Send the VT100 BOLDON command */
 
-  vi_write(vi, g_boldon, sizeof(g_boldon));
+  vi_write(vi, g_boldon, sizeof(g_boldon) - 1);
 }
 
 /****************************************************************************
@@ -775,7 +940,7 @@ static void vi_reverseon(FAR struct vi_s *vi)
 {
   /* Send the VT100 REVERSON command */
 
-  vi_write(vi, g_reverseon, sizeof(g_reverseon));
+  vi_write(vi, g_reverseon, sizeof(g_reverseon) - 1);
 }
 
 /****************************************************************************
@@ -790,7 +955,7 @@ static void vi_attriboff(FAR struct vi_s *vi)
 {
   /* Send the VT100 ATTRIBOFF command */
 
-  vi_write(vi, g_attriboff, sizeof(g_attriboff));
+  vi_write(vi, g_attriboff, sizeof(g_attriboff) - 1);
 }
 
 /****************************************************************************
@@ -805,7 +970,7 @@ static void vi_cursoron(FAR struct vi_s *vi)
 {
   /* Send the VT100 CURSORON command */
 
-  vi_write(vi, g_cursoron, sizeof(g_cursoron));
+  vi_write(vi, g_cursoron, sizeof(g_cursoron) - 1);
 }
 
 /****************************************************************************
@@ -820,7 +985,7 @@ static void vi_cursoroff(FAR struct vi_s *vi)
 {
   /* Send the VT100 CURSOROFF command */
 
-  vi_write(vi, g_cursoroff, sizeof(g_cursoroff));
+  vi_write(vi, g_cursoroff, sizeof(g_cursoroff) - 1);
 }
 
 /****************************************************************************
@@ -860,61 +1025,7 @@ static void vi_clrtoeol(FAR struct vi_s *vi)
 {
   /* Send the VT100 ERASETOEOL command */
 
-  vi_write(vi, g_erasetoeol, sizeof(g_erasetoeol));
-}
-
-/****************************************************************************
- * Name: vi_scrollup
- *
- * Description:
- *   Scroll the display up 'nlines' by sending the VT100 INDEX command.
- *
- ****************************************************************************/
-
-static void vi_scrollup(FAR struct vi_s *vi, uint16_t nlines)
-{
-  viinfo("nlines=%d\n", nlines);
-
-  /* Scroll for the specified number of lines */
-
-  for (; nlines; nlines--)
-    {
-      /* Send the VT100 INDEX command */
-
-      vi_write(vi, g_index, sizeof(g_index));
-    }
-
-  /* Ensure bottom line is clared */
-
-  vi_setcursor(vi, vi->display.row-1, 0);
-  vi_clrtoeol(vi);
-}
-
-/****************************************************************************
- * Name: vi_scrolldown
- *
- * Description:
- *   Scroll the display down 'nlines' by sending the VT100 REVINDEX command.
- *
- ****************************************************************************/
-
-static void vi_scrolldown(FAR struct vi_s *vi, uint16_t nlines)
-{
-  viinfo("nlines=%d\n", nlines);
-
-  /* Ensure the bottom line is cleared after the scroll */
-
-  vi_setcursor(vi, vi->display.row-2, 0);
-  vi_clrtoeol(vi);
-
-  /* Scroll for the specified number of lines */
-
-  for (; nlines; nlines--)
-    {
-      /* Send the VT100 REVINDEX command */
-
-      vi_write(vi, g_revindex, sizeof(g_revindex));
-    }
+  vi_write(vi, g_erasetoeol, sizeof(g_erasetoeol) - 1);
 }
 
 /****************************************************************************
@@ -1642,7 +1753,6 @@ static void vi_scrollcheck(FAR struct vi_s *vi)
   off_t pos;
   uint16_t tmp;
   int column;
-  int nlines;
 
   /* Sanity test */
 
@@ -1725,63 +1835,299 @@ static void vi_scrollcheck(FAR struct vi_s *vi)
 
   vi->cursor.column = column;
 
-  /* Check if new window position is below the previous position.
-   * In this case, we will need to scroll up until the new window
-   * position is at the top of the display.
+  /* If the window position changed, then the whole display must be
+   * updated.  vi_showtext() will detect the vertical scroll and move the
+   * unchanged rows with the terminal's scrolling region.
    */
 
-  if (vi->winpos > vi->prevpos)
+  if (vi->winpos != vi->prevpos)
     {
-      /* We will need to scroll up.  Count how many lines we
-       * need to scroll.
-       */
+      vi->fullredraw = true;
+    }
+
+  /* Save the previous top-of-display position for next time around.
+   * This can be modified asynchronously by text deletion operations.
+   */
+
+  vi->prevpos = vi->winpos;
+  viinfo("winpos=%ld hscroll=%d\n",
+         (long)vi->winpos, (long)vi->hscroll);
+}
+
+/****************************************************************************
+ * Name: vi_allocscreen
+ *
+ * Description:
+ *   Allocate the shadow and new screen row buffers for the current display
+ *   size.  The shadow screen starts out invalid so that the first refresh
+ *   draws every row.
+ *
+ ****************************************************************************/
+
+static bool vi_allocscreen(FAR struct vi_s *vi)
+{
+  size_t scrsize = (size_t)vi->display.row * vi->display.column;
+
+  vi->shadow   = (FAR char *)malloc(scrsize);
+  vi->newscr   = (FAR char *)malloc(scrsize);
+  vi->rowvalid = (FAR bool *)zalloc(vi->display.row * sizeof(bool));
+
+  return vi->shadow != NULL && vi->newscr != NULL && vi->rowvalid != NULL;
+}
+
+/****************************************************************************
+ * Name: vi_invalidate
+ *
+ * Description:
+ *   Forget what is shown on the display so that the next refresh redraws
+ *   every text row.
+ *
+ ****************************************************************************/
+
+static void vi_invalidate(FAR struct vi_s *vi)
+{
+  memset(vi->rowvalid, 0, vi->display.row * sizeof(bool));
+  vi->fullredraw = true;
+}
+
+/****************************************************************************
+ * Name: vi_rowmatch
+ *
+ * Description:
+ *   Return true if new row 'newrow' is the same as what is currently shown
+ *   on display row 'oldrow'.
+ *
+ ****************************************************************************/
+
+static inline bool vi_rowmatch(FAR struct vi_s *vi, uint16_t newrow,
+                               uint16_t oldrow)
+{
+  uint16_t ncols = vi->display.column;
+
+  return vi->rowvalid[oldrow] &&
+         memcmp(&vi->newscr[newrow * ncols], &vi->shadow[oldrow * ncols],
+                ncols) == 0;
+}
+
+/****************************************************************************
+ * Name: vi_shiftrows
+ *
+ * Description:
+ *   Check if the new rows in the range [top, bottom) are the current rows
+ *   moved up or down by some number of lines (as after scrolling, deleting
+ *   or opening lines).  If so, move the rows on the terminal by setting a
+ *   scrolling region and sending INDEX or REVINDEX commands, then update
+ *   the shadow screen to match.  The remaining differences are then sent
+ *   by vi_drawrow().
+ *
+ ****************************************************************************/
+
+static void vi_shiftrows(FAR struct vi_s *vi, uint16_t top, uint16_t bottom)
+{
+  FAR char *row;
+  uint16_t ncols = vi->display.column;
+  uint16_t bestshift = 0;
+  uint16_t bestmatch = 0;
+  bool bestup = false;
+  uint16_t shift;
+  uint16_t nmatch;
+  uint16_t r;
+  char buffer[16];
+  int len;
+
+  /* Rows at the top and bottom of the range that did not change do not
+   * need to move.
+   */
+
+  while (top < bottom && vi_rowmatch(vi, top, top))
+    {
+      top++;
+    }
+
+  while (bottom > top && vi_rowmatch(vi, bottom - 1, bottom - 1))
+    {
+      bottom--;
+    }
 
-      for (nlines = 0, pos = vi->prevpos;
-           pos != vi->winpos && nlines < vi->display.row-1;
-           nlines++)
+  if (bottom - top < 3)
+    {
+      return;
+    }
+
+  /* Find the shift that preserves the most rows */
+
+  for (shift = 1; shift < bottom - top - 1; shift++)
+    {
+      /* Content moved up by 'shift' lines */
+
+      for (nmatch = 0, r = top; r < bottom - shift; r++)
         {
-          pos = vi_nextline(vi, pos);
+          if (vi_rowmatch(vi, r, r + shift))
+            {
+              nmatch++;
+            }
+        }
+
+      if (nmatch > bestmatch)
+        {
+          bestmatch = nmatch;
+          bestshift = shift;
+          bestup    = true;
         }
 
-      /* Then scroll up that number of lines */
+      /* Content moved down by 'shift' lines */
 
-      if (nlines < vi->display.row-1)
+      for (nmatch = 0, r = top + shift; r < bottom; r++)
         {
-          vi_scrollup(vi, nlines);
-          vi->fullredraw = true;
+          if (vi_rowmatch(vi, r, r - shift))
+            {
+              nmatch++;
+            }
+        }
+
+      if (nmatch > bestmatch)
+        {
+          bestmatch = nmatch;
+          bestshift = shift;
+          bestup    = false;
         }
     }
 
-  /* Check if new window position is above the previous position.
-   * In this case, we will need to scroll down until the new window
-   * position is at the top of the display.
+  /* Moving the rows costs a few escape sequences per line of shift.  Only
+   * do it if it preserves at least two rows.
    */
 
-  else if (vi->winpos < vi->prevpos)
+  if (bestmatch < 2)
     {
-      for (nlines = 0, pos = vi->prevpos;
-           pos != vi->winpos && nlines < vi->display.row - 1;
-           nlines++)
+      return;
+    }
+
+  viinfo("top=%d bottom=%d shift=%d up=%d\n", top, bottom, bestshift, bestup);
+
+  /* Restrict scrolling to the affected rows */
+
+  len = snprintf(buffer, 16, g_fmtsetwin, top + 1, bottom);
+  vi_write(vi, buffer, len);
+
+  if (bestup)
+    {
+      /* INDEX at the bottom margin scrolls the region up one line */
+
+      vi_setcursor(vi, bottom - 1, 0);
+      for (shift = 0; shift < bestshift; shift++)
         {
-          pos = vi_prevline(vi, pos);
+          vi_write(vi, g_index, sizeof(g_index) - 1);
         }
 
-      /* Then scroll down that number of lines */
+      memmove(&vi->shadow[top * ncols], &vi->shadow[(top + bestshift) * ncols],
+              (bottom - top - bestshift) * ncols);
+      memmove(&vi->rowvalid[top], &vi->rowvalid[top + bestshift],
+              (bottom - top - bestshift) * sizeof(bool));
+      r = bottom - bestshift;
+    }
+  else
+    {
+      /* REVINDEX at the top margin scrolls the region down one line */
 
-      if (nlines < vi->display.row-1)
+      vi_setcursor(vi, top, 0);
+      for (shift = 0; shift < bestshift; shift++)
         {
-          vi_scrolldown(vi, nlines);
-          vi->fullredraw = true;
+          vi_write(vi, g_revindex, sizeof(g_revindex) - 1);
         }
+
+      memmove(&vi->shadow[(top + bestshift) * ncols], &vi->shadow[top * ncols],
+              (bottom - top - bestshift) * ncols);
+      memmove(&vi->rowvalid[top + bestshift], &vi->rowvalid[top],
+              (bottom - top - bestshift) * sizeof(bool));
+      r = top;
     }
 
-  /* Save the previous top-of-display position for next time around.
-   * This can be modified asynchronously by text deletion operations.
+  /* The lines scrolled into the region are blank */
+
+  for (shift = 0; shift < bestshift; shift++, r++)
+    {
+      row = &vi->shadow[r * ncols];
+      memset(row, ' ', ncols);
+      vi->rowvalid[r] = true;
+    }
+
+  /* Restore the full screen scrolling region */
+
+  vi_write(vi, g_resetwin, sizeof(g_resetwin) - 1);
+}
+
+/****************************************************************************
+ * Name: vi_drawrow
+ *
+ * Description:
+ *   Send the differences between the new and the current content of one
+ *   display row and update the shadow screen.
+ *
+ ****************************************************************************/
+
+static void vi_drawrow(FAR struct vi_s *vi, uint16_t row)
+{
+  FAR const char *newrow = &vi->newscr[row * vi->display.column];
+  FAR char *oldrow = &vi->shadow[row * vi->display.column];
+  uint16_t newlen;
+  uint16_t first;
+  uint16_t last;
+
+  /* Find the length of the new row without trailing spaces */
+
+  for (newlen = vi->display.column;
+       newlen > 0 && newrow[newlen - 1] == ' ';
+       newlen--)
+    {
+    }
+
+  /* Find the range of columns that differ */
+
+  first = 0;
+  last  = vi->display.column;
+
+  if (vi->rowvalid[row])
+    {
+      while (first < last && newrow[first] == oldrow[first])
+        {
+          first++;
+        }
+
+      if (first == last)
+        {
+          /* Nothing changed on this row */
+
+          return;
+        }
+
+      while (newrow[last - 1] == oldrow[last - 1])
+        {
+          last--;
+        }
+    }
+
+  vi_setcursor(vi, row, first);
+
+  /* If the changes extend into the blank tail of the new row, write the
+   * text up to the tail and then clear to the end of the line.
    */
 
-  vi->prevpos = vi->winpos;
-  viinfo("winpos=%ld hscroll=%d\n",
-         (long)vi->winpos, (long)vi->hscroll);
+  if (last > newlen)
+    {
+      if (first < newlen)
+        {
+          vi_write(vi, &newrow[first], newlen - first);
+        }
+
+      vi_clrtoeol(vi);
+    }
+  else
+    {
+      vi_write(vi, &newrow[first], last - first);
+    }
+
+  memcpy(oldrow, newrow, vi->display.column);
+  vi->rowvalid[row] = true;
 }
 
 /****************************************************************************
@@ -1792,18 +2138,22 @@ static void vi_scrollcheck(FAR struct vi_s *vi)
  *   called at the beginning of the processing loop in Command and Insert
  *   modes (and also in the continuous replace mode).
  *
+ *   The affected rows are first composed into newscr[].  Only the rows
+ *   and columns that differ from the shadow screen are then sent to the
+ *   terminal.
+ *
  ****************************************************************************/
 
 static void vi_showtext(FAR struct vi_s *vi)
 {
+  FAR char *line;
   off_t pos;
-  off_t writefrom;
+  uint16_t toprow;
   uint16_t row;
   uint16_t endrow;
   uint16_t column;
-  uint16_t endcol;
   uint16_t tabcol;
-  bool redraw_line;
+  char ch;
 
   /* Check if any of the preceding operations will cause the display to
    * scroll.
@@ -1818,18 +2168,15 @@ static void vi_showtext(FAR struct vi_s *vi)
       return;
     }
 
+#ifdef CONFIG_SYSTEM_VI_OUTSTATS
+  vi->stats.nrefresh++;
+#endif
+
   /* If there is an error message at the bottom of the display, then
    * do not update the last line.
    */
 
-  endrow = vi->display.row-1;
-
-  /* Make sure that all character attributes are disabled; Turn off the
-   * cursor during the update.
-   */
-
-  vi_attriboff(vi);
-  vi_cursoroff(vi);
+  endrow = vi->display.row - 1;
 
   /* Set loop control variables based on draw mode */
 
@@ -1840,10 +2187,9 @@ static void vi_showtext(FAR struct vi_s *vi)
       pos = vi->winpos;
       row = 0;
 
-      /* Ensure drawtoeos and redraw line are also set */
+      /* Ensure drawtoeos is also set */
 
-      vi->drawtoeos  = true;
-      vi->redrawline = true;
+      vi->drawtoeos = true;
     }
   else
     {
@@ -1852,51 +2198,22 @@ static void vi_showtext(FAR struct vi_s *vi)
       pos = vi_linebegin(vi, vi->curpos);
       row = vi->cursor.row;
 
-      if (vi->drawtoeos)
-        {
-          vi->redrawline = true;
-        }
-      else
+      if (!vi->drawtoeos)
         {
           endrow = row + 1;
         }
     }
 
-  /* Write each line to the display, handling horizontal scrolling and
+  toprow = row;
+
+  /* Compose each line into newscr[], handling horizontal scrolling and
    * tab expansion.
    */
 
   for (; pos < vi->textsize && row < endrow; row++)
     {
-      /* Test if this line needs to be redrawn */
-
-      redraw_line = true;
-      if (!vi->redrawline)
-        {
-          redraw_line = false;
-        }
-      else if (row+1 < vi->cursor.row && !vi->fullredraw)
-        {
-          redraw_line = false;
-        }
-      else if (row > vi->cursor.row && !vi->drawtoeos)
-        {
-          redraw_line = false;
-        }
-      else if (row == vi->cursor.row && !vi->redrawline)
-        {
-          redraw_line = false;
-        }
-
-      /* Get the last column on this row.  Avoid writing into the last byte
-       * on the screen which may trigger a scroll.
-       */
-
-      endcol = vi->display.column;
-      if (row >= vi->display.row - 1)
-        {
-         endcol--;
-        }
+      line = &vi->newscr[row * vi->display.column];
+      memset(line, ' ', vi->display.column);
 
       /* Get the position into this line corresponding to display column 0,
        * accounting for horizontal scrolling and tab expansion.  Add that to
@@ -1906,76 +2223,44 @@ static void vi_showtext(FAR struct vi_s *vi)
 
       vi_windowpos(vi, pos, pos + vi->hscroll, NULL, &pos);
 
-      /* Set the cursor position to the beginning of this row and clear to
-       * the end of the line.
-       */
+      /* Loop for each column */
 
-      if (redraw_line)
+      for (column = 0;
+           pos < vi->textsize && column < vi->display.column;
+           pos++)
         {
-          vi_setcursor(vi, row, 0);
+          ch = vi->text[pos];
 
-          /* Loop for each column */
+          /* Break out of the loop if we encounter the newline before the
+           * last column is encountered.
+           */
 
-          writefrom = pos;
-          for (column = 0; pos < vi->textsize && column < endcol; pos++)
+          if (ch == '\n')
             {
-              /* Break out of the loop if we encounter the newline before the
-               * last column is encountered.
-               */
-
-              if (vi->text[pos] == '\n')
-                {
-                  break;
-                }
+              break;
+            }
 
-              /* Perform TAB expansion */
+          /* Perform TAB expansion */
 
-              else if (vi->text[pos] == '\t')
+          else if (ch == '\t')
+            {
+              tabcol = NEXT_TAB(column);
+              if (tabcol >= vi->display.column)
                 {
-                  /* Write collected characters */
-
-                  if (writefrom != pos)
-                    {
-                      vi_write(vi, &vi->text[writefrom], pos-writefrom);
-                    }
+                  /* There is nothing left on the line but whitespace */
 
-                  tabcol = NEXT_TAB(column);
-                  if (tabcol < endcol)
-                    {
-                      for (; column < tabcol; column++)
-                        {
-                          vi_putch(vi, ' ');
-                        }
-
-                      writefrom = pos + 1;
-                    }
-                  else
-                    {
-                      /* Break out of the loop... there is nothing left on the
-                       * line but whitespace.
-                       */
-
-                      writefrom = pos;
-                      break;
-                    }
+                  break;
                 }
 
-              /* Add the normal character to the display */
-
-              else
-                {
-                  column++;
-                }
+              column = tabcol;
             }
 
-          /* Write collected characters */
+          /* Add the normal character to the line */
 
-          if (writefrom != pos)
+          else
             {
-              vi_write(vi, &vi->text[writefrom], pos-writefrom);
+              line[column++] = ch;
             }
-
-          vi_clrtoeol(vi);
         }
 
       /* Skip to the beginning of the next line */
@@ -1983,10 +2268,10 @@ static void vi_showtext(FAR struct vi_s *vi)
       pos = vi_nextline(vi, pos);
     }
 
-  if (pos == vi->textsize && vi->text[pos-1] == '\n')
+  if (pos == vi->textsize && pos > 0 && vi->text[pos - 1] == '\n' &&
+      row < vi->display.row - 1)
     {
-      vi_setcursor(vi, row, 0);
-      vi_clrtoeol(vi);
+      memset(&vi->newscr[row * vi->display.column], ' ', vi->display.column);
       row++;
     }
 
@@ -2001,19 +2286,34 @@ static void vi_showtext(FAR struct vi_s *vi)
 
       for (; row < endrow; row++)
         {
-          /* Set the cursor position to the beginning of the row and clear to
-           * the end of the line.
-           */
-
-          vi_setcursor(vi, row, 0);
-          if (row != endrow && row != 0)
+          line = &vi->newscr[row * vi->display.column];
+          memset(line, ' ', vi->display.column);
+          if (row != 0)
             {
-              vi_putch(vi, '~');
+              line[0] = '~';
             }
-          vi_clrtoeol(vi);
         }
     }
 
+  /* Make sure that all character attributes are disabled; Turn off the
+   * cursor during the update.
+   */
+
+  vi_attriboff(vi);
+  vi_cursoroff(vi);
+
+  /* Move rows that only scrolled, then send what remains different */
+
+  if (row - toprow > 1)
+    {
+      vi_shiftrows(vi, toprow, row);
+    }
+
+  for (endrow = row, row = toprow; row < endrow; row++)
+    {
+      vi_drawrow(vi, row);
+    }
+
   /* Turn the cursor back on */
 
   vi_cursoron(vi);
@@ -4198,10 +4498,15 @@ static void vi_cmd_mode(FAR struct vi_s *vi)
           }
           break;
 
-        /* Unimplemented and invalid commands */
-
         case KEY_CMDMODE_REDRAW:  /* Redraws the screen */
         case KEY_CMDMODE_REDRAW2: /* Redraws the screen, removing deleted lines */
+          {
+            vi_invalidate(vi);
+          }
+          break;
+
+        /* Unimplemented and invalid commands */
+
         case KEY_CMDMODE_MARK:    /* Place a mark beginning at the current cursor position */
         default:
           {
@@ -4803,7 +5108,7 @@ static bool vi_findstring(FAR struct vi_s *vi)
 
       if (strncmp(vi->text + pos, vi->scratch, len) == 0)
         {
-          vi_write(vi, g_fmtsrcbot, sizeof(g_fmtsrcbot));
+          vi_write(vi, g_fmtsrcbot, sizeof(g_fmtsrcbot) - 1);
 
           /* Found it... save the cursor position and
            * return success.
@@ -4873,7 +5178,7 @@ static bool vi_revfindstring(FAR struct vi_s *vi)
 
       if (strncmp(vi->text + pos, vi->scratch, len) == 0)
         {
-          vi_write(vi, g_fmtsrctop, sizeof(g_fmtsrctop));
+          vi_write(vi, g_fmtsrctop, sizeof(g_fmtsrctop) - 1);
 
           /* Found it... save the cursor position and
            * return success.
@@ -5373,7 +5678,7 @@ static void vi_insert_mode(FAR struct vi_s *vi)
   /* Print insert message */
 
   vi_clearbottomline(vi);
-  vi_write(vi, g_fmtinsert, sizeof(g_fmtinsert));
+  vi_write(vi, g_fmtinsert, sizeof(g_fmtinsert) - 1);
   vi_setcursor(vi, vi->cursor.row, vi->cursor.column);
   vi->redrawline = true;
 
@@ -5454,6 +5759,8 @@ static void vi_insert_mode(FAR struct vi_s *vi)
                vi->text[vi->curpos+1] == '\n'))
             {
               vi_putch(vi, ch);
+              vi->shadow[vi->cursor.row * vi->display.column +
+                         vi->cursor.column] = ch;
             }
           else
             {
@@ -5593,8 +5900,6 @@ static void vi_insert_mode(FAR struct vi_s *vi)
                   vi_replacech(vi, '\n');
                 }
 
-              vi_putch(vi, ' ');
-              vi_clrtoeol(vi);
               vi->drawtoeos = true;
             }
             break;
@@ -5676,6 +5981,97 @@ static void vi_insert_mode(FAR struct vi_s *vi)
   vi_clearbottomline(vi);
 }
 
+#ifdef CONFIG_SYSTEM_VI_OUTSTATS
+/****************************************************************************
+ * Output statistics
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vi_benchkey
+ *
+ * Description:
+ *   Return the next key of the benchmark edit sequences.  The output
+ *   statistics are recorded at the end of each sequence.  After the last
+ *   sequence, the results are reported and the editor exits.
+ *
+ ****************************************************************************/
+
+static int vi_benchkey(FAR struct vi_s *vi)
+{
+  FAR const struct vi_benchseq_s *seq;
+  FAR struct vi_outstats_s *res;
+
+  for (; ; )
+    {
+      seq = &g_benchseq[vi->benchseq];
+      if (seq->keys[vi->benchkey] != '\0')
+        {
+          return seq->keys[vi->benchkey++];
+        }
+
+      vi->benchkey = 0;
+      if (++vi->benchrep < seq->repeat)
+        {
+          continue;
+        }
+
+      /* This sequence is complete.  Record the output it generated. */
+
+      vi_flush(vi);
+
+      res           = &vi->benchres[vi->benchseq];
+      res->nbytes   = vi->stats.nbytes - vi->benchbase.nbytes;
+      res->nwrites  = vi->stats.nwrites - vi->benchbase.nwrites;
+      res->nrefresh = vi->stats.nrefresh - vi->benchbase.nrefresh;
+
+      vi->benchbase = vi->stats;
+      vi->benchrep  = 0;
+
+      if (++vi->benchseq >= NBENCHSEQ)
+        {
+          vi_benchreport(vi);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: vi_benchreport
+ *
+ * Description:
+ *   Show the benchmark results below the display and exit without saving.
+ *
+ ****************************************************************************/
+
+static void vi_benchreport(FAR struct vi_s *vi)
+{
+  FAR const struct vi_outstats_s *res;
+  int i;
+
+  vi_setcursor(vi, vi->display.row - 1, 0);
+  vi_clrtoeol(vi);
+  vi_putch(vi, '\n');
+  vi_flush(vi);
+
+  printf("%-16s %6s %8s %7s %8s\n",
+         "SEQUENCE", "KEYS", "REFRESH", "WRITES", "BYTES");
+
+  for (i = 0; i < NBENCHSEQ; i++)
+    {
+      res = &vi->benchres[i];
+      printf("%-16s %6lu %8lu %7lu %8lu\n", g_benchseq[i].name,
+             (unsigned long)(strlen(g_benchseq[i].keys) *
+                             g_benchseq[i].repeat),
+             res->nrefresh, res->nwrites, res->nbytes);
+    }
+
+  printf("%-16s %6s %8lu %7lu %8lu\n", "TOTAL", "",
+         vi->stats.nrefresh, vi->stats.nwrites, vi->stats.nbytes);
+
+  vi_release(vi);
+  exit(EXIT_SUCCESS);
+}
+#endif
+
 /****************************************************************************
  * Command line processing
  ****************************************************************************/
@@ -5692,6 +6088,8 @@ static void vi_release(FAR struct vi_s *vi)
 {
   if (vi)
     {
+      vi_flush(vi);
+
       if (vi->text)
         {
           free(vi->text);
@@ -5702,6 +6100,28 @@ static void vi_release(FAR struct vi_s *vi)
           free(vi->yank);
         }
 
+      if (vi->shadow)
+        {
+          free(vi->shadow);
+        }
+
+      if (vi->newscr)
+        {
+          free(vi->newscr);
+        }
+
+      if (vi->rowvalid)
+        {
+          free(vi->rowvalid);
+        }
+
+#ifdef CONFIG_SYSTEM_VI_OUTSTATS
+      if (vi->benchres)
+        {
+          free(vi->benchres);
+        }
+#endif
+
       if (vi->tcurs)
         {
           termcurses_deinitterm(vi->tcurs);
@@ -5722,13 +6142,23 @@ static void vi_release(FAR struct vi_s *vi)
 static void vi_showusage(FAR struct vi_s *vi, FAR const char *progname,
                          int exitcode)
 {
+#ifdef CONFIG_SYSTEM_VI_OUTSTATS
+  fprintf(stderr, "\nUSAGE:\t%s [-b] [-c <columns] [-r <rows>] [<filename>]\n",
+          progname);
+#else
   fprintf(stderr, "\nUSAGE:\t%s [-c <columns] [-r <rows>] [<filename>]\n",
           progname);
+#endif
   fprintf(stderr, "\nUSAGE:\t%s -h\n\n",
           progname);
   fprintf(stderr, "Where:\n");
   fprintf(stderr, "\t<filename>:\n");
   fprintf(stderr, "\t\tOptional name of the file to open\n");
+#ifdef CONFIG_SYSTEM_VI_OUTSTATS
+  fprintf(stderr, "\t-b:\n");
+  fprintf(stderr, "\t\tReplay common edit sequences and report the display\n");
+  fprintf(stderr, "\t\toutput used by each.  The file is not saved.\n");
+#endif
   fprintf(stderr, "\t-c <columns>:\n");
   fprintf(stderr, "\t\tOptional width of the display in columns.  Default: %d\n",
           CONFIG_SYSTEM_VI_COLS);
@@ -5782,10 +6212,22 @@ int vi_main(int argc, char **argv)
 
   /* Parse command line arguments */
 
+#ifdef CONFIG_SYSTEM_VI_OUTSTATS
+  while ((option = getopt(argc, argv, ":bc:r:h")) != ERROR)
+#else
   while ((option = getopt(argc, argv, ":c:r:h")) != ERROR)
+#endif
     {
       switch (option)
         {
+#ifdef CONFIG_SYSTEM_VI_OUTSTATS
+          case 'b': /* Replay the benchmark edit sequences */
+            {
+              vi->benchmark = true;
+            }
+            break;
+
+#endif
           case 'c': /* Display width in columns */
             {
               unsigned long value = strtoul(optarg, NULL, 10);
@@ -5856,6 +6298,29 @@ int vi_main(int argc, char **argv)
         }
     }
 
+  /* Allocate the display buffers now that the display size is known */
+
+  if (!vi_allocscreen(vi))
+    {
+      fprintf(stderr, "ERROR: %s\n", g_fmtallocfail);
+      vi_release(vi);
+      return EXIT_FAILURE;
+    }
+
+#ifdef CONFIG_SYSTEM_VI_OUTSTATS
+  if (vi->benchmark)
+    {
+      vi->benchres = (FAR struct vi_outstats_s *)
+        zalloc(NBENCHSEQ * sizeof(struct vi_outstats_s));
+      if (vi->benchres == NULL)
+        {
+          fprintf(stderr, "ERROR: %s\n", g_fmtallocfail);
+          vi_release(vi);
+          return EXIT_FAILURE;
+        }
+    }
+#endif
+
   /* There may be one additional argument on the command line:  The filename */
 
   if (optind < argc)
@@ -0,0 +1,152 @@
+/****************************************************************************
+ * wireless/ieee802154/i8shark/i8shark.h
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_WIRELESS_IEEE802154_I8SHARK_I8SHARK_H
+#define __APPS_WIRELESS_IEEE802154_I8SHARK_I8SHARK_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <time.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_IEEE802154_I8SHARK_PCAPNG_PREFIX
+#  define CONFIG_IEEE802154_I8SHARK_PCAPNG_PREFIX "/tmp/i8shark"
+#endif
+
+#ifndef CONFIG_IEEE802154_I8SHARK_PCAPNG_FILESIZE
+#  define CONFIG_IEEE802154_I8SHARK_PCAPNG_FILESIZE 65536
+#endif
+
+#ifndef CONFIG_IEEE802154_I8SHARK_PCAPNG_FILECOUNT
+#  define CONFIG_IEEE802154_I8SHARK_PCAPNG_FILECOUNT 4
+#endif
+
+#ifndef CONFIG_IEEE802154_I8SHARK_PCAPNG_BUFSIZE
+#  define CONFIG_IEEE802154_I8SHARK_PCAPNG_BUFSIZE 1024
+#endif
+
+#define I8SHARK_MAX_PREFIX 32
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+/* State of the rotating pcapng capture files */
+
+struct i8shark_pcapng_s
+{
+  FAR const char *prefix;       /* Capture file name prefix */
+  int fd;                       /* Current capture file */
+  int fileno;                   /* Index of the current capture file */
+  uint16_t linktype;            /* LINKTYPE_* of the captured frames */
+  size_t filesize;              /* Bytes in the current file, incl. buffer */
+  size_t nbuffered;             /* Bytes waiting in buffer */
+  uint8_t buffer[CONFIG_IEEE802154_I8SHARK_PCAPNG_BUFSIZE];
+};
+#endif
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+/****************************************************************************
+ * Name: i8shark_pcapng_open
+ *
+ * Description:
+ *   Create the first capture file, <prefix>0.pcapng, and buffer its section
+ *   header and interface description.
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int i8shark_pcapng_open(FAR struct i8shark_pcapng_s *pcap,
+                        FAR const char *prefix, uint16_t linktype);
+
+/****************************************************************************
+ * Name: i8shark_pcapng_write
+ *
+ * Description:
+ *   Add one frame to the capture.  The frame is buffered; the buffer is
+ *   written when it is full or by i8shark_pcapng_flush().  The next file is
+ *   started first if the frame would take the current one over
+ *   CONFIG_IEEE802154_I8SHARK_PCAPNG_FILESIZE.
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int i8shark_pcapng_write(FAR struct i8shark_pcapng_s *pcap,
+                         FAR const struct timespec *ts,
+                         FAR const uint8_t *data, size_t len);
+
+/****************************************************************************
+ * Name: i8shark_pcapng_flush
+ *
+ * Description:
+ *   Write any buffered data to the current capture file.
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int i8shark_pcapng_flush(FAR struct i8shark_pcapng_s *pcap);
+
+/****************************************************************************
+ * Name: i8shark_pcapng_close
+ *
+ * Description:
+ *   Flush and close the current capture file.
+ *
+ ****************************************************************************/
+
+void i8shark_pcapng_close(FAR struct i8shark_pcapng_s *pcap);
+#endif
+
+#endif /* __APPS_WIRELESS_IEEE802154_I8SHARK_I8SHARK_H */
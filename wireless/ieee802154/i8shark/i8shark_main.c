@@ -48,6 +48,10 @@
 #include <string.h>
 #include <fcntl.h>
 #include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <assert.h>
 #include <errno.h>
 #include <debug.h>
 
@@ -62,6 +66,8 @@
 #include "netutils/netlib.h"
 #include "wireless/ieee802154.h"
 
+#include "i8shark.h"
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -85,27 +91,118 @@
 #  define CONFIG_IEEE802154_I8SHARK_FORWARDING_IFNAME "eth0"
 #endif
 
+#ifndef CONFIG_IEEE802154_I8SHARK_RINGSIZE
+#  define CONFIG_IEEE802154_I8SHARK_RINGSIZE 16
+#endif
+
+#ifndef CONFIG_IEEE802154_I8SHARK_EXPORT_STACKSIZE
+#  define CONFIG_IEEE802154_I8SHARK_EXPORT_STACKSIZE 2048
+#endif
+
 #define I8SHARK_MAX_DEVPATH 15
 
 #define ZEP_MAX_HDRSIZE 32
 #define I8SHARK_MAX_ZEPFRAME IEEE802154_MAX_PHY_PACKET_SIZE + ZEP_MAX_HDRSIZE
 
+/* Wireshark expects ZEP packets over UDP on port 17754 */
+
+#define ZEP_PORT 17754
+
+/* ZEP timestamps are NTP timestamps, which count from 1900 */
+
+#define NTP_EPOCH_OFFSET 2208988800ul
+
+/* pcapng link types.  The MAC passes the FCS up with the frame unless it is
+ * removed along with the XBee application header.
+ */
+
+#define LINKTYPE_IEEE802_15_4_WITHFCS 195
+#define LINKTYPE_IEEE802_15_4_NOFCS   230
+
+/* The ring holds one more entry than its capacity.  The entry at the head is
+ * never owned by the export thread, so the daemon reads into it directly.
+ */
+
+#define I8SHARK_RINGENTRIES (CONFIG_IEEE802154_I8SHARK_RINGSIZE + 1)
+
+/* The capture ring is shared by the daemon and the export thread without a
+ * lock.  The barrier orders the ring data against the index that publishes
+ * it.
+ */
+
+#define I8SHARK_MB() __sync_synchronize()
+
+/* Commands given on the command line besides the sticky settings */
+
+#define I8SHARK_CMD_STATS (1 << 0)
+#define I8SHARK_CMD_STOP  (1 << 1)
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+enum i8shark_sink_e
+{
+  I8SHARK_SINK_ZEP = 0,         /* Send ZEP packets over UDP to Wireshark */
+  I8SHARK_SINK_PCAPNG           /* Write rotating local pcapng files */
+};
+
+/* One entry in the capture ring */
+
+struct i8shark_frame_s
+{
+  struct timespec ts;           /* CLOCK_REALTIME when the frame was read */
+  uint8_t chan;                 /* Channel the frame was received on */
+  struct mac802154dev_rxframe_s frame;
+};
+
+struct i8shark_stats_s
+{
+  uint32_t captured;            /* Frames read from the MAC */
+  uint32_t dropped;             /* Frames lost because the ring was full */
+  uint32_t exported;            /* Frames sent or written */
+  uint32_t errors;              /* Frames that could not be sent or written */
+  uint16_t maxfill;             /* Highest number of frames in the ring */
+};
+
 struct i8shark_state_s
 {
-  bool initialized      : 1;
-  bool daemon_started   : 1;
-  bool daemon_shutdown  : 1;
+  bool initialized;
+  volatile bool daemon_started;
+  volatile bool daemon_shutdown;
+  volatile bool chan_changed;   /* chan must be applied to the radio */
 
   pid_t daemon_pid;
 
   /* User exposed settings */
 
   uint8_t chan;
+  uint8_t sink;
   FAR char devpath[I8SHARK_MAX_DEVPATH];
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+  char prefix[I8SHARK_MAX_PREFIX];
+#endif
+
+  /* Capture ring.  The daemon only advances head and the export thread only
+   * advances tail; exportsem wakes the export thread when frames arrive.
+   */
+
+  FAR struct i8shark_frame_s *ring;
+  volatile uint16_t head;
+  volatile uint16_t tail;
+  volatile bool export_stop;
+  sem_t exportsem;
+  pthread_t exportid;
+
+  /* Export sinks */
+
+  int sockfd;
+  struct sockaddr_in raddr;
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+  struct i8shark_pcapng_s pcap;
+#endif
+
+  struct i8shark_stats_s stats;
 };
 
 /****************************************************************************
@@ -133,22 +230,26 @@ static struct i8shark_state_s g_i8shark;
  * Name: i8shark_help
  ****************************************************************************/
 
-#ifdef CONFIG_NSH_BUILTIN_APPS
 static void i8shark_help(void)
 {
   printf("Usage: i8shark ![interface] [OPTIONS]\n");
   printf("\nArguments are \"sticky\".\n");
   printf("\nInterface only needs to be specified the first time\n");
   printf("OPTIONS include:\n");
+  printf("  [-c channel] sets the channel to sniff\n");
+  printf("  [-u] sends the frames to Wireshark over UDP (default)\n");
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+  printf("  [-f [prefix]] writes the frames to <prefix><n>.pcapng files\n");
+#endif
+  printf("  [-s] shows the capture statistics\n");
+  printf("  [-q] stops the daemon after the next frame\n");
   printf("  [-h] shows this message and exits\n");
 }
-#endif
 
 /****************************************************************************
  * Name: arg_string
  ****************************************************************************/
 
-#ifdef CONFIG_NSH_BUILTIN_APPS
 static int arg_string(FAR char **arg, FAR char **value)
 {
   FAR char *ptr = *arg;
@@ -164,13 +265,11 @@ static int arg_string(FAR char **arg, FAR char **value)
       return 1;
     }
 }
-#endif
 
 /****************************************************************************
  * Name: arg_decimal
  ****************************************************************************/
 
-#ifdef CONFIG_NSH_BUILTIN_APPS
 static int arg_decimal(FAR char **arg, FAR long *value)
 {
   FAR char *string;
@@ -180,19 +279,24 @@ static int arg_decimal(FAR char **arg, FAR long *value)
   *value = strtol(string, NULL, 10);
   return ret;
 }
-#endif
 
 /****************************************************************************
  * Name: parse_args
+ *
+ * Description:
+ *   Apply the sticky settings and return the I8SHARK_CMD_* commands found
+ *   on the command line.
+ *
  ****************************************************************************/
 
-#ifdef CONFIG_NSH_BUILTIN_APPS
-static void parse_args(FAR struct i8shark_state_s *i8shark, int argc, FAR char **argv)
+static int parse_args(FAR struct i8shark_state_s *i8shark, int argc,
+                      FAR char **argv, int index)
 {
   FAR char *ptr;
-  int index;
+  long value;
+  int cmds = 0;
 
-  for (index = 1; index < argc; )
+  while (index < argc)
     {
       ptr = argv[index];
       if (ptr[0] != '-')
@@ -203,6 +307,85 @@ static void parse_args(FAR struct i8shark_state_s *i8shark, int argc, FAR char *
 
       switch (ptr[1])
         {
+          case 'c':
+            if (ptr[2] == '\0' && index + 1 >= argc)
+              {
+                printf("Missing channel\n");
+                exit(1);
+              }
+
+            index += arg_decimal(&argv[index], &value);
+            if (value < 0 || value > 26)
+              {
+                printf("Invalid channel: %ld\n", value);
+                exit(1);
+              }
+
+            i8shark->chan         = (uint8_t)value;
+            i8shark->chan_changed = true;
+            break;
+
+          case 'u':
+            if (i8shark->daemon_started &&
+                i8shark->sink != I8SHARK_SINK_ZEP)
+              {
+                printf("Can't change the output when daemon is running.\n");
+                exit(1);
+              }
+
+            i8shark->sink = I8SHARK_SINK_ZEP;
+            index++;
+            break;
+
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+          case 'f':
+            {
+              FAR char *prefix = NULL;
+
+              /* The prefix is optional */
+
+              if (ptr[2] != '\0')
+                {
+                  prefix = &ptr[2];
+                }
+              else if (index + 1 < argc && argv[index + 1][0] != '-')
+                {
+                  prefix = argv[++index];
+                }
+
+              index++;
+
+              if (i8shark->daemon_started)
+                {
+                  printf("Can't change the output when daemon is running.\n");
+                  exit(1);
+                }
+
+              i8shark->sink = I8SHARK_SINK_PCAPNG;
+              if (prefix != NULL)
+                {
+                  if (strlen(prefix) >= I8SHARK_MAX_PREFIX)
+                    {
+                      printf("Prefix too long: %s\n", prefix);
+                      exit(1);
+                    }
+
+                  strcpy(i8shark->prefix, prefix);
+                }
+            }
+            break;
+#endif
+
+          case 's':
+            cmds |= I8SHARK_CMD_STATS;
+            index++;
+            break;
+
+          case 'q':
+            cmds |= I8SHARK_CMD_STOP;
+            index++;
+            break;
+
           case 'h':
             i8shark_help();
             exit(0);
@@ -213,8 +396,9 @@ static void parse_args(FAR struct i8shark_state_s *i8shark, int argc, FAR char *
             exit(1);
         }
     }
+
+  return cmds;
 }
-#endif
 
 /****************************************************************************
  * Name: i8shark_init
@@ -230,7 +414,11 @@ static int i8shark_init(FAR struct i8shark_state_s *i8shark)
   /* Set the default settings using config options */
 
   i8shark->chan = CONFIG_IEEE802154_I8SHARK_CHANNEL;
+  i8shark->sink = I8SHARK_SINK_ZEP;
   strcpy(i8shark->devpath, CONFIG_IEEE802154_I8SHARK_DEVPATH);
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+  strcpy(i8shark->prefix, CONFIG_IEEE802154_I8SHARK_PCAPNG_PREFIX);
+#endif
 
   /* Flags for synchronzing with daemon state */
 
@@ -242,52 +430,330 @@ static int i8shark_init(FAR struct i8shark_state_s *i8shark)
 }
 
 /****************************************************************************
- * Name : i8shark_daemon
+ * Name: i8shark_showstats
+ ****************************************************************************/
+
+static void i8shark_showstats(FAR struct i8shark_state_s *i8shark)
+{
+  printf("i8shark: captured %lu dropped %lu exported %lu errors %lu "
+         "max ring fill %u/%u\n",
+         (unsigned long)i8shark->stats.captured,
+         (unsigned long)i8shark->stats.dropped,
+         (unsigned long)i8shark->stats.exported,
+         (unsigned long)i8shark->stats.errors,
+         i8shark->stats.maxfill, CONFIG_IEEE802154_I8SHARK_RINGSIZE);
+}
+
+/****************************************************************************
+ * Name: i8shark_framedata
  *
- * Description :
- *   This daemon reads all incoming IEEE 802.15.4 frames from a MAC802154 character
- *   driver, packages the frames into a Wireshark Zigbee Encapsulate Protocol (ZEP)
- *   packet and sends it over Ethernet to the specified host machine running
- *   Wireshark.
+ * Description:
+ *   Copy the frame as it is to be presented to Wireshark and return its
+ *   length.
  *
  ****************************************************************************/
 
-static int i8shark_daemon(int argc, FAR char *argv[])
+static size_t i8shark_framedata(FAR const struct mac802154dev_rxframe_s *frame,
+                                FAR uint8_t *dest)
 {
-  int ret;
-  int fd;
-  struct sockaddr_in addr;
-  struct sockaddr_in raddr;
-  socklen_t addrlen;
-  int sockfd;
+#ifdef CONFIG_IEEE802154_I8SHARK_XBEE_APPHDR
+  memcpy(dest, frame->payload, frame->offset);
+
+  /* XBee radios use a 2 byte "application header" to support duplicate packet
+   * detection.  Wireshark doesn't know how to handle this data, so we provide
+   * a configuration option that drops the first 2 bytes of the payload portion
+   * of the frame for all sniffed frames
+   *
+   * NOTE: Since we remove data from the frame, the FCS is no longer valid
+   * and Wireshark will fail to disect the frame.  Wireshark ignores a case
+   * where the FCS is not included in the actual frame.  Therefore, we
+   * subtract 4 rather than 2 to remove the FCS field so that the disector
+   * will not fail.
+   */
 
-  fprintf(stderr, "i8shark: daemon started\n");
-  g_i8shark.daemon_started = true;
+  memcpy(&dest[frame->offset], (frame->payload + frame->offset + 2),
+         (frame->length - frame->offset - 4));
+  return frame->length - 4;
+#else
+  memcpy(dest, frame->payload, frame->length);
+  return frame->length;
+#endif
+}
 
-  fd = open(g_i8shark.devpath, O_RDWR);
-  if (fd < 0)
+/****************************************************************************
+ * Name: i8shark_sendzep
+ *
+ * Description:
+ *   Package a captured frame into a Wireshark "Zigbee Encapsulation Packet"
+ *   (ZEP) and send it over UDP to Wireshark.
+ *
+ ****************************************************************************/
+
+static int i8shark_sendzep(FAR struct i8shark_state_s *i8shark,
+                           FAR const struct i8shark_frame_s *entry)
+{
+  FAR const struct mac802154dev_rxframe_s *frame = &entry->frame;
+  enum ieee802154_frametype_e ftype;
+  uint8_t zepframe[I8SHARK_MAX_ZEPFRAME];
+  uint32_t ntpsec;
+  uint32_t ntpfrac;
+  int ind = 0;
+  int nbytes;
+
+  /* First 2 bytes of packet represent preamble. For ZEP, "EX" */
+
+  zepframe[ind++] = 'E';
+  zepframe[ind++] = 'X';
+
+  /* The next byte is the version. We are using V2 */
+
+  zepframe[ind++] = 2;
+
+  /* Next byte is type. ZEP only differentiates between ACK and Data. My
+   * assumption is that Data also includes MAC command frames and beacon
+   * frames. So we really only need to check if it's an ACK or not.
+   */
+
+  ftype = ((*(FAR const uint16_t *)frame->payload) &
+           IEEE802154_FRAMECTRL_FTYPE) >> IEEE802154_FRAMECTRL_SHIFT_FTYPE;
+
+  if (ftype == IEEE802154_FRAME_ACK)
     {
-      fprintf(stderr, "ERROR: cannot open %s, errno=%d\n", g_i8shark.devpath, errno);
-      g_i8shark.daemon_started = false;
-      ret = errno;
-      return ret;
+      zepframe[ind++] = 2;
+
+      /* Not sure why, but the ZEP header allows for a 4-byte sequence no.
+       * despite 802.15.4 sequence number only being 1-byte.  It is sent in
+       * network order.
+       */
+
+      zepframe[ind++] = 0;
+      zepframe[ind++] = 0;
+      zepframe[ind++] = 0;
+      zepframe[ind++] = frame->meta.dsn;
     }
+  else
+    {
+      zepframe[ind++] = 1;
 
-  /* Place the MAC into promiscuous mode */
+      /* Next bytes is the Channel ID, as it was when the frame was read */
 
-  ieee802154_setpromisc(fd, true);
+      zepframe[ind++] = entry->chan;
 
-  /* Always listen */
+      /* For now, just hard code the device ID to an arbitrary value */
 
-  ieee802154_setrxonidle(fd, true);
+      zepframe[ind++] = 0xFA;
+      zepframe[ind++] = 0xDE;
+
+      /* Not completely sure what LQI mode is. My best guess as of now based
+       * on a few comments in the Wireshark code is that it determines whether
+       * the last 2 bytes of the frame portion of the packet is the CRC or the
+       * LQI.  I believe it is CRC = 1, LQI = 0. We will assume the CRC is the
+       * last few bytes as that is what the MAC layer expects. However, this
+       * may be a bad assumption for certain radios.
+       */
+
+      zepframe[ind++] = 1;
+
+      /* Next byte is the LQI value */
+
+      zepframe[ind++] = frame->meta.lqi;
+
+      /* The timestamp is the NTP time at which the frame was read, seconds
+       * and binary fraction, in network order.
+       */
+
+      ntpsec  = (uint32_t)entry->ts.tv_sec + NTP_EPOCH_OFFSET;
+      ntpfrac = (uint32_t)(((uint64_t)entry->ts.tv_nsec << 32) /
+                           1000000000);
+
+      zepframe[ind++] = (uint8_t)(ntpsec >> 24);
+      zepframe[ind++] = (uint8_t)(ntpsec >> 16);
+      zepframe[ind++] = (uint8_t)(ntpsec >> 8);
+      zepframe[ind++] = (uint8_t)ntpsec;
+      zepframe[ind++] = (uint8_t)(ntpfrac >> 24);
+      zepframe[ind++] = (uint8_t)(ntpfrac >> 16);
+      zepframe[ind++] = (uint8_t)(ntpfrac >> 8);
+      zepframe[ind++] = (uint8_t)ntpfrac;
+
+      /* Not sure why, but the ZEP header allows for a 4-byte sequence no.
+       * despite 802.15.4 sequence number only being 1-byte
+       */
+
+      zepframe[ind++] = 0;
+      zepframe[ind++] = 0;
+      zepframe[ind++] = 0;
+      zepframe[ind++] = frame->meta.dsn;
+
+      /* 10-bytes of reserved fields */
+
+      memset(&zepframe[ind], 0, 10);
+      ind += 10;
+
+      /* Last byte is the length */
+
+#ifdef CONFIG_IEEE802154_I8SHARK_XBEE_APPHDR
+      zepframe[ind++] = frame->length - 2;
+#else
+      zepframe[ind++] = frame->length;
+#endif
+    }
+
+  /* The ZEP header is filled, now copy the frame in */
+
+  ind += i8shark_framedata(frame, &zepframe[ind]);
+
+  /* Send the encapsulated frame to Wireshark over UDP */
+
+  nbytes = sendto(i8shark->sockfd, zepframe, ind, 0,
+                  (FAR struct sockaddr *)&i8shark->raddr,
+                  sizeof(struct sockaddr_in));
+  if (nbytes < ind)
+    {
+      return nbytes < 0 ? -errno : -EIO;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: i8shark_writepcapng
+ *
+ * Description:
+ *   Add a captured frame to the local pcapng capture.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+static int i8shark_writepcapng(FAR struct i8shark_state_s *i8shark,
+                               FAR const struct i8shark_frame_s *entry)
+{
+  uint8_t data[IEEE802154_MAX_PHY_PACKET_SIZE];
+  size_t len;
+
+  len = i8shark_framedata(&entry->frame, data);
+  return i8shark_pcapng_write(&i8shark->pcap, &entry->ts, data, len);
+}
+#endif
+
+/****************************************************************************
+ * Name: i8shark_export
+ *
+ * Description:
+ *   The export thread.  Each time it is woken it sends (or writes) every
+ *   frame waiting in the capture ring, so that the daemon only has to read
+ *   frames from the MAC and is never held up by the network or the file
+ *   system.
+ *
+ ****************************************************************************/
+
+static FAR void *i8shark_export(FAR void *arg)
+{
+  FAR struct i8shark_state_s *i8shark = (FAR struct i8shark_state_s *)arg;
+  FAR struct i8shark_frame_s *entry;
+  uint16_t head;
+  uint16_t tail;
+  bool stop;
+  int ret;
+
+  for (; ; )
+    {
+      while (sem_wait(&i8shark->exportsem) < 0)
+        {
+          DEBUGASSERT(errno == EINTR);
+        }
 
-  /* Create a UDP socket to send the data to Wireshark */
+      /* Sample the stop flag before the ring so that everything queued
+       * before the stop request is still exported.
+       */
+
+      stop = i8shark->export_stop;
+      I8SHARK_MB();
+
+      head = i8shark->head;
+      tail = i8shark->tail;
+      I8SHARK_MB();
+
+      if (head == tail && !stop)
+        {
+          continue;
+        }
+
+      while (tail != head)
+        {
+          entry = &i8shark->ring[tail];
+
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+          if (i8shark->sink == I8SHARK_SINK_PCAPNG)
+            {
+              ret = i8shark_writepcapng(i8shark, entry);
+            }
+          else
+#endif
+            {
+              ret = i8shark_sendzep(i8shark, entry);
+            }
+
+          if (ret < 0)
+            {
+              i8shark->stats.errors++;
+            }
+          else
+            {
+              i8shark->stats.exported++;
+            }
+
+          if (++tail >= I8SHARK_RINGENTRIES)
+            {
+              tail = 0;
+            }
+
+          /* Release the entry to the daemon */
+
+          I8SHARK_MB();
+          i8shark->tail = tail;
+        }
+
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+      /* Write the file buffer once the ring has been emptied so that the
+       * files are current when the radio goes quiet.
+       */
+
+      if (i8shark->sink == I8SHARK_SINK_PCAPNG &&
+          (stop || i8shark->head == tail))
+        {
+          ret = i8shark_pcapng_flush(&i8shark->pcap);
+          if (ret < 0)
+            {
+              fprintf(stderr, "ERROR: capture file write failed: %d\n", ret);
+            }
+        }
+#endif
+
+      if (stop)
+        {
+          break;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: i8shark_openzep
+ *
+ * Description:
+ *   Create the UDP socket used to send the data to Wireshark.
+ *
+ ****************************************************************************/
+
+static int i8shark_openzep(FAR struct i8shark_state_s *i8shark)
+{
+  struct sockaddr_in addr;
 
-  sockfd = socket(AF_INET, SOCK_DGRAM, 0);
-  if (sockfd < 0)
+  i8shark->sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (i8shark->sockfd < 0)
     {
       fprintf(stderr, "ERROR: socket failure %d\n", errno);
-      g_i8shark.daemon_started = false;
       return -1;
     }
 
@@ -298,165 +764,245 @@ static int i8shark_daemon(int argc, FAR char *argv[])
   netlib_get_ipv4addr(CONFIG_IEEE802154_I8SHARK_FORWARDING_IFNAME, &addr.sin_addr);
   addr.sin_port   = 0;
   addr.sin_family = AF_INET;
-  addrlen = sizeof(struct sockaddr_in);
 
-  if (bind(sockfd, (FAR struct sockaddr *)&addr, addrlen) < 0)
+  if (bind(i8shark->sockfd, (FAR struct sockaddr *)&addr,
+           sizeof(struct sockaddr_in)) < 0)
     {
       fprintf(stderr, "ERROR: Bind failure: %d\n", errno);
+      close(i8shark->sockfd);
       return -1;
     }
 
-  /* Setup our remote address. Wireshark expects ZEP packets over UDP on port 17754 */
-
-  raddr.sin_family      = AF_INET;
-  raddr.sin_port        = HTONS(17754);
-  raddr.sin_addr.s_addr = HTONL(CONFIG_IEEE802154_I8SHARK_HOST_IPADDR);
+  /* Setup our remote address */
 
-  /* Loop until the daemon is shutdown reading incoming IEEE 802.15.4 frames,
-   * packing them into Wireshark "Zigbee Encapsulation Packets" (ZEP) and sending
-   * them over UDP to Wireshark.
-   */
+  i8shark->raddr.sin_family      = AF_INET;
+  i8shark->raddr.sin_port        = HTONS(ZEP_PORT);
+  i8shark->raddr.sin_addr.s_addr = HTONL(CONFIG_IEEE802154_I8SHARK_HOST_IPADDR);
+  return OK;
+}
 
-  while (!g_i8shark.daemon_shutdown)
-    {
-      struct mac802154dev_rxframe_s frame;
-      enum ieee802154_frametype_e ftype;
-      uint8_t zepframe[I8SHARK_MAX_ZEPFRAME];
-      clock_t systime;
-      int ind = 0;
-      int nbytes;
+/****************************************************************************
+ * Name : i8shark_daemon
+ *
+ * Description :
+ *   This daemon reads all incoming IEEE 802.15.4 frames from a MAC802154 character
+ *   driver into the capture ring.  The export thread packages the frames into
+ *   Wireshark Zigbee Encapsulate Protocol (ZEP) packets and sends them over
+ *   Ethernet to the specified host machine running Wireshark, or writes them
+ *   to local pcapng files.
+ *
+ ****************************************************************************/
 
-      /* Get an incoming frame from the MAC character driver */
+static int i8shark_daemon(int argc, FAR char *argv[])
+{
+  FAR struct i8shark_frame_s *entry;
+  struct sched_param sparam;
+  pthread_attr_t tattr;
+  time_t chantime;
+  uint16_t head;
+  uint16_t next;
+  uint16_t used;
+  int ret;
+  int fd;
 
-      ret = read(fd, &frame, sizeof(struct mac802154dev_rxframe_s));
-      if (ret < 0)
-        {
-          continue;
-        }
+  fprintf(stderr, "i8shark: daemon started\n");
 
-      /* First 2 bytes of packet represent preamble. For ZEP, "EX" */
+  memset(&g_i8shark.stats, 0, sizeof(struct i8shark_stats_s));
 
-      zepframe[ind++] = 'E';
-      zepframe[ind++] = 'X';
+  fd = open(g_i8shark.devpath, O_RDWR);
+  if (fd < 0)
+    {
+      fprintf(stderr, "ERROR: cannot open %s, errno=%d\n", g_i8shark.devpath, errno);
+      g_i8shark.daemon_started = false;
+      ret = errno;
+      return ret;
+    }
 
-      /* The next byte is the version. We are using V2 */
+  /* Place the MAC into promiscuous mode */
 
-      zepframe[ind++] = 2;
+  ieee802154_setpromisc(fd, true);
 
-      /* Next byte is type. ZEP only differentiates between ACK and Data. My
-       * assumption is that Data also includes MAC command frames and beacon
-       * frames. So we really only need to check if it's an ACK or not.
-       */
+  /* Always listen */
 
-      ftype = ((*(uint16_t *)frame.payload) & IEEE802154_FRAMECTRL_FTYPE) >>
-              IEEE802154_FRAMECTRL_SHIFT_FTYPE;
+  ieee802154_setrxonidle(fd, true);
 
-      if (ftype == IEEE802154_FRAME_ACK)
-        {
-          zepframe[ind++] = 2;
+  /* Apply a channel given on the command line, otherwise sniff whatever
+   * channel the radio is on.  The channel is cached and refreshed at most
+   * once a second rather than queried for every frame.
+   */
 
-          /* Not sure why, but the ZEP header allows for a 4-byte sequence no.
-           * despite 802.15.4 sequence number only being 1-byte
-           */
+  if (g_i8shark.chan_changed)
+    {
+      g_i8shark.chan_changed = false;
+      ieee802154_setchan(fd, g_i8shark.chan);
+    }
+  else
+    {
+      ieee802154_getchan(fd, &g_i8shark.chan);
+    }
 
-          zepframe[ind] = frame.meta.dsn;
-          ind += 4;
-        }
-      else
-        {
-          zepframe[ind++] = 1;
+  chantime = 0;
 
-          /* Next bytes is the Channel ID */
+  /* Open the output */
 
-          ieee802154_getchan(fd, &zepframe[ind++]);
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+  if (g_i8shark.sink == I8SHARK_SINK_PCAPNG)
+    {
+#ifdef CONFIG_IEEE802154_I8SHARK_XBEE_APPHDR
+      ret = i8shark_pcapng_open(&g_i8shark.pcap, g_i8shark.prefix,
+                                LINKTYPE_IEEE802_15_4_NOFCS);
+#else
+      ret = i8shark_pcapng_open(&g_i8shark.pcap, g_i8shark.prefix,
+                                LINKTYPE_IEEE802_15_4_WITHFCS);
+#endif
+    }
+  else
+#endif
+    {
+      ret = i8shark_openzep(&g_i8shark);
+    }
 
-          /* For now, just hard code the device ID to an arbitrary value */
+  if (ret < 0)
+    {
+      goto errout_with_fd;
+    }
 
-          zepframe[ind++] = 0xFA;
-          zepframe[ind++] = 0xDE;
+  /* Allocate the capture ring and start the export thread */
 
-          /* Not completely sure what LQI mode is. My best guess as of now based
-           * on a few comments in the Wireshark code is that it determines whether
-           * the last 2 bytes of the frame portion of the packet is the CRC or the
-           * LQI.  I believe it is CRC = 1, LQI = 0. We will assume the CRC is the
-           * last few bytes as that is what the MAC layer expects. However, this
-           * may be a bad assumption for certain radios.
-           */
+  g_i8shark.ring = (FAR struct i8shark_frame_s *)
+    malloc(I8SHARK_RINGENTRIES * sizeof(struct i8shark_frame_s));
+  if (g_i8shark.ring == NULL)
+    {
+      fprintf(stderr, "ERROR: failed to allocate the capture ring\n");
+      ret = -ENOMEM;
+      goto errout_with_sink;
+    }
 
-          zepframe[ind++] = 1;
+  g_i8shark.head        = 0;
+  g_i8shark.tail        = 0;
+  g_i8shark.export_stop = false;
+  sem_init(&g_i8shark.exportsem, 0, 0);
 
-          /* Next byte is the LQI value */
+  /* Run just below the daemon so that exporting never delays reading the
+   * MAC.
+   */
 
-          zepframe[ind++] = frame.meta.lqi;
+  pthread_attr_init(&tattr);
+  sparam.sched_priority = CONFIG_IEEE802154_I8SHARK_DAEMON_PRIORITY - 1;
+  (void)pthread_attr_setschedparam(&tattr, &sparam);
+  (void)pthread_attr_setstacksize(&tattr,
+                                  CONFIG_IEEE802154_I8SHARK_EXPORT_STACKSIZE);
 
-          /* Need to use NTP to get time, but for now, include the system time */
+  ret = pthread_create(&g_i8shark.exportid, &tattr, i8shark_export,
+                       (pthread_addr_t)&g_i8shark);
+  if (ret != 0)
+    {
+      fprintf(stderr, "ERROR: failed to start the export thread: %d\n", ret);
+      ret = -ret;
+      goto errout_with_ring;
+    }
 
-          systime = clock();
-          memcpy(&zepframe[ind], &systime, 8);
-          ind += 8;
+  pthread_setname_np(g_i8shark.exportid, "i8shark_export");
 
-          /* Not sure why, but the ZEP header allows for a 4-byte sequence no.
-           * despite 802.15.4 sequence number only being 1-byte
-           */
+  /* Loop until the daemon is shutdown reading incoming IEEE 802.15.4 frames
+   * into the ring for the export thread.
+   */
 
-          zepframe[ind]   = frame.meta.dsn;
-          zepframe[ind+1] = 0;
-          zepframe[ind+2] = 0;
-          zepframe[ind+3] = 0;
-          ind += 4;
+  head = 0;
+  while (!g_i8shark.daemon_shutdown)
+    {
+      /* Get an incoming frame from the MAC character driver.  The entry at
+       * the head of the ring always belongs to the daemon.
+       */
 
-          /* Skip 10-bytes for reserved fields */
+      entry = &g_i8shark.ring[head];
+      ret = read(fd, &entry->frame, sizeof(struct mac802154dev_rxframe_s));
+      if (ret < 0)
+        {
+          continue;
+        }
 
-          ind += 10;
+      clock_gettime(CLOCK_REALTIME, &entry->ts);
+      g_i8shark.stats.captured++;
 
-          /* Last byte is the length */
+      /* Track the channel */
 
-#ifdef CONFIG_IEEE802154_I8SHARK_XBEE_APPHDR
-          zepframe[ind++] = frame.length - 2;
-#else
-          zepframe[ind++] = frame.length;
-#endif
+      if (g_i8shark.chan_changed)
+        {
+          g_i8shark.chan_changed = false;
+          ieee802154_setchan(fd, g_i8shark.chan);
+          chantime = entry->ts.tv_sec;
+        }
+      else if (entry->ts.tv_sec != chantime)
+        {
+          ieee802154_getchan(fd, &g_i8shark.chan);
+          chantime = entry->ts.tv_sec;
         }
 
-      /* The ZEP header is filled, now copy the frame in */
+      entry->chan = g_i8shark.chan;
 
-#ifdef CONFIG_IEEE802154_I8SHARK_XBEE_APPHDR
-      memcpy(&zepframe[ind], frame.payload, frame.offset);
-      ind += frame.offset;
-
-      /* XBee radios use a 2 byte "application header" to support duplicate packet
-       * detection.  Wireshark doesn't know how to handle this data, so we provide
-       * a configuration option that drops the first 2 bytes of the payload portion
-       * of the frame for all sniffed frames
-       *
-       * NOTE: Since we remove data from the frame, the FCS is no longer valid
-       * and Wireshark will fail to disect the frame.  Wireshark ignores a case
-       * where the FCS is not included in the actual frame.  Therefore, we
-       * subtract 4 rather than 2 to remove the FCS field so that the disector
-       * will not fail.
+      /* If the export thread has fallen too far behind, drop the frame and
+       * reuse the entry.
        */
 
-      memcpy(&zepframe[ind], (frame.payload + frame.offset + 2),
-             (frame.length - frame.offset - 2));
-      ind += frame.length - frame.offset - 4;
-#else
-      memcpy(&zepframe[ind], frame.payload, frame.length);
-      ind += frame.length;
-#endif
+      next = head + 1;
+      if (next >= I8SHARK_RINGENTRIES)
+        {
+          next = 0;
+        }
 
-      /* Send the encapsulated frame to Wireshark over UDP */
+      if (next == g_i8shark.tail)
+        {
+          g_i8shark.stats.dropped++;
+          continue;
+        }
 
-      nbytes = sendto(sockfd, zepframe, ind, 0, (struct sockaddr*)&raddr, addrlen);
-      if (nbytes < ind)
+      used = (next >= g_i8shark.tail) ? next - g_i8shark.tail :
+             I8SHARK_RINGENTRIES - g_i8shark.tail + next;
+      if (used > g_i8shark.stats.maxfill)
         {
-          fprintf(stderr, "ERROR: sendto() did not send all bytes. %d\n", errno);
+          g_i8shark.stats.maxfill = used;
         }
+
+      /* Publish the frame to the export thread */
+
+      I8SHARK_MB();
+      head = next;
+      g_i8shark.head = head;
+      sem_post(&g_i8shark.exportsem);
     }
 
+  /* Let the export thread finish the frames in the ring */
+
+  g_i8shark.export_stop = true;
+  I8SHARK_MB();
+  sem_post(&g_i8shark.exportsem);
+  pthread_join(g_i8shark.exportid, NULL);
+  ret = OK;
+
+errout_with_ring:
+  sem_destroy(&g_i8shark.exportsem);
+  free(g_i8shark.ring);
+  g_i8shark.ring = NULL;
+
+errout_with_sink:
+#ifdef CONFIG_IEEE802154_I8SHARK_PCAPNG
+  if (g_i8shark.sink == I8SHARK_SINK_PCAPNG)
+    {
+      i8shark_pcapng_close(&g_i8shark.pcap);
+    }
+  else
+#endif
+    {
+      close(g_i8shark.sockfd);
+    }
+
+errout_with_fd:
   g_i8shark.daemon_started = false;
   close(fd);
+  i8shark_showstats(&g_i8shark);
   printf("i8shark: daemon closing\n");
-  return OK;
+  return ret < 0 ? ERROR : OK;
 }
 
 /****************************************************************************
@@ -474,6 +1020,7 @@ int i8shark_main(int argc, char *argv[])
 #endif
 {
   int argind = 1;
+  int cmds;
 
   if (!g_i8shark.initialized)
     {
@@ -488,7 +1035,7 @@ int i8shark_main(int argc, char *argv[])
         {
           /* Check if the name is the same as the current one */
 
-          if (!strcmp(g_i8shark.devpath, argv[argind]))
+          if (strcmp(g_i8shark.devpath, argv[argind]) != 0)
             {
               /* Adapter daemon can't be running when we change device path */
 
@@ -498,16 +1045,49 @@ int i8shark_main(int argc, char *argv[])
                   exit(1);
                 }
 
+              if (strlen(argv[argind]) >= I8SHARK_MAX_DEVPATH)
+                {
+                  printf("Device path too long: %s\n", argv[argind]);
+                  exit(1);
+                }
+
               /* Copy the path into our state structure */
 
-              strcpy(g_i8shark.devpath, argv[1]);
+              strcpy(g_i8shark.devpath, argv[argind]);
             }
 
           argind++;
         }
     }
 
-  /* If the daemon is not running, start it. */
+  cmds = parse_args(&g_i8shark, argc, argv, argind);
+
+  if ((cmds & I8SHARK_CMD_STATS) != 0)
+    {
+      i8shark_showstats(&g_i8shark);
+    }
+
+  if ((cmds & I8SHARK_CMD_STOP) != 0)
+    {
+      if (g_i8shark.daemon_started)
+        {
+          g_i8shark.daemon_shutdown = true;
+        }
+
+      return OK;
+    }
+
+  /* If the daemon is not running, start it.  A channel change is picked up
+   * by a running daemon.
+   */
+
+  if (g_i8shark.daemon_started || cmds != 0)
+    {
+      return OK;
+    }
+
+  g_i8shark.daemon_started  = true;
+  g_i8shark.daemon_shutdown = false;
 
   g_i8shark.daemon_pid = task_create("i8shark",
                                      CONFIG_IEEE802154_I8SHARK_DAEMON_PRIORITY,
@@ -516,6 +1096,7 @@ int i8shark_main(int argc, char *argv[])
   if (g_i8shark.daemon_pid < 0)
     {
       fprintf(stderr, "failed to start daemon\n");
+      g_i8shark.daemon_started = false;
       return ERROR;
     }
 
@@ -0,0 +1,313 @@
+/****************************************************************************
+ * wireless/ieee802154/i8shark/i8shark_pcapng.c
+ *
+ *   Copyright (C) 2019 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#include "i8shark.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* pcapng block types.  All blocks are written in host byte order; the
+ * byte-order magic in the section header tells the reader which that is.
+ */
+
+#define PCAPNG_SHB_TYPE       0x0a0d0d0a  /* Section Header Block */
+#define PCAPNG_IDB_TYPE       0x00000001  /* Interface Description Block */
+#define PCAPNG_EPB_TYPE       0x00000006  /* Enhanced Packet Block */
+#define PCAPNG_BYTEORDER      0x1a2b3c4d
+
+#define PCAPNG_SHB_SIZE       28
+#define PCAPNG_IDB_SIZE       20
+#define PCAPNG_EPB_HDRSIZE    32          /* Block without the packet data */
+#define PCAPNG_HDRSIZE        (PCAPNG_SHB_SIZE + PCAPNG_IDB_SIZE)
+
+/* The interface description has no if_tsresol option, so timestamps are in
+ * the default resolution of microseconds.
+ */
+
+#define PCAPNG_SNAPLEN        256
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pcapng_put16/pcapng_put32
+ *
+ * Description:
+ *   Store a host order value in the write buffer and return the next
+ *   position.
+ *
+ ****************************************************************************/
+
+static FAR uint8_t *pcapng_put16(FAR uint8_t *dest, uint16_t value)
+{
+  memcpy(dest, &value, 2);
+  return dest + 2;
+}
+
+static FAR uint8_t *pcapng_put32(FAR uint8_t *dest, uint32_t value)
+{
+  memcpy(dest, &value, 4);
+  return dest + 4;
+}
+
+/****************************************************************************
+ * Name: pcapng_create
+ *
+ * Description:
+ *   Create (or truncate) capture file number pcap->fileno and buffer the
+ *   section header and interface description blocks that start it.
+ *
+ ****************************************************************************/
+
+static int pcapng_create(FAR struct i8shark_pcapng_s *pcap)
+{
+  char path[I8SHARK_MAX_PREFIX + 16];
+  FAR uint8_t *ptr;
+
+  snprintf(path, sizeof(path), "%s%d.pcapng", pcap->prefix, pcap->fileno);
+
+  pcap->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (pcap->fd < 0)
+    {
+      int errcode = errno;
+      fprintf(stderr, "ERROR: cannot create %s, errno=%d\n", path, errcode);
+      return -errcode;
+    }
+
+  /* Section header: no options, section length unknown */
+
+  ptr = &pcap->buffer[pcap->nbuffered];
+  ptr = pcapng_put32(ptr, PCAPNG_SHB_TYPE);
+  ptr = pcapng_put32(ptr, PCAPNG_SHB_SIZE);
+  ptr = pcapng_put32(ptr, PCAPNG_BYTEORDER);
+  ptr = pcapng_put16(ptr, 1);
+  ptr = pcapng_put16(ptr, 0);
+  ptr = pcapng_put32(ptr, 0xffffffff);
+  ptr = pcapng_put32(ptr, 0xffffffff);
+  ptr = pcapng_put32(ptr, PCAPNG_SHB_SIZE);
+
+  /* Interface description for the radio */
+
+  ptr = pcapng_put32(ptr, PCAPNG_IDB_TYPE);
+  ptr = pcapng_put32(ptr, PCAPNG_IDB_SIZE);
+  ptr = pcapng_put16(ptr, pcap->linktype);
+  ptr = pcapng_put16(ptr, 0);
+  ptr = pcapng_put32(ptr, PCAPNG_SNAPLEN);
+  ptr = pcapng_put32(ptr, PCAPNG_IDB_SIZE);
+
+  pcap->nbuffered += PCAPNG_HDRSIZE;
+  pcap->filesize   = PCAPNG_HDRSIZE;
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: i8shark_pcapng_open
+ *
+ * Description:
+ *   Create the first capture file, <prefix>0.pcapng, and buffer its section
+ *   header and interface description.
+ *
+ ****************************************************************************/
+
+int i8shark_pcapng_open(FAR struct i8shark_pcapng_s *pcap,
+                        FAR const char *prefix, uint16_t linktype)
+{
+  pcap->prefix    = prefix;
+  pcap->fd        = -1;
+  pcap->fileno    = 0;
+  pcap->linktype  = linktype;
+  pcap->filesize  = 0;
+  pcap->nbuffered = 0;
+
+  return pcapng_create(pcap);
+}
+
+/****************************************************************************
+ * Name: i8shark_pcapng_write
+ *
+ * Description:
+ *   Add one frame to the capture as an enhanced packet block.
+ *
+ ****************************************************************************/
+
+int i8shark_pcapng_write(FAR struct i8shark_pcapng_s *pcap,
+                         FAR const struct timespec *ts,
+                         FAR const uint8_t *data, size_t len)
+{
+  FAR uint8_t *ptr;
+  uint64_t usec;
+  size_t padded;
+  size_t blksize;
+  int ret;
+
+  if (pcap->fd < 0)
+    {
+      return -EBADF;
+    }
+
+  padded  = (len + 3) & ~3;
+  blksize = PCAPNG_EPB_HDRSIZE + padded;
+
+  /* Move on to the next file if this one is full.  A file always holds at
+   * least one frame.
+   */
+
+  if (pcap->filesize + blksize > CONFIG_IEEE802154_I8SHARK_PCAPNG_FILESIZE &&
+      pcap->filesize > PCAPNG_HDRSIZE)
+    {
+      i8shark_pcapng_close(pcap);
+
+      pcap->fileno++;
+      if (pcap->fileno >= CONFIG_IEEE802154_I8SHARK_PCAPNG_FILECOUNT)
+        {
+          pcap->fileno = 0;
+        }
+
+      ret = pcapng_create(pcap);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  if (pcap->nbuffered + blksize > sizeof(pcap->buffer))
+    {
+      ret = i8shark_pcapng_flush(pcap);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  usec = (uint64_t)ts->tv_sec * 1000000 + ts->tv_nsec / 1000;
+
+  ptr = &pcap->buffer[pcap->nbuffered];
+  ptr = pcapng_put32(ptr, PCAPNG_EPB_TYPE);
+  ptr = pcapng_put32(ptr, blksize);
+  ptr = pcapng_put32(ptr, 0);                  /* Interface ID */
+  ptr = pcapng_put32(ptr, (uint32_t)(usec >> 32));
+  ptr = pcapng_put32(ptr, (uint32_t)usec);
+  ptr = pcapng_put32(ptr, len);                /* Captured length */
+  ptr = pcapng_put32(ptr, len);                /* Original length */
+
+  memcpy(ptr, data, len);
+  memset(ptr + len, 0, padded - len);
+  ptr += padded;
+
+  ptr = pcapng_put32(ptr, blksize);
+
+  pcap->nbuffered += blksize;
+  pcap->filesize  += blksize;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: i8shark_pcapng_flush
+ *
+ * Description:
+ *   Write any buffered data to the current capture file.
+ *
+ ****************************************************************************/
+
+int i8shark_pcapng_flush(FAR struct i8shark_pcapng_s *pcap)
+{
+  FAR const uint8_t *ptr = pcap->buffer;
+  size_t remaining = pcap->nbuffered;
+  ssize_t nwritten;
+
+  while (remaining > 0)
+    {
+      nwritten = write(pcap->fd, ptr, remaining);
+      if (nwritten < 0)
+        {
+          int errcode = errno;
+          if (errcode != EINTR)
+            {
+              /* Discard the buffer so that the capture can continue */
+
+              pcap->nbuffered = 0;
+              return -errcode;
+            }
+        }
+      else
+        {
+          ptr       += nwritten;
+          remaining -= nwritten;
+        }
+    }
+
+  pcap->nbuffered = 0;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: i8shark_pcapng_close
+ *
+ * Description:
+ *   Flush and close the current capture file.
+ *
+ ****************************************************************************/
+
+void i8shark_pcapng_close(FAR struct i8shark_pcapng_s *pcap)
+{
+  if (pcap->fd >= 0)
+    {
+      (void)i8shark_pcapng_flush(pcap);
+      close(pcap->fd);
+      pcap->fd = -1;
+    }
+
+  pcap->nbuffered = 0;
+}